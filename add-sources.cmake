@@ -26,6 +26,7 @@ set(DOCUMENT_FILES
     ${LOMSE_SRC_DIR}/document/lomse_command.cpp
     ${LOMSE_SRC_DIR}/document/lomse_document.cpp
     ${LOMSE_SRC_DIR}/document/lomse_document_cursor.cpp
+    ${LOMSE_SRC_DIR}/document/lomse_import_stats.cpp
 )
 
 set(EXPORTERS_FILES
@@ -144,6 +145,7 @@ set(INTERNAL_MODEL_FILES
     ${LOMSE_SRC_DIR}/internal_model/lomse_im_figured_bass.cpp
     ${LOMSE_SRC_DIR}/internal_model/lomse_im_measures_table.cpp
     ${LOMSE_SRC_DIR}/internal_model/lomse_im_note.cpp
+    ${LOMSE_SRC_DIR}/internal_model/lomse_im_snapshot.cpp
     ${LOMSE_SRC_DIR}/internal_model/lomse_internal_model.cpp
     ${LOMSE_SRC_DIR}/internal_model/lomse_model_builder.cpp
     ${LOMSE_SRC_DIR}/internal_model/lomse_relobj_cloner.cpp
@@ -154,6 +156,7 @@ set(INTERNAL_MODEL_FILES
 )
 
 set(MODULE_FILES
+    ${LOMSE_SRC_DIR}/module/lomse_arena.cpp
     ${LOMSE_SRC_DIR}/module/lomse_doorway.cpp
     ${LOMSE_SRC_DIR}/module/lomse_events.cpp
     ${LOMSE_SRC_DIR}/module/lomse_events_dispatcher.cpp
@@ -163,6 +166,7 @@ set(MODULE_FILES
     ${LOMSE_SRC_DIR}/module/lomse_logger.cpp
     ${LOMSE_SRC_DIR}/module/lomse_pitch.cpp
     ${LOMSE_SRC_DIR}/module/lomse_time.cpp
+    ${LOMSE_SRC_DIR}/module/lomse_workers_pool.cpp
 )
 
 set(MVC_FILES
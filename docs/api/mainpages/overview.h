@@ -41,6 +41,7 @@ If you are new to Lomse, @b please read the @subpage page-introduction and then
 - @subpage page-callbacks
 - @subpage page-events
 - @subpage page-logging
+- @subpage page-threads
 
 
 */
@@ -0,0 +1,45 @@
+/**
+@page page-threads Using Lomse from several threads
+
+@tableofcontents
+
+
+
+@section threads-overview Overview
+
+When Lomse is built with threads support (build option <tt>LOMSE_ENABLE_THREADS</tt>, enabled by default), a single LomseDoorway object can be shared by several threads. This allows, for instance, a server to import, lay out and render many documents concurrently, using a pool of worker threads, without having to create a LomseDoorway object for each thread.
+
+The rule is simple: the LomseDoorway object and the library wide objects it owns (fonts, music glyphs, logger, etc.) can be used by any number of threads at the same time, but each document, and all the objects created for it (the Presenter, the Interactors, the Views and the graphic model) must be used by only one thread at a time. For example:
+
+@code
+void render_score(LomseDoorway& lomse, const std::string& filename, std::ostream& svg)
+{
+    //each thread creates and uses its own documents
+    Presenter* pPresenter = lomse.open_document(k_view_vertical_book, filename);
+    Interactor* pIntor = pPresenter->get_interactor_raw_ptr(0);
+    pIntor->render_as_svg(svg, 0);
+    delete pPresenter;
+}
+
+...
+LomseDoorway lomse;
+lomse.init_library(k_pix_format_rgba32, 96);
+
+std::vector<std::thread> workers;
+for (const std::string& filename : files)
+    workers.push_back( std::thread(render_score, std::ref(lomse), filename, ...) );
+@endcode
+
+
+
+@section threads-rules Things to take into account
+
+- <b>Configuration.</b> The library configuration (fonts path, music font, MusicXML import options, spacing parameters, etc.) is not protected. It must be done before starting the threads that use Lomse, and it must not be changed while those threads are running.
+
+- <b>Fonts.</b> Measuring and rendering text requires a font engine, and font engines keep state (the current font and its size). Therefore, Lomse creates a font engine for each thread that uses it. The font engines are kept until the LomseDoorway object is deleted. Thus, if your application creates many short lived threads it is better to use a fixed size pool of threads.
+
+- <b>Callbacks.</b> Callbacks and event handlers, e.g. the request for the rendering buffer or the notification of a document change, are invoked from the thread that is processing the document. Your application is responsible of any synchronization needed in these callbacks.
+
+- <b>Logging.</b> The logging system is shared by all threads. Messages from different threads are not mixed, but their order in the log is not determined.
+
+*/
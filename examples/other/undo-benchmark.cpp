@@ -0,0 +1,143 @@
+// undo-benchmark.cpp
+//
+// Benchmark for the undo of edition commands. Measures the time for undoing the last
+// commands after many insertions in a score, both when undo has to replay all commands
+// from the start of the session and when using the DocCommandExecuter checkpoints.
+// It also measures the time for the first edition of a score, that includes saving a
+// copy of the score for undo. That copy is a deep copy of the whole score, so this
+// time grows with the score size and not with the size of the modification.
+// Feel free to use this example code in any way you see fit (Public Domain)
+//
+// Usage:
+// - build:
+//      g++ -std=c++11 -O2 undo-benchmark.cpp -o undo-benchmark \
+//        `pkg-config --cflags liblomse` `pkg-config --libs liblomse` -lstdc++
+// - run:
+//      ./undo-benchmark [max-edits]
+//
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <chrono>
+#include <cstdlib>
+using namespace std;
+
+#include <lomse_doorway.h>
+#include <lomse_injectors.h>        //LibraryScope
+#include <private/lomse_document_p.h>
+#include <lomse_document_cursor.h>
+#include <lomse_selections.h>
+#include <lomse_command.h>
+using namespace lomse;
+
+static const int k_num_undos = 20;     //the default checkpoints interval
+
+//---------------------------------------------------------------------------------------
+// Returns the source of a score with 'numMeasures' measures
+string score_source(int numMeasures)
+{
+    stringstream src;
+    src << "(score (vers 2.0)(instrument (musicData (clef G)(key D)(time 4 4)";
+    for (int i=0; i < numMeasures; ++i)
+        src << "(n c4 q)(n d4 q)(n e4 q)(n f4 q)(barline)";
+    src << ")))";
+    return src.str();
+}
+
+//---------------------------------------------------------------------------------------
+// Returns the average time, in milliseconds, for undoing one of the last commands
+// after replacing 'numEdits' notes. Notes are replaced by notes of the same duration,
+// so that the score size does not change with the number of edits
+double measure(LibraryScope& libraryScope, int numEdits, bool fCheckpoints)
+{
+    Document doc(libraryScope);
+    doc.from_string( score_source(100) );
+    DocCursor cursor(&doc);
+    SelectionSet selection(&doc);
+    DocCommandExecuter executer(&doc);
+    if (!fCheckpoints)
+        executer.set_checkpoints_policy(size_t(numEdits) + 1, 1.0e12, 2);
+
+    cursor.enter_element();     //points to clef
+    ImoId clefId = (*cursor)->get_id();
+    const char* notes[] = { "(n g4 q v1)", "(n a4 q v1)", "(n b4 q v1)" };
+    for (int i=0; i < numEdits; ++i)
+    {
+        //skip barlines. At end of score go back to first note
+        while (*cursor == nullptr || !(*cursor)->is_note())
+        {
+            if (*cursor == nullptr)
+                cursor.reset_and_point_to(clefId);
+            cursor.move_next();
+        }
+        executer.execute(&cursor, LOMSE_NEW CmdAddNoteRest(notes[i % 3],
+                                                           k_edit_mode_replace),
+                         &selection);
+    }
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int i=0; i < k_num_undos; ++i)
+        executer.undo(&cursor, &selection);
+    chrono::steady_clock::time_point end = chrono::steady_clock::now();
+
+    return chrono::duration<double, milli>(end - start).count() / k_num_undos;
+}
+
+//---------------------------------------------------------------------------------------
+// Returns the time, in milliseconds, for the first edition of a score with
+// 'numMeasures' measures. Only one note is replaced but, before modifying the score,
+// the executer saves a copy of the whole score
+double measure_first_edit(LibraryScope& libraryScope, int numMeasures)
+{
+    Document doc(libraryScope);
+    doc.from_string( score_source(numMeasures) );
+    DocCursor cursor(&doc);
+    SelectionSet selection(&doc);
+    DocCommandExecuter executer(&doc);
+
+    cursor.enter_element();     //points to clef
+    cursor.move_next();         //points to key
+    cursor.move_next();         //points to time
+    cursor.move_next();         //points to first note
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    executer.execute(&cursor, LOMSE_NEW CmdAddNoteRest("(n g4 q v1)",
+                                                       k_edit_mode_replace),
+                     &selection);
+    chrono::steady_clock::time_point end = chrono::steady_clock::now();
+
+    return chrono::duration<double, milli>(end - start).count();
+}
+
+//---------------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    int maxEdits = (argc > 1 ? atoi(argv[1]) : 1000);
+
+    LibraryScope libraryScope(cout);
+
+    cout << "Average time (ms) for undoing one of the last " << k_num_undos
+         << " commands" << endl;
+    cout << setw(8) << "edits" << setw(16) << "replay all" << setw(16)
+         << "checkpoints" << endl;
+
+    for (int numEdits = 125; numEdits <= maxEdits; numEdits *= 2)
+    {
+        double replayAll = measure(libraryScope, numEdits, false);
+        double checkpoints = measure(libraryScope, numEdits, true);
+        cout << fixed << setprecision(2) << setw(8) << numEdits << setw(16)
+             << replayAll << setw(16) << checkpoints << endl;
+    }
+
+    cout << endl << "Time (ms) for the first edition of a score" << endl;
+    cout << setw(8) << "measures" << setw(16) << "first edit" << endl;
+
+    for (int numMeasures = 100; numMeasures <= 3200; numMeasures *= 2)
+    {
+        double firstEdit = measure_first_edit(libraryScope, numMeasures);
+        cout << fixed << setprecision(2) << setw(8) << numMeasures << setw(16)
+             << firstEdit << endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,101 @@
+// xml-tags-benchmark.cpp
+//
+// Micro-benchmark for the conversion from XML element names to tags, as done by
+// the MusicXML, LMD and MNX analysers for each element. Compares the former
+// std::map<string, int> lookup with the XmlTagsTable perfect hash.
+// Feel free to use this example code in any way you see fit (Public Domain)
+//
+// Usage:
+// - build:
+//      g++ -std=c++11 -O2 xml-tags-benchmark.cpp -o xml-tags-benchmark \
+//        `pkg-config --cflags liblomse` `pkg-config --libs liblomse` -lstdc++
+// - run:
+//      ./xml-tags-benchmark [iterations]
+//
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+using namespace std;
+
+#include <lomse_xml_parser.h>
+using namespace lomse;
+
+//Names of frequent MusicXML elements, in the proportions they appear in a
+//typical score, plus some unknown names
+static const XmlTagsTable::Entry k_tags[] =
+{
+    { "accidental",     1 },    { "alter",          2 },    { "attributes",     3 },
+    { "backup",         4 },    { "barline",        5 },    { "beam",           6 },
+    { "chord",          7 },    { "clef",           8 },    { "direction",      9 },
+    { "direction-type", 10 },   { "divisions",      11 },   { "dot",            12 },
+    { "duration",       13 },   { "dynamics",       14 },   { "forward",        15 },
+    { "key",            16 },   { "lyric",          17 },   { "measure",        18 },
+    { "notations",      19 },   { "note",           20 },   { "octave",         21 },
+    { "part",           22 },   { "part-list",      23 },   { "pitch",          24 },
+    { "rest",           25 },   { "score-part",     26 },   { "slur",           27 },
+    { "staff",          28 },   { "stem",           29 },   { "step",           30 },
+    { "tie",            31 },   { "tied",           32 },   { "time",           33 },
+    { "type",           34 },   { "voice",          35 },   { "words",          36 },
+};
+
+static const char* k_input[] =
+{
+    "note", "pitch", "step", "octave", "duration", "voice", "type", "stem", "staff",
+    "note", "pitch", "step", "alter", "octave", "duration", "tie", "voice", "type",
+    "accidental", "stem", "beam", "notations", "tied", "note", "rest", "duration",
+    "voice", "type", "dot", "measure", "attributes", "divisions", "key", "time",
+    "clef", "backup", "forward", "direction", "direction-type", "words", "barline",
+    "print", "sound", "fifths", "mode", "beats", "beat-type", "sign", "line",
+};
+
+//---------------------------------------------------------------------------------------
+template <typename Lookup>
+double measure(const char* title, size_t iterations, Lookup lookup)
+{
+    const size_t numNames = sizeof(k_input) / sizeof(k_input[0]);
+    long checksum = 0;
+
+    auto start = chrono::steady_clock::now();
+    for (size_t i=0; i < iterations; ++i)
+    {
+        for (size_t j=0; j < numNames; ++j)
+            checksum += lookup(k_input[j]);
+    }
+    auto end = chrono::steady_clock::now();
+
+    double seconds = chrono::duration<double>(end - start).count();
+    double rate = double(iterations * numNames) / seconds;
+    cout << title << ": " << static_cast<long>(rate) << " lookups/s"
+         << " (checksum " << checksum << ")" << endl;
+    return rate;
+}
+
+//---------------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    size_t iterations = (argc > 1 ? size_t(atol(argv[1])) : 200000);
+    const size_t numTags = sizeof(k_tags) / sizeof(k_tags[0]);
+
+    //former implementation: std::map, and a std::string created for each element
+    map<string, int> nameToEnum;
+    for (size_t i=0; i < numTags; ++i)
+        nameToEnum[k_tags[i].name] = k_tags[i].tag;
+
+    double mapRate = measure("std::map    ", iterations, [&](const char* name) {
+        map<string, int>::const_iterator it = nameToEnum.find(string(name));
+        return (it != nameToEnum.end() ? it->second : 0);
+    });
+
+    //current implementation
+    XmlTagsTable table(k_tags, numTags, 0);
+
+    double hashRate = measure("XmlTagsTable", iterations, [&](const char* name) {
+        return table.get_tag(name);
+    });
+
+    cout << "Speedup: " << hashRate / mapRate << "x" << endl;
+    return 0;
+}
@@ -0,0 +1,167 @@
+//---------------------------------------------------------------------------------------
+// This file is part of the Lomse library.
+// Copyright (c) 2010-present, Lomse Developers
+//
+// Licensed under the MIT license.
+//
+// See LICENSE and NOTICE.md files in the root directory of this source tree.
+//---------------------------------------------------------------------------------------
+
+#ifndef __LOMSE_ARENA_H__
+#define __LOMSE_ARENA_H__
+
+#include <cstddef>
+#include <vector>
+
+namespace lomse
+{
+
+//---------------------------------------------------------------------------------------
+// Arena: a bump allocator for objects with the same lifetime.
+// Memory is taken from big blocks and it is never released individually: all the
+// memory is released in one go when the arena is cleared or deleted. For objects with
+// a non-trivial destructor, the destructor can be registered in the arena. Registered
+// destructors are invoked, in reverse order of registration, when the arena is cleared.
+class Arena
+{
+protected:
+    struct Destructor
+    {
+        void* pObj;
+        void (*destroy)(void*);
+    };
+
+    size_t m_blockSize;
+    std::vector<char*> m_blocks;
+    char* m_pNext;
+    char* m_pEnd;
+    size_t m_usedBytes;
+    std::vector<Destructor> m_destructors;
+
+public:
+    explicit Arena(size_t blockSize = 64 * 1024);
+    ~Arena();
+
+    Arena(const Arena&) = delete;
+    Arena& operator= (const Arena&) = delete;
+
+    void* allocate(size_t size, size_t align = alignof(std::max_align_t));
+
+    template <typename T>
+    void add_destructor(T* pObj)
+    {
+        Destructor d = { pObj, &destroy<T> };
+        m_destructors.push_back(d);
+    }
+
+    //invoke registered destructors and release all memory
+    void clear();
+
+    //info
+    inline size_t get_used_bytes() const { return m_usedBytes; }
+    inline size_t get_num_blocks() const { return m_blocks.size(); }
+    inline bool is_empty() const { return m_usedBytes == 0; }
+
+protected:
+    void* allocate_in_new_block(size_t size, size_t align);
+
+    template <typename T>
+    static void destroy(void* pObj) { static_cast<T*>(pObj)->~T(); }
+};
+
+
+//---------------------------------------------------------------------------------------
+// NodePool: allocator for the nodes of a tree whose nodes are created and deleted
+// together, as the internal model of a document. Memory is taken from an Arena and
+// it is organized in size classes: deleted nodes are kept in a free list for its size
+// class and their memory is reused for new nodes. Each node is preceded by a small
+// header pointing to its pool, so nodes can be deleted without knowing the pool.
+//
+// Nodes are allocated in the pool that is current in the calling thread (see
+// NodePoolScope) or in the heap when there is no current pool. Therefore, a pool must
+// only be current in one thread at a time.
+//
+// The pool has an owner, but it is not deleted while nodes allocated in it are alive:
+// when the owner releases the pool, it is deleted when its last node is deleted.
+class NodePool
+{
+protected:
+    struct alignas(std::max_align_t) Header
+    {
+        NodePool* pPool;    //nullptr for nodes allocated in the heap
+        size_t sizeClass;
+    };
+
+    struct FreeNode
+    {
+        FreeNode* pNext;
+    };
+
+    enum {
+        k_granularity = 16,
+        k_max_node_size = 1024,
+        k_num_classes = k_max_node_size / k_granularity,
+    };
+
+    Arena m_arena;
+    FreeNode* m_freeLists[k_num_classes];
+    size_t m_liveNodes;
+    bool m_fOwned;
+
+public:
+    NodePool();
+
+    NodePool(const NodePool&) = delete;
+    NodePool& operator= (const NodePool&) = delete;
+
+    //the owner no longer uses the pool
+    void release();
+
+    //info
+    inline size_t get_live_nodes() const { return m_liveNodes; }
+    inline size_t get_used_bytes() const { return m_arena.get_used_bytes(); }
+    inline size_t get_num_blocks() const { return m_arena.get_num_blocks(); }
+
+    //allocation in current pool
+    static NodePool* current();
+    static void* allocate_node(size_t size);
+    static void deallocate_node(void* p);
+
+protected:
+    ~NodePool() {}
+
+    friend class NodePoolScope;
+    static void set_current(NodePool* pPool);
+
+    Header* allocate(size_t sizeClass);
+    void deallocate(Header* pHeader);
+};
+
+//---------------------------------------------------------------------------------------
+// NodePoolScope: helper for making a pool the current one in this thread while this
+// object exists. A nullptr pool suspends the use of the current pool.
+class NodePoolScope
+{
+protected:
+    NodePool* m_pPrevPool;
+
+public:
+    explicit NodePoolScope(NodePool* pPool)
+        : m_pPrevPool(NodePool::current())
+    {
+        NodePool::set_current(pPool);
+    }
+
+    ~NodePoolScope()
+    {
+        NodePool::set_current(m_pPrevPool);
+    }
+
+    NodePoolScope(const NodePoolScope&) = delete;
+    NodePoolScope& operator= (const NodePoolScope&) = delete;
+};
+
+
+}   //namespace lomse
+
+#endif      //__LOMSE_ARENA_H__
@@ -20,6 +20,7 @@
 
 #include <sstream>
 #include <list>
+#include <vector>
 
 ///@cond INTERNALS
 namespace lomse
@@ -31,6 +32,7 @@ class Document;
 class SelectionSet;
 class DocCommandExecuter;
 class OverlappedNoteRest;
+class ScoreCopy;
 
 //---------------------------------------------------------------------------------------
 //edition modes
@@ -71,6 +73,8 @@ protected:
         k_recordable                    = 0x0002,
         k_target_set_in_constructor     = 0x0004,
         k_included_in_composite_cmd     = 0x0008,
+        k_cursor_not_used               = 0x0010,   //set_target() and perform_action()
+                                                    //do not use the cursor
     };
 
     DocCommand(const std::string& name)
@@ -164,6 +168,9 @@ public:
     inline bool is_included_in_composite_cmd() {
         return (m_flags &  k_included_in_composite_cmd) != 0;
     }
+    inline bool uses_cursor() {
+        return (m_flags &  k_cursor_not_used) == 0;
+    }
 
     virtual void update_selection(SelectionSet* UNUSED(pSelection)) {}
     inline void set_final_cursor_pos(ImoId id) { m_idRefresh = id; }
@@ -176,9 +183,19 @@ public:
     virtual int set_target(Document* pDoc, DocCursor* pCursor, SelectionSet* pSelection)=0;
     virtual int perform_action(Document* pDoc, DocCursor* pCursor)=0;
     virtual void undo_action(Document* pDoc, DocCursor* pCursor);
+
+    //Returns the id of the score that will be modified by this command, or
+    //k_no_imoid when the command could modify other parts of the document. Undo
+    //checkpoints then only copy this score. It is invoked after set_target()
+    virtual ImoId get_target_score_id(Document* UNUSED(pDoc),
+                                      DocCursor* UNUSED(pCursor)) { return k_no_imoid; }
 ///@endcond
 
 protected:
+    ImoId find_score_id(Document* pDoc, ImoId id);
+    ImoId find_score_id(Document* pDoc, const std::list<ImoId>& ids);
+    ImoId find_score_id(DocCursor* pCursor);
+
     void log_forensic_data(Document* pDoc, DocCursor* pCursor);
     void set_command_name(const std::string& name, ImoObj* pImo);
     int validate_source(const std::string& source);
@@ -239,6 +256,7 @@ public:
     ///@cond INTERNALS
     //mandatory interface implementation
     int set_target(Document* pDoc, DocCursor* pCursor, SelectionSet* pSelection) override;
+    ImoId get_target_score_id(Document* pDoc, DocCursor* pCursor) override;
     int perform_action(Document* pDoc, DocCursor* pCursor) override;
     void undo_action(Document* pDoc, DocCursor* pCursor) override;
 
@@ -264,11 +282,12 @@ public:
     DocCommand*         pCmd;           ///< ptr. to executed command object.
     DocCursorState      cursorState;    ///< Cursor state before executing the command.
     SelectionState      selState;       ///< SelectionSet before executing the command.
+    double              execTime;       ///< Time (milliseconds) to perform the command.
 
 public:
     /// Constructor
     UndoElement(DocCommand* cmd, DocCursorState state, SelectionState sel)
-        : pCmd(cmd), cursorState(state), selState(sel)
+        : pCmd(cmd), cursorState(state), selState(sel), execTime(0.0)
     {
     }
     ///destructor
@@ -288,15 +307,42 @@ typedef UndoableStack< UndoElement* >   UndoStack;
 //---------------------------------------------------------------------------------------
 /** %DocCommandExecuter class is responsible of maintaining the stack of executed
     commands and performing undo/redo.
+
+    For commands whose undo is based on replaying commands, the executer saves
+    copies of the document model (checkpoints) while commands are executed. Undo
+    restores the nearest checkpoint and replays only the commands after it.
 */
 class DocCommandExecuter
 {
-private:
+protected:
+    //State of the document before executing the command at position 'index' in the
+    //undo stack. Only what is modified after it is saved, just before modifying it:
+    //a copy of each modified score or, when commands could modify other parts of the
+    //document, a copy of the whole model. While nothing is saved, the document is
+    //in that state. Copies are deep copies, so the first modification of a score
+    //after a checkpoint costs a copy of the whole score.
+    struct Checkpoint
+    {
+        size_t      index;
+        DocModel*   pModel;                 //copy of the whole model, or nullptr
+        std::vector<ScoreCopy*> scores;     //copies of the modified scores
+        ImoId       idCounter;              //IdAssigner counter in that state
+    };
+
     Document*   m_pDoc = nullptr;           //the document to edit
-    DocModel*   m_pModelStart = nullptr;    //document state at start of edition
+    std::vector<Checkpoint> m_checkpoints;  //ascending index. First one is start state
     UndoStack   m_stack;                    //stack of executed commands
     std::string m_error;
 
+    //policy for saving checkpoints
+    size_t      m_checkpointInterval = 20;      //max. number of commands to replay
+    double      m_checkpointBudget = 250.0;     //max. replay time, in milliseconds
+    size_t      m_maxCheckpoints = 16;
+
+    //in a transaction, cursor update is deferred until the cursor is needed
+    DocCommand* m_pPendingCmd = nullptr;        //command whose cursor update is pending
+    DocCursor*  m_pPendingCursor = nullptr;
+
 public:
     /// Constructor
     DocCommandExecuter(Document* target);
@@ -333,14 +379,62 @@ public:
     bool is_redo_possible() { return m_stack.history_size() > 0; }
     /// Returns the number of undo/redo elements in the undo/redo stack.
     virtual size_t undo_stack_size() { return m_stack.size(); }
+    /// Returns the number of document model copies saved for undo.
+    size_t num_checkpoints() { return m_checkpoints.size(); }
+
+    //settings
+    /** Sets the policy for saving copies of the document model (checkpoints), used
+        for undo. A checkpoint is saved before executing a command when
+        @c numCommands commands have been executed since the previous checkpoint, or
+        when executing them took more than @c millisecs milliseconds. So, undo will
+        replay, at most, these commands. For limiting the memory used, at most
+        @c maxCheckpoints are kept. When exceeded, old checkpoints are removed
+        first, so that the undo of recent commands remains fast.
+        Default values are 20 commands, 250 ms and 16 checkpoints.
+    */
+    void set_checkpoints_policy(size_t numCommands, double millisecs,
+                                size_t maxCheckpoints);
+
+    //transactions
+    /** Starts a batch of commands. It opens a transaction in the document (see
+        Document::begin_transaction()), so that the `k_doc_modified_event`, and thus
+        the rebuild of the graphic model in views, is done only once, when the batch
+        is committed. Each command is still saved in the undo/redo stack.
+
+        The cursor is not updated after each command but when it is needed: before
+        executing a command that uses the cursor, before undo/redo and when the
+        batch is committed. Therefore, a batch of commands that do not use the
+        cursor (e.g. commands acting on the selection) updates the modified scores
+        only once. The cursor and selection passed to the commands in the batch
+        must remain valid until the batch is committed.
+    */
+    void begin_transaction();
+
+    /** Finishes a batch of commands started with begin_transaction(). When this is
+        the outer transaction, the deferred updates are performed. */
+    void commit_transaction();
 
 protected:
     friend class DocCmdComposite;
     void update_cursor(DocCursor* pCursor, DocCommand* pCmd);
     void update_selection(SelectionSet* pSelection, DocCommand* pCmd);
+    void update_cursor_or_defer(DocCursor* pCursor, DocCommand* pCmd);
+    void update_pending_cursor();
+    bool is_pending_cursor_needed(DocCursor* pCursor, DocCommand* pCmd);
 
     void replay_until(UndoElement* pUE, DocCursor* pCursor, SelectionSet* pSelection);
-    void replay_command(UndoElement* pUE, DocCursor* pCursor, SelectionSet* pSelection);
+    void replay_command(size_t index, DocCursor* pCursor, SelectionSet* pSelection);
+
+    //checkpoints
+    void save_checkpoint(size_t index, DocCommand* pCmd, DocCursor* pCursor);
+    bool is_checkpoint_needed(size_t index);
+    void save_whole_model(Checkpoint& cp, DocModel* pModel);
+    void restore_last_checkpoint();
+    void remove_checkpoints_after(size_t index);
+    void limit_checkpoints();
+    void remove_checkpoint(size_t i);
+    ScoreCopy* find_score_copy(Checkpoint& cp, ImoId scoreId);
+    void delete_checkpoint_data(Checkpoint& cp);
 
 };
 
@@ -415,6 +509,7 @@ public:
 
     ///@cond INTERNALS
     int set_target(Document* pDoc, DocCursor* pCursor, SelectionSet* pSelection) override;
+    ImoId get_target_score_id(Document* pDoc, DocCursor* pCursor) override;
     int perform_action(Document* pDoc, DocCursor* pCursor) override;
     ///@endcond
 
@@ -494,6 +589,7 @@ public:
 
     ///@cond INTERNALS
     int set_target(Document* pDoc, DocCursor* pCursor, SelectionSet* pSelection) override;
+    ImoId get_target_score_id(Document* pDoc, DocCursor* pCursor) override;
     int perform_action(Document* pDoc, DocCursor* pCursor) override;
     ///@endcond
 
@@ -514,11 +610,16 @@ protected:
     std::string m_finalSrc;
     std::list<ImoStaffObj*> m_insertedObjs;
     ImoNoteRest* m_pLastOverlapped;
+    bool m_fUpdateAll;                  //changes not confined to some measures
+    ImoStaffObj* m_pFirstAffected;      //object before the modified ones
+    ImoStaffObj* m_pLastAffected;       //object after the modified ones
 
     void get_data_about_insertion_point();
     void get_data_about_noterest_to_insert();
     void find_and_classify_overlapped_noterests();
     void determine_insertion_point();
+    void determine_affected_objects();
+    bool is_overlapped(ImoObj* pImo);
     void add_new_note_to_existing_beam_if_necessary();
     void reduce_duration_of_overlapped_at_end();
     void remove_fully_overlapped();
@@ -584,6 +685,7 @@ public:
 
     ///@cond INTERNALS
     int set_target(Document* pDoc, DocCursor* pCursor, SelectionSet* pSelection) override;
+    ImoId get_target_score_id(Document* pDoc, DocCursor* pCursor) override;
     int perform_action(Document* pDoc, DocCursor* pCursor) override;
     ///@endcond
 
@@ -651,6 +753,7 @@ public:
 
     ///@cond INTERNALS
     int set_target(Document* pDoc, DocCursor* pCursor, SelectionSet* pSelection) override;
+    ImoId get_target_score_id(Document* pDoc, DocCursor* pCursor) override;
     int perform_action(Document* pDoc, DocCursor* pCursor) override;
     ///@endcond
 
@@ -708,6 +811,7 @@ public:
 
     ///@cond INTERNALS
     int set_target(Document* pDoc, DocCursor* pCursor, SelectionSet* pSelection) override;
+    ImoId get_target_score_id(Document* pDoc, DocCursor* pCursor) override;
     int perform_action(Document* pDoc, DocCursor* pCursor) override;
     ///@endcond
 
@@ -715,6 +819,24 @@ protected:
     void log_command(ostream &logger) override;
 };
 
+///@cond INTERNALS
+//---------------------------------------------------------------------------------------
+// NotePitchImage: the pitch of a note before being modified by a command. Commands
+// changing pitch save it, so that undo just restores the saved values instead of
+// replaying all previous commands
+struct NotePitchImage
+{
+    ImoId           id;
+    int             step;
+    int             octave;
+    float           actualAcc;
+    EAccidentals    notatedAcc;
+
+    NotePitchImage(ImoNote* pNote);
+    void restore(ImoNote* pNote) const;
+};
+///@endcond
+
 //---------------------------------------------------------------------------------------
 /** A command for changing the accidentals of the selected notes.
 
@@ -725,7 +847,7 @@ class CmdChangeAccidentals : public DocCmdSimple
 protected:
     EAccidentals m_acc;
     std::list<ImoId> m_notes;
-    std::list<FPitch> m_oldPitch;
+    std::list<NotePitchImage> m_oldPitch;
 
 public:
     /**
@@ -760,12 +882,14 @@ public:
     virtual ~CmdChangeAccidentals() {};
 
     int get_cursor_update_policy() override { return k_do_nothing; }
-    int get_undo_policy() override { return k_undo_policy_replay_from_start; }
+    int get_undo_policy() override { return k_undo_policy_specific; }
     int get_selection_update_policy() override { return k_sel_do_nothing; }
 
     ///@cond INTERNALS
     int set_target(Document* pDoc, DocCursor* pCursor, SelectionSet* pSelection) override;
+    ImoId get_target_score_id(Document* pDoc, DocCursor* pCursor) override;
     int perform_action(Document* pDoc, DocCursor* pCursor) override;
+    void undo_action(Document* pDoc, DocCursor* pCursor) override;
     ///@endcond
 
 protected:
@@ -789,6 +913,13 @@ protected:
     int             m_newInt;
     Color           m_newColor;
 
+    //values before executing the command, for undo
+    bool            m_fOldExists = false;   //the attribute was in the attributes list
+    std::string     m_oldString;
+    double          m_oldDouble = 0.0;
+    int             m_oldInt = 0;
+    Color           m_oldColor;
+
 public:
 
     ///@{
@@ -917,17 +1048,20 @@ public:
     virtual ~CmdChangeAttribute() {};
 
     int get_cursor_update_policy() override { return k_do_nothing; }
-    int get_undo_policy() override { return k_undo_policy_replay_from_start; }
+    int get_undo_policy() override { return k_undo_policy_specific; }
     int get_selection_update_policy() override { return k_sel_do_nothing; }
 
     ///@cond INTERNALS
     int set_target(Document* pDoc, DocCursor* pCursor, SelectionSet* pSelection) override;
+    ImoId get_target_score_id(Document* pDoc, DocCursor* pCursor) override;
     int perform_action(Document* pDoc, DocCursor* pCursor) override;
+    void undo_action(Document* pDoc, DocCursor* pCursor) override;
     ///@endcond
 
 protected:
     void set_default_name();
     int set_target(ImoObj* pImo);
+    void save_old_value(ImoObj* pImo);
 
 };
 
@@ -941,6 +1075,7 @@ class CmdChangeDots : public DocCmdSimple
 protected:
     int m_dots;
     std::list<ImoId> m_noteRests;
+    std::list<int> m_oldDots;       //dots before executing the command, for undo
 
 public:
     /**
@@ -974,14 +1109,19 @@ public:
     virtual ~CmdChangeDots() {};
 
     int get_cursor_update_policy() override { return k_refresh; }
-    int get_undo_policy() override { return k_undo_policy_replay_from_start; }
+    int get_undo_policy() override { return k_undo_policy_specific; }
     int get_selection_update_policy() override { return k_sel_do_nothing; }
 
     ///@cond INTERNALS
     int set_target(Document* pDoc, DocCursor* pCursor, SelectionSet* pSelection) override;
+    ImoId get_target_score_id(Document* pDoc, DocCursor* pCursor) override;
     int perform_action(Document* pDoc, DocCursor* pCursor) override;
+    void undo_action(Document* pDoc, DocCursor* pCursor) override;
     ///@endcond
 
+protected:
+    void update_staffobjs_table(Document* pDoc);
+
 };
 
 //---------------------------------------------------------------------------------------
@@ -1299,6 +1439,9 @@ public:
 
 protected:
     virtual void prepare_cursor_for_deletion(DocCursor* pCursor);
+    bool find_affected_objects(Document* pDoc, const std::list<ImoId>& ids,
+                               ImoInstrument** ppInstr, ImoStaffObj** ppFirst,
+                               ImoStaffObj** ppLast);
 
     friend class DocCommandExecuter;
     inline ImoId cursor_final_pos_id() { return m_cursorFinalId; }
@@ -1406,6 +1549,7 @@ public:
 
     ///@cond INTERNALS
     int set_target(Document* pDoc, DocCursor* pCursor, SelectionSet* pSelection) override;
+    ImoId get_target_score_id(Document* pDoc, DocCursor* pCursor) override;
     int perform_action(Document* pDoc, DocCursor* pCursor) override;
     ///@endcond
 
@@ -1464,6 +1608,7 @@ public:
 
     ///@cond INTERNALS
     int set_target(Document* pDoc, DocCursor* pCursor, SelectionSet* pSelection) override;
+    ImoId get_target_score_id(Document* pDoc, DocCursor* pCursor) override;
     int perform_action(Document* pDoc, DocCursor* pCursor) override;
     ///@endcond
 
@@ -1536,6 +1681,7 @@ public:
 
     ///@cond INTERNALS
     int set_target(Document* pDoc, DocCursor* pCursor, SelectionSet* pSelection) override;
+    ImoId get_target_score_id(Document* pDoc, DocCursor* pCursor) override;
     int perform_action(Document* pDoc, DocCursor* pCursor) override;
     ///@endcond
 };
@@ -1691,6 +1837,7 @@ public:
 
     ///@cond INTERNALS
     int set_target(Document* pDoc, DocCursor* pCursor, SelectionSet* pSelection) override;
+    ImoId get_target_score_id(Document* pDoc, DocCursor* pCursor) override;
     int perform_action(Document* pDoc, DocCursor* pCursor) override;
     ///@endcond
 
@@ -1752,6 +1899,7 @@ public:
 
     ///@cond INTERNALS
     int set_target(Document* pDoc, DocCursor* pCursor, SelectionSet* pSelection) override;
+    ImoId get_target_score_id(Document* pDoc, DocCursor* pCursor) override;
     int perform_action(Document* pDoc, DocCursor* pCursor) override;
     ///@endcond
 };
@@ -1807,6 +1955,7 @@ public:
 
     ///@cond INTERNALS
     int set_target(Document* pDoc, DocCursor* pCursor, SelectionSet* pSelection) override;
+    ImoId get_target_score_id(Document* pDoc, DocCursor* pCursor) override;
     int perform_action(Document* pDoc, DocCursor* pCursor) override;
     ///@endcond
 
@@ -1851,6 +2000,7 @@ public:
 
     ///@cond INTERNALS
     int set_target(Document* pDoc, DocCursor* pCursor, SelectionSet* pSelection) override;
+    ImoId get_target_score_id(Document* pDoc, DocCursor* pCursor) override;
     int perform_action(Document* pDoc, DocCursor* pCursor) override;
     void undo_action(Document* pDoc, DocCursor* pCursor) override;
     ///@endcond
@@ -1991,6 +2141,10 @@ protected:
     std::list<ImoId> m_notes;
     std::list<ImoId> m_keys;
 
+    //values before executing the command, for undo
+    std::list<NotePitchImage> m_oldPitch;
+    std::list< std::pair<ImoId, int> > m_oldKeys;   //key id, key type
+
     CmdTranspose(const std::string& name="");
 
 public:
@@ -1998,12 +2152,14 @@ public:
     virtual ~CmdTranspose() {};
 
     int get_cursor_update_policy() override { return k_do_nothing; }
-    int get_undo_policy() override { return k_undo_policy_replay_from_start; }
+    int get_undo_policy() override { return k_undo_policy_specific; }
     int get_selection_update_policy() override { return k_sel_do_nothing; }
 
     ///@cond INTERNALS
     int set_target(Document* pDoc, DocCursor* pCursor, SelectionSet* pSelection) override;
+    ImoId get_target_score_id(Document* pDoc, DocCursor* pCursor) override;
     int perform_action(Document* pDoc, DocCursor* pCursor) override;
+    void undo_action(Document* pDoc, DocCursor* pCursor) override;
     ///@endcond
 
 protected:
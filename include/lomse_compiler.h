@@ -53,6 +53,7 @@ public:
     //compilation
     virtual ImoDocument* compile_file(const std::string& filename)=0;
     virtual ImoDocument* compile_string(const std::string& source)=0;
+    virtual ImoDocument* compile_buffer(const void* buffer, size_t size);
 
     //info
     virtual int get_num_errors() const;
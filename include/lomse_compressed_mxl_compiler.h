@@ -20,7 +20,9 @@ class MxlCompiler;
 class ZipInputStream;
 
 //---------------------------------------------------------------------------------------
-// CompressedMxlCompiler: builds the tree for a document
+// CompressedMxlCompiler: builds the tree for a document from a compressed MusicXML
+// (.mxl) file or from a compressed MusicXML archive in memory.
+// The rootfile is inflated directly into the parser, without intermediate copies
 class CompressedMxlCompiler : public Compiler
 {
 protected:
@@ -33,13 +35,15 @@ public:
     //compilation
     ImoDocument* compile_file(const std::string& filename) override;
     ImoDocument* compile_string(const std::string& source) override;
+    ImoDocument* compile_buffer(const void* buffer, size_t size) override;
 
     //info
     int get_num_errors() const override;
 
 protected:
+    ImoDocument* compile_archive(ZipInputStream& zip);
     std::string get_rootfile_path(ZipInputStream&);
-    std::vector<unsigned char> read_rootfile(ZipInputStream&);
+    bool open_rootfile(ZipInputStream&);
 };
 
 
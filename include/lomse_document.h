@@ -12,6 +12,7 @@
 
 #include "lomse_internal_model.h"
 #include "private/lomse_document_p.h"
+#include "lomse_import_stats.h"
 
 
 namespace lomse
@@ -98,6 +99,14 @@ public:
 
     void end_of_changes();
 
+    //Transactions
+    void begin_transaction();
+    void commit_transaction();
+    void flush_deferred_changes();
+
+    //Diagnostics
+    const ImportStats& import_stats() const;
+
     // Transitional, to facilitate migration to the new public API.
     // Notice that this method will be removed in future so, please, if you need to
     // use this method open an issue at https://github.com/lenmus/lomse/issues
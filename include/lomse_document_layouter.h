@@ -41,6 +41,9 @@ protected:
     //for unit tests: need to access ScoreLayouter.
     Layouter* m_pScoreLayouter;
 
+    //graphic model before the document changes, for reusing parts of it
+    GraphicModel* m_pPrevGModel;
+
 public:
     DocLayouter(Document* pDoc, LibraryScope& libraryScope, int constrains=0,
                 LUnits width=0.0f);
@@ -48,6 +51,7 @@ public:
 
     void layout_document();
     void layout_empty_document();
+    void update_document(GraphicModel* pPrevGModel);
 
     //implementation of virtual methods in Layouter base class
     void layout_in_box() override {}
@@ -58,11 +62,15 @@ public:
     //only for unit tests
     ScoreLayouter* get_score_layouter();
     void save_score_layouter(Layouter* pLayouter) override;
+    GraphicModel* get_previous_graphic_model() override { return m_pPrevGModel; }
 
 protected:
     int layout_content();
     void fix_document_size();
     void delete_last_trial();
+    bool can_reuse_previous_model();
+    bool has_changes_other_than_scores();
+    void delete_previous_model();
 
     GmoBoxDocPage* create_document_page();
     void assign_paper_size_to(GmoBox* pBox);
@@ -301,6 +301,11 @@ public:
             - Document::k_format_ldp = 0, for LenMus documents in LDP syntax.
             - Document::k_format_lmd = 1, for LenMus documents in XML syntax (LMD format).
             - Document::k_format_mxl = 2, for MusicXML documents
+            - Document::k_format_mxl_compressed = 3, for compressed MusicXML documents.
+              In this case, @a source must contain the binary content of the .mxl file.
+            - Document::k_format_snapshot = 5, for Lomse binary snapshots created with
+              Document::save_snapshot(). In this case, @a source must contain the
+              binary content of the snapshot.
         @param reporter The ostream to be used for reporting any errors. By default,
             all errors will be send to cout.
         @param screenDrawer  The Drawer to use as main drawer. Ownership of this Drawer
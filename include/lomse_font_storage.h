@@ -29,6 +29,10 @@
 //std
 #include <string>
 #include <map>
+#if (LOMSE_ENABLE_THREADS == 1)
+    #include <mutex>
+    #include <thread>
+#endif
 using namespace std;
 
 using namespace agg;
@@ -48,34 +52,64 @@ typedef lomse::font_cache_manager<FontEngine>::gray8_adaptor_type   Gray8Adaptor
 typedef lomse::font_cache_manager<FontEngine>::gray8_scanline_type  Gary8Scanline;
 
 
+//---------------------------------------------------------------------------------------
+// FontEngineState: a font engine, its glyphs cache and the currently selected font.
+// FontStorage keeps one of these for each thread using it
+struct FontEngineState
+{
+    FontEngine          fontEngine;
+    FontCacheManager    fontCacheManager;
+    double  fontHeight;
+    double  fontWidth;
+    bool    fValidFont;         //there is a font loaded
+    EFontCacheType      fontCacheType;
+    string  fontFullName;
+
+    FontEngineState()
+        : fontEngine(1000)      //1000 = number of faces in cache
+        , fontCacheManager(fontEngine)
+        , fontHeight(14.0)
+        , fontWidth(14.0)
+        , fValidFont(false)
+        , fontCacheType(k_raster_font_cache)
+    {
+    }
+};
+
 // FontStorage: Provides fonts and glyphs
+//
+// FontStorage is shared by all documents in a LibraryScope but it can be used
+// concurrently from several threads: each thread has its own font engine, glyphs
+// cache and selected font, created the first time the thread uses the FontStorage
+// and released when the FontStorage is deleted. Therefore, selecting a font and
+// using it must be done in the same thread.
 //---------------------------------------------------------------------------------------
 class FontStorage
 {
 protected:
-    FontEngine          m_fontEngine;
-    FontCacheManager    m_fontCacheManager;
     LibraryScope*       m_pLibScope;
-
-    double  m_fontHeight;
-    double  m_fontWidth;
     bool    m_fHinting;
-    bool    m_fValidFont;       //there is a font loaded
     bool    m_fKerning;
     bool    m_fFlip_y;
-    EFontCacheType      m_fontCacheType;
-    string m_fontFullName;
+    unsigned long       m_serial;       //unique number to identify this FontStorage
+
+#if (LOMSE_ENABLE_THREADS == 1)
+    std::mutex m_mutex;
+    std::map<std::thread::id, FontEngineState*> m_engines;
+#else
+    FontEngineState* m_pEngine = nullptr;
+#endif
 
 public:
     FontStorage(LibraryScope* pLibScope);
     ~FontStorage();
 
-    inline bool is_font_valid() { return m_fValidFont; }
+    inline bool is_font_valid() { return fonts().fValidFont; }
 
-    inline double get_font_height_in_points() { return m_fontHeight; }
-    inline double get_ascender() { return m_fontEngine.ascender(); }
-    inline double get_descender() { return m_fontEngine.descender(); }
-    inline const string& get_font_file() { return m_fontFullName; }
+    inline double get_font_height_in_points() { return fonts().fontHeight; }
+    inline double get_ascender() { return fonts().fontEngine.ascender(); }
+    inline double get_descender() { return fonts().fontEngine.descender(); }
+    inline const string& get_font_file() { return fonts().fontFullName; }
 
     void set_font_size(double rPoints);
     void set_font_height(double rPoints);
@@ -96,26 +130,31 @@ public:
 
     //transitional. For Calligrapher
     inline const lomse::glyph_cache* get_glyph_cache(unsigned int nChar) {
-        return m_fontCacheManager.glyph(nChar);
+        return fonts().fontCacheManager.glyph(nChar);
     }
     inline void add_kerning(double* x, double* y) {
         if(m_fKerning)
-            m_fontCacheManager.add_kerning(x, y);
+            fonts().fontCacheManager.add_kerning(x, y);
     }
     inline void init_adaptors(const lomse::glyph_cache* glyph, double x, double y) {
-        m_fontCacheManager.init_embedded_adaptors(glyph, x, y);
+        fonts().fontCacheManager.init_embedded_adaptors(glyph, x, y);
     }
     inline Gray8Adaptor& get_gray8_adaptor() {
-        return m_fontCacheManager.gray8_adaptor();
+        return fonts().fontCacheManager.gray8_adaptor();
     }
     inline Gary8Scanline& get_gray8_scanline() {
-        return m_fontCacheManager.gray8_scanline();
+        return fonts().fontCacheManager.gray8_scanline();
     }
     inline void set_transform(agg::trans_affine& mtx) {
-        m_fontEngine.transform(mtx);
+        fonts().fontEngine.transform(mtx);
     }
 
+    //info
+    int get_num_font_engines();
+
 protected:
+    FontEngineState& fonts();
+    FontEngineState* create_font_engine();
     bool set_font(const std::string& fontFullName, double height,
                   EFontCacheType type = k_raster_font_cache);
 
@@ -129,16 +168,27 @@ class FontSelector
 protected:
     LibraryScope* m_pLibScope;
     std::map<string, string> m_cache;
+#if (LOMSE_ENABLE_THREADS == 1)
+    std::mutex m_mutex;
+#endif
 
 public:
     FontSelector(LibraryScope* pLibScope) : m_pLibScope(pLibScope) {}
     ~FontSelector() {}
 
+    //thread safe
     std::string find_font(const std::string& language,
                           const std::string& fontFile,
                           const std::string& name,
                           bool fBold=false, bool fItalic=false);
 
+protected:
+    //platform dependent. Code is in file platform/lomse_<platform>.cpp
+    std::string find_platform_font(const std::string& language,
+                                   const std::string& fontFile,
+                                   const std::string& name,
+                                   bool fBold, bool fItalic);
+
 };
 
 
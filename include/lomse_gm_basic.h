@@ -90,6 +90,30 @@ public:
     /** Returns the table of measures for this score */
     inline GmMeasuresTable* get_measures_table() { return m_measures; }
 
+    /** Information about the staffobjs contained in a system. It is used for deciding
+        the systems that can be reused when the score is modified.
+    */
+    struct SystemContent
+    {
+        int iFirstEntry;        //index of first ColStaffObjs entry in the system
+        int numEntries;         //number of ColStaffObjs entries in the system
+        size_t signature;       //hash of the entries and their attached objects
+        size_t prologSignature; //hash of the clefs, keys and times in system prolog
+        LUnits uPrevFreeSpace;  //free space at bottom of previous system when engraving
+                                //this one, or -1 when first system in page
+        LUnits uFreeAtBottom;   //free space at bottom of this system after engraving it
+        bool fEndsInBarline;    //last entry is a barline
+        bool fPendingRelObjs;   //some RelObjs or lyrics continue in next system
+    };
+
+    inline void add_system_content(const SystemContent& data) {
+        m_systems.push_back(data);
+    }
+    inline std::vector<SystemContent>& get_systems_content() { return m_systems; }
+
+protected:
+    std::vector<SystemContent> m_systems;
+
 };
 ///@endcond
 
@@ -515,6 +539,7 @@ public:
     //child boxes
     inline int get_num_boxes() { return static_cast<int>( m_childBoxes.size() ); }
     void add_child_box(GmoBox* child);
+    void remove_child_box(GmoBox* child);
     GmoBox* get_child_box(int i);  //i = 0..n-1
     inline std::vector<GmoBox*>& get_child_boxes() { return m_childBoxes; }
 
@@ -42,6 +42,8 @@ public:
     //creation
     //invoked when a non-middle barline is found
     void finish_measure(int iInstr, GmoShapeBarline* pBarlineShape);
+    //invoked when the shape for a barline is replaced by other for the same barline
+    void replace_barline_shape(int iInstr, GmoShapeBarline* pBarlineShape);
 
     //info
     int get_num_measures(int iInstr);
@@ -17,6 +17,7 @@
 using namespace std;
 
 #include "lomse_basic.h"
+#include "lomse_id_table.h"
 #include "lomse_observable.h"
 #include "lomse_events.h"
 
@@ -165,12 +166,13 @@ protected:
     GmoBoxDocument* m_root;
     long m_modelId;
     bool m_modified;
-    map<ImoId, GmoBox*> m_imoToBox;
-    map<ImoId, GmoShape*> m_imoToMainShape;
+    IdTable<GmoBox> m_imoToBox;
+    IdTable<GmoShape> m_imoToMainShape;
     map< pair<ImoId, ShapeId>, GmoShape*> m_imoToSecondaryShape;
     map<GmoRef, GmoObj*> m_ctrolToPtr;
     map<ImoId, ScoreStub*> m_scores;
     AreaInfo m_areaInfo;
+    long m_dirtyMarksRef;       //Document dirty marks when this model was built
 
 public:
 
@@ -344,6 +346,10 @@ public:
     inline bool is_modified() { return m_modified; }
     inline long get_model_id() { return m_modelId; }
 
+    //support for reusing parts of this model after modifying the document
+    inline void set_dirty_marks_ref(long ref) { m_dirtyMarksRef = ref; }
+    inline long get_dirty_marks_ref() { return m_dirtyMarksRef; }
+
     //drawing
     void draw_page(int iPage, UPoint& origin, Drawer* pDrawer, RenderOptions& opt);
     //void highlight_object(ImoStaffObj* pSO, bool value);
@@ -357,6 +363,7 @@ public:
 
     //creation
     ScoreStub* add_stub_for(ImoScore* pScore);
+    ScoreStub* get_stub_for(ImoId scoreId);
     void store_in_map_imo_shape(ImoObj* pImo, GmoShape* pShape);
     void add_to_map_imo_to_box(GmoBox* child);
     void add_to_map_ref_to_box(GmoBox* pBox);
@@ -371,10 +378,6 @@ public:
 
 	///@endcond
 
-
-protected:
-    ScoreStub* get_stub_for(ImoId scoreId);
-
 };
 
 
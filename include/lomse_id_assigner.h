@@ -11,6 +11,7 @@
 #define __LOMSE_ID_ASSIGNER_H__
 
 #include "lomse_basic.h"
+#include "lomse_id_table.h"
 
 #include <map>
 #include <unordered_map>
@@ -31,8 +32,8 @@ class IdAssigner
 {
 protected:
     ImoId m_idCounter;
-    std::unordered_map<ImoId, ImoObj*> m_idToImo;
-    std::unordered_map<ImoId, Control*> m_idToControl;
+    IdTable<ImoObj> m_idToImo;
+    IdTable<Control> m_idToControl;
     std::unordered_map<ImoId, std::string> m_idToXmlId;
     std::map<std::string, ImoId> m_xmlIdToId;
 
@@ -60,11 +61,13 @@ public:
 protected:
     friend class FixModelVisitor;
     friend class DocModel;
+    friend class ImSnapshotArchive;
 
     void add_id(ImoId id, ImoObj* pImo);
     void add_control_id(ImoId id, Control* pControl);
     void copy_strings_from(IdAssigner* pIdAssigner);
     void set_counter(ImoId value) { m_idCounter = value; }
+    ImoId get_counter() const { return m_idCounter; }
     void set_control_id(ImoId id, Control* pControl);
 
 };
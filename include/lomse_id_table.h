@@ -0,0 +1,194 @@
+//---------------------------------------------------------------------------------------
+// This file is part of the Lomse library.
+// Copyright (c) 2010-present, Lomse Developers
+//
+// Licensed under the MIT license.
+//
+// See LICENSE and NOTICE.md files in the root directory of this source tree.
+//---------------------------------------------------------------------------------------
+
+#ifndef __LOMSE_ID_TABLE_H__
+#define __LOMSE_ID_TABLE_H__
+
+#include "lomse_basic.h"
+
+#include <algorithm>
+#include <vector>
+#include <unordered_map>
+
+namespace lomse
+{
+
+//---------------------------------------------------------------------------------------
+// IdTable: a map ImoId -> T* for ids assigned by the IdAssigner counter.
+// As these ids are nearly dense, pointers are stored in a vector indexed by id, and
+// look up is just an index operation. Ids far beyond the current range (e.g. an id
+// written in the LDP source) and negative ids are stored in a hash map, so that the
+// vector does not grow for only one object. Removed entries just leave a null slot, as
+// ids are never reused.
+template <typename T>
+class IdTable
+{
+protected:
+    std::vector<T*> m_dense;                    //index is the id
+    std::unordered_map<ImoId, T*> m_sparse;     //ids out of the dense range
+    size_t m_size = 0;                          //number of entries
+
+    enum { k_min_growth = 1024 };
+
+public:
+    IdTable() {}
+
+    //stores or replaces the pointer for an id. A nullptr value removes the entry
+    void set(ImoId id, T* ptr)
+    {
+        if (ptr == nullptr)
+        {
+            erase(id);
+            return;
+        }
+
+        if (!is_dense(id) && id >= 0 && size_t(id) < max_dense_size())
+            grow_to(size_t(id) + 1);
+
+        if (is_dense(id))
+        {
+            if (m_dense[id] == nullptr)
+                ++m_size;
+            m_dense[id] = ptr;
+        }
+        else
+        {
+            if (m_sparse.find(id) == m_sparse.end())
+                ++m_size;
+            m_sparse[id] = ptr;
+        }
+    }
+
+    T* get(ImoId id) const
+    {
+        if (is_dense(id))
+            return m_dense[id];
+
+        typename std::unordered_map<ImoId, T*>::const_iterator it = m_sparse.find(id);
+        return (it != m_sparse.end() ? it->second : nullptr);
+    }
+
+    //returns true if the id was in the table
+    bool erase(ImoId id)
+    {
+        if (is_dense(id))
+        {
+            if (m_dense[id] == nullptr)
+                return false;
+            m_dense[id] = nullptr;
+        }
+        else if (m_sparse.erase(id) == 0)
+            return false;
+
+        --m_size;
+        return true;
+    }
+
+    void clear()
+    {
+        m_dense.clear();
+        m_sparse.clear();
+        m_size = 0;
+    }
+
+    inline size_t size() const { return m_size; }
+    inline bool empty() const { return m_size == 0; }
+
+    //iteration over all entries, as pairs (id, ptr). Dense ids are visited in
+    //ascending order
+    class const_iterator
+    {
+    protected:
+        const IdTable* m_pTable;
+        size_t m_index;         //in dense vector. Its size when iterating sparse ids
+        typename std::unordered_map<ImoId, T*>::const_iterator m_itSparse;
+        std::pair<ImoId, T*> m_value;
+
+    public:
+        const_iterator() : m_pTable(nullptr), m_index(0) {}
+        const_iterator(const IdTable* pTable, bool fEnd)
+            : m_pTable(pTable)
+            , m_index(fEnd ? pTable->m_dense.size() : 0)
+            , m_itSparse(fEnd ? pTable->m_sparse.end() : pTable->m_sparse.begin())
+        {
+            skip_empty_slots();
+        }
+
+        inline const std::pair<ImoId, T*>& operator*() const { return m_value; }
+        inline const std::pair<ImoId, T*>* operator->() const { return &m_value; }
+
+        const_iterator& operator++()
+        {
+            if (m_index < m_pTable->m_dense.size())
+                ++m_index;
+            else
+                ++m_itSparse;
+            skip_empty_slots();
+            return *this;
+        }
+
+        inline bool operator==(const const_iterator& it) const {
+            return m_index == it.m_index && m_itSparse == it.m_itSparse;
+        }
+        inline bool operator!=(const const_iterator& it) const { return !(*this == it); }
+
+    protected:
+        void skip_empty_slots()
+        {
+            const std::vector<T*>& dense = m_pTable->m_dense;
+            while (m_index < dense.size() && dense[m_index] == nullptr)
+                ++m_index;
+
+            if (m_index < dense.size())
+                m_value = std::make_pair(ImoId(m_index), dense[m_index]);
+            else if (m_itSparse != m_pTable->m_sparse.end())
+                m_value = *m_itSparse;
+        }
+    };
+
+    inline const_iterator begin() const { return const_iterator(this, false); }
+    inline const_iterator end() const { return const_iterator(this, true); }
+
+protected:
+    inline bool is_dense(ImoId id) const
+    {
+        return id >= 0 && size_t(id) < m_dense.size();
+    }
+
+    //the vector can, at most, double its size for a new id
+    inline size_t max_dense_size() const
+    {
+        return m_dense.size() + std::max(size_t(k_min_growth), m_dense.size());
+    }
+
+    void grow_to(size_t minSize)
+    {
+        //grow geometrically, so that moving sparse ids is not done for each new id
+        m_dense.resize(std::max(minSize, m_dense.size() + m_dense.size() / 2), nullptr);
+
+        //move to the vector the ids that now are in the dense range
+        typename std::unordered_map<ImoId, T*>::iterator it = m_sparse.begin();
+        while (it != m_sparse.end())
+        {
+            if (is_dense(it->first))
+            {
+                m_dense[it->first] = it->second;
+                it = m_sparse.erase(it);
+            }
+            else
+                ++it;
+        }
+    }
+
+};
+
+
+} //namespace lomse
+
+#endif    //__LOMSE_ID_TABLE_H__
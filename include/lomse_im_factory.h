@@ -36,6 +36,9 @@ public:
     static ImoObj* inject(int type, DocModel* pDocModel, ImoId id=k_no_imoid);
     static ImoObj* inject(int type, Document* pDoc, ImoId id=k_no_imoid);
 
+    //empty node, to be filled with data restored from a snapshot
+    static ImoObj* restore(int type, DocModel* pDocModel, ImoId id);
+
 
     //specific injectors, to simplify some code and testing
     static ImoNote* inject_note(Document* pDoc, int step, int octave,
@@ -52,6 +55,9 @@ public:
                                   VSize bmpSize, EPixelFormat format, USize imgSize);
     static ImoControl* inject_control(DocModel* pDocModel);
 
+protected:
+    static ImoObj* create_object(int type);
+
 };
 
 
@@ -63,6 +63,7 @@ protected:
 
     //setters
     friend class MeasuresTableBuilder;
+    friend class ImSnapshotArchive;
 	inline void set_timepos(TimeUnits timepos) { m_timepos = timepos; }
 	inline void set_first_id(ImoId id) { m_firstId = id; }
 	inline void set_implied_beat_duration(TimeUnits duration) { m_bottomBeat = duration; }
@@ -108,6 +109,12 @@ public:
     string dump();
 
 protected:
+    friend class MeasuresTableBuilder;
+
+    //for incremental updates
+    void detach_entries(int iFirst, vector<ImMeasuresTableEntry*>& entries);
+    void append_entries(vector<ImMeasuresTableEntry*>::iterator itFirst,
+                        vector<ImMeasuresTableEntry*>::iterator itEnd);
 
 };
 
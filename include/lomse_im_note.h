@@ -78,6 +78,9 @@ public:
     ImoNoteRest(ImoNoteRest&&) = delete;
     ImoNoteRest& operator= (ImoNoteRest&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //overrides to ImoStaffObj
     TimeUnits get_duration() override { return m_duration; }
     void set_time(TimeUnits rTime) override {
@@ -188,6 +191,9 @@ public:
     ImoRest(ImoRest&&) = delete;
     ImoRest& operator= (ImoRest&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     inline bool is_go_fwd() { return m_fGoFwd; }
     inline bool is_full_measure() { return m_fFullMeasureRest; }
 
@@ -238,6 +244,9 @@ public:
     ImoNote(ImoNote&&) = delete;
     ImoNote& operator= (ImoNote&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //options for notated accidentals
     enum ENotatedAcc
     {
@@ -395,6 +404,9 @@ public:
     ImoGraceNote(ImoGraceNote&&) = delete;
     ImoGraceNote& operator= (ImoGraceNote&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     inline void set_align_timepos(TimeUnits value) { m_alignTime = value; }
     inline TimeUnits get_align_timepos() { return m_alignTime; }
 
@@ -0,0 +1,236 @@
+//---------------------------------------------------------------------------------------
+// This file is part of the Lomse library.
+// Copyright (c) 2010-present, Lomse Developers
+//
+// Licensed under the MIT license.
+//
+// See LICENSE and NOTICE.md files in the root directory of this source tree.
+//---------------------------------------------------------------------------------------
+
+#ifndef __LOMSE_IM_SNAPSHOT_H__
+#define __LOMSE_IM_SNAPSHOT_H__
+
+#include "lomse_build_options.h"
+#include "lomse_basic.h"
+#include "lomse_compiler.h"
+
+#include <string>
+#include <vector>
+#include <list>
+#include <map>
+#include <unordered_map>
+#include <ostream>
+#include <type_traits>
+
+namespace lomse
+{
+
+//forward declarations
+class AttrList;
+class AttrObj;
+class DocModel;
+class Document;
+class ImoDocument;
+class ImoObj;
+class ImoRelObj;
+class ImoScore;
+struct TypeMeasureInfo;
+struct TypeTextInfo;
+
+
+//---------------------------------------------------------------------------------------
+// ImSnapshotArchive: a binary archive for saving the internal model, and the derived
+// tables ColStaffObjs and ImMeasuresTable, and for restoring it without running the
+// compilers and the ModelBuilder.
+//
+// The archive is bidirectional: the same method is used for saving and for restoring
+// each piece of data. Each ImoObj saves its content in ImoObj::serialize(), and the
+// archive takes care of the tree structure. Data is stored in the native binary
+// representation, so a snapshot can only be restored by the same library version in
+// the same platform. This is enough for its purpose: a cache of already imported
+// documents.
+class ImSnapshotArchive
+{
+protected:
+    DocModel* m_pDocModel;
+    bool m_fLoading;
+    std::string m_out;              //saved data, when saving
+    const char* m_pData;            //next byte to read, when loading
+    const char* m_pEnd;
+    std::unordered_map<ImoRelObj*, int> m_savedRelObjs;    //relobj -> ordinal
+    std::vector<ImoRelObj*> m_restoredRelObjs;
+
+public:
+    //for saving
+    explicit ImSnapshotArchive(DocModel* pDocModel);
+    //for restoring. Data is not copied
+    ImSnapshotArchive(DocModel* pDocModel, const char* data, size_t size);
+
+    ImSnapshotArchive(const ImSnapshotArchive&) = delete;
+    ImSnapshotArchive& operator= (const ImSnapshotArchive&) = delete;
+
+    //the whole model
+    void save_model(ImoDocument* pImoDoc);
+    ImoDocument* restore_model();
+    inline const std::string& get_saved_data() const { return m_out; }
+
+    inline bool is_loading() const { return m_fLoading; }
+
+    //plain data: numbers, enums and trivially copyable structs and arrays
+    template <typename T>
+    typename std::enable_if< std::is_trivially_copyable<T>::value
+                             && !std::is_pointer<T>::value >::type
+    io(T& value)
+    {
+        io_bytes(&value, sizeof(T));
+    }
+
+    void io_bytes(void* data, size_t size);
+
+    //other data types
+    void io(std::string& value);
+    void io(TypeTextInfo& value);
+    void io(TypeMeasureInfo& value);
+    void io(AttrList& attribs);
+
+    template <typename T>
+    void io(std::vector<T>& items)
+    {
+        size_t num = io_count(items.size());
+        if (m_fLoading)
+            items.resize(num);
+        for (T& item : items)
+            io(item);
+    }
+
+    template <typename T>
+    void io(std::list<T>& items)
+    {
+        size_t num = io_count(items.size());
+        if (m_fLoading)
+            items.resize(num);
+        for (T& item : items)
+            io(item);
+    }
+
+    template <typename K, typename V>
+    void io(std::map<K, V>& items)
+    {
+        size_t num = io_count(items.size());
+        if (m_fLoading)
+        {
+            items.clear();
+            for (size_t i=0; i < num; ++i)
+            {
+                K key;
+                V value = V();
+                io(key);
+                io(value);
+                items[key] = value;
+            }
+        }
+        else
+        {
+            for (auto& item : items)
+            {
+                K key = item.first;
+                io(key);
+                io(item.second);
+            }
+        }
+    }
+
+    template <typename A, typename B>
+    void io(std::pair<A, B>& item)
+    {
+        io(item.first);
+        io(item.second);
+    }
+
+    //optional data owned by an ImoObj
+    template <typename T>
+    void io_owned(T*& pData)
+    {
+        bool fExists = (pData != nullptr);
+        io(fExists);
+        if (m_fLoading)
+        {
+            delete pData;
+            pData = (fExists ? LOMSE_NEW T() : nullptr);
+        }
+        if (pData)
+            io(*pData);
+    }
+
+    //nodes of the internal model, including its subtree
+    template <typename T>
+    typename std::enable_if< std::is_base_of<ImoObj, T>::value >::type
+    io(T*& pImo)
+    {
+        ImoObj* pNode = pImo;
+        io_node(pNode);
+        pImo = static_cast<T*>(pNode);
+    }
+
+    void io_node(ImoObj*& pImo);
+
+    //relations are shared by the related objects: the ImoRelObj is saved only once
+    void io_shared(ImoRelObj*& pRO);
+
+    //number of items in a collection. When restoring, the saved number is returned
+    size_t io_count(size_t num);
+
+protected:
+    void io_score_tables(ImoScore* pScore);
+    void check_supported(ImoObj* pImo);
+    void read_error();
+
+};
+
+
+//---------------------------------------------------------------------------------------
+// SnapshotExporter: saves a document in binary snapshot format
+class SnapshotExporter
+{
+protected:
+    ostream& m_reporter;
+
+public:
+    explicit SnapshotExporter(ostream& reporter);
+
+    //returns false when the model can not be saved
+    bool save(DocModel* pDocModel, ostream& out);
+};
+
+
+//---------------------------------------------------------------------------------------
+// SnapshotCompiler: restores a document from a binary snapshot. Instead of parsing
+// and analysing source code, the internal model and its derived tables are directly
+// restored. Snapshot files are memory mapped when possible.
+class SnapshotCompiler : public Compiler
+{
+protected:
+    ostream& m_reporter;
+    int m_numErrors;
+
+public:
+    SnapshotCompiler(Document* pDoc, ostream& reporter);
+    ~SnapshotCompiler() override {}
+
+    //compilation
+    ImoDocument* compile_file(const std::string& filename) override;
+    ImoDocument* compile_string(const std::string& source) override;
+    ImoDocument* compile_buffer(const void* buffer, size_t size) override;
+
+    //info
+    int get_num_errors() const override { return m_numErrors; }
+
+protected:
+    ImoDocument* restore(const char* data, size_t size);
+    void report_error(const std::string& msg);
+};
+
+
+}   //namespace lomse
+
+#endif      //__LOMSE_IM_SNAPSHOT_H__
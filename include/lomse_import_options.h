@@ -60,9 +60,12 @@ namespace lomse
 		<td>When %true, if an score part has pitched notes but the clef is missing,
             the importer will assume a G or an F4 clef, depending on notes pitch
             range.</td></tr>
+	<tr><td>use_parallel_import</td>		<td>false</td>
+		<td>When %true, the <part> elements of a score are analysed concurrently,
+            each one in a different thread.</td></tr>
 	</table>
 
-	@see fix_beams(), use_default_clefs()
+	@see fix_beams(), use_default_clefs(), use_parallel_import()
 */
 class MusicXmlOptions
 {
@@ -76,11 +79,15 @@ private:
             MusicXmlOptionsSettings()
                 : m_fFixBeams(true)
                 , m_fDefaultClef(true)
+                , m_fStreamingImport(false)
+                , m_fParallelImport(false)
             {
             }
 
             bool m_fFixBeams;
             bool m_fDefaultClef;
+            bool m_fStreamingImport;
+            bool m_fParallelImport;
 
     };
 
@@ -100,6 +107,12 @@ public:
 	/** Returns current setting for the 'use_default_clefs' option.    */
     inline bool use_default_clefs() { return m_settings.m_fDefaultClef; }
 
+	/** Returns current setting for the 'use_streaming_import' option.    */
+    inline bool use_streaming_import() { return m_settings.m_fStreamingImport; }
+
+	/** Returns current setting for the 'use_parallel_import' option.    */
+    inline bool use_parallel_import() { return m_settings.m_fParallelImport; }
+
     //setters (only for options that can be changed without rebuilding the object)
     /** Sets the value for 'fix_beams' option. When %true, if beam information is not
         congruent with note type, the importer will fix the beam.    */
@@ -110,6 +123,22 @@ public:
         an F4 clef, depending on notes pitch range.    */
     inline void use_default_clefs(bool value) { m_settings.m_fDefaultClef = value; }
 
+    /** Sets the value for 'use_streaming_import' option. When %true, MusicXML files
+        are read and analysed measure by measure, without loading the whole file in
+        memory. Peak memory is then close to the size of the internal model. */
+    inline void use_streaming_import(bool value) { m_settings.m_fStreamingImport = value; }
+
+    /** Sets the value for 'use_parallel_import' option. When %true, the <part> elements
+        of a MusicXML score are analysed concurrently, each one in a worker thread, and
+        the results are merged when all parts are analysed. Part-groups, lyrics space
+        reserved in the next part and error messages are resolved after merging, so
+        the result is the same than in sequential analysis. The ids assigned to the
+        created objects are the same in all runs but, as they are taken from a
+        different range for each part, they are not the same than in sequential
+        analysis. This option is ignored when
+        streaming import is enabled or when Lomse is built without threads support. */
+    inline void use_parallel_import(bool value) { m_settings.m_fParallelImport = value; }
+
 };
 
 
@@ -0,0 +1,189 @@
+//---------------------------------------------------------------------------------------
+// This file is part of the Lomse library.
+// Copyright (c) 2010-present, Lomse Developers
+//
+// Licensed under the MIT license.
+//
+// See LICENSE and NOTICE.md files in the root directory of this source tree.
+//---------------------------------------------------------------------------------------
+
+#ifndef __LOMSE_IMPORT_STATS_H__
+#define __LOMSE_IMPORT_STATS_H__
+
+#include <string>
+#include <vector>
+#include <chrono>
+
+namespace lomse
+{
+
+//forward declarations
+class DocModel;
+
+
+//---------------------------------------------------------------------------------------
+/** %ImportStats contains the timing and counters for the phases of the import
+    pipeline, for the last Document::from_file(), Document::from_string() or
+    Document::from_buffer() invocation. Use it for knowing which stage is responsible
+    when importing a score takes too long. Example:
+
+    @code
+    ADocument doc = presenter->get_document();
+    const ImportStats& stats = doc.import_stats();
+    for (int i=0; i < ImportStats::k_import_max_phase; ++i)
+    {
+        cout << ImportStats::get_phase_name(i) << ": "
+             << stats.get_elapsed_time(i) << " ms, "
+             << stats.get_nodes_created(i) << " nodes" << endl;
+    }
+    @endcode
+
+    Times are in milliseconds and are exclusive: when a phase is nested in another,
+    as the tables built by the ModelBuilder, its time is not included in the outer
+    phase.
+
+    Nodes created are the internal model objects registered in the document during
+    the phase.
+
+    Optionally, when LibraryScope::set_sample_import_memory() is enabled, the growth
+    of heap memory in use is sampled once at the start and once at the end of the
+    import. This figure is process-wide: allocations done by other threads, for
+    instance other documents being imported concurrently, are also included.
+*/
+class ImportStats
+{
+public:
+    /** Phases of the import pipeline. They are used as index for the getter methods:
+        - <b>k_import_read = 0</b> - reading the source: memory mapping of the file,
+            decompression of compressed MusicXML files.
+        - <b>k_import_parse = 1</b> - tokenizing (LDP) or XML parsing. For MusicXML
+            files it also includes reading the file.
+        - <b>k_import_analyse = 2</b> - analysis of the parsed tree and creation of
+            the internal model. It includes linking the created objects. In MusicXML
+            streaming import mode, reading the source is also included here.
+        - <b>k_import_restore = 3</b> - creation of the internal model from a
+            binary snapshot.
+        - <b>k_import_structurize = 4</b> - ModelBuilder::structurize(), excluding the
+            next three phases.
+        - <b>k_import_staffobjs_table = 5</b> - ColStaffObjsBuilder::build()
+        - <b>k_import_measures_table = 6</b> - MeasuresTableBuilder::build()
+        - <b>k_import_midi = 7</b> - MidiAssigner::assign_midi_data()
+        - <b>k_import_max_phase</b> - Not used as index. It is the number of phases.
+    */
+    enum EImportPhase {
+        k_import_read = 0,
+        k_import_parse,
+        k_import_analyse,
+        k_import_restore,
+        k_import_structurize,
+        k_import_staffobjs_table,
+        k_import_measures_table,
+        k_import_midi,
+        k_import_max_phase,
+    };
+
+protected:
+    typedef std::chrono::steady_clock clock;
+
+    double m_times[k_import_max_phase];
+    long m_nodes[k_import_max_phase];
+    double m_totalTime = 0.0;
+    long long m_processHeapGrowth = -1LL;
+
+    //while recording
+    DocModel* m_pDocModel = nullptr;
+    std::vector<int> m_phases;          //stack of nested phases
+    clock::time_point m_startTime;
+    clock::time_point m_phaseStartTime;
+    long m_phaseStartNodes = 0;
+    long long m_startBytes = -1LL;      //-1: memory is not sampled
+
+public:
+    ImportStats();
+
+    //getters. Times in milliseconds
+    double get_elapsed_time(int phase) const;
+    long get_nodes_created(int phase) const;
+    inline double get_total_time() const { return m_totalTime; }
+
+    /** Increase of heap memory in use, for the whole process, during the import.
+        It is -1 when memory sampling was not enabled or the platform does not
+        provide this information.    */
+    inline long long get_process_heap_growth() const { return m_processHeapGrowth; }
+
+    static const char* get_phase_name(int phase);
+    std::string dump() const;
+
+///@cond INTERNALS
+//excluded from public API. Only for internal use.
+
+    void reset();
+
+    //recording of an import operation
+    void start_recording(DocModel* pDocModel, bool fSampleMemory=false);
+    void end_recording();
+    void enter_phase(int phase);
+    void exit_phase();
+
+    //the import operation being recorded in current thread, or nullptr
+    static ImportStats* current();
+
+protected:
+    void accumulate_current_phase();
+    long count_nodes() const;
+    static long long bytes_in_use();
+
+///@endcond
+};
+
+
+///@cond INTERNALS
+//---------------------------------------------------------------------------------------
+// ImportRecorder: helper for recording the stats of an import operation. The stats
+// are recorded, in current thread, while this object exists.
+class ImportRecorder
+{
+protected:
+    ImportStats* m_pStats;
+    ImportStats* m_pPrevStats;
+
+public:
+    ImportRecorder(ImportStats* pStats, DocModel* pDocModel, bool fSampleMemory=false);
+    ~ImportRecorder();
+
+    ImportRecorder(const ImportRecorder&) = delete;
+    ImportRecorder& operator= (const ImportRecorder&) = delete;
+};
+
+//---------------------------------------------------------------------------------------
+// ImportPhase: helper for timing a phase of the import pipeline. It does nothing when
+// no import is being recorded in current thread, e.g. when the ModelBuilder is invoked
+// after editing a document.
+class ImportPhase
+{
+protected:
+    ImportStats* m_pStats;
+
+public:
+    explicit ImportPhase(int phase)
+        : m_pStats(ImportStats::current())
+    {
+        if (m_pStats)
+            m_pStats->enter_phase(phase);
+    }
+
+    ~ImportPhase()
+    {
+        if (m_pStats)
+            m_pStats->exit_phase();
+    }
+
+    ImportPhase(const ImportPhase&) = delete;
+    ImportPhase& operator= (const ImportPhase&) = delete;
+};
+///@endcond
+
+
+}   //namespace lomse
+
+#endif      //__LOMSE_IMPORT_STATS_H__
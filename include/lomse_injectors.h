@@ -19,6 +19,10 @@
 
 #include <iostream>
 
+#if (LOMSE_ENABLE_THREADS == 1)
+    #include <mutex>
+#endif
+
 namespace lomse
 {
 
@@ -34,6 +38,7 @@ class MxlCompiler;
 class CompressedMxlCompiler;
 class MnxAnalyser;
 class MnxCompiler;
+class SnapshotCompiler;
 class ModelBuilder;
 class Document;
 class LdpFactory;
@@ -63,6 +68,8 @@ class DocCursor;
 class DocCommandExecuter;
 class CaretPositioner;
 class MusicGlyphs;
+class ScopeLock;
+class WorkersPool;
 
 //---------------------------------------------------------------------------------------
 // Trace levels for lines breaker algorithm
@@ -75,9 +82,16 @@ enum ETraceLevelLinesBreaker
 };
 
 //---------------------------------------------------------------------------------------
+// LibraryScope: the library wide objects and settings.
+// When threads are enabled, a LibraryScope can be shared by several threads, each one
+// processing its own documents. Shared objects are lazily created under a lock and
+// each thread gets its own font engine. Settings are not protected and must be
+// defined before starting the threads.
 class LOMSE_EXPORT LibraryScope
 {
 protected:
+    friend class ScopeLock;
+
     ostream& m_reporter;
     LomseDoorway* m_pDoorway;
     LomseDoorway* m_pNullDoorway;
@@ -91,10 +105,17 @@ protected:
     std::string m_sMusicFontPath;
     std::string m_sFontsPath;
     MusicGlyphs* m_pMusicGlyphs;
+#if (LOMSE_ENABLE_THREADS == 1)
+    std::mutex m_mutex;             //for lazy instantiation of shared objects
+    WorkersPool* m_pWorkersPool = nullptr;  //lazy instantiation. Singleton scope.
+#endif
 
     //options
     bool m_fReplaceLocalMetronome;
     MusicXmlOptions m_importOptions;
+    bool m_fParallelEngraving;      //engrave score systems in a pool of threads
+    int m_numEngravingThreads;      //threads in the pool. 0: hardware concurrency
+    bool m_fSampleImportMemory;     //record heap growth in ImportStats
 
     //debug options
     bool m_fJustifySystems;         //if false, prevents systems justification
@@ -127,6 +148,9 @@ public:
     inline std::string& fonts_path() { return m_sFontsPath; }
     EventsDispatcher* get_events_dispatcher();
     FontSelector* get_font_selector();
+#if (LOMSE_ENABLE_THREADS == 1)
+    WorkersPool* get_workers_pool();
+#endif
 
     //callbacks
     void post_event(SpEventInfo pEvent);
@@ -164,6 +188,14 @@ public:
     inline Metronome* get_global_metronome() { return m_pGlobalMetronome; }
     inline bool global_metronome_replaces_local() { return m_fReplaceLocalMetronome; }
     inline MusicXmlOptions* get_musicxml_options() { return &m_importOptions; }
+    inline void set_engrave_systems_in_parallel(bool value) { m_fParallelEngraving = value; }
+    inline bool engrave_systems_in_parallel() { return m_fParallelEngraving; }
+    //number of threads for engraving in parallel, including the calling thread
+    inline void set_num_engraving_threads(int num) { m_numEngravingThreads = num; }
+    inline int get_num_engraving_threads() { return m_numEngravingThreads; }
+    //sample process heap memory at start and end of each import (see ImportStats)
+    inline void set_sample_import_memory(bool value) { m_fSampleImportMemory = value; }
+    inline bool sample_import_memory() { return m_fSampleImportMemory; }
 
     //spacing and lines breaker algorithm parameters
     inline bool use_debug_values() { return m_fUseDbgValues; }
@@ -262,6 +294,10 @@ public:
                                            XmlParser* pParser);
     static MnxCompiler* inject_MnxCompiler(LibraryScope& libraryScope, Document* pDoc);
 
+    //binary snapshots
+    static SnapshotCompiler* inject_SnapshotCompiler(LibraryScope& libraryScope,
+                                                     Document* pDoc);
+
 
     static ModelBuilder* inject_ModelBuilder(DocumentScope& documentScope);
     static Document* inject_Document(LibraryScope& libraryScope,
@@ -160,6 +160,7 @@ protected:
     WpDocument      m_wpDoc;
     View*           m_pView;
     GraphicModel*   m_pGraphicModel;
+    GraphicModel*   m_pPrevGraphicModel;    //invalid GModel, saved for updating it
     Task*           m_pTask;
     DocCursor*      m_pCursor;
     SelectionSet*   m_pSelections;
@@ -1799,6 +1800,8 @@ protected:
 
     void create_graphic_model();
     void delete_graphic_model();
+    void discard_graphic_model();
+    void remove_graphic_model_references();
     bool graphic_model_must_be_updated();
     void request_window_update();
     VRect get_damaged_rectangle();
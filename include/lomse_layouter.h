@@ -74,6 +74,10 @@ public:
     virtual void save_score_layouter(Layouter* pLayouter) {
         m_pParentLayouter->save_score_layouter(pLayouter);
     }
+    virtual GraphicModel* get_previous_graphic_model() {
+        return m_pParentLayouter ? m_pParentLayouter->get_previous_graphic_model()
+                                 : nullptr;
+    }
     inline void set_constrains(int constrains) { m_constrains = constrains; }
 
     inline GraphicModel* get_graphic_model() { return m_pGModel; }
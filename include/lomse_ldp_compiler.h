@@ -58,6 +58,7 @@ public:
 protected:
     ImoDocument* compile_parsed_tree(LdpTree* tree);
     LdpTree* wrap_score_in_lenmusdoc(LdpTree* pParseTree);
+    void delete_parsed_tree(LdpTree* tree);
     void parse_empty_doc();
 
 };
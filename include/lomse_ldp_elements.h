@@ -17,6 +17,7 @@
 #include "lomse_tree.h"
 #include "lomse_visitor.h"
 #include "lomse_basic.h"
+#include "lomse_arena.h"
 
 
 namespace lomse
@@ -283,6 +284,7 @@ protected:
     int m_numLine;          // file line in whicht the elemnt starts or 0
     ImoId m_id;              // for composite: element ID (0..n)
     ImoObj* m_pImo;
+    bool m_fInArena;        // memory owned by an Arena: do not delete
 
     LdpElement();
 
@@ -294,6 +296,7 @@ public:
 
     //getters and setters
 	inline void set_value(const std::string& value) { m_value = value; }
+	inline void set_value(const char* value, size_t size) { m_value.assign(value, size); }
     inline const std::string& get_value() { return m_value; }
     float get_value_as_float();
     inline void set_name(const std::string& name) { m_name = name; }
@@ -315,6 +318,7 @@ public:
     std::string to_string();
     std::string to_string_with_ids();
 
+    inline bool is_in_arena() { return m_fInArena; }
     inline bool is_simple() { return m_fSimple; }
     inline void set_simple() { m_fSimple = true; }
 	inline bool has_children() { return !is_terminal(); }
@@ -344,6 +348,17 @@ class LdpObject : public LdpElement
 		static LdpElement* new_ldp_object()
 			{ LdpObject<type>* o = LOMSE_NEW LdpObject<type>; assert(o!=nullptr); return o; }
 
+        //! static constructor for elements allocated in an arena. They must not be
+        //! deleted: they are destroyed when the arena is cleared
+		static LdpElement* new_ldp_object(Arena& arena)
+        {
+            void* p = arena.allocate(sizeof(LdpObject<type>), alignof(LdpObject<type>));
+            LdpObject<type>* o = new (p) LdpObject<type>;
+            o->m_fInArena = true;
+            arena.add_destructor(o);
+            return o;
+        }
+
         //! implementation of Visitable interface
         void accept_visitor(BaseVisitor& v) override {
 			if (Visitor<LdpObject<type> >* p = dynamic_cast<Visitor<LdpObject<type> >*>(&v))
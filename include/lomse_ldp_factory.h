@@ -36,8 +36,10 @@ public:
     LdpFactory();
 	virtual ~LdpFactory();
 
-	LdpElement* create(const std::string& name, int numLine=0) const;
-	LdpElement* create(ELdpElement type, int numLine=0) const;
+    //When an arena is specified, the element is allocated in it and it must not be
+    //deleted: it is destroyed when the arena is cleared.
+	LdpElement* create(const std::string& name, int numLine=0, Arena* pArena=nullptr) const;
+	LdpElement* create(ELdpElement type, int numLine=0, Arena* pArena=nullptr) const;
 
     const std::string& get_name(ELdpElement type) const;
 
@@ -57,6 +59,15 @@ public:
 	    return elm;
     }
 
+    LdpElement* new_value(ELdpElement type, const char* value, size_t size, int numLine,
+                          Arena* pArena=nullptr)
+    {
+	    LdpElement* elm = create(type, numLine, pArena);
+        elm->set_simple();
+	    elm->set_value(value, size);
+	    return elm;
+    }
+
     LdpElement* new_label(const std::string& value, int numLine=0) {
         return new_value(k_label, value, numLine);
     }
@@ -69,6 +80,23 @@ public:
         return new_value(k_number, value, numLine);
     }
 
+    //versions for values not in a std::string (i.e. views into the source buffer).
+    //The value is copied only once, into the created element
+    LdpElement* new_label(const char* value, size_t size, int numLine,
+                          Arena* pArena=nullptr) {
+        return new_value(k_label, value, size, numLine, pArena);
+    }
+
+    LdpElement* new_string(const char* value, size_t size, int numLine,
+                          Arena* pArena=nullptr) {
+        return new_value(k_string, value, size, numLine, pArena);
+    }
+
+    LdpElement* new_number(const char* value, size_t size, int numLine,
+                          Arena* pArena=nullptr) {
+        return new_value(k_number, value, size, numLine, pArena);
+    }
+
 };
 
 }   //namespace lomse
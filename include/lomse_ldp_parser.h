@@ -53,6 +53,13 @@ public:
         m_tree = nullptr;
     }
 
+    //arena mode: the elements of the parsed trees are allocated in an arena owned by
+    //the parser. The trees must not be deleted: they remain valid until free_arena()
+    //is invoked or the parser is deleted, and then all are destroyed in one go.
+    void use_arena(bool value);
+    void free_arena();
+    inline bool is_using_arena() { return m_fUseArena; }
+
 //    inline int get_num_errors() { return m_numErrors; }
 
 protected:
@@ -74,7 +81,7 @@ protected:
     void Do_WaitingForStartOfElement();
     void Do_WaitingForName();
     void Do_ProcessingParameter();
-    bool must_replace_tag(const std::string& nodename);
+    bool must_replace_tag(LdpToken* pTk);
     void replace_current_tag();
     void terminate_current_parameter();
 
@@ -87,6 +94,8 @@ protected:
     EParsingState   m_state;            // current automata state
     std::stack<pair<EParsingState, LdpElement*> >  m_stack;    // To save current automata state and node
     LdpElement*     m_curNode;             //node in process
+    Arena*          m_pArena;           //for elements, in arena mode
+    bool            m_fUseArena;
 
     // parsing control, options and error variables
 //    bool            m_fDebugMode;
@@ -182,9 +182,6 @@ protected:
     //saved values
     ImoNote* m_pLastNote;
 
-    //tags for xml elements
-    std::map<std::string, int>	m_NameToTag;
-
 public:
     LmdAnalyser(ostream& reporter, LibraryScope& libraryScope, Document* pDoc,
                 XmlParser* parser);
@@ -300,14 +297,15 @@ public:
     }
 
     //-----------------------------------------------------------------------------------
-    inline int get_tag(XmlNode* node) { return name_to_tag( node->name() ); }
+    inline int get_tag(XmlNode* node) { return name_to_tag( node->name_cstr() ); }
 
-    int name_to_tag(const string& name) const;
+    int name_to_tag(const char* name) const;
+    static const XmlTagsTable& get_tags_table();
     bool to_integer(const string& text, int* pResult);
 
 
 protected:
-    LmdElementAnalyser* new_analyser(const string& name, ImoObj* pAnchor=nullptr);
+    LmdElementAnalyser* new_analyser(const char* name, ImoObj* pAnchor=nullptr);
     void delete_relation_builders();
 
     //auxiliary. for ldp notes analysis
@@ -17,6 +17,10 @@
 #include <iomanip>
 #include <fstream>
 #include <string>
+
+#if (LOMSE_ENABLE_THREADS == 1)
+    #include <mutex>
+#endif
 using namespace std;
 
 namespace lomse
@@ -66,6 +70,9 @@ private:
     int m_mode;
     uint_least32_t m_areas;
     bool m_initialized = false;
+#if (LOMSE_ENABLE_THREADS == 1)
+    std::mutex m_mutex;             //messages can be logged from several threads
+#endif
 
 public:
     Logger(int mode=k_normal_mode);
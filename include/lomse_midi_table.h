@@ -195,6 +195,8 @@ protected:
     std::vector< std::pair<int, std::string> > m_targets;          //pair measure, label
     TimeUnits m_rAnacrusisMissingTime;
     TimeUnits m_rAnacrusisExtraTime;
+    std::vector<JumpEntry*> m_pendingVoltaJumps;    //jumps for the current voltas set
+    int m_iVoltaJump;
 
 
 public:
@@ -233,9 +233,6 @@ protected:
 //    int m_nShowTupletBracket;
 //    int m_nShowTupletNumber;
 
-    //conversion from xml element name to int
-    std::map<std::string, int>	m_NameToEnum;
-
 
 public:
     MnxAnalyser(ostream& reporter, LibraryScope& libraryScope, Document* pDoc,
@@ -405,7 +402,8 @@ public:
     int get_line_number(XmlNode* node);
 
 
-    int name_to_enum(const std::string& name) const;
+    int name_to_enum(const char* name) const;
+    static const XmlTagsTable& get_tags_table();
     bool to_integer(const std::string& text, int* pResult);
 
     //public utilities
@@ -431,7 +429,7 @@ public:
 
 protected:
     friend class MnxElementAnalyser;
-    MnxElementAnalyser* new_analyser(const std::string& name, ImoObj* pAnchor=nullptr);
+    MnxElementAnalyser* new_analyser(const char* name, ImoObj* pAnchor=nullptr);
     void set_result(AnalysisData* pData);
     void delete_result();
 
@@ -48,6 +48,8 @@ public:
 
     ImoDocument* build_model(ImoDocument* pImoDoc);
     void structurize(ImoObj* pImo);
+    void update(ImoScore* pScore, ImoInstrument* pInstr, ImoStaffObj* pFirst,
+                ImoStaffObj* pLast);
 
     ImoDocument* fix_cloned_model(ImoDocument* pImoDoc);
     void fix_model(ImoObj* pImo);
@@ -69,6 +71,7 @@ public:
     virtual ~PitchAssigner() {}
 
     void assign_pitch(ImoScore* pScore);
+    void assign_pitch(ImoScore* pScore, const ColStaffObjsChanges& changes);
 
 protected:
     void reset_accidentals(ImoKeySignature* pKey, int idx);
@@ -143,14 +146,26 @@ protected:
     std::vector<ImMeasuresTable*> m_tables;             //table for each instrument
     std::vector<ImMeasuresTableEntry*> m_curMeasure;    //current measure in process, for each instrument
 
+    //for incremental updates
+    int m_iLastEntry = -1;                              //last ColStaffObjs entry modified
+    std::vector<ImMeasuresTableEntry*> m_oldMeasures;   //measures to update
+    size_t m_iOldMeasure = 0;                           //next old measure to check
+    bool m_fSynchronized = false;                       //old measures reused
+
 public:
     MeasuresTableBuilder() {}
     virtual ~MeasuresTableBuilder() {}
 
 	void build(ImoScore* pScore);
+	bool update(ImoScore* pScore, const ColStaffObjsChanges& changes);
 
 protected:
 
+    void process_entry(ImoScore* pScore, ColStaffObjsEntry* pCsoEntry);
+    int find_last_valid_measure(ImMeasuresTable* pTable,
+                                const ColStaffObjsChanges& changes);
+    bool reuse_old_measures(int iInstr, ColStaffObjsEntry* pStartEntry);
+
     void start_measures_table_for(int iInstr, ImoInstrument* pInstr,
                                   ColStaffObjsEntry* pStartEntry);
     void finish_current_measure(int iInstr, ColStaffObjsEntry* pEndEntry=nullptr);
@@ -29,6 +29,7 @@ class MxlAnalyser;
 class ImoObj;
 class ImoNote;
 class ImoRest;
+class XmlStreamReader;
 
 
 //---------------------------------------------------------------------------------------
@@ -331,6 +332,19 @@ protected:
     XmlNode* m_pTree;
     std::string m_fileLocator;
 
+    //streaming import: source and parsers for the <part> and <measure> chunks
+    XmlStreamReader*    m_pStream = nullptr;
+    XmlParser*          m_pPartParser = nullptr;
+    XmlParser*          m_pMeasureParser = nullptr;
+    bool                m_fPartContentPending = false;
+
+    //parallel import: when this analyser is a worker for one <part>, pointer to the
+    //analyser that owns the score, space for lyrics to reserve in next instrument, and
+    //flag signalling that the margin of first staff has been replaced in this part
+    MxlAnalyser*        m_pMainAnalyser = nullptr;
+    std::vector<LUnits> m_nextInstrLyricsSpace;
+    bool                m_fFirstStaffMarginReplaced = false;
+
     // information maintained in MxlAnalyser
     ImoScore*       m_pCurScore;        //the score under construction
     ImoInstrument*  m_pCurInstrument;   //the instrument being analysed
@@ -370,9 +384,6 @@ protected:
 //    int m_nShowTupletBracket;
 //    int m_nShowTupletNumber;
 
-    //conversion from xml element name to int
-    std::map<std::string, int> m_NameToEnum;
-
 public:
     MxlAnalyser(ostream& reporter, LibraryScope& libraryScope, Document* pDoc,
                 XmlParser* parser);
@@ -381,6 +392,16 @@ public:
     //access to results
     ImoObj* analyse_tree(XmlNode* tree, const std::string& locator);
     ImoObj* analyse_tree_and_get_object(XmlNode* tree);
+    ImoObj* analyse_stream(XmlStreamReader* pReader, const std::string& locator);
+
+    //streaming import
+    inline bool is_streaming() { return m_pStream != nullptr; }
+    void analyse_streamed_parts(ImoScore* pScore);
+    void analyse_streamed_measures(ImoMusicData* pMD);
+
+    //parallel import
+    inline bool is_part_worker() { return m_pMainAnalyser != nullptr; }
+    bool analyse_parts_in_parallel(std::vector<XmlNode>& parts, ImoScore* pScore);
 
     //analysis
     ImoObj* analyse_node(XmlNode* pNode, ImoObj* pAnchor=nullptr);
@@ -408,7 +429,10 @@ public:
     //global info: setters, getters and checkers
     int set_musicxml_version(const std::string& version);
     inline int get_musicxml_version() { return m_musicxmlVersion; }
-    ImoInstrument* get_instrument(const std::string& id) { return m_partList.get_instrument(id); }
+    ImoInstrument* get_instrument(const std::string& id) {
+        return (m_pMainAnalyser ? m_pMainAnalyser->get_instrument(id)
+                                : m_partList.get_instrument(id));
+    }
 
     //timepos management
     void increment_time(int voice, int staff, long amount) { m_timeKeeper.increment_time(voice, staff, amount); }
@@ -490,6 +514,7 @@ public:
     LUnits get_staff_distance(int iStaff);
     bool staff_distance_is_imported(int iStaff);
     void clear_staff_distances();
+    inline void first_staff_margin_replaced() { m_fFirstStaffMarginReplaced = true; }
 
 
     //access to document being analysed
@@ -521,6 +546,14 @@ public:
     //interface for building beams
     inline bool fix_beams() { return m_libraryScope.get_musicxml_options()->fix_beams(); }
 
+    //import options
+    inline bool use_streaming_import() {
+        return m_libraryScope.get_musicxml_options()->use_streaming_import();
+    }
+    inline bool use_parallel_import() {
+        return m_libraryScope.get_musicxml_options()->use_parallel_import();
+    }
+
     //interface for building dynamics marks
     void add_pending_dynamics_mark(ImoDynamicsMark* pObj) { m_pendingDynamicsMarks.push_back(pObj); }
     void attach_pending_dynamics_marks(ImoNoteRest* pNR);
@@ -581,17 +614,23 @@ public:
     int get_line_number(XmlNode* node);
 
 
-    int name_to_enum(const std::string& name) const;
+    int name_to_enum(const char* name) const;
+    static const XmlTagsTable& get_tags_table();
     bool to_integer(const std::string& text, int* pResult);
 
     //debug, for unit tests
     void dbg_do_not_reset_voice_times() { m_timeKeeper.dbg_do_not_reset_voice_times(); }
 
 protected:
-    MxlElementAnalyser* new_analyser(const std::string& name, ImoObj* pAnchor=nullptr);
+    MxlElementAnalyser* new_analyser(const char* name, ImoObj* pAnchor=nullptr);
+    void create_relation_builders();
     void delete_relation_builders();
     void add_marging_space_for_lyrics(ImoNote* pNote, ImoLyric* pLyric);
     void add_pending_staffobjs(int voice);
+    void analyse_streamed_part(ImoScore* pScore);
+    void report_streamed_element_ignored(const std::string& parent);
+    bool parts_can_be_analysed_in_parallel(std::vector<XmlNode>& parts);
+    void prepare_as_part_worker(MxlAnalyser* pMain);
 };
 
 //defined in WordsMxlAnalyser to simplify unit testing of the regex
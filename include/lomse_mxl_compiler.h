@@ -24,6 +24,7 @@ class MxlAnalyser;
 class LibraryScope;
 class ImoDocument;
 class Document;
+class ZipInputStream;
 
 
 //---------------------------------------------------------------------------------------
@@ -44,10 +45,18 @@ public:
     //compilation
     ImoDocument* compile_file(const std::string& filename) override;
     ImoDocument* compile_string(const std::string& source) override;
-    ImoDocument* compile_buffer(const void* buffer, size_t size);
+    ImoDocument* compile_buffer(const void* buffer, size_t size) override;
+    ImoDocument* compile_stream(std::istream& stream);
+
+    //compile the current entry of a zip archive. The entry is inflated directly
+    //into the parser buffer or, when streaming import is enabled, it is inflated
+    //chunk by chunk as the stream is parsed
+    ImoDocument* compile_zip_entry(ZipInputStream& zip);
 
 protected:
     ImoDocument* compile_parsed_tree(XmlNode* root);
+    ImoDocument* compile_streamed_file(const std::string& filename);
+    ImoDocument* compile_from_stream(std::istream& stream);
 
 };
 
@@ -12,6 +12,7 @@
 
 #include "lomse_build_options.h"
 
+#include <cstdio>
 #include <fstream>
 #include <iostream>
 #include <sstream>
@@ -23,6 +24,7 @@ namespace lomse
 
 //forward declarations
 class InputStream;
+class LdpReaderBuffer;
 
 //---------------------------------------------------------------------------------------
 // LdpReader: Base class for any provider of LDP source code to be parsed
@@ -44,6 +46,91 @@ public:
     virtual int get_line_number()=0;
     // Returns the file locator associated to this reader
     virtual string get_locator() = 0;
+    // Returns the buffer with all the source, when the reader has it in contiguous
+    // memory, or nullptr. When available, LdpTokenizer scans the buffer directly
+    // instead of invoking get_next_char() for each char
+    virtual LdpReaderBuffer* get_buffer() { return nullptr; }
+
+};
+
+
+//---------------------------------------------------------------------------------------
+// LdpReaderBuffer: the source to parse, when it is in contiguous memory, and the
+// current read position on it
+class LdpReaderBuffer
+{
+public:
+    LdpReaderBuffer() : m_data(nullptr), m_size(0), m_pos(0), m_numLine(0)
+                      , m_fCountLines(false) {}
+
+    inline void set_data(const char* data, size_t size, bool fCountLines)
+    {
+        m_data = data;
+        m_size = size;
+        m_pos = 0;
+        m_fCountLines = fCountLines;
+        m_numLine = (fCountLines ? 1 : 0);
+    }
+
+    inline char get_next_char()
+    {
+        if (m_pos >= m_size)
+        {
+            ++m_pos;
+            return char(EOF);
+        }
+        char ch = m_data[m_pos++];
+        if (ch == 0x0a && m_fCountLines)
+            ++m_numLine;
+        return ch;
+    }
+
+    inline void repeat_last_char()
+    {
+        if (m_pos > 0)
+        {
+            --m_pos;
+            if (m_pos < m_size && m_data[m_pos] == 0x0a && m_fCountLines)
+                --m_numLine;
+        }
+    }
+
+    inline bool end_of_data() const { return m_pos >= m_size; }
+    // Returns a pointer to last char returned by get_next_char(), or nullptr if none
+    // or if it was the EOF mark
+    inline const char* get_last_char_ptr() const {
+        return (m_pos > 0 && m_pos <= m_size ? m_data + m_pos - 1 : nullptr);
+    }
+    inline int get_line_number() const { return m_numLine; }
+    inline size_t get_size() const { return m_size; }
+    inline const char* get_data() const { return m_data; }
+
+protected:
+    const char* m_data;
+    size_t m_size;
+    size_t m_pos;
+    int m_numLine;
+    bool m_fCountLines;
+};
+
+
+//---------------------------------------------------------------------------------------
+// LdpBufferedReader: base class for readers having all the source in contiguous memory
+class LdpBufferedReader : public LdpReader
+{
+protected:
+    LdpReaderBuffer m_buffer;
+
+    LdpBufferedReader() : LdpReader() {}
+
+public:
+    ~LdpBufferedReader() override {}
+
+    char get_next_char() override { return m_buffer.get_next_char(); }
+    void repeat_last_char() override { m_buffer.repeat_last_char(); }
+    bool end_of_data() override { return m_buffer.end_of_data(); }
+    int get_line_number() override { return m_buffer.get_line_number(); }
+    LdpReaderBuffer* get_buffer() override { return &m_buffer; }
 
 };
 
@@ -72,23 +159,45 @@ public:
 };
 
 
+//---------------------------------------------------------------------------------------
+// LdpMappedFileReader: An LDP reader that maps the whole file in memory. Files inside
+// a zip container, or in platforms without memory mapping support, are loaded in
+// memory instead.
+class LdpMappedFileReader : public LdpBufferedReader
+{
+private:
+    const std::string m_locator;
+    void* m_pMapped;            //start of mapped memory or nullptr if not mapped
+    size_t m_mappedSize;
+    std::string m_content;      //file content, when not mapped
+
+public:
+    LdpMappedFileReader(const std::string& locator);
+    ~LdpMappedFileReader() override;
+
+    bool is_ready() override { return true; }
+    string get_locator() override { return m_locator; }
+
+protected:
+    bool map_file(const std::string& filename);
+    void load_file();
+
+};
+
+
 //---------------------------------------------------------------------------------------
 // LdpTextReader: an LDP reader using a string as origin of source code
-class LdpTextReader : public LdpReader
+class LdpTextReader : public LdpBufferedReader
 {
 public:
     LdpTextReader(const std::string& sourceText);
     ~LdpTextReader() override {}
 
-    char get_next_char() override;
-    void repeat_last_char() override;
-    bool is_ready() override;
-    bool end_of_data() override;
-    int get_line_number() override { return 0; }
+    bool is_ready() override { return true; }
     string get_locator() override { return "string:"; }
 
 private:
-    stringstream   m_stream;
+    const std::string m_text;
 
 };
 
@@ -18,6 +18,7 @@
 #include "lomse_engraver.h"
 #include "lomse_engravers_map.h"
 #include "lomse_spacing_algorithm.h"
+#include "lomse_gm_basic.h"
 
 #include <vector>
 using namespace std;
@@ -180,6 +181,19 @@ protected:
     GmoBoxSystem*       m_pCurBoxSystem;
     GmoBoxSystem*       m_pPrevBoxSystem = nullptr;
 
+    //support for reusing the systems of the graphic model built before modifying
+    //the score: the first systems and the systems after the modified ones
+    GraphicModel*       m_pPrevGModel = nullptr;
+    ScoreStub*          m_pPrevStub = nullptr;
+    std::vector<GmoBoxSystem*> m_reusedSystems;
+    int                 m_numReusedEntries = 0;     //ColStaffObjs entries in them
+    std::vector<int>    m_colStartEntry;    //index of first ColStaffObjs entry, per column
+    //systems after the modified ones that could be reused. Index is the system
+    std::vector<GmoBoxSystem*> m_trailingSystems;
+
+    //systems engraved in parallel, waiting to be placed in a page. Index is the system
+    std::vector<SystemLayouter*> m_engravedSystems;
+
     //support for debug and unit test
     int                 m_iColumnToTrace;
     int                 m_nTraceLevel;
@@ -208,6 +222,15 @@ public:
         //invoked when a non-middle barline is found
     void finish_measure(int iInstr, GmoShapeBarline* pBarlineShape);
 
+    //support for reusing systems from the previous graphic model
+    inline int get_num_reused_systems() { return int(m_reusedSystems.size()); }
+    inline int get_num_reused_entries() { return m_numReusedEntries; }
+    inline bool is_first_column_in_score(int iCol) {
+        return iCol == 0 && m_reusedSystems.empty();
+    }
+    void cancel_systems_reuse();
+    GmoShapeBarline* get_reused_barline_shape(ImoStaffObj* pSO);
+
     //support for debugging and unit tests
     void dump_column_data(int iCol, ostream& outStream=glogger.get_stream());
     void delete_not_used_objects();
@@ -231,6 +254,10 @@ protected:
     inline int get_num_systems() { return int(m_breaks.size()); }
     inline bool is_last_system() { return m_iCurSystem == get_num_systems() - 1; }
     inline bool is_first_system_in_score() { return m_iCurSystem == 0; }
+    inline int get_end_column_for_system(int iSystem) {
+        return (iSystem == get_num_systems() - 1 ? get_num_columns()
+                                                 : m_breaks[iSystem + 1]);
+    }
 
     //---------------------------------------------------------------
     void initialice_score_layouter();
@@ -294,6 +321,29 @@ protected:
     std::list<PendingLyricsObj> m_notFinishedLyrics;
 
 
+    //reusing systems from the previous graphic model
+    void find_systems_to_reuse();
+    bool score_has_global_changes();
+    bool is_system_unchanged(int iFirstEntry, int numEntries, size_t signature);
+    size_t compute_system_signature(int iFirstEntry, int numEntries);
+    void reuse_system();
+    void find_trailing_systems_to_reuse();
+    bool can_reuse_trailing_system(int iSystem);
+    void reuse_trailing_system();
+    void move_reused_system_box(GmoBoxSystem* pBox);
+    bool has_reused_barlines(int iFirstEntry, int numEntries);
+    void use_reused_barlines(int iFirstEntry, int numEntries);
+    void delete_pending_aux_objects_for_columns(int iFirstCol, int iLastCol);
+    ScoreStub::SystemContent& get_previous_system_content(int iSystem);
+    size_t compute_prolog_signature(int iCol);
+    LUnits get_free_space_after_previous_system();
+    int get_first_entry_for_column(int iCol);
+    void save_system_content(int iFirstCol, int iLastCol);
+
+    //parallel engraving of systems
+    void engrave_systems_in_parallel();
+    void delete_systems_engraved_in_parallel();
+
     //---------------------------------------------------------------
     int get_system_containing_column(int iCol);
 
@@ -72,7 +72,6 @@ protected:
     EngraversMap&  m_engravers;
     ShapesCreator*  m_pShapesCreator;
     PartsEngraver*  m_pPartsEngraver;
-    VerticalProfile* m_pVProfile;
 
 public:
     SpacingAlgorithm(LibraryScope& libraryScope, ScoreMeter* pScoreMeter,
@@ -125,10 +124,11 @@ public:
 
     //boxes and shapes management
     virtual void reposition_slices_and_staffobjs(int iFirstCol, int iLastCol,
-                                        LUnits yShift, LUnits* yMin, LUnits* yMax) = 0;
+                                        LUnits yShift, VerticalProfile* pVProfile,
+                                        LUnits* yMin, LUnits* yMax) = 0;
     virtual void reposition_full_measure_rests(int iFirstCol, int iLastCol,
                                                GmoBoxSystem* pBox) = 0;
-    virtual void add_shapes_to_boxes(int iCol, VerticalProfile* pVProfile) = 0;
+    virtual void add_shapes_to_boxes(int iCol) = 0;
     virtual void delete_shapes(int iCol) = 0;
     virtual GmoBoxSliceInstr* get_slice_instr(int iCol, int iInstr) = 0;
     virtual void set_slice_final_position(int iCol, LUnits left, LUnits top) = 0;
@@ -259,7 +259,7 @@ public:
     //spacing algorithm
     void do_spacing_algorithm() override;
     //boxes and shapes
-    void add_shapes_to_boxes(int iCol, VerticalProfile* pVProfile) override;
+    void add_shapes_to_boxes(int iCol) override;
     GmoBoxSliceInstr* get_slice_instr(int iCol, int iInstr) override;
     void set_slice_final_position(int iCol, LUnits left, LUnits top) override;
     void create_boxes_for_column(int iCol, LUnits left, LUnits top) override;
@@ -317,6 +317,9 @@ public:
                                            GmoShape* pNonTimedShape) = 0;
     ///terminate current column
     virtual void finish_column_measurements(int iCol) = 0;
+    ///content up to barline in entry pLastEntry is in systems reused from a previous
+    ///layout and will not be included. Prepare for next column as if it were included
+    virtual void start_after_reused_barline(ColStaffObjsEntry* UNUSED(pLastEntry)) {}
 
     //spacing algorithm main actions
     ///apply spacing algorithm to all columns
@@ -429,6 +432,7 @@ protected:
 
     void prepare_for_new_column();
     void collect_content_for_this_column();
+    void skip_content_in_reused_systems();
 
     GmoBoxSlice* create_slice_box();
     void find_and_save_context_info_for_this_column();
@@ -55,12 +55,14 @@ protected:
     std::list<TimeSlice*> m_slices;              //list of TimeSlices
     std::vector<ColumnDataGourlay*> m_columns;   //columns
     std::vector<ShapeData*> m_shapes;            //data associated to each staff object
+    TimeSlice*  m_pReusedSlice;     //barline slice preceding first column, when reusing
+                                    //systems. Not included in m_slices
 
     //auxiliary temporal variables used while collecting columns' data
     TimeSlice*          m_pCurSlice;
     ColStaffObjsEntry*  m_pLastEntry;
     int                 m_prevType;
-    TimeUnits           m_prevTime;
+    TimeTicks           m_prevTime;
     TimeUnits           m_prevAlignTime;    //for grace notes
     int                 m_numEntries;
     ColumnDataGourlay*  m_pCurColumn;
@@ -121,12 +123,14 @@ public:
     void include_full_measure_rest(GmoShape* pRestShape, ColStaffObjsEntry* pCurEntry,
                                    GmoShape* pNonTimedShape) override;
     void finish_column_measurements(int iCol) override;
+    void start_after_reused_barline(ColStaffObjsEntry* pLastEntry) override;
 
     //auxiliary: shapes and boxes
     void add_shapes_to_box(int iCol, GmoBoxSliceInstr* pSliceInstrBox, int iInstr) override;
     void delete_shapes(int iCol) override;
-    void reposition_slices_and_staffobjs(int iFirstCol, int iLastCol,
-                                         LUnits yShift, LUnits* yMin, LUnits* yMax) override;
+    void reposition_slices_and_staffobjs(int iFirstCol, int iLastCol, LUnits yShift,
+                                         VerticalProfile* pVProfile,
+                                         LUnits* yMin, LUnits* yMax) override;
     void reposition_full_measure_rests(int iFirstCol, int iLastCol, GmoBoxSystem* pBox) override;
 
 protected:
@@ -141,8 +145,8 @@ protected:
     bool accept_for_prolog_slice(ColStaffObjsEntry* pEntry);
     int determine_required_slice_type(ImoStaffObj* pSO, bool fInProlog);
     ShapeData* save_info_for_shape(GmoShape* pShape, int iInstr, int iStaff);
-    bool determine_if_new_slice_needed(ColStaffObjsEntry* pCurEntry, TimeUnits curTime,
-                                       int curType, ImoStaffObj* pSO);
+    bool determine_if_new_slice_needed(ColStaffObjsEntry* pCurEntry, int curType,
+                                       ImoStaffObj* pSO);
 
 };
 
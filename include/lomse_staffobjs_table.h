@@ -12,11 +12,14 @@
 
 #include "private/lomse_document_p.h"
 #include "lomse_time.h"
+#include "lomse_arena.h"
 
 //std
 #include <vector>
+#include <unordered_map>
 #include <ostream>
 #include <map>
+#include <array>
 
 namespace lomse
 {
@@ -25,11 +28,13 @@ namespace lomse
 
 //forward declarations
 class DivisionsComputer;
+class ColStaffObjs;
 class ImoAuxObj;
 class ImoDirection;
 class ImoGoBackFwd;
 class ImoGraceNote;
 class ImoGraceRelObj;
+class ImoInstrument;
 class ImoMusicData;
 class ImoObj;
 class ImoScore;
@@ -48,9 +53,10 @@ protected:
     int                 m_line;
     int                 m_staff;
     ImoStaffObj*        m_pImo;
+    TimeTicks           m_ticks;    //timepos of the staffobj, as key for sorting
 
-    ColStaffObjsEntry*  m_pNext;    //next entry in the collection
-    ColStaffObjsEntry*  m_pPrev;    //prev. entry in the collection
+    ColStaffObjs*       m_pTable;   //the collection owning this entry
+    int                 m_index;    //position in the collection, or -1 if removed
 
 public:
     ColStaffObjsEntry(int measure, int instr, int line, int staff, ImoStaffObj* pImo)
@@ -59,15 +65,21 @@ public:
         , m_line(line)
         , m_staff(staff)
         , m_pImo(pImo)
-        , m_pNext(nullptr)
-        , m_pPrev(nullptr)
+        , m_ticks(to_ticks(pImo->get_time()))
+        , m_pTable(nullptr)
+        , m_index(-1)
     {
         m_pImo->set_colstaffobjs_entry(this);
     }
 
+    //allocation in the pool of the document being built, if any
+    static void* operator new(size_t size) { return NodePool::allocate_node(size); }
+    static void operator delete(void* p) { NodePool::deallocate_node(p); }
+
     //getters
     inline int measure() const { return m_measure; }
     inline TimeUnits time() const { return m_pImo->get_time(); }
+    inline TimeTicks ticks() const { return m_ticks; }
     inline int num_instrument() const { return m_instr; }
     inline int line() const { return m_line; }
     inline int staff() const { return m_staff; }
@@ -81,26 +93,137 @@ public:
     std::string to_string_with_ids();
 
     //list structure
-    inline ColStaffObjsEntry* get_next() { return m_pNext; }
-    inline ColStaffObjsEntry* get_prev() { return m_pPrev; }
+    inline int index() const;
+    inline ColStaffObjsEntry* get_next() const;
+    inline ColStaffObjsEntry* get_prev() const;
 
 protected:
     friend class ColStaffObjs;
-    inline void set_next(ColStaffObjsEntry* pEntry) { m_pNext = pEntry; }
-    inline void set_prev(ColStaffObjsEntry* pEntry) { m_pPrev = pEntry; }
+    friend class ImSnapshotArchive;
 
+    inline void update_ticks() { m_ticks = to_ticks(m_pImo->get_time()); }
+
+};
+
+
+//---------------------------------------------------------------------------------------
+// StaffContextIndex: for each staff, the sorted lists of points at which the clef, the
+// key signature, the time signature or the octave shift change. It is built from the
+// ColStaffObjs table and, by binary search, answers which of them is applicable at a
+// given timepos or to a given table entry.
+//---------------------------------------------------------------------------------------
+class StaffContextIndex
+{
+public:
+    enum EStaffContext
+    {
+        k_context_clef = 0,
+        k_context_key,
+        k_context_time,
+        k_context_octave_shift,
+        k_context_max,
+    };
+
+    struct ChangePoint
+    {
+        TimeTicks time;             //timepos from which the change applies
+        int index;                  //index of the table entry creating the change
+        ImoStaffObj* pSO;           //the clef, key or time signature, or the first
+                                    //note in the octave shift. nullptr when the
+                                    //octave shift ends
+        int value;                  //for octave shifts, the shift steps
+
+        ChangePoint(TimeTicks t, int i, ImoStaffObj* p, int v)
+            : time(t), index(i), pSO(p), value(v) {}
+    };
+
+protected:
+    typedef std::array<std::vector<ChangePoint>, k_context_max> StaffPoints;
+
+    std::vector<int> m_firstStaff;      //for each instrument, index in m_staves
+    std::vector<StaffPoints> m_staves;
+
+public:
+    StaffContextIndex() {}
+
+    void build(ColStaffObjs* pTable);
+    void clear();
+
+    //the last change point at or before timepos, or nullptr if none
+    const ChangePoint* find_at(int context, int iInstr, int iStaff,
+                               TimeUnits time) const;
+
+    //the last change point created by a table entry preceding the entry at
+    //iEntry, or nullptr if none. Not valid for octave shifts: they are only
+    //ordered by timepos
+    const ChangePoint* find_before(int context, int iInstr, int iStaff,
+                                   int iEntry) const;
+
+protected:
+    const std::vector<ChangePoint>* get_points(int context, int iInstr,
+                                               int iStaff) const;
+    std::vector<ChangePoint>& points_for(int context, int iInstr, int iStaff);
+    void add_octave_shift_points(ColStaffObjsEntry* pEntry);
+
+};
+
+
+//---------------------------------------------------------------------------------------
+// NoteRestsIndex: for each (instrument, voice), the note/rests time intervals in table
+// order. As the table is ordered by timepos, intervals are sorted by start time and,
+// by keeping the maximum end time of the preceding intervals, the note/rests sounding
+// at a timepos or in a time range are found by binary search.
+//---------------------------------------------------------------------------------------
+class NoteRestsIndex
+{
+public:
+    struct Interval
+    {
+        TimeTicks start;
+        TimeTicks end;
+        TimeTicks maxEnd;           //max end time of this and all previous intervals
+        ColStaffObjsEntry* pEntry;
+
+        Interval(TimeTicks s, TimeTicks e, TimeTicks m, ColStaffObjsEntry* p)
+            : start(s), end(e), maxEnd(m), pEntry(p) {}
+    };
+
+protected:
+    std::map< std::pair<int, int>, std::vector<Interval> > m_voices;
+
+public:
+    NoteRestsIndex() {}
+
+    void build(ColStaffObjs* pTable);
+    void clear() { m_voices.clear(); }
+
+    //the first note/rest in table order with start <= time <= end, or nullptr
+    ColStaffObjsEntry* find_at(int iInstr, int voice, TimeUnits time) const;
+
+    //the note/rests, in table order, with start < endTime and end > startTime
+    void find_overlapped(int iInstr, int voice, TimeUnits startTime,
+                         TimeUnits endTime,
+                         std::vector<ColStaffObjsEntry*>& found) const;
+
+protected:
+    const std::vector<Interval>* get_intervals(int iInstr, int voice) const;
 
 };
 
 
 //---------------------------------------------------------------------------------------
 // ColStaffObjs: encapsulates the staff objects collection for a score
+//
+// Entries are allocated in blocks (a deque never moves its elements) and the table
+// order is kept in a vector of pointers. Each entry knows its position in the
+// vector, so iterating, moving to next/prev entry and random access do not require
+// pointer chasing through the whole collection. Entries are also indexed by the
+// ImoId of their staffobj, for finding the entry for a given staffobj.
 //---------------------------------------------------------------------------------------
 class ColStaffObjs
 {
 protected:
     int m_numLines;
-    int m_numEntries;
     TimeUnits m_rMissingTime;
     TimeUnits m_rAnacrusisExtraTime;    //extra anacrusis time introduced by grace notes
     TimeUnits m_minNoteDuration;
@@ -110,15 +233,39 @@ protected:
     int m_num16th;
     int m_divisions = 480;
 
-    ColStaffObjsEntry* m_pFirst;
-    ColStaffObjsEntry* m_pLast;
+    std::vector<ColStaffObjsEntry*> m_entries;      //entries, in table order
+    int m_iFirstMoved;                              //entries from this position could
+                                                    //have a wrong m_index
+    std::unordered_map<ImoId, ColStaffObjsEntry*> m_entryForId;
+    std::vector<ColStaffObjsEntry*> m_removedEntries;   //not yet deleted
+
+    //info for incremental updates. Only available in tables built for LDP 2.x scores
+    //without grace notes. For each instrument, the line assigned to each (voice, staff)
+    //combination, the measure in which the combination is used for first time and
+    //the order of first use, as lines are assigned in that order.
+    //The key for the map is 100*staff + voice
+    struct LineUsage
+    {
+        int line;
+        int firstMeasure;
+        int order;
+    };
+    bool m_fUpdatable = false;
+    std::vector< std::map<int, LineUsage> > m_lineUsage;
+
+    //indexes for finding the applicable clef, key, time signature and octave shift,
+    //and the note/rests at a timepos. They are rebuilt when the table is modified
+    StaffContextIndex m_context;
+    bool m_fContextValid = false;
+    NoteRestsIndex m_noterests;
+    bool m_fNoteRestsValid = false;
 
 public:
     ColStaffObjs();
     ~ColStaffObjs();
 
     //table info
-    inline int num_entries() const { return m_numEntries; }
+    inline int num_entries() const { return int(m_entries.size()); }
     inline int num_lines() const { return m_numLines; }
     inline bool is_anacrusis_start() const { return is_greater_time(m_rMissingTime, 0.0); }
     inline TimeUnits anacrusis_missing_time() const { return m_rMissingTime; }
@@ -129,79 +276,84 @@ public:
     inline int num_eighth_noterests() const { return m_numEighth; }
     inline int num_16th_noterests() const { return m_num16th; }
     inline int get_divisions() const { return m_divisions; }
+    inline bool is_updatable() const { return m_fUpdatable; }
 
     //table management
     ColStaffObjsEntry* add_entry(int measure, int instr, int voice, int staff,
                                  ImoStaffObj* pImo);
     void delete_entry_for(ImoStaffObj* pSO);
 
+    //Removed entries are not deleted when removed, as other score structures could
+    //still point to them until updated. This method must be invoked when all of them
+    //have been updated
+    void delete_removed_entries();
+
+    //applicable clef, key, time signature and octave shift
+    const StaffContextIndex& get_context_index();
+
+    //note/rests at timepos, by instrument and voice
+    const NoteRestsIndex& get_noterests_index();
+
+    //random access. Returns nullptr if index out of range
+    inline ColStaffObjsEntry* entry_at(int i) const
+    {
+        return (i >= 0 && i < int(m_entries.size()) ? m_entries[i] : nullptr);
+    }
+
     //iterator related
     class iterator
     {
         protected:
             friend class ColStaffObjs;
-            ColStaffObjsEntry* m_pCurrent;
-            ColStaffObjsEntry* m_pPrev;
-            ColStaffObjsEntry* m_pNext;
+            const ColStaffObjs* m_pTable;
+            int m_index;
 
         public:
-            iterator() : m_pCurrent(nullptr), m_pPrev(nullptr), m_pNext(nullptr) {}
+            iterator() : m_pTable(nullptr), m_index(-1) {}
 
-            ///AWARE: This constructor requires pEntry != nullptr.
+            //iterator pointing to pEntry. When pEntry is nullptr the iterator is at end
             iterator(ColStaffObjsEntry* pEntry)
+                : m_pTable(pEntry ? pEntry->m_pTable : nullptr)
+                , m_index(pEntry ? pEntry->index() : -1)
             {
-                m_pCurrent = pEntry;
-                if (m_pCurrent)
-                {
-                    m_pPrev = m_pCurrent->get_prev();
-                    m_pNext = m_pCurrent->get_next();
-                }
-                else
-                {
-                    //is at end. But it is impossible to access any element!!!
-                    m_pPrev = nullptr;
-                    m_pNext = nullptr;
-                }
             }
 
-	        ColStaffObjsEntry* operator *() const { return m_pCurrent; }
+            iterator(const ColStaffObjs* pTable, int index)
+                : m_pTable(pTable)
+                , m_index(index)
+            {
+            }
+
+	        ColStaffObjsEntry* operator *() const {
+                return (m_pTable ? m_pTable->entry_at(m_index) : nullptr);
+            }
 
             iterator& operator ++() {
-                move_next();
+                if (m_pTable && m_index < m_pTable->num_entries())
+                    ++m_index;
                 return *this;
             }
             iterator& operator --() {
-                move_prev();
+                if (m_pTable && m_index >= 0)
+                    --m_index;
                 return *this;
             }
-		    bool operator ==(const iterator& it) const { return m_pCurrent == it.m_pCurrent; }
-		    bool operator !=(const iterator& it) const { return m_pCurrent != it.m_pCurrent; }
+		    bool operator ==(const iterator& it) const { return **this == *it; }
+		    bool operator !=(const iterator& it) const { return **this != *it; }
 
 		    //access to prev/next element without changing iterator position
-		    inline ColStaffObjsEntry* next() { return m_pNext; }
-		    inline ColStaffObjsEntry* prev() { return m_pPrev; }
-
-        protected:
-            void move_next()
-            {
-                m_pPrev = m_pCurrent;
-                m_pCurrent = m_pNext;
-                if (m_pCurrent)
-                    m_pNext = m_pCurrent->get_next();
+		    inline ColStaffObjsEntry* next() {
+                return (m_pTable ? m_pTable->entry_at(m_index + 1) : nullptr);
             }
-            void move_prev()
-            {
-                m_pNext = m_pCurrent;
-                m_pCurrent = m_pPrev;
-                if (m_pCurrent)
-                    m_pPrev = m_pCurrent->get_prev();
+		    inline ColStaffObjsEntry* prev() {
+                return (m_pTable ? m_pTable->entry_at(m_index - 1) : nullptr);
             }
     };
 
-	inline iterator begin() { return iterator(m_pFirst); }
-	inline iterator end() { return iterator(nullptr); }
-    inline ColStaffObjsEntry* back() { return m_pLast; }
-    inline ColStaffObjsEntry* front() { return m_pFirst; }
+	inline iterator begin() { return iterator(this, 0); }
+	inline iterator end() { return iterator(this, num_entries()); }
+    inline ColStaffObjsEntry* back() { return (m_entries.empty() ? nullptr : m_entries.back()); }
+    inline ColStaffObjsEntry* front() { return (m_entries.empty() ? nullptr : m_entries.front()); }
     inline iterator find(ImoStaffObj* pSO) { return iterator(find_entry_for(pSO)); }
 
     //debug
@@ -209,10 +361,12 @@ public:
 
 protected:
 
+    friend class ColStaffObjsEntry;
     friend class ColStaffObjsBuilder;
     friend class ColStaffObjsBuilderEngine;
     friend class ColStaffObjsBuilderEngine1x;
     friend class ColStaffObjsBuilderEngine2x;
+    friend class ImSnapshotArchive;
 
     inline void set_total_lines(int number) { m_numLines = number; }
     inline void set_anacrusis_missing_time(TimeUnits rTime) { m_rMissingTime = rTime; }
@@ -223,14 +377,80 @@ protected:
     void count_noterest(ImoNoteRest* pNR);
     inline void set_divisions(int div) { m_divisions = div; }
 
+    ColStaffObjsEntry* create_entry(int measure, int instr, int line, int staff,
+                                    ImoStaffObj* pImo);
     void add_entry_to_list(ColStaffObjsEntry* pEntry);
+    void append_entry(ColStaffObjsEntry* pEntry);
+    inline void entries_moved(int iFirst) {
+        if (iFirst < m_iFirstMoved)
+            m_iFirstMoved = iFirst;
+    }
+    inline void update_positions();
+    void renumber_entries();
     ColStaffObjsEntry* find_entry_for(ImoStaffObj* pSO);
+    ColStaffObjsEntry* find_entry_by_id(ImoStaffObj* pSO);
+    void release_entry(ColStaffObjsEntry* pEntry);
+
+    //incremental updates
+    void replace_entries(int iFirst, int iLast, std::vector<ColStaffObjsEntry*>& entries);
+    void reset_noterests_info();
+    void save_line_usage(int instr, int voice, int staff, int line, int measure);
+    LineUsage* get_line_usage(int instr, int voice, int staff);
+
+    void build_context_index();
+    inline void invalidate_indexes() { m_fContextValid = m_fNoteRestsValid = false; }
 
 };
 
+//---------------------------------------------------------------------------------------
+inline void ColStaffObjs::update_positions()
+{
+    if (m_iFirstMoved < num_entries())
+        renumber_entries();
+}
+
+//---------------------------------------------------------------------------------------
+inline int ColStaffObjsEntry::index() const
+{
+    if (m_pTable && m_index >= 0)
+        m_pTable->update_positions();
+    return m_index;
+}
+
+//---------------------------------------------------------------------------------------
+inline ColStaffObjsEntry* ColStaffObjsEntry::get_next() const
+{
+    int i = index();
+    return (m_pTable && i >= 0 ? m_pTable->entry_at(i + 1) : nullptr);
+}
+
+//---------------------------------------------------------------------------------------
+inline ColStaffObjsEntry* ColStaffObjsEntry::get_prev() const
+{
+    int i = index();
+    return (m_pTable && i > 0 ? m_pTable->entry_at(i - 1) : nullptr);
+}
+
 typedef  ColStaffObjs::iterator      ColStaffObjsIterator;
 
 
+//---------------------------------------------------------------------------------------
+// ColStaffObjsChanges: describes the part of the ColStaffObjs table modified by an
+// incremental update, for updating the structures derived from the table
+//---------------------------------------------------------------------------------------
+struct ColStaffObjsChanges
+{
+    int iInstr = -1;                        //the modified instrument
+    int iFirstEntry = 0;                    //index of first table entry modified
+    int iLastEntry = -1;                    //index of last table entry modified
+    ColStaffObjsEntry* pStartBarline = nullptr; //barline before the modified measures,
+                                                //or nullptr if from start
+    ColStaffObjsEntry* pEndBarline = nullptr;   //barline after the modified measures,
+                                                //or nullptr if up to the end
+    bool fKeysChanged = false;              //key signatures in the modified measures
+};
+
+
 //---------------------------------------------------------------------------------------
 /** StaffVoiceLineTable: algorithm assign line number to voices/staves
     The algorithm is very simple:
@@ -273,6 +493,8 @@ public:
     virtual ~ColStaffObjsBuilder() {}
 
     ColStaffObjs* build(ImoScore* pScore);
+    bool update(ImoScore* pScore, ImoInstrument* pInstr, ImoStaffObj* pFirst,
+                ImoStaffObj* pLast, ColStaffObjsChanges* pChanges);
 
 protected:
     ColStaffObjsBuilderEngine* create_builder_engine(ImoScore* pScore);
@@ -290,6 +512,12 @@ protected:
     DivisionsComputer* m_pDivComputer = nullptr;    //for computing MusicXML divisions
 
     int         m_nCurMeasure = 0;
+    int         m_nCurInstr = 0;
+    bool        m_fUpdating = false;        //doing an incremental update
+    bool        m_fUpdateFailed = false;    //incremental update not possible
+    int         m_nStartMeasure = 0;        //first measure re-created when updating
+    std::vector<ColStaffObjsEntry*> m_newEntries;   //entries created when updating
+    std::vector< std::pair<ColStaffObjs::LineUsage*, int> > m_newLineUsage;
     TimeUnits   m_rMaxSegmentTime = 0.0;
     TimeUnits   m_rStartSegmentTime = 0.0;
     TimeUnits   m_minNoteDuration = LOMSE_NO_NOTE_DURATION;
@@ -309,6 +537,9 @@ public:
     ColStaffObjsBuilderEngine& operator= (ColStaffObjsBuilderEngine&&) = delete;
 
     ColStaffObjs* do_build();
+    virtual bool do_update(int nInstr, ImoStaffObj* pFirst, ImoStaffObj* pLast,
+                           ColStaffObjsChanges* pChanges);
+    void discard_new_entries();
 
     //debug
     std::string dump_divisions_data() const;
@@ -323,6 +554,8 @@ protected:
     void collect_anacrusis_info();
     void collect_note_rest_info(ImoNoteRest* pNR);
     int get_line_for(int nVoice, int nStaff);
+    ColStaffObjsEntry* add_entry(int measure, int instr, int line, int staff,
+                                 ImoStaffObj* pImo);
     void set_num_lines();
     void add_entries_for_key_or_time_signature(ImoObj* pImo, int nInstr);
     void set_min_note_duration();
@@ -334,6 +567,11 @@ protected:
     void fix_negative_playback_times();
     void compute_arpeggiated_chords_playback_time();
     void compute_divisions();
+    void update_table_info();
+    int merge_new_entries(int iFirst, int iLast, int firstMeasure, int lastMeasure);
+    void sort_entries_at_same_time(std::vector<ColStaffObjsEntry*>& entries,
+                                   size_t iStart, size_t iEnd);
+    bool update_line_usage(int lastMeasure);
 
     static void save_arpeggiated_note(ImoNote* pNote, bool fBottomUp,
                                       list<ImoNote*>& chordNotes);
@@ -407,6 +645,9 @@ public:
     ColStaffObjsBuilderEngine2x(ImoScore* pScore) : ColStaffObjsBuilderEngine(pScore) {}
     ~ColStaffObjsBuilderEngine2x() override {}
 
+    bool do_update(int nInstr, ImoStaffObj* pFirst, ImoStaffObj* pLast,
+                   ColStaffObjsChanges* pChanges) override;
+
 private:
 
     //overrides for base class ColStaffObjsBuilderEngine
@@ -419,6 +660,8 @@ private:
     void reset_counters();
     void update_measure();
     void add_entry_for_staffobj(ImoObj* pImo, int nInstr);
+    void process_staffobj(ImoObj* pImo, int nInstr);
+    void restart_after_barline(ColStaffObjsEntry* pEntry);
 
 };
 
@@ -124,6 +124,7 @@ protected:
     int m_constrains = 0;
     UPoint m_pagePos;
     bool m_fFirstColumnInSystem = true;
+    bool m_fContentEngraved = false;    //engrave_system_content() already invoked
 
     //prolog shapes waiting to be added to slice staff box
     std::list< std::tuple<GmoShape*, int, int> > m_prologShapes;
@@ -133,8 +134,13 @@ public:
     explicit SystemLayouter(ScoreLayoutScope& scoreLayoutScope);
 
     GmoBoxSystem* create_system_box(LUnits left, LUnits top, LUnits width, LUnits height);
+    GmoBoxSystem* move_system_box(LUnits left, LUnits top);
     void engrave_system(LUnits indent, int iFirstCol, int iLastCol, UPoint pos,
                         GmoBoxSystem* pPrevBoxSystem);
+    void set_position_and_width_for_staves(LUnits indent);
+
+    //parallel engraving
+    void engrave_system_content(int iSystem, LUnits indent, int iFirstCol, int iLastCol);
     void on_origin_shift(LUnits yShift);
     inline void set_constrains(int constrains) { m_constrains = constrains; }
 
@@ -156,7 +162,7 @@ public:
     bool system_must_be_truncated();
 
 protected:
-    void set_position_and_width_for_staves(LUnits indent);
+    void engrave_columns(int iFirstCol, int iLastCol);
     void create_vertical_profile();
     void fill_current_system_with_columns();
     void collect_last_column_information();
@@ -182,7 +188,7 @@ protected:
                                            LUnits bottomMarginIncr);
 
     void add_prolog_shapes_to_boxes();
-    void add_system_prolog_if_necessary();
+    void add_system_prolog_if_necessary(int iCol);
     LUnits engrave_prolog(int iInstr);
     LUnits determine_column_start_position(int iCol);
     LUnits determine_column_size(int iCol);
@@ -204,6 +210,7 @@ protected:
 
     //helpers
     inline bool is_first_column_in_system() { return m_fFirstColumnInSystem; }
+    bool is_last_system();
 
     //debug
     void dbg_add_vertical_profile_shape();
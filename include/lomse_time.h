@@ -28,6 +28,17 @@ extern bool is_greater_time(TimeUnits t1, TimeUnits t2);
 
 #define is_higher_time  is_greater_time
 
+//integer representation of times, for exact comparisons and sorting. A time is
+//converted to the nearest tick. The resolution is exact for all note durations,
+//including dotted notes and tuplets of 3, 5, 7, 9, 11 and 13 notes, so times
+//computed by adding durations differ only by rounding errors and map to the same tick
+
+typedef long long TimeTicks;
+#define LOMSE_TICKS_PER_TIME_UNIT   180180LL    //4 * 9 * 5 * 7 * 11 * 13
+
+extern TimeTicks to_ticks(TimeUnits time);
+extern TimeUnits to_time_units(TimeTicks ticks);
+
 //helper function to implement round-half-up algorithm
 
 TimeUnits round_half_up(TimeUnits num);
@@ -7,90 +7,122 @@
 // See LICENSE and NOTICE.md files in the root directory of this source tree.
 //---------------------------------------------------------------------------------------
 
-#ifndef __LOMSE_LDP_TOKEN_H__
-#define __LOMSE_LDP_TOKEN_H__
-
-#include <sstream>
-
-using namespace std;
-
-namespace lomse
-{
-
-    class LdpReader;
-
-enum ETokenType {
-    tkStartOfElement = 0,
-    tkEndOfElement,
-    tkIntegerNumber,
-    tkRealNumber,
-    tkLabel,
-    tkString,
-    tkEndOfFile,
-    //tokens for internal use
-    tkSpaces,        //token separator
-    tkComment        //to be filtered out in tokenizer routines
-};
-
-
-    /*!
-    \brief The lexical analyzer decompose the input into tokens. Class LdpToken represents a token
-    */
-    //----------------------------------------------------------------------------------------------
-    class LdpToken
-    {
-    private:
-        ETokenType m_type;
-        std::string m_value;
-        int m_numLine;
-
-    public:
-        LdpToken(ETokenType type, std::string value, int numLine)
-            : m_type(type), m_value(value), m_numLine(numLine) {}
-        LdpToken(ETokenType type, char value, int numLine)
-            : m_type(type), m_value(""), m_numLine(numLine) { m_value += value; }
-
-        ~LdpToken() {}
-
-        inline ETokenType get_type() { return m_type; }
-        inline const std::string& get_value() { return m_value; }
-        inline int get_line_number() { return m_numLine; }
-    };
-
-    /*!
-    \brief implements the lexical analyzer
-    */
-    //----------------------------------------------------------------------------------------------
-    class LdpTokenizer
-    {
-    public:
-        LdpTokenizer(LdpReader& reader, ostream& reporter);
-        ~LdpTokenizer();
-
-        inline void repeat_token() { m_repeatToken = true; }
-        LdpToken* read_token();
-        int get_line_number();
-        void skip_utf_bom();
-
-    private:
-        LdpToken* parse_new_token();
-        char get_next_char();
-        static bool is_number(char ch);
-        static bool is_letter(char ch);
-
-        LdpReader&  m_reader;
-        ostream&    m_reporter;
-        bool        m_repeatToken;
-        LdpToken*   m_pToken;
-
-        //to deal with compact notation [  name:value  -->  (name value)  ]
-        bool        m_expectingEndOfElement;
-        bool        m_expectingValuePart;
-        bool        m_expectingNamePart;
-        LdpToken*   m_pTokenNamePart;
-    };
-
-
-} //namespace lomse
-
-#endif      //__LOMSE_LDP_TOKEN_H__
+#ifndef __LOMSE_LDP_TOKEN_H__
+#define __LOMSE_LDP_TOKEN_H__
+
+#include <cstring>
+#include <sstream>
+#include <string>
+
+using namespace std;
+
+namespace lomse
+{
+
+    class LdpReader;
+    class LdpReaderBuffer;
+
+enum ETokenType {
+    tkStartOfElement = 0,
+    tkEndOfElement,
+    tkIntegerNumber,
+    tkRealNumber,
+    tkLabel,
+    tkString,
+    tkEndOfFile,
+    //tokens for internal use
+    tkSpaces,        //token separator
+    tkComment        //to be filtered out in tokenizer routines
+};
+
+
+    /*!
+    \brief The lexical analyzer decompose the input into tokens. Class LdpToken represents a token
+
+    When the source is in a contiguous buffer, the token value is not copied: it is
+    just a view into the source buffer and, therefore, it is only valid while the
+    reader exists. Use get_value() for obtaining a copy.
+    */
+    //----------------------------------------------------------------------------------------------
+    class LdpToken
+    {
+    private:
+        ETokenType m_type;
+        const char* m_pValue;       //the value: a view into source or into m_ownedValue
+        size_t m_size;
+        std::string m_ownedValue;
+        int m_numLine;
+
+    public:
+        LdpToken(ETokenType type, const std::string& value, int numLine)
+            : m_type(type), m_ownedValue(value), m_numLine(numLine)
+        {
+            m_pValue = m_ownedValue.data();
+            m_size = m_ownedValue.size();
+        }
+        LdpToken(ETokenType type, char value, int numLine)
+            : m_type(type), m_ownedValue(1, value), m_numLine(numLine)
+        {
+            m_pValue = m_ownedValue.data();
+            m_size = 1;
+        }
+        LdpToken(ETokenType type, const char* value, size_t size, int numLine)
+            : m_type(type), m_pValue(value), m_size(size), m_numLine(numLine) {}
+
+        ~LdpToken() {}
+
+        LdpToken(const LdpToken&) = delete;
+        LdpToken& operator= (const LdpToken&) = delete;
+
+        inline ETokenType get_type() { return m_type; }
+        inline std::string get_value() { return std::string(m_pValue, m_size); }
+        inline const char* get_value_data() { return m_pValue; }
+        inline size_t get_value_size() { return m_size; }
+        inline bool value_is(const char* value) {
+            return strlen(value) == m_size && memcmp(value, m_pValue, m_size) == 0;
+        }
+        inline int get_line_number() { return m_numLine; }
+    };
+
+    /*!
+    \brief implements the lexical analyzer
+    */
+    //----------------------------------------------------------------------------------------------
+    class LdpTokenizer
+    {
+    public:
+        LdpTokenizer(LdpReader& reader, ostream& reporter);
+        ~LdpTokenizer();
+
+        inline void repeat_token() { m_repeatToken = true; }
+        LdpToken* read_token();
+        int get_line_number();
+        void skip_utf_bom();
+
+    private:
+        LdpToken* parse_new_token();
+        char get_next_char();
+        void repeat_last_char();
+        bool end_of_data();
+        static bool is_number(char ch);
+        static bool is_letter(char ch);
+
+        LdpReader&  m_reader;
+        ostream&    m_reporter;
+        bool        m_repeatToken;
+        LdpToken*   m_pToken;
+
+        //to deal with compact notation [  name:value  -->  (name value)  ]
+        bool        m_expectingEndOfElement;
+        bool        m_expectingValuePart;
+        bool        m_expectingNamePart;
+        LdpToken*   m_pTokenNamePart;
+
+        //when not null, the source is scanned directly from the reader buffer
+        LdpReaderBuffer* m_pBuffer;
+    };
+
+
+} //namespace lomse
+
+#endif      //__LOMSE_LDP_TOKEN_H__
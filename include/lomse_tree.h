@@ -11,6 +11,8 @@
 #define __LOMSE_TREE_H__
 
 #include <iostream>
+#include <vector>
+#include <stdexcept>
 
 
 namespace lomse
@@ -149,6 +151,10 @@ protected:
 /// A node in the tree. It is a base abstract class from which any tree node must derive.
 /// It adds the links to place the node in the tree and provides iterators for traversing
 /// the tree.
+///
+/// The number of children is cached. For nodes with many children, an index with the
+/// children is built when a child is accessed by position, so that traversals using
+/// get_child(i) are linear. The index is discarded when the children change.
 template<class T>
 class TreeNode : public Tree<T>
 {
@@ -159,14 +165,23 @@ protected:
 	T* m_prevSibling;
     T* m_nextSibling;
     int m_nModified;
+    int m_numChildren;
+    std::vector<T*>* m_pChildren;   //index for accessing children by position, or nullptr
+
+    //min. number of children for building the index
+    enum { k_min_children_for_index = 16, };
 
     TreeNode() : Tree<T>(), m_parent(nullptr), m_firstChild(nullptr), m_lastChild(nullptr),
-                 m_prevSibling(nullptr), m_nextSibling(nullptr), m_nModified(0) {}
+                 m_prevSibling(nullptr), m_nextSibling(nullptr), m_nModified(0),
+                 m_numChildren(0), m_pChildren(nullptr) {}
 
 public:
     //the five specials
-    virtual ~TreeNode() {}
-    TreeNode(const TreeNode& a) : Tree<T>(a) { clone(a); }
+    virtual ~TreeNode() { delete m_pChildren; }
+    TreeNode(const TreeNode& a) : Tree<T>(a), m_numChildren(0), m_pChildren(nullptr)
+    {
+        clone(a);
+    }
     TreeNode& operator= (const TreeNode& a) { clone(a); return *this; }
     TreeNode(TreeNode&&) = delete;
     TreeNode& operator= (TreeNode&&) = delete;
@@ -207,6 +222,7 @@ public:
     virtual int get_num_children();
     virtual T* get_child(int i);
     virtual void remove_child(T* child);
+    inline bool has_children_index() const { return m_pChildren != nullptr; }
 
     //-----------------------------------------------------------------------------------
     class children_iterator
@@ -251,6 +267,8 @@ public:
 protected:
     TreeNode<T>& clone(const TreeNode<T>& a);
     void clone_children(T* parent);
+    void on_children_changed(int increment);
+    void build_children_index();
 
     friend class Tree<T>;
     T* deep_clone(TreeNode<T>* parent=nullptr);
@@ -277,6 +295,8 @@ void TreeNode<T>::append_child(T* child)
     if (oldLastChild)
         oldLastChild->set_next_sibling( child );
 
+    on_children_changed(1);
+
     //cout << "Append child ----------------------------------" << endl;
     //cout << "first child: " << m_firstChild << ", last child: " << m_lastChild << endl;
     //cout << "prev sibling: " << m_prevSibling << ", next sibling: " << m_nextSibling << endl;
@@ -294,13 +314,7 @@ void TreeNode<T>::append_child(T* child)
 template <class T>
 int TreeNode<T>::get_num_children()
 {
-    TreeNode<T>::children_iterator it;
-	int numChildren = 0;
-    for (it=this->begin(); it != this->end(); ++it)
-    {
-        numChildren++;
-    }
-    return numChildren;
+    return m_numChildren;
 }
 
 //---------------------------------------------------------------------------------------
@@ -308,15 +322,51 @@ template <class T>
 T* TreeNode<T>::get_child(int i)
 {
     // i = 0..n-1
-    children_iterator it(this);
-    int numChild = 0;
-    for (it=this->begin(); it != this->end() && numChild < i; ++it, ++numChild);
-    if (it != this->end() && i == numChild)
+    if (i < 0 || i >= m_numChildren)
+        throw std::runtime_error("[TreeNode<T>::get_child]. Num child greater than available children" );
+
+    if (m_numChildren >= k_min_children_for_index)
+    {
+        if (!m_pChildren)
+            build_children_index();
+        return (*m_pChildren)[i];
+    }
+
+    //few children. Walk from the nearest end
+    T* child;
+    if (i < m_numChildren / 2)
     {
-        return *it;
+        child = m_firstChild;
+        for (int j=0; j < i; ++j)
+            child = child->get_next_sibling();
     }
     else
-        throw std::runtime_error("[TreeNode<T>::get_child]. Num child greater than available children" );
+    {
+        child = m_lastChild;
+        for (int j=m_numChildren - 1; j > i; --j)
+            child = child->get_prev_sibling();
+    }
+    return child;
+}
+
+//---------------------------------------------------------------------------------------
+template <class T>
+void TreeNode<T>::build_children_index()
+{
+    m_pChildren = LOMSE_NEW std::vector<T*>();
+    m_pChildren->reserve(m_numChildren);
+    for (T* child = m_firstChild; child; child = child->get_next_sibling())
+        m_pChildren->push_back(child);
+}
+
+//---------------------------------------------------------------------------------------
+template <class T>
+void TreeNode<T>::on_children_changed(int increment)
+{
+    //update cached count and discard the index. It will be rebuilt when needed
+    m_numChildren += increment;
+    delete m_pChildren;
+    m_pChildren = nullptr;
 }
 
 //---------------------------------------------------------------------------------------
@@ -342,6 +392,8 @@ void TreeNode<T>::remove_child(T* nodeToErase)
         set_first_child( nodeToErase->get_next_sibling() );
     if (get_last_child() == nodeToErase)
         set_last_child( nodeToErase->get_prev_sibling() );
+
+    on_children_changed(-1);
 }
 
 //---------------------------------------------------------------------------------------
@@ -426,6 +478,7 @@ typename Tree<T>::depth_first_iterator Tree<T>::erase(depth_first_iterator posit
             parent->set_first_child( nodeToErase->get_next_sibling() );
         if (parent->get_last_child() == nodeToErase)
             parent->set_last_child( nodeToErase->get_prev_sibling() );
+        parent->on_children_changed(-1);
     }
 
     //determine next node after deleted one
@@ -480,6 +533,7 @@ typename Tree<T>::depth_first_iterator Tree<T>::replace_node(depth_first_iterato
             parent->set_first_child( newNode );
         if (parent->get_last_child() == nodeToReplace)
             parent->set_last_child( newNode );
+        parent->on_children_changed(0);
     }
     else
         set_root(newNode);
@@ -529,6 +583,7 @@ typename Tree<T>::depth_first_iterator Tree<T>::insert(T* curNode, T* newNode)
     T* parent = curNode->get_parent();
     if (parent->get_first_child() == curNode)
         parent->set_first_child( newNode );
+    parent->on_children_changed(1);
 
     return newNode;
 }
@@ -557,6 +612,7 @@ TreeNode<T>& TreeNode<T>::clone(const TreeNode<T>& a)
     m_prevSibling = nullptr;
     m_nextSibling = nullptr;
     m_nModified = a.m_nModified;
+    on_children_changed(-m_numChildren);
 
     return *this;
 }
@@ -83,6 +83,9 @@ public:
     void initialize(int idxStaff, LUnits yStaffTop, LUnits yStaffBottom);
     void update(GmoShape* pShape, int idxStaff);
 
+    /** Move the profile by the given amount, when the system is moved. */
+    void shift(USize shift);
+
     /** Return max/min reached value for staff idxStaff. */
     LUnits get_min_limit(int idxStaff) { return m_yMin[idxStaff]; }
     LUnits get_max_limit(int idxStaff) { return m_yMax[idxStaff]; }
@@ -116,6 +119,7 @@ protected:
 
 
     void update_shape(GmoShape* pShape, int idxStaff);
+    void shift_points(PointsRow* pPoints, USize shift);
 
     //debug
     GmoShape* dbg_generate_shape(bool fMax, int idxStaff);
@@ -0,0 +1,71 @@
+//---------------------------------------------------------------------------------------
+// This file is part of the Lomse library.
+// Copyright (c) 2010-present, Lomse Developers
+//
+// Licensed under the MIT license.
+//
+// See LICENSE and NOTICE.md files in the root directory of this source tree.
+//---------------------------------------------------------------------------------------
+
+#ifndef __LOMSE_WORKERS_POOL_H__
+#define __LOMSE_WORKERS_POOL_H__
+
+#include "lomse_build_options.h"
+
+#if (LOMSE_ENABLE_THREADS == 1)
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lomse
+{
+
+//=======================================================================================
+// WorkersPool
+//  A set of threads, created when needed and kept alive until the pool is deleted, for
+//  running a task in several threads at the same time. As the threads are reused, the
+//  per-thread data kept by other library objects (e.g. the font engines in
+//  FontStorage) does not grow with each use.
+//  This class is a singleton maintained in Lomse LibraryScope object
+class WorkersPool
+{
+protected:
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;                 //to control access to the task data
+    std::mutex m_runMutex;              //only one task at a time
+    std::condition_variable m_cvStart;  //to wake up the workers for a new task
+    std::condition_variable m_cvDone;   //to notify that the workers finished
+    const std::function<void()>* m_pTask = nullptr;
+    int m_numSeats = 0;                 //workers still to join the current task
+    int m_numPending = 0;               //workers not yet finished the current task
+    bool m_fStop = false;
+
+public:
+    WorkersPool() {}
+    ~WorkersPool();
+
+    WorkersPool(const WorkersPool&) = delete;
+    WorkersPool& operator= (const WorkersPool&) = delete;
+
+    //Runs the task in numWorkers threads, including the calling thread, and returns
+    //when all of them have finished. The task must not throw exceptions and must
+    //split the work between the threads running it. If the pool is already running a
+    //task for other thread, the task is only run in the calling thread.
+    void run(int numWorkers, const std::function<void()>& task);
+
+    inline int num_threads() { return int(m_threads.size()); }
+
+protected:
+    void add_threads(int numThreads);
+    void worker_loop();
+};
+
+
+}   //namespace lomse
+
+#endif  //LOMSE_ENABLE_THREADS
+
+#endif  //__LOMSE_WORKERS_POOL_H__
@@ -14,6 +14,9 @@
 #include "lomse_internal_model.h"
 
 #include <string>
+#include <cstring>
+#include <istream>
+#include <vector>
 using namespace std;
 
 #include "pugixml/pugiconfig.hpp"
@@ -43,6 +46,8 @@ public:
     XmlNode(const XmlNode* node) : m_node(node->m_node) {}
 
     string name() { return string(m_node.name()); }
+    inline const char* name_cstr() { return m_node.name(); }
+    inline bool has_name(const string& name) { return name == m_node.name(); }
     string value();
     XmlAttribute attribute(const string& name) {
         return m_node.attribute(name.c_str());
@@ -89,6 +94,64 @@ protected:
 
 };
 
+//---------------------------------------------------------------------------------------
+/** XmlTagsTable: Conversion from XML element names to an integer tag, used by the
+    analysers of XML based formats (MusicXML, LMD, MNX) for selecting the analyser
+    for each element.
+
+    The table is a perfect hash, created once from a static list of names: at
+    construction, a seed is searched so that each name maps to a different slot.
+    Therefore, a lookup costs one hash computation and, at most, one string
+    comparison, and does not require creating any string.
+
+    The table is built at runtime, on first use. The seed search tries about 1000 to
+    2000 seeds for the analysers tables, around 1 ms. To avoid it, the seed and size
+    found can be passed as hints; then the table is built in a single pass and the
+    search is done only when the hints are not valid (e.g., the list of names was
+    modified). The unit tests check that the hints used by the analysers are valid.
+*/
+class XmlTagsTable
+{
+public:
+    struct Entry
+    {
+        const char* name;
+        int tag;
+    };
+
+    XmlTagsTable(const Entry* entries, size_t numEntries, int undefinedTag,
+                 unsigned int seedHint=0, size_t sizeHint=0);
+
+    int get_tag(const char* name, size_t len) const;
+    inline int get_tag(const char* name) const { return get_tag(name, strlen(name)); }
+    inline int get_tag(const std::string& name) const {
+        return get_tag(name.c_str(), name.size());
+    }
+
+    //info
+    inline size_t get_table_size() const { return m_slots.size(); }
+    inline unsigned int get_seed() const { return m_seed; }
+    inline bool was_seed_searched() const { return m_fSeedSearched; }
+
+protected:
+    struct Slot
+    {
+        const char* name;
+        size_t len;
+        int tag;
+    };
+
+    std::vector<Slot> m_slots;
+    unsigned int m_seed;
+    size_t m_mask;
+    int m_undefinedTag;
+    bool m_fSeedSearched;
+
+    bool build_table(const Entry* entries, size_t numEntries, size_t size,
+                     unsigned int seed);
+    static unsigned int hash(const char* name, size_t len, unsigned int seed);
+};
+
 //---------------------------------------------------------------------------------------
 class XmlParser : public Parser
 {
@@ -101,6 +164,7 @@ private:
     vector<ptrdiff_t> m_offsetData;     // offset -> line mapping
     bool m_fOffsetDataReady;
     string m_filename;
+    int m_firstLine;                    //first line, when parsing a chunk
 
 public:
     XmlParser(ostream& reporter=cout);
@@ -111,19 +175,110 @@ public:
     void parse_cstring(char* sourceText);
     void parse_buffer(const void* buffer, size_t size);
 
+    //parse a buffer allocated with allocate_buffer(), without copying it. The
+    //parser takes ownership of the buffer and it is modified while parsing
+    void parse_owned_buffer(void* buffer, size_t size);
+    static void* allocate_buffer(size_t size);
+    static void free_buffer(void* buffer);
+
+    //parse a fragment of a bigger document (e.g., one element extracted by
+    //XmlStreamReader). firstLine is the line, in the full document, at which the
+    //fragment starts, so that line numbers in error messages are still meaningful
+    void parse_chunk(const std::string& text, int firstLine);
+    void clear();
+
     inline const string& get_error() { return m_errorMsg; }
     inline const string& get_encoding() { return m_encoding; }
     inline XmlNode* get_tree_root() { return &m_root; }
     int get_line_number(XmlNode* node);
+    bool is_node_in_tree(XmlNode* node);
 
 protected:
     void parse_char_string(char* string);
     void find_root();
     bool build_offset_data(const char* file);
+    void build_offset_data_from_text(const std::string& text);
     std::pair<int, int> get_location(ptrdiff_t offset);
 
 };
 
+//---------------------------------------------------------------------------------------
+/** XmlStreamReader: Lightweight scanner for reading a big XML document from a stream
+    without building a DOM for the whole document. It only identifies markup
+    boundaries (tags, comments, processing instructions, etc.) and keeps track of
+    element nesting, so that the document can be split into chunks, each one
+    containing a complete element, to be parsed and analysed separately by
+    XmlParser::parse_chunk().
+
+    Only unconsumed data is kept in memory. Character data and attribute values are
+    not decoded: the raw text is returned, to be parsed by XmlParser.
+*/
+class XmlStreamReader
+{
+protected:
+    std::istream& m_stream;
+    std::string m_buffer;       //data read from the stream and not yet consumed
+    size_t m_pos;               //first not consumed char in m_buffer
+    bool m_fEof;                //no more data in the stream
+    int m_line;                 //line number for m_pos
+
+    //information about last markup read
+    int m_type;
+    int m_depth;                //depth of the element (root element is depth 1)
+    int m_openElements;         //elements open after last markup
+    int m_tagLine;              //line at which the markup starts
+    std::string m_name;         //element name, for tags
+    std::string m_text;         //character data preceding the markup
+    std::string m_tag;          //raw markup text
+
+public:
+    explicit XmlStreamReader(std::istream& stream);
+
+    enum EMarkupType
+    {
+        k_eof = 0,          //no more markup
+        k_error,            //malformed markup or unexpected end of data
+        k_start_tag,        //e.g., '<node>'
+        k_end_tag,          //e.g., '</node>'
+        k_empty_tag,        //e.g., '<node/>'
+        k_other             //declaration, comment, processing instruction, cdata, doctype
+    };
+
+    /** Consumes the character data before next markup and the markup itself.
+        Returns the type of the markup found. */
+    int next_markup();
+
+    /** Must be invoked after a k_start_tag. Consumes everything up to and including
+        the matching end tag and returns in *pText the raw text of the whole element,
+        start tag included. Returns false when the element is not properly closed.  */
+    bool read_element(std::string* pText);
+
+    /** Like read_element() but the element content is discarded. */
+    bool skip_element();
+
+    /** Consumes all remaining data and returns it */
+    std::string read_remaining();
+
+    //information about last markup
+    inline int get_type() const { return m_type; }
+    inline int get_depth() const { return m_depth; }
+    inline int get_tag_line() const { return m_tagLine; }
+    inline const std::string& get_name() const { return m_name; }
+    inline const std::string& get_text() const { return m_text; }
+    inline const std::string& get_tag() const { return m_tag; }
+    inline std::string get_markup_text() const { return m_text + m_tag; }
+
+protected:
+    bool fill_buffer();
+    bool ensure_data(size_t pos);
+    size_t find_in_buffer(const char* pattern, size_t from);
+    size_t find_end_of_tag(size_t from);
+    size_t find_end_of_doctype(size_t from);
+    void consume(size_t end);
+    void extract_name();
+
+};
+
 
 } //namespace lomse
 
@@ -15,6 +15,7 @@
 
 #include <fstream>
 #include <sstream>
+#include <streambuf>
 #include <vector>
 using namespace std;
 
@@ -81,8 +82,20 @@ struct ZipEntryInfo
     }
 };
 
+//---------------------------------------------------------------------------------------
+// ZipMemorySource: a zip archive in memory, for reading it with minizip
+struct ZipMemorySource
+{
+    const unsigned char* data;
+    size_t size;
+    size_t pos;
+
+    ZipMemorySource() : data(nullptr), size(0), pos(0) {}
+};
+
 //---------------------------------------------------------------------------------------
 // ZipInputStream: A stream for reading an entry in a zip file in the local file system
+// or in a zip archive in memory
 class ZipInputStream : public InputStream
 {
 protected:
@@ -94,10 +107,16 @@ protected:
     char m_buffer[k_buffersize];
     char* m_pNextChar;
     ZipEntryInfo m_curEntry;
+    ZipMemorySource m_memSource;
 
 
 public:
 	ZipInputStream(const std::string& filelocator);
+
+    //zip archive in memory. The buffer is not copied: it must not be deleted while
+    //the stream is in use. The stream is positioned at the first entry
+	ZipInputStream(const void* buffer, size_t size);
+
 	virtual ~ZipInputStream();
 
     //mandatory overrides inherited from InputStream
@@ -129,6 +148,7 @@ public:
 
 protected:
     bool open_zip_archive(const std::string& filelocator);
+    bool open_zip_archive_in_memory(const void* buffer, size_t size);
     void open_specified_entry_or_first(const std::string& filelocator);
     bool read_buffer();
     void close_current_entry();
@@ -137,7 +157,24 @@ protected:
 
 };
 
+//---------------------------------------------------------------------------------------
+// ZipEntryStreamBuf: std::streambuf adapter for reading the current entry of a
+// ZipInputStream with a std::istream. Data is inflated on demand, chunk by chunk, as
+// the istream consumes it, so the entry is never held in memory as a whole.
+class ZipEntryStreamBuf : public std::streambuf
+{
+protected:
+    enum { k_chunksize = 16384, };
 
+    ZipInputStream& m_zip;
+    char m_chunk[k_chunksize];
+
+public:
+    explicit ZipEntryStreamBuf(ZipInputStream& zip);
+
+protected:
+    int_type underflow() override;
+};
 
 
 
@@ -33,8 +33,13 @@
 #include "lomse_events.h"
 #include "lomse_reader.h"
 #include "lomse_document.h"
+#include "lomse_import_stats.h"
 
 #include <sstream>
+#include <vector>
+#if (LOMSE_ENABLE_THREADS == 1)
+    #include <mutex>
+#endif
 
 ///@cond INTERNALS
 namespace lomse
@@ -62,6 +67,9 @@ class ImoButton;
 class ImoParagraph;
 class ImoTextItem;
 class RelObjCloner;
+class IdsLock;
+class IdsStreamScope;
+class ScoreCopy;
 
 
 //---------------------------------------------------------------------------------------
@@ -78,6 +86,37 @@ enum EDocLayoutOptions
 };
 
 
+//------------------------------------------------------------------------------------
+/** %ScoreCopy is a copy of a score that is not part of the internal model. It is used
+    for restoring a score to a previous state without copying the whole document model
+    (i.e. for undo). The copied objects keep their ids and are anchored to a private
+    %DocModel, so they are not accessible from the document.
+
+    The copy is a deep copy of the whole score: its cost grows with the score size,
+    not with the number of objects modified by the command. Unchanged subtrees (e.g.
+    instruments or music data) can not be shared between the document and the copy
+    because every ImoObj stores its parent and its %DocModel, and the staffobjs
+    table, the measures tables and the ImoRelObj point to objects in their own tree.
+*/
+class ScoreCopy
+{
+protected:
+    friend class DocModel;
+    DocModel* m_pModel = nullptr;   //ids and memory for the copied objects
+    ImoScore* m_pScore = nullptr;
+
+    ScoreCopy() {}
+
+public:
+    ~ScoreCopy();
+
+    ScoreCopy(const ScoreCopy&) = delete;
+    ScoreCopy& operator= (const ScoreCopy&) = delete;
+
+    ImoId get_score_id();
+};
+
+
 //------------------------------------------------------------------------------------
 /** %DocModel is a container object for all data representing the current content of
     a document, basically the internal model tree (ImoDocument), and the IdAssigner
@@ -96,8 +135,15 @@ protected:
     IdAssigner*     m_pIdAssigner = nullptr;    //basically a map id <--> ptr to ImoObj
     ImoDocument*    m_pImoDoc = nullptr;        //the internal model tree
     RelObjCloner*   m_pRelObjCloner = nullptr;  //helper to clone ImoRelObj nodes
+    NodePool*       m_pNodePool = nullptr;      //memory for the internal model nodes
     unsigned int    m_flags = k_dirty;
     long            m_imRef = -1L;               //this model unique id number
+    std::vector<ImoId> m_dirtyIds;              //objects marked dirty since last clear
+    bool            m_fClearAllMarks = true;    //dirty marks not tracked: clear all
+#if (LOMSE_ENABLE_THREADS == 1)
+    std::mutex*     m_pIdsMutex = nullptr;      //not null while ids are shared by threads
+#endif
+    friend class IdsLock;
 
 
     DocModel(Document* pDoc);
@@ -121,6 +167,7 @@ public:
     inline Document* get_owner_document() { return m_pDoc; }
     inline IdAssigner* get_id_assigner() { return m_pIdAssigner; }
     RelObjCloner* get_relobj_cloner();
+    inline NodePool* get_node_pool() { return m_pNodePool; }
 
     //information
     inline std::string get_language() { return (m_pImoDoc ? m_pImoDoc->get_language() : "en"); }
@@ -139,12 +186,24 @@ public:
     Control* get_pointer_to_control(ImoId id) const;
     void reset_id_assigner();
     void on_removed_from_model(ImoObj* pImo);
+    void enable_concurrent_ids_access(bool value);
+    ImoId get_last_assigned_id() const;
 
     //dirty flag
     inline bool is_dirty() { return (m_flags & k_dirty) != 0; }
     inline void set_dirty() { m_flags |= k_dirty; }
     inline void clear_dirty() { m_flags &= ~k_dirty; }
 
+    //dirty marks in ImoObjs
+    void on_dirty_marks_set(ImoObj* pImo);
+    void clear_dirty_marks();
+
+    //copies of scores, for undo
+    ScoreCopy* create_score_copy(ImoId scoreId);
+    void restore_score_copy(ScoreCopy* pCopy);
+    ImoId get_ids_counter() const;
+    void set_ids_counter(ImoId value);
+
     //unique model reference
     void add_unique_model_ref();
     inline bool is_valid_model(long imRef) const { return m_imRef == imRef; }
@@ -153,11 +212,48 @@ public:
 
 protected:
     DocModel& clone(const DocModel& a);
+    ImoId next_id(ImoId id);
 
 
 };
 
 
+//---------------------------------------------------------------------------------------
+// IdsStreamScope: while this object exists, the ids for the objects created by this
+// thread in the DocModel are taken from an ids stream, instead of from the shared
+// counter. The ids after 'baseId' are divided in blocks of k_block_size ids, and block
+// k belongs to stream (k % numStreams). Therefore, the ids assigned to the objects
+// created in one stream do not depend on the objects created concurrently in other
+// streams (i.e. parallel import of MusicXML parts), and they are the same in all runs.
+class IdsStreamScope
+{
+protected:
+    DocModel* m_pModel;
+    IdsStreamScope* m_pPrevScope;
+    ImoId m_baseId;
+    int m_iStream;
+    int m_numStreams;
+    long m_iBlock = -1L;            //block being used, in this stream
+    ImoId m_nextId = 0;
+    ImoId m_blockEnd = 0;           //first id after current block
+
+public:
+    enum { k_block_size = 1024 };
+
+    IdsStreamScope(DocModel* pModel, ImoId baseId, int iStream, int numStreams);
+    ~IdsStreamScope();
+
+    ImoId next_id();
+    inline DocModel* get_model() const { return m_pModel; }
+
+    //the scope active in this thread, or nullptr
+    static IdsStreamScope* current();
+
+    IdsStreamScope(const IdsStreamScope&) = delete;
+    IdsStreamScope& operator= (const IdsStreamScope&) = delete;
+};
+
+
 //------------------------------------------------------------------------------------
 /** The %Document class is a facade object that contains, basically, the @IM, a model
     similar to the DOM in HTML. By accessing and modifying this internal model you
@@ -200,6 +296,17 @@ protected:
     DocumentScope   m_docScope;
     int             m_modified = 0;         //modified since last 'save to file' operation
     DocModel*       m_pModel = nullptr;     //the document content
+    ImportStats     m_importStats;          //stats for the last import operation
+
+    //edition transactions
+    int             m_transactionLevel = 0;     //nested begin_transaction() calls
+    bool            m_fDeferredBuild = false;   //end_of_changes() requested
+    bool            m_fDeferredNotify = false;  //notify_if_document_modified() requested
+    std::vector<ImoId> m_deferredScores;        //scores requesting end_of_changes()
+
+    //identifies the dirty marks in the internal model. It changes when the marks are
+    //cleared and when the internal model is replaced
+    long            m_dirtyMarksRef = 0;
 
 public:
     /// Constructor
@@ -213,6 +320,7 @@ public:
         k_format_mxl,       ///< MusicXML format
         k_format_mxl_compressed, ///< Compressed MusicXML format
         k_format_mnx,       ///< W3C MNX format
+        k_format_snapshot,  ///< Lomse binary snapshot. See save_snapshot()
         k_format_unknown,
     };
 
@@ -256,6 +364,21 @@ public:
     */
     int from_string(const std::string& source, int format=k_format_ldp);
 
+    /** Add content to an uninitialized %Document (a %Document created by just invoking
+        the %Document constructor) by parsing the content of a memory buffer.
+        @param buffer   Pointer to the content to be parsed. It is not copied.
+        @param size     The size, in bytes, of the content.
+        @param format   The expected format of the content. Must be a value from
+            enum EFileFormat.
+
+        <b>Remarks</b>
+        - This method is the way to import a compressed MusicXML file
+            (k_format_mxl_compressed) already loaded in memory, e.g. received from
+            the network, without writing it to a temporary file.
+        - Errors are reported as in from_string() method.
+    */
+    int from_buffer(const void* buffer, size_t size, int format=k_format_ldp);
+
     /** Add content to an uninitialized %Document (a %Document created by just invoking
         the %Document constructor) by parsing data from LdpReader object.
         <b>Remarks</b>
@@ -290,6 +413,32 @@ public:
     //@}    //Document creation
 
 
+    /// @name Binary snapshots
+    //@{
+
+    /** Saves the internal model of this %Document, and the tables derived from it, in
+        binary snapshot format. Later, the %Document can be restored from the snapshot
+        (format k_format_snapshot) much faster than importing the source file again, as
+        parsing and analysis of the source are not needed. Returns @false if the
+        snapshot could not be saved.
+
+        <b>Remarks</b>
+        - A snapshot is intended as a cache of imported documents. It can only be
+            restored by the same Lomse version, in the same platform.
+        - Documents containing controls (ImoControl objects) and figured bass are not
+            yet supported.
+        - Errors are reported to the reporter object defined in %Document constructor.
+    */
+    bool save_snapshot(std::ostream& out);
+
+    /** Saves the internal model of this %Document in a file, in binary snapshot format.
+        The recommended file extension is '.lmsnap'. See save_snapshot(std::ostream&).
+    */
+    bool save_snapshot(const std::string& filename);
+
+    //@}    //Binary snapshots
+
+
     /// @name Access to the internal model
     //@{
 
@@ -586,6 +735,12 @@ public:
     /** Returns the scope object associated to the library.  */
     inline LibraryScope& get_library_scope() { return m_libraryScope; }
 
+    /** Returns the timing and counters for the phases of the last import operation,
+        that is, for the last invocation of from_file(), from_string() or
+        from_buffer(). See ImportStats.
+    */
+    inline const ImportStats& get_import_stats() const { return m_importStats; }
+
     /** Returns a shared pointer for this %Document. */
     inline std::shared_ptr<Document> get_shared_ptr_from_this() { return shared_from_this(); }
 
@@ -620,6 +775,43 @@ public:
     //@}    //Miscellaneous methods
 
 
+    /// @name Edition transactions
+    //@{
+
+    /** Start a batch of modifications. Until the matching commit_transaction() the
+        update of the score structures requested by end_of_changes() methods, and the
+        `k_doc_modified_event` requested by notify_if_document_modified(), are
+        deferred. Therefore, for a batch of edits, scores are rebuilt only once and
+        views only rebuild the graphic model once.
+
+        Transactions can be nested. Only the commit of the outer transaction
+        performs the deferred updates.
+
+        <b>Remarks</b>
+        - While a transaction is open, the staffobjs table of a modified score is
+            not valid and must not be accessed, e.g. by a score cursor, until the
+            transaction is committed or flush_deferred_changes() is invoked.
+    */
+    void begin_transaction();
+
+    /** Finish a batch of modifications started with begin_transaction(). When this
+        is the outer transaction, the deferred score updates are performed and, if
+        requested during the transaction, a `k_doc_modified_event` is sent.
+    */
+    void commit_transaction();
+
+    /** Performs now the deferred score updates, without closing the transaction.
+        Invoke it before accessing the structures of a score modified in the
+        transaction, such as the staffobjs table.
+    */
+    void flush_deferred_changes();
+
+    /** Returns @true if there is an open transaction. */
+    inline bool is_in_transaction() const { return m_transactionLevel > 0; }
+
+    //@}    //Edition transactions
+
+
 
 //methods excluded from documented public API. Only for internal use.
 
@@ -651,9 +843,21 @@ public:
 
     Observable* get_observable_child(int childType, ImoId childId) override;
 
+    //edition transactions
+    bool defer_end_of_changes(ImoScore* pScore);
+    bool is_end_of_changes_deferred(ImoScore* pScore);
+    void set_changes_deferred_in_scores(bool value);
+
     //undo/redo support based on re-running all commands
     DocModel* create_model_copy();
     void replace_model(DocModel* pNewModel);
+    ScoreCopy* create_score_copy(ImoId scoreId);
+    void restore_score_copy(ScoreCopy* pCopy);
+
+    //dirty marks in the internal model: objects modified since the marks were cleared.
+    //Used for deciding the parts of a graphic model that can be reused
+    void clear_dirty_marks();
+    inline long get_dirty_marks_ref() const { return m_dirtyMarksRef; }
 
     //modified since last 'save to file' operation
     inline void clear_modified() { m_modified = 0; }
@@ -673,6 +877,7 @@ public:
 
 protected:
     void initialize();
+    void build_model();
     Compiler* get_compiler_for_format(int format);
     void fix_malformed_musicxml();
 
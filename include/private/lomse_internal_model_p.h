@@ -36,6 +36,7 @@
 #include "lomse_image.h"
 #include "lomse_logger.h"
 #include "lomse_engraving_options.h"
+#include "lomse_arena.h"
 typedef int TIntAttribute;
 
 #include <string>
@@ -43,6 +44,7 @@ typedef int TIntAttribute;
 #include <vector>
 #include <map>
 #include <sstream>
+#include <cassert>
 using namespace std;
 
 ///@cond INTERNALS
@@ -70,6 +72,7 @@ class ButtonCtrl;
 class AttribsContainer;
 class ImMeasuresTable;
 class ImMeasuresTableEntry;
+class ImSnapshotArchive;
 
 class ImoAttachments;
 class ImoAuxObj;
@@ -1109,11 +1112,24 @@ public:
     void operator=(const std::string& value);
     void operator=(const Color& value);
 
+    //checks the type of the value
+    template<typename T> bool holds() const
+    {
+        return m_type == type_of(static_cast<const T*>(nullptr));
+    }
+
 private:
     AttribValue& clone(const AttribValue& a);
     void cleanup();
     void check_type(AttribType type) const;
 
+    static AttribType type_of(const int*) { return vt_int; }
+    static AttribType type_of(const std::string*) { return vt_string; }
+    static AttribType type_of(const bool*) { return vt_bool; }
+    static AttribType type_of(const float*) { return vt_float; }
+    static AttribType type_of(const double*) { return vt_double; }
+    static AttribType type_of(const Color*) { return vt_color; }
+
 };
 
 
@@ -1132,7 +1148,8 @@ private:
     to save memory and speed up comparisons.
 
     Also the values for attributes are not strings but can be different types:
-    string, int, float, bool, color, etc.
+    string, int, float, bool, color, etc. Each %AttrObj is just the pair attribute
+    index and value, stored in an AttribValue.
 
     IMPORTANT:
     When modifying Lomse to create a new attribute, appart from adding a new element
@@ -1144,179 +1161,90 @@ class AttrObj
 {
 protected:
     int m_attrbIdx = 0;         //attribute name, from enum EImoAttribute
-    AttrObj* m_prev = nullptr;
-    AttrObj* m_next = nullptr;
-
-    AttrObj(int idx) : m_attrbIdx(idx) {}
+    AttribValue m_value;
 
 public:
-    //the five special
-    virtual ~AttrObj() { delete m_next; }
-    AttrObj(const AttrObj& a) = default;    //{ clone(a); }
-    AttrObj& operator= (const AttrObj& a) = default;    //{ clone(a); return *this; }
-    AttrObj(AttrObj&&) = delete;
-    AttrObj& operator= (AttrObj&&) = delete;
+    AttrObj(int idx, int value) : m_attrbIdx(idx) { m_value = value; }
+    AttrObj(int idx, float value) : m_attrbIdx(idx) { m_value = value; }
+    AttrObj(int idx, double value) : m_attrbIdx(idx) { m_value = value; }
+    AttrObj(int idx, bool value) : m_attrbIdx(idx) { m_value = value; }
+    AttrObj(int idx, const std::string& value) : m_attrbIdx(idx) { m_value = value; }
+    AttrObj(int idx, const char* value) : m_attrbIdx(idx) { m_value = std::string(value); }
+    AttrObj(int idx, const Color& value) : m_attrbIdx(idx) { m_value = value; }
 
-    //virtual constructor
-    virtual AttrObj* clone() = 0;
+    //copy. Moves also copy, as AttribValue is not movable
+    ~AttrObj() {}
+    AttrObj(const AttrObj& a) = default;
+    AttrObj& operator= (const AttrObj& a) = default;
 
     const std::string get_name() const;
     static const std::string get_name(int idx);
 
     inline int get_attrib_idx() const { return m_attrbIdx; }
 
-    inline AttrObj* get_next_attrib() const { return m_next; }
-    inline AttrObj* get_prev_attrib() const { return m_prev; }
-
-    int get_int_value() const;
-    double get_double_value() const;
-    std::string get_string_value() const;
-    bool get_bool_value() const;
-    float get_float_value() const;
-    Color get_color_value() const;
-
-protected:
-
-    friend class AttrList;
-    inline void set_next_attrib(AttrObj* pNext) { m_next = pNext; }
-    inline void set_prev_attrib(AttrObj* pPrev) { m_prev = pPrev; }
-
-    friend class ImoObj;
-    AttrObj* replace_by(AttrObj* newAttr);
-
-
-};
-
-//=======================================================================================
-template <class T> class Attr : public AttrObj
-{
-protected:
-    T m_value;
-
-public:
-    Attr(int idx, const T& value) : AttrObj(idx), m_value(value) {}
-
-    //the five special
-    ~Attr() override {}
-    Attr(const Attr&) = default;
-    Attr& operator= (const Attr&) = default;
-    Attr(Attr&&) = delete;
-    Attr& operator= (Attr&&) = delete;
-
-    //virtual constructor
-    Attr<T>* clone() override
-    {
-        Attr<T>* pAttr = LOMSE_NEW Attr<T>(m_attrbIdx, m_value);
-        pAttr->m_prev = m_prev;
-
-        if (m_next)
-            pAttr->m_next = m_next->clone();
-        else
-            pAttr->m_next = nullptr;
-
-        return pAttr;
-    }
-
-    inline const T& get_value() { return m_value; }
-    inline void set_value(const T& value) { m_value = value; }
-
-};
-
-
-//---------------------------------------------------------------------------------------
-typedef Attr<int> AttrInt;
-typedef Attr<double> AttrDouble;
-typedef Attr<float> AttrFloat;
-typedef Attr<std::string> AttrString;
-typedef Attr<bool> AttrBool;
-typedef Attr< Color > AttrColor;
-
-
-//=======================================================================================
-class AttrVariant : public AttrObj
-{
-protected:
-    AttribValue m_value;
-
-public:
-    AttrVariant(int idx) : AttrObj(idx) {}
-    AttrVariant(int idx, const std::string& value);
-    AttrVariant(int idx, int value);
-    AttrVariant(int idx, float value);
-    AttrVariant(int idx, double value);
-    AttrVariant(int idx, bool value);
-    AttrVariant(int idx, Color value);
-
-    //the five special
-    ~AttrVariant() override {}
-    AttrVariant(const AttrVariant&) = default;
-    AttrVariant& operator= (const AttrVariant&) = default;
-    AttrVariant(AttrVariant&&) = delete;
-    AttrVariant& operator= (AttrVariant&&) = delete;
-
-    //virtual constructor
-    AttrVariant* clone() override
-    {
-        AttrVariant* pAttr = LOMSE_NEW AttrVariant(m_attrbIdx);
-        pAttr->m_value = m_value;
-        pAttr->m_prev = m_prev;
-
-        if (m_next)
-            pAttr->m_next = m_next->clone();
-        else
-            pAttr->m_next = nullptr;
-
-        return pAttr;
-    }
-
-    inline int get_int_value() { return static_cast<int>(m_value); }
-    inline double get_double_value() { return static_cast<double>(m_value); }
-    inline std::string get_string_value() { return static_cast<string>(m_value); }
-    inline bool get_bool_value() { return static_cast<bool>(m_value); }
-    inline float get_float_value() { return static_cast<float>(m_value); }
-    inline Color get_color_value() { return static_cast<Color>(m_value); }
-
-    inline void set_string_value(const std::string& value) { m_value = value; }
-    inline void set_int_value(int value) { m_value = value; }
-    inline void set_double_value(double value) { m_value = value; }
-    inline void set_float_value(float value) { m_value = value; }
-    inline void set_bool_value(bool value) { m_value = value; }
-    inline void set_color_value(Color value) { m_value = value; }
+    //value. Getting a value of a different type throws
+    template<typename T> bool holds() const { return m_value.holds<T>(); }
+    template<typename T> T get_value() const { return static_cast<T>(m_value); }
+
+    inline int get_int_value() const { return static_cast<int>(m_value); }
+    inline double get_double_value() const { return static_cast<double>(m_value); }
+    inline std::string get_string_value() const { return static_cast<std::string>(m_value); }
+    inline bool get_bool_value() const { return static_cast<bool>(m_value); }
+    inline float get_float_value() const { return static_cast<float>(m_value); }
+    inline Color get_color_value() const { return static_cast<Color>(m_value); }
+
+    //setting a value of a different type changes the type of the attribute
+    inline void set_value(int value) { m_value = value; }
+    inline void set_value(float value) { m_value = value; }
+    inline void set_value(double value) { m_value = value; }
+    inline void set_value(bool value) { m_value = value; }
+    inline void set_value(const std::string& value) { m_value = value; }
+    inline void set_value(const char* value) { m_value = std::string(value); }
+    inline void set_value(const Color& value) { m_value = value; }
 
 };
 
 //=======================================================================================
-/** A simple double linked list to store AttrObj objects with minimum memory footprint.
+/** The list of attributes of an ImoObj. Most objects have no attributes, so the list
+    is just a pointer, and the vector with the attributes is only allocated when the
+    first attribute is added and released when the last one is removed. Attributes
+    are stored by value in the vector.
 */
 class AttrList
 {
 protected:
-    AttrObj* m_first = nullptr;
+    std::vector<AttrObj>* m_pAttrs = nullptr;   //nullptr when the list is empty
 
 public:
     AttrList() {}
 
     //the five special
-    ~AttrList() { delete m_first; }
+    ~AttrList() { clear(); }
     AttrList(const AttrList& a) { clone(a); }
-    AttrList& operator= (const AttrList& a) { clone(a); return *this; }
+    AttrList& operator= (const AttrList& a);
     AttrList(AttrList&&) = delete;
     AttrList& operator= (AttrList&&) = delete;
 
     //capacity
-    size_t size();                                      //returns the number of elements
-    inline bool empty() { return m_first == nullptr; }  //checks whether the list is empty
+    inline size_t size() const { return (m_pAttrs ? m_pAttrs->size() : 0); }
+    inline bool empty() const { return m_pAttrs == nullptr; }
 
     //modifiers
-    void clear();                               //clears the contents
-    AttrObj* push_back(AttrObj* newAttr);       //adds an element to the end
+    void clear();                                   //clears the contents
+    AttrObj* push_back(const AttrObj& newAttr);     //adds an element to the end
 
     //element access
-    inline AttrObj* front() { return m_first; }     //access the first element
-    AttrObj* back();                                //access the last element
+    inline AttrObj* front() { return (m_pAttrs ? &m_pAttrs->front() : nullptr); }
+    inline AttrObj* back() { return (m_pAttrs ? &m_pAttrs->back() : nullptr); }
+    inline AttrObj* operator[](size_t i) { return &(*m_pAttrs)[i]; }
+
+    //iteration
+    inline AttrObj* begin() { return (m_pAttrs ? m_pAttrs->data() : nullptr); }
+    inline AttrObj* end() { return (m_pAttrs ? m_pAttrs->data() + m_pAttrs->size()
+                                             : nullptr); }
 
     //operations
-    void remove(TIntAttribute idx);         //removes and deletes the element
+    void remove(TIntAttribute idx);         //removes the element
     AttrObj* find(TIntAttribute idx);       //access element by name identifier
 
 protected:
@@ -1497,6 +1425,10 @@ public:
     ImoObj(ImoObj&&) = delete;
     ImoObj& operator= (ImoObj&&) = delete;
 
+    //allocation in the pool of the document being built, if any
+    static void* operator new(size_t size) { return NodePool::allocate_node(size); }
+    static void operator delete(void* p) { NodePool::deallocate_node(p); }
+
     //flag values
     enum
     {
@@ -1560,6 +1492,9 @@ public:
     //properties
     virtual bool can_generate_secondary_shapes() { return false; }
 
+    //snapshot support: saves/restores the content of this node, but not its children
+    virtual void serialize(ImSnapshotArchive& ar);
+
     //object classification
     inline int get_obj_type() { return m_objtype; }
     inline bool has_children() { return !is_terminal(); }
@@ -1730,21 +1665,11 @@ public:
         AttrObj* pAttr = get_attribute(idx);
         if (pAttr)
         {
-            Attr<T>* pT = dynamic_cast< Attr<T>* >(pAttr);
-            if (pT)
-            {
-                pT->set_value(value);
-                return;
-            }
-
-            else
-            {
-                pAttr->replace_by( LOMSE_NEW Attr<T>(idx, value) );
-                return;
-            }
+            pAttr->set_value(value);
+            return;
         }
 
-        add_attribute( LOMSE_NEW Attr<T>(idx, value) );
+        add_attribute( AttrObj(idx, value) );
         set_dirty(true);
     }
 
@@ -1759,12 +1684,9 @@ public:
     template<typename T> T get_attribute_value(TIntAttribute idx)
     {
         AttrObj* pAttr = get_attribute(idx);
-        if (pAttr)
-        {
-            Attr<T>* pT = dynamic_cast< Attr<T>* >(pAttr);
-            if (pT)
-                return pT->get_value();
-        }
+        if (pAttr && pAttr->holds<T>())
+            return pAttr->get_value<T>();
+
         T value = T();
         return value;
     }
@@ -1782,7 +1704,7 @@ public:
 
         //miscellaneous
     virtual size_t get_num_attributes() { return m_attribs.size(); }
-    inline AttrObj* get_first_attribute() { return m_attribs.front(); }
+    inline AttrObj* get_attribute_at(size_t i) { return m_attribs[i]; }
     virtual list<TIntAttribute> get_supported_attributes();
 
 protected:
@@ -1792,10 +1714,11 @@ protected:
     inline void anchor_to_model(DocModel* pDocModel) { m_pDocModel = pDocModel; }
 
 
-    AttrObj* add_attribute(AttrObj* newAttr) { m_attribs.push_back(newAttr); return newAttr; }
+    AttrObj* add_attribute(const AttrObj& newAttr) { return m_attribs.push_back(newAttr); }
 
     void visit_children(BaseVisitor& v);
     void propagate_dirty();
+    void add_dirty_flags(unsigned int flags);
     void remove_id();
 
 };
@@ -1959,6 +1882,9 @@ public:
     ImoStyle(ImoStyle&&) = delete;
     ImoStyle& operator= (ImoStyle&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //text style
     enum { k_spacing_normal=0, k_length, };
     enum { k_decoration_none=0, k_decoration_underline, k_decoration_overline,
@@ -2196,6 +2122,9 @@ public:
     ImoContentObj(ImoContentObj&&) = delete;
     ImoContentObj& operator= (ImoContentObj&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //getters
     inline Tenths get_user_location_x() { return m_txUserLocation; }
     inline Tenths get_user_location_y() { return m_tyUserLocation; }
@@ -2306,6 +2235,9 @@ public:
     ImoRelations(ImoRelations&&) = delete;
     ImoRelations& operator= (ImoRelations&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //overrides, to traverse this special node
     void accept_visitor(BaseVisitor& v) override;
     bool has_visitable_children() override { return get_num_items() > 0; }
@@ -2467,6 +2399,9 @@ public:
     ImoBoxInline(ImoBoxInline&&) = delete;
     ImoBoxInline& operator= (ImoBoxInline&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //add/remove content
     inline void add_item(ImoInlineLevelObj* pItem) { append_child_imo(pItem); }
     inline void remove_item(ImoContentObj* pItem) { remove_child_imo(pItem); }
@@ -2532,6 +2467,9 @@ public:
     ImoLink(ImoLink&&) = delete;
     ImoLink& operator= (ImoLink&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //url
     inline std::string& get_url() { return m_url; }
     inline void set_url(const std::string& url) { m_url = url; }
@@ -2558,6 +2496,9 @@ public:
     ImoScoreObj(ImoScoreObj&&) = delete;
     ImoScoreObj& operator= (ImoScoreObj&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //getters
     inline Color& get_color() { return m_color; }
 
@@ -2594,6 +2535,9 @@ public:
     ImoStaffObj(ImoStaffObj&&) = delete;
     ImoStaffObj& operator= (ImoStaffObj&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //relations
     void include_in_relation(ImoRelObj* pRelObj, ImoRelDataObj* pData=nullptr);
     void remove_from_relation(ImoRelObj* pRelObj);
@@ -2696,6 +2640,9 @@ public:
     ImoAuxRelObj(ImoAuxRelObj&&) = delete;
     ImoAuxRelObj& operator= (ImoAuxRelObj&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //information
     inline bool is_start_of_relation() { return m_prevId == k_no_imoid; }
     inline bool is_end_of_relation() { return m_nextId == k_no_imoid; }
@@ -2759,6 +2706,9 @@ public:
     ImoRelObj(ImoRelObj&&) = delete;
     ImoRelObj& operator= (ImoRelObj&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     virtual void push_back(ImoStaffObj* pSO, ImoRelDataObj* pData);
     void remove(ImoStaffObj* pSO);
     void remove_all();
@@ -2834,6 +2784,9 @@ public:
     ImoBeamData(ImoBeamData&&) = delete;
     ImoBeamData& operator= (ImoBeamData&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //getters
     inline int get_beam_type(int level) { return m_beamType[level]; }
     inline bool get_repeat(int level) { return m_repeat[level]; }
@@ -2933,6 +2886,9 @@ public:
     ImoBezierInfo(ImoBezierInfo&&) = delete;
     ImoBezierInfo& operator= (ImoBezierInfo&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     enum { k_start=0, k_end, k_ctrol1, k_ctrol2, k_max};     // point number
 
     //points
@@ -3015,6 +2971,9 @@ public:
     ImoChord(ImoChord&&) = delete;
     ImoChord& operator= (ImoChord&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     inline bool is_cross_staff() { return m_fCrossStaff; }
     void update_cross_staff_data();
     ImoNote* get_start_note();
@@ -3202,6 +3161,9 @@ public:
     ImoMidiInfo(ImoMidiInfo&&) = delete;
     ImoMidiInfo& operator= (ImoMidiInfo&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //getters
     inline std::string& get_score_instr_id() { return 	m_soundId; }
     inline int get_midi_port() { return m_port; }
@@ -3279,6 +3241,9 @@ public:
     {
     }
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //getters
     inline Tenths get_height()
     {
@@ -3374,6 +3339,9 @@ public:
     ImoSoundInfo(ImoSoundInfo&&) = delete;
     ImoSoundInfo& operator= (ImoSoundInfo&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //getters
     inline std::string& get_score_instr_id() { return m_soundId; }
     inline std::string& get_score_instr_name() { return m_instrName; }
@@ -3446,6 +3414,9 @@ public:
     ImoPageInfo(ImoPageInfo&&) = delete;
     ImoPageInfo& operator= (ImoPageInfo&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //info about modified values (values imported from source file or modified by the user)
     inline bool is_page_layout_modified() { return m_modified != 0L; }
     inline bool is_left_margin_odd_modified() { return (m_modified & k_modified_left_margin_odd) != 0; }
@@ -3571,6 +3542,9 @@ public:
     ImoBarline(ImoBarline&&) = delete;
     ImoBarline& operator= (ImoBarline&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //getters
     inline int get_type() { return m_barlineType; }
     inline bool is_middle() { return m_fMiddle; }
@@ -3624,6 +3598,9 @@ public:
     ImoBeam(ImoBeam&&) = delete;
     ImoBeam& operator= (ImoBeam&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //type of beam
     enum { k_none = 0, k_begin, k_continue, k_end, k_forward, k_backward, };
 
@@ -3653,6 +3630,9 @@ public:
     ImoBlock(ImoBlock&&) = delete;
     ImoBlock& operator= (ImoBlock&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
 };
 
 //---------------------------------------------------------------------------------------
@@ -3676,6 +3656,9 @@ public:
     ImoTextBox(ImoTextBox&&) = delete;
     ImoTextBox& operator= (ImoTextBox&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     inline ImoTextBlockInfo* get_box_info() { return &m_box; }
     inline TypeLineStyle& get_anchor_line_info() { return m_line; }
     inline bool has_anchor_line() { return m_fHasAnchorLine; }
@@ -3788,6 +3771,9 @@ public:
     ImoClef(ImoClef&&) = delete;
     ImoClef& operator= (ImoClef&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //building
     void set_clef(int sign, int line, int octaveChange);
     inline void set_symbol_size(int symbolSize) { m_symbolSize = symbolSize; }
@@ -3895,6 +3881,9 @@ public:
     ImoDirection(ImoDirection&&) = delete;
     ImoDirection& operator= (ImoDirection&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //getters
     inline Tenths get_width() { return m_space; }
     inline EPlacement get_placement() const { return m_placement; }
@@ -3936,6 +3925,9 @@ public:
     ImoSymbolRepetitionMark(ImoSymbolRepetitionMark&&) = delete;
     ImoSymbolRepetitionMark& operator= (ImoSymbolRepetitionMark&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     enum ESymbolRepetitionMark
     {
         k_undefined = 0,
@@ -3966,6 +3958,9 @@ public:
     ImoDynamic(ImoDynamic&&) = delete;
     ImoDynamic& operator= (ImoDynamic&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //construction
     inline void set_classid(const std::string& value) { m_classid = value; }
     void add_param(ImoParamInfo* pParam);
@@ -4042,6 +4037,9 @@ public:
     ImoDocument(ImoDocument&&) = delete;
     ImoDocument& operator= (ImoDocument&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //special node
     void accept_visitor(BaseVisitor& v) override;
     bool has_visitable_children() override;
@@ -4108,6 +4106,9 @@ public:
     ImoArpeggio(ImoArpeggio&&) = delete;
     ImoArpeggio& operator= (ImoArpeggio&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //getters
     EArpeggio get_type() const { return m_type; }
 
@@ -4166,6 +4167,9 @@ public:
     ImoFermata(ImoFermata&&) = delete;
     ImoFermata& operator= (ImoFermata&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     enum { k_normal, k_short, k_long, k_henze_short, k_henze_long,
            k_very_short, k_very_long, k_curlew,
          };
@@ -4214,6 +4218,9 @@ public:
     ImoArticulation(ImoArticulation&&) = delete;
     ImoArticulation& operator= (ImoArticulation&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //getters
     inline int get_placement()
     {
@@ -4259,6 +4266,9 @@ public:
     ImoArticulationSymbol(ImoArticulationSymbol&&) = delete;
     ImoArticulationSymbol& operator= (ImoArticulationSymbol&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     enum
     {
         k_default=0,
@@ -4337,6 +4347,9 @@ public:
     ImoArticulationLine(ImoArticulationLine&&) = delete;
     ImoArticulationLine& operator= (ImoArticulationLine&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //getters
     inline int get_line_shape()
     {
@@ -4397,6 +4410,9 @@ public:
     ImoDynamicsMark(ImoDynamicsMark&&) = delete;
     ImoDynamicsMark& operator= (ImoDynamicsMark&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //getters
     inline int get_placement() { return m_placement; }
     inline std::string get_mark_type() { return m_markType; }
@@ -4438,6 +4454,9 @@ public:
     ImoOrnament(ImoOrnament&&) = delete;
     ImoOrnament& operator= (ImoOrnament&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //getters
     inline int get_placement()
     {
@@ -4496,6 +4515,9 @@ public:
     ImoTechnical(ImoTechnical&&) = delete;
     ImoTechnical& operator= (ImoTechnical&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //getters and setters
     inline int get_placement() { return m_placement; }
     inline int get_technical_type() { return m_technicalType; }
@@ -4528,6 +4550,9 @@ public:
     ImoFretString(ImoFretString&&) = delete;
     ImoFretString& operator= (ImoFretString&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     inline int get_fret() const { return m_fret; }
     inline int get_string() const { return m_string; }
     inline void set_fret(int value) { m_fret = value; }
@@ -4553,7 +4578,7 @@ class FingerData
 {
 public:
     std::string value;              //fingering symbols
-    AttrObj* attribs = nullptr;     //position, font, color, placement
+    AttrList attribs;               //position, font, color, placement
     unsigned flags = 0;
 
     enum EFingeringFlags
@@ -4565,7 +4590,7 @@ public:
     FingerData(const std::string& val) : value(val) {}
 
     //the five special
-    ~FingerData() { delete attribs; }
+    ~FingerData() {}
     FingerData(const FingerData& a) { clone(a); }
     FingerData& operator= (const FingerData& a) { clone(a); return *this; }
     FingerData(FingerData&&) = delete;
@@ -4584,10 +4609,7 @@ protected:
     {
         value = a.value;
         flags = a.flags;
-        if (a.attribs)
-            attribs = a.attribs->clone();  //LOMSE_NEW AttrObj(*(a.attribs));
-        else
-            attribs = nullptr;
+        attribs = a.attribs;
 
         return *this;
     }
@@ -4617,6 +4639,9 @@ public:
     ImoFingering(ImoFingering&&) = delete;
     ImoFingering& operator= (ImoFingering&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //building
     FingerData& add_fingering(const std::string& value);
 
@@ -4646,6 +4671,9 @@ public:
     ImoGoBackFwd(ImoGoBackFwd&&) = delete;
     ImoGoBackFwd& operator= (ImoGoBackFwd&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //getters and setters
     inline bool is_forward() { return m_fFwd; }
     inline void set_forward(bool fFwd) { m_fFwd = fFwd; }
@@ -4689,6 +4717,9 @@ public:
     ImoGraceRelObj(ImoGraceRelObj&&) = delete;
     ImoGraceRelObj& operator= (ImoGraceRelObj&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     // grace notes behaviour
     enum EGraceType
     {
@@ -4738,6 +4769,9 @@ public:
     ImoScoreText(ImoScoreText&&) = delete;
     ImoScoreText& operator= (ImoScoreText&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //getters
     inline std::string& get_text() { return m_text.text; }
     inline TypeTextInfo& get_text_info() { return m_text; }
@@ -4767,6 +4801,9 @@ public:
     ImoScoreTitle(ImoScoreTitle&&) = delete;
     ImoScoreTitle& operator= (ImoScoreTitle&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     inline int get_h_align()
     {
         return m_hAlign;
@@ -4840,6 +4877,9 @@ public:
     ImoTranspose(ImoTranspose&&) = delete;
     ImoTranspose& operator= (ImoTranspose&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     inline int get_applicable_staff() { return m_numStaff; }
     inline int get_diatonic() { return m_diatonic; }
     inline int get_chromatic() { return m_chromatic; }
@@ -4879,6 +4919,9 @@ public:
     ImoTextRepetitionMark(ImoTextRepetitionMark&&) = delete;
     ImoTextRepetitionMark& operator= (ImoTextRepetitionMark&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //getters
     inline int get_repeat_mark()
     {
@@ -4920,6 +4963,9 @@ public:
     ImoImage(ImoImage&&) = delete;
     ImoImage& operator= (ImoImage&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //accessors
     SpImage get_image() { return m_image; }
     inline unsigned char* get_buffer() { return m_image->get_buffer(); }
@@ -4977,6 +5023,9 @@ public:
     ImoInstrGroup(ImoInstrGroup&&) = delete;
     ImoInstrGroup& operator= (ImoInstrGroup&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //getters
     inline int join_barlines() { return m_joinBarlines; }
     inline int get_symbol() { return m_symbol; }
@@ -5060,6 +5109,9 @@ public:
     ImoInstrument(ImoInstrument&&) = delete;
     ImoInstrument& operator= (ImoInstrument&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //special node
     void accept_visitor(BaseVisitor& v) override;
     bool has_visitable_children() override;
@@ -5170,6 +5222,7 @@ protected:
     void reserve_space_for_lyrics(int iStaff, LUnits space);
 
     friend class MeasuresTableBuilder;
+    friend class ImSnapshotArchive;
     void set_measures_table(ImMeasuresTable* pTable);
 
     ImoStyle* get_style_imo(ImoId id);
@@ -5341,6 +5394,9 @@ public:
     ImoKeySignature(ImoKeySignature&&) = delete;
     ImoKeySignature& operator= (ImoKeySignature&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //building
     void set_standard_key(int fifths, bool fMajor);
     void set_non_standard_key(const KeyAccidental (&acc)[7]);
@@ -5386,6 +5442,9 @@ public:
     inline TypeLineStyle& get_line_info() { return m_style; }
     inline void set_line_style(ImoLineStyleDto* pStyle) { m_style = pStyle->get_data(); }
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
 };
 
 //---------------------------------------------------------------------------------------
@@ -5425,6 +5484,9 @@ public:
     ImoList(ImoList&&) = delete;
     ImoList& operator= (ImoList&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     enum { k_itemized=0, k_ordered, };
 
     inline void set_list_type(int type) { m_listType = type; }
@@ -5468,6 +5530,9 @@ public:
     ImoMetronomeMark(ImoMetronomeMark&&) = delete;
     ImoMetronomeMark& operator= (ImoMetronomeMark&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     enum { k_note_value=0, k_note_note, k_value, };
 
     //getters
@@ -5549,6 +5614,9 @@ public:
     ImoMultiColumn(ImoMultiColumn&&) = delete;
     ImoMultiColumn& operator= (ImoMultiColumn&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //contents
     inline int get_num_columns() { return get_num_content_items(); }
     inline ImoContent* get_column(int iCol)     //iCol = 0..n-1
@@ -5605,6 +5673,9 @@ public:
     ImoOptionInfo(ImoOptionInfo&&) = delete;
     ImoOptionInfo& operator= (ImoOptionInfo&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     enum { k_boolean=0, k_number_long, k_number_float, k_string };
 
     //getters
@@ -5732,6 +5803,9 @@ public:
     ImoParamInfo(ImoParamInfo&&) = delete;
     ImoParamInfo& operator= (ImoParamInfo&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //getters
     inline std::string& get_name() { return m_name; }
     inline std::string& get_value() { return m_value; }
@@ -5760,6 +5834,9 @@ public:
     ImoHeading(ImoHeading&&) = delete;
     ImoHeading& operator= (ImoHeading&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //level
     inline int get_level() { return m_level; }
     inline void set_level(int level) { m_level = level; }
@@ -5826,6 +5903,9 @@ public:
     ImoScoreLine(ImoScoreLine&&) = delete;
     ImoScoreLine& operator= (ImoScoreLine&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //setters
     inline void set_start_point(TPoint point) { m_startPoint = point; }
     inline void set_end_point(TPoint point) { m_endPoint = point; }
@@ -5951,6 +6031,9 @@ public:
     ImoSystemInfo(ImoSystemInfo&&) = delete;
     ImoSystemInfo& operator= (ImoSystemInfo&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //info about values modified (values imported from source file or modified by the user)
     inline bool is_system_layout_modified() { return m_modified != 0L; }
     inline bool is_left_margin_modified() { return (m_modified & k_modified_left_margin) != 0; }
@@ -6002,7 +6085,10 @@ protected:
         k_modified_scaling =    0x00000001,     //global scaling has been modified
     };
 
+    bool m_fChangesDeferred = false;    //end_of_changes() deferred by a transaction
+
     friend class ImFactory;
+    friend class Document;
     ImoScore();
     void initialize_object() override;
 
@@ -6014,6 +6100,9 @@ public:
     ImoScore(ImoScore&&) = delete;
     ImoScore& operator= (ImoScore&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //to support different models for encoding notes in source files
     enum {
         k_pitch_and_notation_provided = 0,  //both notated and actual acc provided. Nothing to compute (e.g. MusicXML).
@@ -6036,7 +6125,12 @@ public:
     inline int get_version_minor() const { return m_version % 100; }
     inline int get_version_number() const { return m_version; }
     inline int get_accidentals_model() const { return m_accidentalsModel; }
-    inline ColStaffObjs* get_staffobjs_table() const { return m_pColStaffObjs; }
+    inline ColStaffObjs* get_staffobjs_table() {
+        //in a transaction, Document::flush_deferred_changes() must be invoked before
+        //accessing the table of a modified score
+        assert(!m_fChangesDeferred);
+        return m_pColStaffObjs;
+    }
     SoundEventsTable* get_midi_table();
     inline bool was_created_from_musicxml() const { return m_sourceFormat == k_musicxml; }
     inline bool was_created_from_ldp() const { return m_sourceFormat == k_ldp; }
@@ -6112,9 +6206,20 @@ public:
     /** When you modify the content of an score it is necessary to update associated
         structures, such as the staffobjs collection. For this it is mandatory to
         invoke this method. Alternatively, you can invoke Document::end_of_changes(),
-        that will invoke this method on all scores. */
+        that will invoke this method on all scores. When the document has an open
+        transaction the update is deferred until the transaction is committed or
+        until the staffobjs table is accessed, whatever happens first. */
     void end_of_changes();
 
+    /** Faster alternative to end_of_changes() when the changes are confined to one
+        instrument. All modified objects must be in instrument pInstr, from the measure
+        containing pFirst to the measure containing pLast, and pFirst and pLast must be
+        objects in the score. Use nullptr for pFirst if the changes start in the first
+        measure, and for pLast if they continue up to the end of the instrument.
+        When possible, the associated structures are updated instead of rebuilt.
+        In a transaction, the update is deferred as for end_of_changes(). */
+    void end_of_changes(ImoInstrument* pInstr, ImoStaffObj* pFirst, ImoStaffObj* pLast);
+
 
 protected:
     ImoScore& clone(const ImoScore& a);
@@ -6154,6 +6259,9 @@ public:
     ImoSlur(ImoSlur&&) = delete;
     ImoSlur& operator= (ImoSlur&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //getters
     inline int get_slur_number() { return m_slurNum; }
     inline int get_orientation() { return m_orientation; }
@@ -6186,6 +6294,7 @@ protected:
 
     friend class ImFactory;
     ImoSlurData(ImoSlurDto* pDto);
+    ImoSlurData();
 
 public:
     //the five special
@@ -6195,6 +6304,9 @@ public:
     ImoSlurData(ImoSlurData&&) = delete;
     ImoSlurData& operator= (ImoSlurData&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //getters
     inline bool is_start() { return m_fStart; }
     inline int get_slur_number() { return m_slurNum; }
@@ -6351,6 +6463,9 @@ public:
     ImoStaffInfo(ImoStaffInfo&&) = delete;
     ImoStaffInfo& operator= (ImoStaffInfo&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     enum { k_staff_ossia=0, k_staff_cue, k_staff_editorial, k_staff_regular,
            k_staff_alternate,
          };
@@ -6419,6 +6534,9 @@ public:
     ImoStyles(ImoStyles&&) = delete;
     ImoStyles& operator= (ImoStyles&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //overrides, to traverse this special node
     void accept_visitor(BaseVisitor& v) override;
     bool has_visitable_children() override { return m_nameToStyle.size() > 0; }
@@ -6462,6 +6580,9 @@ public:
     ImoTable(ImoTable&&) = delete;
     ImoTable& operator= (ImoTable&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //contents
     ImoTableHead* get_head();
     ImoTableBody* get_body();
@@ -6497,6 +6618,9 @@ public:
     ImoTableCell(ImoTableCell&&) = delete;
     ImoTableCell& operator= (ImoTableCell&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //accessors
     inline void set_rowspan(int value) { m_rowspan = value; }
     inline int get_rowspan() { return m_rowspan; }
@@ -6616,6 +6740,9 @@ public:
     ImoTextItem(ImoTextItem&&) = delete;
     ImoTextItem& operator= (ImoTextItem&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //getters
     inline std::string& get_text() { return m_text; }
     std::string& get_language();
@@ -6653,6 +6780,9 @@ public:
     ImoTieData(ImoTieData&&) = delete;
     ImoTieData& operator= (ImoTieData&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //getters
     inline bool is_start() { return m_fStart; }
     inline int get_tie_number() { return m_tieNum; }
@@ -6682,6 +6812,9 @@ public:
     ImoTie(ImoTie&&) = delete;
     ImoTie& operator= (ImoTie&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //getters
     inline int get_tie_number() { return m_tieNum; }
     inline int get_orientation() { return m_orientation; }
@@ -6849,6 +6982,9 @@ public:
     ImoTimeSignature(ImoTimeSignature&&) = delete;
     ImoTimeSignature& operator= (ImoTimeSignature&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //getters and setters
     inline int get_top_number()
     {
@@ -7056,6 +7192,9 @@ public:
     ImoTuplet(ImoTuplet&&) = delete;
     ImoTuplet& operator= (ImoTuplet&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     enum { k_straight = 0, k_curved, k_slurred, };
     enum { k_number_actual=0, k_number_both, k_number_none, };
 
@@ -7121,6 +7260,9 @@ public:
     ImoLyric(ImoLyric&&) = delete;
     ImoLyric& operator= (ImoLyric&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //getters
     inline int get_number() { return m_number; }
     inline int get_placement() { return m_placement; }
@@ -7186,6 +7328,9 @@ public:
     ImoLyricsTextInfo(ImoLyricsTextInfo&&) = delete;
     ImoLyricsTextInfo& operator= (ImoLyricsTextInfo&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //syllable type
     enum { k_single, k_begin, k_end, k_middle, };
 
@@ -7231,6 +7376,9 @@ public:
     ImoOctaveShift(ImoOctaveShift&&) = delete;
     ImoOctaveShift& operator= (ImoOctaveShift&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //setters
     inline void set_shift_steps(int value) { m_steps = value; }
     inline void set_octave_shift_number(int value) { m_octaveShiftNum = value; }
@@ -7313,6 +7461,9 @@ public:
     ImoPedalMark(ImoPedalMark&&) = delete;
     ImoPedalMark& operator= (ImoPedalMark&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //setters
     void set_type(EPedalMark value) { m_type = value; }
     void set_abbreviated(bool value) { m_fAbbreviated = value; }
@@ -7347,6 +7498,9 @@ public:
     ImoPedalLine(ImoPedalLine&&) = delete;
     ImoPedalLine& operator= (ImoPedalLine&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //setters
     void set_draw_start_corner(bool value) { m_fDrawStartCorner = value; }
     void set_draw_end_corner(bool value) { m_fDrawEndCorner = value; }
@@ -7473,6 +7627,9 @@ public:
     ImoVoltaBracket(ImoVoltaBracket&&) = delete;
     ImoVoltaBracket& operator= (ImoVoltaBracket&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //getters
     inline bool has_final_jog()
     {
@@ -7677,6 +7834,9 @@ public:
     ImoWedge(ImoWedge&&) = delete;
     ImoWedge& operator= (ImoWedge&&) = delete;
 
+    //snapshot support
+    void serialize(ImSnapshotArchive& ar) override;
+
     //setters
     inline void set_start_spread(Tenths value) { m_startSpread = value; m_modified |= k_modified_start_spread; }
     inline void set_end_spread(Tenths value) { m_endSpread = value;  m_modified |= k_modified_end_spread; }
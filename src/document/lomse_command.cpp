@@ -28,6 +28,8 @@
 #include "lomse_score_utilities.h"
 
 #include <sstream>
+#include <chrono>
+#include <limits>
 using namespace std;
 
 namespace lomse
@@ -42,6 +44,52 @@ void DocCommand::undo_action(Document* UNUSED(pDoc), DocCursor* UNUSED(pCursor))
     //log command for forensic analysis
 }
 
+//---------------------------------------------------------------------------------------
+ImoId DocCommand::find_score_id(Document* pDoc, ImoId id)
+{
+    //Returns the id of the score containing the object, or k_no_imoid if the object
+    //is not inside a score
+
+    ImoObj* pImo = pDoc->get_pointer_to_imo(id);
+    if (pImo == nullptr || pImo->is_score())
+        return k_no_imoid;
+
+    //RelObjs are not in the tree. Use first participant
+    if (pImo->is_relobj())
+        pImo = static_cast<ImoRelObj*>(pImo)->get_start_object();
+
+    ImoObj* pParent = (pImo ? pImo->get_parent_imo() : nullptr);
+    while (pParent && !pParent->is_score())
+        pParent = pParent->get_parent_imo();
+
+    return (pParent ? pParent->get_id() : k_no_imoid);
+}
+
+//---------------------------------------------------------------------------------------
+ImoId DocCommand::find_score_id(Document* pDoc, const list<ImoId>& ids)
+{
+    //Returns the id of the score containing all the objects, or k_no_imoid if they
+    //are not in the same score
+
+    ImoId scoreId = k_no_imoid;
+    list<ImoId>::const_iterator it;
+    for (it = ids.begin(); it != ids.end(); ++it)
+    {
+        ImoId id = find_score_id(pDoc, *it);
+        if (id == k_no_imoid || (scoreId != k_no_imoid && id != scoreId))
+            return k_no_imoid;
+        scoreId = id;
+    }
+    return scoreId;
+}
+
+//---------------------------------------------------------------------------------------
+ImoId DocCommand::find_score_id(DocCursor* pCursor)
+{
+    ImoObj* pParent = pCursor->get_parent_object();
+    return (pParent && pParent->is_score() ? pParent->get_id() : k_no_imoid);
+}
+
 //---------------------------------------------------------------------------------------
 void DocCommand::log_forensic_data(Document* UNUSED(pDoc), DocCursor* UNUSED(pCursor))
 {
@@ -168,6 +216,22 @@ int DocCmdComposite::set_target(Document* pDoc, DocCursor* pCursor,
     return result;
 }
 
+//---------------------------------------------------------------------------------------
+ImoId DocCmdComposite::get_target_score_id(Document* pDoc, DocCursor* pCursor)
+{
+    //all children commands must modify the same score
+    ImoId scoreId = k_no_imoid;
+    list<DocCommand*>::iterator it;
+    for (it=m_commands.begin(); it != m_commands.end(); ++it)
+    {
+        ImoId id = (*it)->get_target_score_id(pDoc, pCursor);
+        if (id == k_no_imoid || (scoreId != k_no_imoid && id != scoreId))
+            return k_no_imoid;
+        scoreId = id;
+    }
+    return scoreId;
+}
+
 //---------------------------------------------------------------------------------------
 int DocCmdComposite::perform_action(Document* pDoc, DocCursor* pCursor)
 {
@@ -175,26 +239,38 @@ int DocCmdComposite::perform_action(Document* pDoc, DocCursor* pCursor)
 
     log_forensic_data(pDoc, pCursor);
 
+    //children commands modifying the same score will update it only once
+    pDoc->begin_transaction();
+
     list<DocCommand*>::iterator it;
     for (it=m_commands.begin(); it != m_commands.end(); ++it)
     {
+        //the cursor requires the structures updated by previous commands
+        if ((*it)->uses_cursor())
+            pDoc->flush_deferred_changes();
+
         if ((*it)->get_cursor_update_policy() == DocCommand::k_refresh)
             (*it)->set_final_cursor_pos( pCursor->get_pointee_id() );
 
         result &= (*it)->perform_action(pDoc, pCursor);
     }
 
+    pDoc->commit_transaction();
     return result;
 }
 
 //---------------------------------------------------------------------------------------
 void DocCmdComposite::undo_action(Document* pDoc, DocCursor* pCursor)
 {
+    pDoc->begin_transaction();
+
     list<DocCommand*>::reverse_iterator it;
     for (it=m_commands.rbegin(); it != m_commands.rend(); ++it)
     {
         (*it)->undo_action(pDoc, pCursor);
     }
+
+    pDoc->commit_transaction();
 }
 
 //---------------------------------------------------------------------------------------
@@ -225,20 +301,38 @@ void DocCmdComposite::update_selection(SelectionSet* pSelection,
 DocCommandExecuter::DocCommandExecuter(Document* target)
     : m_pDoc(target)
 {
+    //start state. Nothing is copied until the document is modified
+    Checkpoint start = { 0, nullptr, vector<ScoreCopy*>(), k_no_imoid };
+    m_checkpoints.push_back(start);
 }
 
 //---------------------------------------------------------------------------------------
 DocCommandExecuter::~DocCommandExecuter()
 {
-    delete m_pModelStart;
+    vector<Checkpoint>::iterator it;
+    for (it = m_checkpoints.begin(); it != m_checkpoints.end(); ++it)
+        delete_checkpoint_data(*it);
+}
+
+//---------------------------------------------------------------------------------------
+void DocCommandExecuter::set_checkpoints_policy(size_t numCommands, double millisecs,
+                                                size_t maxCheckpoints)
+{
+    m_checkpointInterval = max(numCommands, size_t(1));
+    m_checkpointBudget = millisecs;
+    m_maxCheckpoints = max(maxCheckpoints, size_t(2));
+    limit_checkpoints();
 }
 
 //---------------------------------------------------------------------------------------
 int DocCommandExecuter::execute(DocCursor* pCursor, DocCommand* pCmd,
                                 SelectionSet* pSelection)
 {
-    if (m_pModelStart == nullptr)
-        m_pModelStart = m_pDoc->create_model_copy();
+    NodePoolScope pool(m_pDoc->get_doc_model()->get_node_pool());
+    if (is_pending_cursor_needed(pCursor, pCmd))
+        update_pending_cursor();
+    else if (pCmd->uses_cursor())
+        m_pDoc->flush_deferred_changes();
 
     int result = k_success;
     if (!pCmd->is_target_set_in_constructor())
@@ -256,14 +350,24 @@ int DocCommandExecuter::execute(DocCursor* pCursor, DocCommand* pCmd,
         if (pCmd->get_cursor_update_policy() == DocCommand::k_refresh)
             pCmd->set_final_cursor_pos( pCursor->get_pointee_id() );
 
+        //by design, only reversible commands modify the document
+        if (pCmd->is_reversible())
+            save_checkpoint(m_stack.size(), pCmd, pCursor);
+
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
         result = pCmd->perform_action(m_pDoc, pCursor);
+        if (pUE)
+        {
+            pUE->execTime = chrono::duration<double, milli>(
+                                        chrono::steady_clock::now() - start).count();
+        }
         m_error = pCmd->get_error();
         if ( result == k_success && pCmd->is_reversible())
         {
             //by design, all commands that modify the document are reversible and must
             //support undo/redo
             m_stack.push( pUE );
-            update_cursor(pCursor, pCmd);
+            update_cursor_or_defer(pCursor, pCmd);
             update_selection(pSelection, pCmd);
             m_pDoc->set_modified();
         }
@@ -355,6 +459,7 @@ void DocCommandExecuter::update_selection(SelectionSet* pSelection, DocCommand*
             {
                 if (pSelection)
                 {
+                    m_pDoc->flush_deferred_changes();
                     pSelection->clear();
                     pCmd->update_selection(pSelection);
                 }
@@ -371,15 +476,22 @@ void DocCommandExecuter::update_selection(SelectionSet* pSelection, DocCommand*
 //---------------------------------------------------------------------------------------
 void DocCommandExecuter::undo(DocCursor* pCursor, SelectionSet* pSelection)
 {
+    update_pending_cursor();
+
     UndoElement* pUE = m_stack.pop();
     if (pUE)
     {
+        //checkpoints after the undone command are no longer needed
+        remove_checkpoints_after( m_stack.size() );
+
+        NodePoolScope pool(m_pDoc->get_doc_model()->get_node_pool());
         DocCommand* cmd = pUE->pCmd;
         if (cmd->get_undo_policy() == DocCommand::k_undo_policy_replay_from_start)
             replay_until(pUE, pCursor, pSelection);
         else
         {
             cmd->undo_action(m_pDoc, pCursor);
+            m_pDoc->flush_deferred_changes();
             pCursor->restore_state( pUE->cursorState );
             pSelection->restore_state( pUE->selState );
         }
@@ -391,32 +503,35 @@ void DocCommandExecuter::undo(DocCursor* pCursor, SelectionSet* pSelection)
 void DocCommandExecuter::replay_until(UndoElement* pUE, DocCursor* pCursor,
                                       SelectionSet* pSelection)
 {
-    //restore initial model
-    m_pDoc->replace_model(m_pModelStart);
-    m_pModelStart = LOMSE_NEW DocModel(*m_pModelStart);
+    //AWARE: pUE is already removed from the stack and the checkpoints after it have
+    //been removed. Restore the last checkpoint. It is now shared with the document
+    //and it will be copied again only if there are commands to replay
+    size_t iStart = m_checkpoints.back().index;
+    restore_last_checkpoint();
+    NodePoolScope pool(m_pDoc->get_doc_model()->get_node_pool());
 
-    //re-play all commands until the desired one
-    for (size_t i=0; i < m_stack.size(); ++i)
-    {
-        UndoElement* pUEi = m_stack.get_item(i);
-        if (pUEi == pUE)
-            break;
-
-        replay_command(pUEi, pCursor, pSelection);
-    }
+    //re-play the commands after the checkpoint. When there are many (i.e. some
+    //checkpoints were removed) new checkpoints are saved, so that next undo will
+    //not need to replay them again
+    for (size_t i=iStart; i < m_stack.size(); ++i)
+        replay_command(i, pCursor, pSelection);
 
     //restore selection and cursor state
+    m_pDoc->flush_deferred_changes();
     pCursor->restore_state( pUE->cursorState );
     pSelection->restore_state( pUE->selState );
 }
 
 //---------------------------------------------------------------------------------------
-void DocCommandExecuter::replay_command(UndoElement* pUE, DocCursor* pCursor,
+void DocCommandExecuter::replay_command(size_t index, DocCursor* pCursor,
                                         SelectionSet* pSelection)
 {
+    UndoElement* pUE = m_stack.get_item(int(index));
+    m_pDoc->flush_deferred_changes();
     pCursor->restore_state( pUE->cursorState );
     pSelection->restore_state( pUE->selState );
     DocCommand* cmd = pUE->pCmd;
+    save_checkpoint(index, cmd, pCursor);
     cmd->perform_action(m_pDoc, pCursor);
 
     //by design, all commands that modify the document are reversible
@@ -427,15 +542,20 @@ void DocCommandExecuter::replay_command(UndoElement* pUE, DocCursor* pCursor,
 //---------------------------------------------------------------------------------------
 void DocCommandExecuter::redo(DocCursor* pCursor, SelectionSet* pSelection)
 {
+    update_pending_cursor();
+
     UndoElement* pUE = m_stack.undo_pop();
     if (pUE)
     {
         pCursor->restore_state( pUE->cursorState );
         pSelection->restore_state( pUE->selState );
+        NodePoolScope pool(m_pDoc->get_doc_model()->get_node_pool());
         DocCommand* cmd = pUE->pCmd;
+        if (cmd->is_reversible())
+            save_checkpoint(m_stack.size() - 1, cmd, pCursor);
         cmd->perform_action(m_pDoc, pCursor);
 
-        update_cursor(pCursor, cmd);
+        update_cursor_or_defer(pCursor, cmd);
         update_selection(pSelection, cmd);
         m_pDoc->set_dirty();
 
@@ -445,6 +565,276 @@ void DocCommandExecuter::redo(DocCursor* pCursor, SelectionSet* pSelection)
     }
 }
 
+//---------------------------------------------------------------------------------------
+void DocCommandExecuter::begin_transaction()
+{
+    m_pDoc->begin_transaction();
+}
+
+//---------------------------------------------------------------------------------------
+void DocCommandExecuter::commit_transaction()
+{
+    m_pDoc->commit_transaction();
+
+    if (!m_pDoc->is_in_transaction())
+        update_pending_cursor();
+}
+
+//---------------------------------------------------------------------------------------
+void DocCommandExecuter::update_cursor_or_defer(DocCursor* pCursor, DocCommand* pCmd)
+{
+    //Updating the cursor requires updated score structures. In a transaction, the
+    //update is deferred until the cursor is needed
+
+    if (!m_pDoc->is_in_transaction())
+    {
+        update_cursor(pCursor, pCmd);
+        return;
+    }
+
+    //a pending update is not superseded by a command that does not move the cursor
+    if (m_pPendingCmd == nullptr || pCmd->is_composite()
+        || pCmd->get_cursor_update_policy() != DocCommand::k_do_nothing)
+    {
+        m_pPendingCmd = pCmd;
+        m_pPendingCursor = pCursor;
+    }
+}
+
+//---------------------------------------------------------------------------------------
+void DocCommandExecuter::update_pending_cursor()
+{
+    //the cursor and the selection require updated score structures
+    m_pDoc->flush_deferred_changes();
+
+    if (m_pPendingCmd)
+    {
+        DocCommand* pCmd = m_pPendingCmd;
+        m_pPendingCmd = nullptr;
+        update_cursor(m_pPendingCursor, pCmd);
+    }
+}
+
+//---------------------------------------------------------------------------------------
+bool DocCommandExecuter::is_pending_cursor_needed(DocCursor* pCursor, DocCommand* pCmd)
+{
+    //Returns true if the pending cursor update must be done before executing pCmd.
+    //This is not needed when pCmd does not use the cursor and the cursor position
+    //was not changed by the pending command
+
+    if (m_pPendingCmd == nullptr)
+        return false;
+
+    if (pCmd->uses_cursor() || pCursor != m_pPendingCursor
+        || m_pPendingCmd->is_composite())
+    {
+        return true;
+    }
+
+    int policy = m_pPendingCmd->get_cursor_update_policy();
+    return policy != DocCommand::k_refresh && policy != DocCommand::k_do_nothing;
+}
+
+//---------------------------------------------------------------------------------------
+void DocCommandExecuter::save_checkpoint(size_t index, DocCommand* pCmd,
+                                         DocCursor* pCursor)
+{
+    //AWARE: to be invoked before performing the command that will be at position
+    //'index' in the undo stack, and that will modify the document.
+
+    //Copy-on-write: the state at the last checkpoint is the current document, but
+    //for the parts already modified after it. Therefore, only the parts that this
+    //command will modify and that are not yet saved have to be copied.
+    bool fSaved = m_checkpoints.back().pModel || !m_checkpoints.back().scores.empty();
+    if (fSaved && is_checkpoint_needed(index))
+    {
+        Checkpoint cp = { index, nullptr, vector<ScoreCopy*>(), k_no_imoid };
+        m_checkpoints.push_back(cp);
+        limit_checkpoints();
+        fSaved = false;
+    }
+
+    Checkpoint& cp = m_checkpoints.back();
+    if (cp.pModel)
+        return;     //the whole model is saved
+
+    DocModel* pModel = m_pDoc->get_doc_model();
+    if (!fSaved)
+        cp.idCounter = pModel->get_ids_counter();
+
+    ImoId scoreId = pCmd->get_target_score_id(m_pDoc, pCursor);
+    if (scoreId != k_no_imoid)
+    {
+        if (find_score_copy(cp, scoreId))
+            return;     //already saved
+
+        ScoreCopy* pCopy = m_pDoc->create_score_copy(scoreId);
+        if (pCopy)
+        {
+            cp.scores.push_back(pCopy);
+            return;
+        }
+    }
+
+    //the command could modify any part of the document. Save the whole model
+    save_whole_model(cp, m_pDoc->create_model_copy());
+}
+
+//---------------------------------------------------------------------------------------
+void DocCommandExecuter::save_whole_model(Checkpoint& cp, DocModel* pModel)
+{
+    //pModel is a copy of the model in a later state. The scores saved in the
+    //checkpoint are the only differences: restore them in the copy
+    cp.pModel = pModel;
+    vector<ScoreCopy*>::iterator it;
+    for (it = cp.scores.begin(); it != cp.scores.end(); ++it)
+    {
+        pModel->restore_score_copy(*it);
+        delete *it;
+    }
+    cp.scores.clear();
+}
+
+//---------------------------------------------------------------------------------------
+void DocCommandExecuter::restore_last_checkpoint()
+{
+    //After restoring it, the checkpoint is shared with the document
+    Checkpoint& cp = m_checkpoints.back();
+    if (cp.pModel)
+    {
+        m_pDoc->replace_model(cp.pModel);
+        cp.pModel = nullptr;
+    }
+    else if (cp.scores.empty())
+        return;     //nothing modified
+
+    vector<ScoreCopy*>::iterator it;
+    for (it = cp.scores.begin(); it != cp.scores.end(); ++it)
+    {
+        m_pDoc->restore_score_copy(*it);
+        delete *it;
+    }
+    cp.scores.clear();
+
+    //ids for the objects created when replaying commands must be the same than
+    //when the commands were executed, as cursor and selection states use them
+    m_pDoc->get_doc_model()->set_ids_counter(cp.idCounter);
+}
+
+//---------------------------------------------------------------------------------------
+bool DocCommandExecuter::is_checkpoint_needed(size_t index)
+{
+    size_t iLast = m_checkpoints.back().index;
+    if (index <= iLast)
+        return false;
+
+    if (index - iLast >= m_checkpointInterval)
+        return true;
+
+    //time for replaying the commands after last checkpoint
+    double time = 0.0;
+    for (size_t i=iLast; i < index; ++i)
+        time += m_stack.get_item(int(i))->execTime;
+
+    return time > m_checkpointBudget;
+}
+
+//---------------------------------------------------------------------------------------
+void DocCommandExecuter::remove_checkpoints_after(size_t index)
+{
+    //the start checkpoint is never removed
+    while (m_checkpoints.size() > 1 && m_checkpoints.back().index > index)
+        remove_checkpoint(m_checkpoints.size() - 1);
+}
+
+//---------------------------------------------------------------------------------------
+void DocCommandExecuter::limit_checkpoints()
+{
+    //Remove the checkpoint whose removal creates the smallest gap, relative to its
+    //distance to the last checkpoint. Thus, gaps grow with the age of the commands and
+    //undoing the most recent commands remains fast. The start and the last
+    //checkpoints are never removed
+    while (m_checkpoints.size() > m_maxCheckpoints && m_checkpoints.size() > 2)
+    {
+        size_t iLast = m_checkpoints.back().index;
+        size_t iRemove = 1;
+        double minGap = numeric_limits<double>::max();
+        for (size_t i=1; i+1 < m_checkpoints.size(); ++i)
+        {
+            double gap = double(m_checkpoints[i+1].index - m_checkpoints[i-1].index)
+                         / double(iLast - m_checkpoints[i-1].index);
+            if (gap < minGap)
+            {
+                minGap = gap;
+                iRemove = i;
+            }
+        }
+
+        remove_checkpoint(iRemove);
+    }
+}
+
+//---------------------------------------------------------------------------------------
+void DocCommandExecuter::remove_checkpoint(size_t i)
+{
+    //The state at the previous checkpoint is only saved for the parts modified
+    //between both checkpoints. The other parts are as in this checkpoint. Therefore,
+    //the previous checkpoint takes from this one the parts it has not saved.
+    Checkpoint& cp = m_checkpoints[i];
+    Checkpoint& prev = m_checkpoints[i-1];
+    if (prev.pModel == nullptr)
+    {
+        if (prev.scores.empty())
+            prev.idCounter = cp.idCounter;
+
+        if (cp.pModel)
+        {
+            save_whole_model(prev, cp.pModel);
+            cp.pModel = nullptr;
+        }
+        else
+        {
+            vector<ScoreCopy*> scores;
+            vector<ScoreCopy*>::iterator it;
+            for (it = cp.scores.begin(); it != cp.scores.end(); ++it)
+            {
+                if (find_score_copy(prev, (*it)->get_score_id()))
+                    scores.push_back(*it);
+                else
+                    prev.scores.push_back(*it);
+            }
+            cp.scores.swap(scores);
+        }
+    }
+
+    delete_checkpoint_data(cp);
+    m_checkpoints.erase(m_checkpoints.begin() + i);
+}
+
+//---------------------------------------------------------------------------------------
+ScoreCopy* DocCommandExecuter::find_score_copy(Checkpoint& cp, ImoId scoreId)
+{
+    vector<ScoreCopy*>::iterator it;
+    for (it = cp.scores.begin(); it != cp.scores.end(); ++it)
+    {
+        if ((*it)->get_score_id() == scoreId)
+            return *it;
+    }
+    return nullptr;
+}
+
+//---------------------------------------------------------------------------------------
+void DocCommandExecuter::delete_checkpoint_data(Checkpoint& cp)
+{
+    delete cp.pModel;
+    cp.pModel = nullptr;
+
+    vector<ScoreCopy*>::iterator it;
+    for (it = cp.scores.begin(); it != cp.scores.end(); ++it)
+        delete *it;
+    cp.scores.clear();
+}
+
 ////---------------------------------------------------------------------------------------
 //void DocCommandExecuter::replay(DocCursor* pCursor)
 //{
@@ -517,6 +907,12 @@ int CmdAddChordNote::set_target(Document* UNUSED(pDoc), DocCursor* UNUSED(pCurso
     return k_success;
 }
 
+//---------------------------------------------------------------------------------------
+ImoId CmdAddChordNote::get_target_score_id(Document* pDoc, DocCursor* UNUSED(pCursor))
+{
+    return find_score_id(pDoc, m_baseId);
+}
+
 //---------------------------------------------------------------------------------------
 int CmdAddChordNote::perform_action(Document* pDoc, DocCursor* pCursor)
 {
@@ -541,8 +937,8 @@ int CmdAddChordNote::perform_action(Document* pDoc, DocCursor* pCursor)
     //create or update the chord
     ImoTreeAlgoritms::add_note_to_chord(pBaseNote, pNewNote, pDoc);
 
-    //force to rebuild ColStaffObjs table
-    pScore->end_of_changes();
+    //update ColStaffObjs table
+    pScore->end_of_changes(pInstr, pBaseNote, pNewNote);
 
     return k_success;
 }
@@ -578,6 +974,9 @@ CmdAddNoteRest::CmdAddNoteRest(const string& source, int UNUSED(editMode),
     , m_newDuration(0.0)
     , m_pAt(nullptr)
     , m_pLastOverlapped(nullptr)
+    , m_fUpdateAll(false)
+    , m_pFirstAffected(nullptr)
+    , m_pLastAffected(nullptr)
 {
     m_flags = k_recordable | k_reversible;
 }
@@ -602,6 +1001,12 @@ int CmdAddNoteRest::set_target(Document* UNUSED(pDoc), DocCursor* pCursor,
         return k_failure;
 }
 
+//---------------------------------------------------------------------------------------
+ImoId CmdAddNoteRest::get_target_score_id(Document* UNUSED(pDoc), DocCursor* pCursor)
+{
+    return find_score_id(pCursor);
+}
+
 //---------------------------------------------------------------------------------------
 int CmdAddNoteRest::perform_action(Document* pDoc, DocCursor* pCursor)
 {
@@ -615,6 +1020,7 @@ int CmdAddNoteRest::perform_action(Document* pDoc, DocCursor* pCursor)
     get_data_about_noterest_to_insert();
     find_and_classify_overlapped_noterests();
     determine_insertion_point();
+    determine_affected_objects();
     if (!m_overlaps.empty())
     {
         reduce_duration_of_overlapped_at_end();
@@ -631,8 +1037,14 @@ int CmdAddNoteRest::perform_action(Document* pDoc, DocCursor* pCursor)
 
     clear_temporary_objects();
 
-    //rebuild ColStaffObjs table, as there are objects added/removed
-    m_pScore->end_of_changes();
+    //update ColStaffObjs table, as there are objects added/removed
+    if (m_fUpdateAll || m_insertedObjs.empty())
+        m_pScore->end_of_changes();
+    else
+        m_pScore->end_of_changes(m_pInstr, m_pFirstAffected, m_pLastAffected);
+
+    //the cursor requires updated score structures, also in a transaction
+    pDoc->flush_deferred_changes();
     update_cursor();
 
     return k_success;
@@ -742,6 +1154,64 @@ void CmdAddNoteRest::determine_insertion_point()
     m_pAt = static_cast<ImoStaffObj*>(m_pDoc->get_pointer_to_imo(m_idAt));
 }
 
+//---------------------------------------------------------------------------------------
+void CmdAddNoteRest::determine_affected_objects()
+{
+    //AWARE: This is executed *before* any change
+    //Modified objects are the overlapped notes/rests and the new content, inserted
+    //before m_pAt. Determine the objects enclosing all them, for updating only the
+    //affected measures.
+
+    ColStaffObjsEntry* pFirst = nullptr;
+    ColStaffObjsEntry* pLast = (m_pAt ? m_pAt->get_colstaffobjs_entry() : nullptr);
+    list<OverlappedNoteRest*>::const_iterator it;
+    for (it = m_overlaps.begin(); it != m_overlaps.end(); ++it)
+    {
+        ImoNoteRest* pNR = (*it)->pNR;
+        ColStaffObjsEntry* pEntry = pNR->get_colstaffobjs_entry();
+        if (pNR->is_in_tuplet() || !pEntry || pEntry->index() < 0)
+        {
+            //durations of other notes could change
+            m_fUpdateAll = true;
+            return;
+        }
+
+        if (!pFirst || pEntry->index() < pFirst->index())
+            pFirst = pEntry;
+        if ((*it)->type == k_overlap_at_start && pLast
+            && pEntry->index() > pLast->index())
+        {
+            pLast = pEntry;
+        }
+    }
+    m_pLastAffected = (pLast ? pLast->imo_object() : nullptr);
+
+    //first affected: the object before the first modified one
+    ImoObj* pPrev = nullptr;
+    if (pFirst)
+        pPrev = pFirst->imo_object()->get_prev_sibling();
+    else if (m_pAt)
+        pPrev = m_pAt->get_prev_sibling();
+    else
+        pPrev = m_pInstr->get_musicdata()->get_last_child();
+
+    while (pPrev && is_overlapped(pPrev))
+        pPrev = pPrev->get_prev_sibling();
+    m_pFirstAffected = static_cast<ImoStaffObj*>(pPrev);
+}
+
+//---------------------------------------------------------------------------------------
+bool CmdAddNoteRest::is_overlapped(ImoObj* pImo)
+{
+    list<OverlappedNoteRest*>::const_iterator it;
+    for (it = m_overlaps.begin(); it != m_overlaps.end(); ++it)
+    {
+        if ((*it)->pNR == pImo)
+            return true;
+    }
+    return false;
+}
+
 //---------------------------------------------------------------------------------------
 void CmdAddNoteRest::reduce_duration_of_overlapped_at_end()
 {
@@ -773,7 +1243,9 @@ void CmdAddNoteRest::remove_fully_overlapped()
 //---------------------------------------------------------------------------------------
 void CmdAddNoteRest::insert_new_content()
 {
-    m_insertedObjs = ImoTreeAlgoritms::insert_staffobjs(m_pInstr, m_pAt, m_finalSrc);
+    //ColStaffObjs table will be updated when all changes are done
+    stringstream errormsg;
+    m_insertedObjs = m_pInstr->insert_staff_objects_at(m_pAt, m_finalSrc, errormsg);
 }
 
 //---------------------------------------------------------------------------------------
@@ -886,7 +1358,7 @@ CmdAddTie::CmdAddTie(const string& name)
     , m_endId(k_no_imoid)
     , m_tieId(k_no_imoid)
 {
-    m_flags = k_recordable | k_reversible;
+    m_flags = k_recordable | k_reversible | k_cursor_not_used;
 }
 
 //---------------------------------------------------------------------------------------
@@ -904,6 +1376,12 @@ int CmdAddTie::set_target(Document* UNUSED(pDoc), DocCursor* UNUSED(pCursor),
     return k_failure;
 }
 
+//---------------------------------------------------------------------------------------
+ImoId CmdAddTie::get_target_score_id(Document* pDoc, DocCursor* UNUSED(pCursor))
+{
+    return find_score_id(pDoc, m_startId);
+}
+
 //---------------------------------------------------------------------------------------
 void CmdAddTie::log_command(ostream &logger)
 {
@@ -942,7 +1420,7 @@ CmdAddTuplet::CmdAddTuplet(const string& src, const string& name)
     , m_tupletId(k_no_imoid)
     , m_source(src)
 {
-    m_flags = k_recordable | k_reversible;
+    m_flags = k_recordable | k_reversible | k_cursor_not_used;
 }
 
 //---------------------------------------------------------------------------------------
@@ -964,6 +1442,12 @@ int CmdAddTuplet::set_target(Document* UNUSED(pDoc), DocCursor* UNUSED(pCursor),
     return k_failure;
 }
 
+//---------------------------------------------------------------------------------------
+ImoId CmdAddTuplet::get_target_score_id(Document* pDoc, DocCursor* UNUSED(pCursor))
+{
+    return find_score_id(pDoc, m_startId);
+}
+
 //---------------------------------------------------------------------------------------
 void CmdAddTuplet::log_command(ostream &logger)
 {
@@ -1031,6 +1515,12 @@ int CmdBreakBeam::set_target(Document* UNUSED(pDoc), DocCursor* pCursor,
     return k_failure;
 }
 
+//---------------------------------------------------------------------------------------
+ImoId CmdBreakBeam::get_target_score_id(Document* pDoc, DocCursor* UNUSED(pCursor))
+{
+    return find_score_id(pDoc, m_beforeId);
+}
+
 //---------------------------------------------------------------------------------------
 void CmdBreakBeam::log_command(ostream &logger)
 {
@@ -1146,6 +1636,27 @@ int CmdBreakBeam::perform_action(Document* pDoc, DocCursor* pCursor)
 }
 
 
+//=======================================================================================
+// NotePitchImage implementation
+//=======================================================================================
+NotePitchImage::NotePitchImage(ImoNote* pNote)
+    : id( pNote->get_id() )
+    , step( pNote->get_step() )
+    , octave( pNote->get_octave() )
+    , actualAcc( pNote->get_actual_accidentals() )
+    , notatedAcc( pNote->get_notated_accidentals() )
+{
+}
+
+//---------------------------------------------------------------------------------------
+void NotePitchImage::restore(ImoNote* pNote) const
+{
+    pNote->set_pitch(step, octave, actualAcc);
+    pNote->set_notated_accidentals(notatedAcc);
+    pNote->set_dirty(true);
+}
+
+
 //=======================================================================================
 // CmdChangeAccidentals implementation
 //=======================================================================================
@@ -1153,7 +1664,7 @@ CmdChangeAccidentals::CmdChangeAccidentals(EAccidentals acc, const string& name)
     : DocCmdSimple(name)
     , m_acc(acc)
 {
-    m_flags = k_recordable | k_reversible;
+    m_flags = k_recordable | k_reversible | k_cursor_not_used;
 }
 
 //---------------------------------------------------------------------------------------
@@ -1168,6 +1679,13 @@ int CmdChangeAccidentals::set_target(Document* UNUSED(pDoc), DocCursor* UNUSED(p
     return k_failure;
 }
 
+//---------------------------------------------------------------------------------------
+ImoId CmdChangeAccidentals::get_target_score_id(Document* pDoc,
+                                                DocCursor* UNUSED(pCursor))
+{
+    return find_score_id(pDoc, m_notes);
+}
+
 //---------------------------------------------------------------------------------------
 void CmdChangeAccidentals::log_command(ostream &logger)
 {
@@ -1180,14 +1698,17 @@ int CmdChangeAccidentals::perform_action(Document* pDoc, DocCursor* UNUSED(pCurs
     //AWARE: changing accidentals in one note could affect many notes in the
     //same measure
 
-    bool fSavePitch = (m_oldPitch.size() == 0);     //AWARE: for redo pitch is already saved
+    m_oldPitch.clear();
     ImoScore* pScore = nullptr;
     list<ImoId>::iterator it;
     for (it = m_notes.begin(); it != m_notes.end(); ++it)
     {
-        ImoNote* pNote = static_cast<ImoNote*>( pDoc->get_pointer_to_imo(*it) );
-        if (fSavePitch)
-            m_oldPitch.push_back( pNote->get_fpitch() );
+        ImoObj* pImo = pDoc->get_pointer_to_imo(*it);
+        if (!pImo || !pImo->is_note())
+            continue;
+
+        ImoNote* pNote = static_cast<ImoNote*>(pImo);
+        m_oldPitch.push_back( NotePitchImage(pNote) );
         pNote->set_notated_accidentals(m_acc);
         pNote->request_pitch_recomputation();
         pNote->set_dirty(true);
@@ -1195,12 +1716,36 @@ int CmdChangeAccidentals::perform_action(Document* pDoc, DocCursor* UNUSED(pCurs
             pScore = pNote->get_score();
     }
 
+    if (!pScore)
+        return k_failure;
+
     PitchAssigner tuner;
     tuner.assign_pitch(pScore);
 
     return k_success;
 }
 
+//---------------------------------------------------------------------------------------
+void CmdChangeAccidentals::undo_action(Document* pDoc, DocCursor* UNUSED(pCursor))
+{
+    //restore saved pitch and recompute the accidentals of the other notes
+    ImoScore* pScore = nullptr;
+    list<NotePitchImage>::const_iterator it;
+    for (it = m_oldPitch.begin(); it != m_oldPitch.end(); ++it)
+    {
+        ImoNote* pNote = static_cast<ImoNote*>( pDoc->get_pointer_to_imo(it->id) );
+        it->restore(pNote);
+        if (!pScore)
+            pScore = pNote->get_score();
+    }
+
+    if (pScore)
+    {
+        PitchAssigner tuner;
+        tuner.assign_pitch(pScore);
+    }
+}
+
 
 //=======================================================================================
 // CmdChangeAttribute implementation
@@ -1269,7 +1814,8 @@ CmdChangeAttribute::CmdChangeAttribute(ImoObj* pImo, EImoAttribute attrb,
     , m_newDouble(0.0)
     , m_newInt(0)
 {
-    m_flags = k_recordable | k_reversible | k_target_set_in_constructor;
+    m_flags = k_recordable | k_reversible | k_target_set_in_constructor
+               | k_cursor_not_used;
     set_target(pImo);
 }
 
@@ -1283,7 +1829,8 @@ CmdChangeAttribute::CmdChangeAttribute(ImoObj* pImo, EImoAttribute attrb,
     , m_newDouble(value)
     , m_newInt(0)
 {
-    m_flags = k_recordable | k_reversible | k_target_set_in_constructor;
+    m_flags = k_recordable | k_reversible | k_target_set_in_constructor
+               | k_cursor_not_used;
     set_target(pImo);
 }
 
@@ -1297,7 +1844,8 @@ CmdChangeAttribute::CmdChangeAttribute(ImoObj* pImo, EImoAttribute attrb,
     , m_newDouble(0.0)
     , m_newInt(value)
 {
-    m_flags = k_recordable | k_reversible | k_target_set_in_constructor;
+    m_flags = k_recordable | k_reversible | k_target_set_in_constructor
+               | k_cursor_not_used;
     set_target(pImo);
 }
 
@@ -1312,7 +1860,8 @@ CmdChangeAttribute::CmdChangeAttribute(ImoObj* pImo, EImoAttribute attrb,
     , m_newInt(0)
     , m_newColor(value)
 {
-    m_flags = k_recordable | k_reversible | k_target_set_in_constructor;
+    m_flags = k_recordable | k_reversible | k_target_set_in_constructor
+               | k_cursor_not_used;
     set_target(pImo);
 }
 
@@ -1328,6 +1877,18 @@ int CmdChangeAttribute::set_target(Document* UNUSED(pDoc), DocCursor* pCursor,
     return set_target(pImo);
 }
 
+//---------------------------------------------------------------------------------------
+ImoId CmdChangeAttribute::get_target_score_id(Document* pDoc,
+                                              DocCursor* UNUSED(pCursor))
+{
+    //changing an attribute of the score itself only modifies the score
+    ImoObj* pImo = pDoc->get_pointer_to_imo(m_targetId);
+    if (pImo && pImo->is_score())
+        return m_targetId;
+
+    return find_score_id(pDoc, m_targetId);
+}
+
 //---------------------------------------------------------------------------------------
 int CmdChangeAttribute::set_target(ImoObj* pImo)
 {
@@ -1343,6 +1904,7 @@ int CmdChangeAttribute::set_target(ImoObj* pImo)
 int CmdChangeAttribute::perform_action(Document* pDoc, DocCursor* UNUSED(pCursor))
 {
     ImoObj* pImo = pDoc->get_pointer_to_imo( m_targetId );
+    save_old_value(pImo);
     switch (m_dataType)
     {
         case k_type_bool:
@@ -1361,6 +1923,56 @@ int CmdChangeAttribute::perform_action(Document* pDoc, DocCursor* UNUSED(pCursor
     return k_success;
 }
 
+//---------------------------------------------------------------------------------------
+void CmdChangeAttribute::save_old_value(ImoObj* pImo)
+{
+    //AWARE: some attributes are not stored in the attributes list but in member
+    //variables. For them, m_fOldExists will be false but getters return the right value
+    m_fOldExists = (pImo->get_attribute(m_attrb) != nullptr);
+    switch (m_dataType)
+    {
+        case k_type_bool:
+            m_oldInt = (pImo->get_bool_attribute(m_attrb) ? 1 : 0);    break;
+        case k_type_color:
+            m_oldColor = pImo->get_color_attribute(m_attrb);          break;
+        case k_type_double:
+            m_oldDouble = pImo->get_double_attribute(m_attrb);        break;
+        case k_type_int:
+            m_oldInt = pImo->get_int_attribute(m_attrb);              break;
+        case k_type_string:
+            m_oldString = pImo->get_string_attribute(m_attrb);        break;
+        default:
+            break;
+    }
+}
+
+//---------------------------------------------------------------------------------------
+void CmdChangeAttribute::undo_action(Document* pDoc, DocCursor* UNUSED(pCursor))
+{
+    ImoObj* pImo = pDoc->get_pointer_to_imo( m_targetId );
+    switch (m_dataType)
+    {
+        case k_type_bool:
+            pImo->set_bool_attribute(m_attrb, m_oldInt != 0); break;
+        case k_type_color:
+            pImo->set_color_attribute(m_attrb, m_oldColor);    break;
+        case k_type_double:
+            pImo->set_double_attribute(m_attrb, m_oldDouble);  break;
+        case k_type_int:
+            pImo->set_int_attribute(m_attrb, m_oldInt);        break;
+        case k_type_string:
+            pImo->set_string_attribute(m_attrb, m_oldString);  break;
+        default:
+            return;
+    }
+
+    //if the attribute was added by the command, remove it
+    if (!m_fOldExists)
+        pImo->remove_attribute(m_attrb);
+
+    pImo->set_dirty(true);
+}
+
 //=======================================================================================
 // CmdChangeDots implementation
 //=======================================================================================
@@ -1368,7 +1980,7 @@ CmdChangeDots::CmdChangeDots(int dots, const string& name)
     : DocCmdSimple(name)
     , m_dots(dots)
 {
-    m_flags = k_recordable | k_reversible;
+    m_flags = k_recordable | k_reversible | k_cursor_not_used;
 }
 
 //---------------------------------------------------------------------------------------
@@ -1384,24 +1996,91 @@ int CmdChangeDots::set_target(Document* UNUSED(pDoc), DocCursor* UNUSED(pCursor)
 }
 
 //---------------------------------------------------------------------------------------
-int CmdChangeDots::perform_action(Document* pDoc, DocCursor* pCursor)
+ImoId CmdChangeDots::get_target_score_id(Document* pDoc, DocCursor* UNUSED(pCursor))
 {
+    return find_score_id(pDoc, m_noteRests);
+}
+
+//---------------------------------------------------------------------------------------
+int CmdChangeDots::perform_action(Document* pDoc, DocCursor* UNUSED(pCursor))
+{
+    m_oldDots.clear();
     list<ImoId>::iterator it;
     for (it = m_noteRests.begin(); it != m_noteRests.end(); ++it)
     {
         ImoNoteRest* pNR = static_cast<ImoNoteRest*>( pDoc->get_pointer_to_imo(*it) );
+        m_oldDots.push_back( pNR->get_dots() );
         pNR->set_dots(m_dots);
+        pNR->set_time_modifiers_and_duration(pNR->get_time_modifier_top(),
+                                             pNR->get_time_modifier_bottom());
         pNR->set_dirty(true);
     }
 
-    //rebuild StaffObjs collection, as duration of some objects have changed and this
-    //affects to timepos of objects after them
-    ImoScore* pScore = static_cast<ImoScore*>( pCursor->get_parent_object() );
-    pScore->end_of_changes();
-
+    update_staffobjs_table(pDoc);
     return k_success;
 }
 
+//---------------------------------------------------------------------------------------
+void CmdChangeDots::undo_action(Document* pDoc, DocCursor* UNUSED(pCursor))
+{
+    list<ImoId>::iterator it;
+    list<int>::iterator itDots = m_oldDots.begin();
+    for (it = m_noteRests.begin(); it != m_noteRests.end(); ++it, ++itDots)
+    {
+        ImoNoteRest* pNR = static_cast<ImoNoteRest*>( pDoc->get_pointer_to_imo(*it) );
+        pNR->set_dots(*itDots);
+        pNR->set_time_modifiers_and_duration(pNR->get_time_modifier_top(),
+                                             pNR->get_time_modifier_bottom());
+        pNR->set_dirty(true);
+    }
+
+    update_staffobjs_table(pDoc);
+}
+
+//---------------------------------------------------------------------------------------
+void CmdChangeDots::update_staffobjs_table(Document* pDoc)
+{
+    //modified notes/rests. If all are in the same instrument, only the measures
+    //containing them will be updated
+    ImoScore* pScore = nullptr;
+    ImoInstrument* pInstr = nullptr;
+    ColStaffObjsEntry* pFirst = nullptr;
+    ColStaffObjsEntry* pLast = nullptr;
+    bool fUpdateAll = false;
+
+    list<ImoId>::iterator it;
+    for (it = m_noteRests.begin(); it != m_noteRests.end(); ++it)
+    {
+        ImoNoteRest* pNR = static_cast<ImoNoteRest*>( pDoc->get_pointer_to_imo(*it) );
+        if (!pScore)
+            pScore = pNR->get_score();
+
+        ColStaffObjsEntry* pEntry = pNR->get_colstaffobjs_entry();
+        if (!pEntry || pEntry->index() < 0
+            || (pInstr && pInstr != pNR->get_instrument()) )
+        {
+            fUpdateAll = true;
+        }
+        else
+        {
+            pInstr = pNR->get_instrument();
+            if (!pFirst || pEntry->index() < pFirst->index())
+                pFirst = pEntry;
+            if (!pLast || pEntry->index() > pLast->index())
+                pLast = pEntry;
+        }
+    }
+
+    //update StaffObjs collection, as duration of some objects have changed and this
+    //affects to timepos of objects after them
+    if (!pScore)
+        return;
+    if (fUpdateAll || !pInstr)
+        pScore->end_of_changes();
+    else
+        pScore->end_of_changes(pInstr, pFirst->imo_object(), pLast->imo_object());
+}
+
 
 //=======================================================================================
 // CmdCursor implementation
@@ -1598,6 +2277,70 @@ void CmdDelete::prepare_cursor_for_deletion(DocCursor* pCursor)
     m_cursorFinalId = state.pointee_id();   //pCursor->find_previous_pos_state().pointee_id();
 }
 
+//---------------------------------------------------------------------------------------
+bool CmdDelete::find_affected_objects(Document* pDoc, const list<ImoId>& ids,
+                                      ImoInstrument** ppInstr, ImoStaffObj** ppFirst,
+                                      ImoStaffObj** ppLast)
+{
+    //AWARE: This must be executed *before* deleting the staffobjs.
+    //When all staffobjs to delete are in the same instrument, it is possible to update
+    //only the affected measures. This method returns the instrument and the objects,
+    //not to be deleted, enclosing the deleted ones. Returns false when the score must
+    //be fully updated: when the objects are in several instruments, when a key
+    //signature is deleted (affects the pitch of notes in next measures) or when a
+    //note/rest in a tuplet is deleted (the tuplet could be removed, changing the
+    //duration of other notes).
+
+    ImoInstrument* pInstr = nullptr;
+    ColStaffObjsEntry* pFirst = nullptr;
+    ColStaffObjsEntry* pLast = nullptr;
+    for (ImoId id : ids)
+    {
+        ImoStaffObj* pSO = dynamic_cast<ImoStaffObj*>( pDoc->get_pointer_to_imo(id) );
+        if (!pSO)
+            continue;
+
+        if (pSO->is_key_signature()
+            || (pSO->is_note_rest() && static_cast<ImoNoteRest*>(pSO)->is_in_tuplet()))
+        {
+            return false;
+        }
+
+        ColStaffObjsEntry* pEntry = pSO->get_colstaffobjs_entry();
+        if (!pEntry || pEntry->index() < 0
+            || (pInstr && pInstr != pSO->get_instrument()) )
+        {
+            return false;
+        }
+
+        pInstr = pSO->get_instrument();
+        if (!pFirst || pEntry->index() < pFirst->index())
+            pFirst = pEntry;
+        if (!pLast || pEntry->index() > pLast->index())
+            pLast = pEntry;
+    }
+    if (!pInstr)
+        return false;
+
+    auto isDeleted = [&ids](ImoObj* pImo)
+    {
+        return std::find(ids.begin(), ids.end(), pImo->get_id()) != ids.end();
+    };
+
+    ImoObj* pPrev = pFirst->imo_object()->get_prev_sibling();
+    while (pPrev && isDeleted(pPrev))
+        pPrev = pPrev->get_prev_sibling();
+
+    ImoObj* pNext = pLast->imo_object()->get_next_sibling();
+    while (pNext && isDeleted(pNext))
+        pNext = pNext->get_next_sibling();
+
+    *ppInstr = pInstr;
+    *ppFirst = static_cast<ImoStaffObj*>(pPrev);
+    *ppLast = static_cast<ImoStaffObj*>(pNext);
+    return true;
+}
+
 
 //=======================================================================================
 // CmdDeleteBlockLevelObj implementation
@@ -1693,6 +2436,13 @@ int CmdDeleteRelation::set_target(Document* pDoc, DocCursor* UNUSED(pCursor),
     return k_failure;
 }
 
+//---------------------------------------------------------------------------------------
+ImoId CmdDeleteRelation::get_target_score_id(Document* pDoc,
+                                             DocCursor* UNUSED(pCursor))
+{
+    return find_score_id(pDoc, m_relobjs);
+}
+
 //---------------------------------------------------------------------------------------
 int CmdDeleteRelation::perform_action(Document* pDoc, DocCursor* pCursor)
 {
@@ -1767,20 +2517,42 @@ int CmdDeleteSelection::set_target(Document* UNUSED(pDoc), DocCursor* UNUSED(pCu
     return k_failure;
 }
 
+//---------------------------------------------------------------------------------------
+ImoId CmdDeleteSelection::get_target_score_id(Document* pDoc,
+                                              DocCursor* UNUSED(pCursor))
+{
+    //all objects to delete must be in the same score
+    list<ImoId> ids(m_idSO);
+    ids.insert(ids.end(), m_idRO.begin(), m_idRO.end());
+    ids.insert(ids.end(), m_idAO.begin(), m_idAO.end());
+    ids.insert(ids.end(), m_idOther.begin(), m_idOther.end());
+    return find_score_id(pDoc, ids);
+}
+
 //---------------------------------------------------------------------------------------
 int CmdDeleteSelection::perform_action(Document* pDoc, DocCursor* pCursor)
 {
     log_forensic_data(pDoc, pCursor);
 
+    //when only staffobjs are deleted, only the affected measures will be updated
+    ImoInstrument* pInstr = nullptr;
+    ImoStaffObj* pFirst = nullptr;
+    ImoStaffObj* pLast = nullptr;
+    bool fUpdate = m_idRO.empty() && m_idOther.empty()
+                   && find_affected_objects(pDoc, m_idSO, &pInstr, &pFirst, &pLast);
+
     prepare_cursor_for_deletion(pCursor);
     delete_staffobjs(pDoc);
     delete_relobjs(pDoc);
     delete_auxobjs(pDoc);
     delete_other(pDoc);
 
-    //rebuild StaffObjs collection
+    //update StaffObjs collection
     ImoScore* pScore = static_cast<ImoScore*>( pCursor->get_parent_object() );
-    pScore->end_of_changes();
+    if (fUpdate)
+        pScore->end_of_changes(pInstr, pFirst, pLast);
+    else
+        pScore->end_of_changes();
 
     return k_success;
 }
@@ -1961,6 +2733,13 @@ int CmdDeleteStaffObj::set_target(Document* UNUSED(pDoc), DocCursor* pCursor,
     return k_failure;
 }
 
+//---------------------------------------------------------------------------------------
+ImoId CmdDeleteStaffObj::get_target_score_id(Document* pDoc,
+                                             DocCursor* UNUSED(pCursor))
+{
+    return find_score_id(pDoc, m_id);
+}
+
 //---------------------------------------------------------------------------------------
 int CmdDeleteStaffObj::perform_action(Document* pDoc, DocCursor* pCursor)
 {
@@ -1969,6 +2748,12 @@ int CmdDeleteStaffObj::perform_action(Document* pDoc, DocCursor* pCursor)
     ImoStaffObj* pImo = dynamic_cast<ImoStaffObj*>( pDoc->get_pointer_to_imo(m_id) );
     if (pImo)
     {
+        ImoInstrument* pInstr = nullptr;
+        ImoStaffObj* pFirst = nullptr;
+        ImoStaffObj* pLast = nullptr;
+        list<ImoId> ids = { m_id };
+        bool fUpdate = find_affected_objects(pDoc, ids, &pInstr, &pFirst, &pLast);
+
         prepare_cursor_for_deletion(pCursor);
         if (m_name == "")
             set_command_name("Delete ", pImo);
@@ -1990,8 +2775,7 @@ int CmdDeleteStaffObj::perform_action(Document* pDoc, DocCursor* pCursor)
         }
 
         //delete object
-        ImoInstrument* pInstr = pImo->get_instrument();
-        pInstr->delete_staffobj(pImo);
+        pImo->get_instrument()->delete_staffobj(pImo);
 
         //ask relations to reorganize themselves
         if (relIds.size() > 0)
@@ -2005,9 +2789,12 @@ int CmdDeleteStaffObj::perform_action(Document* pDoc, DocCursor* pCursor)
             }
         }
 
-        //rebuild StaffObjs collection
+        //update StaffObjs collection
         ImoScore* pScore = static_cast<ImoScore*>( pCursor->get_parent_object() );
-        pScore->end_of_changes();
+        if (fUpdate)
+            pScore->end_of_changes(pInstr, pFirst, pLast);
+        else
+            pScore->end_of_changes();
 
         return k_success;
     }
@@ -2146,6 +2933,13 @@ int CmdInsertManyStaffObjs::set_target(Document* UNUSED(pDoc), DocCursor* pCurso
         return k_failure;
 }
 
+//---------------------------------------------------------------------------------------
+ImoId CmdInsertManyStaffObjs::get_target_score_id(Document* UNUSED(pDoc),
+                                                  DocCursor* pCursor)
+{
+    return find_score_id(pCursor);
+}
+
 //---------------------------------------------------------------------------------------
 int CmdInsertManyStaffObjs::perform_action(Document* pDoc, DocCursor* pCursor)
 {
@@ -2165,7 +2959,8 @@ int CmdInsertManyStaffObjs::perform_action(Document* pDoc, DocCursor* pCursor)
         list<ImoStaffObj*> objects = pInstr->insert_staff_objects_at(pAt, m_source, errormsg);
         if (objects.size() > 0)
         {
-            pScore->end_of_changes();        //update ColStaffObjs table
+            //update ColStaffObjs table
+            pScore->end_of_changes(pInstr, objects.front(), objects.back());
             m_lastInsertedId = objects.back()->get_id();
             objects.clear();
             return k_success;
@@ -2200,6 +2995,13 @@ int CmdInsertStaffObj::set_target(Document* UNUSED(pDoc), DocCursor* pCursor,
         return k_failure;
 }
 
+//---------------------------------------------------------------------------------------
+ImoId CmdInsertStaffObj::get_target_score_id(Document* UNUSED(pDoc),
+                                             DocCursor* pCursor)
+{
+    return find_score_id(pCursor);
+}
+
 //---------------------------------------------------------------------------------------
 int CmdInsertStaffObj::perform_action(Document* pDoc, DocCursor* pCursor)
 {
@@ -2239,7 +3041,7 @@ int CmdInsertStaffObj::perform_action(Document* pDoc, DocCursor* pCursor)
             }
 
             //update ColStaffObjs table
-            pScore->end_of_changes();
+            pScore->end_of_changes(pInstr, pImo, pImo);
 
             //assign name to this command
             if (m_name == "")
@@ -2281,6 +3083,12 @@ int CmdJoinBeam::set_target(Document* UNUSED(pDoc), DocCursor* UNUSED(pCursor),
     return k_failure;
 }
 
+//---------------------------------------------------------------------------------------
+ImoId CmdJoinBeam::get_target_score_id(Document* pDoc, DocCursor* UNUSED(pCursor))
+{
+    return find_score_id(pDoc, m_noteRests);
+}
+
 //---------------------------------------------------------------------------------------
 void CmdJoinBeam::log_command(ostream &logger)
 {
@@ -2327,7 +3135,7 @@ CmdMoveObjectPoint::CmdMoveObjectPoint(int pointIndex, UPoint shift,
     , m_pointIndex(pointIndex)
     , m_shift(shift)
 {
-    m_flags = k_recordable | k_reversible;
+    m_flags = k_recordable | k_reversible | k_cursor_not_used;
 }
 
 //---------------------------------------------------------------------------------------
@@ -2346,6 +3154,13 @@ int CmdMoveObjectPoint::set_target(Document* UNUSED(pDoc), DocCursor* UNUSED(pCu
     return k_failure;
 }
 
+//---------------------------------------------------------------------------------------
+ImoId CmdMoveObjectPoint::get_target_score_id(Document* pDoc,
+                                              DocCursor* UNUSED(pCursor))
+{
+    return find_score_id(pDoc, m_targetId);
+}
+
 //---------------------------------------------------------------------------------------
 int CmdMoveObjectPoint::perform_action(Document* pDoc, DocCursor* UNUSED(pCursor))
 {
@@ -2513,7 +3328,7 @@ void CmdSelection::set_default_name()
 CmdTranspose::CmdTranspose(const string& name)
     : DocCmdSimple(name)
 {
-    m_flags = k_recordable | k_reversible;
+    m_flags = k_recordable | k_reversible | k_cursor_not_used;
 }
 
 //---------------------------------------------------------------------------------------
@@ -2530,10 +3345,20 @@ int CmdTranspose::set_target(Document* UNUSED(pDoc),
     return k_failure;
 }
 
+//---------------------------------------------------------------------------------------
+ImoId CmdTranspose::get_target_score_id(Document* pDoc, DocCursor* UNUSED(pCursor))
+{
+    list<ImoId> ids(m_notes);
+    ids.insert(ids.end(), m_keys.begin(), m_keys.end());
+    return find_score_id(pDoc, ids);
+}
+
 //---------------------------------------------------------------------------------------
 int CmdTranspose::perform_action(Document* pDoc, DocCursor* UNUSED(pCursor))
 {
     ImoScore* pScore = nullptr;
+    m_oldPitch.clear();
+    m_oldKeys.clear();
 
     //transpose notes
     list<ImoId>::iterator itN;
@@ -2547,6 +3372,7 @@ int CmdTranspose::perform_action(Document* pDoc, DocCursor* UNUSED(pCursor))
             return k_failure;
 
         //transpose note
+        m_oldPitch.push_back( NotePitchImage(pNote) );
         transpose_note(pNote);
         pNote->set_dirty(true);
     }
@@ -2557,16 +3383,57 @@ int CmdTranspose::perform_action(Document* pDoc, DocCursor* UNUSED(pCursor))
     {
         ImoKeySignature* pKey = static_cast<ImoKeySignature*>( pDoc->get_pointer_to_imo(*itK) );
         if (pKey)
+        {
+            m_oldKeys.push_back( make_pair(*itK, pKey->get_key_type()) );
             transpose_key(pKey);
+            if (!pScore)
+                pScore = pKey->get_score();
+        }
     }
 
     //assign pitch to all notes
-    PitchAssigner tuner;
-    tuner.assign_pitch(pScore);
+    if (pScore)
+    {
+        PitchAssigner tuner;
+        tuner.assign_pitch(pScore);
+    }
 
     return k_success;
 }
 
+//---------------------------------------------------------------------------------------
+void CmdTranspose::undo_action(Document* pDoc, DocCursor* UNUSED(pCursor))
+{
+    //restore saved pitch and key types. Notated accidentals depend on context so
+    //they are computed again
+    ImoScore* pScore = nullptr;
+    list<NotePitchImage>::const_iterator itN;
+    for (itN = m_oldPitch.begin(); itN != m_oldPitch.end(); ++itN)
+    {
+        ImoNote* pNote = static_cast<ImoNote*>( pDoc->get_pointer_to_imo(itN->id) );
+        itN->restore(pNote);
+        if (!pScore)
+            pScore = pNote->get_score();
+    }
+
+    list< pair<ImoId, int> >::const_iterator itK;
+    for (itK = m_oldKeys.begin(); itK != m_oldKeys.end(); ++itK)
+    {
+        ImoKeySignature* pKey =
+            static_cast<ImoKeySignature*>( pDoc->get_pointer_to_imo(itK->first) );
+        pKey->set_key_type(itK->second);
+        pKey->set_dirty(true);
+        if (!pScore)
+            pScore = pKey->get_score();
+    }
+
+    if (pScore)
+    {
+        PitchAssigner tuner;
+        tuner.assign_pitch(pScore);
+    }
+}
+
 //---------------------------------------------------------------------------------------
 void CmdTranspose::transpose_chromatically(ImoNote* pNote, FIntval interval, bool fUp)
 {
@@ -2589,7 +3456,7 @@ CmdTransposeChromatically::CmdTransposeChromatically(FIntval interval,
     , m_fUp(interval.is_ascending())
 {
     m_interval.make_ascending();
-    m_flags = k_recordable | k_reversible;
+    m_flags = k_recordable | k_reversible | k_cursor_not_used;
     if (m_name=="")
         m_name = "Chromatic transposition";
 }
@@ -2616,7 +3483,7 @@ CmdTransposeDiatonically::CmdTransposeDiatonically(int steps, bool fUp,
     , m_steps(steps)
     , m_fUp(fUp)
 {
-    m_flags = k_recordable | k_reversible;
+    m_flags = k_recordable | k_reversible | k_cursor_not_used;
     if (m_name=="")
         m_name = "Diatonic transposition";
 }
@@ -2669,7 +3536,7 @@ CmdTransposeKey::CmdTransposeKey(FIntval interval, const string& name)
     , m_fUp(interval.is_ascending())
 {
     m_interval.make_ascending();
-    m_flags = k_recordable | k_reversible;
+    m_flags = k_recordable | k_reversible | k_cursor_not_used;
     if (m_name=="")
         m_name = "Transpose key signature";
 }
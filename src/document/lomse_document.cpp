@@ -20,6 +20,7 @@
 #include "lomse_mxl_compiler.h"
 #include "lomse_compressed_mxl_compiler.h"
 #include "lomse_mnx_compiler.h"
+#include "lomse_im_snapshot.h"
 #include "lomse_injectors.h"
 #include "lomse_id_assigner.h"
 #include "lomse_ldp_exporter.h"
@@ -34,7 +35,10 @@
 #include "lomse_autoclef.h"
 #include "lomse_relobj_cloner.h"
 
+#include <algorithm>
+#include <atomic>
 #include <sstream>
+#include <fstream>
 using namespace std;
 
 ///@cond INTERNALS
@@ -152,6 +156,72 @@ public:
     }
 };
 
+//---------------------------------------------------------------------------------------
+// CopyXmlIdsVisitor: helper for transferring the xml ids of the objects in a subtree
+// to another IdAssigner
+class CopyXmlIdsVisitor : public Visitor<ImoObj>
+{
+protected:
+    IdAssigner* m_pSrc = nullptr;
+    IdAssigner* m_pDest = nullptr;
+
+public:
+    CopyXmlIdsVisitor(IdAssigner* pSrc, IdAssigner* pDest)
+        : Visitor<ImoObj>(), m_pSrc(pSrc), m_pDest(pDest) {}
+
+    void start_visit(ImoObj* pImo) override
+    {
+        string xmlId = m_pSrc->get_xml_id_for( pImo->get_id() );
+        if (!xmlId.empty())
+            m_pDest->set_xml_id_for(pImo->get_id(), xmlId);
+    }
+};
+
+
+//---------------------------------------------------------------------------------------
+// IdsLock: helper to serialize the access to the IdAssigner while several threads are
+// adding objects to the model (i.e. parallel import of MusicXML parts). It does
+// nothing when concurrent access is not enabled.
+class IdsLock
+{
+#if (LOMSE_ENABLE_THREADS == 1)
+protected:
+    std::mutex* m_pMutex;
+
+public:
+    explicit IdsLock(const DocModel* pModel) : m_pMutex(pModel->m_pIdsMutex)
+    {
+        if (m_pMutex)
+            m_pMutex->lock();
+    }
+    ~IdsLock()
+    {
+        if (m_pMutex)
+            m_pMutex->unlock();
+    }
+#else
+public:
+    explicit IdsLock(const DocModel* UNUSED(pModel)) {}
+#endif
+};
+
+
+//=======================================================================================
+// ScoreCopy implementation
+//=======================================================================================
+ScoreCopy::~ScoreCopy()
+{
+    //the score must be deleted while its ids are still accessible
+    delete m_pScore;
+    delete m_pModel;
+}
+
+//---------------------------------------------------------------------------------------
+ImoId ScoreCopy::get_score_id()
+{
+    return (m_pScore ? m_pScore->get_id() : k_no_imoid);
+}
+
 
 //=======================================================================================
 // DocModel implementation
@@ -161,6 +231,7 @@ DocModel::DocModel(Document* pDoc)
     , m_pIdAssigner( LOMSE_NEW IdAssigner() )
     , m_pImoDoc(nullptr)
     , m_pRelObjCloner(nullptr)
+    , m_pNodePool( LOMSE_NEW NodePool() )
     , m_flags(k_dirty)
     , m_imRef(-1L)
 {
@@ -172,6 +243,12 @@ DocModel::~DocModel()
     delete m_pImoDoc;
     delete m_pIdAssigner;
     delete m_pRelObjCloner;
+#if (LOMSE_ENABLE_THREADS == 1)
+    delete m_pIdsMutex;
+#endif
+
+    //nodes not in the tree, if any, keep the pool alive
+    m_pNodePool->release();
 }
 
 //---------------------------------------------------------------------------------------
@@ -180,8 +257,14 @@ DocModel& DocModel::clone(const DocModel& a)
     //instantiate member variables
     m_pDoc = a.m_pDoc;
     m_pIdAssigner = LOMSE_NEW IdAssigner();
+    if (m_pNodePool)
+        m_pNodePool->release();
+    m_pNodePool = LOMSE_NEW NodePool();
+    NodePoolScope pool(m_pNodePool);
     m_pImoDoc = static_cast<ImoDocument*>( ImFactory::clone(a.m_pImoDoc) );
     m_flags = a.m_flags;
+    m_dirtyIds = a.m_dirtyIds;
+    m_fClearAllMarks = a.m_fClearAllMarks;
 
     //add ptr to this DocModel in ImoObjs and instantiate ids in IdAssigner as the
     //tree is traversed
@@ -211,11 +294,84 @@ DocModel& DocModel::clone(const DocModel& a)
 //---------------------------------------------------------------------------------------
 void DocModel::add_unique_model_ref()
 {
-    static long m_refsCounter = 0L;     //global counter to create unique id numbers
+    static std::atomic<long> m_refsCounter(0L);     //global counter to create unique id numbers
 
     m_imRef = ++m_refsCounter;
 }
 
+//---------------------------------------------------------------------------------------
+ScoreCopy* DocModel::create_score_copy(ImoId scoreId)
+{
+    ImoScore* pScore = dynamic_cast<ImoScore*>( get_pointer_to_imo(scoreId) );
+    if (!pScore)
+        return nullptr;
+
+    ScoreCopy* pCopy = LOMSE_NEW ScoreCopy();
+    pCopy->m_pModel = LOMSE_NEW DocModel(m_pDoc);
+    {
+        NodePoolScope pool(pCopy->m_pModel->m_pNodePool);
+        pCopy->m_pScore = static_cast<ImoScore*>( ImFactory::clone(pScore) );
+    }
+    delete m_pRelObjCloner;
+    m_pRelObjCloner = nullptr;
+
+    //the copied objects have the same ids than the original ones. Anchor them to
+    //the private DocModel of the copy, so that ImoRelObj participants are found
+    //in the copy and deleting the copy does not affect the ids in this model
+    FixModelVisitor v(pCopy->m_pModel, pCopy->m_pModel->m_pIdAssigner);
+    pCopy->m_pScore->accept_visitor(v);
+
+    CopyXmlIdsVisitor vXml(m_pIdAssigner, pCopy->m_pModel->m_pIdAssigner);
+    pCopy->m_pScore->accept_visitor(vXml);
+
+    return pCopy;
+}
+
+//---------------------------------------------------------------------------------------
+void DocModel::restore_score_copy(ScoreCopy* pCopy)
+{
+    //replaces the score having the same id than the copy. Ownership of the copied
+    //score is transferred to the model
+
+    ImoScore* pScore = pCopy->m_pScore;
+    ImoObj* pOld = get_pointer_to_imo( pScore->get_id() );
+    if (!pOld || !pOld->is_score() || !pOld->get_parent_imo())
+        return;
+
+    //remove current score. This also removes its ids from the IdAssigner
+    ImoObj* pParent = pOld->get_parent_imo();
+    pParent->insert(pOld, pScore);
+    pParent->remove_child(pOld);
+    delete pOld;
+    pCopy->m_pScore = nullptr;
+
+    //add the copied objects to the model
+    FixModelVisitor v(this, m_pIdAssigner);
+    pScore->accept_visitor(v);
+
+    m_pIdAssigner->copy_strings_from(pCopy->m_pModel->m_pIdAssigner);
+
+    //build ColStaffObjs and ImMeasureTable
+    ModelBuilder builder;
+    builder.fix_model(pScore);
+
+    //dirty marks in the copy are not tracked
+    m_fClearAllMarks = true;
+    pScore->set_dirty(true);
+}
+
+//---------------------------------------------------------------------------------------
+ImoId DocModel::get_ids_counter() const
+{
+    return m_pIdAssigner->get_counter();
+}
+
+//---------------------------------------------------------------------------------------
+void DocModel::set_ids_counter(ImoId value)
+{
+    m_pIdAssigner->set_counter(value);
+}
+
 //---------------------------------------------------------------------------------------
 RelObjCloner* DocModel::get_relobj_cloner()
 {
@@ -228,30 +384,60 @@ RelObjCloner* DocModel::get_relobj_cloner()
 //---------------------------------------------------------------------------------------
 void DocModel::assign_id(ImoObj* pImo)
 {
+    if (pImo->get_id() == k_no_imoid)
+        pImo->set_id( next_id(k_no_imoid) );
+
+    IdsLock lock(this);
     m_pIdAssigner->assign_id(pImo);
 }
 
 //---------------------------------------------------------------------------------------
 ImoId DocModel::reserve_id(ImoId id)
 {
+    id = next_id(id);
+
+    IdsLock lock(this);
     return m_pIdAssigner->reserve_id(id);
 }
 
+//---------------------------------------------------------------------------------------
+ImoId DocModel::next_id(ImoId id)
+{
+    //When an ids stream is active in this thread, new ids are taken from it.
+    //Otherwise, k_no_imoid is returned and the IdAssigner will assign next id
+
+    if (id != k_no_imoid)
+        return id;
+
+    IdsStreamScope* pStream = IdsStreamScope::current();
+    return (pStream && pStream->get_model() == this ? pStream->next_id() : k_no_imoid);
+}
+
+//---------------------------------------------------------------------------------------
+ImoId DocModel::get_last_assigned_id() const
+{
+    IdsLock lock(this);
+    return m_pIdAssigner->get_counter();
+}
+
 //---------------------------------------------------------------------------------------
 void DocModel::assign_id(Control* pControl)
 {
+    IdsLock lock(this);
     m_pIdAssigner->assign_id(pControl);
 }
 
 //---------------------------------------------------------------------------------------
 string DocModel::get_xml_id_for(ImoId id) const
 {
+    IdsLock lock(this);
     return m_pIdAssigner->get_xml_id_for(id);
 }
 
 //---------------------------------------------------------------------------------------
 void DocModel::set_xml_id_for(ImoId id, const string& value)
 {
+    IdsLock lock(this);
     m_pIdAssigner->set_xml_id_for(id, value);
 }
 
@@ -270,18 +456,21 @@ string DocModel::dump_id_assigner() const
 //---------------------------------------------------------------------------------------
 ImoObj* DocModel::get_pointer_to_imo(const std::string& xmlId) const
 {
+    IdsLock lock(this);
     return m_pIdAssigner->get_pointer_to_imo(xmlId);
 }
 
 //---------------------------------------------------------------------------------------
 ImoObj* DocModel::get_pointer_to_imo(ImoId id) const
 {
+    IdsLock lock(this);
     return m_pIdAssigner->get_pointer_to_imo(id);
 }
 
 //---------------------------------------------------------------------------------------
 Control* DocModel::get_pointer_to_control(ImoId id) const
 {
+    IdsLock lock(this);
     return m_pIdAssigner->get_pointer_to_control(id);
 }
 
@@ -294,9 +483,70 @@ void DocModel::reset_id_assigner()
 //---------------------------------------------------------------------------------------
 void DocModel::on_removed_from_model(ImoObj* pImo)
 {
+    IdsLock lock(this);
     m_pIdAssigner->remove(pImo);
 }
 
+//---------------------------------------------------------------------------------------
+void DocModel::enable_concurrent_ids_access(bool value)
+{
+    //AWARE: to be invoked only when no other thread is using the model
+#if (LOMSE_ENABLE_THREADS == 1)
+    if (value && !m_pIdsMutex)
+        m_pIdsMutex = LOMSE_NEW std::mutex();
+    else if (!value)
+    {
+        delete m_pIdsMutex;
+        m_pIdsMutex = nullptr;
+    }
+#else
+    (void)value;
+#endif
+}
+
+
+//=======================================================================================
+// IdsStreamScope implementation
+//=======================================================================================
+static thread_local IdsStreamScope* s_pCurrentIdsStream = nullptr;
+
+//---------------------------------------------------------------------------------------
+IdsStreamScope::IdsStreamScope(DocModel* pModel, ImoId baseId, int iStream,
+                               int numStreams)
+    : m_pModel(pModel)
+    , m_pPrevScope(s_pCurrentIdsStream)
+    , m_baseId(baseId)
+    , m_iStream(iStream)
+    , m_numStreams(numStreams)
+{
+    s_pCurrentIdsStream = this;
+}
+
+//---------------------------------------------------------------------------------------
+IdsStreamScope::~IdsStreamScope()
+{
+    s_pCurrentIdsStream = m_pPrevScope;
+}
+
+//---------------------------------------------------------------------------------------
+ImoId IdsStreamScope::next_id()
+{
+    if (m_nextId == m_blockEnd)
+    {
+        ++m_iBlock;
+        ImoId block = ImoId(m_iBlock * m_numStreams + m_iStream);
+        m_nextId = m_baseId + 1 + block * k_block_size;
+        m_blockEnd = m_nextId + k_block_size;
+    }
+    return m_nextId++;
+}
+
+//---------------------------------------------------------------------------------------
+IdsStreamScope* IdsStreamScope::current()
+{
+    return s_pCurrentIdsStream;
+}
+
 
 
 //=======================================================================================
@@ -339,6 +589,7 @@ void Document::initialize()
     m_pModel->set_dirty();
     m_pModel->m_pImoDoc = nullptr;
     m_modified = 0;
+    ++m_dirtyMarksRef;
 }
 
 //---------------------------------------------------------------------------------------
@@ -346,12 +597,16 @@ void Document::set_imo_doc(ImoDocument* pImoDoc)
 {
     delete m_pModel->m_pImoDoc;
     m_pModel->m_pImoDoc = pImoDoc;
+    m_pModel->m_fClearAllMarks = true;
 }
 
 //---------------------------------------------------------------------------------------
 int Document::from_file(const string& filename, int format)
 {
     initialize();
+    ImportRecorder recorder(&m_importStats, m_pModel,
+                            m_libraryScope.sample_import_memory());
+    NodePoolScope pool(m_pModel->get_node_pool());
     int numErrors = 0;
     Compiler* pCompiler = get_compiler_for_format(format);
     if (pCompiler)
@@ -379,6 +634,9 @@ int Document::from_file(const string& filename, int format)
 int Document::from_string(const string& source, int format)
 {
     initialize();
+    ImportRecorder recorder(&m_importStats, m_pModel,
+                            m_libraryScope.sample_import_memory());
+    NodePoolScope pool(m_pModel->get_node_pool());
     int numErrors = 0;
     Compiler* pCompiler = get_compiler_for_format(format);
     if (pCompiler)
@@ -402,10 +660,43 @@ int Document::from_string(const string& source, int format)
     return numErrors;
 }
 
+//---------------------------------------------------------------------------------------
+int Document::from_buffer(const void* buffer, size_t size, int format)
+{
+    initialize();
+    ImportRecorder recorder(&m_importStats, m_pModel,
+                            m_libraryScope.sample_import_memory());
+    NodePoolScope pool(m_pModel->get_node_pool());
+    int numErrors = 0;
+    Compiler* pCompiler = get_compiler_for_format(format);
+    if (pCompiler)
+    {
+        m_pModel->m_pImoDoc = pCompiler->compile_buffer(buffer, size);
+        numErrors = pCompiler->get_num_errors();
+        delete pCompiler;
+    }
+    else
+    {
+        m_reporter << "File format not supported." << endl;
+        numErrors = 1;
+    }
+
+    if (m_pModel->m_pImoDoc == nullptr)
+        create_empty();
+
+    if (m_pModel->m_pImoDoc && (format == Document::k_format_mxl || format == Document::k_format_mxl_compressed))
+        fix_malformed_musicxml();
+
+    return numErrors;
+}
+
 //---------------------------------------------------------------------------------------
 int Document::from_input(LdpReader& reader)
 {
     initialize();
+    ImportRecorder recorder(&m_importStats, m_pModel,
+                            m_libraryScope.sample_import_memory());
+    NodePoolScope pool(m_pModel->get_node_pool());
     try
     {
         LdpCompiler* pCompiler  = Injector::inject_LdpCompiler(m_libraryScope, this);
@@ -428,6 +719,7 @@ int Document::from_input(LdpReader& reader)
 void Document::create_empty()
 {
     initialize();
+    NodePoolScope pool(m_pModel->get_node_pool());
     LdpCompiler* pCompiler  = Injector::inject_LdpCompiler(m_libraryScope, this);
     m_pModel->m_pImoDoc = pCompiler->create_empty();
     delete pCompiler;
@@ -437,13 +729,46 @@ void Document::create_empty()
 void Document::create_with_empty_score()
 {
     initialize();
+    NodePoolScope pool(m_pModel->get_node_pool());
     LdpCompiler* pCompiler  = Injector::inject_LdpCompiler(m_libraryScope, this);
     m_pModel->m_pImoDoc = pCompiler->create_with_empty_score();
     delete pCompiler;
 }
 
+//---------------------------------------------------------------------------------------
+bool Document::save_snapshot(std::ostream& out)
+{
+    SnapshotExporter exporter(m_reporter);
+    return exporter.save(m_pModel, out);
+}
+
+//---------------------------------------------------------------------------------------
+bool Document::save_snapshot(const std::string& filename)
+{
+    ofstream out(filename, ios::out | ios::binary);
+    if (!out.good())
+    {
+        m_reporter << "Snapshot file '" << filename << "' can not be created." << endl;
+        return false;
+    }
+    return save_snapshot(out);
+}
+
 //---------------------------------------------------------------------------------------
 void Document::end_of_changes()
+{
+    if (is_in_transaction())
+    {
+        m_fDeferredBuild = true;
+        set_changes_deferred_in_scores(true);
+        return;
+    }
+
+    build_model();
+}
+
+//---------------------------------------------------------------------------------------
+void Document::build_model()
 {
     ModelBuilder builder;
     builder.build_model(m_pModel->m_pImoDoc);
@@ -484,6 +809,97 @@ void Document::replace_model(DocModel* pNewModel)
 {
     delete m_pModel;
     m_pModel = pNewModel;
+    ++m_dirtyMarksRef;
+}
+
+//---------------------------------------------------------------------------------------
+ScoreCopy* Document::create_score_copy(ImoId scoreId)
+{
+    return m_pModel->create_score_copy(scoreId);
+}
+
+//---------------------------------------------------------------------------------------
+void Document::restore_score_copy(ScoreCopy* pCopy)
+{
+    m_pModel->restore_score_copy(pCopy);
+    ++m_dirtyMarksRef;
+}
+
+//---------------------------------------------------------------------------------------
+static void clear_dirty_marks_in(ImoObj* pImo)
+{
+    pImo->set_dirty(false);
+    pImo->set_children_dirty(false);
+
+    //RelObjs are not children of the staffobjs. They are only referenced
+    if (pImo->is_relations())
+    {
+        std::list<ImoRelObj*>& relobjs = static_cast<ImoRelations*>(pImo)->get_relobjs();
+        std::list<ImoRelObj*>::iterator itR;
+        for (itR = relobjs.begin(); itR != relobjs.end(); ++itR)
+        {
+            (*itR)->set_dirty(false);
+            (*itR)->set_children_dirty(false);
+        }
+    }
+
+    ImoObj::children_iterator it;
+    for (it = pImo->begin(); it != pImo->end(); ++it)
+        clear_dirty_marks_in(*it);
+}
+
+//---------------------------------------------------------------------------------------
+static const size_t k_max_dirty_ids = 4096;
+
+//---------------------------------------------------------------------------------------
+void DocModel::on_dirty_marks_set(ImoObj* pImo)
+{
+    //Records the objects that get dirty marks. Above a limit, or for objects without
+    //id, it is cheaper to traverse the tree when clearing the marks.
+
+    if (m_fClearAllMarks || pImo->is_dto())
+        return;
+
+    if (pImo->get_id() == k_no_imoid || m_dirtyIds.size() >= k_max_dirty_ids)
+    {
+        m_fClearAllMarks = true;
+        m_dirtyIds.clear();
+    }
+    else
+        m_dirtyIds.push_back( pImo->get_id() );
+}
+
+//---------------------------------------------------------------------------------------
+void DocModel::clear_dirty_marks()
+{
+    if (m_fClearAllMarks)
+    {
+        if (m_pImoDoc)
+            clear_dirty_marks_in(m_pImoDoc);
+    }
+    else
+    {
+        std::vector<ImoId>::iterator it;
+        for (it = m_dirtyIds.begin(); it != m_dirtyIds.end(); ++it)
+        {
+            //deleted objects are no longer in the IdAssigner
+            ImoObj* pImo = get_pointer_to_imo(*it);
+            if (pImo)
+            {
+                pImo->set_dirty(false);
+                pImo->set_children_dirty(false);
+            }
+        }
+    }
+    m_dirtyIds.clear();
+    m_fClearAllMarks = false;
+}
+
+//---------------------------------------------------------------------------------------
+void Document::clear_dirty_marks()
+{
+    m_pModel->clear_dirty_marks();
+    ++m_dirtyMarksRef;
 }
 
 //---------------------------------------------------------------------------------------
@@ -508,6 +924,9 @@ Compiler* Document::get_compiler_for_format(int format)
         case k_format_mnx:
             return Injector::inject_MnxCompiler(m_libraryScope, this);
 
+        case k_format_snapshot:
+            return Injector::inject_SnapshotCompiler(m_libraryScope, this);
+
         default:
             return nullptr;
     }
@@ -732,6 +1151,12 @@ ImoStyle* Document::get_default_style()
 //---------------------------------------------------------------------------------------
 void Document::notify_if_document_modified()
 {
+    if (is_in_transaction())
+    {
+        m_fDeferredNotify = true;
+        return;
+    }
+
     if (!is_dirty())
         return;
 
@@ -740,6 +1165,95 @@ void Document::notify_if_document_modified()
     notify_observers(pEvent, this);
 }
 
+//---------------------------------------------------------------------------------------
+void Document::begin_transaction()
+{
+    ++m_transactionLevel;
+}
+
+//---------------------------------------------------------------------------------------
+void Document::commit_transaction()
+{
+    if (m_transactionLevel == 0 || --m_transactionLevel > 0)
+        return;
+
+    flush_deferred_changes();
+
+    if (m_fDeferredNotify)
+    {
+        m_fDeferredNotify = false;
+        notify_if_document_modified();
+    }
+}
+
+//---------------------------------------------------------------------------------------
+bool Document::defer_end_of_changes(ImoScore* pScore)
+{
+    //Returns true if the update of the score structures must be deferred. In this
+    //case the score is saved for updating it when the transaction is committed
+
+    if (!is_in_transaction())
+        return false;
+
+    if (!is_end_of_changes_deferred(pScore))
+        m_deferredScores.push_back( pScore->get_id() );
+    return true;
+}
+
+//---------------------------------------------------------------------------------------
+bool Document::is_end_of_changes_deferred(ImoScore* pScore)
+{
+    if (m_fDeferredBuild)
+        return true;
+
+    return find(m_deferredScores.begin(), m_deferredScores.end(), pScore->get_id())
+           != m_deferredScores.end();
+}
+
+//---------------------------------------------------------------------------------------
+void Document::set_changes_deferred_in_scores(bool value)
+{
+    ImoDocument* pImoDoc = get_im_root();
+    int numItems = (pImoDoc ? pImoDoc->get_num_content_items() : 0);
+    for (int i=0; i < numItems; ++i)
+    {
+        ImoContentObj* pItem = pImoDoc->get_content_item(i);
+        if (pItem->is_score())
+            static_cast<ImoScore*>(pItem)->m_fChangesDeferred = value;
+    }
+}
+
+//---------------------------------------------------------------------------------------
+void Document::flush_deferred_changes()
+{
+    if (m_fDeferredBuild)
+    {
+        m_fDeferredBuild = false;
+        m_deferredScores.clear();
+        set_changes_deferred_in_scores(false);
+        build_model();
+        return;
+    }
+
+    //AWARE: scores are saved by id, as the model could have been replaced (e.g. by
+    //undo) since the score was saved
+    vector<ImoId> scores;
+    scores.swap(m_deferredScores);
+
+    vector<ImoId>::iterator it;
+    for (it = scores.begin(); it != scores.end(); ++it)
+    {
+        ImoObj* pImo = get_pointer_to_imo(*it);
+        if (pImo && pImo->is_score())
+        {
+            ImoScore* pScore = static_cast<ImoScore*>(pImo);
+            pScore->m_fChangesDeferred = false;
+            ModelBuilder builder;
+            builder.structurize(pScore);
+        }
+    }
+}
+
 //---------------------------------------------------------------------------------------
 Observable* Document::get_observable_child(int childType, ImoId childId)
 {
@@ -1404,6 +1918,54 @@ void ADocument::end_of_changes()
     pimpl()->end_of_changes();
 }
 
+//---------------------------------------------------------------------------------------
+/** @memberof ADocument
+    Starts a batch of modifications. Until the matching commit_transaction(),
+    invoking end_of_changes() on the document or on its scores does not update the
+    score structures; they are updated only once, when committing. Notice that, while
+    the transaction is open, the modified scores must not be traversed by using
+    methods that depend on these structures, unless flush_deferred_changes() is
+    invoked first.
+    Transactions can be nested; only the outer commit performs the updates.
+*/
+void ADocument::begin_transaction()
+{
+    pimpl()->begin_transaction();
+}
+
+//---------------------------------------------------------------------------------------
+/** @memberof ADocument
+    Finishes a batch of modifications started with begin_transaction(). When this is
+    the outer transaction, all the deferred updates are performed.
+*/
+void ADocument::commit_transaction()
+{
+    pimpl()->commit_transaction();
+}
+
+//---------------------------------------------------------------------------------------
+/** @memberof ADocument
+    Performs now the score updates deferred by the open transaction, without closing
+    it. After this, the modified scores can be traversed again.
+*/
+void ADocument::flush_deferred_changes()
+{
+    pimpl()->flush_deferred_changes();
+}
+
+
+//---------------------------------------------------------------------------------------
+/** @memberof ADocument
+    Returns the timing and counters for the phases of the import operation that
+    created the content of this document. Use it for knowing which stage of the
+    import pipeline (parsing, analysis, building the tables, ...) is responsible
+    when loading a score takes too long. See ImportStats.
+*/
+const ImportStats& ADocument::import_stats() const
+{
+    return pimpl()->get_import_stats();
+}
+
 
 //---------------------------------------------------------------------------------------
 /** @memberof ADocument
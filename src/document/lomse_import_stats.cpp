@@ -0,0 +1,202 @@
+//---------------------------------------------------------------------------------------
+// This file is part of the Lomse library.
+// Copyright (c) 2010-present, Lomse Developers
+//
+// Licensed under the MIT license.
+//
+// See LICENSE and NOTICE.md files in the root directory of this source tree.
+//---------------------------------------------------------------------------------------
+
+#include "lomse_import_stats.h"
+
+#include "private/lomse_document_p.h"
+
+#include <sstream>
+#include <iomanip>
+
+#if defined(__GLIBC__)
+    #include <malloc.h>
+#endif
+
+using namespace std;
+
+namespace lomse
+{
+
+//the import operation being recorded in each thread
+static thread_local ImportStats* s_pCurrentStats = nullptr;
+
+
+//=======================================================================================
+// ImportStats implementation
+//=======================================================================================
+ImportStats::ImportStats()
+{
+    reset();
+}
+
+//---------------------------------------------------------------------------------------
+void ImportStats::reset()
+{
+    for (int i=0; i < k_import_max_phase; ++i)
+    {
+        m_times[i] = 0.0;
+        m_nodes[i] = 0L;
+    }
+    m_totalTime = 0.0;
+    m_processHeapGrowth = -1LL;
+    m_startBytes = -1LL;
+    m_phases.clear();
+}
+
+//---------------------------------------------------------------------------------------
+double ImportStats::get_elapsed_time(int phase) const
+{
+    return (phase >= 0 && phase < k_import_max_phase ? m_times[phase] : 0.0);
+}
+
+//---------------------------------------------------------------------------------------
+long ImportStats::get_nodes_created(int phase) const
+{
+    return (phase >= 0 && phase < k_import_max_phase ? m_nodes[phase] : 0L);
+}
+
+//---------------------------------------------------------------------------------------
+const char* ImportStats::get_phase_name(int phase)
+{
+    switch (phase)
+    {
+        case k_import_read:             return "read";
+        case k_import_parse:            return "parse";
+        case k_import_analyse:          return "analyse";
+        case k_import_restore:          return "restore";
+        case k_import_structurize:      return "structurize";
+        case k_import_staffobjs_table:  return "staffobjs table";
+        case k_import_measures_table:   return "measures table";
+        case k_import_midi:             return "midi";
+        default:
+            return "unknown";
+    }
+}
+
+//---------------------------------------------------------------------------------------
+string ImportStats::dump() const
+{
+    stringstream ss;
+    ss << fixed << setprecision(3);
+    for (int i=0; i < k_import_max_phase; ++i)
+    {
+        ss << get_phase_name(i) << ": " << m_times[i] << " ms, "
+           << m_nodes[i] << " nodes" << endl;
+    }
+    ss << "total: " << m_totalTime << " ms" << endl;
+    if (m_processHeapGrowth >= 0)
+        ss << "process heap growth: " << m_processHeapGrowth << " bytes" << endl;
+    return ss.str();
+}
+
+//---------------------------------------------------------------------------------------
+void ImportStats::start_recording(DocModel* pDocModel, bool fSampleMemory)
+{
+    reset();
+    m_pDocModel = pDocModel;
+    if (fSampleMemory)
+        m_startBytes = bytes_in_use();
+    m_startTime = clock::now();
+}
+
+//---------------------------------------------------------------------------------------
+void ImportStats::end_recording()
+{
+    while (!m_phases.empty())
+        exit_phase();
+
+    chrono::duration<double, milli> elapsed = clock::now() - m_startTime;
+    m_totalTime = elapsed.count();
+    m_pDocModel = nullptr;
+
+    if (m_startBytes >= 0)
+        m_processHeapGrowth = bytes_in_use() - m_startBytes;
+}
+
+//---------------------------------------------------------------------------------------
+void ImportStats::enter_phase(int phase)
+{
+    //the running phase, if any, is suspended
+    if (!m_phases.empty())
+        accumulate_current_phase();
+
+    m_phases.push_back(phase);
+    m_phaseStartTime = clock::now();
+    m_phaseStartNodes = count_nodes();
+}
+
+//---------------------------------------------------------------------------------------
+void ImportStats::exit_phase()
+{
+    if (m_phases.empty())
+        return;
+
+    accumulate_current_phase();
+    m_phases.pop_back();
+
+    //the suspended phase, if any, is resumed
+    m_phaseStartTime = clock::now();
+    m_phaseStartNodes = count_nodes();
+}
+
+//---------------------------------------------------------------------------------------
+void ImportStats::accumulate_current_phase()
+{
+    int phase = m_phases.back();
+
+    chrono::duration<double, milli> elapsed = clock::now() - m_phaseStartTime;
+    m_times[phase] += elapsed.count();
+    m_nodes[phase] += count_nodes() - m_phaseStartNodes;
+}
+
+//---------------------------------------------------------------------------------------
+long ImportStats::count_nodes() const
+{
+    return (m_pDocModel ? long(m_pDocModel->id_assigner_size()) : 0L);
+}
+
+//---------------------------------------------------------------------------------------
+long long ImportStats::bytes_in_use()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 info = mallinfo2();
+    return (long long)(info.uordblks + info.hblkhd);
+#else
+    return -1LL;
+#endif
+}
+
+//---------------------------------------------------------------------------------------
+ImportStats* ImportStats::current()
+{
+    return s_pCurrentStats;
+}
+
+
+//=======================================================================================
+// ImportRecorder implementation
+//=======================================================================================
+ImportRecorder::ImportRecorder(ImportStats* pStats, DocModel* pDocModel,
+                               bool fSampleMemory)
+    : m_pStats(pStats)
+    , m_pPrevStats(s_pCurrentStats)
+{
+    m_pStats->start_recording(pDocModel, fSampleMemory);
+    s_pCurrentStats = m_pStats;
+}
+
+//---------------------------------------------------------------------------------------
+ImportRecorder::~ImportRecorder()
+{
+    m_pStats->end_recording();
+    s_pCurrentStats = m_pPrevStats;
+}
+
+
+}  //namespace lomse
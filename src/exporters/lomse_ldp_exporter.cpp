@@ -3493,6 +3493,8 @@ string LdpExporter::clef_type_to_ldp(int clefType)
         "G2_15",   //15 below
         "15_F4",   //15 above
         "F4_15",   //15 below
+        "TAB",
+        "none",
     };
     static const string undefined = "undefined";
 
@@ -24,11 +24,83 @@ using namespace std;
 namespace lomse
 {
 
+//=======================================================================================
+// minizip low level I/O functions for reading a zip archive in memory. The opaque
+// pointer is the ZipMemorySource and it is also used as stream handle.
+//=======================================================================================
+static voidpf ZCALLBACK mem_open(voidpf opaque, const char* UNUSED(filename),
+                                 int UNUSED(mode))
+{
+    ZipMemorySource* pSource = static_cast<ZipMemorySource*>(opaque);
+    pSource->pos = 0;
+    return opaque;
+}
+
+//---------------------------------------------------------------------------------------
+static uLong ZCALLBACK mem_read(voidpf UNUSED(opaque), voidpf stream, void* buf,
+                                uLong size)
+{
+    ZipMemorySource* pSource = static_cast<ZipMemorySource*>(stream);
+    size_t available = pSource->size - pSource->pos;
+    size_t bytes = min(size_t(size), available);
+    memcpy(buf, pSource->data + pSource->pos, bytes);
+    pSource->pos += bytes;
+    return uLong(bytes);
+}
+
+//---------------------------------------------------------------------------------------
+static uLong ZCALLBACK mem_write(voidpf UNUSED(opaque), voidpf UNUSED(stream),
+                                 const void* UNUSED(buf), uLong UNUSED(size))
+{
+    return 0;   //read only
+}
+
+//---------------------------------------------------------------------------------------
+static long ZCALLBACK mem_tell(voidpf UNUSED(opaque), voidpf stream)
+{
+    return long( static_cast<ZipMemorySource*>(stream)->pos );
+}
+
+//---------------------------------------------------------------------------------------
+static long ZCALLBACK mem_seek(voidpf UNUSED(opaque), voidpf stream, uLong offset,
+                               int origin)
+{
+    ZipMemorySource* pSource = static_cast<ZipMemorySource*>(stream);
+    size_t base;
+    switch (origin)
+    {
+        case ZLIB_FILEFUNC_SEEK_SET:    base = 0;               break;
+        case ZLIB_FILEFUNC_SEEK_CUR:    base = pSource->pos;    break;
+        case ZLIB_FILEFUNC_SEEK_END:    base = pSource->size;   break;
+        default:
+            return -1;
+    }
+    if (base + offset > pSource->size)
+        return -1;
+
+    pSource->pos = base + offset;
+    return 0;
+}
+
+//---------------------------------------------------------------------------------------
+static int ZCALLBACK mem_close(voidpf UNUSED(opaque), voidpf UNUSED(stream))
+{
+    return 0;
+}
+
+//---------------------------------------------------------------------------------------
+static int ZCALLBACK mem_error(voidpf UNUSED(opaque), voidpf UNUSED(stream))
+{
+    return 0;
+}
+
+
 //=======================================================================================
 // ZipInputStream implementation
 //=======================================================================================
 ZipInputStream::ZipInputStream(const std::string& filelocator)
     : InputStream()
+    , m_uzFile(nullptr)
     , m_fIsLastBuffer(true)
     , m_remainingBytes(0)
     , m_pNextChar(nullptr)
@@ -48,6 +120,27 @@ ZipInputStream::ZipInputStream(const std::string& filelocator)
         m_curEntry.fEOF = true;
 }
 
+//---------------------------------------------------------------------------------------
+ZipInputStream::ZipInputStream(const void* buffer, size_t size)
+    : InputStream()
+    , m_uzFile(nullptr)
+    , m_fIsLastBuffer(true)
+    , m_remainingBytes(0)
+    , m_pNextChar(nullptr)
+{
+    if (!open_zip_archive_in_memory(buffer, size))
+    {
+        string msg("[ZipInputStream::ZipInputStream] Invalid zip archive in memory");
+        LOMSE_LOG_ERROR(msg);
+        throw runtime_error(msg);
+    }
+
+    if (get_num_entries() != 0)
+        open_specified_entry_or_first("");
+    else
+        m_curEntry.fEOF = true;
+}
+
 //---------------------------------------------------------------------------------------
 ZipInputStream::~ZipInputStream()
 {
@@ -66,6 +159,30 @@ bool ZipInputStream::open_zip_archive(const std::string& filelocator)
     return (m_uzFile != nullptr);
 }
 
+//---------------------------------------------------------------------------------------
+bool ZipInputStream::open_zip_archive_in_memory(const void* buffer, size_t size)
+{
+    if (buffer == nullptr || size == 0)
+        return false;
+
+    m_memSource.data = static_cast<const unsigned char*>(buffer);
+    m_memSource.size = size;
+    m_memSource.pos = 0;
+
+    zlib_filefunc_def filefuncs;
+    filefuncs.zopen_file = mem_open;
+    filefuncs.zread_file = mem_read;
+    filefuncs.zwrite_file = mem_write;
+    filefuncs.ztell_file = mem_tell;
+    filefuncs.zseek_file = mem_seek;
+    filefuncs.zclose_file = mem_close;
+    filefuncs.zerror_file = mem_error;
+    filefuncs.opaque = &m_memSource;
+
+    m_uzFile = unzOpen2("memory", &filefuncs);
+    return (m_uzFile != nullptr);
+}
+
 //---------------------------------------------------------------------------------------
 void ZipInputStream::close_zip_archive()
 {
@@ -409,6 +526,35 @@ std::vector<unsigned char> ZipInputStream::get_as_vector()
     return buffer;
 }
 
+
+
+//=======================================================================================
+// ZipEntryStreamBuf implementation
+//=======================================================================================
+ZipEntryStreamBuf::ZipEntryStreamBuf(ZipInputStream& zip)
+    : std::streambuf()
+    , m_zip(zip)
+{
+    setg(m_chunk, m_chunk, m_chunk);
+}
+
+//---------------------------------------------------------------------------------------
+ZipEntryStreamBuf::int_type ZipEntryStreamBuf::underflow()
+{
+    if (gptr() < egptr())
+        return traits_type::to_int_type(*gptr());
+
+    if (!m_zip.is_open() || m_zip.eof())
+        return traits_type::eof();
+
+    long bytes = m_zip.read(reinterpret_cast<unsigned char*>(m_chunk), k_chunksize);
+    if (bytes <= 0)
+        return traits_type::eof();
+
+    setg(m_chunk, m_chunk, m_chunk + bytes);
+    return traits_type::to_int_type(*gptr());
+}
+
 }  //namespace lomse
 
 #endif  // LOMSE_ENABLE_COMPRESSION
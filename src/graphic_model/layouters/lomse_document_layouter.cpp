@@ -35,6 +35,7 @@ DocLayouter::DocLayouter(Document* pDoc, LibraryScope& libraryScope, int constra
     , m_pDoc( pDoc->get_im_root() )
     , m_viewWidth(width)
     , m_pScoreLayouter(nullptr)
+    , m_pPrevGModel(nullptr)
 {
     m_pStyles = m_pDoc->get_styles();
     m_pGModel = LOMSE_NEW GraphicModel(m_pDoc);
@@ -45,6 +46,7 @@ DocLayouter::DocLayouter(Document* pDoc, LibraryScope& libraryScope, int constra
 DocLayouter::~DocLayouter()
 {
     delete m_pScoreLayouter;
+    delete_previous_model();
 }
 
 //---------------------------------------------------------------------------------------
@@ -63,6 +65,8 @@ void DocLayouter::layout_document()
     {
         numTrials++;
         start_new_page();
+        if (m_pPrevGModel && !can_reuse_previous_model())
+            delete_previous_model();
         result = layout_content();
         if (result == k_layout_failed_auto_scale)
         {
@@ -76,11 +80,87 @@ void DocLayouter::layout_document()
         fix_document_size();
 }
 
+//---------------------------------------------------------------------------------------
+void DocLayouter::update_document(GraphicModel* pPrevGModel)
+{
+    //Layouts the document after modifying it. pPrevGModel is the graphic model built
+    //before the modifications. Systems not affected by the modifications will be
+    //moved from it to the new graphic model instead of engraving them again.
+    //DocLayouter takes ownership of pPrevGModel and deletes it when no longer needed.
+
+    delete_previous_model();
+    m_pPrevGModel = pPrevGModel;
+    layout_document();
+    delete_previous_model();
+}
+
+//---------------------------------------------------------------------------------------
+bool DocLayouter::can_reuse_previous_model()
+{
+    //The previous model can only be used when it was built for the current state
+    //of the dirty marks, the pages geometry is not changed and the only modified
+    //content is in scores.
+
+    Document* pDoc = m_pDoc->get_the_document();
+    if (m_pPrevGModel->get_dirty_marks_ref() != pDoc->get_dirty_marks_ref()
+        || m_pPrevGModel->get_root()->get_creator_imo() != m_pDoc
+        || (m_constrains & k_infinite_width)
+        || has_changes_other_than_scores())
+    {
+        return false;
+    }
+
+    GmoBoxDocPage* pPrevPage = m_pPrevGModel->get_page(0);
+    GmoBox* pPrevContent = (pPrevPage ? pPrevPage->get_child_box(0) : nullptr);
+    if (!pPrevContent)
+        return false;
+
+    return pPrevPage->get_width() == m_pItemMainBox->get_width()
+           && ((m_constrains & k_infinite_height)
+               || pPrevPage->get_height() == m_pItemMainBox->get_height())
+           && pPrevContent->get_left() == m_pageCursor.x
+           && pPrevContent->get_top() == m_pageCursor.y
+           && pPrevContent->get_width() == m_availableWidth;
+}
+
+//---------------------------------------------------------------------------------------
+bool DocLayouter::has_changes_other_than_scores()
+{
+    if (m_pDoc->is_dirty())
+        return true;
+
+    ImoContent* pContent = m_pDoc->get_content();
+    if (!pContent || pContent->is_dirty())
+        return true;
+
+    ImoObj::children_iterator it;
+    for (it = m_pDoc->begin(); it != m_pDoc->end(); ++it)
+    {
+        if (*it != pContent && ((*it)->is_dirty() || (*it)->are_children_dirty()))
+            return true;
+    }
+
+    for (it = pContent->begin(); it != pContent->end(); ++it)
+    {
+        if (!(*it)->is_score() && ((*it)->is_dirty() || (*it)->are_children_dirty()))
+            return true;
+    }
+    return false;
+}
+
+//---------------------------------------------------------------------------------------
+void DocLayouter::delete_previous_model()
+{
+    delete m_pPrevGModel;
+    m_pPrevGModel = nullptr;
+}
+
 //---------------------------------------------------------------------------------------
 void DocLayouter::delete_last_trial()
 {
     delete m_pScoreLayouter;
     delete m_pGModel;
+    delete_previous_model();
 
     m_result = k_layout_not_finished;
     m_pGModel = LOMSE_NEW GraphicModel(m_pDoc);
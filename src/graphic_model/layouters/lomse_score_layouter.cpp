@@ -58,6 +58,14 @@
 #include "lomse_gm_measures_table.h"
 #include "lomse_vertical_profile.h"
 #include "lomse_fingering_engraver.h"
+#include "lomse_workers_pool.h"
+
+#include <algorithm>
+#if (LOMSE_ENABLE_THREADS == 1)
+    #include <thread>
+    #include <atomic>
+    #include <exception>
+#endif
 
 namespace lomse
 {
@@ -150,6 +158,7 @@ ScoreLayouter::ScoreLayouter(ImoContentObj* pItem, Layouter* pParent,
 //---------------------------------------------------------------------------------------
 ScoreLayouter::~ScoreLayouter()
 {
+    delete_systems_engraved_in_parallel();
     delete_system_layouters();
 }
 
@@ -171,6 +180,11 @@ void ScoreLayouter::prepare_to_start_layout()
     //position for staves.
     decide_systems_indentation();
 
+    //When the score has been modified after building the previous graphic model,
+    //the first systems not affected by the changes are reused. Only the content
+    //after them has to be split in columns and laid out again.
+    find_systems_to_reuse();
+
     //Next the score is split in columns (small chunks, e.g. measures) and
     //the spacing algorithm is applied
     m_pSpAlgorithm->split_content_in_columns();
@@ -200,7 +214,14 @@ void ScoreLayouter::layout_in_box()
         //for deciding break points it is necessary to know page size, and this
         //information is not known in the preparation phase.
 
+        //once line breaks are known, systems after the modified ones can be compared
+        //with those in the previous graphic model
+        find_trailing_systems_to_reuse();
+
         add_score_titles();
+
+        if (m_libraryScope.engrave_systems_in_parallel())
+            engrave_systems_in_parallel();
     }
 
 
@@ -290,9 +311,16 @@ void ScoreLayouter::initialice_score_layouter()
 //---------------------------------------------------------------------------------------
 void ScoreLayouter::create_system()
 {
-    create_system_layouter();
-    create_system_box();
-    engrave_system();
+    if (m_iCurSystem + 1 < get_num_reused_systems())
+        reuse_system();
+    else if (can_reuse_trailing_system(m_iCurSystem + 1))
+        reuse_trailing_system();
+    else
+    {
+        create_system_layouter();
+        create_system_box();
+        engrave_system();
+    }
 }
 
 //---------------------------------------------------------------------------------------
@@ -368,8 +396,18 @@ void ScoreLayouter::delete_system()
 //---------------------------------------------------------------------------------------
 void ScoreLayouter::create_system_layouter()
 {
-    m_pCurSysLyt = LOMSE_NEW SystemLayouter(m_scoreLayoutScope);
-    m_pCurSysLyt->set_constrains(m_constrains);
+    //systems engraved in parallel already have a layouter
+    int iSystem = m_iCurSystem + 1;
+    if (iSystem < int(m_engravedSystems.size()) && m_engravedSystems[iSystem])
+    {
+        m_pCurSysLyt = m_engravedSystems[iSystem];
+        m_engravedSystems[iSystem] = nullptr;
+    }
+    else
+    {
+        m_pCurSysLyt = LOMSE_NEW SystemLayouter(m_scoreLayoutScope);
+        m_pCurSysLyt->set_constrains(m_constrains);
+    }
     m_sysLayouters.push_back(m_pCurSysLyt);
 }
 
@@ -381,13 +419,15 @@ void ScoreLayouter::engrave_system()
     {
         //force to layout an empty system
         m_pCurSysLyt->engrave_system(indent, 0, 0, m_cursor, m_pPrevBoxSystem);
+        m_iCurColumn = 0;
     }
     else
     {
         int iFirstCol = m_breaks[m_iCurSystem];
-        int iLastCol = (m_iCurSystem == get_num_systems() - 1 ?
-                                        get_num_columns() : m_breaks[m_iCurSystem + 1] );
+        int iLastCol = get_end_column_for_system(m_iCurSystem);
         m_pCurSysLyt->engrave_system(indent, iFirstCol, iLastCol, m_cursor, m_pPrevBoxSystem);
+        save_system_content(iFirstCol, iLastCol);
+        m_iCurColumn = iLastCol;
     }
 }
 
@@ -417,8 +457,12 @@ void ScoreLayouter::create_system_box()
     LUnits width = m_pCurBoxPage->get_width();
     width -= (leftMargin + rightMargin);
 
-    //create the box
-    m_pCurBoxSystem = m_pCurSysLyt->create_system_box(left, top, width, height);
+    //create the box. Systems engraved in parallel already have it, at a provisional
+    //position, and it must be moved to its position
+    if (m_pCurSysLyt->get_box_system())
+        m_pCurBoxSystem = m_pCurSysLyt->move_system_box(left, top);
+    else
+        m_pCurBoxSystem = m_pCurSysLyt->create_system_box(left, top, width, height);
 
     //save info for repositioning system if necessary
     m_iSysPage = m_iCurPage;
@@ -451,7 +495,8 @@ void ScoreLayouter::reposition_system_if_page_has_changed()
         USize shift(m_cursor.x - m_sysCursor.x,
                     m_cursor.y - m_sysCursor.y );
         m_pCurBoxSystem->shift_origin_and_content(shift);
-        m_pCurSysLyt->on_origin_shift(shift.height);
+        if (m_pCurSysLyt)   //nullptr for reused systems
+            m_pCurSysLyt->on_origin_shift(shift.height);
     }
     m_pCurBoxSystem->set_page_number(m_iCurPage);
 }
@@ -679,11 +724,13 @@ LUnits ScoreLayouter::determine_system_top_margin()
 //---------------------------------------------------------------------------------------
 int ScoreLayouter::get_system_containing_column(int iCol)
 {
+    //AWARE: columns only exist for the systems after the reused ones
+    int iFirstSystem = get_num_reused_systems();
     if (iCol > 0)
     {
 
         int maxSystem = get_num_systems() - 1;
-        for (int iSys = 0; iSys < maxSystem; ++iSys)
+        for (int iSys = iFirstSystem; iSys < maxSystem; ++iSys)
         {
             if (iCol >= m_breaks[iSys] && iCol < m_breaks[iSys+1])
                 return iSys;
@@ -691,7 +738,7 @@ int ScoreLayouter::get_system_containing_column(int iCol)
         return maxSystem;
     }
     else
-        return 0;
+        return iFirstSystem;
 }
 
 //---------------------------------------------------------------------------------------
@@ -921,6 +968,563 @@ void ScoreLayouter::finish_measure(int iInstr, GmoShapeBarline* pBarlineShape)
     pTable->finish_measure(iInstr, pBarlineShape);
 }
 
+//---------------------------------------------------------------------------------------
+static inline void combine_hash(size_t& seed, size_t value)
+{
+    seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+//---------------------------------------------------------------------------------------
+void ScoreLayouter::find_systems_to_reuse()
+{
+    //Systems can be reused while their staffobjs and attached objects are not
+    //modified. As systems are not engraved again, the reused systems must finish
+    //at a barline and without RelObjs or lyrics continuing in the next system.
+
+    m_reusedSystems.clear();
+    m_numReusedEntries = 0;
+    m_pPrevStub = nullptr;
+
+    m_trailingSystems.clear();
+    m_pPrevGModel = get_previous_graphic_model();
+    if (m_pPrevGModel && score_has_global_changes())
+        m_pPrevGModel = nullptr;
+    if (!m_pPrevGModel)
+        return;
+
+    ImoId scoreId = m_pScore->get_id();
+    ScoreStub* pPrevStub = m_pPrevGModel->get_stub_for(scoreId);
+    if (!pPrevStub)
+        return;
+
+    //find first modified system
+    std::vector<ScoreStub::SystemContent>& systems = pPrevStub->get_systems_content();
+    int numSystems = 0;
+    int iEntry = 0;
+    std::vector<ScoreStub::SystemContent>::iterator it;
+    for (it = systems.begin(); it != systems.end(); ++it, ++numSystems)
+    {
+        if (it->iFirstEntry != iEntry
+            || !is_system_unchanged(it->iFirstEntry, it->numEntries, it->signature))
+        {
+            break;
+        }
+        iEntry += it->numEntries;
+    }
+
+    //the next system must start after a barline, and not at end of score
+    ColStaffObjs* pTable = m_pScore->get_staffobjs_table();
+    while (numSystems > 0)
+    {
+        ScoreStub::SystemContent& data = systems[numSystems - 1];
+        if (data.fEndsInBarline && !data.fPendingRelObjs
+            && data.iFirstEntry + data.numEntries < pTable->num_entries())
+        {
+            break;
+        }
+        --numSystems;
+    }
+
+    for (int i=0; i < numSystems; ++i)
+    {
+        GmoBoxSystem* pBox = m_pPrevGModel->get_system_box(i, scoreId);
+        if (!pBox)
+        {
+            m_reusedSystems.clear();
+            return;
+        }
+        m_reusedSystems.push_back(pBox);
+    }
+
+    if (numSystems > 0)
+    {
+        ScoreStub::SystemContent& data = systems[numSystems - 1];
+        m_numReusedEntries = data.iFirstEntry + data.numEntries;
+        m_pPrevStub = pPrevStub;
+    }
+}
+
+//---------------------------------------------------------------------------------------
+bool ScoreLayouter::score_has_global_changes()
+{
+    //changes in score, instruments or any other content not in musicData affect all
+    //systems
+
+    if (m_pScore->is_dirty())
+        return true;
+
+    ImoInstruments* pInstruments = m_pScore->get_instruments();
+    ImoObj::children_iterator it;
+    for (it = m_pScore->begin(); it != m_pScore->end(); ++it)
+    {
+        if (*it != pInstruments && ((*it)->is_dirty() || (*it)->are_children_dirty()))
+            return true;
+    }
+
+    if (pInstruments->is_dirty())
+        return true;
+
+    for (it = pInstruments->begin(); it != pInstruments->end(); ++it)
+    {
+        if ((*it)->is_dirty())
+            return true;
+
+        ImoObj::children_iterator itI;
+        for (itI = (*it)->begin(); itI != (*it)->end(); ++itI)
+        {
+            if (!(*itI)->is_music_data()
+                && ((*itI)->is_dirty() || (*itI)->are_children_dirty()))
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+//---------------------------------------------------------------------------------------
+bool ScoreLayouter::is_system_unchanged(int iFirstEntry, int numEntries,
+                                        size_t signature)
+{
+    ColStaffObjs* pTable = m_pScore->get_staffobjs_table();
+    if (numEntries == 0 || iFirstEntry + numEntries > pTable->num_entries())
+        return false;
+
+    for (int i=iFirstEntry; i < iFirstEntry + numEntries; ++i)
+    {
+        ImoStaffObj* pSO = pTable->entry_at(i)->imo_object();
+        if (pSO->is_dirty() || pSO->are_children_dirty())
+            return false;
+
+        //RelObjs are not children of the staffobj
+        ImoRelations* pRelObjs = pSO->get_relations();
+        if (pRelObjs)
+        {
+            std::list<ImoRelObj*>& relobjs = pRelObjs->get_relobjs();
+            std::list<ImoRelObj*>::iterator it;
+            for (it = relobjs.begin(); it != relobjs.end(); ++it)
+            {
+                if ((*it)->is_dirty() || (*it)->are_children_dirty())
+                    return false;
+            }
+        }
+    }
+
+    return compute_system_signature(iFirstEntry, numEntries) == signature;
+}
+
+//---------------------------------------------------------------------------------------
+size_t ScoreLayouter::compute_system_signature(int iFirstEntry, int numEntries)
+{
+    //The signature detects changes not reflected in the dirty marks, such as
+    //the insertion or removal of staffobjs, or changes in their position or pitch
+
+    ColStaffObjs* pTable = m_pScore->get_staffobjs_table();
+    size_t signature = size_t(numEntries);
+    for (int i=iFirstEntry; i < iFirstEntry + numEntries; ++i)
+    {
+        ColStaffObjsEntry* pEntry = pTable->entry_at(i);
+        ImoStaffObj* pSO = pEntry->imo_object();
+        combine_hash(signature, size_t(pSO->get_id()));
+        combine_hash(signature, std::hash<double>()(pEntry->time()));
+        combine_hash(signature, size_t(pEntry->num_instrument()));
+        combine_hash(signature, size_t(pEntry->staff()));
+        combine_hash(signature, size_t(pEntry->line()));
+        combine_hash(signature, size_t(pEntry->measure()));
+
+        if (pSO->is_note())
+        {
+            ImoNote* pNote = static_cast<ImoNote*>(pSO);
+            combine_hash(signature, size_t(pNote->get_step()));
+            combine_hash(signature, size_t(pNote->get_octave()));
+            combine_hash(signature, size_t(pNote->get_notated_accidentals()));
+        }
+
+        ImoAttachments* pAuxObjs = pSO->get_attachments();
+        if (pAuxObjs)
+        {
+            ImoObj::children_iterator it;
+            for (it = pAuxObjs->begin(); it != pAuxObjs->end(); ++it)
+                combine_hash(signature, size_t((*it)->get_id()));
+        }
+
+        ImoRelations* pRelObjs = pSO->get_relations();
+        if (pRelObjs)
+        {
+            std::list<ImoRelObj*>& relobjs = pRelObjs->get_relobjs();
+            std::list<ImoRelObj*>::iterator it;
+            for (it = relobjs.begin(); it != relobjs.end(); ++it)
+                combine_hash(signature, size_t((*it)->get_id()));
+        }
+    }
+    return signature;
+}
+
+//---------------------------------------------------------------------------------------
+void ScoreLayouter::cancel_systems_reuse()
+{
+    m_reusedSystems.clear();
+    m_numReusedEntries = 0;
+    m_pPrevStub = nullptr;
+}
+
+//---------------------------------------------------------------------------------------
+GmoShapeBarline* ScoreLayouter::get_reused_barline_shape(ImoStaffObj* pSO)
+{
+    GmoShape* pShape = m_pPrevGModel->get_main_shape_for_imo(pSO->get_id());
+    return dynamic_cast<GmoShapeBarline*>(pShape);
+}
+
+//---------------------------------------------------------------------------------------
+void ScoreLayouter::reuse_system()
+{
+    move_reused_system_box( m_reusedSystems[m_iCurSystem + 1] );
+    m_pStub->add_system_content( m_pPrevStub->get_systems_content()[m_iCurSystem] );
+}
+
+//---------------------------------------------------------------------------------------
+void ScoreLayouter::move_reused_system_box(GmoBoxSystem* pBox)
+{
+    //The system box is moved from the previous graphic model. It is placed at the
+    //position in which it would be created, and no engraving is needed.
+
+    m_iCurSystem++;
+    m_pPrevBoxSystem = (m_fFirstSystemInPage ? nullptr : m_pPrevBoxSystem);
+    m_pCurSysLyt = nullptr;
+
+    m_pCurBoxSystem = pBox;
+    GmoBox* pOldPage = m_pCurBoxSystem->get_parent_box();
+    if (pOldPage)
+        pOldPage->remove_child_box(m_pCurBoxSystem);
+
+    ImoSystemInfo* pInfo = (m_iCurSystem == 0 ? m_pScore->get_first_system_info()
+                                              : m_pScore->get_other_system_info());
+    LUnits top = m_cursor.y
+                 + distance_to_top_of_system(m_iCurSystem, m_fFirstSystemInPage);
+    LUnits left = m_cursor.x + pInfo->get_left_margin();
+    USize shift(left - m_pCurBoxSystem->get_left(), top - m_pCurBoxSystem->get_top());
+    if (shift.width != 0.0f || shift.height != 0.0f)
+        m_pCurBoxSystem->shift_origin_and_content(shift);
+
+    //save info for repositioning system if necessary
+    m_iSysPage = m_iCurPage;
+    m_sysCursor = m_cursor;
+}
+
+//---------------------------------------------------------------------------------------
+void ScoreLayouter::find_trailing_systems_to_reuse()
+{
+    //Systems after the modified ones are reused when the line breaks place them at
+    //the same system as in the previous graphic model, and their content and prolog
+    //are not changed. As the system number is part of the id of some shapes, the
+    //number of systems must not change. The last system is always engraved again.
+    //A candidate system is only reused when the previous system ends as it ended in
+    //the previous graphic model. This is checked when creating the system, after
+    //engraving the previous one. See can_reuse_trailing_system().
+
+    m_trailingSystems.clear();
+    if (!m_pPrevGModel || get_num_columns() == 0)
+        return;
+
+    ImoId scoreId = m_pScore->get_id();
+    ScoreStub* pPrevStub = m_pPrevGModel->get_stub_for(scoreId);
+    int numSystems = get_num_systems();
+    if (!pPrevStub || m_pPrevGModel->get_num_systems(scoreId) != numSystems)
+        return;
+
+    std::vector<ScoreStub::SystemContent>& systems = pPrevStub->get_systems_content();
+    if (int(systems.size()) != numSystems)
+        return;
+
+    m_trailingSystems.assign(numSystems, nullptr);
+    for (int iSys = max(1, get_num_reused_systems()); iSys < numSystems - 1; ++iSys)
+    {
+        ScoreStub::SystemContent& data = systems[iSys];
+        ScoreStub::SystemContent& prevData = systems[iSys - 1];
+        if (!data.fEndsInBarline || data.fPendingRelObjs
+            || !prevData.fEndsInBarline || prevData.fPendingRelObjs)
+        {
+            continue;
+        }
+
+        int iFirstCol = m_breaks[iSys];
+        int iFirstEntry = get_first_entry_for_column(iFirstCol);
+        int iEnd = get_first_entry_for_column( get_end_column_for_system(iSys) );
+        if (iEnd - iFirstEntry != data.numEntries
+            || !is_system_unchanged(iFirstEntry, data.numEntries, data.signature)
+            || compute_prolog_signature(iFirstCol) != data.prologSignature
+            || !has_reused_barlines(iFirstEntry, data.numEntries))
+        {
+            continue;
+        }
+
+        //the box must be as it was after engraving it
+        GmoBoxSystem* pBox = m_pPrevGModel->get_system_box(iSys, scoreId);
+        if (pBox && pBox->get_free_space_at_bottom() == data.uFreeAtBottom)
+            m_trailingSystems[iSys] = pBox;
+    }
+}
+
+//---------------------------------------------------------------------------------------
+bool ScoreLayouter::can_reuse_trailing_system(int iSystem)
+{
+    //The system placement depends on the previous system: nothing must continue in
+    //this system, and the space at its bottom must be the same than when the system
+    //was engraved
+
+    if (iSystem >= int(m_trailingSystems.size()) || !m_trailingSystems[iSystem])
+        return false;
+
+    std::vector<ScoreStub::SystemContent>& systems = m_pStub->get_systems_content();
+    return !systems.empty() && systems.back().fEndsInBarline
+           && m_notFinishedRelObj.empty() && m_notFinishedLyrics.empty()
+           && get_free_space_after_previous_system()
+                == get_previous_system_content(iSystem).uPrevFreeSpace;
+}
+
+//---------------------------------------------------------------------------------------
+void ScoreLayouter::reuse_trailing_system()
+{
+    //The system box is moved from the previous graphic model, as in reuse_system().
+    //But its content was split in columns for deciding line breaks. The shapes
+    //created for these columns are not needed, and the measures table must use the
+    //barlines in the reused system.
+
+    int iSystem = m_iCurSystem + 1;
+    move_reused_system_box( m_trailingSystems[iSystem] );
+
+    int iFirstCol = m_breaks[iSystem];
+    int iLastCol = get_end_column_for_system(iSystem);
+    ScoreStub::SystemContent data = get_previous_system_content(iSystem);
+    data.iFirstEntry = get_first_entry_for_column(iFirstCol);
+    use_reused_barlines(data.iFirstEntry, data.numEntries);
+
+    for (int iCol = iFirstCol; iCol < iLastCol; ++iCol)
+        m_pSpAlgorithm->delete_box_and_shapes(iCol);
+    delete_pending_aux_objects_for_columns(iFirstCol, iLastCol);
+
+    m_pStub->add_system_content(data);
+    m_iCurColumn = iLastCol;
+}
+
+//---------------------------------------------------------------------------------------
+bool ScoreLayouter::has_reused_barlines(int iFirstEntry, int numEntries)
+{
+    ColStaffObjs* pTable = m_pScore->get_staffobjs_table();
+    for (int i=iFirstEntry; i < iFirstEntry + numEntries; ++i)
+    {
+        ImoStaffObj* pSO = pTable->entry_at(i)->imo_object();
+        if (pSO->is_barline() && get_reused_barline_shape(pSO) == nullptr)
+            return false;
+    }
+    return true;
+}
+
+//---------------------------------------------------------------------------------------
+void ScoreLayouter::use_reused_barlines(int iFirstEntry, int numEntries)
+{
+    GmMeasuresTable* pMeasures = m_pStub->get_measures_table();
+    ColStaffObjs* pTable = m_pScore->get_staffobjs_table();
+    for (int i=iFirstEntry; i < iFirstEntry + numEntries; ++i)
+    {
+        ColStaffObjsEntry* pEntry = pTable->entry_at(i);
+        ImoStaffObj* pSO = pEntry->imo_object();
+        if (pSO->is_barline() && !static_cast<ImoBarline*>(pSO)->is_middle())
+        {
+            pMeasures->replace_barline_shape(pEntry->num_instrument(),
+                                             get_reused_barline_shape(pSO));
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------
+void ScoreLayouter::delete_pending_aux_objects_for_columns(int iFirstCol, int iLastCol)
+{
+    std::list<AuxObjContext*>::iterator it;
+    for (it = m_pendingAuxObjs.begin(); it != m_pendingAuxObjs.end(); )
+    {
+        int iCol = (*it)->iCol;
+        if (iCol >= iLastCol)
+            break;
+        if (iCol >= iFirstCol)
+        {
+            delete *it;
+            it = m_pendingAuxObjs.erase(it);
+        }
+        else
+            ++it;
+    }
+}
+
+//---------------------------------------------------------------------------------------
+ScoreStub::SystemContent& ScoreLayouter::get_previous_system_content(int iSystem)
+{
+    ScoreStub* pPrevStub = m_pPrevGModel->get_stub_for( m_pScore->get_id() );
+    return pPrevStub->get_systems_content()[iSystem];
+}
+
+//---------------------------------------------------------------------------------------
+size_t ScoreLayouter::compute_prolog_signature(int iCol)
+{
+    //The prolog of a system depends on previous content. The signature detects
+    //changes in it, such as a modified key signature in a previous system
+
+    size_t signature = 0;
+    int numStaves = m_pScoreMeter->num_staves();
+    for (int idx=0; idx < numStaves; ++idx)
+    {
+        ColStaffObjsEntry* pClef = m_pSpAlgorithm->get_prolog_clef(iCol, idx);
+        ColStaffObjsEntry* pKey = m_pSpAlgorithm->get_prolog_key(iCol, idx);
+        ColStaffObjsEntry* pTime = m_pSpAlgorithm->get_prolog_time(iCol, idx);
+        combine_hash(signature, pClef ? size_t(pClef->imo_object()->get_id()) : 0);
+        combine_hash(signature, pKey ? size_t(pKey->imo_object()->get_id()) : 0);
+        combine_hash(signature, pTime ? size_t(pTime->imo_object()->get_id()) : 0);
+    }
+    return signature;
+}
+
+//---------------------------------------------------------------------------------------
+LUnits ScoreLayouter::get_free_space_after_previous_system()
+{
+    //the space between systems depends on free space at bottom of previous system
+    GmoBoxSystem* pPrevBox = (m_fFirstSystemInPage ? nullptr : m_pPrevBoxSystem);
+    return (pPrevBox ? pPrevBox->get_free_space_at_bottom() : -1.0f);
+}
+
+//---------------------------------------------------------------------------------------
+int ScoreLayouter::get_first_entry_for_column(int iCol)
+{
+    if (iCol < int(m_colStartEntry.size()))
+        return m_colStartEntry[iCol];
+    return m_pScore->get_staffobjs_table()->num_entries();
+}
+
+//---------------------------------------------------------------------------------------
+void ScoreLayouter::save_system_content(int iFirstCol, int iLastCol)
+{
+    ColStaffObjs* pTable = m_pScore->get_staffobjs_table();
+    int iEnd = get_first_entry_for_column(iLastCol);
+    ScoreStub::SystemContent data;
+    data.iFirstEntry = m_colStartEntry[iFirstCol];
+    data.numEntries = iEnd - data.iFirstEntry;
+    data.signature = compute_system_signature(data.iFirstEntry, data.numEntries);
+    data.prologSignature = compute_prolog_signature(iFirstCol);
+    data.uPrevFreeSpace = get_free_space_after_previous_system();
+    data.uFreeAtBottom = m_pCurBoxSystem->get_free_space_at_bottom();
+    data.fEndsInBarline = (data.numEntries > 0
+                           && pTable->entry_at(iEnd - 1)->imo_object()->is_barline());
+    data.fPendingRelObjs = !m_notFinishedRelObj.empty() || !m_notFinishedLyrics.empty();
+    m_pStub->add_system_content(data);
+}
+
+//---------------------------------------------------------------------------------------
+void ScoreLayouter::engrave_systems_in_parallel()
+{
+    //Parallel engraving. Once line breaks are decided, the content of each system
+    //(prolog, slice boxes, staffobjs shapes, vertical profile and justification) only
+    //depends on its columns. Therefore, it is engraved by a pool of threads before
+    //knowing the system position, and all system boxes are created at the same
+    //provisional position. Later, in the layout_in_box() loop, each system is moved to
+    //its position in the page and its engraving is finished serially, in systems order:
+    //AuxObjs, RelObjs and lyrics (that could continue from previous system), measure
+    //numbers, staves collisions and instrument names and brackets.
+    //The first system, that has a different indentation, is engraved as usual. The
+    //systems that could be reused from the previous graphic model are not engraved.
+    //If finally not reused, they are engraved as usual.
+    //The rules that make safe to engrave the systems content concurrently are
+    //described in SystemLayouter::engrave_system_content().
+
+#if (LOMSE_ENABLE_THREADS == 1)
+    int numSystems = get_num_systems();
+    vector<int> systems;
+    for (int iSystem = max(1, get_num_reused_systems()); iSystem < numSystems; ++iSystem)
+    {
+        if (iSystem >= int(m_trailingSystems.size()) || !m_trailingSystems[iSystem])
+            systems.push_back(iSystem);
+    }
+    if (get_num_columns() == 0 || systems.size() < 2)
+        return;
+
+    ImoSystemInfo* pInfo = m_pScore->get_other_system_info();
+    LUnits leftMargin = pInfo->get_left_margin();
+    LUnits rightMargin = pInfo->get_right_margin();
+    LUnits left = m_cursor.x + leftMargin;
+    LUnits top = m_cursor.y;
+    LUnits width = m_pCurBoxPage->get_width() - (leftMargin + rightMargin);
+    LUnits height = pInfo->get_system_distance() / 2.0f;     //top margin
+    height += m_pSpAlgorithm->get_staves_height();          //staves height
+    height += pInfo->get_system_distance() / 2.0f;          //bottom margin
+
+    m_engravedSystems.assign(numSystems, nullptr);
+    for (int iSystem : systems)
+    {
+        SystemLayouter* pSysLyt = LOMSE_NEW SystemLayouter(m_scoreLayoutScope);
+        pSysLyt->set_constrains(m_constrains);
+        pSysLyt->create_system_box(left, top, width, height);
+        m_engravedSystems[iSystem] = pSysLyt;
+    }
+
+    //staves position in the engravers is shared by all systems. As all boxes are at
+    //the same position, it is set before starting the workers
+    m_engravedSystems[systems.front()]->set_position_and_width_for_staves(m_uOtherSystemIndent);
+
+    //lazy initialized shared data must be ready before starting the workers
+    m_pScore->get_default_style();
+    m_libraryScope.get_glyphs_table();
+    m_libraryScope.font_storage();
+
+    size_t numJobs = systems.size();
+    vector<exception_ptr> errors(numJobs);
+    atomic<size_t> nextJob(0);
+    auto work = [&]()
+    {
+        size_t i;
+        while ((i = nextJob++) < numJobs)
+        {
+            int iSystem = systems[i];
+            try
+            {
+                m_engravedSystems[iSystem]->engrave_system_content(iSystem,
+                                            m_uOtherSystemIndent, m_breaks[iSystem],
+                                            get_end_column_for_system(iSystem));
+            }
+            catch (...)
+            {
+                errors[i] = current_exception();
+            }
+        }
+    };
+
+    int maxThreads = m_libraryScope.get_num_engraving_threads();
+    if (maxThreads <= 0)
+        maxThreads = int(max(1u, thread::hardware_concurrency()));
+    size_t numThreads = min(numJobs, size_t(maxThreads));
+    m_libraryScope.get_workers_pool()->run(int(numThreads), work);
+
+    for (exception_ptr& error : errors)
+    {
+        if (error)
+            rethrow_exception(error);
+    }
+#endif
+}
+
+//---------------------------------------------------------------------------------------
+void ScoreLayouter::delete_systems_engraved_in_parallel()
+{
+    //systems not yet placed in a page, when the layout is not finished
+    std::vector<SystemLayouter*>::iterator it;
+    for (it = m_engravedSystems.begin(); it != m_engravedSystems.end(); ++it)
+    {
+        if (*it)
+        {
+            delete (*it)->get_box_system();
+            delete *it;
+        }
+    }
+    m_engravedSystems.clear();
+}
+
 
 
 //=======================================================================================
@@ -1554,11 +2158,11 @@ void LinesBreakerSimple::decide_line_breaks()
     //simple algorithm: just fill system with columns while space available
 
     int numCols = m_pScoreLyt->get_num_columns();
-    int iSystem = 0;
+    int iSystem = m_pScoreLyt->get_num_reused_systems();
 
-    //start first system
-    m_breaks.push_back(0);
-    LUnits space = m_pScoreLyt->get_target_size_for_system(0)
+    //start first system. Reused systems have no columns
+    m_breaks.assign(iSystem + 1, 0);
+    LUnits space = m_pScoreLyt->get_target_size_for_system(iSystem)
                    - m_pScoreLyt->get_column_width(0);        //+gross
 
     for (int iCol=1; iCol < numCols; ++iCol)
@@ -1612,7 +2216,7 @@ void LinesBreakerOptimal::initialize_entries_table()
     m_entries.assign(m_numCols+1, Entry());
     m_entries[0].penalty = 0.0f;
     m_entries[0].predecessor = 0;
-    m_entries[0].system = 0;
+    m_entries[0].system = m_pScoreLyt->get_num_reused_systems();
     for (int i=1; i <= m_numCols; ++i)
     {
         m_entries[i].penalty = LOMSE_INFINITE_PENALTY;
@@ -1721,9 +2325,10 @@ void LinesBreakerOptimal::retrieve_breaks_sequence()
 
     if (i == 0)
     {
-        //no breaks. Just one single system
-        m_breaks.push_back(0);      //AWARE: breaks size is the number of systems because
-                                    //last break is implicit: last column
+        //no breaks. Just one single system after the reused ones, if any.
+        //AWARE: breaks size is the number of systems because last break is implicit:
+        //last column. Reused systems have no columns
+        m_breaks.assign(m_pScoreLyt->get_num_reused_systems() + 1, 0);
 
         if (fTrace)
         {
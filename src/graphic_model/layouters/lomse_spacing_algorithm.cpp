@@ -93,9 +93,8 @@ LUnits SpAlgColumn::get_staves_height()
 }
 
 //---------------------------------------------------------------------------------------
-void SpAlgColumn::add_shapes_to_boxes(int iCol, VerticalProfile* pVProfile)
+void SpAlgColumn::add_shapes_to_boxes(int iCol)
 {
-    m_pVProfile = pVProfile;
     m_pColsBuilder->add_shapes_to_boxes(iCol);
 }
 
@@ -280,17 +279,106 @@ void ColumnsBuilder::create_columns()
     m_fOther.assign(m_pScore->get_num_instruments(), false);
 
     determine_staves_vertical_position();
+    if (m_pScoreLyt->get_num_reused_entries() > 0)
+        skip_content_in_reused_systems();
+
     while(!m_pSysCursor->is_end())
     {
         m_iColumn++;
         prepare_for_new_column();
         m_colsData.push_back( LOMSE_NEW ColumnData(m_pScoreMeter, m_pSpAlgorithm) );
+        m_pScoreLyt->m_colStartEntry.push_back( m_pSysCursor->cur_entry()->index() );
         find_and_save_context_info_for_this_column();
         collect_content_for_this_column();
     }
     m_maxColumn = m_iColumn;
 }
 
+//---------------------------------------------------------------------------------------
+void ColumnsBuilder::skip_content_in_reused_systems()
+{
+    //The staffobjs in the systems reused from the previous graphic model are not
+    //processed again, but the cursor context, the columns breaker state, the prolog
+    //flags and the measures table must be as if they were processed. If the content
+    //after the reused systems does not start a new column, systems can not be reused.
+
+    int numEntries = m_pScoreLyt->get_num_reused_entries();
+    std::vector< pair<int, GmoShapeBarline*> > barlines;
+    GmoShapeBarline* pBarlineShape = nullptr;
+    ColStaffObjsEntry* pBarlineEntry = nullptr;
+    ImoStaffObj* pSO = nullptr;
+    bool fValid = true;
+    int iEntry = 0;
+
+    while(!m_pSysCursor->is_end())
+    {
+        ImoStaffObj* pPrevSO = pSO;
+        pSO = m_pSysCursor->get_staffobj();
+        int iInstr = m_pSysCursor->num_instrument();
+        TimeUnits rTime = m_pSysCursor->time();
+
+        if (m_pBreaker->feasible_break_before_this_obj(pSO, pPrevSO, rTime, iInstr,
+                                                       m_pSysCursor->line()))
+        {
+            if (iEntry == numEntries)
+                break;
+
+            //a new column starts at this staffobj. It will be checked again
+            pSO = nullptr;
+            continue;
+        }
+
+        if (iEntry == numEntries)
+        {
+            fValid = false;
+            break;
+        }
+
+        if (pSO->is_clef() || pSO->is_key_signature() || pSO->is_time_signature())
+            determine_if_is_in_prolog(pSO, rTime, iInstr, m_pSysCursor->staff_index());
+        else if (!pSO->is_system_break())
+            m_fOther[iInstr] = true;
+
+        if (pSO->is_barline())
+        {
+            pBarlineShape = m_pScoreLyt->get_reused_barline_shape(pSO);
+            pBarlineEntry = m_pSysCursor->cur_entry();
+            fValid &= (pBarlineShape != nullptr);
+            if (!static_cast<ImoBarline*>(pSO)->is_middle())
+                barlines.push_back( make_pair(iInstr, pBarlineShape) );
+        }
+
+        m_pSysCursor->move_next();
+        ++iEntry;
+    }
+
+    if (fValid && iEntry == numEntries && !m_pSysCursor->is_end())
+    {
+        std::vector< pair<int, GmoShapeBarline*> >::iterator it;
+        for (it = barlines.begin(); it != barlines.end(); ++it)
+            m_pScoreLyt->finish_measure(it->first, it->second);
+
+        //the last reused staffobj is a barline. It starts next measure
+        m_pStartBarlineShape = pBarlineShape;
+        m_pSpAlgorithm->start_after_reused_barline(pBarlineEntry);
+    }
+    else
+    {
+        //start again from the beginning of the score
+        m_pScoreLyt->cancel_systems_reuse();
+
+        delete m_pBreaker;
+        delete m_pSysCursor;
+        m_pSysCursor = LOMSE_NEW StaffObjsCursor(m_pScore);
+        m_pBreaker = LOMSE_NEW ColumnBreaker(m_pScoreMeter->num_instruments(),
+                                             m_pSysCursor);
+
+        m_fClefFound.assign(m_pSysCursor->get_num_staves(), false);
+        m_fSignatures.assign(m_pScore->get_num_instruments(), false);
+        m_fOther.assign(m_pScore->get_num_instruments(), false);
+    }
+}
+
 //---------------------------------------------------------------------------------------
 void ColumnsBuilder::do_spacing_algorithm()
 {
@@ -309,7 +397,7 @@ void ColumnsBuilder::collect_content_for_this_column()
     GmoShapeBarline* pPrevBarlineShape = nullptr;
     GmoShape* pShape = nullptr;
 
-    bool fSaveNonTimed = (m_iColumn == 0);
+    bool fSaveNonTimed = m_pScoreLyt->is_first_column_in_score(m_iColumn);
     vector<GmoShape*> nonTimed;     //last non-timed shape at start or after a barline
     nonTimed.assign(m_pScoreMeter->num_instruments(), nullptr);
 
@@ -46,10 +46,11 @@ SpAlgGourlay::SpAlgGourlay(LibraryScope& libraryScope, ScoreMeter* pScoreMeter,
                            PartsEngraver* pPartsEngraver)
     : SpAlgColumn(libraryScope, pScoreMeter, pScoreLyt, pScore, engravers,
                   pShapesCreator, pPartsEngraver)
+    , m_pReusedSlice(nullptr)
     , m_pCurSlice(nullptr)
     , m_pLastEntry(nullptr)
     , m_prevType(TimeSlice::k_undefined)
-    , m_prevTime(0.0)
+    , m_prevTime(0)
     , m_prevAlignTime(0.0)
     , m_numEntries(0)
     , m_pCurColumn(nullptr)
@@ -103,6 +104,8 @@ SpAlgGourlay::~SpAlgGourlay()
     for (itS = m_slices.begin(); itS != m_slices.end(); ++itS)
         delete *itS;
     m_slices.clear();
+
+    delete m_pReusedSlice;
 }
 
 //---------------------------------------------------------------------------------------
@@ -142,8 +145,7 @@ void SpAlgGourlay::include_object(ColStaffObjsEntry* pCurEntry, int iCol, int iI
 {
     save_info_for_shape(pShape, iInstr, iStaff);
     int curType = determine_required_slice_type(pSO, fInProlog);
-    TimeUnits curTime = pCurEntry->time();
-    bool fCreateNewSlice = determine_if_new_slice_needed(pCurEntry, curTime, curType, pSO);
+    bool fCreateNewSlice = determine_if_new_slice_needed(pCurEntry, curType, pSO);
 
     //include entry in current or new slice
     if (fCreateNewSlice)
@@ -177,7 +179,7 @@ void SpAlgGourlay::include_object(ColStaffObjsEntry* pCurEntry, int iCol, int iI
         ++m_numSlices;
 
         m_prevType = curType;
-        m_prevTime = curTime;
+        m_prevTime = pCurEntry->ticks();
 
         if (pSO->is_grace_note())
         {
@@ -317,15 +319,14 @@ int SpAlgGourlay::determine_required_slice_type(ImoStaffObj* pSO, bool fInProlog
 
 //---------------------------------------------------------------------------------------
 bool SpAlgGourlay::determine_if_new_slice_needed(ColStaffObjsEntry* pCurEntry,
-                                                 TimeUnits curTime, int curType,
-                                                 ImoStaffObj* pSO)
+                                                 int curType, ImoStaffObj* pSO)
 {
     if (!m_pCurSlice)
         return true;
 
     bool fCreateNewSlice = false;
 
-    if (curType != m_prevType || !is_equal_time(m_prevTime, curTime) )
+    if (curType != m_prevType || m_prevTime != pCurEntry->ticks())
         fCreateNewSlice = true;
     else if (pSO->is_grace_note())
     {
@@ -467,6 +468,27 @@ void SpAlgGourlay::finish_column_measurements(int UNUSED(iCol))
         m_pCurColumn->set_num_entries(m_numSlices);
 }
 
+//---------------------------------------------------------------------------------------
+void SpAlgGourlay::start_after_reused_barline(ColStaffObjsEntry* pLastEntry)
+{
+    //Spacing for a slice depends on previous slice. Therefore, an empty barline slice
+    //is created to precede the first slice, but it is not part of any column
+
+    delete m_pReusedSlice;
+    m_pReusedSlice = LOMSE_NEW TimeSliceBarline(pLastEntry, -1, -1);
+    m_pReusedSlice->set_final_data(pLastEntry, 1, 0.0, LOMSE_NO_DURATION,
+                                   m_pScoreMeter);
+    m_pReusedSlice->compute_ds_and_di();
+
+    m_pCurSlice = m_pReusedSlice;
+    m_pLastEntry = pLastEntry;
+    m_numEntries = 1;
+    m_prevType = TimeSlice::k_barline;
+    m_prevTime = pLastEntry->ticks();
+    m_maxNoteDur = 0.0;
+    m_minNoteDur = LOMSE_NO_DURATION;
+}
+
 //---------------------------------------------------------------------------------------
 void SpAlgGourlay::do_spacing(int iColumnToTrace)
 {
@@ -606,6 +628,7 @@ void SpAlgGourlay::compute_springs()
 //---------------------------------------------------------------------------------------
 void SpAlgGourlay::reposition_slices_and_staffobjs(int iFirstCol, int iLastCol,
                                                    LUnits yShift,
+                                                   VerticalProfile* pVProfile,
                                                    LUnits* yMin, LUnits* yMax)
 {
     // A system is ready. It is formed by columns iFirstCol and iLastCol, both included.
@@ -626,7 +649,8 @@ void SpAlgGourlay::reposition_slices_and_staffobjs(int iFirstCol, int iLastCol,
     //   determined by the spacing algorithm and its y position is valid but
     //   must be shifted by the amount indicated by parameter yShift.
     //
-    // - collect information about system vertical limits.
+    // - collect information about system vertical limits and update the system
+    //   vertical profile.
 
 
     GmoBoxSlice* pFirstSlice = get_slice_box(iFirstCol);
@@ -641,7 +665,7 @@ void SpAlgGourlay::reposition_slices_and_staffobjs(int iFirstCol, int iLastCol,
         //reposition staffobjs
         m_columns[iCol]->move_shapes_to_final_positions(m_shapes, xLeft, yTop + yShift,
                                                         yMin, yMax, m_pScoreMeter,
-                                                        m_pVProfile);
+                                                        pVProfile);
 
         //assign the final width to the boxes
         LUnits colWidth = m_columns[iCol]->get_column_width();
@@ -1722,7 +1746,7 @@ void TimeSliceGraces::assign_spacing_values(vector<ShapeData*>& shapes,
     //if this is the first slice (scores without prolog) add some space at start
     //TODO: LDP score for test. [NR2a] 00609. CHECK: there is some space at start of score before the note.
     //      Spacing must be similar to that of first note in second measure
-    if (m_iFirstShape == 0)
+    if (!m_prev)
         m_dxLeft = max(m_dxLeft, pMeter->tenths_to_logical_max(LOMSE_SPACE_BEFORE_PROLOG));
 
     //if prev slice is a barline slice, add some extra space at start
@@ -2094,7 +2118,7 @@ void TimeSliceNoterest::assign_spacing_values(vector<ShapeData*>& shapes,
     //if this is the first slice (scores without prolog) add some space at start
     //[NR2a] test 00609. CHECK: there is some space at start of score before the note.
     //      Spacing must be similar to that of first note in second measure
-    if (m_iFirstShape == 0)
+    if (!m_prev)
         m_dxLeft += pMeter->tenths_to_logical_max(LOMSE_SPACE_BEFORE_PROLOG);
 
     //if prev slice is a barline slice, add some extra space at start
@@ -152,22 +152,40 @@ GmoBoxSystem* SystemLayouter::create_system_box(LUnits left, LUnits top, LUnits
     return m_pBoxSystem;
 }
 
+//---------------------------------------------------------------------------------------
+GmoBoxSystem* SystemLayouter::move_system_box(LUnits left, LUnits top)
+{
+    USize shift(left - m_pBoxSystem->get_left(), top - m_pBoxSystem->get_top());
+    if (shift.width != 0.0f || shift.height != 0.0f)
+    {
+        m_pBoxSystem->shift_origin_and_content(shift);
+        if (m_pVProfile)
+            m_pVProfile->shift(shift);
+        on_origin_shift(shift.height);
+    }
+    return m_pBoxSystem;
+}
+
 //---------------------------------------------------------------------------------------
 void SystemLayouter::engrave_system(LUnits indent, int iFirstCol, int iLastCol,
                                     UPoint pos, GmoBoxSystem* pPrevBoxSystem)
 {
-    m_iSystem = m_pScoreLyt->m_iCurSystem;
-    m_iFirstCol = iFirstCol;
-    m_iLastCol = iLastCol;
-    m_pagePos = pos;
+    if (m_fContentEngraved)
+    {
+        //content engraved by engrave_system_content() and system box already moved
+        //to its final position. Staves in the engravers must be placed there.
+        set_position_and_width_for_staves(indent);
+    }
+    else
+    {
+        m_iSystem = m_pScoreLyt->m_iCurSystem;
+        m_pagePos = pos;
+        m_pBoxSystem->add_shift_to_start_measure(indent);
+        set_position_and_width_for_staves(indent);
+        engrave_columns(iFirstCol, iLastCol);
+    }
 
-    set_position_and_width_for_staves(indent);
-    create_vertical_profile();
-    fill_current_system_with_columns();
-    collect_last_column_information();
-    justify_current_system();
     truncate_current_system(indent);
-    build_system_timegrid();
     reposition_full_measure_rests();
     engrave_system_details(m_iSystem);
 
@@ -185,6 +203,53 @@ void SystemLayouter::engrave_system(LUnits indent, int iFirstCol, int iLastCol,
     add_initial_line_joining_all_staves_in_system();
 }
 
+//---------------------------------------------------------------------------------------
+void SystemLayouter::engrave_system_content(int iSystem, LUnits indent, int iFirstCol,
+                                            int iLastCol)
+{
+    //Engraves the part of the system that only depends on its columns: prolog, slice
+    //boxes and staffobjs shapes, vertical profile and justification. The system box is
+    //at a provisional position, and the staves position in the engravers must be
+    //already set for a box at that position. Later, engrave_system() must be invoked
+    //to finish the system, once the box is moved to its final position.
+    //
+    //This method can be invoked from worker threads for engraving several systems at
+    //the same time. The objects shared by the systems are also modified here, but
+    //each system only writes the data for its own columns:
+    //  - In the spacing algorithm, only the ColumnData of columns iFirstCol to
+    //    iLastCol-1 (slice boxes, forces applied when justifying and final positions)
+    //    and the ShapeData and shapes of the entries in those columns. Columns and
+    //    ShapeData vectors are not resized while engraving columns, and the spacing
+    //    parameters are only read.
+    //  - ShapesCreator is only used for prolog clefs, keys and time signatures, which
+    //    are engraved by local engravers. Its engravers map, used for notes and rests,
+    //    is not accessed.
+    //  - PartsEngraver is only read. Staves positions are set before starting the
+    //    workers, and set_staves_width() is only invoked from engrave_system(), in the
+    //    calling thread.
+    //  - Lazily created shared objects (the score default style, the glyphs table and
+    //    the fonts storage) must be created before starting the workers.
+    //Any change to this method or to the methods it invokes must preserve these rules.
+
+    m_iSystem = iSystem;
+    m_pBoxSystem->add_shift_to_start_measure(indent);
+    engrave_columns(iFirstCol, iLastCol);
+    m_fContentEngraved = true;
+}
+
+//---------------------------------------------------------------------------------------
+void SystemLayouter::engrave_columns(int iFirstCol, int iLastCol)
+{
+    m_iFirstCol = iFirstCol;
+    m_iLastCol = iLastCol;
+
+    create_vertical_profile();
+    fill_current_system_with_columns();
+    collect_last_column_information();
+    justify_current_system();
+    build_system_timegrid();
+}
+
 //---------------------------------------------------------------------------------------
 void SystemLayouter::set_position_and_width_for_staves(LUnits indent)
 {
@@ -197,8 +262,6 @@ void SystemLayouter::set_position_and_width_for_staves(LUnits indent)
     org.y += m_pScoreLyt->determine_top_space(0);
     org.x = 0.0f;
 
-    m_pBoxSystem->add_shift_to_start_measure(indent);
-
     m_pPartsEngraver->set_position_and_width_for_staves(indent, org, m_pBoxSystem);
 }
 
@@ -237,7 +300,6 @@ void SystemLayouter::create_vertical_profile()
 //---------------------------------------------------------------------------------------
 void SystemLayouter::fill_current_system_with_columns()
 {
-    m_pScoreLyt->m_iCurColumn = 0;
     if (m_pScoreLyt->get_num_systems() == 0)
         return;
 
@@ -250,12 +312,10 @@ void SystemLayouter::fill_current_system_with_columns()
     m_fFirstColumnInSystem = true;
     for (int iCol = m_iFirstCol; iCol < m_iLastCol; ++iCol)
     {
-        m_pScoreLyt->m_iCurColumn = iCol;
-        add_system_prolog_if_necessary();
+        add_system_prolog_if_necessary(iCol);
         add_column_to_system(iCol);
         m_fFirstColumnInSystem = false;
     }
-    m_pScoreLyt->m_iCurColumn = m_iLastCol;
 }
 
 //---------------------------------------------------------------------------------------
@@ -334,7 +394,7 @@ bool SystemLayouter::system_must_be_truncated()
         return false;
 
     //only last system can be truncated
-    if (!m_pScoreLyt->is_last_system())
+    if (!is_last_system())
         return false;
 
     //last system must be truncated only in the following cases:
@@ -363,7 +423,7 @@ void SystemLayouter::add_column_to_system(int iCol)
 
     create_boxes_for_column(iCol, m_pagePos.x, size);
 
-    if (iCol != 0 && is_first_column_in_system())
+    if (!m_pScoreLyt->is_first_column_in_score(iCol) && is_first_column_in_system())
         add_prolog_shapes_to_boxes();
 
     add_shapes_for_column(iCol);
@@ -392,9 +452,9 @@ void SystemLayouter::add_prolog_shapes_to_boxes()
 }
 
 //---------------------------------------------------------------------------------------
-void SystemLayouter::add_system_prolog_if_necessary()
+void SystemLayouter::add_system_prolog_if_necessary(int iCol)
 {
-    if (m_pScoreLyt->m_iCurColumn > 0 && is_first_column_in_system())
+    if (!m_pScoreLyt->is_first_column_in_score(iCol) && is_first_column_in_system())
 	{
 	    LUnits uPrologWidth = 0.0f;
 
@@ -537,7 +597,7 @@ LUnits SystemLayouter::engrave_prolog(int iInstr)
 //---------------------------------------------------------------------------------------
 void SystemLayouter::add_shapes_for_column(int iCol)
 {
-    m_pSpAlgorithm->add_shapes_to_boxes(iCol, m_pVProfile.get());
+    m_pSpAlgorithm->add_shapes_to_boxes(iCol);
 }
 
 //---------------------------------------------------------------------------------------
@@ -567,7 +627,7 @@ bool SystemLayouter::system_must_be_justified()
         return false;
 
     //if not last system or free space is negative, force justification
-    if (m_uFreeSpace < 0.0f || !m_pScoreLyt->is_last_system())
+    if (m_uFreeSpace < 0.0f || !is_last_system())
         return true;
 
     //Otherwise, the decision for final system depends on the justification option:
@@ -593,7 +653,7 @@ void SystemLayouter::reposition_slices_and_staffobjs()
 {
     LUnits yShift = m_pScoreLyt->determine_top_space(0);
     m_pSpAlgorithm->reposition_slices_and_staffobjs(m_iFirstCol, m_iLastCol, yShift,
-                                                    &m_yMin, &m_yMax);
+                                                    m_pVProfile.get(), &m_yMin, &m_yMax);
 }
 
 //---------------------------------------------------------------------------------------
@@ -1321,6 +1381,14 @@ void SystemLayouter::add_instruments_info()
     }
 }
 
+//---------------------------------------------------------------------------------------
+bool SystemLayouter::is_last_system()
+{
+    //AWARE: systems can be engraved in parallel. Do not use ScoreLayouter current
+    //system, as it could refer to another system
+    return m_iSystem == m_pScoreLyt->get_num_systems() - 1;
+}
+
 //---------------------------------------------------------------------------------------
 void SystemLayouter::dbg_add_vertical_profile_shape()
 {
@@ -163,6 +163,46 @@ void VerticalProfile::update_shape(GmoShape* pShape, int idxStaff)
     update_profile(pPointsMax, yBottom, true, xLeft, xRight, pShape);  //true -> maximum profile
 }
 
+//---------------------------------------------------------------------------------------
+void VerticalProfile::shift(USize shift)
+{
+    m_xStart += shift.width;
+    m_xEnd += shift.width;
+
+    for (int idxStaff=0; idxStaff < m_numStaves; ++idxStaff)
+    {
+        //limit values for not occupied space are not changed
+        if (m_yMin[idxStaff] != LOMSE_PAPER_UPPER_LIMIT
+            && m_yMin[idxStaff] != LOMSE_PAPER_LOWER_LIMIT)
+        {
+            m_yMin[idxStaff] += shift.height;
+        }
+        if (m_yMax[idxStaff] != LOMSE_PAPER_LOWER_LIMIT)
+            m_yMax[idxStaff] += shift.height;
+
+        m_yStaffTop[idxStaff] += shift.height;
+        m_yStaffBottom[idxStaff] += shift.height;
+
+        shift_points(m_xMax[idxStaff], shift);
+        shift_points(m_xMin[idxStaff], shift);
+    }
+}
+
+//---------------------------------------------------------------------------------------
+void VerticalProfile::shift_points(PointsRow* pPoints, USize shift)
+{
+    if (!pPoints)
+        return;
+
+    PointsIterator it;
+    for (it = pPoints->begin(); it != pPoints->end(); ++it)
+    {
+        (*it).x += shift.width;
+        if ((*it).y != LOMSE_PAPER_UPPER_LIMIT && (*it).y != LOMSE_PAPER_LOWER_LIMIT)
+            (*it).y += shift.height;
+    }
+}
+
 //---------------------------------------------------------------------------------------
 void VerticalProfile::update_profile(list<VProfilePoint>* pPoints, LUnits yPos, bool fMax,
                                      LUnits xLeft, LUnits xRight, GmoShape* pShape)
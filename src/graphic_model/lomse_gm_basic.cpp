@@ -20,6 +20,7 @@
 #include "lomse_logger.h"
 #include "lomse_gm_measures_table.h"
 
+#include <algorithm>    //find
 #include <cstdlib>      //abs
 #include <iomanip>
 using namespace std;
@@ -35,7 +36,6 @@ namespace lomse
 
 //association object-type <-> object-name
 static std::map<int, std::string> m_typeToName;
-static bool m_fNamesLoaded = false;
 static string m_unknown = "unknown";
 
 //---------------------------------------------------------------------------------------
@@ -123,7 +123,8 @@ void GmoObj::dump(ostream& outStream, int level)
 //---------------------------------------------------------------------------------------
 const string& GmoObj::get_name(int objtype)
 {
-    if (!m_fNamesLoaded)
+    //AWARE: initialization of a local static is thread safe
+    static const bool fNamesLoaded = []()
     {
         m_typeToName[k_box]                     = "box (A)";
         m_typeToName[k_box_control]             = "box-control";
@@ -195,8 +196,9 @@ const string& GmoObj::get_name(int objtype)
         m_typeToName[k_shape_word]              = "word";
         m_typeToName[k_shape_wedge]             = "wedge";
 
-        m_fNamesLoaded = true;
-    }
+        return true;
+    }();
+    (void)fNamesLoaded;
 
 	map<int, std::string>::const_iterator it = m_typeToName.find( objtype );
 	if (it != m_typeToName.end())
@@ -349,6 +351,20 @@ void GmoBox::add_child_box(GmoBox* child)
     child->set_owner_box(this);
 }
 
+//---------------------------------------------------------------------------------------
+void GmoBox::remove_child_box(GmoBox* child)
+{
+    //AWARE: removes child but does not delete it
+
+    std::vector<GmoBox*>::iterator it = find(m_childBoxes.begin(), m_childBoxes.end(),
+                                             child);
+    if (it != m_childBoxes.end())
+    {
+        m_childBoxes.erase(it);
+        child->set_owner_box(nullptr);
+    }
+}
+
 //---------------------------------------------------------------------------------------
 GmoBox* GmoBox::get_child_box(int i)  //i = 0..n-1
 {
@@ -89,6 +89,25 @@ void GmMeasuresTable::finish_measure(int iInstr, GmoShapeBarline* pBarlineShape)
     m_numBarlines[iInstr]++;
 }
 
+//---------------------------------------------------------------------------------------
+void GmMeasuresTable::replace_barline_shape(int iInstr, GmoShapeBarline* pBarlineShape)
+{
+    //invoked when a system is reused from a previous graphic model. The barline shape
+    //in it replaces the shape created for the same barline
+
+    BarlinesVector* pBarlines = m_instrument[iInstr];
+    ImoObj* pCreator = pBarlineShape->get_creator_imo();
+    for (int i = m_numBarlines[iInstr] - 1; i >= 0; --i)
+    {
+        GmoShapeBarline* pShape = pBarlines->at(i);
+        if (pShape && pShape->get_creator_imo() == pCreator)
+        {
+            pBarlines->at(i) = pBarlineShape;
+            return;
+        }
+    }
+}
+
 //---------------------------------------------------------------------------------------
 LUnits GmMeasuresTable::get_end_barline_left(int iInstr, int iMeasure,
                                              GmoBoxSystem* pBox)
@@ -27,6 +27,7 @@
 #include "lomse_score_algorithms.h"
 #include "lomse_logger.h"
 
+#include <atomic>
 #include <cstdlib>      //abs
 #include <iomanip>
 
@@ -38,11 +39,12 @@ namespace lomse
 //=======================================================================================
 // Graphic model implementation
 //=======================================================================================
-static long m_idCounter = 0L;
+static std::atomic<long> m_idCounter(0L);
 
 //---------------------------------------------------------------------------------------
 GraphicModel::GraphicModel(ImoDocument* pCreator)
     : m_modified(true)
+    , m_dirtyMarksRef(-1L)
 {
     m_root = LOMSE_NEW GmoBoxDocument(this, pCreator);
     m_modelId = ++m_idCounter;
@@ -154,7 +156,7 @@ void GraphicModel::store_in_map_imo_shape(ImoObj* pImo, GmoShape* pShape)
     if (idx > 0)
         m_imoToSecondaryShape[ make_pair(id, idx) ] = pShape;
     else
-        m_imoToMainShape[id] = pShape;
+        m_imoToMainShape.set(id, pShape);
 }
 
 //---------------------------------------------------------------------------------------
@@ -165,12 +167,12 @@ void GraphicModel::add_to_map_imo_to_box(GmoBox* pBox)
     {
         ImoId id = pImo->get_id();
         //DBG ------------------------------------------------------------
-        map<ImoId, GmoBox*>::const_iterator it = m_imoToBox.find(id);
-        if (it != m_imoToBox.end())
+        GmoBox* pExisting = m_imoToBox.get(id);
+        if (pExisting)
         {
             LOMSE_LOG_ERROR(
                 "Duplicated Imo id %d. Existing Gmo: %s. Adding Gmo: %s",
-                id, (it->second)->get_name().c_str(), pBox->get_name().c_str() );
+                id, pExisting->get_name().c_str(), pBox->get_name().c_str() );
             //TO_INVESTIGATE: This is not an error for DocPage and DocPageContent
             //boxes, as they can create more boxes when the content
             //is split in two or more physical pages. Maybe the
@@ -178,7 +180,7 @@ void GraphicModel::add_to_map_imo_to_box(GmoBox* pBox)
             //detected cases.
         }
         //END_DBG --------------------------------------------------------
-        m_imoToBox[id] = pBox;
+        m_imoToBox.set(id, pBox);
     }
 }
 
@@ -213,14 +215,10 @@ GmoShape* GraphicModel::get_shape_for_imo(ImoId id, ShapeId shapeId)
 //---------------------------------------------------------------------------------------
 GmoShape* GraphicModel::get_main_shape_for_imo(ImoId id)
 {
-    map<ImoId, GmoShape*>::const_iterator it = m_imoToMainShape.find(id);
-    if (it != m_imoToMainShape.end())
-        return it->second;
-    else
-    {
+    GmoShape* pShape = m_imoToMainShape.get(id);
+    if (pShape == nullptr)
         LOMSE_LOG_INFO("No shape found for Imo id: %d", id );
-        return nullptr;
-    }
+    return pShape;
 }
 
 //---------------------------------------------------------------------------------------
@@ -236,11 +234,7 @@ GmoObj* GraphicModel::get_box_for_control(GmoRef gref)
 //---------------------------------------------------------------------------------------
 GmoBox* GraphicModel::get_box_for_imo(ImoId id)
 {
-	map<ImoId, GmoBox*>::const_iterator it = m_imoToBox.find(id);
-	if (it != m_imoToBox.end())
-		return it->second;
-    else
-        return nullptr;
+    return m_imoToBox.get(id);
 }
 
 //---------------------------------------------------------------------------------------
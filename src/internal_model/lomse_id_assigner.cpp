@@ -39,11 +39,11 @@ void IdAssigner::assign_id(ImoObj* pImo)
     if (id == k_no_imoid)
     {
         pImo->set_id(++m_idCounter);
-        m_idToImo[m_idCounter] = pImo;
+        m_idToImo.set(m_idCounter, pImo);
     }
     else
     {
-        m_idToImo[id] = pImo;
+        m_idToImo.set(id, pImo);
         m_idCounter = max(id, m_idCounter);
     }
 }
@@ -71,14 +71,14 @@ void IdAssigner::assign_id(Control* pControl)
     else
         m_idCounter = max(id, m_idCounter);
 
-    m_idToControl[m_idCounter] = pControl;
+    m_idToControl.set(m_idCounter, pControl);
 }
 
 //---------------------------------------------------------------------------------------
 void IdAssigner::set_control_id(ImoId id, Control* pControl)
 {
     if (id != k_no_imoid)
-        m_idToControl[id] = pControl;
+        m_idToControl.set(id, pControl);
 }
 
 //---------------------------------------------------------------------------------------
@@ -87,7 +87,7 @@ void IdAssigner::remove(ImoObj* pImo)
     ImoId id = pImo->get_id();
     if (id != k_no_imoid)
     {
-        m_idToImo.erase(id);        //this assumes that id exists; crash otherwise
+        m_idToImo.erase(id);
         string xmlId = get_xml_id_for(id);
         if (!xmlId.empty())
             m_xmlIdToId.erase(xmlId);
@@ -121,11 +121,7 @@ void IdAssigner::set_xml_id_for(ImoId id, const string& xmlId)
 //---------------------------------------------------------------------------------------
 ImoObj* IdAssigner::get_pointer_to_imo(ImoId id) const
 {
-	unordered_map<ImoId, ImoObj*>::const_iterator it = m_idToImo.find( id );
-	if (it != m_idToImo.end())
-		return it->second;
-    else
-        return nullptr;
+    return m_idToImo.get(id);
 }
 
 //---------------------------------------------------------------------------------------
@@ -141,11 +137,7 @@ ImoObj* IdAssigner::get_pointer_to_imo(const string& xmlId) const
 //---------------------------------------------------------------------------------------
 Control* IdAssigner::get_pointer_to_control(ImoId id) const
 {
-	unordered_map<ImoId, Control*>::const_iterator it = m_idToControl.find( id );
-	if (it != m_idToControl.end())
-		return it->second;
-    else
-        return nullptr;
+    return m_idToControl.get(id);
 }
 
 //---------------------------------------------------------------------------------------
@@ -153,12 +145,12 @@ string IdAssigner::dump() const
 {
     stringstream data;
     data << "Imo: " << endl;
-	unordered_map<ImoId, ImoObj*>::const_iterator it;
+	IdTable<ImoObj>::const_iterator it;
 	for (it = m_idToImo.begin(); it != m_idToImo.end(); ++it)
 		data << it->first << "-" << it->second->get_name() << endl;
     data << endl;
 
-	unordered_map<ImoId, Control*>::const_iterator itC = m_idToControl.begin();
+	IdTable<Control>::const_iterator itC = m_idToControl.begin();
 	if (itC != m_idToControl.end())
     {
         data << "Control: " << endl;
@@ -172,14 +164,14 @@ string IdAssigner::dump() const
 //---------------------------------------------------------------------------------------
 void IdAssigner::copy_ids_to(IdAssigner* assigner, ImoId idMin)
 {
-	unordered_map<ImoId, ImoObj*>::const_iterator it;
+	IdTable<ImoObj>::const_iterator it;
 	for (it = m_idToImo.begin(); it != m_idToImo.end(); ++it)
     {
         if (it->first >= idMin)
             assigner->add_id(it->first, it->second);
     }
 
-	unordered_map<ImoId, Control*>::const_iterator itC;
+	IdTable<Control>::const_iterator itC;
 	for (itC = m_idToControl.begin(); itC != m_idToControl.end(); ++itC)
         assigner->add_control_id(itC->first, itC->second);
 
@@ -191,13 +183,13 @@ void IdAssigner::copy_ids_to(IdAssigner* assigner, ImoId idMin)
 //---------------------------------------------------------------------------------------
 void IdAssigner::add_id(ImoId id, ImoObj* pImo)
 {
-    m_idToImo[id] = pImo;
+    m_idToImo.set(id, pImo);
 }
 
 //---------------------------------------------------------------------------------------
 void IdAssigner::add_control_id(ImoId id, Control* pControl)
 {
-    m_idToControl[id] = pControl;
+    m_idToControl.set(id, pControl);
 }
 
 //---------------------------------------------------------------------------------------
@@ -225,7 +217,7 @@ bool IdAssigner::check_ids(IdAssigner* pCopy, stringstream& reporter, const stri
             << ", copy = " << pCopy->size() << endl;
     }
 
-	unordered_map<ImoId, ImoObj*>::const_iterator it;
+	IdTable<ImoObj>::const_iterator it;
 	for (it = m_idToImo.begin(); it != m_idToImo.end(); ++it)
     {
         if (pCopy->get_pointer_to_imo(it->first) == nullptr)
@@ -236,7 +228,7 @@ bool IdAssigner::check_ids(IdAssigner* pCopy, stringstream& reporter, const stri
         }
     }
 
-	unordered_map<ImoId, Control*>::const_iterator itC;
+	IdTable<Control>::const_iterator itC;
 	for (itC = m_idToControl.begin(); itC != m_idToControl.end(); ++itC)
     {
         if (pCopy->get_pointer_to_control(itC->first) == nullptr)
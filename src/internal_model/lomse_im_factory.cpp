@@ -28,11 +28,54 @@ ImoObj* ImFactory::inject(int type, Document* pDoc, ImoId id)
 //---------------------------------------------------------------------------------------
 ImoObj* ImFactory::inject(int type, DocModel* pDocModel, ImoId id)
 {
-    ImoObj* pObj = nullptr;
-
     if (!(type > k_imo_dto && type < k_imo_dto_last))
         id = pDocModel->reserve_id(id);
 
+    ImoObj* pObj = create_object(type);
+    if (!pObj)
+    {
+        LOMSE_LOG_ERROR("[ImFactory::inject] invalid type.");
+        throw runtime_error("[ImFactory::inject] invalid type.");
+    }
+
+    if (!pObj->is_dto())
+    {
+        pObj->set_id(id);
+        pDocModel->assign_id(pObj);
+    }
+    pObj->set_owner_model(pDocModel);
+    pObj->initialize_object();
+    return pObj;
+}
+
+//---------------------------------------------------------------------------------------
+ImoObj* ImFactory::restore(int type, DocModel* pDocModel, ImoId id)
+{
+    //Creates an empty node, without the default content added by initialize_object(),
+    //as all content will be restored from a snapshot. Objects without id in the
+    //saved model are restored without id.
+
+    ImoObj* pObj = create_object(type);
+    if (!pObj || pObj->is_dto())
+    {
+        delete pObj;
+        LOMSE_LOG_ERROR("[ImFactory::restore] invalid type.");
+        throw runtime_error("[ImFactory::restore] invalid type.");
+    }
+
+    if (id != k_no_imoid)
+    {
+        pObj->set_id(id);
+        pDocModel->assign_id(pObj);
+    }
+    pObj->set_owner_model(pDocModel);
+    return pObj;
+}
+
+//---------------------------------------------------------------------------------------
+ImoObj* ImFactory::create_object(int type)
+{
+    ImoObj* pObj = nullptr;
     switch(type)
     {
         case k_imo_anonymous_block:     pObj = LOMSE_NEW ImoAnonymousBlock();     break;
@@ -106,7 +149,7 @@ ImoObj* ImFactory::inject(int type, DocModel* pDocModel, ImoId id)
         case k_imo_score_title:         pObj = LOMSE_NEW ImoScoreTitle();         break;
         case k_imo_score_titles:        pObj = LOMSE_NEW ImoScoreTitles();        break;
         case k_imo_slur:                pObj = LOMSE_NEW ImoSlur();               break;
-//        case k_imo_slur_data:           pObj = LOMSE_NEW ImoSlurData();           break;
+        case k_imo_slur_data:           pObj = LOMSE_NEW ImoSlurData();           break;
         case k_imo_slur_dto:            pObj = LOMSE_NEW ImoSlurDto();            break;
         case k_imo_sound_change:        pObj = LOMSE_NEW ImoSoundChange();        break;
         case k_imo_sound_info:          pObj = LOMSE_NEW ImoSoundInfo();          break;
@@ -141,19 +184,8 @@ ImoObj* ImFactory::inject(int type, DocModel* pDocModel, ImoId id)
         case k_imo_wedge:               pObj = LOMSE_NEW ImoWedge();              break;
         case k_imo_wedge_dto:           pObj = LOMSE_NEW ImoWedgeDto();           break;
         default:
-        {
-            LOMSE_LOG_ERROR("[ImFactory::inject] invalid type.");
-            throw runtime_error("[ImFactory::inject] invalid type.");
-        }
-    }
-
-    if (!pObj->is_dto())
-    {
-        pObj->set_id(id);
-        pDocModel->assign_id(pObj);
+            break;
     }
-    pObj->set_owner_model(pDocModel);
-    pObj->initialize_object();
     return pObj;
 }
 
@@ -82,6 +82,26 @@ ImMeasuresTableEntry* ImMeasuresTable::add_entry(ColStaffObjsEntry* pCsoEntry)
     return pEntry;
 }
 
+//---------------------------------------------------------------------------------------
+void ImMeasuresTable::detach_entries(int iFirst, vector<ImMeasuresTableEntry*>& entries)
+{
+    //remove entries from iFirst to the end, and return them in entries.
+    //Entries are not deleted
+    entries.assign(m_theTable.begin() + iFirst, m_theTable.end());
+    m_theTable.erase(m_theTable.begin() + iFirst, m_theTable.end());
+}
+
+//---------------------------------------------------------------------------------------
+void ImMeasuresTable::append_entries(vector<ImMeasuresTableEntry*>::iterator itFirst,
+                                     vector<ImMeasuresTableEntry*>::iterator itEnd)
+{
+    for (auto it=itFirst; it != itEnd; ++it)
+    {
+        m_theTable.push_back(*it);
+        (*it)->set_index( int(m_theTable.size()) - 1 );
+    }
+}
+
 //---------------------------------------------------------------------------------------
 ImMeasuresTableEntry* ImMeasuresTable::get_measure(int iMeasure)
 {
@@ -0,0 +1,1482 @@
+//---------------------------------------------------------------------------------------
+// This file is part of the Lomse library.
+// Copyright (c) 2010-present, Lomse Developers
+//
+// Licensed under the MIT license.
+//
+// See LICENSE and NOTICE.md files in the root directory of this source tree.
+//---------------------------------------------------------------------------------------
+
+#include "lomse_im_snapshot.h"
+
+#include "lomse_version.h"
+#include "lomse_internal_model.h"
+#include "lomse_im_note.h"
+#include "lomse_im_factory.h"
+#include "lomse_im_measures_table.h"
+#include "lomse_staffobjs_table.h"
+#include "lomse_id_assigner.h"
+#include "lomse_image.h"
+#include "lomse_reader.h"
+#include "lomse_logger.h"
+#include "lomse_import_stats.h"
+#include "private/lomse_document_p.h"
+
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+namespace lomse
+{
+
+//=======================================================================================
+// Snapshot file format:
+//  - header: SnapshotHeader struct, for identifying the file and validating the data
+//  - payload: ids counter, xml ids, and the internal model tree, as saved by
+//    ImSnapshotArchive. ColStaffObjs and ImMeasuresTable tables are saved after
+//    the ImoScore subtree.
+//=======================================================================================
+
+#define LOMSE_SNAPSHOT_MAGIC        "LOMSESNP"
+#define LOMSE_SNAPSHOT_FORMAT       2
+
+struct SnapshotHeader
+{
+    char magic[8];
+    uint32_t formatVersion;
+    uint32_t byteOrder;             //0x01020304 as saved, to detect endianness
+    uint32_t typesSignature;        //sizes of the platform dependent types
+    char libraryVersion[32];        //LOMSE_VERSION
+    uint32_t reserved;
+    uint64_t payloadSize;
+    uint64_t checksum;              //checksum of the payload
+};
+
+//---------------------------------------------------------------------------------------
+static uint32_t snapshot_types_signature()
+{
+    return uint32_t(sizeof(long))
+           | uint32_t(sizeof(int)) << 8
+           | uint32_t(sizeof(TimeUnits)) << 16
+           | uint32_t(sizeof(LUnits)) << 24;
+}
+
+//---------------------------------------------------------------------------------------
+static void init_snapshot_header(SnapshotHeader* pHeader)
+{
+    memset(pHeader, 0, sizeof(SnapshotHeader));
+    memcpy(pHeader->magic, LOMSE_SNAPSHOT_MAGIC, sizeof(pHeader->magic));
+    pHeader->formatVersion = LOMSE_SNAPSHOT_FORMAT;
+    pHeader->byteOrder = 0x01020304;
+    pHeader->typesSignature = snapshot_types_signature();
+    strncpy(pHeader->libraryVersion, LOMSE_VERSION, sizeof(pHeader->libraryVersion) - 1);
+}
+
+//---------------------------------------------------------------------------------------
+static uint64_t snapshot_checksum(const char* data, size_t size)
+{
+    //FNV-1a, processing eight bytes per step, with an additional shift for mixing
+    //high bits into low bits
+    const uint64_t prime = 1099511628211ULL;
+    uint64_t hash = 14695981039346656037ULL;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        uint64_t word;
+        memcpy(&word, data + i, 8);
+        hash = (hash ^ word) * prime;
+        hash ^= (hash >> 32);
+    }
+    for (; i < size; ++i)
+        hash = (hash ^ uint64_t(uint8_t(data[i]))) * prime;
+    return hash;
+}
+
+
+//=======================================================================================
+// ImSnapshotArchive implementation
+//=======================================================================================
+ImSnapshotArchive::ImSnapshotArchive(DocModel* pDocModel)
+    : m_pDocModel(pDocModel)
+    , m_fLoading(false)
+    , m_pData(nullptr)
+    , m_pEnd(nullptr)
+{
+}
+
+//---------------------------------------------------------------------------------------
+ImSnapshotArchive::ImSnapshotArchive(DocModel* pDocModel, const char* data, size_t size)
+    : m_pDocModel(pDocModel)
+    , m_fLoading(true)
+    , m_pData(data)
+    , m_pEnd(data + size)
+{
+}
+
+//---------------------------------------------------------------------------------------
+void ImSnapshotArchive::save_model(ImoDocument* pImoDoc)
+{
+    IdAssigner* pIds = m_pDocModel->get_id_assigner();
+    ImoId counter = pIds->m_idCounter;
+    io(counter);
+
+    std::map<ImoId, std::string> xmlIds(pIds->m_idToXmlId.begin(),
+                                        pIds->m_idToXmlId.end());
+    io(xmlIds);
+
+    ImoObj* pRoot = pImoDoc;
+    io_node(pRoot);
+}
+
+//---------------------------------------------------------------------------------------
+ImoDocument* ImSnapshotArchive::restore_model()
+{
+    ImoId counter = k_no_imoid;
+    io(counter);
+
+    std::map<ImoId, std::string> xmlIds;
+    io(xmlIds);
+
+    ImoObj* pRoot = nullptr;
+    io_node(pRoot);
+    if (!pRoot || !pRoot->is_document() || m_pData != m_pEnd)
+        read_error();
+
+    IdAssigner* pIds = m_pDocModel->get_id_assigner();
+    pIds->m_idCounter = max(counter, pIds->m_idCounter);
+    for (auto& item : xmlIds)
+        pIds->set_xml_id_for(item.first, item.second);
+
+    return static_cast<ImoDocument*>(pRoot);
+}
+
+//---------------------------------------------------------------------------------------
+void ImSnapshotArchive::io_bytes(void* data, size_t size)
+{
+    if (m_fLoading)
+    {
+        if (size > size_t(m_pEnd - m_pData))
+            read_error();
+        memcpy(data, m_pData, size);
+        m_pData += size;
+    }
+    else
+        m_out.append(static_cast<const char*>(data), size);
+}
+
+//---------------------------------------------------------------------------------------
+size_t ImSnapshotArchive::io_count(size_t num)
+{
+    uint32_t count = uint32_t(num);
+    io(count);
+
+    //each item requires, at least, one byte
+    if (m_fLoading && size_t(count) > size_t(m_pEnd - m_pData))
+        read_error();
+
+    return size_t(count);
+}
+
+//---------------------------------------------------------------------------------------
+void ImSnapshotArchive::io(std::string& value)
+{
+    size_t size = io_count(value.size());
+    if (m_fLoading)
+    {
+        value.assign(m_pData, size);
+        m_pData += size;
+    }
+    else
+        m_out.append(value);
+}
+
+//---------------------------------------------------------------------------------------
+void ImSnapshotArchive::io(TypeTextInfo& value)
+{
+    io(value.text);
+    io(value.language);
+}
+
+//---------------------------------------------------------------------------------------
+void ImSnapshotArchive::io(TypeMeasureInfo& value)
+{
+    io(value.index);
+    io(value.count);
+    io(value.number);
+    io(value.fHideNumber);
+}
+
+//---------------------------------------------------------------------------------------
+void ImSnapshotArchive::io(AttrList& attribs)
+{
+    //Each attribute is saved as its index, a code for the type of value, and the value
+    enum { k_int=0, k_double, k_float, k_string, k_bool, k_color, };
+
+    size_t num = io_count(attribs.size());
+
+    if (m_fLoading)
+    {
+        attribs.clear();
+        for (size_t i=0; i < num; ++i)
+        {
+            int idx;
+            int kind;
+            io(idx);
+            io(kind);
+            switch (kind)
+            {
+                case k_int:     { int v;    io(v); attribs.push_back(AttrObj(idx, v)); break; }
+                case k_double:  { double v; io(v); attribs.push_back(AttrObj(idx, v)); break; }
+                case k_float:   { float v;  io(v); attribs.push_back(AttrObj(idx, v)); break; }
+                case k_string:  { string v; io(v); attribs.push_back(AttrObj(idx, v)); break; }
+                case k_bool:    { bool v;   io(v); attribs.push_back(AttrObj(idx, v)); break; }
+                case k_color:   { Color v;  io(v); attribs.push_back(AttrObj(idx, v)); break; }
+                default:
+                    read_error();
+            }
+        }
+    }
+    else
+    {
+        for (AttrObj& attr : attribs)
+        {
+            int idx = attr.get_attrib_idx();
+            io(idx);
+            int kind;
+            if (attr.holds<int>())
+            {
+                kind = k_int;   io(kind);
+                int v = attr.get_int_value();   io(v);
+            }
+            else if (attr.holds<double>())
+            {
+                kind = k_double;   io(kind);
+                double v = attr.get_double_value();   io(v);
+            }
+            else if (attr.holds<float>())
+            {
+                kind = k_float;   io(kind);
+                float v = attr.get_float_value();   io(v);
+            }
+            else if (attr.holds<string>())
+            {
+                kind = k_string;   io(kind);
+                string v = attr.get_string_value();   io(v);
+            }
+            else if (attr.holds<bool>())
+            {
+                kind = k_bool;   io(kind);
+                bool v = attr.get_bool_value();   io(v);
+            }
+            else if (attr.holds<Color>())
+            {
+                kind = k_color;   io(kind);
+                Color v = attr.get_color_value();   io(v);
+            }
+            else
+            {
+                LOMSE_LOG_ERROR("Attribute type not supported in snapshots");
+                throw runtime_error("[ImSnapshotArchive::io] Attribute '"
+                                    + attr.get_name()
+                                    + "' can not be saved in a snapshot.");
+            }
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------
+void ImSnapshotArchive::io_node(ImoObj*& pImo)
+{
+    //A node is saved as its type, its id, its content and its children. Type -1 is
+    //used for nullptr
+
+    int type = (pImo ? pImo->get_obj_type() : -1);
+    io(type);
+    if (type == -1)
+    {
+        pImo = nullptr;
+        return;
+    }
+
+    ImoId id = (pImo ? pImo->get_id() : k_no_imoid);
+    io(id);
+
+    if (m_fLoading)
+        pImo = ImFactory::restore(type, m_pDocModel, id);
+    else
+        check_supported(pImo);
+
+    pImo->serialize(*this);
+
+    size_t numChildren = io_count(m_fLoading ? 0 : size_t(pImo->get_num_children()));
+    if (m_fLoading)
+    {
+        for (size_t i=0; i < numChildren; ++i)
+        {
+            ImoObj* pChild = nullptr;
+            io_node(pChild);
+            if (!pChild)
+                read_error();
+            pImo->append_child(pChild);
+        }
+    }
+    else
+    {
+        for (ImoObj* pChild = pImo->get_first_child(); pChild;
+             pChild = pChild->get_next_sibling())
+        {
+            io_node(pChild);
+        }
+    }
+
+    if (pImo->is_score())
+        io_score_tables(static_cast<ImoScore*>(pImo));
+}
+
+//---------------------------------------------------------------------------------------
+void ImSnapshotArchive::io_shared(ImoRelObj*& pRO)
+{
+    //The first reference to a relation saves the full node. Next references only save
+    //the relation ordinal number
+
+    int ref = -1;
+    if (!m_fLoading)
+    {
+        auto it = m_savedRelObjs.find(pRO);
+        if (it != m_savedRelObjs.end())
+            ref = it->second;
+    }
+    io(ref);
+
+    if (ref == -1)
+    {
+        ImoObj* pNode = pRO;
+        io_node(pNode);
+        if (!pNode || !pNode->is_relobj())
+            read_error();
+        pRO = static_cast<ImoRelObj*>(pNode);
+
+        if (m_fLoading)
+            m_restoredRelObjs.push_back(pRO);
+        else
+            m_savedRelObjs[pRO] = int(m_savedRelObjs.size());
+    }
+    else if (m_fLoading)
+    {
+        if (ref < 0 || ref >= int(m_restoredRelObjs.size()))
+            read_error();
+        pRO = m_restoredRelObjs[ref];
+    }
+}
+
+//---------------------------------------------------------------------------------------
+void ImSnapshotArchive::io_score_tables(ImoScore* pScore)
+{
+    //ColStaffObjs and measures tables. Entries are saved in table order, and measures
+    //refer to entries by its position in the ColStaffObjs table
+
+    ColStaffObjs* pTable = pScore->get_staffobjs_table();
+    bool fExists = (pTable != nullptr);
+    io(fExists);
+    if (!fExists)
+        return;
+
+    if (m_fLoading)
+    {
+        pTable = LOMSE_NEW ColStaffObjs();
+        pScore->set_staffobjs_table(pTable);
+    }
+
+    io(pTable->m_numLines);
+    io(pTable->m_rMissingTime);
+    io(pTable->m_rAnacrusisExtraTime);
+    io(pTable->m_minNoteDuration);
+    io(pTable->m_numHalf);
+    io(pTable->m_numQuarter);
+    io(pTable->m_numEighth);
+    io(pTable->m_num16th);
+    io(pTable->m_divisions);
+
+    size_t numEntries = io_count(size_t(pTable->num_entries()));
+    if (m_fLoading)
+    {
+        for (size_t i=0; i < numEntries; ++i)
+        {
+            int measure, instr, line, staff;
+            ImoId id;
+            io(measure);
+            io(instr);
+            io(line);
+            io(staff);
+            io(id);
+            ImoObj* pImo = m_pDocModel->get_pointer_to_imo(id);
+            if (!pImo || !pImo->is_staffobj())
+                read_error();
+
+            ColStaffObjsEntry* pEntry =
+                pTable->create_entry(measure, instr, line, staff,
+                                     static_cast<ImoStaffObj*>(pImo));
+            pTable->append_entry(pEntry);
+        }
+    }
+    else
+    {
+        for (ColStaffObjsEntry* pEntry : pTable->m_entries)
+        {
+            io(pEntry->m_measure);
+            io(pEntry->m_instr);
+            io(pEntry->m_line);
+            io(pEntry->m_staff);
+            ImoId id = pEntry->m_pImo->get_id();
+            io(id);
+        }
+    }
+
+    auto index_of = [](ColStaffObjsEntry* pEntry) -> int
+    {
+        return (pEntry ? pEntry->index() : -1);
+    };
+    auto entry_at = [this, pTable](int i) -> ColStaffObjsEntry*
+    {
+        if (i < -1 || i >= pTable->num_entries())
+            read_error();
+        return pTable->entry_at(i);
+    };
+
+    int numInstrs = pScore->get_num_instruments();
+    if (io_count(size_t(numInstrs)) != size_t(numInstrs))
+        read_error();
+
+    for (int iInstr=0; iInstr < numInstrs; ++iInstr)
+    {
+        ImoInstrument* pInstr = pScore->get_instrument(iInstr);
+        ImMeasuresTable* pMeasures = pInstr->get_measures_table();
+        bool fHasMeasures = (pMeasures != nullptr);
+        io(fHasMeasures);
+        if (!fHasMeasures)
+            continue;
+
+        if (m_fLoading)
+        {
+            pMeasures = LOMSE_NEW ImMeasuresTable();
+            pInstr->set_measures_table(pMeasures);
+        }
+
+        size_t numMeasures = io_count(size_t(pMeasures->num_entries()));
+        for (size_t i=0; i < numMeasures; ++i)
+        {
+            ImMeasuresTableEntry* pEntry = (m_fLoading ? nullptr
+                                                       : pMeasures->get_measure(int(i)));
+            int iStart = (m_fLoading ? -1 : index_of(pEntry->m_pStartEntry));
+            int iEnd = (m_fLoading ? -1 : index_of(pEntry->m_pEndEntry));
+            io(iStart);
+            io(iEnd);
+            if (m_fLoading)
+            {
+                pEntry = pMeasures->add_entry( entry_at(iStart) );
+                pEntry->m_pEndEntry = entry_at(iEnd);
+            }
+            io(pEntry->m_timepos);
+            io(pEntry->m_firstId);
+            io(pEntry->m_bottomBeat);
+            io(pEntry->m_impliedBeat);
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------
+void ImSnapshotArchive::check_supported(ImoObj* pImo)
+{
+    //objects owning resources external to the model, and objects whose content is not
+    //yet serialized
+    if (pImo->is_dto() || pImo->is_control() || pImo->is_cursor_info()
+        || pImo->is_figured_bass())
+    {
+        LOMSE_LOG_ERROR("Object not supported in snapshots: %s", pImo->get_name().c_str());
+        throw runtime_error("[ImSnapshotArchive] '" + pImo->get_name()
+                            + "' objects can not be saved in a snapshot.");
+    }
+}
+
+//---------------------------------------------------------------------------------------
+void ImSnapshotArchive::read_error()
+{
+    LOMSE_LOG_ERROR("Invalid snapshot data");
+    throw runtime_error("[ImSnapshotArchive] Invalid snapshot data.");
+}
+
+
+//=======================================================================================
+// ImoObj::serialize() implementation, for all classes with member variables. Each
+// class saves its own variables after invoking its base class method
+//=======================================================================================
+void ImoObj::serialize(ImSnapshotArchive& ar)
+{
+    ar.io(m_flags);
+    ar.io(m_attribs);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoStyle::serialize(ImSnapshotArchive& ar)
+{
+    ImoSimpleObj::serialize(ar);
+    ar.io(m_name);
+    ar.io(m_idParent);
+    ar.io(m_lunitsProps);
+    ar.io(m_floatProps);
+    ar.io(m_stringProps);
+    ar.io(m_intProps);
+    ar.io(m_colorProps);
+    ar.io(m_modified);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoRelations::serialize(ImSnapshotArchive& ar)
+{
+    ImoSimpleObj::serialize(ar);
+    size_t num = ar.io_count(m_relations.size());
+    if (ar.is_loading())
+        m_relations.resize(num, nullptr);
+    for (ImoRelObj*& pRO : m_relations)
+        ar.io_shared(pRO);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoContentObj::serialize(ImSnapshotArchive& ar)
+{
+    ImoObj::serialize(ar);
+    ar.io(m_styleId);
+    ar.io(m_txUserLocation);
+    ar.io(m_tyUserLocation);
+    ar.io(m_txUserRefPoint);
+    ar.io(m_tyUserRefPoint);
+    ar.io(m_fVisible);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoBoxInline::serialize(ImSnapshotArchive& ar)
+{
+    ImoInlineLevelObj::serialize(ar);
+    ar.io(m_size);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoLink::serialize(ImSnapshotArchive& ar)
+{
+    ImoBoxInline::serialize(ar);
+    ar.io(m_url);
+    ar.io(m_language);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoScoreObj::serialize(ImSnapshotArchive& ar)
+{
+    ImoContentObj::serialize(ar);
+    ar.io(m_color);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoStaffObj::serialize(ImSnapshotArchive& ar)
+{
+    //m_pEntry is restored when restoring the ColStaffObjs table
+    ImoScoreObj::serialize(ar);
+    ar.io(m_staff);
+    ar.io(m_nVoice);
+    ar.io(m_time);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoAuxRelObj::serialize(ImSnapshotArchive& ar)
+{
+    ImoAuxObj::serialize(ar);
+    ar.io(m_prevId);
+    ar.io(m_nextId);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoRelObj::serialize(ImSnapshotArchive& ar)
+{
+    ImoScoreObj::serialize(ar);
+#if (LOMSE_RELOBJ_USES_ID == 1)
+    ar.io(m_relatedObjects);
+#else
+    LOMSE_LOG_ERROR("Snapshots require LOMSE_RELOBJ_USES_ID");
+    throw runtime_error("[ImoRelObj::serialize] Snapshots not supported.");
+#endif
+}
+
+//---------------------------------------------------------------------------------------
+void ImoBeamData::serialize(ImSnapshotArchive& ar)
+{
+    ImoRelDataObj::serialize(ar);
+    ar.io(m_beamType);
+    ar.io(m_repeat);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoBezierInfo::serialize(ImSnapshotArchive& ar)
+{
+    ImoSimpleObj::serialize(ar);
+    ar.io(m_tPoints);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoChord::serialize(ImSnapshotArchive& ar)
+{
+    ImoRelObj::serialize(ar);
+    ar.io(m_fCrossStaff);
+    ar.io(m_stemDirection);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoMidiInfo::serialize(ImSnapshotArchive& ar)
+{
+    ImoSimpleObj::serialize(ar);
+    ar.io(m_soundId);
+    ar.io(m_port);
+    ar.io(m_midiDeviceName);
+    ar.io(m_midiName);
+    ar.io(m_bank);
+    ar.io(m_channel);
+    ar.io(m_program);
+    ar.io(m_unpitched);
+    ar.io(m_volume);
+    ar.io(m_pan);
+    ar.io(m_elevation);
+    ar.io(m_modified);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoTextBlockInfo::serialize(ImSnapshotArchive& ar)
+{
+    ImoSimpleObj::serialize(ar);
+    ar.io(m_size);
+    ar.io(m_topLeftPoint);
+    ar.io(m_bgColor);
+    ar.io(m_borderColor);
+    ar.io(m_borderWidth);
+    ar.io(m_borderStyle);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoSoundInfo::serialize(ImSnapshotArchive& ar)
+{
+    ImoSimpleObj::serialize(ar);
+    ar.io(m_soundId);
+    ar.io(m_instrName);
+    ar.io(m_instrAbbrev);
+    ar.io(m_instrSound);
+    ar.io(m_fSolo);
+    ar.io(m_fEnsemble);
+    ar.io(m_ensembleSize);
+    ar.io(m_virtualLibrary);
+    ar.io(m_virtualName);
+    ar.io(m_playTechnique);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoPageInfo::serialize(ImSnapshotArchive& ar)
+{
+    ImoSimpleObj::serialize(ar);
+    ar.io(m_uLeftMarginOdd);
+    ar.io(m_uRightMarginOdd);
+    ar.io(m_uTopMarginOdd);
+    ar.io(m_uBottomMarginOdd);
+    ar.io(m_uLeftMarginEven);
+    ar.io(m_uRightMarginEven);
+    ar.io(m_uTopMarginEven);
+    ar.io(m_uBottomMarginEven);
+    ar.io(m_uPageSize);
+    ar.io(m_fPortrait);
+    ar.io(m_modified);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoBarline::serialize(ImSnapshotArchive& ar)
+{
+    ImoStaffObj::serialize(ar);
+    ar.io(m_barlineType);
+    ar.io(m_fMiddle);
+    ar.io(m_fTKChange);
+    ar.io(m_times);
+    ar.io(m_winged);
+    ar.io_owned(m_pMeasureInfo);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoBeam::serialize(ImSnapshotArchive& ar)
+{
+    ImoRelObj::serialize(ar);
+    ar.io_owned(m_pStemsDir);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoBlock::serialize(ImSnapshotArchive& ar)
+{
+    ImoAuxObj::serialize(ar);
+    m_box.serialize(ar);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoTextBox::serialize(ImSnapshotArchive& ar)
+{
+    ImoBlock::serialize(ar);
+    ar.io(m_text);
+    ar.io(m_line);
+    ar.io(m_fHasAnchorLine);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoClef::serialize(ImSnapshotArchive& ar)
+{
+    ImoStaffObj::serialize(ar);
+    ar.io(m_sign);
+    ar.io(m_line);
+    ar.io(m_octaveChange);
+    ar.io(m_symbolSize);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoDirection::serialize(ImSnapshotArchive& ar)
+{
+    ImoStaffObj::serialize(ar);
+    ar.io(m_space);
+    ar.io(m_placement);
+    ar.io(m_displayRepeat);
+    ar.io(m_soundRepeat);
+    ar.io(m_idNR);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoSymbolRepetitionMark::serialize(ImSnapshotArchive& ar)
+{
+    ImoAuxObj::serialize(ar);
+    ar.io(m_symbol);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoDynamic::serialize(ImSnapshotArchive& ar)
+{
+    ImoContent::serialize(ar);
+    ar.io(m_classid);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoDocument::serialize(ImSnapshotArchive& ar)
+{
+    ImoBlocksContainer::serialize(ar);
+    ar.io(m_scale);
+    ar.io(m_version);
+    ar.io(m_language);
+    ar.io(m_privateStyles);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoArpeggio::serialize(ImSnapshotArchive& ar)
+{
+    ImoRelObj::serialize(ar);
+    ar.io(m_type);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoFermata::serialize(ImSnapshotArchive& ar)
+{
+    ImoAuxObj::serialize(ar);
+    ar.io(m_placement);
+    ar.io(m_symbol);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoArticulation::serialize(ImSnapshotArchive& ar)
+{
+    ImoAuxObj::serialize(ar);
+    ar.io(m_articulationType);
+    ar.io(m_placement);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoArticulationSymbol::serialize(ImSnapshotArchive& ar)
+{
+    ImoArticulation::serialize(ar);
+    ar.io(m_fUp);
+    ar.io(m_symbol);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoArticulationLine::serialize(ImSnapshotArchive& ar)
+{
+    ImoArticulation::serialize(ar);
+    ar.io(m_lineShape);
+    ar.io(m_lineType);
+    ar.io(m_dashLength);
+    ar.io(m_dashSpace);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoDynamicsMark::serialize(ImSnapshotArchive& ar)
+{
+    ImoAuxObj::serialize(ar);
+    ar.io(m_markType);
+    ar.io(m_placement);
+    ar.io(m_moved);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoOrnament::serialize(ImSnapshotArchive& ar)
+{
+    ImoAuxObj::serialize(ar);
+    ar.io(m_ornamentType);
+    ar.io(m_placement);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoTechnical::serialize(ImSnapshotArchive& ar)
+{
+    ImoAuxObj::serialize(ar);
+    ar.io(m_technicalType);
+    ar.io(m_placement);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoFretString::serialize(ImSnapshotArchive& ar)
+{
+    ImoTechnical::serialize(ar);
+    ar.io(m_fret);
+    ar.io(m_string);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoFingering::serialize(ImSnapshotArchive& ar)
+{
+    ImoTechnical::serialize(ar);
+    size_t num = ar.io_count(m_fingerings.size());
+    if (ar.is_loading())
+    {
+        m_fingerings.clear();
+        for (size_t i=0; i < num; ++i)
+            m_fingerings.emplace_back("");
+    }
+    for (FingerData& data : m_fingerings)
+    {
+        ar.io(data.value);
+        ar.io(data.flags);
+        ar.io(data.attribs);
+    }
+}
+
+//---------------------------------------------------------------------------------------
+void ImoGoBackFwd::serialize(ImSnapshotArchive& ar)
+{
+    ImoStaffObj::serialize(ar);
+    ar.io(m_fFwd);
+    ar.io(m_rTimeShift);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoGraceRelObj::serialize(ImSnapshotArchive& ar)
+{
+    ImoRelObj::serialize(ar);
+    ar.io(m_graceType);
+    ar.io(m_fSlash);
+    ar.io(m_percentage);
+    ar.io(m_makeTime);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoScoreText::serialize(ImSnapshotArchive& ar)
+{
+    ImoAuxObj::serialize(ar);
+    ar.io(m_text);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoScoreTitle::serialize(ImSnapshotArchive& ar)
+{
+    ImoScoreText::serialize(ar);
+    ar.io(m_hAlign);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoTranspose::serialize(ImSnapshotArchive& ar)
+{
+    ImoStaffObj::serialize(ar);
+    ar.io(m_numStaff);
+    ar.io(m_diatonic);
+    ar.io(m_chromatic);
+    ar.io(m_octaveChange);
+    ar.io(m_doubled);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoTextRepetitionMark::serialize(ImSnapshotArchive& ar)
+{
+    ImoScoreText::serialize(ar);
+    ar.io(m_repeatType);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoImage::serialize(ImSnapshotArchive& ar)
+{
+    //the bitmap is saved as raw pixels
+    ImoInlineLevelObj::serialize(ar);
+
+    VSize bmpSize = m_image->get_bitmap_size();
+    USize imgSize = m_image->get_image_size();
+    int format = m_image->get_format();
+    ar.io(bmpSize);
+    ar.io(imgSize);
+    ar.io(format);
+
+    size_t bytes = 0;
+    if (!ar.is_loading() && m_image->get_buffer())
+        bytes = size_t(m_image->get_stride()) * size_t(bmpSize.height);
+    bytes = ar.io_count(bytes);
+
+    if (ar.is_loading())
+    {
+        unsigned char* imgbuf = nullptr;
+        if (bytes > 0)
+        {
+            imgbuf = static_cast<unsigned char*>( malloc(bytes) );
+            if (imgbuf == nullptr)
+            {
+                LOMSE_LOG_ERROR("Not enough memory for image");
+                throw runtime_error("[ImoImage::serialize] Not enough memory for image.");
+            }
+            ar.io_bytes(imgbuf, bytes);
+        }
+        m_image = SpImage( LOMSE_NEW Image(imgbuf, bmpSize, EPixelFormat(format),
+                                           imgSize) );
+    }
+    else if (bytes > 0)
+        ar.io_bytes(m_image->get_buffer(), bytes);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoInstrGroup::serialize(ImSnapshotArchive& ar)
+{
+    ImoSimpleObj::serialize(ar);
+    ar.io(m_joinBarlines);
+    ar.io(m_symbol);
+    ar.io(m_name);
+    ar.io(m_abbrev);
+    ar.io(m_numInstrs);
+    ar.io(m_iFirstInstr);
+    ar.io(m_nameStyle);
+    ar.io(m_abbrevStyle);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoInstrument::serialize(ImSnapshotArchive& ar)
+{
+    //m_pMeasures is restored with the score tables
+    ImoContainerObj::serialize(ar);
+    ar.io(m_name);
+    ar.io(m_abbrev);
+    ar.io(m_nameStyle);
+    ar.io(m_abbrevStyle);
+    ar.io(m_partId);
+    ar.io(m_staves);
+    ar.io(m_barlineLayout);
+    ar.io(m_measuresNumbering);
+    ar.io_owned(m_pLastMeasureInfo);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoKeySignature::serialize(ImSnapshotArchive& ar)
+{
+    ImoStaffObj::serialize(ar);
+    ar.io(m_fStandard);
+    ar.io(m_fForAllStaves);
+    ar.io(m_fifths);
+    ar.io(m_keyMode);
+    ar.io(m_fCancel);
+    ar.io(m_accidentals);
+    ar.io(m_octave);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoLine::serialize(ImSnapshotArchive& ar)
+{
+    ImoAuxObj::serialize(ar);
+    ar.io(m_style);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoList::serialize(ImSnapshotArchive& ar)
+{
+    ImoBlocksContainer::serialize(ar);
+    ar.io(m_listType);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoMetronomeMark::serialize(ImSnapshotArchive& ar)
+{
+    ImoAuxObj::serialize(ar);
+    ar.io(m_markType);
+    ar.io(m_ticksPerMinute);
+    ar.io(m_leftNoteType);
+    ar.io(m_leftDots);
+    ar.io(m_rightNoteType);
+    ar.io(m_rightDots);
+    ar.io(m_fParenthesis);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoMultiColumn::serialize(ImSnapshotArchive& ar)
+{
+    ImoBlocksContainer::serialize(ar);
+    ar.io(m_widths);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoOptionInfo::serialize(ImSnapshotArchive& ar)
+{
+    ImoSimpleObj::serialize(ar);
+    ar.io(m_type);
+    ar.io(m_name);
+    ar.io(m_sValue);
+    ar.io(m_fValue);
+    ar.io(m_nValue);
+    ar.io(m_rValue);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoParamInfo::serialize(ImSnapshotArchive& ar)
+{
+    ImoSimpleObj::serialize(ar);
+    ar.io(m_name);
+    ar.io(m_value);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoHeading::serialize(ImSnapshotArchive& ar)
+{
+    ImoInlinesContainer::serialize(ar);
+    ar.io(m_level);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoScoreLine::serialize(ImSnapshotArchive& ar)
+{
+    ImoAuxObj::serialize(ar);
+    ar.io(m_startPoint);
+    ar.io(m_endPoint);
+    ar.io(m_style);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoScore::serialize(ImSnapshotArchive& ar)
+{
+    //ColStaffObjs table is saved after the score subtree. MIDI table is not saved, as
+    //it is created when needed
+    ImoBlockLevelObj::serialize(ar);
+    ar.io(m_version);
+    ar.io(m_sourceFormat);
+    ar.io(m_accidentalsModel);
+    ar.io(m_scaling);
+
+    //system info objects are members, not nodes. Their ids are saved here
+    ImoId idFirst = m_systemInfoFirst.get_id();
+    ImoId idOther = m_systemInfoOther.get_id();
+    ar.io(idFirst);
+    ar.io(idOther);
+    m_systemInfoFirst.set_id(idFirst);
+    m_systemInfoOther.set_id(idOther);
+    m_systemInfoFirst.serialize(ar);
+    m_systemInfoOther.serialize(ar);
+    ar.io(m_nameToStyle);
+    ar.io(m_numLyricFonts);
+    ar.io(m_lyricLanguages);
+    ar.io(m_staffDistance);
+    ar.io(m_modified);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoSystemInfo::serialize(ImSnapshotArchive& ar)
+{
+    ImoSimpleObj::serialize(ar);
+    ar.io(m_fFirst);
+    ar.io(m_leftMargin);
+    ar.io(m_rightMargin);
+    ar.io(m_systemDistance);
+    ar.io(m_topSystemDistance);
+    ar.io(m_modified);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoSlur::serialize(ImSnapshotArchive& ar)
+{
+    ImoRelObj::serialize(ar);
+    ar.io(m_slurNum);
+    ar.io(m_orientation);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoSlurData::serialize(ImSnapshotArchive& ar)
+{
+    ImoRelDataObj::serialize(ar);
+    ar.io(m_fStart);
+    ar.io(m_slurNum);
+    ar.io(m_orientation);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoStaffInfo::serialize(ImSnapshotArchive& ar)
+{
+    ImoSimpleObj::serialize(ar);
+    ar.io(m_numStaff);
+    ar.io(m_nNumLines);
+    ar.io(m_staffType);
+    ar.io(m_uSpacing);
+    ar.io(m_uLineThickness);
+    ar.io(m_uMarging);
+    ar.io(m_fTablature);
+    ar.io(m_notationScaling);
+    ar.io(m_modified);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoStyles::serialize(ImSnapshotArchive& ar)
+{
+    ImoSimpleObj::serialize(ar);
+    ar.io(m_nameToStyle);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoTable::serialize(ImSnapshotArchive& ar)
+{
+    ImoBlocksContainer::serialize(ar);
+    ar.io(m_colStyles);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoTableCell::serialize(ImSnapshotArchive& ar)
+{
+    ImoBlocksContainer::serialize(ar);
+    ar.io(m_rowspan);
+    ar.io(m_colspan);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoTextItem::serialize(ImSnapshotArchive& ar)
+{
+    ImoInlineLevelObj::serialize(ar);
+    ar.io(m_text);
+    ar.io(m_language);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoTieData::serialize(ImSnapshotArchive& ar)
+{
+    ImoRelDataObj::serialize(ar);
+    ar.io(m_fStart);
+    ar.io(m_tieNum);
+    ar.io(m_orientation);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoTie::serialize(ImSnapshotArchive& ar)
+{
+    ImoRelObj::serialize(ar);
+    ar.io(m_tieNum);
+    ar.io(m_orientation);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoTimeSignature::serialize(ImSnapshotArchive& ar)
+{
+    ImoStaffObj::serialize(ar);
+    ar.io(m_top);
+    ar.io(m_bottom);
+    ar.io(m_type);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoTuplet::serialize(ImSnapshotArchive& ar)
+{
+    ImoRelObj::serialize(ar);
+    ar.io(m_nActualNum);
+    ar.io(m_nNormalNum);
+    ar.io(m_nShowBracket);
+    ar.io(m_nShowNumber);
+    ar.io(m_nPlacement);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoLyric::serialize(ImSnapshotArchive& ar)
+{
+    ImoAuxRelObj::serialize(ar);
+    ar.io(m_number);
+    ar.io(m_placement);
+    ar.io(m_numTextItems);
+    ar.io(m_fLaughing);
+    ar.io(m_fHumming);
+    ar.io(m_fEndLine);
+    ar.io(m_fEndParagraph);
+    ar.io(m_fMelisma);
+    ar.io(m_fHyphenation);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoLyricsTextInfo::serialize(ImSnapshotArchive& ar)
+{
+    ImoSimpleObj::serialize(ar);
+    ar.io(m_syllableType);
+    ar.io(m_text);
+    ar.io(m_styleId);
+    ar.io(m_elision);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoOctaveShift::serialize(ImSnapshotArchive& ar)
+{
+    ImoRelObj::serialize(ar);
+    ar.io(m_steps);
+    ar.io(m_octaveShiftNum);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoPedalMark::serialize(ImSnapshotArchive& ar)
+{
+    ImoAuxObj::serialize(ar);
+    ar.io(m_type);
+    ar.io(m_fAbbreviated);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoPedalLine::serialize(ImSnapshotArchive& ar)
+{
+    ImoRelObj::serialize(ar);
+    ar.io(m_fDrawStartCorner);
+    ar.io(m_fDrawEndCorner);
+    ar.io(m_fDrawContinuationText);
+    ar.io(m_fSostenuto);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoVoltaBracket::serialize(ImSnapshotArchive& ar)
+{
+    ImoRelObj::serialize(ar);
+    ar.io(m_fStopJog);
+    ar.io(m_voltaNum);
+    ar.io(m_voltaText);
+    ar.io(m_repetitions);
+    ar.io(m_numVoltas);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoWedge::serialize(ImSnapshotArchive& ar)
+{
+    ImoRelObj::serialize(ar);
+    ar.io(m_startSpread);
+    ar.io(m_endSpread);
+    ar.io(m_fNiente);
+    ar.io(m_fCrescendo);
+    ar.io(m_wedgeNum);
+    ar.io(m_modified);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoNoteRest::serialize(ImSnapshotArchive& ar)
+{
+    ImoStaffObj::serialize(ar);
+    ar.io(m_fUnpitched);
+    ar.io(m_nNoteType);
+    ar.io(m_step);
+    ar.io(m_octave);
+    ar.io(m_nDots);
+    ar.io(m_timeModifierTop);
+    ar.io(m_timeModifierBottom);
+    ar.io(m_duration);
+    ar.io(m_playDuration);
+    ar.io(m_eventDuration);
+    ar.io(m_playTime);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoRest::serialize(ImSnapshotArchive& ar)
+{
+    ImoNoteRest::serialize(ar);
+    ar.io(m_fGoFwd);
+    ar.io(m_fFullMeasureRest);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoNote::serialize(ImSnapshotArchive& ar)
+{
+    ImoNoteRest::serialize(ar);
+    ar.io(m_actual_acc);
+    ar.io(m_notated_acc);
+    ar.io(m_options);
+    ar.io(m_stemDirection);
+    ar.io(m_idTieNext);
+    ar.io(m_idTiePrev);
+    ar.io(m_computedStem);
+    ar.io(m_fMute);
+}
+
+//---------------------------------------------------------------------------------------
+void ImoGraceNote::serialize(ImSnapshotArchive& ar)
+{
+    ImoNote::serialize(ar);
+    ar.io(m_alignTime);
+}
+
+
+//=======================================================================================
+// SnapshotExporter implementation
+//=======================================================================================
+SnapshotExporter::SnapshotExporter(ostream& reporter)
+    : m_reporter(reporter)
+{
+}
+
+//---------------------------------------------------------------------------------------
+bool SnapshotExporter::save(DocModel* pDocModel, ostream& out)
+{
+    ImoDocument* pImoDoc = pDocModel->get_im_root();
+    if (!pImoDoc)
+    {
+        m_reporter << "Snapshot not saved: the document is empty." << endl;
+        return false;
+    }
+
+    ImSnapshotArchive ar(pDocModel);
+    try
+    {
+        ar.save_model(pImoDoc);
+    }
+    catch (std::exception& e)
+    {
+        m_reporter << "Snapshot not saved: " << e.what() << endl;
+        return false;
+    }
+
+    const std::string& payload = ar.get_saved_data();
+    SnapshotHeader header;
+    init_snapshot_header(&header);
+    header.payloadSize = uint64_t(payload.size());
+    header.checksum = snapshot_checksum(payload.data(), payload.size());
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(SnapshotHeader));
+    out.write(payload.data(), streamsize(payload.size()));
+    return out.good();
+}
+
+
+//=======================================================================================
+// SnapshotCompiler implementation
+//=======================================================================================
+SnapshotCompiler::SnapshotCompiler(Document* pDoc, ostream& reporter)
+    : Compiler(nullptr, nullptr, nullptr, pDoc)
+    , m_reporter(reporter)
+    , m_numErrors(0)
+{
+}
+
+//---------------------------------------------------------------------------------------
+ImoDocument* SnapshotCompiler::compile_file(const std::string& filename)
+{
+    m_fileLocator = filename;
+    try
+    {
+        //the file is memory mapped when possible
+        LdpMappedFileReader reader(filename);
+        LdpReaderBuffer* pBuffer = reader.get_buffer();
+        return restore(pBuffer->get_data(), pBuffer->get_size());
+    }
+    catch (std::exception& e)
+    {
+        report_error(e.what());
+        return nullptr;
+    }
+}
+
+//---------------------------------------------------------------------------------------
+ImoDocument* SnapshotCompiler::compile_string(const std::string& source)
+{
+    return compile_buffer(source.data(), source.size());
+}
+
+//---------------------------------------------------------------------------------------
+ImoDocument* SnapshotCompiler::compile_buffer(const void* buffer, size_t size)
+{
+    m_fileLocator = "string:";
+    return restore(static_cast<const char*>(buffer), size);
+}
+
+//---------------------------------------------------------------------------------------
+ImoDocument* SnapshotCompiler::restore(const char* data, size_t size)
+{
+    //All data is validated before creating any object
+
+    ImportPhase phase(ImportStats::k_import_restore);
+    SnapshotHeader header;
+    if (size < sizeof(SnapshotHeader))
+    {
+        report_error("Invalid snapshot: not a snapshot or truncated data.");
+        return nullptr;
+    }
+    memcpy(&header, data, sizeof(SnapshotHeader));
+
+    SnapshotHeader expected;
+    init_snapshot_header(&expected);
+    if (memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0)
+    {
+        report_error("Invalid snapshot: not a snapshot.");
+        return nullptr;
+    }
+    if (header.formatVersion != expected.formatVersion
+        || header.byteOrder != expected.byteOrder
+        || header.typesSignature != expected.typesSignature
+        || memcmp(header.libraryVersion, expected.libraryVersion,
+                  sizeof(header.libraryVersion)) != 0)
+    {
+        report_error("Snapshot created by a different Lomse version or platform.");
+        return nullptr;
+    }
+
+    const char* payload = data + sizeof(SnapshotHeader);
+    size_t payloadSize = size - sizeof(SnapshotHeader);
+    if (header.payloadSize != uint64_t(payloadSize))
+    {
+        report_error("Invalid snapshot: truncated data.");
+        return nullptr;
+    }
+    if (header.checksum != snapshot_checksum(payload, payloadSize))
+    {
+        report_error("Invalid snapshot: corrupted data.");
+        return nullptr;
+    }
+
+    DocModel* pModel = m_pDoc->get_doc_model();
+    try
+    {
+        ImSnapshotArchive ar(pModel, payload, payloadSize);
+        return ar.restore_model();
+    }
+    catch (std::exception& e)
+    {
+        //AWARE: a partially restored tree can not be safely deleted, as relations
+        //could be incomplete. This will produce memory leaks, but only when the data
+        //is not valid despite of a valid checksum
+        pModel->reset_id_assigner();
+        report_error(e.what());
+        return nullptr;
+    }
+}
+
+//---------------------------------------------------------------------------------------
+void SnapshotCompiler::report_error(const std::string& msg)
+{
+    m_reporter << msg << endl;
+    LOMSE_LOG_ERROR(msg);
+    ++m_numErrors;
+}
+
+
+}  //namespace lomse
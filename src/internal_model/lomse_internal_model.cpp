@@ -48,7 +48,6 @@ LUnits pt_to_LUnits(float pt)
 //---------------------------------------------------------------------------------------
 // static variables to convert from ImoObj type to name
 static map<int, string> m_TypeToName;
-static bool m_fNamesRegistered;
 static string m_unknown = "unknown";
 
 //---------------------------------------------------------------------------------------
@@ -110,215 +109,76 @@ const string AttrObj::get_name(int idx)
     return data.label;
 }
 
-//---------------------------------------------------------------------------------------
-AttrObj* AttrObj::replace_by(AttrObj* newAttr)
-{
-    newAttr->set_next_attrib(m_next);
-    newAttr->set_prev_attrib(m_prev);
-    if (m_prev)
-        m_prev->set_next_attrib(newAttr);
-
-    m_next = nullptr;
-    delete this;
-
-    return newAttr;
-}
-
-//---------------------------------------------------------------------------------------
-int AttrObj::get_int_value() const
-{
-    const Attr<int>* p1 = static_cast< Attr<int> const * >(this);
-    Attr<int>* p2 = const_cast< Attr<int>* >(p1);
-    return p2->get_value();
-//    return static_cast< Attr<int>* >(this)->get_value();
-}
-
-//---------------------------------------------------------------------------------------
-double AttrObj::get_double_value() const
-{
-    const Attr<double>* p1 = static_cast< Attr<double> const * >(this);
-    Attr<double>* p2 = const_cast< Attr<double>* >(p1);
-    return p2->get_value();
-//    return static_cast< Attr<double>* >(this)->get_value();
-}
-
-//---------------------------------------------------------------------------------------
-std::string AttrObj::get_string_value() const
-{
-    const Attr<string>* p1 = static_cast< Attr<string> const * >(this);
-    Attr<string>* p2 = const_cast< Attr<string>* >(p1);
-    return p2->get_value();
-//    return static_cast< Attr<string>* >(this)->get_value();
-}
-
-//---------------------------------------------------------------------------------------
-bool AttrObj::get_bool_value() const
-{
-    const Attr<bool>* p1 = static_cast< Attr<bool> const * >(this);
-    Attr<bool>* p2 = const_cast< Attr<bool>* >(p1);
-    return p2->get_value();
-//    return static_cast< Attr<bool>* >(this)->get_value();
-}
-
-//---------------------------------------------------------------------------------------
-float AttrObj::get_float_value() const
-{
-    const Attr<float>* p1 = static_cast< Attr<float> const * >(this);
-    Attr<float>* p2 = const_cast< Attr<float>* >(p1);
-    return p2->get_value();
-//    return static_cast< Attr<float>* >(this)->get_value();
-}
-
-//---------------------------------------------------------------------------------------
-Color AttrObj::get_color_value() const
-{
-    const Attr< Color >* p1 = static_cast< Attr< Color > const * >(this);
-    Attr< Color >* p2 = const_cast< Attr< Color >* >(p1);
-    return p2->get_value();
-//    return static_cast< const Attr< Color >* >(this)->get_value();
-}
-
-
-//=======================================================================================
-// AttrVariant implementation
-//=======================================================================================
-AttrVariant::AttrVariant(int idx, const string& value)
-    : AttrObj(idx)
-{
-    set_string_value(value);
-}
-
-//---------------------------------------------------------------------------------------
-AttrVariant::AttrVariant(int idx, int value)
-    : AttrObj(idx)
-{
-    set_int_value(value);
-}
-
-//---------------------------------------------------------------------------------------
-AttrVariant::AttrVariant(int idx, double value)
-    : AttrObj(idx)
-{
-    set_double_value(value);
-}
-
-//---------------------------------------------------------------------------------------
-AttrVariant::AttrVariant(int idx, bool value)
-    : AttrObj(idx)
-{
-    set_bool_value(value);
-}
-
-//---------------------------------------------------------------------------------------
-AttrVariant::AttrVariant(int idx, float value)
-    : AttrObj(idx)
-{
-    set_float_value(value);
-}
-
-//---------------------------------------------------------------------------------------
-AttrVariant::AttrVariant(int idx, Color value)
-    : AttrObj(idx)
-{
-    set_color_value(value);
-}
-
 
 //=======================================================================================
 // AttrList implementation
 //=======================================================================================
-AttrList& AttrList::clone(const AttrList& a)
+AttrList& AttrList::operator= (const AttrList& a)
 {
-    if (a.m_first)
-        m_first = a.m_first->clone();
-    else
-        m_first = nullptr;
-
+    if (this != &a)
+    {
+        clear();
+        clone(a);
+    }
     return *this;
 }
 
 //---------------------------------------------------------------------------------------
-size_t AttrList::size()
+AttrList& AttrList::clone(const AttrList& a)
 {
-    AttrObj* pAttr = m_first;
-    size_t i = 0;
-    while (pAttr)
-    {
-        ++i;
-        pAttr = pAttr->get_next_attrib();
-    }
-
-    return i;
+    m_pAttrs = (a.m_pAttrs ? LOMSE_NEW std::vector<AttrObj>(*a.m_pAttrs) : nullptr);
+    return *this;
 }
 
 //---------------------------------------------------------------------------------------
 void AttrList::clear()
 {
-    delete m_first;
-    m_first = nullptr;
+    delete m_pAttrs;
+    m_pAttrs = nullptr;
 }
 
 //---------------------------------------------------------------------------------------
-AttrObj* AttrList::back()
+AttrObj* AttrList::push_back(const AttrObj& newAttr)
 {
-    AttrObj* pAttr = m_first;
-    AttrObj* pLast = pAttr;
-    while (pAttr)
-    {
-        pLast = pAttr;
-        pAttr = pAttr->get_next_attrib();
-    }
+    if (!m_pAttrs)
+        m_pAttrs = LOMSE_NEW std::vector<AttrObj>();
 
-    return pLast;
+    m_pAttrs->push_back(newAttr);
+    return &m_pAttrs->back();
 }
 
 //---------------------------------------------------------------------------------------
-AttrObj* AttrList::push_back(AttrObj* newAttr)
+void AttrList::remove(TIntAttribute idx)
 {
-    newAttr->set_next_attrib(nullptr);
-    AttrObj* pLast = back();
-    if (pLast)
+    if (!m_pAttrs)
+        return;
+
+    std::vector<AttrObj>::iterator it;
+    for (it = m_pAttrs->begin(); it != m_pAttrs->end(); ++it)
     {
-        pLast->set_next_attrib(newAttr);
-        newAttr->set_prev_attrib(pLast);
+        if (it->get_attrib_idx() == idx)
+        {
+            m_pAttrs->erase(it);
+            break;
+        }
     }
-    else
-        m_first = newAttr;
 
-    return newAttr;
+    if (m_pAttrs->empty())
+        clear();
 }
 
 //---------------------------------------------------------------------------------------
-void AttrList::remove(TIntAttribute idx)
+AttrObj* AttrList::find(TIntAttribute idx)
 {
-    AttrObj* pAttr = find(idx);
-    if (pAttr)
+    if (m_pAttrs)
     {
-        AttrObj* pPrev = pAttr->get_prev_attrib();
-        if (pPrev)
+        for (AttrObj& attr : *m_pAttrs)
         {
-            AttrObj* pNext = pAttr->get_next_attrib();
-            pPrev->set_next_attrib(pNext);
-            if (pNext)
-                pNext->set_prev_attrib(pPrev);
+            if (attr.get_attrib_idx() == idx)
+                return &attr;
         }
-
-        if (pAttr == m_first)
-            m_first = nullptr;
-
-        pAttr->set_next_attrib(nullptr);
-        delete pAttr;
     }
-}
-
-//---------------------------------------------------------------------------------------
-AttrObj* AttrList::find(TIntAttribute idx)
-{
-    AttrObj* pAttr = m_first;
-    while (pAttr && pAttr->get_attrib_idx() != idx)
-        pAttr = pAttr->get_next_attrib();
-
-    return pAttr;
+    return nullptr;
 }
 
 
@@ -447,14 +307,20 @@ void AttribValue::check_type(AttribType type) const
 //---------------------------------------------------------------------------------------
 AttribValue& AttribValue::clone(const AttribValue& a)
 {
+    if (this == &a)
+        return *this;
+
+    cleanup();
     switch (a.m_type)
     {
+        case vt_empty:                                      break;
         case vt_int:        intValue = a.intValue;          break;
-        case vt_string:     stringValue = a.stringValue;    break;
         case vt_bool:       boolValue = a.boolValue;        break;
         case vt_float:      floatValue = a.floatValue;      break;
         case vt_double:     doubleValue = a.doubleValue;    break;
-        case vt_color:      colorValue = a.colorValue;      break;
+        // placement new (http://en.cppreference.com/w/cpp/language/union)
+        case vt_string:     new (&stringValue) string(a.stringValue);   break;
+        case vt_color:      new (&colorValue) Color(a.colorValue);      break;
         default:
         {
             string msg("[AttribValue::clone]. Invalid type in source object");
@@ -462,6 +328,7 @@ AttribValue& AttribValue::clone(const AttribValue& a)
             throw std::runtime_error(msg);
         }
     }
+    m_type = a.m_type;
     return *this;
 }
 
@@ -641,6 +508,10 @@ ImoObj& ImoObj::clone(const ImoObj& a)
 void ImoObj::set_owner_model(DocModel* pDocModel)
 {
     m_pDocModel = pDocModel;
+
+    //new objects are created dirty
+    if (m_pDocModel && (m_flags & (k_dirty | k_children_dirty)) != 0)
+        m_pDocModel->on_dirty_marks_set(this);
 }
 
 //---------------------------------------------------------------------------------------
@@ -666,8 +537,8 @@ void ImoObj::set_xml_id(const std::string& value)
 //---------------------------------------------------------------------------------------
 const string& ImoObj::get_name(int type)
 {
-    //Register all IM objects
-    if (!m_fNamesRegistered)
+    //Register all IM objects. AWARE: initialization of a local static is thread safe
+    static const bool fRegistered = []()
     {
         // ImoStaffObj (A)
         m_TypeToName[k_imo_barline] = "barline";
@@ -844,8 +715,9 @@ const string& ImoObj::get_name(int type)
         m_TypeToName[k_imo_articulation_last] = "non-valid";
         m_TypeToName[k_imo_last] = "non-valid";
 
-        m_fNamesRegistered = true;
-    }
+        return true;
+    }();
+    (void)fRegistered;
 
 	map<int, std::string>::const_iterator it = m_TypeToName.find( type );
 	if (it != m_TypeToName.end())
@@ -1026,7 +898,7 @@ void ImoObj::set_dirty(bool dirty)
     //change status and propagate
     if (dirty)
     {
-        m_flags |= k_dirty;
+        add_dirty_flags(k_dirty);
         propagate_dirty();
     }
     else
@@ -1036,7 +908,21 @@ void ImoObj::set_dirty(bool dirty)
 //---------------------------------------------------------------------------------------
 void ImoObj::set_children_dirty(bool value)
 {
-    value ? m_flags |= k_children_dirty : m_flags &= ~k_children_dirty;
+    if (value)
+        add_dirty_flags(k_children_dirty);
+    else
+        m_flags &= ~k_children_dirty;
+}
+
+//---------------------------------------------------------------------------------------
+void ImoObj::add_dirty_flags(unsigned int flags)
+{
+    //the model records the objects with dirty marks, so that they can be cleared
+    //without traversing the whole tree
+    if (m_pDocModel && (m_flags & (k_dirty | k_children_dirty)) == 0)
+        m_pDocModel->on_dirty_marks_set(this);
+
+    m_flags |= flags;
 }
 
 //---------------------------------------------------------------------------------------
@@ -1158,25 +1044,7 @@ string ImoObj::get_string_attribute(TIntAttribute attrib)
 //---------------------------------------------------------------------------------------
 void ImoObj::set_color_attribute(TIntAttribute idx, Color value)
 {
-    AttrObj* pAttr = get_attribute(idx);
-    if (pAttr)
-    {
-        Attr< Color >* pT = dynamic_cast< Attr< Color >* >(pAttr);
-        if (pT)
-        {
-            pT->set_value(value);
-            return;
-        }
-
-        else
-        {
-            pAttr->replace_by( LOMSE_NEW Attr< Color >(idx, value) );
-            return;
-        }
-    }
-
-    add_attribute( LOMSE_NEW Attr< Color >(idx, value) );
-    set_dirty(true);
+    set_attribute< Color >(idx, value);
 }
 
 //---------------------------------------------------------------------------------------
@@ -4895,10 +4763,33 @@ ImoInstrument* ImoScore::add_instrument()
 //---------------------------------------------------------------------------------------
 void ImoScore::end_of_changes()
 {
+    Document* pDoc = get_the_document();
+    if (pDoc && pDoc->defer_end_of_changes(this))
+    {
+        m_fChangesDeferred = true;
+        return;
+    }
+
     ModelBuilder builder;
     builder.structurize(this);
 }
 
+//---------------------------------------------------------------------------------------
+void ImoScore::end_of_changes(ImoInstrument* pInstr, ImoStaffObj* pFirst,
+                              ImoStaffObj* pLast)
+{
+    //in a transaction, the score will be rebuilt when committing it
+    Document* pDoc = get_the_document();
+    if (pDoc && pDoc->defer_end_of_changes(this))
+    {
+        m_fChangesDeferred = true;
+        return;
+    }
+
+    ModelBuilder builder;
+    builder.update(this, pInstr, pFirst, pLast);
+}
+
 
 //=======================================================================================
 // ImoScoreLine implementation
@@ -6463,6 +6354,15 @@ ImoSlurData::ImoSlurData(ImoSlurDto* pDto)
 
 }
 
+//---------------------------------------------------------------------------------------
+ImoSlurData::ImoSlurData()
+    : ImoRelDataObj(k_imo_slur_data)
+    , m_fStart(false)
+    , m_slurNum(0)
+    , m_orientation(k_orientation_default)
+{
+}
+
 //---------------------------------------------------------------------------------------
 ImoBezierInfo* ImoSlurData::add_bezier()
 {
@@ -19,6 +19,7 @@
 #include "lomse_logger.h"
 #include "lomse_im_factory.h"
 #include "lomse_im_measures_table.h"
+#include "lomse_import_stats.h"
 
 #include <math.h>       //round
 
@@ -87,6 +88,7 @@ ImoDocument* ModelBuilder::build_model(ImoDocument* pImoDoc)
 {
     if (pImoDoc)
     {
+        ImportPhase phase(ImportStats::k_import_structurize);
         VisitorForStructurizables v(this);
         pImoDoc->accept_visitor(v);
     }
@@ -102,14 +104,21 @@ void ModelBuilder::structurize(ImoObj* pImo)
     {
         ImoScore* pScore = static_cast<ImoScore*>(pImo);
 
-        ColStaffObjsBuilder builder;
-        builder.build(pScore);
-
-        MeasuresTableBuilder measures;
-        measures.build(pScore);
-
-        MidiAssigner assigner;
-        assigner.assign_midi_data(pScore);
+        {
+            ImportPhase phase(ImportStats::k_import_staffobjs_table);
+            ColStaffObjsBuilder builder;
+            builder.build(pScore);
+        }
+        {
+            ImportPhase phase(ImportStats::k_import_measures_table);
+            MeasuresTableBuilder measures;
+            measures.build(pScore);
+        }
+        {
+            ImportPhase phase(ImportStats::k_import_midi);
+            MidiAssigner assigner;
+            assigner.assign_midi_data(pScore);
+        }
 
         PitchAssigner tuner;
         tuner.assign_pitch(pScore);
@@ -122,6 +131,45 @@ void ModelBuilder::structurize(ImoObj* pImo)
     }
 }
 
+//---------------------------------------------------------------------------------------
+void ModelBuilder::update(ImoScore* pScore, ImoInstrument* pInstr, ImoStaffObj* pFirst,
+                          ImoStaffObj* pLast)
+{
+    //Updates the score structures after modifying instrument pInstr in the measures
+    //from the one containing pFirst to the one containing pLast. When an incremental
+    //update is not possible the structures are rebuilt.
+
+    ColStaffObjsChanges changes;
+    ColStaffObjsBuilder builder;
+    if (!builder.update(pScore, pInstr, pFirst, pLast, &changes))
+    {
+        structurize(pScore);
+        return;
+    }
+
+    MeasuresTableBuilder measures;
+    if (!measures.update(pScore, changes))
+    {
+        MeasuresTableBuilder rebuilder;
+        rebuilder.build(pScore);
+    }
+
+    MidiAssigner assigner;
+    assigner.assign_midi_data(pScore);
+
+    PitchAssigner tuner;
+    tuner.assign_pitch(pScore, changes);
+
+    PartIdAssigner parts;
+    parts.assign_parts_id(pScore);
+
+    GroupBarlinesFixer fixer;
+    fixer.set_barline_layout_in_instruments(pScore);
+
+    //measures table no longer refers to the entries removed from the table
+    pScore->get_staffobjs_table()->delete_removed_entries();
+}
+
 //---------------------------------------------------------------------------------------
 ImoDocument* ModelBuilder::fix_cloned_model(ImoDocument* pImoDoc)
 {
@@ -204,6 +252,64 @@ void PitchAssigner::assign_pitch(ImoScore* pScore)
     }
 }
 
+//---------------------------------------------------------------------------------------
+void PitchAssigner::assign_pitch(ImoScore* pScore, const ColStaffObjsChanges& changes)
+{
+    //Pitch is only re-computed for the notes in the modified measures. If key
+    //signatures were modified, also for the notes up to next key signature.
+
+    if (pScore->get_accidentals_model() == ImoScore::k_pitch_and_notation_provided)
+        return;
+
+    ColStaffObjs* pTable = pScore->get_staffobjs_table();
+    int iInstr = changes.iInstr;
+    int numStaves = pScore->get_instrument(iInstr)->get_num_staves();
+    m_context.assign(numStaves, {{0,0,0,0,0,0,0}} );    //alterations, per staff
+
+    //determine the key signature in force
+    int iStart = (changes.pStartBarline ? changes.pStartBarline->index() : 0);
+    const StaffContextIndex::ChangePoint* pPoint =
+        pTable->get_context_index().find_before(StaffContextIndex::k_context_key,
+                                                iInstr, 0, iStart);
+    ImoKeySignature* pKey = (pPoint ? static_cast<ImoKeySignature*>(pPoint->pSO)
+                                    : nullptr);
+    for (int iStaff=0; iStaff < numStaves; ++iStaff)
+        reset_accidentals(pKey, iStaff);
+
+    bool fAfterEnd = false;
+    for (int i=iStart; i < pTable->num_entries(); ++i)
+    {
+        ColStaffObjsEntry* pEntry = pTable->entry_at(i);
+        if (pEntry->num_instrument() != iInstr)
+            continue;
+
+        ImoStaffObj* pSO = pEntry->imo_object();
+        if (pSO->is_note())
+        {
+            compute_pitch(static_cast<ImoNote*>(pSO), pEntry->staff());
+        }
+        else if (pSO->is_barline())
+        {
+            if (pEntry == changes.pEndBarline)
+            {
+                if (!changes.fKeysChanged)
+                    break;
+                fAfterEnd = true;
+            }
+            for (int iStaff=0; iStaff < numStaves; ++iStaff)
+                reset_accidentals(pKey, iStaff);
+        }
+        else if (pSO->is_key_signature())
+        {
+            if (fAfterEnd)
+                break;
+            pKey = static_cast<ImoKeySignature*>( pSO );
+            for (int iStaff=0; iStaff < numStaves; ++iStaff)
+                reset_accidentals(pKey, iStaff);
+        }
+    }
+}
+
 //---------------------------------------------------------------------------------------
 void PitchAssigner::compute_notated_accidentals(ImoNote* pNote, int context)
 {
@@ -752,43 +858,173 @@ void MeasuresTableBuilder::build(ImoScore* pScore)
     ColStaffObjsIterator it = pCSO->begin();
     while (it != pCSO->end())
     {
-        ColStaffObjsEntry* pCsoEntry = *it;
-        int iInstr = pCsoEntry->num_instrument();
-        ImoStaffObj* pSO = pCsoEntry->imo_object();
+        process_entry(pScore, *it);
+        ++it;
+    }
+}
 
-        //if first entry for the instrument create measures table and first measure
-        if (m_tables[iInstr] == nullptr)
-        {
-            ImoInstrument* pInstr = pScore->get_instrument(iInstr);
-            start_measures_table_for(iInstr, pInstr, pCsoEntry);
-        }
+//---------------------------------------------------------------------------------------
+bool MeasuresTableBuilder::update(ImoScore* pScore, const ColStaffObjsChanges& changes)
+{
+    //Updates the measures table of the instrument modified by an incremental update
+    //of the ColStaffObjs table. Measures before the changes are preserved, and
+    //measures after the changes are reused when possible. Returns false if the table
+    //must be rebuilt.
 
-        //start new measure if no current measure or current object is for next measure
-        if (m_curMeasure[iInstr] == nullptr
-            || pCsoEntry->measure() > m_curMeasure[iInstr]->get_start_entry()->measure())
-        {
-            start_new_measure(iInstr, pCsoEntry);
-        }
+    int iInstr = changes.iInstr;
+    ImoInstrument* pInstr = pScore->get_instrument(iInstr);
+    ImMeasuresTable* pTable = pInstr->get_measures_table();
+    if (!pTable)
+        return false;
 
-        //if Time Signature update beat duration
-        if (pSO->is_time_signature())
-        {
-            ImoTimeSignature* pTS = static_cast<ImoTimeSignature*>(pSO);
-            m_curMeasure[iInstr]->set_implied_beat_duration( pTS->get_beat_duration() );
-            m_curMeasure[iInstr]->set_bottom_ts_beat_duration( pTS->get_ref_note_duration() );
-        }
+    ColStaffObjs* pCSO = pScore->get_staffobjs_table();
+    m_tables.assign(pScore->get_num_instruments(), nullptr);
+    m_curMeasure.assign(pScore->get_num_instruments(), nullptr);
+    m_tables[iInstr] = pTable;
+    m_iLastEntry = changes.iLastEntry;
+
+    //measures after the last valid one will be re-created or reused
+    int iMeasure = find_last_valid_measure(pTable, changes);
+    pTable->detach_entries(iMeasure + 1, m_oldMeasures);
+    m_iOldMeasure = 0;
+    m_fSynchronized = false;
+
+    int i = (iMeasure >= 0 ? pTable->get_measure(iMeasure)->get_end_entry()->index() + 1
+                           : 0);
+    for (; i < pCSO->num_entries() && !m_fSynchronized; ++i)
+    {
+        ColStaffObjsEntry* pCsoEntry = pCSO->entry_at(i);
+        if (pCsoEntry->num_instrument() == iInstr)
+            process_entry(pScore, pCsoEntry);
+    }
+
+    //delete old measures not reused
+    for (size_t k=0; k < m_iOldMeasure; ++k)
+        delete m_oldMeasures[k];
+    if (!m_fSynchronized)
+    {
+        for (size_t k=m_iOldMeasure; k < m_oldMeasures.size(); ++k)
+            delete m_oldMeasures[k];
+    }
+    m_oldMeasures.clear();
 
-        //if not intermediate barline finish current measure
-        if (pSO->is_barline()
-            && pCsoEntry->measure() == m_curMeasure[iInstr]->get_start_entry()->measure())
+    return true;
+}
+
+//---------------------------------------------------------------------------------------
+int MeasuresTableBuilder::find_last_valid_measure(ImMeasuresTable* pTable,
+                                                  const ColStaffObjsChanges& changes)
+{
+    //Returns the index of the last measure not affected by the changes, or -1 if all
+    //measures are affected. The measure must end before the first modified entry and
+    //next measure must not start before the end of this one.
+
+    if (!changes.pStartBarline || pTable->num_entries() == 0)
+        return -1;
+
+    ImMeasuresTableEntry* pMeasure = pTable->get_measure_at(changes.pStartBarline->time());
+    int iMeasure = (pMeasure ? pMeasure->get_table_index() : pTable->num_entries() - 1);
+    for (; iMeasure >= 0; --iMeasure)
+    {
+        ColStaffObjsEntry* pEnd = pTable->get_measure(iMeasure)->get_end_entry();
+        if (!pEnd || pEnd->index() < 0 || pEnd->index() >= changes.iFirstEntry)
+            continue;
+
+        ImMeasuresTableEntry* pNext = pTable->get_measure(iMeasure + 1);
+        if (pNext)
         {
-            ImoBarline* pBL = static_cast<ImoBarline*>(pSO);
-            if (!pBL->is_middle())
-                finish_current_measure(iInstr, pCsoEntry);
+            int iNextStart = pNext->get_start_entry()->index();
+            if (iNextStart >= 0 && iNextStart < pEnd->index())
+                continue;
         }
+        return iMeasure;
+    }
+    return -1;
+}
 
-        //advance to next entry
-        ++it;
+//---------------------------------------------------------------------------------------
+bool MeasuresTableBuilder::reuse_old_measures(int iInstr, ColStaffObjsEntry* pStartEntry)
+{
+    //After the modified entries, when a new measure must be started and the old table
+    //had a measure starting at the same entry, the old measures from that one are
+    //still valid if they were created in the same conditions.
+
+    if (m_curMeasure[iInstr] != nullptr || pStartEntry->index() <= m_iLastEntry
+        || m_tables[iInstr]->num_entries() == 0)
+    {
+        return false;
+    }
+
+    while (m_iOldMeasure < m_oldMeasures.size())
+    {
+        ColStaffObjsEntry* pOldStart = m_oldMeasures[m_iOldMeasure]->get_start_entry();
+        if (pOldStart == pStartEntry)
+            break;
+        if (pOldStart->index() > pStartEntry->index())
+            return false;
+        ++m_iOldMeasure;
+    }
+    if (m_iOldMeasure == m_oldMeasures.size())
+        return false;
+
+    //previous measure must be finished before this one, and with the same beat
+    ImMeasuresTableEntry* pPrev = (m_iOldMeasure > 0 ? m_oldMeasures[m_iOldMeasure - 1]
+                                                     : m_tables[iInstr]->back());
+    ColStaffObjsEntry* pPrevEnd = pPrev->get_end_entry();
+    if (!pPrevEnd || (pPrevEnd->index() >= 0 && pPrevEnd->index() > pStartEntry->index()))
+        return false;
+
+    ImMeasuresTableEntry* pLast = m_tables[iInstr]->back();
+    if (!is_equal_time(pLast->get_implied_beat_duration(), pPrev->get_implied_beat_duration())
+        || !is_equal_time(pLast->get_bottom_ts_beat_duration(),
+                          pPrev->get_bottom_ts_beat_duration()) )
+    {
+        return false;
+    }
+
+    m_tables[iInstr]->append_entries(m_oldMeasures.begin() + m_iOldMeasure,
+                                     m_oldMeasures.end());
+    m_fSynchronized = true;
+    return true;
+}
+
+//---------------------------------------------------------------------------------------
+void MeasuresTableBuilder::process_entry(ImoScore* pScore, ColStaffObjsEntry* pCsoEntry)
+{
+    int iInstr = pCsoEntry->num_instrument();
+    ImoStaffObj* pSO = pCsoEntry->imo_object();
+
+    //if first entry for the instrument create measures table and first measure
+    if (m_tables[iInstr] == nullptr)
+    {
+        ImoInstrument* pInstr = pScore->get_instrument(iInstr);
+        start_measures_table_for(iInstr, pInstr, pCsoEntry);
+    }
+
+    //start new measure if no current measure or current object is for next measure
+    if (m_curMeasure[iInstr] == nullptr
+        || pCsoEntry->measure() > m_curMeasure[iInstr]->get_start_entry()->measure())
+    {
+        if (!m_oldMeasures.empty() && reuse_old_measures(iInstr, pCsoEntry))
+            return;
+        start_new_measure(iInstr, pCsoEntry);
+    }
+
+    //if Time Signature update beat duration
+    if (pSO->is_time_signature())
+    {
+        ImoTimeSignature* pTS = static_cast<ImoTimeSignature*>(pSO);
+        m_curMeasure[iInstr]->set_implied_beat_duration( pTS->get_beat_duration() );
+        m_curMeasure[iInstr]->set_bottom_ts_beat_duration( pTS->get_ref_note_duration() );
+    }
+
+    //if not intermediate barline finish current measure
+    if (pSO->is_barline()
+        && pCsoEntry->measure() == m_curMeasure[iInstr]->get_start_entry()->measure())
+    {
+        ImoBarline* pBL = static_cast<ImoBarline*>(pSO);
+        if (!pBL->is_middle())
+            finish_current_measure(iInstr, pCsoEntry);
     }
 }
 
@@ -822,7 +1058,8 @@ void MeasuresTableBuilder::finish_current_measure(int iInstr, ColStaffObjsEntry*
 //---------------------------------------------------------------------------------------
 void MeasuresTableBuilder::start_new_measure(int iInstr, ColStaffObjsEntry* pStartEntry)
 {
-    ImMeasuresTableEntry* prevMeasure = m_tables[iInstr]->back();
+    ImMeasuresTableEntry* prevMeasure = (m_tables[iInstr]->num_entries() > 0
+                                         ? m_tables[iInstr]->back() : nullptr);
     ImMeasuresTableEntry* pMeasure = m_tables[iInstr]->add_entry(pStartEntry);
 
     if (prevMeasure != nullptr)
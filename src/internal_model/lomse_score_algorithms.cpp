@@ -83,23 +83,19 @@ ImoNote* ScoreAlgorithms::find_possible_end_of_tie(ColStaffObjs* pColStaffObjs,
 ImoKeySignature* ScoreAlgorithms::get_applicable_key(ImoScore* pScore, ImoNote* pNote)
 {
     ColStaffObjs* pColStaffObjs = pScore->get_staffobjs_table();
-    ImoKeySignature* pKey = nullptr;
     ImoInstrument* pInstr = pNote->get_instrument();
     int iInstr = pScore->get_instr_number_for(pInstr);
     int iStaff = pNote->get_staff();
-    ColStaffObjsIterator it;
-    for (it=pColStaffObjs->begin(); it != pColStaffObjs->end(); ++it)
-    {
-        if ((*it)->imo_object() == static_cast<ImoObj*>(pNote))
-            break;
-        if ((*it)->num_instrument() == iInstr && (*it)->staff() == iStaff)
-        {
-            ImoObj* pImo = (*it)->imo_object();
-            if (pImo->is_key_signature())
-                pKey = static_cast<ImoKeySignature*>(pImo);
-        }
-    }
-    return pKey;
+
+    //when the note is not in the table, the last key signature in the staff
+    ColStaffObjsIterator it = pColStaffObjs->find(pNote);
+    int iEntry = (it != pColStaffObjs->end() ? (*it)->index()
+                                             : pColStaffObjs->num_entries());
+
+    const StaffContextIndex::ChangePoint* pPoint =
+        pColStaffObjs->get_context_index().find_before(StaffContextIndex::k_context_key,
+                                                       iInstr, iStaff, iEntry);
+    return (pPoint ? static_cast<ImoKeySignature*>(pPoint->pSO) : nullptr);
 }
 
 //---------------------------------------------------------------------------------------
@@ -107,20 +103,11 @@ int ScoreAlgorithms::get_applicable_clef_for(ImoScore* pScore,
                                              int iInstr, int iStaff, TimeUnits time)
 {
     ColStaffObjs* pColStaffObjs = pScore->get_staffobjs_table();
-    int clef = k_clef_undefined;
-    ColStaffObjsIterator it;
-    for (it=pColStaffObjs->begin(); it != pColStaffObjs->end(); ++it)
-    {
-        if (is_greater_time((*it)->time(), time))
-            break;
-        if ((*it)->num_instrument() == iInstr && (*it)->staff() == iStaff)
-        {
-            ImoObj* pImo = (*it)->imo_object();
-            if (pImo->is_clef())
-                clef = static_cast<ImoClef*>(pImo)->get_clef_type();
-        }
-    }
-    return clef;
+    const StaffContextIndex::ChangePoint* pPoint =
+        pColStaffObjs->get_context_index().find_at(StaffContextIndex::k_context_clef,
+                                                   iInstr, iStaff, time);
+    return (pPoint ? static_cast<ImoClef*>(pPoint->pSO)->get_clef_type()
+                   : k_clef_undefined);
 }
 
 //---------------------------------------------------------------------------------------
@@ -128,24 +115,9 @@ ImoNoteRest* ScoreAlgorithms::find_noterest_at(ImoScore* pScore,
                                                int instr, int voice, TimeUnits time)
 {
     ColStaffObjs* pColStaffObjs = pScore->get_staffobjs_table();
-    ColStaffObjsIterator it;
-    for (it=pColStaffObjs->begin(); it != pColStaffObjs->end(); ++it)
-    {
-        if (is_greater_time((*it)->time(), time))
-            break;
-        ImoObj* pImo = (*it)->imo_object();
-        if (pImo->is_note_rest())
-        {
-            ImoNoteRest* pNR = static_cast<ImoNoteRest*>(pImo);
-            if ((*it)->num_instrument() == instr)
-            {
-                if (pNR->get_voice() == voice
-                    && !is_greater_time(time, (*it)->time() + pNR->get_duration()) )
-                    return pNR;
-            }
-        }
-    }
-    return nullptr;
+    ColStaffObjsEntry* pEntry =
+        pColStaffObjs->get_noterests_index().find_at(instr, voice, time);
+    return (pEntry ? static_cast<ImoNoteRest*>(pEntry->imo_object()) : nullptr);
 }
 
 //---------------------------------------------------------------------------------------
@@ -154,67 +126,59 @@ list<OverlappedNoteRest*> ScoreAlgorithms::find_and_classify_overlapped_noterest
 {
     list<OverlappedNoteRest*> overlaps;
     ColStaffObjs* pColStaffObjs = pScore->get_staffobjs_table();
-    ColStaffObjsIterator it;
-    for (it=pColStaffObjs->begin(); it != pColStaffObjs->end(); ++it)
+
+    //note/rests starting before end of inserted one and ending after its start
+    vector<ColStaffObjsEntry*> found;
+    pColStaffObjs->get_noterests_index().find_overlapped(instr, voice, time,
+                                                         time + duration, found);
+    for (ColStaffObjsEntry* pEntry : found)
     {
-        ImoObj* pImo = (*it)->imo_object();
-        if (pImo->is_note_rest())
+        ImoNoteRest* pNR = static_cast<ImoNoteRest*>( pEntry->imo_object() );
+        TimeUnits nrTime = pEntry->time();
+        TimeUnits nrDuration = pNR->get_duration();
+
+        OverlappedNoteRest* pOV = LOMSE_NEW OverlappedNoteRest(pNR);
+        if (is_equal_time(nrTime, time))
         {
-            ImoNoteRest* pNR = static_cast<ImoNoteRest*>(pImo);
-            TimeUnits nrTime = (*it)->time();
-            TimeUnits nrDuration = pNR->get_duration();
-            if ((*it)->num_instrument() == instr
-                && pNR->get_voice() == voice
-                && is_greater_time(time + duration, nrTime)     //starts before end of inserted one
-                && is_lower_time(time, nrTime + nrDuration)     //ends after start of inserted one
-               )
+            //both start at same time
+            if (is_lower_time(duration, nrDuration))
             {
-                OverlappedNoteRest* pOV = LOMSE_NEW OverlappedNoteRest(pNR);
-                if (is_equal_time(nrTime, time))
-                {
-                    //both start at same time
-                    if (is_lower_time(duration, nrDuration))
-                    {
-                        //test 4
-                        pOV->type = k_overlap_at_start;
-                        pOV->overlap = duration;
-                    }
-                    else
-                    {
-                        //test 1
-                        pOV->type = k_overlap_full;
-                        pOV->overlap = nrDuration;
-                    }
-                }
-                else if (is_lower_time(time, nrTime))
-                {
-                    //starts after inserted one: overlap at_start or full
-                    pOV->overlap = duration - (nrTime - time);
-                    if (is_lower_time(pOV->overlap, nrDuration))
-                    {
-                        //test 5
-                        pOV->type = k_overlap_at_start;
-                    }
-                    else
-                    {
-                        //test 3
-                        pOV->type = k_overlap_full;
-                        pOV->overlap = nrDuration;
-                    }
-                }
-                else
-                {
-                    //starts before inserted one: overlap at_end
-                    //test 2, 3, 5
-                    pOV->overlap = nrDuration - (time - nrTime);
-                    pOV->type = k_overlap_at_end;
-                }
-
-                overlaps.push_back(pOV);
+                //test 4
+                pOV->type = k_overlap_at_start;
+                pOV->overlap = duration;
+            }
+            else
+            {
+                //test 1
+                pOV->type = k_overlap_full;
+                pOV->overlap = nrDuration;
             }
-            else if (is_lower_time(time + duration, nrTime))
-                break;
         }
+        else if (is_lower_time(time, nrTime))
+        {
+            //starts after inserted one: overlap at_start or full
+            pOV->overlap = duration - (nrTime - time);
+            if (is_lower_time(pOV->overlap, nrDuration))
+            {
+                //test 5
+                pOV->type = k_overlap_at_start;
+            }
+            else
+            {
+                //test 3
+                pOV->type = k_overlap_full;
+                pOV->overlap = nrDuration;
+            }
+        }
+        else
+        {
+            //starts before inserted one: overlap at_end
+            //test 2, 3, 5
+            pOV->overlap = nrDuration - (time - nrTime);
+            pOV->type = k_overlap_at_end;
+        }
+
+        overlaps.push_back(pOV);
     }
     return overlaps;
 }
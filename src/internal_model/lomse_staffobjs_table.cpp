@@ -19,6 +19,7 @@
 
 #include <sstream>
 #include <cmath>
+#include <climits>
 using namespace std;
 
 namespace lomse
@@ -173,12 +174,248 @@ std::string ColStaffObjsEntry::to_string_with_ids()
 
 
 
+
+//=======================================================================================
+// StaffContextIndex implementation
+//=======================================================================================
+void StaffContextIndex::clear()
+{
+    m_firstStaff.clear();
+    m_staves.clear();
+}
+
+//---------------------------------------------------------------------------------------
+void StaffContextIndex::build(ColStaffObjs* pTable)
+{
+    clear();
+
+    //determine the number of staves of each instrument
+    std::vector<int> numStaves;
+    for (ColStaffObjsIterator it=pTable->begin(); it != pTable->end(); ++it)
+    {
+        int iInstr = (*it)->num_instrument();
+        if (int(numStaves.size()) <= iInstr)
+            numStaves.resize(iInstr + 1, 0);
+        numStaves[iInstr] = max(numStaves[iInstr], (*it)->staff() + 1);
+    }
+
+    int total = 0;
+    m_firstStaff.reserve(numStaves.size());
+    for (int n : numStaves)
+    {
+        m_firstStaff.push_back(total);
+        total += n;
+    }
+    m_staves.resize(total);
+
+    //table entries are ordered by timepos. Therefore, change points are created
+    //ordered by timepos and by entry index
+    for (ColStaffObjsIterator it=pTable->begin(); it != pTable->end(); ++it)
+    {
+        ColStaffObjsEntry* pEntry = *it;
+        ImoStaffObj* pSO = pEntry->imo_object();
+        int context = k_context_max;
+        if (pSO->is_clef())
+            context = k_context_clef;
+        else if (pSO->is_key_signature())
+            context = k_context_key;
+        else if (pSO->is_time_signature())
+            context = k_context_time;
+        else if (pSO->is_note_rest() && pSO->get_num_relations() > 0)
+            add_octave_shift_points(pEntry);
+
+        if (context != k_context_max)
+        {
+            points_for(context, pEntry->num_instrument(), pEntry->staff())
+                .emplace_back(pEntry->ticks(), pEntry->index(), pSO, 0);
+        }
+    }
+
+    //an octave shift ends after its last note. When there are several voices, the
+    //end point could be after the start of a later octave shift
+    for (StaffPoints& points : m_staves)
+    {
+        std::vector<ChangePoint>& shifts = points[k_context_octave_shift];
+        std::stable_sort(shifts.begin(), shifts.end(),
+            [](const ChangePoint& a, const ChangePoint& b)
+            {
+                return a.time < b.time;
+            });
+    }
+}
+
+//---------------------------------------------------------------------------------------
+void StaffContextIndex::add_octave_shift_points(ColStaffObjsEntry* pEntry)
+{
+    ImoStaffObj* pSO = pEntry->imo_object();
+    std::vector<ChangePoint>& points =
+        points_for(k_context_octave_shift, pEntry->num_instrument(), pEntry->staff());
+
+    list<ImoRelObj*>& relobjs = pSO->get_relations()->get_relobjs();
+    for (ImoRelObj* pRO : relobjs)
+    {
+        if (!pRO->is_octave_shift())
+            continue;
+
+        if (pSO == pRO->get_start_object())
+        {
+            int steps = static_cast<ImoOctaveShift*>(pRO)->get_shift_steps();
+            points.emplace_back(pEntry->ticks(), pEntry->index(), pSO, steps);
+        }
+        if (pSO == pRO->get_end_object())
+        {
+            points.emplace_back(to_ticks(pEntry->time() + pSO->get_duration()),
+                                pEntry->index(), nullptr, 0);
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------
+std::vector<StaffContextIndex::ChangePoint>&
+StaffContextIndex::points_for(int context, int iInstr, int iStaff)
+{
+    return m_staves[m_firstStaff[iInstr] + iStaff][context];
+}
+
+//---------------------------------------------------------------------------------------
+const std::vector<StaffContextIndex::ChangePoint>*
+StaffContextIndex::get_points(int context, int iInstr, int iStaff) const
+{
+    if (context < 0 || context >= k_context_max
+        || iInstr < 0 || iInstr >= int(m_firstStaff.size()) || iStaff < 0)
+    {
+        return nullptr;
+    }
+
+    int idx = m_firstStaff[iInstr] + iStaff;
+    int end = (iInstr + 1 < int(m_firstStaff.size()) ? m_firstStaff[iInstr + 1]
+                                                     : int(m_staves.size()) );
+    return (idx < end ? &m_staves[idx][context] : nullptr);
+}
+
+//---------------------------------------------------------------------------------------
+const StaffContextIndex::ChangePoint* StaffContextIndex::find_at(int context,
+                                        int iInstr, int iStaff, TimeUnits time) const
+{
+    const std::vector<ChangePoint>* pPoints = get_points(context, iInstr, iStaff);
+    if (!pPoints)
+        return nullptr;
+
+    //first point with timepos greater than time
+    auto it = std::upper_bound(pPoints->begin(), pPoints->end(), to_ticks(time),
+        [](TimeTicks t, const ChangePoint& point)
+        {
+            return t < point.time;
+        });
+
+    return (it == pPoints->begin() ? nullptr : &(*(it - 1)));
+}
+
+//---------------------------------------------------------------------------------------
+const StaffContextIndex::ChangePoint* StaffContextIndex::find_before(int context,
+                                        int iInstr, int iStaff, int iEntry) const
+{
+    const std::vector<ChangePoint>* pPoints = get_points(context, iInstr, iStaff);
+    if (!pPoints)
+        return nullptr;
+
+    //first point created by entry iEntry or by a later one
+    auto it = std::lower_bound(pPoints->begin(), pPoints->end(), iEntry,
+        [](const ChangePoint& point, int i)
+        {
+            return point.index < i;
+        });
+
+    return (it == pPoints->begin() ? nullptr : &(*(it - 1)));
+}
+
+
+
+//=======================================================================================
+// NoteRestsIndex implementation
+//=======================================================================================
+void NoteRestsIndex::build(ColStaffObjs* pTable)
+{
+    clear();
+    for (ColStaffObjsIterator it=pTable->begin(); it != pTable->end(); ++it)
+    {
+        ColStaffObjsEntry* pEntry = *it;
+        ImoStaffObj* pSO = pEntry->imo_object();
+        if (!pSO->is_note_rest())
+            continue;
+
+        std::vector<Interval>& intervals =
+            m_voices[make_pair(pEntry->num_instrument(), pSO->get_voice())];
+        TimeTicks start = pEntry->ticks();
+        TimeTicks end = to_ticks(pEntry->time() + pSO->get_duration());
+        TimeTicks maxEnd = (intervals.empty() ? end : max(end, intervals.back().maxEnd));
+        intervals.emplace_back(start, end, maxEnd, pEntry);
+    }
+}
+
+//---------------------------------------------------------------------------------------
+const std::vector<NoteRestsIndex::Interval>* NoteRestsIndex::get_intervals(int iInstr,
+                                                                   int voice) const
+{
+    auto it = m_voices.find(make_pair(iInstr, voice));
+    return (it != m_voices.end() ? &(it->second) : nullptr);
+}
+
+//---------------------------------------------------------------------------------------
+ColStaffObjsEntry* NoteRestsIndex::find_at(int iInstr, int voice, TimeUnits time) const
+{
+    const std::vector<Interval>* pIntervals = get_intervals(iInstr, voice);
+    if (!pIntervals)
+        return nullptr;
+
+    //skip intervals ending before time
+    TimeTicks ticks = to_ticks(time);
+    auto it = std::partition_point(pIntervals->begin(), pIntervals->end(),
+        [ticks](const Interval& interval)
+        {
+            return interval.maxEnd < ticks;
+        });
+
+    for (; it != pIntervals->end() && it->start <= ticks; ++it)
+    {
+        if (it->end >= ticks)
+            return it->pEntry;
+    }
+    return nullptr;
+}
+
+//---------------------------------------------------------------------------------------
+void NoteRestsIndex::find_overlapped(int iInstr, int voice, TimeUnits startTime,
+                                     TimeUnits endTime,
+                                     std::vector<ColStaffObjsEntry*>& found) const
+{
+    const std::vector<Interval>* pIntervals = get_intervals(iInstr, voice);
+    if (!pIntervals)
+        return;
+
+    //skip intervals ending before or at startTime
+    TimeTicks startTicks = to_ticks(startTime);
+    TimeTicks endTicks = to_ticks(endTime);
+    auto it = std::partition_point(pIntervals->begin(), pIntervals->end(),
+        [startTicks](const Interval& interval)
+        {
+            return interval.maxEnd <= startTicks;
+        });
+
+    for (; it != pIntervals->end() && it->start < endTicks; ++it)
+    {
+        if (it->end > startTicks)
+            found.push_back(it->pEntry);
+    }
+}
+
+
+
 //=======================================================================================
 // ColStaffObjs implementation
 //=======================================================================================
 ColStaffObjs::ColStaffObjs()
     : m_numLines(0)
-    , m_numEntries(0)
     , m_rMissingTime(0.0)
     , m_rAnacrusisExtraTime(0.0)
     , m_minNoteDuration(LOMSE_NO_NOTE_DURATION)
@@ -186,27 +423,65 @@ ColStaffObjs::ColStaffObjs()
     , m_numQuarter(0)
     , m_numEighth(0)
     , m_num16th(0)
-    , m_pFirst(nullptr)
-    , m_pLast(nullptr)
+    , m_iFirstMoved(INT_MAX)
 {
 }
 
 //---------------------------------------------------------------------------------------
 ColStaffObjs::~ColStaffObjs()
 {
-    ColStaffObjs::iterator it;
-    for (it=begin(); it != end(); ++it)
-        delete *it;
+    for (ColStaffObjsEntry* pEntry : m_entries)
+        delete pEntry;
+    delete_removed_entries();
 }
 
 //---------------------------------------------------------------------------------------
 ColStaffObjsEntry* ColStaffObjs::add_entry(int measure, int instr, int voice, int staff,
                                            ImoStaffObj* pImo)
 {
-    ColStaffObjsEntry* pEntry =
-        LOMSE_NEW ColStaffObjsEntry(measure, instr, voice, staff, pImo);
+    ColStaffObjsEntry* pEntry = create_entry(measure, instr, voice, staff, pImo);
     add_entry_to_list(pEntry);
-    ++m_numEntries;
+    return pEntry;
+}
+
+//---------------------------------------------------------------------------------------
+const StaffContextIndex& ColStaffObjs::get_context_index()
+{
+    if (!m_fContextValid)
+        build_context_index();
+    return m_context;
+}
+
+//---------------------------------------------------------------------------------------
+const NoteRestsIndex& ColStaffObjs::get_noterests_index()
+{
+    if (!m_fNoteRestsValid)
+    {
+        m_noterests.build(this);
+        m_fNoteRestsValid = true;
+    }
+    return m_noterests;
+}
+
+//---------------------------------------------------------------------------------------
+void ColStaffObjs::build_context_index()
+{
+    m_context.build(this);
+    m_fContextValid = true;
+}
+
+//---------------------------------------------------------------------------------------
+ColStaffObjsEntry* ColStaffObjs::create_entry(int measure, int instr, int line,
+                                              int staff, ImoStaffObj* pImo)
+{
+    ColStaffObjsEntry* pEntry =
+                    LOMSE_NEW ColStaffObjsEntry(measure, instr, line, staff, pImo);
+    pEntry->m_pTable = this;
+
+    ImoId id = pImo->get_id();
+    if (id != k_no_imoid)
+        m_entryForId[id] = pEntry;
+
     return pEntry;
 }
 
@@ -245,42 +520,48 @@ string ColStaffObjs::dump(bool fWithIds)
 //---------------------------------------------------------------------------------------
 void ColStaffObjs::add_entry_to_list(ColStaffObjsEntry* pEntry)
 {
-    if (!m_pFirst)
+    //insert in order. Entries are ordered by time and the ordering rules only move an
+    //entry before others at the same time. Therefore, the search for the insertion
+    //point starts at the last entry with equal or lower time, found by binary search.
+    //Entries are normally created in order, so the table end is checked first.
+    invalidate_indexes();
+    TimeTicks ticks = pEntry->ticks();
+    int i = int(m_entries.size());
+    if (i > 0 && m_entries[i-1]->ticks() > ticks)
     {
-        //first entry
-        m_pFirst = pEntry;
-        m_pLast = pEntry;
-        pEntry->set_prev( nullptr );
-        pEntry->set_next( nullptr );
-        return;
+        auto it = std::partition_point(m_entries.begin(), m_entries.end(),
+            [ticks](ColStaffObjsEntry* pOther)
+            {
+                return pOther->ticks() <= ticks;
+            });
+        i = int(it - m_entries.begin());
     }
+    --i;
+    while (i >= 0 && is_lower_entry(pEntry, m_entries[i]))
+        --i;
+
+    //insert after entry i. Following entries are renumbered when needed
+    pEntry->m_index = i + 1;
+    m_entries.insert(m_entries.begin() + (i + 1), pEntry);
+    if (i + 2 < int(m_entries.size()))
+        entries_moved(i + 2);
+}
 
-    //insert in list in order
-    ColStaffObjsEntry* pCurrent = m_pLast;
-    while (pCurrent != nullptr)
-    {
-        if (is_lower_entry(pEntry, pCurrent))
-            pCurrent = pCurrent->get_prev();
-        else
-        {
-            //insert after pCurrent
-            ColStaffObjsEntry* pNext = pCurrent->get_next();
-            pEntry->set_prev( pCurrent );
-            pEntry->set_next( pNext );
-            pCurrent->set_next( pEntry );
-            if (pNext == nullptr)
-                m_pLast = pEntry;
-            else
-                pNext->set_prev( pEntry );
-            return;
-        }
-    }
+//---------------------------------------------------------------------------------------
+void ColStaffObjs::append_entry(ColStaffObjsEntry* pEntry)
+{
+    invalidate_indexes();
+    pEntry->m_index = int(m_entries.size());
+    m_entries.push_back(pEntry);
+}
 
-    //it is the first one
-    pEntry->set_prev( nullptr );
-    pEntry->set_next( m_pFirst );
-    m_pFirst->set_prev( pEntry );
-    m_pFirst = pEntry;
+//---------------------------------------------------------------------------------------
+void ColStaffObjs::renumber_entries()
+{
+    int numEntries = int(m_entries.size());
+    for (int i=m_iFirstMoved; i < numEntries; ++i)
+        m_entries[i]->m_index = i;
+    m_iFirstMoved = INT_MAX;
 }
 
 //---------------------------------------------------------------------------------------
@@ -299,11 +580,11 @@ bool ColStaffObjs::is_lower_entry(ColStaffObjsEntry* b, ColStaffObjsEntry* a)
     //R1. All staffobjs must be ordered by timepos
     {
         //R1.1 swap if B has lower time than A
-        if ( is_lower_time(b->time(), a->time()) )
+        if (b->ticks() < a->ticks())
             return true;    //B cannot go after A, Try with A-1
 
         //R1.2 time(pB) > time(pA). They are correctly ordered
-        if ( is_greater_time(b->time(), a->time()) )
+        if (b->ticks() > a->ticks())
             return false;   //insert B after A
     }
 
@@ -401,39 +682,77 @@ void ColStaffObjs::delete_entry_for(ImoStaffObj* pSO)
         throw runtime_error("[ColStaffObjs::delete_entry_for] entry not found!");
     }
 
-    ColStaffObjsEntry* pPrev = pEntry->get_prev();
-    ColStaffObjsEntry* pNext = pEntry->get_next();
-    delete pEntry;
-    if (pPrev == nullptr)
+    //key and time signatures have an entry for each staff. All of them are at the
+    //same timepos
+    TimeTicks ticks = pEntry->ticks();
+    int iFirst = pEntry->index();
+    while (iFirst > 0 && m_entries[iFirst-1]->ticks() == ticks)
+        --iFirst;
+    int iLast = iFirst;
+    int maxIndex = num_entries() - 1;
+    while (iLast < maxIndex && m_entries[iLast+1]->ticks() == ticks)
+        ++iLast;
+
+    int j = iFirst;
+    for (int i=iFirst; i <= iLast; ++i)
     {
-        //removing the head of the list
-        m_pFirst = pNext;
-        if (pNext)
-            pNext->set_prev(nullptr);
-    }
-    else if (pNext == nullptr)
-    {
-        //removing the tail of the list
-        m_pLast = pPrev;
-        pPrev->set_next(nullptr);
+        if (m_entries[i]->imo_object() == pSO)
+            release_entry(m_entries[i]);
+        else
+            m_entries[j++] = m_entries[i];
     }
-    else
+    m_entries.erase(m_entries.begin() + j, m_entries.begin() + (iLast + 1));
+    invalidate_indexes();
+    entries_moved(iFirst);
+
+    ImoId id = pSO->get_id();
+    if (id != k_no_imoid)
+        m_entryForId.erase(id);
+}
+
+//---------------------------------------------------------------------------------------
+void ColStaffObjs::release_entry(ColStaffObjsEntry* pEntry)
+{
+    pEntry->m_index = -1;
+    m_removedEntries.push_back(pEntry);
+}
+
+//---------------------------------------------------------------------------------------
+void ColStaffObjs::delete_removed_entries()
+{
+    for (ColStaffObjsEntry* pEntry : m_removedEntries)
+        delete pEntry;
+    m_removedEntries.clear();
+}
+
+//---------------------------------------------------------------------------------------
+ColStaffObjsEntry* ColStaffObjs::find_entry_for(ImoStaffObj* pSO)
+{
+    ColStaffObjsEntry* pEntry = find_entry_by_id(pSO);
+    if (pEntry)
+        return pEntry;
+
+    //objects without id, or id changed after creating the table
+    for (ColStaffObjsEntry* pEntry : m_entries)
     {
-        //removing intermediate node
-        pPrev->set_next( pNext );
-        pNext->set_prev( pPrev );
+        if (pEntry->imo_object() == pSO)
+            return pEntry;
     }
-    --m_numEntries;
+    return nullptr;
 }
 
 //---------------------------------------------------------------------------------------
-ColStaffObjsEntry* ColStaffObjs::find_entry_for(ImoStaffObj* pSO)
+ColStaffObjsEntry* ColStaffObjs::find_entry_by_id(ImoStaffObj* pSO)
 {
-    ColStaffObjs::iterator it;
-    for (it=begin(); it != end(); ++it)
+    ImoId id = pSO->get_id();
+    if (id != k_no_imoid)
     {
-        if ((*it)->imo_object() == pSO)
-            return *it;
+        auto it = m_entryForId.find(id);
+        if (it != m_entryForId.end() && it->second->imo_object() == pSO
+            && it->second->m_index >= 0)
+        {
+            return it->second;
+        }
     }
     return nullptr;
 }
@@ -448,23 +767,91 @@ void ColStaffObjs::sort_table()
     // * good performance when table is nearly ordered
     // * simple to implement and much better performance than other simple algorithms,
     //   such as the bubble sort
-    // * in-place sort (does not require extra memory)
 
-    ColStaffObjsEntry* pUnsorted = m_pFirst;
-    m_pFirst = nullptr;
-    m_pLast = nullptr;
+    std::vector<ColStaffObjsEntry*> unsorted;
+    unsorted.swap(m_entries);
+    m_entries.reserve(unsorted.size());
 
-    while (pUnsorted != nullptr)
+    for (ColStaffObjsEntry* pEntry : unsorted)
     {
-        ColStaffObjsEntry* pCurrent = pUnsorted;
+        pEntry->update_ticks();
+        add_entry_to_list(pEntry);
+    }
+}
 
-        //get next here, as insertion could change next element
-        pUnsorted = pUnsorted->get_next();
 
-        add_entry_to_list(pCurrent);
+//---------------------------------------------------------------------------------------
+void ColStaffObjs::replace_entries(int iFirst, int iLast,
+                                   std::vector<ColStaffObjsEntry*>& entries)
+{
+    //replace entries in range [iFirst, iLast] by the received ones
+    invalidate_indexes();
+    int numOld = iLast - iFirst + 1;
+    int numNew = int(entries.size());
+    int common = min(numOld, numNew);
+    for (int i=0; i < common; ++i)
+        m_entries[iFirst + i] = entries[i];
+
+    if (numNew > numOld)
+    {
+        m_entries.insert(m_entries.begin() + (iFirst + numOld),
+                         entries.begin() + numOld, entries.end());
+    }
+    else if (numNew < numOld)
+    {
+        m_entries.erase(m_entries.begin() + (iFirst + numNew),
+                        m_entries.begin() + (iLast + 1));
+    }
+
+    //when the number of entries does not change, only the replaced entries must be
+    //re-indexed
+    if (numNew == numOld)
+    {
+        for (int i=iFirst; i <= iLast; ++i)
+            m_entries[i]->m_index = i;
+    }
+    else
+    {
+        for (int i=iFirst; i < iFirst + numNew; ++i)
+            m_entries[i]->m_index = i;
+        entries_moved(iFirst + numNew);
     }
 }
 
+//---------------------------------------------------------------------------------------
+void ColStaffObjs::reset_noterests_info()
+{
+    m_numHalf = 0;
+    m_numQuarter = 0;
+    m_numEighth = 0;
+    m_num16th = 0;
+    m_minNoteDuration = LOMSE_NO_NOTE_DURATION;
+    m_rMissingTime = 0.0;
+    m_rAnacrusisExtraTime = 0.0;
+}
+
+//---------------------------------------------------------------------------------------
+void ColStaffObjs::save_line_usage(int instr, int voice, int staff, int line,
+                                   int measure)
+{
+    if (int(m_lineUsage.size()) <= instr)
+        m_lineUsage.resize(instr + 1);
+
+    //only the first use is saved
+    int order = int(m_lineUsage[instr].size());
+    m_lineUsage[instr].insert( make_pair(100*staff + voice,
+                                         LineUsage{line, measure, order}) );
+}
+
+//---------------------------------------------------------------------------------------
+ColStaffObjs::LineUsage* ColStaffObjs::get_line_usage(int instr, int voice, int staff)
+{
+    if (instr >= int(m_lineUsage.size()))
+        return nullptr;
+
+    auto it = m_lineUsage[instr].find(100*staff + voice);
+    return (it != m_lineUsage[instr].end() ? &(it->second) : nullptr);
+}
 
 
 //=======================================================================================
@@ -474,6 +861,7 @@ ColStaffObjs* ColStaffObjsBuilder::build(ImoScore* pScore)
 {
     ColStaffObjsBuilderEngine* builder = create_builder_engine(pScore);
     ColStaffObjs* pColStaffObjs = builder->do_build();
+    pColStaffObjs->build_context_index();
     pScore->set_staffobjs_table(pColStaffObjs);
 
     delete builder;
@@ -481,6 +869,32 @@ ColStaffObjs* ColStaffObjsBuilder::build(ImoScore* pScore)
     return pColStaffObjs;
 }
 
+//---------------------------------------------------------------------------------------
+bool ColStaffObjsBuilder::update(ImoScore* pScore, ImoInstrument* pInstr,
+                                 ImoStaffObj* pFirst, ImoStaffObj* pLast,
+                                 ColStaffObjsChanges* pChanges)
+{
+    //Updates the table after modifying instrument pInstr in the measures from the one
+    //containing pFirst to the one containing pLast. When pFirst is nullptr changes
+    //start in first measure, and when pLast is nullptr they continue up to the end.
+    //Returns false if the table can not be updated and must be rebuilt.
+
+    ColStaffObjs* pColStaffObjs = pScore->get_staffobjs_table();
+    if (!pColStaffObjs || !pColStaffObjs->is_updatable() || !pInstr)
+        return false;
+
+    ColStaffObjsBuilderEngine* builder = create_builder_engine(pScore);
+    bool fUpdated = builder->do_update(pScore->get_instr_number_for(pInstr), pFirst,
+                                       pLast, pChanges);
+    if (fUpdated)
+        pColStaffObjs->build_context_index();
+    else
+        builder->discard_new_entries();
+    delete builder;
+
+    return fUpdated;
+}
+
 //---------------------------------------------------------------------------------------
 ColStaffObjsBuilderEngine* ColStaffObjsBuilder::create_builder_engine(ImoScore* pScore)
 {
@@ -507,6 +921,16 @@ ColStaffObjsBuilderEngine::~ColStaffObjsBuilderEngine()
     delete m_pDivComputer;
 }
 
+//---------------------------------------------------------------------------------------
+void ColStaffObjsBuilderEngine::discard_new_entries()
+{
+    //entries created by an update that failed are not in the table, but the table
+    //owns them
+    for (ColStaffObjsEntry* pEntry : m_newEntries)
+        m_pColStaffObjs->release_entry(pEntry);
+    m_newEntries.clear();
+}
+
 //---------------------------------------------------------------------------------------
 ColStaffObjs* ColStaffObjsBuilderEngine::do_build()
 {
@@ -524,10 +948,16 @@ void ColStaffObjsBuilderEngine::create_table()
     int totalInstruments = m_pImScore->get_num_instruments();
     for (int instr = 0; instr < totalInstruments; instr++)
     {
+        m_nCurInstr = instr;
         create_entries_for_instrument(instr);
         prepare_for_next_instrument();
     }
 
+    //grace notes playback and anacrusis time depend on the whole table. Tables with
+    //grace notes can not be updated
+    if (!m_graces.empty())
+        m_pColStaffObjs->m_fUpdatable = false;
+
     //the table is created. Fix notes playback time and playback duration
     compute_grace_notes_playback_time();
     compute_arpeggiated_chords_playback_time();
@@ -614,10 +1044,64 @@ void ColStaffObjsBuilderEngine::collect_note_rest_info(ImoNoteRest* pNR)
     m_pDivComputer->add_note_rest(pNR);
 }
 
+//---------------------------------------------------------------------------------------
+bool ColStaffObjsBuilderEngine::do_update(int UNUSED(nInstr),
+                                          ImoStaffObj* UNUSED(pFirst),
+                                          ImoStaffObj* UNUSED(pLast),
+                                          ColStaffObjsChanges* UNUSED(pChanges))
+{
+    //by default, incremental updates are not supported
+    return false;
+}
+
 //---------------------------------------------------------------------------------------
 int ColStaffObjsBuilderEngine::get_line_for(int nVoice, int nStaff)
 {
-    return m_lines.get_line_assigned_to(nVoice, nStaff);
+    if (m_fUpdating)
+    {
+        //lines were assigned when the table was built. The first use of each
+        //combination in the modified measures is saved for checking later that lines
+        //assignment does not change
+        ColStaffObjs::LineUsage* pUsage =
+                        m_pColStaffObjs->get_line_usage(m_nCurInstr, nVoice, nStaff);
+        if (!pUsage)
+        {
+            m_fUpdateFailed = true;
+            return 0;
+        }
+
+        if (pUsage->firstMeasure >= m_nStartMeasure)
+        {
+            auto it = std::find_if(m_newLineUsage.begin(), m_newLineUsage.end(),
+                        [pUsage](const pair<ColStaffObjs::LineUsage*, int>& item)
+                        {
+                            return item.first == pUsage;
+                        });
+            if (it == m_newLineUsage.end())
+                m_newLineUsage.push_back( make_pair(pUsage, m_nCurMeasure) );
+        }
+        return pUsage->line;
+    }
+
+    int line = m_lines.get_line_assigned_to(nVoice, nStaff);
+    m_pColStaffObjs->save_line_usage(m_nCurInstr, nVoice, nStaff, line, m_nCurMeasure);
+    return line;
+}
+
+//---------------------------------------------------------------------------------------
+ColStaffObjsEntry* ColStaffObjsBuilderEngine::add_entry(int measure, int instr,
+                                                        int line, int staff,
+                                                        ImoStaffObj* pImo)
+{
+    if (m_fUpdating)
+    {
+        //new entries are merged with the table when all of them are created
+        ColStaffObjsEntry* pEntry = m_pColStaffObjs->create_entry(measure, instr, line,
+                                                                  staff, pImo);
+        m_newEntries.push_back(pEntry);
+        return pEntry;
+    }
+    return m_pColStaffObjs->add_entry(measure, instr, line, staff, pImo);
 }
 
 //---------------------------------------------------------------------------------------
@@ -644,14 +1128,14 @@ void ColStaffObjsBuilderEngine::add_entries_for_key_or_time_signature(ImoObj* pI
         for (int nStaff=0; nStaff < numStaves; nStaff++)
         {
             int nLine = get_line_for(0, nStaff);
-            m_pColStaffObjs->add_entry(m_nCurMeasure, nInstr, nLine, nStaff, pSO);
+            add_entry(m_nCurMeasure, nInstr, nLine, nStaff, pSO);
         }
     }
     else
     {
         //key signature, specific for one staff
         int nLine = get_line_for(0, staff);
-        m_pColStaffObjs->add_entry(m_nCurMeasure, nInstr, nLine, staff, pSO);
+        add_entry(m_nCurMeasure, nInstr, nLine, staff, pSO);
     }
 }
 
@@ -962,6 +1446,182 @@ void ColStaffObjsBuilderEngine::compute_divisions()
     m_pColStaffObjs->set_divisions( m_pDivComputer->compute_divisions() );
 }
 
+//---------------------------------------------------------------------------------------
+void ColStaffObjsBuilderEngine::update_table_info()
+{
+    //after an incremental update, noterests counters, min. note duration, anacrusis
+    //and divisions are recomputed by traversing the table. This is fast, as no entry
+    //is created or moved.
+
+    m_pColStaffObjs->reset_noterests_info();
+    delete m_pDivComputer;
+    m_pDivComputer = LOMSE_NEW DivisionsComputer();
+    m_minNoteDuration = LOMSE_NO_NOTE_DURATION;
+
+    for (ColStaffObjsEntry* pEntry : m_pColStaffObjs->m_entries)
+    {
+        ImoStaffObj* pSO = pEntry->imo_object();
+        if (pSO->is_note_rest() && !pSO->is_grace_note())
+        {
+            ImoNoteRest* pNR = static_cast<ImoNoteRest*>(pSO);
+            collect_note_rest_info(pNR);
+
+            TimeUnits duration = pNR->get_duration();
+            if (pNR->is_note())
+            {
+                ImoNote* pNote = static_cast<ImoNote*>(pNR);
+                if (pNote->is_in_chord() && !pNote->is_end_of_chord())
+                    duration = 0.0;
+            }
+            if (duration > 0.0)
+                m_minNoteDuration = min(m_minNoteDuration, duration);
+        }
+    }
+
+    collect_anacrusis_info();
+    set_min_note_duration();
+    compute_divisions();
+}
+
+//---------------------------------------------------------------------------------------
+bool ColStaffObjsBuilderEngine::update_line_usage(int lastMeasure)
+{
+    //Lines are assigned in the order in which each (voice, staff) combination is used
+    //for first time. Therefore, lines do not change if, in the modified measures, the
+    //combinations used for first time are the same and in the same order.
+    //Returns false if lines assignment would change.
+
+    std::vector<ColStaffObjs::LineUsage*> oldUsage;
+    for (auto& item : m_pColStaffObjs->m_lineUsage[m_nCurInstr])
+    {
+        ColStaffObjs::LineUsage& usage = item.second;
+        if (usage.firstMeasure >= m_nStartMeasure && usage.firstMeasure <= lastMeasure)
+            oldUsage.push_back(&usage);
+    }
+    std::sort(oldUsage.begin(), oldUsage.end(),
+              [](ColStaffObjs::LineUsage* a, ColStaffObjs::LineUsage* b)
+              {
+                  return a->order < b->order;
+              });
+
+    if (oldUsage.size() != m_newLineUsage.size())
+        return false;
+    for (size_t i=0; i < oldUsage.size(); ++i)
+    {
+        if (oldUsage[i] != m_newLineUsage[i].first)
+            return false;
+    }
+
+    //measure numbers could change
+    for (auto& item : m_newLineUsage)
+        item.first->firstMeasure = item.second;
+    return true;
+}
+
+//---------------------------------------------------------------------------------------
+int ColStaffObjsBuilderEngine::merge_new_entries(int iFirst, int iLast,
+                                                 int firstMeasure, int lastMeasure)
+{
+    //In table range [iFirst, iLast], the entries for current instrument in measures
+    //[firstMeasure, lastMeasure] are replaced by the new entries. Returns the number
+    //of entries in the range after the replacement.
+
+    std::vector<ColStaffObjsEntry*> entries;
+    entries.reserve(iLast - iFirst + 1 + int(m_newEntries.size()));
+    for (int i=iFirst; i <= iLast; ++i)
+    {
+        ColStaffObjsEntry* pEntry = m_pColStaffObjs->m_entries[i];
+        if (pEntry->num_instrument() == m_nCurInstr && pEntry->measure() >= firstMeasure
+            && pEntry->measure() <= lastMeasure)
+        {
+            m_pColStaffObjs->release_entry(pEntry);
+        }
+        else
+            entries.push_back(pEntry);
+    }
+    entries.insert(entries.end(), m_newEntries.begin(), m_newEntries.end());
+
+    //order by time and, at equal time, as if the table were built from scratch
+    std::stable_sort(entries.begin(), entries.end(),
+                     [](ColStaffObjsEntry* a, ColStaffObjsEntry* b)
+                     {
+                         return a->ticks() < b->ticks();
+                     });
+
+    size_t iStart = 0;
+    while (iStart < entries.size())
+    {
+        size_t iEnd = iStart + 1;
+        while (iEnd < entries.size()
+               && entries[iEnd]->ticks() == entries[iStart]->ticks())
+        {
+            ++iEnd;
+        }
+        if (iEnd - iStart > 1)
+            sort_entries_at_same_time(entries, iStart, iEnd);
+        iStart = iEnd;
+    }
+
+    m_pColStaffObjs->replace_entries(iFirst, iLast, entries);
+    return int(entries.size());
+}
+
+//---------------------------------------------------------------------------------------
+void ColStaffObjsBuilderEngine::sort_entries_at_same_time(
+                                        std::vector<ColStaffObjsEntry*>& entries,
+                                        size_t iStart, size_t iEnd)
+{
+    //When building the table, entries are added in definition order (by instrument
+    //and, in each instrument, by position in the music data) and each one is placed
+    //by applying the ordering rules, that only compare entries at the same timepos.
+    //Therefore, the same order is obtained by repeating the process for the entries
+    //in range [iStart, iEnd), all of them at the same timepos.
+
+    struct DefinitionOrder
+    {
+        ColStaffObjsEntry* pEntry;
+        int position;       //position in the measure
+    };
+    std::vector<DefinitionOrder> sorted;
+    sorted.reserve(iEnd - iStart);
+    for (size_t i=iStart; i < iEnd; ++i)
+    {
+        int position = 0;
+        ImoObj* pPrev = entries[i]->imo_object()->get_prev_sibling();
+        while (pPrev && !pPrev->is_barline())
+        {
+            ++position;
+            pPrev = pPrev->get_prev_sibling();
+        }
+        sorted.push_back({entries[i], position});
+    }
+
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const DefinitionOrder& a, const DefinitionOrder& b)
+                     {
+                         if (a.pEntry->num_instrument() != b.pEntry->num_instrument())
+                             return a.pEntry->num_instrument() < b.pEntry->num_instrument();
+                         if (a.pEntry->measure() != b.pEntry->measure())
+                             return a.pEntry->measure() < b.pEntry->measure();
+                         if (a.position != b.position)
+                             return a.position < b.position;
+                         return a.pEntry->staff() < b.pEntry->staff();
+                     });
+
+    //place each entry by applying the ordering rules
+    std::vector<ColStaffObjsEntry*> placed;
+    placed.reserve(iEnd - iStart);
+    for (const DefinitionOrder& item : sorted)
+    {
+        int i = int(placed.size()) - 1;
+        while (i >= 0 && ColStaffObjs::is_lower_entry(item.pEntry, placed[i]))
+            --i;
+        placed.insert(placed.begin() + (i + 1), item.pEntry);
+    }
+
+    std::copy(placed.begin(), placed.end(), entries.begin() + iStart);
+}
+
 //---------------------------------------------------------------------------------------
 string ColStaffObjsBuilderEngine::dump_divisions_data() const
 {
@@ -1152,6 +1812,7 @@ void ColStaffObjsBuilderEngine2x::initializations()
 {
     m_rCurTime.reserve(k_max_voices);
     m_pColStaffObjs = LOMSE_NEW ColStaffObjs();
+    m_pColStaffObjs->m_fUpdatable = true;
     m_curVoice = 0;
     m_prevVoice = 0;
 }
@@ -1172,26 +1833,171 @@ void ColStaffObjsBuilderEngine2x::create_entries_for_instrument(int nInstr)
     for(it = pMusicData->begin(); it != pMusicData->end(); ++it)
     {
 //        cout << "  processing MD object. pSO=" << (*it)->to_string() << endl;
-        if ((*it)->is_key_signature() || (*it)->is_time_signature())
+        process_staffobj(*it, nInstr);
+    }
+}
+
+//---------------------------------------------------------------------------------------
+void ColStaffObjsBuilderEngine2x::process_staffobj(ImoObj* pImo, int nInstr)
+{
+    if (pImo->is_key_signature() || pImo->is_time_signature())
+    {
+        if (m_pLastBarline)
+            m_pLastBarline->set_tk_change();
+        add_entries_for_key_or_time_signature(pImo, nInstr);
+        m_pLastBarline = nullptr;
+    }
+    else
+    {
+        ImoStaffObj* pSO = static_cast<ImoStaffObj*>(pImo);
+        add_entry_for_staffobj(pSO, nInstr);
+        m_pLastBarline = nullptr;
+
+        if (pSO->is_barline())
         {
-            if (m_pLastBarline)
-                m_pLastBarline->set_tk_change();
-            add_entries_for_key_or_time_signature(*it, nInstr);
-            m_pLastBarline = nullptr;
+            update_measure();
+            m_pLastBarline = static_cast<ImoBarline*>(pSO);
         }
-        else
+    }
+}
+
+//---------------------------------------------------------------------------------------
+bool ColStaffObjsBuilderEngine2x::do_update(int nInstr, ImoStaffObj* pFirst,
+                                            ImoStaffObj* pLast,
+                                            ColStaffObjsChanges* pChanges)
+{
+    //In LDP 2.x all time counters are synchronized at barlines. Therefore, entries are
+    //re-created starting after the barline previous to the changes, and the process
+    //stops when reaching a barline, after the changes, whose timepos and measure do
+    //not change, as objects after that barline are not affected.
+
+    m_pColStaffObjs = m_pImScore->get_staffobjs_table();
+    ImoInstrument* pInstr = m_pImScore->get_instrument(nInstr);
+    ImoMusicData* pMusicData = pInstr->get_musicdata();
+    if (!pMusicData)
+        return false;
+
+    //find the barline before the changes
+    ColStaffObjsEntry* pStartEntry = nullptr;
+    ImoObj* pStart = pFirst;
+    while (pStart)
+    {
+        if (pStart->is_barline())
         {
-            ImoStaffObj* pSO = static_cast<ImoStaffObj*>(*it);
-            add_entry_for_staffobj(pSO, nInstr);
-            m_pLastBarline = nullptr;
+            pStartEntry = m_pColStaffObjs->find_entry_by_id(
+                                                static_cast<ImoStaffObj*>(pStart) );
+            if (pStartEntry)
+                break;
+        }
+        pStart = pStart->get_prev_sibling();
+    }
+
+    m_nCurInstr = nInstr;
+    m_numStaves = pInstr->get_num_staves();
+    reset_counters();
+    m_pLastBarline = nullptr;
+    int iFirst = 0;
+    if (pStartEntry)
+    {
+        if (pStartEntry->num_instrument() != nInstr)
+            return false;
+
+        restart_after_barline(pStartEntry);
+
+        //first affected entry: first one at barline timepos
+        TimeTicks ticks = pStartEntry->ticks();
+        iFirst = pStartEntry->index();
+        while (iFirst > 0 && m_pColStaffObjs->m_entries[iFirst-1]->ticks() == ticks)
+        {
+            --iFirst;
+        }
+    }
+    m_nStartMeasure = m_nCurMeasure;
+
+    //create entries for the objects after the start barline
+    m_fUpdating = true;
+    bool fKeys = false;
+    bool fAfterLast = false;
+    ColStaffObjsEntry* pEndEntry = nullptr;
+    ImoObj* pImo = (pStart ? pStart->get_next_sibling() : pMusicData->get_first_child());
+    for (; pImo; pImo = pImo->get_next_sibling())
+    {
+        if (pImo == pLast)
+            fAfterLast = true;
 
-            if (pSO->is_barline())
+        ImoStaffObj* pSO = static_cast<ImoStaffObj*>(pImo);
+        fKeys |= pSO->is_key_signature();
+        if (fAfterLast && pSO->is_barline())
+        {
+            TimeUnits oldTime = pSO->get_time();
+            ColStaffObjsEntry* pOldEntry = m_pColStaffObjs->find_entry_by_id(pSO);
+            process_staffobj(pSO, nInstr);
+            if (m_fUpdateFailed)
+                return false;
+
+            if (pOldEntry && pOldEntry->measure() == m_nCurMeasure - 1
+                && is_equal_time(oldTime, pSO->get_time()))
             {
-                update_measure();
-                m_pLastBarline = static_cast<ImoBarline*>(pSO);
+                pEndEntry = pOldEntry;
+                break;
             }
         }
+        else
+        {
+            process_staffobj(pSO, nInstr);
+            if (m_fUpdateFailed)
+                return false;
+        }
+    }
+    m_fUpdating = false;
+
+    //grace notes and arpeggios require processing the whole table
+    if (!m_graces.empty() || !m_arpeggios.empty())
+        return false;
+
+    int lastMeasure = (pEndEntry ? pEndEntry->measure() : INT_MAX);
+    if (!update_line_usage(lastMeasure))
+        return false;
+
+    //last affected entry: last one at end barline timepos
+    int iLast = m_pColStaffObjs->num_entries() - 1;
+    if (pEndEntry)
+    {
+        TimeTicks ticks = pEndEntry->ticks();
+        int maxIndex = iLast;
+        iLast = pEndEntry->index();
+        while (iLast < maxIndex && m_pColStaffObjs->m_entries[iLast+1]->ticks() == ticks)
+        {
+            ++iLast;
+        }
     }
+
+    int numEntries = merge_new_entries(iFirst, iLast, m_nStartMeasure, lastMeasure);
+    update_table_info();
+
+    if (pChanges)
+    {
+        pChanges->iInstr = nInstr;
+        pChanges->iFirstEntry = iFirst;
+        pChanges->iLastEntry = iFirst + numEntries - 1;
+        pChanges->pStartBarline = pStartEntry;
+        pChanges->pEndBarline = (pEndEntry ? m_newEntries.back() : nullptr);
+        pChanges->fKeysChanged = fKeys;
+    }
+    return true;
+}
+
+//---------------------------------------------------------------------------------------
+void ColStaffObjsBuilderEngine2x::restart_after_barline(ColStaffObjsEntry* pEntry)
+{
+    //set counters as they are after processing the barline
+    TimeUnits time = pEntry->time();
+    m_nCurMeasure = pEntry->measure();
+    m_rMaxSegmentTime = time;
+    m_instrTime = time;
+    m_rStaffTime.assign(m_numStaves, time);
+    update_measure();
+    m_pLastBarline = static_cast<ImoBarline*>(pEntry->imo_object());
 }
 
 //---------------------------------------------------------------------------------------
@@ -1231,8 +2037,7 @@ void ColStaffObjsBuilderEngine2x::add_entry_for_staffobj(ImoObj* pImo, int nInst
         nVoice = m_curVoice;
 
     int nLine = get_line_for(nVoice, nStaff);
-    ColStaffObjsEntry* pEntry = m_pColStaffObjs->add_entry(m_nCurMeasure, nInstr,
-                                                           nLine, nStaff, pSO);
+    ColStaffObjsEntry* pEntry = add_entry(m_nCurMeasure, nInstr, nLine, nStaff, pSO);
 //    cout << "    add_entry_for_staffobj() pSO=" << pSO->to_string()
 //        << ", time=" << pSO->get_time()
 //        << ", get_line_for(nVoice=" << nVoice << ", nStaff=" << nStaff
@@ -0,0 +1,182 @@
+//---------------------------------------------------------------------------------------
+// This file is part of the Lomse library.
+// Copyright (c) 2010-present, Lomse Developers
+//
+// Licensed under the MIT license.
+//
+// See LICENSE and NOTICE.md files in the root directory of this source tree.
+//---------------------------------------------------------------------------------------
+
+#include "lomse_arena.h"
+
+#include "lomse_build_options.h"
+
+#include <cstdint>
+#include <new>
+
+namespace lomse
+{
+
+//=======================================================================================
+// Arena implementation
+//=======================================================================================
+Arena::Arena(size_t blockSize)
+    : m_blockSize(blockSize)
+    , m_pNext(nullptr)
+    , m_pEnd(nullptr)
+    , m_usedBytes(0)
+{
+}
+
+//---------------------------------------------------------------------------------------
+Arena::~Arena()
+{
+    clear();
+}
+
+//---------------------------------------------------------------------------------------
+void* Arena::allocate(size_t size, size_t align)
+{
+    uintptr_t pos = reinterpret_cast<uintptr_t>(m_pNext);
+    uintptr_t aligned = (pos + align - 1) & ~(uintptr_t(align) - 1);
+    if (m_pNext == nullptr || aligned + size > reinterpret_cast<uintptr_t>(m_pEnd))
+        return allocate_in_new_block(size, align);
+
+    m_pNext = reinterpret_cast<char*>(aligned + size);
+    m_usedBytes += size;
+    return reinterpret_cast<void*>(aligned);
+}
+
+//---------------------------------------------------------------------------------------
+void* Arena::allocate_in_new_block(size_t size, size_t align)
+{
+    //big objects get a block for them alone
+    size_t blockSize = (size + align > m_blockSize ? size + align : m_blockSize);
+    char* pBlock = LOMSE_NEW char[blockSize];
+    m_blocks.push_back(pBlock);
+    m_pNext = pBlock;
+    m_pEnd = pBlock + blockSize;
+    return allocate(size, align);
+}
+
+//---------------------------------------------------------------------------------------
+void Arena::clear()
+{
+    std::vector<Destructor>::reverse_iterator it;
+    for (it = m_destructors.rbegin(); it != m_destructors.rend(); ++it)
+        (*it).destroy((*it).pObj);
+    m_destructors.clear();
+
+    std::vector<char*>::iterator itB;
+    for (itB = m_blocks.begin(); itB != m_blocks.end(); ++itB)
+        delete[] *itB;
+    m_blocks.clear();
+
+    m_pNext = nullptr;
+    m_pEnd = nullptr;
+    m_usedBytes = 0;
+}
+
+
+//the pool for allocating nodes in each thread
+static thread_local NodePool* s_pCurrentPool = nullptr;
+
+
+//=======================================================================================
+// NodePool implementation
+//=======================================================================================
+NodePool::NodePool()
+    : m_arena(64 * 1024)
+    , m_liveNodes(0)
+    , m_fOwned(true)
+{
+    for (int i=0; i < k_num_classes; ++i)
+        m_freeLists[i] = nullptr;
+}
+
+//---------------------------------------------------------------------------------------
+void NodePool::release()
+{
+    m_fOwned = false;
+    if (m_liveNodes == 0)
+        delete this;
+}
+
+//---------------------------------------------------------------------------------------
+NodePool* NodePool::current()
+{
+    return s_pCurrentPool;
+}
+
+//---------------------------------------------------------------------------------------
+void NodePool::set_current(NodePool* pPool)
+{
+    s_pCurrentPool = pPool;
+}
+
+//---------------------------------------------------------------------------------------
+void* NodePool::allocate_node(size_t size)
+{
+    Header* pHeader;
+    if (s_pCurrentPool && size <= k_max_node_size)
+    {
+        pHeader = s_pCurrentPool->allocate((size + k_granularity - 1) / k_granularity - 1);
+    }
+    else
+    {
+        pHeader = static_cast<Header*>( ::operator new(sizeof(Header) + size) );
+        pHeader->pPool = nullptr;
+        pHeader->sizeClass = 0;
+    }
+    return pHeader + 1;
+}
+
+//---------------------------------------------------------------------------------------
+void NodePool::deallocate_node(void* p)
+{
+    if (!p)
+        return;
+
+    Header* pHeader = static_cast<Header*>(p) - 1;
+    if (pHeader->pPool)
+        pHeader->pPool->deallocate(pHeader);
+    else
+        ::operator delete(pHeader);
+}
+
+//---------------------------------------------------------------------------------------
+NodePool::Header* NodePool::allocate(size_t sizeClass)
+{
+    Header* pHeader;
+    FreeNode* pFree = m_freeLists[sizeClass];
+    if (pFree)
+    {
+        m_freeLists[sizeClass] = pFree->pNext;
+        pHeader = reinterpret_cast<Header*>(pFree);
+    }
+    else
+    {
+        size_t size = sizeof(Header) + (sizeClass + 1) * k_granularity;
+        pHeader = static_cast<Header*>( m_arena.allocate(size, alignof(Header)) );
+    }
+
+    pHeader->pPool = this;
+    pHeader->sizeClass = sizeClass;
+    ++m_liveNodes;
+    return pHeader;
+}
+
+//---------------------------------------------------------------------------------------
+void NodePool::deallocate(Header* pHeader)
+{
+    FreeNode* pFree = reinterpret_cast<FreeNode*>(pHeader);
+    size_t sizeClass = pHeader->sizeClass;
+    pFree->pNext = m_freeLists[sizeClass];
+    m_freeLists[sizeClass] = pFree;
+
+    if (--m_liveNodes == 0 && !m_fOwned)
+        delete this;
+}
+
+
+}  //namespace lomse
@@ -22,6 +22,7 @@
 #include "lomse_compressed_mxl_compiler.h"
 #include "lomse_mnx_analyser.h"
 #include "lomse_mnx_compiler.h"
+#include "lomse_im_snapshot.h"
 #include "lomse_model_builder.h"
 #include "private/lomse_document_p.h"
 #include "lomse_font_storage.h"
@@ -40,6 +41,7 @@
 #include "lomse_caret_positioner.h"
 #include "lomse_glyphs.h"
 #include "lomse_engraving_options.h"
+#include "lomse_workers_pool.h"
 
 #if (LOMSE_ENABLE_THREADS == 1)
     #include "lomse_score_player.h"
@@ -52,6 +54,23 @@ namespace lomse
 {
 
 
+//---------------------------------------------------------------------------------------
+// ScopeLock: helper for serializing the lazy instantiation of LibraryScope objects
+class ScopeLock
+{
+#if (LOMSE_ENABLE_THREADS == 1)
+protected:
+    std::lock_guard<std::mutex> m_lock;
+
+public:
+    explicit ScopeLock(LibraryScope* pScope) : m_lock(pScope->m_mutex) {}
+#else
+public:
+    explicit ScopeLock(LibraryScope* UNUSED(pScope)) {}
+#endif
+};
+
+
 //=======================================================================================
 // LibraryScope implementation
 //=======================================================================================
@@ -71,6 +90,9 @@ LibraryScope::LibraryScope(ostream& reporter, LomseDoorway* pDoorway)
     , m_pMusicGlyphs(nullptr)      //lazzy instantiation. Singleton scope.
     , m_fReplaceLocalMetronome(false)
     , m_importOptions()
+    , m_fParallelEngraving(false)
+    , m_numEngravingThreads(0)
+    , m_fSampleImportMemory(false)
     , m_fJustifySystems(true)
     , m_fDumpColumnTables(false)
     , m_fDrawAnchorObjects(false)
@@ -98,6 +120,9 @@ LibraryScope::LibraryScope(ostream& reporter, LomseDoorway* pDoorway)
 //---------------------------------------------------------------------------------------
 LibraryScope::~LibraryScope()
 {
+#if (LOMSE_ENABLE_THREADS == 1)
+    delete m_pWorkersPool;
+#endif
     delete m_pLdpFactory;
     delete m_pFontStorage;
     delete m_pFontSelector;
@@ -113,6 +138,7 @@ LibraryScope::~LibraryScope()
 //---------------------------------------------------------------------------------------
 LdpFactory* LibraryScope::ldp_factory()
 {
+    ScopeLock lock(this);
     if (!m_pLdpFactory)
         m_pLdpFactory = LOMSE_NEW LdpFactory();
     return m_pLdpFactory;
@@ -121,6 +147,7 @@ LdpFactory* LibraryScope::ldp_factory()
 //---------------------------------------------------------------------------------------
 FontStorage* LibraryScope::font_storage()
 {
+    ScopeLock lock(this);
     if (!m_pFontStorage)
         m_pFontStorage = LOMSE_NEW FontStorage(this);
     return m_pFontStorage;
@@ -129,14 +156,27 @@ FontStorage* LibraryScope::font_storage()
 //---------------------------------------------------------------------------------------
 FontSelector* LibraryScope::get_font_selector()
 {
+    ScopeLock lock(this);
     if (!m_pFontSelector)
         m_pFontSelector = LOMSE_NEW FontSelector(this);
     return m_pFontSelector;
 }
 
+//---------------------------------------------------------------------------------------
+#if (LOMSE_ENABLE_THREADS == 1)
+WorkersPool* LibraryScope::get_workers_pool()
+{
+    ScopeLock lock(this);
+    if (!m_pWorkersPool)
+        m_pWorkersPool = LOMSE_NEW WorkersPool();
+    return m_pWorkersPool;
+}
+#endif
+
 //---------------------------------------------------------------------------------------
 MusicGlyphs* LibraryScope::get_glyphs_table()
 {
+    ScopeLock lock(this);
     if (!m_pMusicGlyphs)
         m_pMusicGlyphs = LOMSE_NEW MusicGlyphs(this);
     return m_pMusicGlyphs;
@@ -172,6 +212,7 @@ bool LibraryScope::is_music_font_smufl_compliant()
 //---------------------------------------------------------------------------------------
 EventsDispatcher* LibraryScope::get_events_dispatcher()
 {
+    ScopeLock lock(this);
     if (!m_pDispatcher)
     {
         m_pDispatcher = LOMSE_NEW EventsDispatcher();
@@ -348,6 +389,13 @@ MnxCompiler* Injector::inject_MnxCompiler(LibraryScope& libraryScope,
                                  pDoc );
 }
 
+//---------------------------------------------------------------------------------------
+SnapshotCompiler* Injector::inject_SnapshotCompiler(LibraryScope& UNUSED(libraryScope),
+                                                    Document* pDoc)
+{
+    return LOMSE_NEW SnapshotCompiler(pDoc, pDoc->get_scope().default_reporter());
+}
+
 //---------------------------------------------------------------------------------------
 ModelBuilder* Injector::inject_ModelBuilder(DocumentScope& UNUSED(documentScope))
 {
@@ -10,6 +10,7 @@
 #include "lomse_logger.h"
 
 #include <algorithm> // min
+#include <sstream>
 #include <stdarg.h> // va_start, va_end
 using namespace std;
 
@@ -129,8 +130,14 @@ void Logger::log_message(const string& file, int line, const string& prettyFunct
     size_t fileStartWindows = file.rfind("\\") + 1;
     size_t fileStart = max(fileStartLinux, fileStartWindows);
 
-    (*m_logStream) << file.substr(fileStart) << ", line " << line << ". " << prefix << "["
-            << prettyFunction.substr(begin,end) << "] " << msg << endl;
+    stringstream ss;
+    ss << file.substr(fileStart) << ", line " << line << ". " << prefix << "["
+       << prettyFunction.substr(begin,end) << "] " << msg << endl;
+
+#if (LOMSE_ENABLE_THREADS == 1)
+    std::lock_guard<std::mutex> lock(m_mutex);
+#endif
+    (*m_logStream) << ss.str() << flush;
 }
 
 //---------------------------------------------------------------------------------------
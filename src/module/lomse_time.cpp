@@ -11,6 +11,7 @@
 #include "lomse_time.h"
 
 #include <cmath>
+#include <climits>
 #include <chrono>
 #include <sstream>
 #include <time.h>
@@ -39,6 +40,24 @@ bool is_greater_time(TimeUnits t1, TimeUnits t2)
     return (t1 > t2) && (fabs(t1 - t2) >= 0.1);
 }
 
+//---------------------------------------------------------------------------------------
+TimeTicks to_ticks(TimeUnits time)
+{
+    //LOMSE_NO_TIME and other out of range values are saturated
+    const TimeUnits maxTime = TimeUnits(LLONG_MAX / LOMSE_TICKS_PER_TIME_UNIT);
+    if (time >= maxTime)
+        return LLONG_MAX;
+    if (time <= -maxTime)
+        return -LLONG_MAX;
+    return llround(time * TimeUnits(LOMSE_TICKS_PER_TIME_UNIT));
+}
+
+//---------------------------------------------------------------------------------------
+TimeUnits to_time_units(TimeTicks ticks)
+{
+    return TimeUnits(ticks) / TimeUnits(LOMSE_TICKS_PER_TIME_UNIT);
+}
+
 //---------------------------------------------------------------------------------------
 //global function for implementing round-half-up rounding algorithm
 TimeUnits round_half_up(TimeUnits num)
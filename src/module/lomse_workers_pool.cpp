@@ -0,0 +1,90 @@
+//---------------------------------------------------------------------------------------
+// This file is part of the Lomse library.
+// Copyright (c) 2010-present, Lomse Developers
+//
+// Licensed under the MIT license.
+//
+// See LICENSE and NOTICE.md files in the root directory of this source tree.
+//---------------------------------------------------------------------------------------
+
+#include "lomse_workers_pool.h"
+
+#if (LOMSE_ENABLE_THREADS == 1)
+
+namespace lomse
+{
+
+//=======================================================================================
+// WorkersPool implementation
+//=======================================================================================
+WorkersPool::~WorkersPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_fStop = true;
+    }
+    m_cvStart.notify_all();
+
+    for (std::thread& t : m_threads)
+        t.join();
+}
+
+//---------------------------------------------------------------------------------------
+void WorkersPool::run(int numWorkers, const std::function<void()>& task)
+{
+    std::unique_lock<std::mutex> runLock(m_runMutex, std::try_to_lock);
+    if (numWorkers <= 1 || !runLock.owns_lock())
+    {
+        task();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        add_threads(numWorkers - 1);
+        m_pTask = &task;
+        m_numSeats = numWorkers - 1;
+        m_numPending = numWorkers - 1;
+    }
+    m_cvStart.notify_all();
+
+    task();     //the calling thread is also a worker
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cvDone.wait(lock, [this]{ return m_numPending == 0; });
+    m_pTask = nullptr;
+}
+
+//---------------------------------------------------------------------------------------
+void WorkersPool::add_threads(int numThreads)
+{
+    //AWARE: m_mutex must be locked
+    while (int(m_threads.size()) < numThreads)
+        m_threads.push_back( std::thread(&WorkersPool::worker_loop, this) );
+}
+
+//---------------------------------------------------------------------------------------
+void WorkersPool::worker_loop()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+        m_cvStart.wait(lock, [this]{ return m_fStop || m_numSeats > 0; });
+        if (m_fStop)
+            return;
+
+        --m_numSeats;
+        const std::function<void()>* pTask = m_pTask;
+        lock.unlock();
+        (*pTask)();
+        lock.lock();
+
+        if (--m_numPending == 0)
+            m_cvDone.notify_one();
+    }
+}
+
+
+}   //namespace lomse
+
+#endif  //LOMSE_ENABLE_THREADS
@@ -61,6 +61,7 @@ Interactor::Interactor(LibraryScope& libraryScope, WpDocument wpDoc, View* pView
     , m_wpDoc(wpDoc)
     , m_pView(pView)
     , m_pGraphicModel(nullptr)
+    , m_pPrevGraphicModel(nullptr)
     , m_pTask(nullptr)
     , m_pCursor(nullptr)
     , m_pSelections(nullptr)
@@ -147,13 +148,21 @@ void Interactor::create_graphic_model()
             LUnits width = pView->get_viewport_width();
             DocLayouter layouter(pDoc, m_libScope, constrains, width);
 
-            if (pView->is_valid_for_this_view(pDoc))
-                layouter.layout_document();
-            else
+            if (!pView->is_valid_for_this_view(pDoc))
                 layouter.layout_empty_document();
+            else if (m_pPrevGraphicModel)
+            {
+                //the layouter takes ownership of the previous model
+                layouter.update_document(m_pPrevGraphicModel);
+                m_pPrevGraphicModel = nullptr;
+            }
+            else
+                layouter.layout_document();
 
             m_pGraphicModel = layouter.get_graphic_model();
             m_pGraphicModel->build_main_boxes_table();
+            spDoc->clear_dirty_marks();
+            m_pGraphicModel->set_dirty_marks_ref( spDoc->get_dirty_marks_ref() );
             m_pSelections->graphic_model_changed(m_pGraphicModel);
         }
         spDoc->clear_dirty();
@@ -181,7 +190,7 @@ bool Interactor::graphic_model_must_be_updated()
 void Interactor::on_document_updated()
 {
     LOMSE_LOG_DEBUG(Logger::k_mvc, "[Interactor::on_document_updated]");
-    delete_graphic_model();
+    discard_graphic_model();
     create_graphic_model();
     //TODO: Interactor::on_document_updated. Update cursor
     //DocCursor cursor(m_pDoc);
@@ -194,7 +203,7 @@ void Interactor::handle_event(SpEventInfo pEvent)
     switch(pEvent->get_event_type())
     {
         case k_doc_modified_event:
-            delete_graphic_model();
+            discard_graphic_model();
             restore_selection();
             force_redraw();
             break;
@@ -229,8 +238,33 @@ void Interactor::handle_event(SpEventInfo pEvent)
 //---------------------------------------------------------------------------------------
 void Interactor::delete_graphic_model()
 {
+    delete m_pPrevGraphicModel;
+    m_pPrevGraphicModel = nullptr;
+
     delete m_pGraphicModel;
     m_pGraphicModel = nullptr;
+    remove_graphic_model_references();
+}
+
+//---------------------------------------------------------------------------------------
+void Interactor::discard_graphic_model()
+{
+    //The document has been modified and the GModel is no longer valid. But it is
+    //saved so that, when creating the new GModel, the layouter could reuse the
+    //parts not affected by the changes.
+
+    if (m_pGraphicModel)
+    {
+        delete m_pPrevGraphicModel;
+        m_pPrevGraphicModel = m_pGraphicModel;
+        m_pGraphicModel = nullptr;
+    }
+    remove_graphic_model_references();
+}
+
+//---------------------------------------------------------------------------------------
+void Interactor::remove_graphic_model_references()
+{
     m_pSelections->graphic_model_changed(nullptr);
 
     GraphicView* pGView = dynamic_cast<GraphicView*>(m_pView);
@@ -967,7 +1001,7 @@ void Interactor::redraw_bitmap()
     if (SpDocument spDoc = m_wpDoc.lock())
     {
         if (spDoc->is_dirty())
-            delete_graphic_model();
+            discard_graphic_model();
 
         GraphicView* pGView = dynamic_cast<GraphicView*>(m_pView);
         if (pGView)
@@ -53,6 +53,8 @@ public:
             return Document::k_format_mxl_compressed;
         else if (ext == "mnx")
             return Document::k_format_mnx;
+        else if (ext == "lmsnap")
+            return Document::k_format_snapshot;
         else
             return Document::k_format_unknown;
     }
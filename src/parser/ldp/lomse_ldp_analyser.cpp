@@ -8,6 +8,7 @@
 //---------------------------------------------------------------------------------------
 
 #include "lomse_ldp_analyser.h"
+#include "lomse_import_stats.h"
 
 #include <iostream>
 #include <sstream>
@@ -6638,6 +6639,7 @@ ImoObj* LdpAnalyser::analyse_tree_and_get_object(LdpTree* tree)
 //---------------------------------------------------------------------------------------
 ImoObj* LdpAnalyser::analyse_tree(LdpTree* tree, const string& locator)
 {
+    ImportPhase phase(ImportStats::k_import_analyse);
     m_fileLocator = locator;
     return analyse_tree_and_get_object(tree);
 }
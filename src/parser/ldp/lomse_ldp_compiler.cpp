@@ -37,6 +37,9 @@ LdpCompiler::LdpCompiler(LibraryScope& libraryScope, Document* pDoc)
     m_pModelBuilder = Injector::inject_ModelBuilder(pDoc->get_scope());
     m_pDoc = pDoc;
     m_fileLocator = "";
+
+    //the parsed tree is discarded after analysis: allocate it in an arena
+    m_pLdpParser->use_arena(true);
 }
 
 //---------------------------------------------------------------------------------------
@@ -46,6 +49,8 @@ LdpCompiler::LdpCompiler(LdpParser* p, LdpAnalyser* a, ModelBuilder* mb, Documen
     , m_pLdpParser(p)
     , m_pLdpAnalyser(a)
 {
+    //the parsed tree is discarded after analysis: allocate it in an arena
+    m_pLdpParser->use_arena(true);
 }
 
 //---------------------------------------------------------------------------------------
@@ -108,10 +113,20 @@ ImoDocument* LdpCompiler::compile_parsed_tree(LdpTree* tree)
     ImoDocument* pRoot = dynamic_cast<ImoDocument*>(
                                 m_pLdpAnalyser->analyse_tree(tree, m_fileLocator));
     m_pModelBuilder->build_model(pRoot);
-    delete tree->get_root();
+    delete_parsed_tree(tree);
     return pRoot;
 }
 
+//---------------------------------------------------------------------------------------
+void LdpCompiler::delete_parsed_tree(LdpTree* tree)
+{
+    //elements allocated in the parser arena are released in one go
+    if (tree->get_root()->is_in_arena())
+        m_pLdpParser->free_arena();
+    else
+        delete tree->get_root();
+}
+
 //---------------------------------------------------------------------------------------
 LdpTree* LdpCompiler::wrap_score_in_lenmusdoc(LdpTree* pParseTree)
 {
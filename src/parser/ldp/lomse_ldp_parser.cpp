@@ -10,9 +10,11 @@
 #include "lomse_ldp_parser.h"
 
 #include <algorithm>
+#include <cstring>
 #include <iostream>
 #include "lomse_ldp_factory.h"
 #include "lomse_logger.h"
+#include "lomse_import_stats.h"
 
 using namespace std;
 
@@ -34,6 +36,8 @@ LdpParser::LdpParser(ostream& reporter, LdpFactory* pFactory)
     , m_pTk(nullptr)
     , m_state(A0_WaitingForStartOfElement)
     , m_curNode(nullptr)
+    , m_pArena(nullptr)
+    , m_fUseArena(false)
 {
 }
 
@@ -41,6 +45,25 @@ LdpParser::LdpParser(ostream& reporter, LdpFactory* pFactory)
 LdpParser::~LdpParser()
 {
     clear_all();
+    delete m_pArena;
+}
+
+//---------------------------------------------------------------------------------------
+void LdpParser::use_arena(bool value)
+{
+    m_fUseArena = value;
+    if (!value)
+    {
+        delete m_pArena;
+        m_pArena = nullptr;
+    }
+}
+
+//---------------------------------------------------------------------------------------
+void LdpParser::free_arena()
+{
+    if (m_pArena)
+        m_pArena->clear();
 }
 
 //---------------------------------------------------------------------------------------
@@ -52,7 +75,8 @@ void LdpParser::clear_all()
     while (!m_stack.empty())
     {
         std::pair<EParsingState, LdpElement*> data = m_stack.top();
-        delete data.second;
+        if (data.second && !data.second->is_in_arena())
+            delete data.second;
         m_stack.pop();
     }
     m_curNode = nullptr;
@@ -71,13 +95,14 @@ void LdpParser::parse_text(const std::string& sourceText)
 //---------------------------------------------------------------------------------------
 void LdpParser::parse_file(const std::string& filename, bool UNUSED(fErrorMsg))
 {
-    LdpFileReader reader(filename);
+    LdpMappedFileReader reader(filename);
     parse_input(reader);
 }
 
 //---------------------------------------------------------------------------------------
 void LdpParser::parse_input(LdpReader& reader)
 {
+    ImportPhase phase(ImportStats::k_import_parse);
     do_syntax_analysis(reader);
 }
 
@@ -105,6 +130,9 @@ void LdpParser::do_syntax_analysis(LdpReader& reader)
 
     clear_all();
 
+    if (m_fUseArena && !m_pArena)
+        m_pArena = LOMSE_NEW Arena();
+
     delete m_pTokenizer;
     m_pTokenizer = LOMSE_NEW LdpTokenizer(reader, m_reporter);
     m_pTokenizer->skip_utf_bom();
@@ -186,24 +214,24 @@ void LdpParser::Do_WaitingForName()
         case tkLabel:
         {
             //check if the name has an ID and extract it
-            const std::string& tagname = m_pTk->get_value();
-            std::string nodename = tagname;
-            size_t i = tagname.find('#');
+            const char* tagname = m_pTk->get_value_data();
+            size_t size = m_pTk->get_value_size();
+            const char* pSharp = static_cast<const char*>( memchr(tagname, '#', size) );
+            std::string nodename(tagname, pSharp ? size_t(pSharp - tagname) : size);
             ImoId id = k_no_imoid;
-            if (i != string::npos)
+            if (pSharp)
             {
-                nodename = tagname.substr(0, i);
-                std::istringstream sid( tagname.substr(i+1) );
+                std::istringstream sid( std::string(pSharp + 1, tagname + size) );
                 if (!(sid >> id))
                 {
                     m_reporter << "Line " << m_pTk->get_line_number()
-                               << ". Bad id in name '" + tagname + "'." << endl;
+                               << ". Bad id in name '" + m_pTk->get_value() + "'." << endl;
                     id = k_no_imoid;
                 }
             }
 
             //create the node
-            m_curNode = m_pLdpFactory->create(nodename, m_pTk->get_line_number());
+            m_curNode = m_pLdpFactory->create(nodename, m_pTk->get_line_number(), m_pArena);
             if (m_curNode->get_type() == k_undefined)
                 m_reporter << "Line " << m_pTk->get_line_number()
                            << ". Unknown tag '" + nodename + "'." << endl;
@@ -232,24 +260,30 @@ void LdpParser::Do_ProcessingParameter()
             //                                                  m_pTk->get_line_number()) );
             //m_state = A3_ProcessingParameter;
             //break;
-            if ( must_replace_tag(m_pTk->get_value()) )
+            if ( must_replace_tag(m_pTk) )
                 replace_current_tag();
             else
             {
-                m_curNode->append_child( m_pLdpFactory->new_label(m_pTk->get_value(),
-                                                                  m_pTk->get_line_number()) );
+                m_curNode->append_child( m_pLdpFactory->new_label(m_pTk->get_value_data(),
+                                                                  m_pTk->get_value_size(),
+                                                                  m_pTk->get_line_number(),
+                                                                  m_pArena) );
                 m_state = A3_ProcessingParameter;
             }
             break;
         case tkIntegerNumber:
         case tkRealNumber:
-            m_curNode->append_child( m_pLdpFactory->new_number(m_pTk->get_value(),
-                                                               m_pTk->get_line_number()) );
+            m_curNode->append_child( m_pLdpFactory->new_number(m_pTk->get_value_data(),
+                                                               m_pTk->get_value_size(),
+                                                               m_pTk->get_line_number(),
+                                                               m_pArena) );
             m_state = A3_ProcessingParameter;
             break;
         case tkString:
-            m_curNode->append_child( m_pLdpFactory->new_string(m_pTk->get_value(),
-                                                               m_pTk->get_line_number()) );
+            m_curNode->append_child( m_pLdpFactory->new_string(m_pTk->get_value_data(),
+                                                               m_pTk->get_value_size(),
+                                                               m_pTk->get_line_number(),
+                                                               m_pArena) );
             m_state = A3_ProcessingParameter;
             break;
         case tkStartOfElement:
@@ -271,9 +305,9 @@ void LdpParser::Do_ProcessingParameter()
 }
 
 //---------------------------------------------------------------------------------------
-bool LdpParser::must_replace_tag(const std::string& nodename)
+bool LdpParser::must_replace_tag(LdpToken* pTk)
 {
-    return nodename == "noVisible";
+    return pTk->value_is("noVisible");
 }
 
 //---------------------------------------------------------------------------------------
@@ -292,11 +326,11 @@ void LdpParser::replace_current_tag()
     //    newname = "tied";
 
     //create the replacement node
-    m_curNode = m_pLdpFactory->create(newname, m_pTk->get_line_number());
+    m_curNode = m_pLdpFactory->create(newname, m_pTk->get_line_number(), m_pArena);
 
     //add parameter
-    m_curNode->append_child( m_pLdpFactory->new_label("no",
-                                                      m_pTk->get_line_number()) );
+    m_curNode->append_child( m_pLdpFactory->new_label("no", 2, m_pTk->get_line_number(),
+                                                      m_pArena) );
 
     //close node
     terminate_current_parameter();
@@ -8,6 +8,7 @@
 //---------------------------------------------------------------------------------------
 
 #include "lomse_lmd_analyser.h"
+#include "lomse_import_stats.h"
 #include "lomse_xml_parser.h"
 
 #include <iostream>
@@ -5568,7 +5569,7 @@ bool LmdElementAnalyser::get_optional(const string& name)
     if (more_children_to_analyse())
     {
         m_childToAnalyse = get_child_to_analyse();
-        if (m_childToAnalyse.name() == name)
+        if (m_childToAnalyse.has_name(name))
         {
             move_to_next_child();
             return true;
@@ -5777,35 +5778,6 @@ LmdAnalyser::LmdAnalyser(ostream& reporter, LibraryScope& libraryScope, Document
     , m_nShowTupletNumber(k_yesno_default)
     , m_pLastNote(nullptr)
 {
-    m_NameToTag["clef"] = k_tag_clef;
-    m_NameToTag["content"] = k_tag_content;
-    m_NameToTag["color"] = k_tag_color;
-    m_NameToTag["defineStyle"] = k_tag_defineStyle;
-    m_NameToTag["dynamic"] = k_tag_dynamic;
-    m_NameToTag["group"] = k_tag_group;
-    m_NameToTag["image"] = k_tag_image;
-    m_NameToTag["instrument"] = k_tag_instrument;
-    m_NameToTag["itemizedlist"] = k_tag_itemizedlist;
-    m_NameToTag["ldpmusic"] = k_tag_ldpmusic;
-    m_NameToTag["lenmusdoc"] = k_tag_lenmusdoc;
-    m_NameToTag["link"] = k_tag_link;
-    m_NameToTag["listitem"] = k_tag_listitem;
-    m_NameToTag["musicData"] = k_tag_musicData;
-    m_NameToTag["orderedlist"] = k_tag_orderedlist;
-    m_NameToTag["para"] = k_tag_para;
-    m_NameToTag["param"] = k_tag_param;
-    m_NameToTag["parts"] = k_tag_parts;
-    m_NameToTag["score"] = k_tag_score;
-    m_NameToTag["scorePlayer"] = k_tag_scorePlayer;
-    m_NameToTag["section"] = k_tag_section;
-    m_NameToTag["styles"] = k_tag_styles;
-    m_NameToTag["table"] = k_tag_table;
-    m_NameToTag["tableCell"] = k_tag_tableCell;
-    m_NameToTag["tableColumn"] = k_tag_tableColumn;
-    m_NameToTag["tableBody"] = k_tag_tableBody;
-    m_NameToTag["tableHead"] = k_tag_tableHead;
-    m_NameToTag["tableRow"] = k_tag_tableRow;
-    m_NameToTag["txt"] = k_tag_txt;
 }
 
 //---------------------------------------------------------------------------------------
@@ -5846,6 +5818,7 @@ ImoObj* LmdAnalyser::analyse_tree_and_get_object(XmlNode* root)
 //---------------------------------------------------------------------------------------
 ImoObj* LmdAnalyser::analyse_tree(XmlNode* tree, const string& locator)
 {
+    ImportPhase phase(ImportStats::k_import_analyse);
     m_fileLocator = locator;
     return analyse_tree_and_get_object(tree);
 }
@@ -5859,7 +5832,7 @@ int LmdAnalyser::get_line_number(XmlNode* node)
 //---------------------------------------------------------------------------------------
 ImoObj* LmdAnalyser::analyse_node(XmlNode* pNode, ImoObj* pAnchor)
 {
-    LmdElementAnalyser* a = new_analyser( pNode->name(), pAnchor );
+    LmdElementAnalyser* a = new_analyser( pNode->name_cstr(), pAnchor );
     ImoObj* pImo = a->analyse_node(pNode);
     delete a;
     return pImo;
@@ -6171,7 +6144,7 @@ EAccidentals LmdAnalyser::to_accidentals(const std::string& accidentals)
 }
 
 //---------------------------------------------------------------------------------------
-LmdElementAnalyser* LmdAnalyser::new_analyser(const string& name, ImoObj* pAnchor)
+LmdElementAnalyser* LmdAnalyser::new_analyser(const char* name, ImoObj* pAnchor)
 {
     //Factory method to create analysers
 
@@ -6257,13 +6230,53 @@ LmdElementAnalyser* LmdAnalyser::new_analyser(const string& name, ImoObj* pAncho
 }
 
 //---------------------------------------------------------------------------------------
-int LmdAnalyser::name_to_tag(const string& name) const
+// conversion from LMD element name to ELdpElement
+static const XmlTagsTable::Entry k_lmd_tags[] =
+{
+    { "clef",            k_tag_clef },
+    { "content",         k_tag_content },
+    { "color",           k_tag_color },
+    { "defineStyle",     k_tag_defineStyle },
+    { "dynamic",         k_tag_dynamic },
+    { "group",           k_tag_group },
+    { "image",           k_tag_image },
+    { "instrument",      k_tag_instrument },
+    { "itemizedlist",    k_tag_itemizedlist },
+    { "ldpmusic",        k_tag_ldpmusic },
+    { "lenmusdoc",       k_tag_lenmusdoc },
+    { "link",            k_tag_link },
+    { "listitem",        k_tag_listitem },
+    { "musicData",       k_tag_musicData },
+    { "orderedlist",     k_tag_orderedlist },
+    { "para",            k_tag_para },
+    { "param",           k_tag_param },
+    { "parts",           k_tag_parts },
+    { "score",           k_tag_score },
+    { "scorePlayer",     k_tag_scorePlayer },
+    { "section",         k_tag_section },
+    { "styles",          k_tag_styles },
+    { "table",           k_tag_table },
+    { "tableCell",       k_tag_tableCell },
+    { "tableColumn",     k_tag_tableColumn },
+    { "tableBody",       k_tag_tableBody },
+    { "tableHead",       k_tag_tableHead },
+    { "tableRow",        k_tag_tableRow },
+    { "txt",             k_tag_txt },
+};
+
+//---------------------------------------------------------------------------------------
+const XmlTagsTable& LmdAnalyser::get_tags_table()
 {
-	map<string, int>::const_iterator it = m_NameToTag.find(name);
-	if (it != m_NameToTag.end())
-		return it->second;
-    else
-        return k_tag_undefined;
+    //hints: seed and size found by XmlTagsTable. Update them when modifying the names
+    static const XmlTagsTable table(k_lmd_tags, sizeof(k_lmd_tags) / sizeof(k_lmd_tags[0]),
+                                    k_tag_undefined, 66u, 128);
+    return table;
+}
+
+//---------------------------------------------------------------------------------------
+int LmdAnalyser::name_to_tag(const char* name) const
+{
+    return get_tags_table().get_tag(name);
 }
 
 
@@ -34,6 +34,13 @@ Compiler::~Compiler()
     delete m_pModelBuilder;
 }
 
+//---------------------------------------------------------------------------------------
+ImoDocument* Compiler::compile_buffer(const void* buffer, size_t size)
+{
+    //default implementation for compilers without specific support for buffers
+    return compile_string( std::string(static_cast<const char*>(buffer), size) );
+}
+
 //---------------------------------------------------------------------------------------
 int Compiler::get_num_errors() const
 {
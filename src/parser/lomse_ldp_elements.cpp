@@ -25,6 +25,7 @@ LdpElement::LdpElement()
     , m_numLine(0)
     , m_id(k_no_imoid)
     , m_pImo(nullptr)
+    , m_fInArena(false)
     //, m_fProcessed(false)
 {
 }
@@ -32,6 +33,10 @@ LdpElement::LdpElement()
 //---------------------------------------------------------------------------------------
 LdpElement::~LdpElement()
 {
+    //children in an arena are destroyed by the arena
+    if (m_fInArena)
+        return;
+
     TreeNode<LdpElement>::children_iterator it(this);
     it = begin();
     while (it != end())
@@ -24,6 +24,7 @@ public:
 	LdpFunctor() {}
 	virtual ~LdpFunctor() {}
     virtual LdpElement* operator ()() = 0;
+    virtual LdpElement* operator ()(Arena& arena) = 0;
 };
 
 
@@ -32,6 +33,9 @@ class LdpElementFunctor : public LdpFunctor
 {
 public:
 	LdpElement* operator ()() override {  return LdpObject<type>::new_ldp_object(); }
+	LdpElement* operator ()(Arena& arena) override {
+        return LdpObject<type>::new_ldp_object(arena);
+    }
 };
 
 
@@ -464,31 +468,31 @@ LdpFactory::~LdpFactory()
         delete it->second;
 }
 
-LdpElement* LdpFactory::create(const std::string& name, int numLine) const
+LdpElement* LdpFactory::create(const std::string& name, int numLine, Arena* pArena) const
 {
 	map<std::string, LdpFunctor*>::const_iterator it
         = m_NameToFunctor.find(name);
 	if (it != m_NameToFunctor.end())
     {
 		LdpFunctor* f = it->second;
-		LdpElement* element = (*f)();
+		LdpElement* element = (pArena ? (*f)(*pArena) : (*f)());
 		element->set_name(name);
         element->set_num_line(numLine);
 		return element;
 	}
     else
     {
-        LdpElement* element = create(k_undefined, numLine);
+        LdpElement* element = create(k_undefined, numLine, pArena);
 		//element->set_name(name);
         return element;
     }
 }
 
-LdpElement* LdpFactory::create(ELdpElement type, int numLine) const
+LdpElement* LdpFactory::create(ELdpElement type, int numLine, Arena* pArena) const
 {
 	map<ELdpElement, std::string>::const_iterator it = m_TypeToName.find( type );
 	if (it != m_TypeToName.end())
-		return create(it->second, numLine);
+		return create(it->second, numLine, pArena);
 
     std::stringstream err;
     err << "[LdpFactory::create] invoked with unknown type \""
@@ -10,12 +10,25 @@
 #include "lomse_reader.h"
 
 #include "lomse_file_system.h"
+#include "lomse_logger.h"
+#include "lomse_import_stats.h"
 
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
+#include <vector>
 using namespace std;
 
+#if (LOMSE_PLATFORM_UNIX == 1 || LOMSE_PLATFORM_APPLE == 1)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+    #define LOMSE_USE_MMAP  1
+#else
+    #define LOMSE_USE_MMAP  0
+#endif
+
 
 namespace lomse
 {
@@ -70,37 +83,95 @@ bool LdpFileReader::end_of_data()
 
 
 //=======================================================================================
-// LdpTextReader implementation
+// LdpMappedFileReader implementation
 //=======================================================================================
-
-LdpTextReader::LdpTextReader(const std::string& sourceText)
-    : LdpReader()
-    , m_stream(sourceText)
+LdpMappedFileReader::LdpMappedFileReader(const std::string& filelocator)
+    : LdpBufferedReader()
+    , m_locator(filelocator)
+    , m_pMapped(nullptr)
+    , m_mappedSize(0)
 {
+    ImportPhase phase(ImportStats::k_import_read);
+    DocLocator loc(filelocator);
+    if (!(loc.get_protocol() == DocLocator::k_file
+          && loc.get_inner_protocol() == DocLocator::k_none
+          && map_file(loc.get_path()) ))
+    {
+        load_file();
+    }
 }
 
 //---------------------------------------------------------------------------------------
-char LdpTextReader::get_next_char()
+LdpMappedFileReader::~LdpMappedFileReader()
 {
-    return m_stream.get();
+#if (LOMSE_USE_MMAP == 1)
+    if (m_pMapped)
+        munmap(m_pMapped, m_mappedSize);
+#endif
 }
 
 //---------------------------------------------------------------------------------------
-void LdpTextReader::repeat_last_char()
+bool LdpMappedFileReader::map_file(const std::string& filename)
 {
-    m_stream.unget();
+#if (LOMSE_USE_MMAP == 1)
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd == -1)
+        return false;
+
+    struct stat info;
+    if (fstat(fd, &info) == -1 || !S_ISREG(info.st_mode) || info.st_size == 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    size_t size = static_cast<size_t>(info.st_size);
+    void* pData = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (pData == MAP_FAILED)
+        return false;
+
+    madvise(pData, size, MADV_SEQUENTIAL);
+    m_pMapped = pData;
+    m_mappedSize = size;
+    m_buffer.set_data(static_cast<const char*>(pData), size, true);
+    return true;
+#else
+    return false;
+#endif
 }
 
 //---------------------------------------------------------------------------------------
-bool LdpTextReader::is_ready()
+void LdpMappedFileReader::load_file()
 {
-    return true;
+    //throws if file not found
+    InputStream* file = FileSystem::open_input_stream(m_locator);
+
+    const long k_blockSize = 64 * 1024;
+    std::vector<unsigned char> block(k_blockSize);
+    while (!file->eof())
+    {
+        long bytes = file->read(&block[0], k_blockSize);
+        if (bytes <= 0)
+            break;
+        m_content.append(reinterpret_cast<const char*>(&block[0]), size_t(bytes));
+    }
+    delete file;
+
+    m_buffer.set_data(m_content.data(), m_content.size(), true);
 }
 
-//---------------------------------------------------------------------------------------
-bool LdpTextReader::end_of_data()
+
+
+//=======================================================================================
+// LdpTextReader implementation
+//=======================================================================================
+
+LdpTextReader::LdpTextReader(const std::string& sourceText)
+    : LdpBufferedReader()
+    , m_text(sourceText)
 {
-    return m_stream.peek() == EOF;
+    m_buffer.set_data(m_text.data(), m_text.size(), false);
 }
 
 
@@ -50,6 +50,60 @@ const char chUnderscore = '_';
 const char nEOF = EOF;         //End Of File
 
 
+//---------------------------------------------------------------------------------------
+// LdpTokenText: helper for accumulating the chars of a token. When the source is in
+// a buffer and the chars are contiguous and unchanged in it, the token value is just
+// a view into the buffer and no copy is made.
+class LdpTokenText
+{
+private:
+    LdpReaderBuffer* m_pBuffer;
+    const char* m_pStart;
+    size_t m_size;
+    bool m_fView;
+    std::string m_text;
+
+public:
+    LdpTokenText(LdpReaderBuffer* pBuffer)
+        : m_pBuffer(pBuffer)
+        , m_pStart(nullptr)
+        , m_size(0)
+        , m_fView(pBuffer != nullptr)
+    {
+    }
+
+    //appends ch, that must be the last char read from the reader
+    inline void append(char ch)
+    {
+        if (m_fView)
+        {
+            const char* pLast = m_pBuffer->get_last_char_ptr();
+            if (pLast && *pLast == ch && (m_size == 0 || pLast == m_pStart + m_size))
+            {
+                if (m_size == 0)
+                    m_pStart = pLast;
+                ++m_size;
+                return;
+            }
+
+            //not contiguous or changed (i.e. tabs). Switch to a copy
+            m_fView = false;
+            if (m_size > 0)
+                m_text.assign(m_pStart, m_size);
+        }
+        m_text += ch;
+    }
+
+    inline LdpToken* new_token(ETokenType type, int numLine)
+    {
+        if (m_fView)
+            return LOMSE_NEW LdpToken(type, (m_size > 0 ? m_pStart : ""), m_size, numLine);
+        else
+            return LOMSE_NEW LdpToken(type, m_text, numLine);
+    }
+};
+
+
 //---------------------------------------------------------------------------------------
 // Implementation of class LdpTokenizer
 //---------------------------------------------------------------------------------------
@@ -69,6 +123,7 @@ LdpTokenizer::LdpTokenizer(LdpReader& reader, ostream& reporter)
     , m_expectingValuePart(false)
     , m_expectingNamePart(false)
     , m_pTokenNamePart(nullptr)
+    , m_pBuffer( reader.get_buffer() )
 {
 }
 
@@ -88,7 +143,7 @@ void LdpTokenizer::skip_utf_bom()
         curChar = get_next_char();  // 0xbf
     }
     else
-        m_reader.repeat_last_char();
+        repeat_last_char();
 }
 
 //---------------------------------------------------------------------------------------
@@ -138,9 +193,9 @@ LdpToken* LdpTokenizer::read_token()
     // loop until a token is found
     while(true)
     {
-        if (m_reader.end_of_data())
+        if (end_of_data())
         {
-            m_pToken = LOMSE_NEW LdpToken(tkEndOfFile, "", m_reader.get_line_number());
+            m_pToken = LOMSE_NEW LdpToken(tkEndOfFile, "", get_line_number());
             return m_pToken;
         }
 
@@ -182,7 +237,7 @@ LdpToken* LdpTokenizer::parse_new_token()
     };
 
     EAutomataState state = k_Start;
-    stringstream tokendata;
+    LdpTokenText tokendata(m_pBuffer);
     char curChar = 0;
     int numLine = 0;
 
@@ -192,7 +247,7 @@ LdpToken* LdpTokenizer::parse_new_token()
         {
             case k_Start:
                 curChar = get_next_char();
-                numLine = m_reader.get_line_number();
+                numLine = get_line_number();
                 if (is_letter(curChar)
                     || curChar == chOpenBracket
                     || curChar == chBar
@@ -246,7 +301,7 @@ LdpToken* LdpTokenizer::parse_new_token()
                 break;
 
             case k_ETQ01:
-                tokendata << curChar;
+                tokendata.append(curChar);
                 curChar = get_next_char();
                 if (is_letter(curChar) || is_number(curChar) ||
                     curChar == chUnderscore || curChar == chDot ||
@@ -261,12 +316,12 @@ LdpToken* LdpTokenizer::parse_new_token()
                     // compact notation [ name:value --> (name value) ]
                     // 'name' part is parsed and we've found the ':' sign
                     m_expectingNamePart = true;
-                    m_pTokenNamePart = LOMSE_NEW LdpToken(tkLabel, tokendata.str(), numLine);
+                    m_pTokenNamePart = tokendata.new_token(tkLabel, numLine);
                     return LOMSE_NEW LdpToken(tkStartOfElement, chOpenParenthesis, numLine);
                 }
                 else {
-                    m_reader.repeat_last_char();
-                    return LOMSE_NEW LdpToken(tkLabel, tokendata.str(), numLine);
+                    repeat_last_char();
+                    return tokendata.new_token(tkLabel, numLine);
                 }
                 break;
 
@@ -292,7 +347,7 @@ LdpToken* LdpTokenizer::parse_new_token()
             case k_STR00:
                 curChar = get_next_char();
                 if (curChar == chQuotes) {
-                    return LOMSE_NEW LdpToken(tkString, tokendata.str(), numLine);
+                    return tokendata.new_token(tkString, numLine);
                 } else {
                     if (curChar == nEOF) {
                         state = k_Error;
@@ -303,10 +358,10 @@ LdpToken* LdpTokenizer::parse_new_token()
                 break;
 
             case k_STR01:
-                tokendata << curChar;
+                tokendata.append(curChar);
                 curChar = get_next_char();
                 if (curChar == chQuotes) {
-                    return LOMSE_NEW LdpToken(tkString, tokendata.str(), numLine);
+                    return tokendata.new_token(tkString, numLine);
                 } else {
                     if (curChar == nEOF) {
                         state = k_Error;
@@ -326,7 +381,7 @@ LdpToken* LdpTokenizer::parse_new_token()
                 break;
 
             case k_STR02:
-                tokendata << curChar;
+                tokendata.append(curChar);
                 curChar = get_next_char();
                 if (curChar == chApostrophe) {
                     state = k_STR03;
@@ -338,14 +393,14 @@ LdpToken* LdpTokenizer::parse_new_token()
             case k_STR03:
                 curChar = get_next_char();
                 if (curChar == chApostrophe) {
-                    return LOMSE_NEW LdpToken(tkString, tokendata.str(), numLine);
+                    return tokendata.new_token(tkString, numLine);
                 } else {
                     state = k_STR02;
                 }
                 break;
 
             case k_CMT01:
-                tokendata << curChar;
+                tokendata.append(curChar);
                 curChar = get_next_char();
                 if (curChar == chSlash)
                     state = k_CMT02;
@@ -356,16 +411,16 @@ LdpToken* LdpTokenizer::parse_new_token()
                 break;
 
             case k_CMT02:
-                tokendata << curChar;
+                tokendata.append(curChar);
                 curChar = get_next_char();
                 if (curChar == chLF || curChar == nEOF) {
-                    return LOMSE_NEW LdpToken(tkComment, tokendata.str(), numLine);
+                    return tokendata.new_token(tkComment, numLine);
                 }
                 //else continue in this state
                 break;
 
             case k_CMT03:
-                tokendata << curChar;
+                tokendata.append(curChar);
                 curChar = get_next_char();
                 if (curChar == chAsterisk || curChar == nEOF) {
                     state = k_CMT04;
@@ -374,18 +429,18 @@ LdpToken* LdpTokenizer::parse_new_token()
                 break;
 
             case k_CMT04:
-                tokendata << curChar;
+                tokendata.append(curChar);
                 curChar = get_next_char();
                 if (curChar == chSlash || curChar == nEOF) {
-                    tokendata << curChar;
-                    return LOMSE_NEW LdpToken(tkComment, tokendata.str(), numLine);
+                    tokendata.append(curChar);
+                    return tokendata.new_token(tkComment, numLine);
                 }
                 else
                     state = k_CMT03;
                 break;
 
             case k_NUM01:
-                tokendata << curChar;
+                tokendata.append(curChar);
                 curChar = get_next_char();
                 if (is_number(curChar)) {
                     state = k_NUM01;
@@ -394,19 +449,19 @@ LdpToken* LdpTokenizer::parse_new_token()
                 } else if (is_letter(curChar) || curChar == chUnderscore) {
                     state = k_ETQ01;
                 } else {
-                    m_reader.repeat_last_char();
-                    return LOMSE_NEW LdpToken(tkIntegerNumber, tokendata.str(), numLine);
+                    repeat_last_char();
+                    return tokendata.new_token(tkIntegerNumber, numLine);
                 }
                 break;
 
             case k_NUM02:
-                tokendata << curChar;
+                tokendata.append(curChar);
                 curChar = get_next_char();
                 if (is_number(curChar)) {
                     state = k_NUM02;
                 } else {
-                    m_reader.repeat_last_char();
-                    return LOMSE_NEW LdpToken(tkRealNumber, tokendata.str(), numLine);
+                    repeat_last_char();
+                    return tokendata.new_token(tkRealNumber, numLine);
                 }
                 break;
 
@@ -415,21 +470,21 @@ LdpToken* LdpTokenizer::parse_new_token()
                 if (curChar == chSpace || curChar == chTab) {
                     state = k_SPC01;
                 } else {
-                    m_reader.repeat_last_char();
+                    repeat_last_char();
                     return LOMSE_NEW LdpToken(tkSpaces, chSpace, numLine);
                 }
                 break;
 
             case k_S01:
-                tokendata << curChar;
+                tokendata.append(curChar);
                 curChar = get_next_char();
                 if (curChar == chSpace || curChar == chTab) {
-                    return LOMSE_NEW LdpToken(tkLabel, tokendata.str(), numLine);
+                    return tokendata.new_token(tkLabel, numLine);
                 }
                 else if (curChar == chCloseParenthesis)
                 {
-                    m_reader.repeat_last_char();
-                    return LOMSE_NEW LdpToken(tkLabel, tokendata.str(), numLine);
+                    repeat_last_char();
+                    return tokendata.new_token(tkLabel, numLine);
                 }
                 else if (is_number(curChar)) {
                     state = k_NUM01;
@@ -467,31 +522,44 @@ LdpToken* LdpTokenizer::parse_new_token()
 //---------------------------------------------------------------------------------------
 char LdpTokenizer::get_next_char()
 {
-    char ch = m_reader.get_next_char();
+    char ch = (m_pBuffer ? m_pBuffer->get_next_char() : m_reader.get_next_char());
     if (ch == chTab || ch == chCR)
         return ' ';
     else
         return ch;
 }
 
+//---------------------------------------------------------------------------------------
+void LdpTokenizer::repeat_last_char()
+{
+    if (m_pBuffer)
+        m_pBuffer->repeat_last_char();
+    else
+        m_reader.repeat_last_char();
+}
+
+//---------------------------------------------------------------------------------------
+bool LdpTokenizer::end_of_data()
+{
+    return (m_pBuffer ? m_pBuffer->end_of_data() : m_reader.end_of_data());
+}
+
 //---------------------------------------------------------------------------------------
 bool LdpTokenizer::is_letter(char ch)
 {
-    static const std::string letters("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz");
-    return (letters.find(ch) != string::npos);
+    return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z');
 }
 
 //---------------------------------------------------------------------------------------
 bool LdpTokenizer::is_number(char ch)
 {
-    static const std::string numbers("0123456789");
-    return (numbers.find(ch) != string::npos);
+    return (ch >= '0' && ch <= '9');
 }
 
 //---------------------------------------------------------------------------------------
 int LdpTokenizer::get_line_number()
 {
-    return m_reader.get_line_number();
+    return (m_pBuffer ? m_pBuffer->get_line_number() : m_reader.get_line_number());
 }
 
 
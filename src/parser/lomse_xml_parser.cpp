@@ -8,11 +8,15 @@
 //---------------------------------------------------------------------------------------
 
 #include "lomse_xml_parser.h"
+#include "lomse_import_stats.h"
 
 #include <iostream>
 #include <ostream>
 #include <sstream>
 #include <vector>
+#include <cstring>
+#include <cctype>
+#include <algorithm>
 using namespace std;
 
 
@@ -102,6 +106,89 @@ ptrdiff_t XmlNode::offset()
 }
 
 
+//=======================================================================================
+// XmlTagsTable implementation
+//=======================================================================================
+XmlTagsTable::XmlTagsTable(const Entry* entries, size_t numEntries, int undefinedTag,
+                           unsigned int seedHint, size_t sizeHint)
+    : m_seed(0)
+    , m_mask(0)
+    , m_undefinedTag(undefinedTag)
+    , m_fSeedSearched(false)
+{
+    if (seedHint != 0 && sizeHint >= numEntries && (sizeHint & (sizeHint - 1)) == 0
+        && build_table(entries, numEntries, sizeHint, seedHint))
+    {
+        return;
+    }
+
+    //search for a seed without collisions. When not found, try a bigger table
+    m_fSeedSearched = true;
+    size_t size = 1;
+    while (size < 2 * numEntries)
+        size <<= 1;
+
+    while (true)
+    {
+        for (unsigned int seed = 1; seed <= 1000; ++seed)
+        {
+            if (build_table(entries, numEntries, size, seed))
+                return;
+        }
+        size <<= 1;
+    }
+}
+
+//---------------------------------------------------------------------------------------
+bool XmlTagsTable::build_table(const Entry* entries, size_t numEntries, size_t size,
+                               unsigned int seed)
+{
+    Slot empty = { nullptr, 0, m_undefinedTag };
+    m_slots.assign(size, empty);
+    m_mask = size - 1;
+    m_seed = seed;
+
+    for (size_t i=0; i < numEntries; ++i)
+    {
+        size_t len = strlen(entries[i].name);
+        Slot& slot = m_slots[ hash(entries[i].name, len, seed) & m_mask ];
+        if (slot.name != nullptr)
+        {
+            //duplicated names are ignored: first one is kept
+            if (slot.len == len && memcmp(slot.name, entries[i].name, len) == 0)
+                continue;
+            return false;
+        }
+        slot.name = entries[i].name;
+        slot.len = len;
+        slot.tag = entries[i].tag;
+    }
+    return true;
+}
+
+//---------------------------------------------------------------------------------------
+unsigned int XmlTagsTable::hash(const char* name, size_t len, unsigned int seed)
+{
+    //FNV-1a, with the seed mixed in the offset basis
+    unsigned int h = 2166136261u ^ (seed * 16777619u);
+    for (size_t i=0; i < len; ++i)
+    {
+        h ^= static_cast<unsigned char>(name[i]);
+        h *= 16777619u;
+    }
+    return h ^ (h >> 15);
+}
+
+//---------------------------------------------------------------------------------------
+int XmlTagsTable::get_tag(const char* name, size_t len) const
+{
+    const Slot& slot = m_slots[ hash(name, len, m_seed) & m_mask ];
+    if (slot.len == len && slot.name != nullptr && memcmp(slot.name, name, len) == 0)
+        return slot.tag;
+    return m_undefinedTag;
+}
+
+
 //=======================================================================================
 // XmlParser implementation
 //=======================================================================================
@@ -110,6 +197,7 @@ XmlParser::XmlParser(ostream& reporter)
     , m_root()
     , m_errorOffset(0)
     , m_fOffsetDataReady(false)
+    , m_firstLine(0)
 {
 }
 
@@ -133,7 +221,9 @@ void XmlParser::parse_cstring(char* sourceText)
 //---------------------------------------------------------------------------------------
 void XmlParser::parse_file(const std::string& filename, bool UNUSED(fErrorMsg))
 {
+    ImportPhase phase(ImportStats::k_import_parse);
     m_fOffsetDataReady = false;
+    m_firstLine = 0;
     m_filename = filename;
     pugi::xml_parse_result result = m_doc.load_file(filename.c_str(),
                                                     (pugi::parse_default |
@@ -155,7 +245,9 @@ void XmlParser::parse_file(const std::string& filename, bool UNUSED(fErrorMsg))
 //---------------------------------------------------------------------------------------
 void XmlParser::parse_char_string(char* str)
 {
+    ImportPhase phase(ImportStats::k_import_parse);
     m_fOffsetDataReady = false;
+    m_firstLine = 0;
     m_filename.clear();
     pugi::xml_parse_result result = m_doc.load_string(str, (pugi::parse_default |
                                                             //pugi::parse_trim_pcdata |
@@ -175,7 +267,9 @@ void XmlParser::parse_char_string(char* str)
 //---------------------------------------------------------------------------------------
 void XmlParser::parse_buffer(const void* buffer, size_t size)
 {
+    ImportPhase phase(ImportStats::k_import_parse);
     m_fOffsetDataReady = false;
+    m_firstLine = 0;
     m_filename.clear();
     pugi::xml_parse_result result = m_doc.load_buffer(buffer, size,
                                                       (pugi::parse_default |
@@ -193,6 +287,66 @@ void XmlParser::parse_buffer(const void* buffer, size_t size)
     find_root();
 }
 
+//---------------------------------------------------------------------------------------
+void XmlParser::parse_owned_buffer(void* buffer, size_t size)
+{
+    ImportPhase phase(ImportStats::k_import_parse);
+    m_fOffsetDataReady = false;
+    m_firstLine = 0;
+    m_filename.clear();
+    pugi::xml_parse_result result = m_doc.load_buffer_inplace_own(buffer, size,
+                                                      (pugi::parse_default |
+                                                       pugi::parse_declaration)
+                                                     );
+
+    if (!result)
+    {
+        m_errorMsg = string(result.description());
+        m_errorOffset = int(result.offset);
+        m_reporter << "Pos: " << m_errorOffset << ". Error: " << m_errorMsg << endl;
+    }
+    find_root();
+}
+
+//---------------------------------------------------------------------------------------
+void* XmlParser::allocate_buffer(size_t size)
+{
+    //AWARE: the buffer will be deallocated by pugixml
+    return pugi::get_memory_allocation_function()(size);
+}
+
+//---------------------------------------------------------------------------------------
+void XmlParser::free_buffer(void* buffer)
+{
+    //for buffers not passed to parse_owned_buffer(), e.g. on read errors
+    pugi::get_memory_deallocation_function()(buffer);
+}
+
+//---------------------------------------------------------------------------------------
+void XmlParser::parse_chunk(const std::string& text, int firstLine)
+{
+    parse_buffer(static_cast<const void*>(text.data()), text.size());
+    m_firstLine = firstLine;
+    build_offset_data_from_text(text);
+    m_fOffsetDataReady = true;
+}
+
+//---------------------------------------------------------------------------------------
+void XmlParser::clear()
+{
+    m_doc.reset();
+    m_root = XmlNode();
+    m_offsetData.clear();
+    m_fOffsetDataReady = false;
+    m_firstLine = 0;
+}
+
+//---------------------------------------------------------------------------------------
+bool XmlParser::is_node_in_tree(XmlNode* node)
+{
+    return !m_doc.empty() && node->m_node.root() == m_doc;
+}
+
 //---------------------------------------------------------------------------------------
 void XmlParser::find_root()
 {
@@ -246,6 +400,17 @@ bool XmlParser::build_offset_data(const char* filename)
     return true;
 }
 
+//---------------------------------------------------------------------------------------
+void XmlParser::build_offset_data_from_text(const std::string& text)
+{
+    m_offsetData.clear();
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+        if (text[i] == '\n')
+            m_offsetData.push_back(ptrdiff_t(i));
+    }
+}
+
 //---------------------------------------------------------------------------------------
 std::pair<int, int> XmlParser::get_location(ptrdiff_t offset)
 {
@@ -267,12 +432,321 @@ int XmlParser::get_line_number(XmlNode* node)
     if ( m_fOffsetDataReady)
     {
         std::pair<int, int> pos = get_location(offset);
-        return pos.first;
+        return (m_firstLine > 0 ? m_firstLine - 1 : 0) + pos.first;
     }
     else
         return 0;
 }
 
 
+//=======================================================================================
+// XmlStreamReader implementation
+//=======================================================================================
+XmlStreamReader::XmlStreamReader(std::istream& stream)
+    : m_stream(stream)
+    , m_pos(0)
+    , m_fEof(false)
+    , m_line(1)
+    , m_type(k_eof)
+    , m_depth(0)
+    , m_openElements(0)
+    , m_tagLine(1)
+{
+}
+
+//---------------------------------------------------------------------------------------
+bool XmlStreamReader::fill_buffer()
+{
+    if (m_fEof)
+        return false;
+
+    //discard consumed data before growing the buffer
+    if (m_pos > 0 && m_pos >= m_buffer.size() / 2)
+    {
+        m_buffer.erase(0, m_pos);
+        m_pos = 0;
+    }
+
+    char chunk[65536];
+    m_stream.read(chunk, sizeof(chunk));
+    std::streamsize size = m_stream.gcount();
+    if (size > 0)
+        m_buffer.append(chunk, size_t(size));
+
+    if (!m_stream)
+        m_fEof = true;
+
+    return size > 0;
+}
+
+//---------------------------------------------------------------------------------------
+bool XmlStreamReader::ensure_data(size_t pos)
+{
+    //AWARE: pos is relative to m_pos, as fill_buffer() could move data
+    while (m_pos + pos >= m_buffer.size())
+    {
+        if (!fill_buffer())
+            return false;
+    }
+    return true;
+}
+
+//---------------------------------------------------------------------------------------
+size_t XmlStreamReader::find_in_buffer(const char* pattern, size_t from)
+{
+    //returns position (relative to m_pos) of first char after pattern, or
+    //string::npos if not found
+
+    size_t len = strlen(pattern);
+    while (true)
+    {
+        size_t found = m_buffer.find(pattern, m_pos + from);
+        if (found != string::npos)
+            return found - m_pos + len;
+
+        //not found: search again, when more data, from last possible start point
+        size_t searched = m_buffer.size() - m_pos;
+        from = (searched >= len ? searched - len + 1 : 0);
+        if (!fill_buffer())
+            return string::npos;
+    }
+}
+
+//---------------------------------------------------------------------------------------
+size_t XmlStreamReader::find_end_of_tag(size_t from)
+{
+    //returns position (relative to m_pos) of first char after the '>' that closes
+    //current tag, or string::npos if not found. Quoted attribute values can
+    //contain '>' chars.
+
+    char quote = 0;
+    for (size_t i = from; ensure_data(i); ++i)
+    {
+        char ch = m_buffer[m_pos + i];
+        if (quote)
+        {
+            if (ch == quote)
+                quote = 0;
+        }
+        else if (ch == '"' || ch == '\'')
+            quote = ch;
+        else if (ch == '>')
+            return i + 1;
+    }
+    return string::npos;
+}
+
+//---------------------------------------------------------------------------------------
+size_t XmlStreamReader::find_end_of_doctype(size_t from)
+{
+    //doctype can contain an internal subset, enclosed in [], with markup
+    //declarations inside
+
+    char quote = 0;
+    int brackets = 0;
+    for (size_t i = from; ensure_data(i); ++i)
+    {
+        char ch = m_buffer[m_pos + i];
+        if (quote)
+        {
+            if (ch == quote)
+                quote = 0;
+        }
+        else if (ch == '"' || ch == '\'')
+            quote = ch;
+        else if (ch == '[')
+            ++brackets;
+        else if (ch == ']')
+            --brackets;
+        else if (ch == '>' && brackets <= 0)
+            return i + 1;
+    }
+    return string::npos;
+}
+
+//---------------------------------------------------------------------------------------
+void XmlStreamReader::consume(size_t end)
+{
+    //moves m_pos to the given position (relative to m_pos), updating line number
+
+    for (size_t i = m_pos; i < m_pos + end; ++i)
+    {
+        if (m_buffer[i] == '\n')
+            ++m_line;
+    }
+    m_pos += end;
+}
+
+//---------------------------------------------------------------------------------------
+void XmlStreamReader::extract_name()
+{
+    //m_tag starts with '<' or '</'
+    size_t start = (m_tag.size() > 1 && m_tag[1] == '/' ? 2 : 1);
+    size_t end = start;
+    while (end < m_tag.size())
+    {
+        char ch = m_tag[end];
+        if (ch == '>' || ch == '/' || isspace(static_cast<unsigned char>(ch)))
+            break;
+        ++end;
+    }
+    m_name = m_tag.substr(start, end - start);
+}
+
+//---------------------------------------------------------------------------------------
+int XmlStreamReader::next_markup()
+{
+    m_text.clear();
+    m_tag.clear();
+    m_name.clear();
+
+    //character data up to next '<'
+    size_t start = 0;
+    while (true)
+    {
+        size_t found = m_buffer.find('<', m_pos + start);
+        if (found != string::npos)
+        {
+            start = found - m_pos;
+            break;
+        }
+        start = m_buffer.size() - m_pos;
+        if (!fill_buffer())
+        {
+            m_text = m_buffer.substr(m_pos);
+            consume(m_buffer.size() - m_pos);
+            m_type = (m_openElements > 0 ? k_error : k_eof);
+            return m_type;
+        }
+    }
+    m_text = m_buffer.substr(m_pos, start);
+    consume(start);
+    m_tagLine = m_line;
+
+    //identify markup and find its end
+    size_t end = string::npos;
+    int type = k_other;
+    ensure_data(8);
+    if (m_buffer.compare(m_pos, 4, "<!--") == 0)
+        end = find_in_buffer("-->", 4);
+    else if (m_buffer.compare(m_pos, 9, "<![CDATA[") == 0)
+        end = find_in_buffer("]]>", 9);
+    else if (m_buffer.compare(m_pos, 2, "<?") == 0)
+        end = find_in_buffer("?>", 2);
+    else if (m_buffer.compare(m_pos, 2, "<!") == 0)
+        end = find_end_of_doctype(2);
+    else if (m_buffer.compare(m_pos, 2, "</") == 0)
+    {
+        type = k_end_tag;
+        end = find_end_of_tag(2);
+    }
+    else
+    {
+        type = k_start_tag;
+        end = find_end_of_tag(1);
+        if (end != string::npos && m_buffer[m_pos + end - 2] == '/')
+            type = k_empty_tag;
+    }
+
+    if (end == string::npos)
+    {
+        m_tag = m_buffer.substr(m_pos);
+        consume(m_buffer.size() - m_pos);
+        m_type = k_error;
+        return m_type;
+    }
+
+    m_tag = m_buffer.substr(m_pos, end);
+    consume(end);
+
+    //update nesting info
+    m_type = type;
+    if (type == k_start_tag)
+    {
+        extract_name();
+        m_depth = ++m_openElements;
+    }
+    else if (type == k_empty_tag)
+    {
+        extract_name();
+        m_depth = m_openElements + 1;
+    }
+    else if (type == k_end_tag)
+    {
+        extract_name();
+        m_depth = m_openElements--;
+        if (m_openElements < 0)
+        {
+            m_openElements = 0;
+            m_type = k_error;
+        }
+    }
+    else
+        m_depth = m_openElements;
+
+    return m_type;
+}
+
+//---------------------------------------------------------------------------------------
+bool XmlStreamReader::read_element(std::string* pText)
+{
+    if (m_type != k_start_tag)
+        return false;
+
+    int depth = m_depth;
+    std::string name = m_name;
+    int line = m_tagLine;
+    *pText = m_tag;
+    while (true)
+    {
+        int type = next_markup();
+        pText->append(m_text);
+        pText->append(m_tag);
+        if (type == k_eof || type == k_error)
+            break;
+
+        if (type == k_end_tag && m_depth == depth)
+        {
+            //restore information about the element start tag
+            m_depth = depth;
+            m_name = name;
+            m_tagLine = line;
+            return true;
+        }
+    }
+    return false;
+}
+
+//---------------------------------------------------------------------------------------
+bool XmlStreamReader::skip_element()
+{
+    if (m_type != k_start_tag)
+        return m_type == k_empty_tag;
+
+    int depth = m_depth;
+    while (true)
+    {
+        int type = next_markup();
+        if (type == k_eof || type == k_error)
+            return false;
+        if (type == k_end_tag && m_depth == depth)
+            return true;
+    }
+}
+
+//---------------------------------------------------------------------------------------
+std::string XmlStreamReader::read_remaining()
+{
+    while (fill_buffer());
+
+    std::string data = m_buffer.substr(m_pos);
+    consume(m_buffer.size() - m_pos);
+    m_buffer.clear();
+    m_pos = 0;
+    m_type = k_eof;
+    return data;
+}
+
+
 } //namespace lomse
 
@@ -8,6 +8,7 @@
 //---------------------------------------------------------------------------------------
 
 #include "lomse_mnx_analyser.h"
+#include "lomse_import_stats.h"
 
 #include "lomse_xml_parser.h"
 #include "lomse_ldp_exporter.h"
@@ -34,6 +35,7 @@
 
 
 #include <iostream>
+#include <atomic>
 #include <sstream>
 //BUG: In my Ubuntu box next line causes problems since approx. 20/march/2011
 #if (LOMSE_PLATFORM_WIN32 == 1)
@@ -826,7 +828,7 @@ bool MnxElementAnalyser::get_optional(const string& name)
     if (more_children_to_analyse())
     {
         m_childToAnalyse = get_child_to_analyse();
-        if (m_childToAnalyse.name() == name)
+        if (m_childToAnalyse.has_name(name))
         {
             move_to_next_child();
             return true;
@@ -851,7 +853,7 @@ bool MnxElementAnalyser::analyse_optional(const string& name, ImoObj* pAnchor)
 //---------------------------------------------------------------------------------------
 bool MnxElementAnalyser::analyse_content(const string& tag, ImoObj* pAnchor)
 {
-    MnxElementAnalyser* a = m_pAnalyser->new_analyser(tag, pAnchor);
+    MnxElementAnalyser* a = m_pAnalyser->new_analyser(tag.c_str(), pAnchor);
     bool ret = a->analyse_node(&m_analysedNode);
     delete a;
     return ret;
@@ -3571,7 +3573,7 @@ public:
         //attrib: staff
         //TODO
 
-        static int num = 0;
+        static std::atomic<int> num(0);
 
         set_mandatory_data(orient, ++num, type);
 
@@ -3729,10 +3731,9 @@ protected:
 
     string generate_new_id()
     {
-        static int num=1;
+        static std::atomic<int> num(1);
         stringstream s;
-        s << "P" << num;
-        ++num;
+        s << "P" << num++;
         return s.str();
     }
 };
@@ -4230,7 +4231,7 @@ protected:
     ImoTie* create_tie(ImoNote* pStartNote, ImoNote* pEndNote)
     {
         //TODO: Finish this
-        static int tieNumber = 0;
+        static std::atomic<int> tieNumber(0);
 
         Document* pDoc = m_pAnalyser->get_document_being_analysed();
 
@@ -4695,84 +4696,6 @@ MnxAnalyser::MnxAnalyser(ostream& reporter, LibraryScope& libraryScope, Document
     , m_beamLevel(0)
     , m_noteClass(k_imo_note_regular)
 {
-    //populate the name to enum conversion map
-//    m_NameToEnum["accordion-registration"] = k_mnx_tag_accordion_registration;
-//    m_NameToEnum["articulations"] = k_mnx_tag_articulations;
-//    m_NameToEnum["backup"] = k_mnx_tag_backup;
-//    m_NameToEnum["barline"] = k_mnx_tag_barline;
-    m_NameToEnum["beam"] = k_mnx_tag_beam;
-    m_NameToEnum["beam-hook"] = k_mnx_tag_beam_hook;
-    m_NameToEnum["beams"] = k_mnx_tag_beams;
-//    m_NameToEnum["bracket"] = k_mnx_tag_bracket;
-    m_NameToEnum["clef"] = k_mnx_tag_clef;
-//    m_NameToEnum["coda"] = k_mnx_tag_coda;
-//    m_NameToEnum["damp"] = k_mnx_tag_damp;
-//    m_NameToEnum["damp-all"] = k_mnx_tag_damp_all;
-//    m_NameToEnum["dashes"] = k_mnx_tag_dashes;
-//    m_NameToEnum["direction"] = k_mnx_tag_direction;
-    m_NameToEnum["directions"] = k_mnx_tag_directions;
-//    m_NameToEnum["direction-type"] = k_mnx_tag_direction_type;
-    m_NameToEnum["dynamics"] = k_mnx_tag_dynamics;
-//    m_NameToEnum["ending"] = k_mnx_tag_ending;
-    m_NameToEnum["event"] = k_mnx_tag_event;
-    m_NameToEnum["expression"] = k_mnx_tag_expression;
-//    m_NameToEnum["eyeglasses"] = k_mnx_tag_eyeglasses;
-//    m_NameToEnum["fermata"] = k_mnx_tag_fermata;
-//    m_NameToEnum["forward"] = k_mnx_tag_forward;
-    m_NameToEnum["fine"] = k_mnx_tag_fine;
-    m_NameToEnum["global"] = k_mnx_tag_global;
-    m_NameToEnum["grace"] = k_mnx_tag_grace;
-//    m_NameToEnum["harp-pedals"] = k_mnx_tag_harp_pedals;
-    m_NameToEnum["head"] = k_mnx_tag_head;
-//    m_NameToEnum["image"] = k_mnx_tag_image;
-    m_NameToEnum["instrument-sound"] = k_mnx_tag_instrument_sound;
-    m_NameToEnum["jump"] = k_mnx_tag_jump;
-    m_NameToEnum["key"] = k_mnx_tag_key;
-//    m_NameToEnum["lyric"] = k_mnx_tag_lyric;
-    m_NameToEnum["measure"] = k_mnx_tag_measure;
-//    m_NameToEnum["metronome"] = k_mnx_tag_metronome;
-//    m_NameToEnum["midi-device"] = k_mnx_tag_midi_device;
-//    m_NameToEnum["midi-instrument"] = k_mnx_tag_midi_instrument;
-    m_NameToEnum["mnx"] = k_mnx_tag_mnx;
-//    m_NameToEnum["notations"] = k_mnx_tag_notations;
-    m_NameToEnum["note"] = k_mnx_tag_note;
-    m_NameToEnum["octave-shift"] = k_mnx_tag_octave_shift;
-//    m_NameToEnum["ornaments"] = k_mnx_tag_ornaments;
-    m_NameToEnum["part"] = k_mnx_tag_part;
-//    m_NameToEnum["part-group"] = k_mnx_tag_part_group;
-//    m_NameToEnum["part-list"] = k_mnx_tag_part_list;
-    m_NameToEnum["part-name"] = k_mnx_tag_part_name;
-//    m_NameToEnum["pedal"] = k_mnx_tag_pedal;
-//    m_NameToEnum["percussion"] = k_mnx_tag_percussion;
-//    m_NameToEnum["pitch"] = k_mnx_tag_pitch;
-//    m_NameToEnum["principal-voice"] = k_mnx_tag_principal_voice;
-//    m_NameToEnum["print"] = k_mnx_tag_print;
-//    m_NameToEnum["rehearsal"] = k_mnx_tag_rehearsal;
-    m_NameToEnum["repeat"] = k_mnx_tag_repeat;
-    m_NameToEnum["rest"] = k_mnx_tag_rest;
-//    m_NameToEnum["scordatura"] = k_mnx_tag_scordatura;
-    m_NameToEnum["score"] = k_mnx_tag_score;
-//    m_NameToEnum["score-instrument"] = k_mnx_tag_score_instrument;
-//    m_NameToEnum["score-part"] = k_mnx_tag_score_part;
-//    m_NameToEnum["score-partwise"] = k_mnx_tag_score_partwise;
-    m_NameToEnum["segno"] = k_mnx_tag_segno;
-    m_NameToEnum["sequence"] = k_mnx_tag_sequence;
-    m_NameToEnum["sequence_content"] = k_mnx_tag_sequence_content;
-//    m_NameToEnum["slur"] = k_mnx_tag_slur;
-//    m_NameToEnum["sound"] = k_mnx_tag_sound;
-    m_NameToEnum["staff"] = k_mnx_tag_staff;
-//    m_NameToEnum["string-mute"] = k_mnx_tag_string_mute;
-//    m_NameToEnum["technical"] = k_mnx_tag_technical;
-//    m_NameToEnum["text"] = k_mnx_tag_text;
-    m_NameToEnum["tied"] = k_mnx_tag_tied;
-    m_NameToEnum["time"] = k_mnx_tag_time;
-//    m_NameToEnum["time-modification"] = k_mnx_tag_time_modification;
-    m_NameToEnum["tuplet"] = k_mnx_tag_tuplet;
-//    m_NameToEnum["tuplet-actual"] = k_mnx_tag_tuplet_actual;
-//    m_NameToEnum["tuplet-normal"] = k_mnx_tag_tuplet_normal;
-//    m_NameToEnum["virtual-instrument"] = k_mnx_tag_virtual_instr;
-    m_NameToEnum["wedge"] = k_mnx_tag_wedge;
-//    m_NameToEnum["words"] = k_mnx_tag_words;
 }
 
 //---------------------------------------------------------------------------------------
@@ -4780,7 +4703,6 @@ MnxAnalyser::~MnxAnalyser()
 {
     delete_relation_builders();
     delete_globals();
-    m_NameToEnum.clear();
     m_lyrics.clear();
     m_lyricIndex.clear();
     set_result(nullptr);
@@ -4828,6 +4750,7 @@ ImoObj* MnxAnalyser::analyse_tree_and_get_object(XmlNode* root)
 //---------------------------------------------------------------------------------------
 ImoObj* MnxAnalyser::analyse_tree(XmlNode* tree, const string& locator)
 {
+    ImportPhase phase(ImportStats::k_import_analyse);
     m_fileLocator = locator;
     return analyse_tree_and_get_object(tree);
 }
@@ -4836,7 +4759,7 @@ ImoObj* MnxAnalyser::analyse_tree(XmlNode* tree, const string& locator)
 bool MnxAnalyser::analyse_node(XmlNode* pNode, ImoObj* pAnchor)
 {
     //m_reporter << "DBG. Analysing node: " << pNode->name() << endl;
-    MnxElementAnalyser* a = new_analyser( pNode->name(), pAnchor );
+    MnxElementAnalyser* a = new_analyser( pNode->name_cstr(), pAnchor );
     set_result(nullptr);
     bool res = a->analyse_node(pNode);
     delete a;
@@ -5195,7 +5118,7 @@ bool MnxAnalyser::to_integer(const string& text, int* pResult)
 }
 
 //---------------------------------------------------------------------------------------
-MnxElementAnalyser* MnxAnalyser::new_analyser(const string& name, ImoObj* pAnchor)
+MnxElementAnalyser* MnxAnalyser::new_analyser(const char* name, ImoObj* pAnchor)
 {
     //Factory method to create analysers
 
@@ -5238,13 +5161,101 @@ MnxElementAnalyser* MnxAnalyser::new_analyser(const string& name, ImoObj* pAncho
 }
 
 //---------------------------------------------------------------------------------------
-int MnxAnalyser::name_to_enum(const string& name) const
+// conversion from MNX element name to EMnxTag
+static const XmlTagsTable::Entry k_mnx_tags[] =
+{
+//  { "accordion-registration",    k_mnx_tag_accordion_registration },
+//  { "articulations",             k_mnx_tag_articulations },
+//  { "backup",                    k_mnx_tag_backup },
+//  { "barline",                   k_mnx_tag_barline },
+    { "beam",                      k_mnx_tag_beam },
+    { "beam-hook",                 k_mnx_tag_beam_hook },
+    { "beams",                     k_mnx_tag_beams },
+//  { "bracket",                   k_mnx_tag_bracket },
+    { "clef",                      k_mnx_tag_clef },
+//  { "coda",                      k_mnx_tag_coda },
+//  { "damp",                      k_mnx_tag_damp },
+//  { "damp-all",                  k_mnx_tag_damp_all },
+//  { "dashes",                    k_mnx_tag_dashes },
+//  { "direction",                 k_mnx_tag_direction },
+    { "directions",                k_mnx_tag_directions },
+//  { "direction-type",            k_mnx_tag_direction_type },
+    { "dynamics",                  k_mnx_tag_dynamics },
+//  { "ending",                    k_mnx_tag_ending },
+    { "event",                     k_mnx_tag_event },
+    { "expression",                k_mnx_tag_expression },
+//  { "eyeglasses",                k_mnx_tag_eyeglasses },
+//  { "fermata",                   k_mnx_tag_fermata },
+//  { "forward",                   k_mnx_tag_forward },
+    { "fine",                      k_mnx_tag_fine },
+    { "global",                    k_mnx_tag_global },
+    { "grace",                     k_mnx_tag_grace },
+//  { "harp-pedals",               k_mnx_tag_harp_pedals },
+    { "head",                      k_mnx_tag_head },
+//  { "image",                     k_mnx_tag_image },
+    { "instrument-sound",          k_mnx_tag_instrument_sound },
+    { "jump",                      k_mnx_tag_jump },
+    { "key",                       k_mnx_tag_key },
+//  { "lyric",                     k_mnx_tag_lyric },
+    { "measure",                   k_mnx_tag_measure },
+//  { "metronome",                 k_mnx_tag_metronome },
+//  { "midi-device",               k_mnx_tag_midi_device },
+//  { "midi-instrument",           k_mnx_tag_midi_instrument },
+    { "mnx",                       k_mnx_tag_mnx },
+//  { "notations",                 k_mnx_tag_notations },
+    { "note",                      k_mnx_tag_note },
+    { "octave-shift",              k_mnx_tag_octave_shift },
+//  { "ornaments",                 k_mnx_tag_ornaments },
+    { "part",                      k_mnx_tag_part },
+//  { "part-group",                k_mnx_tag_part_group },
+//  { "part-list",                 k_mnx_tag_part_list },
+    { "part-name",                 k_mnx_tag_part_name },
+//  { "pedal",                     k_mnx_tag_pedal },
+//  { "percussion",                k_mnx_tag_percussion },
+//  { "pitch",                     k_mnx_tag_pitch },
+//  { "principal-voice",           k_mnx_tag_principal_voice },
+//  { "print",                     k_mnx_tag_print },
+//  { "rehearsal",                 k_mnx_tag_rehearsal },
+    { "repeat",                    k_mnx_tag_repeat },
+    { "rest",                      k_mnx_tag_rest },
+//  { "scordatura",                k_mnx_tag_scordatura },
+    { "score",                     k_mnx_tag_score },
+//  { "score-instrument",          k_mnx_tag_score_instrument },
+//  { "score-part",                k_mnx_tag_score_part },
+//  { "score-partwise",            k_mnx_tag_score_partwise },
+    { "segno",                     k_mnx_tag_segno },
+    { "sequence",                  k_mnx_tag_sequence },
+    { "sequence_content",          k_mnx_tag_sequence_content },
+//  { "slur",                      k_mnx_tag_slur },
+//  { "sound",                     k_mnx_tag_sound },
+    { "staff",                     k_mnx_tag_staff },
+//  { "string-mute",               k_mnx_tag_string_mute },
+//  { "technical",                 k_mnx_tag_technical },
+//  { "text",                      k_mnx_tag_text },
+    { "tied",                      k_mnx_tag_tied },
+    { "time",                      k_mnx_tag_time },
+//  { "time-modification",         k_mnx_tag_time_modification },
+    { "tuplet",                    k_mnx_tag_tuplet },
+//  { "tuplet-actual",             k_mnx_tag_tuplet_actual },
+//  { "tuplet-normal",             k_mnx_tag_tuplet_normal },
+//  { "virtual-instrument",        k_mnx_tag_virtual_instr },
+    { "wedge",                     k_mnx_tag_wedge },
+//  { "words",                     k_mnx_tag_words },
+};
+
+//---------------------------------------------------------------------------------------
+const XmlTagsTable& MnxAnalyser::get_tags_table()
 {
-	map<string, int>::const_iterator it = m_NameToEnum.find(name);
-	if (it != m_NameToEnum.end())
-		return it->second;
-    else
-        return k_mnx_tag_undefined;
+    //hints: seed and size found by XmlTagsTable. Update them when modifying the names
+    static const XmlTagsTable table(k_mnx_tags, sizeof(k_mnx_tags) / sizeof(k_mnx_tags[0]),
+                                    k_mnx_tag_undefined, 792u, 512);
+    return table;
+}
+
+//---------------------------------------------------------------------------------------
+int MnxAnalyser::name_to_enum(const char* name) const
+{
+    return get_tags_table().get_tag(name);
 }
 
 //---------------------------------------------------------------------------------------
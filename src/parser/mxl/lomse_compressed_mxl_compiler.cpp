@@ -41,26 +41,47 @@ ImoDocument* CompressedMxlCompiler::compile_file(const std::string& filename)
 
 #if (LOMSE_ENABLE_COMPRESSION == 1)
     ZipInputStream zip(filename);
+    return compile_archive(zip);
+#else
+    throw runtime_error("Could not open compressed file: Lomse was compiled without compression support");
+#endif
+}
 
-    const std::vector<unsigned char> mxmlBuffer = read_rootfile(zip);
+//---------------------------------------------------------------------------------------
+ImoDocument* CompressedMxlCompiler::compile_string(const std::string& source)
+{
+    //AWARE: source is the binary content of the .mxl file
+    return compile_buffer(static_cast<const void*>(source.data()), source.size());
+}
 
-    if (mxmlBuffer.empty())
-    {
-        LOMSE_LOG_ERROR("[CompressedMxlCompiler::compile_file] Couldn't read rootfile");
-        return nullptr;
-    }
+//---------------------------------------------------------------------------------------
+ImoDocument* CompressedMxlCompiler::compile_buffer(const void* buffer, size_t size)
+{
+    m_fileLocator = "string:";
 
-    return m_pMxlCompiler->compile_buffer(static_cast<const void*>(mxmlBuffer.data()), mxmlBuffer.size());
+#if (LOMSE_ENABLE_COMPRESSION == 1)
+    ZipInputStream zip(buffer, size);
+    return compile_archive(zip);
 #else
-    throw runtime_error("Could not open compressed file: Lomse was compiled without compression support");
+    throw runtime_error("Could not open compressed .mxl string: Lomse was compiled without compression support");
 #endif
 }
 
 //---------------------------------------------------------------------------------------
-ImoDocument* CompressedMxlCompiler::compile_string(const std::string& UNUSED(source))
+ImoDocument* CompressedMxlCompiler::compile_archive(ZipInputStream& zip)
 {
-    m_fileLocator = "string:";
-    throw runtime_error("Could not open compressed .mxl string: reading compressed string is not supported currently");
+#if (LOMSE_ENABLE_COMPRESSION == 1)
+    if (!open_rootfile(zip))
+    {
+        LOMSE_LOG_ERROR("[CompressedMxlCompiler::compile_archive] Couldn't read rootfile");
+        return nullptr;
+    }
+
+    return m_pMxlCompiler->compile_zip_entry(zip);
+#else
+    (void)zip;
+    return nullptr;
+#endif
 }
 
 //---------------------------------------------------------------------------------------
@@ -93,22 +114,20 @@ std::string CompressedMxlCompiler::get_rootfile_path(ZipInputStream& zip)
 }
 
 //---------------------------------------------------------------------------------------
-std::vector<unsigned char> CompressedMxlCompiler::read_rootfile(ZipInputStream& zip)
+bool CompressedMxlCompiler::open_rootfile(ZipInputStream& zip)
 {
 #if (LOMSE_ENABLE_COMPRESSION == 1)
     const std::string rootFilePath = get_rootfile_path(zip);
 
     if (rootFilePath.empty())
-        return {};
-
-    zip.move_to_entry(rootFilePath);
+        return false;
 
-    if (!zip.open_current_entry())
-        return {};
+    if (!zip.move_to_entry(rootFilePath))
+        return false;
 
-    return zip.get_as_vector();
+    return zip.open_current_entry();
 #else
-    return {};
+    return false;
 #endif
 }
 
@@ -8,6 +8,7 @@
 //---------------------------------------------------------------------------------------
 
 #include "lomse_mxl_analyser.h"
+#include "lomse_import_stats.h"
 
 #include "lomse_xml_parser.h"
 #include "lomse_ldp_exporter.h"
@@ -41,6 +42,12 @@
 #include <vector>
 #include <algorithm>   // for find
 #include <regex>
+#include <set>
+#if (LOMSE_ENABLE_THREADS == 1)
+    #include <thread>
+    #include <atomic>
+    #include <exception>
+#endif
 using namespace std;
 
 #define LOMSE_TRACE_GOBACK  0
@@ -225,8 +232,11 @@ TimeUnits MxlTimeKeeper::duration_to_time_units(long duration)
 {
     //AWARE: 'divisions' indicates how many divisions per quarter note
     //       and 'duration' is expressed in 'divisions'
-    float timeUnitsPerDivision = float(k_duration_quarter) / float(m_divisions);
-    return TimeUnits( float(duration) * timeUnitsPerDivision);
+    //The result is snapped to the nearest tick, so that times computed by adding
+    //durations do not accumulate rounding errors and can be compared exactly
+    TimeUnits units = TimeUnits(duration) * TimeUnits(k_duration_quarter)
+                      / TimeUnits(m_divisions);
+    return to_time_units( to_ticks(units) );
 }
 
 //---------------------------------------------------------------------------------------
@@ -1793,7 +1803,7 @@ bool MxlElementAnalyser::get_optional(const string& name)
     if (more_children_to_analyse())
     {
         m_childToAnalyse = get_child_to_analyse();
-        if (m_childToAnalyse.name() == name)
+        if (m_childToAnalyse.has_name(name))
         {
             move_to_next_child();
             return true;
@@ -2386,6 +2396,7 @@ public:
                 if (m_pAnalyser->staff_distance_is_imported(iStaff))
                     pInstr->mark_staff_margin_as_imported(iStaff);
             }
+            m_pAnalyser->first_staff_margin_replaced();
         }
 
         // part-symbol?
@@ -2495,6 +2506,8 @@ protected:
             ImoStaffInfo* pOldInfo = pInstr->get_staff(iStaff);
             pInfo->set_tablature( pOldInfo->is_for_tablature() );
             pInstr->replace_staff_info(pInfo);
+            if (iStaff == 0)
+                m_pAnalyser->first_staff_margin_replaced();
         }
     }
 };
@@ -5177,6 +5190,8 @@ public:
 
         // [<time-modification>]
         analyse_optional("time-modification", pNR);
+        if (!fIsGrace)
+            snap_to_exact_duration(pNR);
 
         // [<stem>]
         if (!fIsRest && get_optional("stem"))
@@ -5365,6 +5380,30 @@ protected:
         pNR->set_type_dots_duration(noteType, dots, units);
     }
 
+    //----------------------------------------------------------------------------------
+    void snap_to_exact_duration(ImoNoteRest* pNR)
+    {
+        //<duration> is rounded when the divisions can not represent the note duration
+        //(e.g. septuplets with divisions=480). Notes that should start at the same
+        //time would then be placed at different timepos. When the difference with the
+        //duration implied by <type>, <dot> and <time-modification> is lower than one
+        //division, the difference is a rounding error: use the exact duration
+        if (pNR->is_rest() && static_cast<ImoRest*>(pNR)->is_full_measure())
+            return;
+
+        TimeUnits exact = to_duration(pNR->get_note_type(), pNR->get_dots())
+                          * TimeUnits(pNR->get_time_modifier_top())
+                          / TimeUnits(pNR->get_time_modifier_bottom());
+        TimeUnits division = m_pAnalyser->duration_to_time_units(1L);
+        if (fabs(pNR->get_duration() - exact) < division)
+        {
+            int top = pNR->get_time_modifier_top();
+            int bottom = pNR->get_time_modifier_bottom();
+            pNR->set_type_dots_duration(pNR->get_note_type(), pNR->get_dots(), exact);
+            pNR->set_time_modifiers(top, bottom);
+        }
+    }
+
     //----------------------------------------------------------------------------------
     int set_staff(ImoNoteRest* pNR)
     {
@@ -5588,7 +5627,8 @@ public:
             error_msg("No <score-part> found for part id='" + id + "'. <part> content will be ignored.");
             return nullptr;
         }
-        if (m_pAnalyser->mark_part_as_added(id))
+        //in parallel import, parts are checked and marked by the main analyser
+        if (!m_pAnalyser->is_part_worker() && m_pAnalyser->mark_part_as_added(id))
         {
             error_msg("Duplicated <part> for part id='" + id + "'. <part> content will be ignored.");
             return nullptr;
@@ -5601,6 +5641,8 @@ public:
 
         // <measure>*
         while (analyse_optional("measure", pMD));
+        if (m_pAnalyser->is_streaming())
+            m_pAnalyser->analyse_streamed_measures(pMD);
 
         error_if_more_elements();
 
@@ -7002,13 +7044,20 @@ public:
             remove_score(pImoDoc, pScore);
             return pImoDoc;
         }
-        add_all_instruments(pScore);
 
         // <part>*
-        while (more_children_to_analyse())
+        if (m_pAnalyser->use_parallel_import() && !m_pAnalyser->is_streaming())
+            analyse_parts_in_parallel(pScore);
+        else
         {
-            if (!analyse_mandatory("part", pScore))
-                break;
+            add_all_instruments(pScore);
+            while (more_children_to_analyse())
+            {
+                if (!analyse_mandatory("part", pScore))
+                    break;
+            }
+            if (m_pAnalyser->is_streaming())
+                m_pAnalyser->analyse_streamed_parts(pScore);
         }
         error_if_more_elements();
 
@@ -7021,6 +7070,23 @@ public:
 
 protected:
 
+    void analyse_parts_in_parallel(ImoScore* pScore)
+    {
+        vector<XmlNode> parts;
+        while (get_optional("part"))
+            parts.push_back(m_childToAnalyse);
+
+        if (!m_pAnalyser->analyse_parts_in_parallel(parts, pScore))
+        {
+            add_all_instruments(pScore);
+            for (XmlNode& part : parts)
+                m_pAnalyser->analyse_node(&part, pScore);
+        }
+
+        if (more_children_to_analyse())
+            get_mandatory("part");
+    }
+
     ImoScore* create_score()
     {
         //add an empty score
@@ -9189,82 +9255,6 @@ MxlAnalyser::MxlAnalyser(ostream& reporter, LibraryScope& libraryScope, Document
     , m_measuresCounter(0)
     , m_curVoice(0)
 {
-    //populate the name to enum conversion map
-    m_NameToEnum["accordion-registration"] = k_mxl_tag_accordion_registration;
-    m_NameToEnum["arpeggiate"] = k_mxl_tag_arpeggiate;
-    m_NameToEnum["articulations"] = k_mxl_tag_articulations;
-    m_NameToEnum["attributes"] = k_mxl_tag_attributes;
-    m_NameToEnum["backup"] = k_mxl_tag_backup;
-    m_NameToEnum["barline"] = k_mxl_tag_barline;
-    m_NameToEnum["bracket"] = k_mxl_tag_bracket;
-    m_NameToEnum["clef"] = k_mxl_tag_clef;
-    m_NameToEnum["coda"] = k_mxl_tag_coda;
-    m_NameToEnum["damp"] = k_mxl_tag_damp;
-    m_NameToEnum["damp-all"] = k_mxl_tag_damp_all;
-    m_NameToEnum["dashes"] = k_mxl_tag_dashes;
-    m_NameToEnum["defaults"] = k_mxl_tag_defaults;
-    m_NameToEnum["direction"] = k_mxl_tag_direction;
-    m_NameToEnum["direction-type"] = k_mxl_tag_direction_type;
-    m_NameToEnum["dynamics"] = k_mxl_tag_dynamics;
-    m_NameToEnum["ending"] = k_mxl_tag_ending;
-    m_NameToEnum["eyeglasses"] = k_mxl_tag_eyeglasses;
-    m_NameToEnum["fermata"] = k_mxl_tag_fermata;
-    m_NameToEnum["fingering"] = k_mxl_tag_fingering;
-    m_NameToEnum["forward"] = k_mxl_tag_forward;
-    m_NameToEnum["fret"] = k_mxl_tag_fret;
-    m_NameToEnum["harp-pedals"] = k_mxl_tag_harp_pedals;
-    m_NameToEnum["image"] = k_mxl_tag_image;
-    m_NameToEnum["key"] = k_mxl_tag_key;
-    m_NameToEnum["lyric"] = k_mxl_tag_lyric;
-    m_NameToEnum["measure"] = k_mxl_tag_measure;
-    m_NameToEnum["metronome"] = k_mxl_tag_metronome;
-    m_NameToEnum["midi-device"] = k_mxl_tag_midi_device;
-    m_NameToEnum["midi-instrument"] = k_mxl_tag_midi_instrument;
-    m_NameToEnum["notations"] = k_mxl_tag_notations;
-    m_NameToEnum["note"] = k_mxl_tag_note;
-    m_NameToEnum["octave-shift"] = k_mxl_tag_octave_shift;
-    m_NameToEnum["ornaments"] = k_mxl_tag_ornaments;
-    m_NameToEnum["page-layout"] = k_mxl_tag_page_layout;
-    m_NameToEnum["page-margins"] = k_mxl_tag_page_margins;
-    m_NameToEnum["part"] = k_mxl_tag_part;
-    m_NameToEnum["part-group"] = k_mxl_tag_part_group;
-    m_NameToEnum["part-list"] = k_mxl_tag_part_list;
-    m_NameToEnum["part-name"] = k_mxl_tag_part_name;
-    m_NameToEnum["pedal"] = k_mxl_tag_pedal;
-    m_NameToEnum["percussion"] = k_mxl_tag_percussion;
-    m_NameToEnum["pitch"] = k_mxl_tag_pitch;
-    m_NameToEnum["principal-voice"] = k_mxl_tag_principal_voice;
-    m_NameToEnum["print"] = k_mxl_tag_print;
-    m_NameToEnum["rehearsal"] = k_mxl_tag_rehearsal;
-    m_NameToEnum["rest"] = k_mxl_tag_rest;
-    m_NameToEnum["scaling"] = k_mxl_tag_scaling;
-    m_NameToEnum["scordatura"] = k_mxl_tag_scordatura;
-    m_NameToEnum["score-instrument"] = k_mxl_tag_score_instrument;
-    m_NameToEnum["score-part"] = k_mxl_tag_score_part;
-    m_NameToEnum["score-partwise"] = k_mxl_tag_score_partwise;
-    m_NameToEnum["segno"] = k_mxl_tag_segno;
-    m_NameToEnum["slur"] = k_mxl_tag_slur;
-    m_NameToEnum["sound"] = k_mxl_tag_sound;
-    m_NameToEnum["string-mute"] = k_mxl_tag_string_mute;
-    m_NameToEnum["staff-details"] = k_mxl_tag_staff_details;
-    m_NameToEnum["staff-layout"] = k_mxl_tag_staff_layout;
-    m_NameToEnum["string"] = k_mxl_tag_string;
-    m_NameToEnum["system-layout"] = k_mxl_tag_system_layout;
-    m_NameToEnum["system-margins"] = k_mxl_tag_system_margins;
-    m_NameToEnum["technical"] = k_mxl_tag_technical;
-    m_NameToEnum["text"] = k_mxl_tag_text;
-    m_NameToEnum["tied"] = k_mxl_tag_tied;
-    m_NameToEnum["time"] = k_mxl_tag_time;
-    m_NameToEnum["time-modification"] = k_mxl_tag_time_modification;
-    m_NameToEnum["transpose"] = k_mxl_tag_transpose;
-    m_NameToEnum["tuplet"] = k_mxl_tag_tuplet;
-    m_NameToEnum["tuplet-actual"] = k_mxl_tag_tuplet_actual;
-    m_NameToEnum["tuplet-normal"] = k_mxl_tag_tuplet_normal;
-    m_NameToEnum["unpitched"] = k_mxl_tag_unpitched;
-    m_NameToEnum["virtual-instrument"] = k_mxl_tag_virtual_instr;
-    m_NameToEnum["wedge"] = k_mxl_tag_wedge;
-    m_NameToEnum["words"] = k_mxl_tag_words;
-
     m_notes.assign(50, nullptr);
 }
 
@@ -9273,7 +9263,6 @@ MxlAnalyser::~MxlAnalyser()
 {
     delete m_pArpeggioDto;
     delete_relation_builders();
-    m_NameToEnum.clear();
     m_lyrics.clear();
     m_lyricIndex.clear();
     m_staffDistance.clear();
@@ -9282,6 +9271,9 @@ MxlAnalyser::~MxlAnalyser()
 
     delete m_pMusicFont;
     delete m_pWordFont;
+
+    delete m_pPartParser;
+    delete m_pMeasureParser;
 }
 
 //---------------------------------------------------------------------------------------
@@ -9298,7 +9290,7 @@ void MxlAnalyser::delete_relation_builders()
 }
 
 //---------------------------------------------------------------------------------------
-ImoObj* MxlAnalyser::analyse_tree_and_get_object(XmlNode* root)
+void MxlAnalyser::create_relation_builders()
 {
     delete_relation_builders();
     m_pTiesBuilder = LOMSE_NEW MxlTiesBuilder(m_reporter, this);
@@ -9309,6 +9301,12 @@ ImoObj* MxlAnalyser::analyse_tree_and_get_object(XmlNode* root)
     m_pWedgesBuilder = LOMSE_NEW MxlWedgesBuilder(m_reporter, this);
     m_pOctaveShiftBuilder = LOMSE_NEW MxlOctaveShiftBuilder(m_reporter, this);
     m_pPedalBuilder = LOMSE_NEW MxlPedalBuilder(m_reporter, this);
+}
+
+//---------------------------------------------------------------------------------------
+ImoObj* MxlAnalyser::analyse_tree_and_get_object(XmlNode* root)
+{
+    create_relation_builders();
 
     m_pTree = root;
 //    m_curStaff = 0;
@@ -9319,15 +9317,388 @@ ImoObj* MxlAnalyser::analyse_tree_and_get_object(XmlNode* root)
 //---------------------------------------------------------------------------------------
 ImoObj* MxlAnalyser::analyse_tree(XmlNode* tree, const string& locator)
 {
+    ImportPhase phase(ImportStats::k_import_analyse);
     m_fileLocator = locator;
     return analyse_tree_and_get_object(tree);
 }
 
+//---------------------------------------------------------------------------------------
+ImoObj* MxlAnalyser::analyse_stream(XmlStreamReader* pReader, const string& locator)
+{
+    //Streaming import. Only the score header (all elements before the first <part>)
+    //is loaded as a tree. Then, each <measure> is read, parsed, analysed and released
+    //before reading the next one. The analysis of the header tree continues in
+    //analyse_streamed_parts(), invoked from ScorePartwiseMxlAnalyser.
+
+    ImportPhase phase(ImportStats::k_import_analyse);
+    m_fileLocator = locator;
+
+    //read header
+    string header;
+    string rootName;
+    bool fPartFound = false;
+    while (true)
+    {
+        int type = pReader->next_markup();
+        if (type == XmlStreamReader::k_eof || type == XmlStreamReader::k_error)
+        {
+            header += pReader->get_markup_text();
+            break;
+        }
+        if (type == XmlStreamReader::k_start_tag || type == XmlStreamReader::k_empty_tag)
+        {
+            if (pReader->get_depth() == 1)
+                rootName = pReader->get_name();
+            else if (pReader->get_depth() == 2 && rootName == "score-partwise"
+                     && pReader->get_name() == "part")
+            {
+                fPartFound = true;
+                break;
+            }
+        }
+        header += pReader->get_markup_text();
+    }
+
+    //parse the header. When no <part> element, the header is the whole document
+    if (fPartFound)
+        m_pParser->parse_chunk(header + "</" + rootName + ">", 1);
+    else
+        m_pParser->parse_chunk(header, 1);
+
+    //chunks are parsed as utf-8. For other encodings, fall back to a full tree
+    string encoding = m_pParser->get_encoding();
+    std::transform(encoding.begin(), encoding.end(), encoding.begin(), ::tolower);
+    if (fPartFound && encoding != "unknown" && encoding != "utf-8" && encoding != "utf8")
+    {
+        header += pReader->get_markup_text();
+        header += pReader->read_remaining();
+        m_pParser->parse_chunk(header, 1);
+        fPartFound = false;
+    }
+    header.clear();
+    header.shrink_to_fit();
+
+    if (!fPartFound)
+        return analyse_tree(m_pParser->get_tree_root(), locator);
+
+    m_pStream = pReader;
+    m_pPartParser = LOMSE_NEW XmlParser(m_reporter);
+    m_pMeasureParser = LOMSE_NEW XmlParser(m_reporter);
+
+    ImoObj* pImo = analyse_tree(m_pParser->get_tree_root(), locator);
+
+    m_pStream = nullptr;
+    delete m_pPartParser;
+    m_pPartParser = nullptr;
+    delete m_pMeasureParser;
+    m_pMeasureParser = nullptr;
+
+    return pImo;
+}
+
+//---------------------------------------------------------------------------------------
+void MxlAnalyser::analyse_streamed_parts(ImoScore* pScore)
+{
+    //AWARE: the stream is positioned just after the first <part> start tag
+
+    int type = m_pStream->get_type();
+    while (true)
+    {
+        if (type == XmlStreamReader::k_eof)
+            break;
+
+        if (type == XmlStreamReader::k_error)
+        {
+            m_reporter << "Line " << m_pStream->get_tag_line()
+                       << ". Malformed XML or unexpected end of data. Analysis stopped."
+                       << endl;
+            break;
+        }
+
+        //end of <score-partwise>
+        if (type == XmlStreamReader::k_end_tag && m_pStream->get_depth() == 1)
+            break;
+
+        if ((type == XmlStreamReader::k_start_tag || type == XmlStreamReader::k_empty_tag)
+            && m_pStream->get_depth() == 2)
+        {
+            if (m_pStream->get_name() == "part")
+                analyse_streamed_part(pScore);
+            else
+            {
+                report_streamed_element_ignored("score-partwise");
+                m_pStream->skip_element();
+            }
+        }
+
+        type = m_pStream->next_markup();
+    }
+}
+
+//---------------------------------------------------------------------------------------
+void MxlAnalyser::analyse_streamed_part(ImoScore* pScore)
+{
+    //The <part> start tag is parsed and analysed as an empty element. Its content
+    //is streamed from analyse_streamed_measures(), invoked from PartMxlAnalyser.
+
+    bool fEmpty = (m_pStream->get_type() == XmlStreamReader::k_empty_tag);
+    string text = m_pStream->get_tag();
+    if (!fEmpty)
+        text += "</part>";
+    m_pPartParser->parse_chunk(text, m_pStream->get_tag_line());
+
+    m_fPartContentPending = !fEmpty;
+    analyse_node(m_pPartParser->get_tree_root(), pScore);
+
+    //skip <part> content when not analysed (i.e., errors in <part> attributes)
+    if (m_fPartContentPending)
+    {
+        m_fPartContentPending = false;
+        m_pStream->skip_element();
+    }
+
+    m_pPartParser->clear();
+}
+
+//---------------------------------------------------------------------------------------
+void MxlAnalyser::analyse_streamed_measures(ImoMusicData* pMD)
+{
+    if (!m_fPartContentPending)
+        return;
+    m_fPartContentPending = false;
+
+    string text;
+    while (true)
+    {
+        int type = m_pStream->next_markup();
+        if (type == XmlStreamReader::k_eof || type == XmlStreamReader::k_error)
+        {
+            m_reporter << "Line " << m_pStream->get_tag_line()
+                       << ". Malformed XML or unexpected end of data in <part>."
+                       << endl;
+            return;
+        }
+
+        //end of <part>
+        if (type == XmlStreamReader::k_end_tag)
+            return;
+
+        if (type == XmlStreamReader::k_start_tag || type == XmlStreamReader::k_empty_tag)
+        {
+            if (m_pStream->get_name() != "measure")
+            {
+                report_streamed_element_ignored("part");
+                m_pStream->skip_element();
+                continue;
+            }
+
+            int line = m_pStream->get_tag_line();
+            if (type == XmlStreamReader::k_empty_tag)
+                text = m_pStream->get_tag();
+            else if (!m_pStream->read_element(&text))
+            {
+                m_reporter << "Line " << line
+                           << ". <measure> not properly closed. Ignored." << endl;
+                return;
+            }
+
+            m_pMeasureParser->parse_chunk(text, line);
+            analyse_node(m_pMeasureParser->get_tree_root(), pMD);
+            m_pMeasureParser->clear();
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------
+void MxlAnalyser::report_streamed_element_ignored(const string& parent)
+{
+    m_reporter << "Line " << m_pStream->get_tag_line() << ". Element <" << parent
+               << ">: element '" << m_pStream->get_name()
+               << "' unknown or not possible here. Ignored." << endl;
+}
+
+//---------------------------------------------------------------------------------------
+bool MxlAnalyser::analyse_parts_in_parallel(vector<XmlNode>& parts, ImoScore* pScore)
+{
+    //Parallel import. Each <part> is analysed by a worker MxlAnalyser, in a pool of
+    //threads. Returns false, without analysing any part, when parallel analysis is not
+    //possible.
+    //
+    //Threads and shared data:
+    //- Main thread, before the workers start: all the score level elements
+    //  (<part-list>, <defaults>, <credit>, etc.) are already analysed, so all
+    //  mutations of the ImoScore (styles, options, lyric languages, scaling, groups)
+    //  are done. The instruments are created but not yet added to the score. Lazy
+    //  initialized shared data is created here.
+    //- Workers: each one only modifies the subtree of its ImoInstrument and its own
+    //  MxlAnalyser. As the instrument is not in the score, dirty marks are not
+    //  propagated to the score. The ImoScore is only read (tenths_to_logical(),
+    //  find_style(), get_default_style()) and never modified. In the shared DocModel,
+    //  the ids tables and the xml ids are protected by the ids mutex, and dirty marks
+    //  are not recorded while importing (DocModel::on_dirty_marks_set() only reads
+    //  a flag). Ids are taken from an ids stream for each part (IdsStreamScope), so
+    //  that they do not depend on threads scheduling.
+    //- Main thread, after joining the workers: instruments are added to the score and
+    //  the pending cross-part information is resolved, in parts order.
+
+#if (LOMSE_ENABLE_THREADS == 1)
+    if (!parts_can_be_analysed_in_parallel(parts))
+        return false;
+
+    //lazy initialized shared data must be ready before starting the workers
+    for (XmlNode& part : parts)
+        mark_part_as_added(part.attribute_value("id"));
+    get_line_number(&parts.front());
+    pScore->get_default_style();
+    ImoObj::get_name(k_imo_note_regular);
+
+    size_t numParts = parts.size();
+    vector<stringstream*> reporters(numParts, nullptr);
+    vector<MxlAnalyser*> workers(numParts, nullptr);
+    vector<exception_ptr> errors(numParts);
+    for (size_t i=0; i < numParts; ++i)
+    {
+        reporters[i] = LOMSE_NEW stringstream();
+        workers[i] = LOMSE_NEW MxlAnalyser(*reporters[i], m_libraryScope, m_pDoc, m_pParser);
+        workers[i]->prepare_as_part_worker(this);
+    }
+
+    DocModel* pModel = m_pDoc->get_doc_model();
+    pModel->enable_concurrent_ids_access(true);
+    ImoId baseId = pModel->get_last_assigned_id();
+
+    //node pools can not be shared by threads. Workers allocate in the heap
+    NodePoolScope noPool(nullptr);
+
+    atomic<size_t> nextPart(0);
+    auto work = [&]()
+    {
+        size_t i;
+        while ((i = nextPart++) < numParts)
+        {
+            try
+            {
+                IdsStreamScope ids(pModel, baseId, int(i), int(numParts));
+                workers[i]->analyse_node(&parts[i], pScore);
+            }
+            catch (...)
+            {
+                errors[i] = current_exception();
+            }
+        }
+    };
+
+    size_t numThreads = min(numParts, size_t(max(1u, thread::hardware_concurrency())));
+    vector<thread> threads;
+    for (size_t i=1; i < numThreads; ++i)
+        threads.push_back(thread(work));
+    work();     //this thread is also a worker
+    for (thread& t : threads)
+        t.join();
+
+    pModel->enable_concurrent_ids_access(false);
+
+    //merge results
+    add_all_instruments(pScore);
+    int numInstrs = pScore->get_num_instruments();
+    vector<size_t> instrToPart(numInstrs, numParts);
+    for (size_t i=0; i < numParts; ++i)
+    {
+        ImoInstrument* pInstr = get_instrument(parts[i].attribute_value("id"));
+        instrToPart[pScore->get_instr_number_for(pInstr)] = i;
+    }
+    m_measuresCounter = workers.back()->m_measuresCounter;
+
+    exception_ptr error;
+    for (size_t i=0; i < numParts; ++i)
+    {
+        //space for lyrics in next instrument. As in sequential analysis, it is lost
+        //when the <part> for next instrument is analysed later and replaces the margin
+        ImoInstrument* pInstr = get_instrument(parts[i].attribute_value("id"));
+        int iInstr = pScore->get_instr_number_for(pInstr) + 1;
+        if (iInstr < numInstrs)
+        {
+            size_t iNext = instrToPart[iInstr];
+            if (iNext < i || iNext == numParts || !workers[iNext]->m_fFirstStaffMarginReplaced)
+            {
+                for (LUnits space : workers[i]->m_nextInstrLyricsSpace)
+                    pScore->get_instrument(iInstr)->reserve_space_for_lyrics(0, space);
+            }
+        }
+
+        //AWARE: worker must be deleted before transferring its messages, as pending
+        //relations are reported when the worker is deleted
+        delete workers[i];
+        m_reporter << reporters[i]->str();
+        delete reporters[i];
+
+        if (errors[i] && !error)
+            error = errors[i];
+    }
+
+    if (error)
+        rethrow_exception(error);
+
+    return true;
+
+#else
+    (void)parts;
+    (void)pScore;
+    return false;
+#endif
+}
+
+//---------------------------------------------------------------------------------------
+bool MxlAnalyser::parts_can_be_analysed_in_parallel(vector<XmlNode>& parts)
+{
+    //All parts must be valid. Otherwise, sequential analysis is used so that errors
+    //are reported and managed as usual
+    if (parts.size() < 2)
+        return false;
+
+    set<string> ids;
+    for (XmlNode& part : parts)
+    {
+        string id = part.attribute_value("id");
+        if (id.empty() || get_instrument(id) == nullptr || !ids.insert(id).second)
+            return false;
+    }
+    return true;
+}
+
+//---------------------------------------------------------------------------------------
+void MxlAnalyser::prepare_as_part_worker(MxlAnalyser* pMain)
+{
+    //copy the score level information required for analysing a <part>
+
+    m_pMainAnalyser = pMain;
+    m_musicxmlVersion = pMain->m_musicxmlVersion;
+    m_fileLocator = pMain->m_fileLocator;
+    m_pTree = pMain->m_pTree;
+    m_pCurScore = pMain->m_pCurScore;
+    m_pImoDoc = pMain->m_pImoDoc;
+
+    if (pMain->m_pMusicFont)
+        m_pMusicFont = LOMSE_NEW ImoFontStyleDto(*(pMain->m_pMusicFont));
+    if (pMain->m_pWordFont)
+        m_pWordFont = LOMSE_NEW ImoFontStyleDto(*(pMain->m_pWordFont));
+    m_lyricStyle = pMain->m_lyricStyle;
+    m_lyricLang = pMain->m_lyricLang;
+
+    m_soundIdToIdx = pMain->m_soundIdToIdx;
+    m_latestMidiInfo = pMain->m_latestMidiInfo;
+
+    m_defaultStaffDistance = pMain->m_defaultStaffDistance;
+    m_fDefaultStaffDistanceForAllStaves = pMain->m_fDefaultStaffDistanceForAllStaves;
+
+    create_relation_builders();
+}
+
 //---------------------------------------------------------------------------------------
 ImoObj* MxlAnalyser::analyse_node(XmlNode* pNode, ImoObj* pAnchor)
 {
     //m_reporter << "DBG. Analysing node: " << pNode->name() << endl;
-    MxlElementAnalyser* a = new_analyser( pNode->name(), pAnchor );
+    MxlElementAnalyser* a = new_analyser( pNode->name_cstr(), pAnchor );
     ImoObj* pImo = a->analyse_node(pNode);
     delete a;
     return pImo;
@@ -9336,7 +9707,7 @@ ImoObj* MxlAnalyser::analyse_node(XmlNode* pNode, ImoObj* pAnchor)
 //---------------------------------------------------------------------------------------
 bool MxlAnalyser::analyse_node_bool(XmlNode* pNode, ImoObj* pAnchor)
 {
-    MxlElementAnalyser* a = new_analyser( pNode->name(), pAnchor );
+    MxlElementAnalyser* a = new_analyser( pNode->name_cstr(), pAnchor );
     bool value = a->analyse_node_bool(pNode);
     delete a;
     return value;
@@ -9345,6 +9716,13 @@ bool MxlAnalyser::analyse_node_bool(XmlNode* pNode, ImoObj* pAnchor)
 //---------------------------------------------------------------------------------------
 int MxlAnalyser::get_line_number(XmlNode* node)
 {
+    if (m_pStream)
+    {
+        if (m_pMeasureParser->is_node_in_tree(node))
+            return m_pMeasureParser->get_line_number(node);
+        if (m_pPartParser->is_node_in_tree(node))
+            return m_pPartParser->get_line_number(node);
+    }
     return m_pParser->get_line_number(node);
 }
 
@@ -9355,6 +9733,8 @@ void MxlAnalyser::prepare_for_new_instrument_content()
     m_timeKeeper.full_reset();
     save_last_barline(nullptr);
     m_measuresCounter = 0;
+    m_curVoice = 0;
+    m_fWaitingForVoice = false;
     clear_staff_distances();
 }
 
@@ -9908,6 +10288,12 @@ void MxlAnalyser::add_marging_space_for_lyrics(ImoNote* pNote, ImoLyric* pLyric)
         {
             //add space to top margin of first staff in next instrument
             //AWARE: All instruments are already created
+            if (is_part_worker())
+            {
+                //next instrument could be in analysis: postpone until merging parts
+                m_nextInstrLyricsSpace.push_back(space);
+                return;
+            }
             int iInstr = m_pCurScore->get_instr_number_for(pInstr) + 1;
             if (iInstr < m_pCurScore->get_num_instruments())
             {
@@ -10151,7 +10537,7 @@ bool MxlAnalyser::to_integer(const string& text, int* pResult)
 }
 
 //---------------------------------------------------------------------------------------
-MxlElementAnalyser* MxlAnalyser::new_analyser(const string& name, ImoObj* pAnchor)
+MxlElementAnalyser* MxlAnalyser::new_analyser(const char* name, ImoObj* pAnchor)
 {
     //Factory method to create analysers
 
@@ -10237,13 +10623,98 @@ MxlElementAnalyser* MxlAnalyser::new_analyser(const string& name, ImoObj* pAncho
 }
 
 //---------------------------------------------------------------------------------------
-int MxlAnalyser::name_to_enum(const string& name) const
+// conversion from MusicXML element name to EMxlTag
+static const XmlTagsTable::Entry k_mxl_tags[] =
+{
+    { "accordion-registration",    k_mxl_tag_accordion_registration },
+    { "arpeggiate",                k_mxl_tag_arpeggiate },
+    { "articulations",             k_mxl_tag_articulations },
+    { "attributes",                k_mxl_tag_attributes },
+    { "backup",                    k_mxl_tag_backup },
+    { "barline",                   k_mxl_tag_barline },
+    { "bracket",                   k_mxl_tag_bracket },
+    { "clef",                      k_mxl_tag_clef },
+    { "coda",                      k_mxl_tag_coda },
+    { "damp",                      k_mxl_tag_damp },
+    { "damp-all",                  k_mxl_tag_damp_all },
+    { "dashes",                    k_mxl_tag_dashes },
+    { "defaults",                  k_mxl_tag_defaults },
+    { "direction",                 k_mxl_tag_direction },
+    { "direction-type",            k_mxl_tag_direction_type },
+    { "dynamics",                  k_mxl_tag_dynamics },
+    { "ending",                    k_mxl_tag_ending },
+    { "eyeglasses",                k_mxl_tag_eyeglasses },
+    { "fermata",                   k_mxl_tag_fermata },
+    { "fingering",                 k_mxl_tag_fingering },
+    { "forward",                   k_mxl_tag_forward },
+    { "fret",                      k_mxl_tag_fret },
+    { "harp-pedals",               k_mxl_tag_harp_pedals },
+    { "image",                     k_mxl_tag_image },
+    { "key",                       k_mxl_tag_key },
+    { "lyric",                     k_mxl_tag_lyric },
+    { "measure",                   k_mxl_tag_measure },
+    { "metronome",                 k_mxl_tag_metronome },
+    { "midi-device",               k_mxl_tag_midi_device },
+    { "midi-instrument",           k_mxl_tag_midi_instrument },
+    { "notations",                 k_mxl_tag_notations },
+    { "note",                      k_mxl_tag_note },
+    { "octave-shift",              k_mxl_tag_octave_shift },
+    { "ornaments",                 k_mxl_tag_ornaments },
+    { "page-layout",               k_mxl_tag_page_layout },
+    { "page-margins",              k_mxl_tag_page_margins },
+    { "part",                      k_mxl_tag_part },
+    { "part-group",                k_mxl_tag_part_group },
+    { "part-list",                 k_mxl_tag_part_list },
+    { "part-name",                 k_mxl_tag_part_name },
+    { "pedal",                     k_mxl_tag_pedal },
+    { "percussion",                k_mxl_tag_percussion },
+    { "pitch",                     k_mxl_tag_pitch },
+    { "principal-voice",           k_mxl_tag_principal_voice },
+    { "print",                     k_mxl_tag_print },
+    { "rehearsal",                 k_mxl_tag_rehearsal },
+    { "rest",                      k_mxl_tag_rest },
+    { "scaling",                   k_mxl_tag_scaling },
+    { "scordatura",                k_mxl_tag_scordatura },
+    { "score-instrument",          k_mxl_tag_score_instrument },
+    { "score-part",                k_mxl_tag_score_part },
+    { "score-partwise",            k_mxl_tag_score_partwise },
+    { "segno",                     k_mxl_tag_segno },
+    { "slur",                      k_mxl_tag_slur },
+    { "sound",                     k_mxl_tag_sound },
+    { "string-mute",               k_mxl_tag_string_mute },
+    { "staff-details",             k_mxl_tag_staff_details },
+    { "staff-layout",              k_mxl_tag_staff_layout },
+    { "string",                    k_mxl_tag_string },
+    { "system-layout",             k_mxl_tag_system_layout },
+    { "system-margins",            k_mxl_tag_system_margins },
+    { "technical",                 k_mxl_tag_technical },
+    { "text",                      k_mxl_tag_text },
+    { "tied",                      k_mxl_tag_tied },
+    { "time",                      k_mxl_tag_time },
+    { "time-modification",         k_mxl_tag_time_modification },
+    { "transpose",                 k_mxl_tag_transpose },
+    { "tuplet",                    k_mxl_tag_tuplet },
+    { "tuplet-actual",             k_mxl_tag_tuplet_actual },
+    { "tuplet-normal",             k_mxl_tag_tuplet_normal },
+    { "unpitched",                 k_mxl_tag_unpitched },
+    { "virtual-instrument",        k_mxl_tag_virtual_instr },
+    { "wedge",                     k_mxl_tag_wedge },
+    { "words",                     k_mxl_tag_words },
+};
+
+//---------------------------------------------------------------------------------------
+const XmlTagsTable& MxlAnalyser::get_tags_table()
 {
-	map<string, int>::const_iterator it = m_NameToEnum.find(name);
-	if (it != m_NameToEnum.end())
-		return it->second;
-    else
-        return k_mxl_tag_undefined;
+    //hints: seed and size found by XmlTagsTable. Update them when modifying the names
+    static const XmlTagsTable table(k_mxl_tags, sizeof(k_mxl_tags) / sizeof(k_mxl_tags[0]),
+                                    k_mxl_tag_undefined, 138u, 512);
+    return table;
+}
+
+//---------------------------------------------------------------------------------------
+int MxlAnalyser::name_to_enum(const char* name) const
+{
+    return get_tags_table().get_tag(name);
 }
 
 
@@ -10,6 +10,7 @@
 #include "lomse_mxl_compiler.h"
 
 #include <sstream>
+#include <fstream>
 #include "lomse_xml_parser.h"
 #include "lomse_mxl_analyser.h"
 #include "lomse_model_builder.h"
@@ -18,6 +19,8 @@
 #include "private/lomse_document_p.h"
 #include "lomse_file_system.h"
 #include "lomse_ldp_compiler.h"
+#include "lomse_import_stats.h"
+#include "lomse_logger.h"
 
 #if (LOMSE_ENABLE_COMPRESSION == 1)
 	#include "lomse_zip_stream.h"
@@ -69,16 +72,15 @@ ImoDocument* MxlCompiler::compile_file(const std::string& filename)
 #if (LOMSE_ENABLE_COMPRESSION == 1)
         InputStream* pFile = FileSystem::open_input_stream(m_fileLocator);
         ZipInputStream* zip  = static_cast<ZipInputStream*>(pFile);
-
-        unsigned char* buffer = zip->get_as_string();
-        m_pXmlParser->parse_cstring( (char *)buffer );
-
+        ImoDocument* pDoc = compile_zip_entry(*zip);
         delete pFile;
-        delete[] buffer;
+        return pDoc;
 #else
 		throw runtime_error("Could not open compressed file: Lomse was compiled without compression support");
 #endif
     }
+    else if (m_pMxlAnalyser->use_streaming_import())
+        return compile_streamed_file(filename);
     else //k_file
         m_pParser->parse_file(filename);
 
@@ -105,6 +107,101 @@ ImoDocument* MxlCompiler::compile_buffer(const void* buffer, size_t size)
     return compile_parsed_tree( m_pXmlParser->get_tree_root() );
 }
 
+//---------------------------------------------------------------------------------------
+ImoDocument* MxlCompiler::compile_stream(std::istream& stream)
+{
+    m_fileLocator = "string:";
+    return compile_from_stream(stream);
+}
+
+//---------------------------------------------------------------------------------------
+//Max. size accepted for an uncompressed entry when it must be loaded in memory. The
+//size is taken from the zip headers, so it can not be trusted
+const size_t k_max_zip_entry_size = 256 * 1024 * 1024;
+
+//---------------------------------------------------------------------------------------
+ImoDocument* MxlCompiler::compile_zip_entry(ZipInputStream& zip)
+{
+#if (LOMSE_ENABLE_COMPRESSION == 1)
+    if (m_pMxlAnalyser->use_streaming_import())
+    {
+        ZipEntryStreamBuf buf(zip);
+        std::istream stream(&buf);
+        return compile_from_stream(stream);
+    }
+
+    //the whole entry is required for building the DOM. Inflate it directly into
+    //a buffer owned by the parser, to avoid an intermediate copy
+    long entrySize = (zip.is_open() ? zip.get_size() : 0L);
+    if (entrySize < 0 || size_t(entrySize) > k_max_zip_entry_size)
+    {
+        LOMSE_LOG_ERROR("Zip entry too big (%ld bytes). Max. size is %zu bytes",
+                        entrySize, k_max_zip_entry_size);
+        return nullptr;
+    }
+
+    size_t size = size_t(entrySize);
+    void* buffer = XmlParser::allocate_buffer(size + 1);
+    if (!buffer)
+    {
+        LOMSE_LOG_ERROR("Not enough memory for loading zip entry (%zu bytes)", size);
+        return nullptr;
+    }
+
+    long bytes = 0;
+    {
+        ImportPhase phase(ImportStats::k_import_read);
+        if (size > 0 && !zip.eof())
+            bytes = zip.read(static_cast<unsigned char*>(buffer), entrySize);
+    }
+    if (bytes != entrySize)
+    {
+        LOMSE_LOG_ERROR("Error reading zip entry. Expected %zu bytes but %ld read",
+                        size, bytes);
+        XmlParser::free_buffer(buffer);
+        return nullptr;
+    }
+    m_pXmlParser->parse_owned_buffer(buffer, size);
+
+    XmlNode* root = m_pXmlParser->get_tree_root();
+    if (root)
+        return compile_parsed_tree(root);
+    else
+        return nullptr;
+#else
+    (void)zip;
+    throw runtime_error("Could not open compressed file: Lomse was compiled without compression support");
+#endif
+}
+
+//---------------------------------------------------------------------------------------
+ImoDocument* MxlCompiler::compile_from_stream(std::istream& stream)
+{
+    //The source is read, parsed and analysed measure by measure, without loading
+    //it in memory as a whole
+
+    XmlStreamReader reader(stream);
+    ImoDocument* pDoc = dynamic_cast<ImoDocument*>(
+                            m_pMxlAnalyser->analyse_stream(&reader, m_fileLocator));
+    if (pDoc)
+        m_pModelBuilder->build_model(pDoc);
+    return pDoc;
+}
+
+//---------------------------------------------------------------------------------------
+ImoDocument* MxlCompiler::compile_streamed_file(const std::string& filename)
+{
+    std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+    if (!file.is_open())
+    {
+        //let the parser report the error
+        m_pParser->parse_file(filename);
+        return compile_parsed_tree( m_pXmlParser->get_tree_root() );
+    }
+
+    return compile_from_stream(file);
+}
+
 //---------------------------------------------------------------------------------------
 ImoDocument* MxlCompiler::compile_parsed_tree(XmlNode* root)
 {
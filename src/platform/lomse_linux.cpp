@@ -43,12 +43,12 @@ std::string Logger::get_default_log_path()
 
 
 //=======================================================================================
-// FontSelector::find_font implementation for Linux
+// FontSelector::find_platform_font implementation for Linux
 //=======================================================================================
-std::string FontSelector::find_font(const std::string& language,
-                                    const std::string& UNUSED(fontFile),
-                                    const std::string& name,
-                                    bool fBold, bool fItalic)
+std::string FontSelector::find_platform_font(const std::string& language,
+                                             const std::string& UNUSED(fontFile),
+                                             const std::string& name,
+                                             bool fBold, bool fItalic)
 {
     //search in cache
     string key=language + name + (fBold ? "1" : "0") + (fItalic ? "1" : "0");
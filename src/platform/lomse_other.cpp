@@ -29,12 +29,12 @@ std::string Logger::get_default_log_path()
 }
 
 //=======================================================================================
-// FontSelector::find_font implementation for other Operating Systems
+// FontSelector::find_platform_font implementation for other Operating Systems
 //=======================================================================================
-std::string FontSelector::find_font(const std::string& language,
-                                    const std::string& fontFile,
-                                    const std::string& name,
-                                    bool fBold, bool fItalic)
+std::string FontSelector::find_platform_font(const std::string& language,
+                                             const std::string& fontFile,
+                                             const std::string& name,
+                                             bool fBold, bool fItalic)
 {
     //Priority is given to font file.
     //For generic families (i.e.: sans, serif, monospace, ...) priority is given to
@@ -22,6 +22,7 @@
 #include "lomse_build_options.h"
 #include "lomse_logger.h"
 
+#include <atomic>
 #include <locale>   //to upper conversion
 using namespace agg;
 
@@ -33,16 +34,10 @@ namespace lomse
 // FontStorage implementation
 //=======================================================================================
 FontStorage::FontStorage(LibraryScope* pLibScope)
-    : m_fontEngine(1000)        //1000 = number of faces in cache
-    , m_fontCacheManager(m_fontEngine)
-    , m_pLibScope(pLibScope)
-    , m_fontHeight(14.0)
-    , m_fontWidth(14.0)
+    : m_pLibScope(pLibScope)
     , m_fHinting(false)
-    , m_fValidFont(false)
     , m_fKerning(true)
     , m_fFlip_y(true)
-    , m_fontCacheType(k_raster_font_cache)
 {
     //AWARE:
     //Apple Computer, Inc., owns three patents that are related to the
@@ -54,35 +49,107 @@ FontStorage::FontStorage(LibraryScope* pLibScope)
     //and, so, previous flag value doesn't matter. But its value is important
     //if I finally use FreeType for all fonts.
 
+    static std::atomic<unsigned long> counter(0);
+    m_serial = ++counter;
+
+    //load music font for the creating thread
+    fonts();
+}
+
+//---------------------------------------------------------------------------------------
+FontStorage::~FontStorage()
+{
+#if (LOMSE_ENABLE_THREADS == 1)
+    for (auto& item : m_engines)
+        delete item.second;
+#else
+    delete m_pEngine;
+#endif
+}
+
+//---------------------------------------------------------------------------------------
+FontEngineState& FontStorage::fonts()
+{
+#if (LOMSE_ENABLE_THREADS == 1)
+    //fast path: the engine for this FontStorage was the last one used by this thread.
+    //AWARE: the serial number is used instead of the FontStorage address, as the
+    //address of a deleted FontStorage could be reused
+    static thread_local unsigned long lastSerial = 0;
+    static thread_local FontEngineState* pLastEngine = nullptr;
+    if (lastSerial == m_serial)
+        return *pLastEngine;
+
+    FontEngineState* pEngine;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        FontEngineState*& pSlot = m_engines[std::this_thread::get_id()];
+        if (!pSlot)
+            pSlot = create_font_engine();
+        pEngine = pSlot;
+    }
+
+    lastSerial = m_serial;
+    pLastEngine = pEngine;
+    return *pEngine;
+#else
+    if (!m_pEngine)
+        m_pEngine = create_font_engine();
+    return *m_pEngine;
+#endif
+}
+
+//---------------------------------------------------------------------------------------
+FontEngineState* FontStorage::create_font_engine()
+{
+    FontEngineState* pEngine = LOMSE_NEW FontEngineState();
+
     //font settings
-    unsigned ppi = unsigned(pLibScope->get_screen_ppi());
-    m_fontEngine.resolution(ppi);
-    m_fontEngine.gamma(agg::gamma_none());
-    m_fontEngine.hinting(m_fHinting);
-    m_fontEngine.flip_y(m_fFlip_y);
+    unsigned ppi = unsigned(m_pLibScope->get_screen_ppi());
+    pEngine->fontEngine.resolution(ppi);
+    pEngine->fontEngine.gamma(agg::gamma_none());
+    pEngine->fontEngine.hinting(m_fHinting);
+    pEngine->fontEngine.flip_y(m_fFlip_y);
 
     //load music font
     string fullname = m_pLibScope->get_music_font_path();
     fullname += m_pLibScope->get_music_font_file();
-    set_font(fullname, 24.0);
+    lomse::glyph_rendering gren = lomse::glyph_ren_agg_gray8;
+    if (pEngine->fontEngine.select_font(fullname, 0, gren))
+    {
+        pEngine->fontHeight = 24.0;
+        pEngine->fontWidth = 24.0;
+        pEngine->fontEngine.height(24.0);
+        pEngine->fontEngine.width(24.0);
+        pEngine->fValidFont = true;
+        pEngine->fontFullName = fullname;
+    }
+
+    return pEngine;
 }
 
 //---------------------------------------------------------------------------------------
-FontStorage::~FontStorage()
+int FontStorage::get_num_font_engines()
 {
+#if (LOMSE_ENABLE_THREADS == 1)
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return int(m_engines.size());
+#else
+    return (m_pEngine ? 1 : 0);
+#endif
 }
 
 //---------------------------------------------------------------------------------------
 bool FontStorage::set_font(const std::string& fontFullName, double height,
                            EFontCacheType type)
 {
-    m_fValidFont = false;
+    FontEngineState& f = fonts();
+    f.fValidFont = false;
     lomse::glyph_rendering gren = lomse::glyph_ren_agg_gray8;
-    if(! m_fontEngine.select_font(fontFullName, 0, gren))
-        return !m_fValidFont;    //error
+    if(! f.fontEngine.select_font(fontFullName, 0, gren))
+        return !f.fValidFont;    //error
 
     //set curren values for renderization
-    m_fontCacheType = type;
+    f.fontCacheType = type;
     set_font_size(height);
 
     ////un-comment this to rotate/skew/translate the text
@@ -90,34 +157,37 @@ bool FontStorage::set_font(const std::string& fontFullName, double height,
     ////mtx *= agg::trans_affine_rotation(agg::deg2rad(-4.0));
     //////mtx *= agg::trans_affine_skewing(-0.4, 0);
     //////mtx *= agg::trans_affine_translation(1, 0);
-    ////m_fontEngine.transform(mtx);
+    ////f.fontEngine.transform(mtx);
 
-    m_fValidFont = true;
-    m_fontFullName = fontFullName;
-    return !m_fValidFont;
+    f.fValidFont = true;
+    f.fontFullName = fontFullName;
+    return !f.fValidFont;
 }
 
 //---------------------------------------------------------------------------------------
 void FontStorage::set_font_size(double rPoints)
 {
-    m_fontHeight = rPoints;
-    m_fontWidth = rPoints;
-    m_fontEngine.height(m_fontHeight);
-    m_fontEngine.width(m_fontWidth);
+    FontEngineState& f = fonts();
+    f.fontHeight = rPoints;
+    f.fontWidth = rPoints;
+    f.fontEngine.height(rPoints);
+    f.fontEngine.width(rPoints);
 }
 
 //---------------------------------------------------------------------------------------
 void FontStorage::set_font_height(double rPoints)
 {
-    m_fontHeight = rPoints;
-    m_fontEngine.height(rPoints);
+    FontEngineState& f = fonts();
+    f.fontHeight = rPoints;
+    f.fontEngine.height(rPoints);
 }
 
 //---------------------------------------------------------------------------------------
 void FontStorage::set_font_width(double rPoints)
 {
-    m_fontWidth = rPoints;
-    m_fontEngine.width(rPoints);
+    FontEngineState& f = fonts();
+    f.fontWidth = rPoints;
+    f.fontEngine.width(rPoints);
 }
 
 //---------------------------------------------------------------------------------------
@@ -154,4 +224,19 @@ bool FontStorage::select_vector_font(const std::string& language,
 }
 
 
+//=======================================================================================
+// FontSelector implementation
+//=======================================================================================
+std::string FontSelector::find_font(const std::string& language,
+                                    const std::string& fontFile,
+                                    const std::string& name,
+                                    bool fBold, bool fItalic)
+{
+#if (LOMSE_ENABLE_THREADS == 1)
+    std::lock_guard<std::mutex> lock(m_mutex);
+#endif
+    return find_platform_font(language, fontFile, name, fBold, fItalic);
+}
+
+
 }   //namespace lomse
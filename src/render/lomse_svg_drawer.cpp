@@ -14,6 +14,7 @@
 #include "agg_basics.h"
 
 //std
+#include <atomic>
 #include <locale>
 #include <codecvt>
 using namespace std;
@@ -746,7 +747,7 @@ void SvgDrawer::end_composite_notation()
 //---------------------------------------------------------------------------------------
 string SvgDrawer::validate_id(const string& id)
 {
-    static int counter = 0;
+    static std::atomic<int> counter(0);
 
     if (id.empty())
         return id;
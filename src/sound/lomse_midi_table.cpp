@@ -51,6 +51,7 @@ SoundEventsTable::SoundEventsTable(ImoScore* pScore)
     , m_numMeasures(0)
     , m_rAnacrusisMissingTime(0.0)
     , m_rAnacrusisExtraTime(0.0)
+    , m_iVoltaJump(0)
 {
 }
 
@@ -212,9 +213,10 @@ void SoundEventsTable::process_sound_change(ImoSoundChange* pSound,
                                             int UNUSED(channel),
                                             int UNUSED(iInstr), int measure)
 {
-    AttrObj* pAttr = pSound->get_first_attribute();
-    while (pAttr)
+    size_t numAttrs = pSound->get_num_attributes();
+    for (size_t i=0; i < numAttrs; ++i)
     {
+        AttrObj* pAttr = pSound->get_attribute_at(i);
         JumpEntry* pJump = nullptr;
         switch (pAttr->get_attrib_idx())
         {
@@ -261,7 +263,6 @@ void SoundEventsTable::process_sound_change(ImoSoundChange* pSound,
             default:
                 break;
         }
-        pAttr = pAttr->get_next_attrib();
     }
 }
 
@@ -269,9 +270,6 @@ void SoundEventsTable::process_sound_change(ImoSoundChange* pSound,
 void SoundEventsTable::add_jumps_if_volta_bracket(StaffObjsCursor& cursor,
                                                   ImoBarline* pBar, int measure)
 {
-    static vector<JumpEntry*> m_pending;
-    static int m_iJump = 0;
-
     if (pBar->get_num_relations() > 0)
     {
         ImoRelations* pRels = pBar->get_relations();
@@ -291,7 +289,7 @@ void SoundEventsTable::add_jumps_if_volta_bracket(StaffObjsCursor& cursor,
                         {
                             //First volta bracket of a repetition set starts here.
                             //Add all jumps for voltas in this set
-                            m_pending.clear();
+                            m_pendingVoltaJumps.clear();
 
                             //jump for first volta
                             int times = pVB->get_number_of_repetitions();
@@ -305,9 +303,9 @@ void SoundEventsTable::add_jumps_if_volta_bracket(StaffObjsCursor& cursor,
                                 times = (j == numVoltas ? 0 : 1);
                                 pJump = create_jump(measure, 0, times);
                                 add_jump(cursor, measure, pJump);
-                                m_pending.push_back(pJump);
+                                m_pendingVoltaJumps.push_back(pJump);
                             }
-                            m_iJump = 0;
+                            m_iVoltaJump = 0;
                         }
                         else
                         {
@@ -315,14 +313,14 @@ void SoundEventsTable::add_jumps_if_volta_bracket(StaffObjsCursor& cursor,
                             //Update:
                             //- measure to jump
                             //- number of repeat times if not last volta
-                            JumpEntry* pJump = m_pending[m_iJump];
+                            JumpEntry* pJump = m_pendingVoltaJumps[m_iVoltaJump];
                             pJump->set_measure(measure+1);
                             if (pJump->get_times_valid() != 0)
                             {
                                 int times = pVB->get_number_of_repetitions();
                                 pJump->set_times_valid(times);
                             }
-                            ++m_iJump;
+                            ++m_iVoltaJump;
                         }
                     }
                 }
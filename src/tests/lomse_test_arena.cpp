@@ -0,0 +1,206 @@
+//---------------------------------------------------------------------------------------
+// This file is part of the Lomse library.
+// Copyright (c) 2010-present, Lomse Developers
+//
+// Licensed under the MIT license.
+//
+// See LICENSE and NOTICE.md files in the root directory of this source tree.
+//---------------------------------------------------------------------------------------
+
+#include <UnitTest++.h>
+#include <iostream>
+#include "lomse_build_options.h"
+
+//classes related to these tests
+#include "lomse_arena.h"
+
+#include <cstdint>
+#include <new>
+
+using namespace UnitTest;
+using namespace std;
+using namespace lomse;
+
+
+//---------------------------------------------------------------------------------------
+// helper: object that counts destructions
+class ArenaTestObject
+{
+public:
+    int* m_pCounter;
+    double m_value;
+
+    ArenaTestObject(int* pCounter, double value) : m_pCounter(pCounter), m_value(value) {}
+    ~ArenaTestObject() { ++(*m_pCounter); }
+};
+
+//---------------------------------------------------------------------------------------
+class ArenaTestFixture
+{
+public:
+
+    ArenaTestFixture()     //SetUp fixture
+    {
+    }
+
+    ~ArenaTestFixture()    //TearDown fixture
+    {
+    }
+};
+
+SUITE(ArenaTest)
+{
+
+    TEST_FIXTURE(ArenaTestFixture, arena_01)
+    {
+        //@01. Allocations are aligned and use one block
+
+        Arena arena(1024);
+        CHECK( arena.is_empty() );
+
+        char* p1 = static_cast<char*>( arena.allocate(3, 1) );
+        void* p2 = arena.allocate(sizeof(double), alignof(double));
+        void* p3 = arena.allocate(16, 16);
+
+        CHECK( p1 != nullptr );
+        CHECK( reinterpret_cast<uintptr_t>(p2) % alignof(double) == 0 );
+        CHECK( reinterpret_cast<uintptr_t>(p3) % 16 == 0 );
+        CHECK( static_cast<char*>(p2) >= p1 + 3 );
+        CHECK( arena.get_num_blocks() == 1 );
+        CHECK( arena.get_used_bytes() == 3 + sizeof(double) + 16 );
+    }
+
+    TEST_FIXTURE(ArenaTestFixture, arena_02)
+    {
+        //@02. New blocks are added when needed. Big objects get its own block
+
+        Arena arena(256);
+        for (int i=0; i < 10; ++i)
+            arena.allocate(100);
+        CHECK( arena.get_num_blocks() == 5 );
+
+        arena.allocate(1000);
+        CHECK( arena.get_num_blocks() == 6 );
+    }
+
+    TEST_FIXTURE(ArenaTestFixture, arena_03)
+    {
+        //@03. Clear invokes registered destructors and releases memory
+
+        int counter = 0;
+        Arena arena(128);
+        for (int i=0; i < 20; ++i)
+        {
+            void* p = arena.allocate(sizeof(ArenaTestObject), alignof(ArenaTestObject));
+            ArenaTestObject* pObj = new (p) ArenaTestObject(&counter, double(i));
+            arena.add_destructor(pObj);
+        }
+        CHECK( counter == 0 );
+
+        arena.clear();
+
+        CHECK( counter == 20 );
+        CHECK( arena.is_empty() );
+        CHECK( arena.get_num_blocks() == 0 );
+    }
+
+    TEST_FIXTURE(ArenaTestFixture, arena_04)
+    {
+        //@04. Destructors are invoked when the arena is deleted
+
+        int counter = 0;
+        {
+            Arena arena;
+            void* p = arena.allocate(sizeof(ArenaTestObject), alignof(ArenaTestObject));
+            arena.add_destructor( new (p) ArenaTestObject(&counter, 1.0) );
+        }
+        CHECK( counter == 1 );
+    }
+
+    TEST_FIXTURE(ArenaTestFixture, node_pool_05)
+    {
+        //@05. Without current pool, nodes are allocated in the heap
+
+        CHECK( NodePool::current() == nullptr );
+        void* p = NodePool::allocate_node(sizeof(ArenaTestObject));
+        CHECK( p != nullptr );
+        CHECK( reinterpret_cast<uintptr_t>(p) % alignof(std::max_align_t) == 0 );
+        NodePool::deallocate_node(p);
+    }
+
+    TEST_FIXTURE(ArenaTestFixture, node_pool_06)
+    {
+        //@06. Nodes are allocated in current pool. Memory is reused
+
+        NodePool* pPool = new NodePool();
+        {
+            NodePoolScope scope(pPool);
+            CHECK( NodePool::current() == pPool );
+
+            void* p1 = NodePool::allocate_node(40);
+            void* p2 = NodePool::allocate_node(100);
+            CHECK( pPool->get_live_nodes() == 2 );
+            CHECK( reinterpret_cast<uintptr_t>(p2) % alignof(std::max_align_t) == 0 );
+            size_t used = pPool->get_used_bytes();
+
+            NodePool::deallocate_node(p1);
+            CHECK( pPool->get_live_nodes() == 1 );
+            void* p3 = NodePool::allocate_node(48);     //same size class than p1
+            CHECK( p3 == p1 );
+            CHECK( pPool->get_used_bytes() == used );
+
+            NodePool::deallocate_node(p2);
+            NodePool::deallocate_node(p3);
+            CHECK( pPool->get_live_nodes() == 0 );
+        }
+        CHECK( NodePool::current() == nullptr );
+        pPool->release();
+    }
+
+    TEST_FIXTURE(ArenaTestFixture, node_pool_07)
+    {
+        //@07. Big nodes are allocated in the heap
+
+        NodePool* pPool = new NodePool();
+        NodePoolScope scope(pPool);
+        void* p = NodePool::allocate_node(4000);
+        CHECK( pPool->get_live_nodes() == 0 );
+        CHECK( pPool->get_used_bytes() == 0 );
+        NodePool::deallocate_node(p);
+        pPool->release();
+    }
+
+    TEST_FIXTURE(ArenaTestFixture, node_pool_08)
+    {
+        //@08. Nodes can be deleted after releasing the pool and out of its scope
+
+        NodePool* pPool = new NodePool();
+        void* p;
+        {
+            NodePoolScope scope(pPool);
+            p = NodePool::allocate_node(sizeof(ArenaTestObject));
+        }
+        pPool->release();
+        CHECK( pPool->get_live_nodes() == 1 );
+        NodePool::deallocate_node(p);   //the pool is deleted here
+    }
+
+    TEST_FIXTURE(ArenaTestFixture, node_pool_09)
+    {
+        //@09. Scopes can be nested. A nullptr scope suspends the current pool
+
+        NodePool* pPool = new NodePool();
+        {
+            NodePoolScope scope(pPool);
+            {
+                NodePoolScope noPool(nullptr);
+                CHECK( NodePool::current() == nullptr );
+                NodePool::deallocate_node( NodePool::allocate_node(32) );
+            }
+            CHECK( NodePool::current() == pPool );
+            CHECK( pPool->get_used_bytes() == 0 );
+        }
+        pPool->release();
+    }
+
+}
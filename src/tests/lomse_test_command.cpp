@@ -39,6 +39,23 @@ public:
 };
 
 
+//=======================================================================================
+// MyDocCommandExecuter:  Helper class to use DocCommandExecuter protected members
+//=======================================================================================
+class MyDocCommandExecuter : public DocCommandExecuter
+{
+public:
+    MyDocCommandExecuter(Document* pDoc) : DocCommandExecuter(pDoc) {}
+    ~MyDocCommandExecuter() override {}
+
+    bool my_has_start_model_copy() { return m_checkpoints.front().pModel != nullptr
+                                            || !m_checkpoints.front().scores.empty(); }
+    size_t my_checkpoint_index(size_t i) { return m_checkpoints[i].index; }
+    bool my_has_whole_model_copy(size_t i) { return m_checkpoints[i].pModel != nullptr; }
+    size_t my_num_score_copies(size_t i) { return m_checkpoints[i].scores.size(); }
+};
+
+
 //=======================================================================================
 // helper class
 //=======================================================================================
@@ -1619,7 +1636,7 @@ SUITE(DocCommandTest)
         sel.debug_add(pNote);
         executer.execute(&cursor, pCmd, &sel);
 
-        CHECK( pCmd->get_undo_policy() == DocCommand::k_undo_policy_replay_from_start );
+        CHECK( pCmd->get_undo_policy() == DocCommand::k_undo_policy_specific );
         CHECK( doc.is_dirty() == true );
         CHECK( pCmd->get_name() == "Change accidentals" );
         CHECK( *cursor != nullptr );
@@ -1701,7 +1718,7 @@ SUITE(DocCommandTest)
         MySelectionSet sel(&doc);
         executer.execute(&cursor, pCmd, &sel);
 
-        CHECK( pCmd->get_undo_policy() == DocCommand::k_undo_policy_replay_from_start );
+        CHECK( pCmd->get_undo_policy() == DocCommand::k_undo_policy_specific );
         CHECK( doc.is_dirty() == true );
         CHECK( pCmd->get_name() == "Change barline type" );
         CHECK( *cursor != nullptr );
@@ -1848,7 +1865,7 @@ SUITE(DocCommandTest)
         sel.debug_add(pNote);
         executer.execute(&cursor, pCmd, &sel);
 
-        CHECK( pCmd->get_undo_policy() == DocCommand::k_undo_policy_replay_from_start );
+        CHECK( pCmd->get_undo_policy() == DocCommand::k_undo_policy_specific );
         CHECK( doc.is_dirty() == true );
         CHECK( pCmd->get_name() == "Change dots" );
         CHECK( *cursor != nullptr );
@@ -4503,7 +4520,7 @@ SUITE(DocCommandTest)
         DocCommand* pCmd = LOMSE_NEW
             CmdTransposeChromatically(FIntval("p4"));
         CHECK( pCmd->get_name() == "Chromatic transposition" );
-        CHECK( pCmd->get_undo_policy() == DocCommand::k_undo_policy_replay_from_start );
+        CHECK( pCmd->get_undo_policy() == DocCommand::k_undo_policy_specific );
 
         executer.execute(&cursor, pCmd, &sel);
 
@@ -4566,7 +4583,7 @@ SUITE(DocCommandTest)
         DocCommand* pCmd = LOMSE_NEW
             CmdTransposeChromatically(FIntval("p4"));
         CHECK( pCmd->get_name() == "Chromatic transposition" );
-        CHECK( pCmd->get_undo_policy() == DocCommand::k_undo_policy_replay_from_start );
+        CHECK( pCmd->get_undo_policy() == DocCommand::k_undo_policy_specific );
 
         executer.execute(&cursor, pCmd, &sel);
 
@@ -4629,7 +4646,7 @@ SUITE(DocCommandTest)
         DocCommand* pCmd = LOMSE_NEW
             CmdTransposeChromatically(FIntval("p4", k_descending));
         CHECK( pCmd->get_name() == "Chromatic transposition" );
-        CHECK( pCmd->get_undo_policy() == DocCommand::k_undo_policy_replay_from_start );
+        CHECK( pCmd->get_undo_policy() == DocCommand::k_undo_policy_specific );
 
         executer.execute(&cursor, pCmd, &sel);
 
@@ -4692,7 +4709,7 @@ SUITE(DocCommandTest)
         DocCommand* pCmd = LOMSE_NEW
             CmdTransposeChromatically(FIntval("p4", k_descending));
         CHECK( pCmd->get_name() == "Chromatic transposition" );
-        CHECK( pCmd->get_undo_policy() == DocCommand::k_undo_policy_replay_from_start );
+        CHECK( pCmd->get_undo_policy() == DocCommand::k_undo_policy_specific );
 
         executer.execute(&cursor, pCmd, &sel);
 
@@ -4757,7 +4774,7 @@ SUITE(DocCommandTest)
         DocCommand* pCmd = LOMSE_NEW
             CmdTransposeDiatonically(3);
         CHECK( pCmd->get_name() == "Diatonic transposition" );
-        CHECK( pCmd->get_undo_policy() == DocCommand::k_undo_policy_replay_from_start );
+        CHECK( pCmd->get_undo_policy() == DocCommand::k_undo_policy_specific );
 
         executer.execute(&cursor, pCmd, &sel);
 
@@ -4820,7 +4837,7 @@ SUITE(DocCommandTest)
         DocCommand* pCmd = LOMSE_NEW
             CmdTransposeDiatonically(3);
         CHECK( pCmd->get_name() == "Diatonic transposition" );
-        CHECK( pCmd->get_undo_policy() == DocCommand::k_undo_policy_replay_from_start );
+        CHECK( pCmd->get_undo_policy() == DocCommand::k_undo_policy_specific );
 
         executer.execute(&cursor, pCmd, &sel);
 
@@ -4883,7 +4900,7 @@ SUITE(DocCommandTest)
         DocCommand* pCmd = LOMSE_NEW
             CmdTransposeDiatonically(3, false /*down*/);
         CHECK( pCmd->get_name() == "Diatonic transposition" );
-        CHECK( pCmd->get_undo_policy() == DocCommand::k_undo_policy_replay_from_start );
+        CHECK( pCmd->get_undo_policy() == DocCommand::k_undo_policy_specific );
 
         executer.execute(&cursor, pCmd, &sel);
 
@@ -4946,7 +4963,7 @@ SUITE(DocCommandTest)
         DocCommand* pCmd = LOMSE_NEW
             CmdTransposeDiatonically(3, false /*down*/);
         CHECK( pCmd->get_name() == "Diatonic transposition" );
-        CHECK( pCmd->get_undo_policy() == DocCommand::k_undo_policy_replay_from_start );
+        CHECK( pCmd->get_undo_policy() == DocCommand::k_undo_policy_specific );
 
         executer.execute(&cursor, pCmd, &sel);
 
@@ -5012,7 +5029,7 @@ SUITE(DocCommandTest)
         DocCommand* pCmd = LOMSE_NEW
             CmdTransposeKey(FIntval("M3"));
         CHECK( pCmd->get_name() == "Transpose key signature" );
-        CHECK( pCmd->get_undo_policy() == DocCommand::k_undo_policy_replay_from_start );
+        CHECK( pCmd->get_undo_policy() == DocCommand::k_undo_policy_specific );
 
         executer.execute(&cursor, pCmd, &sel);
 
@@ -5066,7 +5083,7 @@ SUITE(DocCommandTest)
         DocCommand* pCmd = LOMSE_NEW
             CmdTransposeKey(FIntval("M2", true));
         CHECK( pCmd->get_name() == "Transpose key signature" );
-        CHECK( pCmd->get_undo_policy() == DocCommand::k_undo_policy_replay_from_start );
+        CHECK( pCmd->get_undo_policy() == DocCommand::k_undo_policy_specific );
 
         executer.execute(&cursor, pCmd, &sel);
 
@@ -5121,7 +5138,7 @@ SUITE(DocCommandTest)
         DocCommand* pCmd = LOMSE_NEW
             CmdTransposeKey(FIntval("M3"));
         CHECK( pCmd->get_name() == "Transpose key signature" );
-        CHECK( pCmd->get_undo_policy() == DocCommand::k_undo_policy_replay_from_start );
+        CHECK( pCmd->get_undo_policy() == DocCommand::k_undo_policy_specific );
 
         executer.execute(&cursor, pCmd, &sel);
 
@@ -5186,7 +5203,7 @@ SUITE(DocCommandTest)
         DocCommand* pCmd = LOMSE_NEW
             CmdTransposeKey(FIntval("M2", true));
         CHECK( pCmd->get_name() == "Transpose key signature" );
-        CHECK( pCmd->get_undo_policy() == DocCommand::k_undo_policy_replay_from_start );
+        CHECK( pCmd->get_undo_policy() == DocCommand::k_undo_policy_specific );
 
         executer.execute(&cursor, pCmd, &sel);
 
@@ -5322,4 +5339,622 @@ SUITE(DocCommandTest)
         CHECK( (*cursor)->to_string() == "(n f4 e v1 p1)" );
     }
 
+    TEST_FIXTURE(DocCommandTestFixture, undo_9003)
+    {
+        //9003. model copy not taken until a command modifies the document
+
+        MyDocument3 doc(m_libraryScope);
+        doc.from_string("(score (vers 2.0)(instrument#90 (musicData#122 "
+            "(clef G)"
+            ")))");
+        doc.my_clear_dirty();
+        DocCursor cursor(&doc);
+        MyDocCommandExecuter executer(&doc);
+        MySelectionSet sel(&doc);
+        DocModel* pModel = doc.get_doc_model();
+
+        executer.execute(&cursor, LOMSE_NEW CmdCursor(CmdCursor::k_enter), &sel);
+        executer.execute(&cursor, LOMSE_NEW CmdCursor(CmdCursor::k_move_next), &sel);
+
+        CHECK( executer.my_has_start_model_copy() == false );
+        CHECK( doc.get_doc_model() == pModel );
+        CHECK( executer.undo_stack_size() == 0 );
+
+        DocCommand* pCmd = LOMSE_NEW CmdAddNoteRest("(n a4 e v1)", k_edit_mode_replace);
+        executer.execute(&cursor, pCmd, &sel);
+
+        CHECK( executer.my_has_start_model_copy() == true );
+        CHECK( doc.get_doc_model() == pModel );
+        ImoScore* pScore = static_cast<ImoScore*>( doc.get_im_root()->get_content_item(0) );
+        CHECK( pScore->get_staffobjs_table()->num_entries() == 2 );
+    }
+
+    TEST_FIXTURE(DocCommandTestFixture, undo_9004)
+    {
+        //9004. undo to start shares the start model. Redo copies it again
+
+        MyDocument3 doc(m_libraryScope);
+        doc.from_string("(score (vers 2.0)(instrument#90 (musicData#122 "
+            "(clef G)"
+            ")))");
+        doc.my_clear_dirty();
+        DocCursor cursor(&doc);
+        MyDocCommandExecuter executer(&doc);
+        cursor.enter_element();     //points to clef
+        cursor.move_next();         //points to end of score
+        MySelectionSet sel(&doc);
+
+        DocCommand* pCmd = LOMSE_NEW CmdAddNoteRest("(n a4 e v1)", k_edit_mode_replace);
+        executer.execute(&cursor, pCmd, &sel);
+        pCmd = LOMSE_NEW CmdAddNoteRest("(n f4 e v1)", k_edit_mode_replace);
+        executer.execute(&cursor, pCmd, &sel);
+
+        executer.undo(&cursor, &sel);       //replays first command
+        CHECK( executer.my_has_start_model_copy() == true );
+        ImoScore* pScore = static_cast<ImoScore*>( doc.get_im_root()->get_content_item(0) );
+        CHECK( pScore->get_staffobjs_table()->num_entries() == 2 );
+
+        executer.undo(&cursor, &sel);       //nothing to replay
+        CHECK( executer.my_has_start_model_copy() == false );
+        pScore = static_cast<ImoScore*>( doc.get_im_root()->get_content_item(0) );
+        CHECK( pScore->get_staffobjs_table()->num_entries() == 1 );
+
+        executer.redo(&cursor, &sel);
+        CHECK( executer.my_has_start_model_copy() == true );
+        pScore = static_cast<ImoScore*>( doc.get_im_root()->get_content_item(0) );
+        CHECK( pScore->get_staffobjs_table()->num_entries() == 2 );
+
+        executer.undo(&cursor, &sel);       //start model is still the initial one
+        pScore = static_cast<ImoScore*>( doc.get_im_root()->get_content_item(0) );
+        CHECK( pScore->get_staffobjs_table()->num_entries() == 1 );
+        cursor.move_prev();
+        CHECK( (*cursor)->is_clef() == true );
+    }
+
+    TEST_FIXTURE(DocCommandTestFixture, undo_9005)
+    {
+        //9005. undo restores the nearest checkpoint and replays the commands after it
+
+        MyDocument3 doc(m_libraryScope);
+        doc.from_string("(score (vers 2.0)(instrument#90 (musicData#122 "
+            "(clef G)"
+            ")))");
+        doc.my_clear_dirty();
+        DocCursor cursor(&doc);
+        MyDocCommandExecuter executer(&doc);
+        executer.set_checkpoints_policy(2, 1000000.0, 16);
+        cursor.enter_element();     //points to clef
+        cursor.move_next();         //points to end of score
+        MySelectionSet sel(&doc);
+
+        for (int i=0; i < 5; ++i)
+        {
+            DocCommand* pCmd = LOMSE_NEW CmdAddNoteRest("(n c4 e v1)", k_edit_mode_replace);
+            executer.execute(&cursor, pCmd, &sel);
+        }
+        CHECK( executer.num_checkpoints() == 3 );
+        CHECK( executer.my_checkpoint_index(1) == 2 );
+        CHECK( executer.my_checkpoint_index(2) == 4 );
+
+        executer.undo(&cursor, &sel);       //checkpoint 4, nothing to replay
+        CHECK( executer.num_checkpoints() == 3 );
+        ImoScore* pScore = static_cast<ImoScore*>( doc.get_im_root()->get_content_item(0) );
+        CHECK( pScore->get_staffobjs_table()->num_entries() == 5 );
+
+        executer.undo(&cursor, &sel);       //checkpoint 2, replays one command
+        CHECK( executer.num_checkpoints() == 2 );
+        pScore = static_cast<ImoScore*>( doc.get_im_root()->get_content_item(0) );
+        CHECK( pScore->get_staffobjs_table()->num_entries() == 4 );
+
+        executer.redo(&cursor, &sel);
+        executer.redo(&cursor, &sel);
+        CHECK( executer.num_checkpoints() == 3 );
+        pScore = static_cast<ImoScore*>( doc.get_im_root()->get_content_item(0) );
+        CHECK( pScore->get_staffobjs_table()->num_entries() == 6 );
+
+        for (int i=0; i < 5; ++i)
+            executer.undo(&cursor, &sel);
+
+        CHECK( executer.num_checkpoints() == 1 );
+        pScore = static_cast<ImoScore*>( doc.get_im_root()->get_content_item(0) );
+        CHECK( pScore->get_staffobjs_table()->num_entries() == 1 );
+    }
+
+    TEST_FIXTURE(DocCommandTestFixture, undo_9006)
+    {
+        //9006. number of checkpoints is limited. Undo replays the commands in the
+        //gaps and saves new checkpoints
+
+        MyDocument3 doc(m_libraryScope);
+        doc.from_string("(score (vers 2.0)(instrument#90 (musicData#122 "
+            "(clef G)"
+            ")))");
+        doc.my_clear_dirty();
+        DocCursor cursor(&doc);
+        MyDocCommandExecuter executer(&doc);
+        executer.set_checkpoints_policy(1, 1000000.0, 4);
+        cursor.enter_element();     //points to clef
+        cursor.move_next();         //points to end of score
+        MySelectionSet sel(&doc);
+
+        for (int i=0; i < 8; ++i)
+        {
+            DocCommand* pCmd = LOMSE_NEW CmdAddNoteRest("(n c4 e v1)", k_edit_mode_replace);
+            executer.execute(&cursor, pCmd, &sel);
+        }
+        CHECK( executer.num_checkpoints() == 4 );
+        CHECK( executer.my_checkpoint_index(0) == 0 );
+        CHECK( executer.my_checkpoint_index(3) == 7 );
+
+        for (int i=8; i > 0; --i)
+        {
+            executer.undo(&cursor, &sel);
+            ImoScore* pScore = static_cast<ImoScore*>( doc.get_im_root()->get_content_item(0) );
+            CHECK( pScore->get_staffobjs_table()->num_entries() == i );
+            CHECK( executer.num_checkpoints() <= 4 );
+        }
+    }
+
+    TEST_FIXTURE(DocCommandTestFixture, undo_9007)
+    {
+        //9007. undo transposition restores the saved pitch. The model is not
+        //replaced, as commands are not replayed
+
+        MyDocument3 doc(m_libraryScope);
+        doc.from_string("(score (vers 2.0)(instrument#90 (musicData#122 "
+            "(clef G)(key D)(n c4 q)(n +f4 q)(n =f4 q)(barline)"
+            ")))");
+        doc.my_clear_dirty();
+        DocCursor cursor(&doc);
+        MyDocCommandExecuter executer(&doc);
+        MySelectionSet sel(&doc);
+        cursor.enter_element();     //points to clef
+        cursor.move_next();         //points to key
+        sel.debug_add( *cursor );
+        cursor.move_next();         //points to c4
+        sel.debug_add( *cursor );
+        cursor.move_next();         //points to +f4
+        sel.debug_add( *cursor );
+        cursor.move_next();         //points to =f4
+        ImoNote* pNote = static_cast<ImoNote*>( *cursor );
+        sel.debug_add(pNote);
+        ImoScore* pScore = static_cast<ImoScore*>( doc.get_im_root()->get_content_item(0) );
+
+        DocCommand* pCmd = LOMSE_NEW CmdTransposeKey(FIntval("M2", true));
+        executer.execute(&cursor, pCmd, &sel);
+        CHECK( pNote->get_step() == k_step_E );
+        CHECK( pNote->get_actual_accidentals() == -1.0f );
+
+        executer.undo(&cursor, &sel);
+
+        CHECK( doc.get_im_root()->get_content_item(0) == pScore );
+        CHECK( doc.get_pointer_to_imo(pNote->get_id()) == pNote );
+        CHECK( pNote->get_step() == k_step_F );
+        CHECK( pNote->get_octave() == 4 );
+        CHECK( pNote->get_actual_accidentals() == 0.0f );
+        CHECK( pNote->get_notated_accidentals() == k_natural );
+        DocCursor c(&doc);
+        c.enter_element();     //points to clef
+        c.move_next();         //points to key
+        ImoKeySignature* pKey = static_cast<ImoKeySignature*>( c.get_pointee() );
+        CHECK( pKey->get_key_type() == k_key_D );
+        c.move_next();         //points to c4
+        pNote = static_cast<ImoNote*>( c.get_pointee() );
+        CHECK( pNote->get_step() == k_step_C );
+        CHECK( pNote->get_actual_accidentals() == 1.0f );
+        CHECK( pNote->get_notated_accidentals() == k_no_accidentals );
+        c.move_next();         //points to +f4
+        pNote = static_cast<ImoNote*>( c.get_pointee() );
+        CHECK( pNote->get_step() == k_step_F );
+        CHECK( pNote->get_actual_accidentals() == 1.0f );
+        CHECK( pNote->get_notated_accidentals() == k_sharp );
+    }
+
+    TEST_FIXTURE(DocCommandTestFixture, undo_9008)
+    {
+        //9008. undo change attribute removes the attribute when it was added
+        //by the command
+
+        MyDocument3 doc(m_libraryScope);
+        doc.from_string("(score (vers 2.0)(instrument#90 (musicData#122 "
+            "(clef G)(barline simple)"
+            ")))");
+        doc.my_clear_dirty();
+        DocCursor cursor(&doc);
+        MyDocCommandExecuter executer(&doc);
+        MySelectionSet sel(&doc);
+        cursor.enter_element();     //points to clef
+        cursor.move_next();         //points to barline
+        ImoObj* pImo = *cursor;
+        CHECK( pImo->get_attribute(k_attr_coda) == nullptr );
+
+        DocCommand* pCmd = LOMSE_NEW CmdChangeAttribute(k_attr_coda, string("coda"));
+        executer.execute(&cursor, pCmd, &sel);
+        CHECK( pImo->get_string_attribute(k_attr_coda) == "coda" );
+
+        executer.undo(&cursor, &sel);
+        CHECK( doc.get_pointer_to_imo(pImo->get_id()) == pImo );
+        CHECK( pImo->get_attribute(k_attr_coda) == nullptr );
+
+        executer.redo(&cursor, &sel);
+        CHECK( pImo->get_string_attribute(k_attr_coda) == "coda" );
+    }
+
+    TEST_FIXTURE(DocCommandTestFixture, undo_9012)
+    {
+        //9012. undo change dots restores durations and timepos of the following
+        //notes. Notes are not replaced
+
+        MyDocument3 doc(m_libraryScope);
+        doc.from_string("(score (vers 2.0)(instrument#90 (musicData#122 "
+            "(clef G)(time 4 4)(n c4 q)(n d4 q)(n e4 q)(barline)(n f4 q)"
+            ")))");
+        doc.my_clear_dirty();
+        DocCursor cursor(&doc);
+        MyDocCommandExecuter executer(&doc);
+        MySelectionSet sel(&doc);
+        cursor.enter_element();     //points to clef
+        cursor.move_next();         //points to time
+        cursor.move_next();         //points to c4
+        cursor.move_next();         //points to d4
+        ImoNote* pNote2 = static_cast<ImoNote*>( *cursor );
+        cursor.move_next();         //points to e4
+        ImoNote* pNote3 = static_cast<ImoNote*>( *cursor );
+        cursor.move_next();         //points to barline
+        cursor.move_next();         //points to f4
+        ImoNote* pNote4 = static_cast<ImoNote*>( *cursor );
+        sel.debug_add(pNote2);
+
+        DocCommand* pCmd = LOMSE_NEW CmdChangeDots(1);
+        executer.execute(&cursor, pCmd, &sel);
+        CHECK( pNote2->get_duration() == 96.0 );
+        CHECK( pNote3->get_colstaffobjs_entry()->time() == 160.0 );
+
+        executer.undo(&cursor, &sel);
+        CHECK( doc.get_pointer_to_imo(pNote2->get_id()) == pNote2 );
+        CHECK( pNote2->get_dots() == 0 );
+        CHECK( pNote2->get_duration() == 64.0 );
+        CHECK( pNote2->get_colstaffobjs_entry()->time() == 64.0 );
+        CHECK( pNote3->get_colstaffobjs_entry()->time() == 128.0 );
+        CHECK( pNote4->get_colstaffobjs_entry()->time() == 192.0 );
+        CHECK( pNote4->get_colstaffobjs_entry()->measure() == 1 );
+        CHECK( pNote3->get_step() == k_step_E );
+        CHECK( pNote4->get_step() == k_step_F );
+
+        executer.redo(&cursor, &sel);
+        CHECK( pNote2->get_dots() == 1 );
+        CHECK( pNote2->get_duration() == 96.0 );
+        CHECK( pNote3->get_colstaffobjs_entry()->time() == 160.0 );
+        CHECK( pNote4->get_colstaffobjs_entry()->time() == 224.0 );
+    }
+
+    TEST_FIXTURE(DocCommandTestFixture, undo_9013)
+    {
+        //9013. undo change accidentals restores the pitch and displayed accidentals
+        //of the other notes in the measure. Notes are not replaced
+
+        MyDocument3 doc(m_libraryScope);
+        doc.from_string("(score (vers 2.0)(instrument#90 (musicData#122 "
+            "(clef G)(n f4 q)(n f4 q)(n g4 q)(n f4 q)(barline)(n f4 q)"
+            ")))");
+        doc.my_clear_dirty();
+        DocCursor cursor(&doc);
+        MyDocCommandExecuter executer(&doc);
+        MySelectionSet sel(&doc);
+        cursor.enter_element();     //points to clef
+        cursor.move_next();         //points to first f4
+        ImoNote* pNote1 = static_cast<ImoNote*>( *cursor );
+        cursor.move_next();
+        ImoNote* pNote2 = static_cast<ImoNote*>( *cursor );
+        cursor.move_next();
+        ImoNote* pNote3 = static_cast<ImoNote*>( *cursor );
+        cursor.move_next();
+        ImoNote* pNote4 = static_cast<ImoNote*>( *cursor );
+        cursor.move_next();         //points to barline
+        cursor.move_next();
+        ImoNote* pNote5 = static_cast<ImoNote*>( *cursor );
+        sel.debug_add(pNote1);
+
+        DocCommand* pCmd = LOMSE_NEW CmdChangeAccidentals(k_sharp);
+        executer.execute(&cursor, pCmd, &sel);
+        CHECK( pNote1->get_actual_accidentals() == 1.0f );
+        CHECK( pNote2->get_actual_accidentals() == 0.0f );
+        CHECK( pNote2->get_notated_accidentals() == k_natural );
+        CHECK( pNote4->get_notated_accidentals() == k_no_accidentals );
+        CHECK( pNote5->get_notated_accidentals() == k_no_accidentals );
+
+        executer.undo(&cursor, &sel);
+        CHECK( doc.get_pointer_to_imo(pNote1->get_id()) == pNote1 );
+        CHECK( pNote1->get_notated_accidentals() == k_no_accidentals );
+        CHECK( pNote1->get_actual_accidentals() == 0.0f );
+        CHECK( pNote2->get_actual_accidentals() == 0.0f );
+        CHECK( pNote2->get_notated_accidentals() == k_no_accidentals );
+        CHECK( pNote3->get_step() == k_step_G );
+        CHECK( pNote3->get_actual_accidentals() == 0.0f );
+        CHECK( pNote4->get_actual_accidentals() == 0.0f );
+        CHECK( pNote5->get_actual_accidentals() == 0.0f );
+        CHECK( pNote4->get_colstaffobjs_entry()->time() == 192.0 );
+
+        executer.redo(&cursor, &sel);
+        CHECK( pNote1->get_notated_accidentals() == k_sharp );
+        CHECK( pNote1->get_actual_accidentals() == 1.0f );
+        CHECK( pNote2->get_notated_accidentals() == k_natural );
+        CHECK( pNote5->get_notated_accidentals() == k_no_accidentals );
+    }
+
+    TEST_FIXTURE(DocCommandTestFixture, undo_9009)
+    {
+        //9009. checkpoint for a command modifying a score only copies that score
+
+        MyDocument3 doc(m_libraryScope);
+        doc.from_string("(score (vers 2.0)(instrument#90 (musicData#122 "
+            "(clef G)"
+            ")))");
+        doc.my_clear_dirty();
+        DocCursor cursor(&doc);
+        MyDocCommandExecuter executer(&doc);
+        cursor.enter_element();     //points to clef
+        cursor.move_next();         //points to end of score
+        MySelectionSet sel(&doc);
+
+        DocCommand* pCmd = LOMSE_NEW CmdAddNoteRest("(n a4 e v1)", k_edit_mode_replace);
+        executer.execute(&cursor, pCmd, &sel);
+
+        CHECK( executer.my_has_whole_model_copy(0) == false );
+        CHECK( executer.my_num_score_copies(0) == 1 );
+
+        executer.undo(&cursor, &sel);
+        ImoScore* pScore = static_cast<ImoScore*>( doc.get_im_root()->get_content_item(0) );
+        CHECK( pScore->get_staffobjs_table()->num_entries() == 1 );
+        CHECK( doc.get_pointer_to_imo(pScore->get_id()) == pScore );
+    }
+
+    TEST_FIXTURE(DocCommandTestFixture, undo_9010)
+    {
+        //9010. commands modifying two scores. Both scores are copied and restored
+
+        MyDocument3 doc(m_libraryScope);
+        doc.from_string("(lenmusdoc (vers 0.0)(content "
+            "(score (vers 2.0)(instrument (musicData (clef G))))"
+            "(score (vers 2.0)(instrument (musicData "
+            "(clef F4)(n e3 e v1 (beam 1 +))(n g3 e v1 (beam 1 -))))) ))");
+        doc.my_clear_dirty();
+        DocCursor cursor(&doc);
+        MyDocCommandExecuter executer(&doc);
+        MySelectionSet sel(&doc);
+        ImoScore* pScore2 = static_cast<ImoScore*>( doc.get_im_root()->get_content_item(1) );
+        ColStaffObjsIterator it = pScore2->get_staffobjs_table()->begin();
+        ImoId idClef2 = (*it)->imo_object()->get_id();
+
+        cursor.enter_element();     //points to clef G
+        cursor.move_next();         //points to end of first score
+        DocCommand* pCmd = LOMSE_NEW CmdAddNoteRest("(n a4 e v1)", k_edit_mode_replace);
+        executer.execute(&cursor, pCmd, &sel);
+
+        cursor.point_to(idClef2);
+        cursor.move_next();         //points to e3
+        cursor.move_next();         //points to g3
+        cursor.move_next();         //points to end of second score
+        pCmd = LOMSE_NEW CmdAddNoteRest("(n c4 q v1)", k_edit_mode_replace);
+        executer.execute(&cursor, pCmd, &sel);
+
+        CHECK( executer.my_has_whole_model_copy(0) == false );
+        CHECK( executer.my_num_score_copies(0) == 2 );
+
+        executer.undo(&cursor, &sel);
+        executer.undo(&cursor, &sel);
+
+        ImoScore* pScore = static_cast<ImoScore*>( doc.get_im_root()->get_content_item(0) );
+        CHECK( pScore->get_staffobjs_table()->num_entries() == 1 );
+        pScore2 = static_cast<ImoScore*>( doc.get_im_root()->get_content_item(1) );
+        CHECK( pScore2->get_staffobjs_table()->num_entries() == 3 );
+        it = pScore2->get_staffobjs_table()->begin();
+        ++it;
+        ImoNote* pNote = static_cast<ImoNote*>( (*it)->imo_object() );
+        CHECK( pNote->is_beamed() == true );
+        ImoBeam* pBeam = pNote->get_beam();
+        CHECK( pBeam && pBeam->get_start_object() == pNote );
+        CHECK( doc.get_pointer_to_imo(pNote->get_id()) == pNote );
+
+        executer.redo(&cursor, &sel);
+        executer.redo(&cursor, &sel);
+        pScore = static_cast<ImoScore*>( doc.get_im_root()->get_content_item(0) );
+        CHECK( pScore->get_staffobjs_table()->num_entries() == 2 );
+        pScore2 = static_cast<ImoScore*>( doc.get_im_root()->get_content_item(1) );
+        CHECK( pScore2->get_staffobjs_table()->num_entries() == 4 );
+    }
+
+    TEST_FIXTURE(DocCommandTestFixture, undo_9011)
+    {
+        //9011. commands not restricted to a score save a copy of the whole model
+
+        MyDocument3 doc(m_libraryScope);
+        doc.create_empty();
+        doc.my_clear_dirty();
+        DocCursor cursor(&doc);
+        MyDocCommandExecuter executer(&doc);
+        MySelectionSet sel(&doc);
+
+        DocCommand* pCmd = LOMSE_NEW CmdInsertBlockLevelObj(k_imo_para);
+        executer.execute(&cursor, pCmd, &sel);
+
+        CHECK( executer.my_has_whole_model_copy(0) == true );
+        CHECK( executer.my_num_score_copies(0) == 0 );
+
+        executer.undo(&cursor, &sel);
+        CHECK( doc.get_im_root()->get_num_content_items() == 0 );
+    }
+
+    // DocCommandExecuter transactions --------------------------------------------------
+
+    TEST_FIXTURE(DocCommandTestFixture, transaction_9101)
+    {
+        //9101. in a transaction, commands using the cursor see the changes done by
+        //previous commands, but the document modified event is deferred until commit
+
+        MyDocument3 doc(m_libraryScope);
+        doc.from_string("(score (vers 2.0)(instrument#90 (musicData#122 "
+            "(clef G)"
+            ")))");
+        doc.my_clear_dirty();
+        DocCursor cursor(&doc);
+        DocCommandExecuter executer(&doc);
+        MySelectionSet sel(&doc);
+        cursor.enter_element();     //points to clef
+        cursor.move_next();         //points to end of score
+        ImoScore* pScore = static_cast<ImoScore*>( doc.get_im_root()->get_content_item(0) );
+
+        executer.begin_transaction();
+        for (int i=0; i < 3; ++i)
+        {
+            executer.execute(&cursor, LOMSE_NEW CmdInsertStaffObj("(n e4 q)"), &sel);
+            doc.notify_if_document_modified();
+        }
+        CHECK( doc.is_dirty() == true );
+
+        executer.commit_transaction();
+
+        CHECK( doc.is_in_transaction() == false );
+        CHECK( doc.is_dirty() == false );
+        CHECK( *cursor == nullptr );
+        ColStaffObjs* pTable = pScore->get_staffobjs_table();
+        CHECK( pTable->num_entries() == 4 );
+        ColStaffObjsIterator it = pTable->begin();
+        for (int i=0; i < 3; ++i)
+        {
+            ++it;
+            CHECK( (*it)->imo_object()->is_note() );
+            CHECK( (*it)->time() == 64.0 * i );
+        }
+        CHECK( executer.undo_stack_size() == 3 );
+        executer.undo(&cursor, &sel);
+        pScore = static_cast<ImoScore*>( doc.get_im_root()->get_content_item(0) );
+        CHECK( pScore->get_staffobjs_table()->num_entries() == 3 );
+    }
+
+    TEST_FIXTURE(DocCommandTestFixture, transaction_9102)
+    {
+        //9102. a batch of commands not using the cursor updates the score only once
+
+        MyDocument3 doc(m_libraryScope);
+        doc.from_string("(score (vers 2.0)(instrument#90 (musicData#122 "
+            "(clef G)(n c4 q)(n d4 q)(n e4 q)(n f4 q)(barline)"
+            ")))");
+        doc.my_clear_dirty();
+        DocCursor cursor(&doc);
+        DocCommandExecuter executer(&doc);
+        cursor.enter_element();     //points to clef
+        cursor.move_next();         //points to c4
+        ImoId idCursor = cursor.get_pointee_id();
+        ImoScore* pScore = static_cast<ImoScore*>( doc.get_im_root()->get_content_item(0) );
+        ColStaffObjsIterator it = pScore->get_staffobjs_table()->begin();
+        vector<ImoNote*> notes;
+        vector<MySelectionSet*> selections;
+        for (++it; (*it)->imo_object()->is_note(); ++it)
+        {
+            //selections need the staffobjs table. Build them before the batch
+            ImoNote* pNote = static_cast<ImoNote*>( (*it)->imo_object() );
+            MySelectionSet* pSel = LOMSE_NEW MySelectionSet(&doc);
+            pSel->debug_add(pNote);
+            notes.push_back(pNote);
+            selections.push_back(pSel);
+        }
+
+        executer.begin_transaction();
+        vector<MySelectionSet*>::iterator itS;
+        for (itS = selections.begin(); itS != selections.end(); ++itS)
+            executer.execute(&cursor, LOMSE_NEW CmdChangeDots(1), *itS);
+
+        executer.commit_transaction();
+
+        CHECK( executer.undo_stack_size() == 4 );
+        CHECK( notes.back()->get_colstaffobjs_entry()->time() == 288.0 );
+        CHECK( cursor.get_pointee_id() == idCursor );
+        CHECK( *cursor == notes.front() );
+
+        for (itS = selections.begin(); itS != selections.end(); ++itS)
+            delete *itS;
+    }
+
+    TEST_FIXTURE(DocCommandTestFixture, transaction_9103)
+    {
+        //9103. composite commands update the score only once
+
+        MyDocument3 doc(m_libraryScope);
+        doc.from_string("(score (vers 2.0)(instrument#90 (musicData#122 "
+            "(clef G)(n e4 e)(n f4 e)(n g4 e)"
+            ")))");
+        doc.my_clear_dirty();
+        DocCursor cursor(&doc);
+        DocCommandExecuter executer(&doc);
+        cursor.enter_element();     //points to clef
+        cursor.move_next();         //points to e4
+        MySelectionSet sel(&doc);
+        sel.debug_add(*cursor);
+        cursor.move_next();         //points to f4
+        sel.debug_add(*cursor);
+        cursor.move_next();         //points to g4
+        sel.debug_add(*cursor);
+        DocCmdComposite* pCmd = LOMSE_NEW DocCmdComposite("Join beam and change dots");
+        pCmd->add_child_command( LOMSE_NEW CmdJoinBeam() );
+        pCmd->add_child_command( LOMSE_NEW CmdChangeDots(1) );
+
+        executer.execute(&cursor, pCmd, &sel);
+
+        CHECK( doc.is_in_transaction() == false );
+        ImoNote* pNote = static_cast<ImoNote*>( *cursor );
+        CHECK( pNote->get_step() == k_step_G );
+        CHECK( pNote->is_beamed() == true );
+        CHECK( pNote->get_colstaffobjs_entry()->time() == 96.0 );
+    }
+
+    TEST_FIXTURE(DocCommandTestFixture, transaction_9104)
+    {
+        //9104. in a transaction, the cursor is correctly updated after replacing a
+        //note in a tuplet (all the score is updated)
+
+        string src("(score (vers 2.0)(instrument#90 (musicData#122 "
+            "(clef G)(n e4 e (t + 2 3))(n f4 e)(n g4 e (t -))(n c5 q)(barline)"
+            ")))");
+
+        //expected result: same command without transaction
+        MyDocument3 docRef(m_libraryScope);
+        docRef.from_string(src);
+        DocCursor cursorRef(&docRef);
+        DocCommandExecuter executerRef(&docRef);
+        MySelectionSet selRef(&docRef);
+        cursorRef.enter_element();      //points to clef
+        cursorRef.move_next();          //points to e4
+        executerRef.execute(&cursorRef,
+                            LOMSE_NEW CmdAddNoteRest("(n a4 q v1)", k_edit_mode_replace),
+                            &selRef);
+        ImoScore* pScore = static_cast<ImoScore*>( docRef.get_im_root()->get_content_item(0) );
+        string tableRef = pScore->get_staffobjs_table()->dump();
+
+        MyDocument3 doc(m_libraryScope);
+        doc.from_string(src);
+        DocCursor cursor(&doc);
+        DocCommandExecuter executer(&doc);
+        MySelectionSet sel(&doc);
+        cursor.enter_element();     //points to clef
+        cursor.move_next();         //points to e4
+
+        executer.begin_transaction();
+        executer.execute(&cursor, LOMSE_NEW CmdAddNoteRest("(n a4 q v1)", k_edit_mode_replace),
+                         &sel);
+        doc.flush_deferred_changes();
+        CHECK( doc.is_in_transaction() == true );
+        pScore = static_cast<ImoScore*>( doc.get_im_root()->get_content_item(0) );
+        CHECK( pScore->get_staffobjs_table()->dump() == tableRef );
+        CHECK( cursor.get_pointee_id() == cursorRef.get_pointee_id() );
+        CHECK( *cursor != nullptr );
+        executer.commit_transaction();
+
+        CHECK( pScore->get_staffobjs_table()->dump() == tableRef );
+        CHECK( cursor.get_pointee_id() == cursorRef.get_pointee_id() );
+        ScoreCursor* pSC = static_cast<ScoreCursor*>( cursor.get_inner_cursor() );
+        ScoreCursor* pSCRef = static_cast<ScoreCursor*>( cursorRef.get_inner_cursor() );
+        CHECK( pSC->time() == pSCRef->time() );
+    }
+
 }
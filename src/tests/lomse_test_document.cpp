@@ -21,6 +21,7 @@
 #include "lomse_im_note.h"
 #include "lomse_events.h"
 #include "lomse_im_factory.h"
+#include "lomse_staffobjs_table.h"
 
 #include <exception>
 using namespace UnitTest;
@@ -92,6 +93,78 @@ SUITE(IdAssignerTest)
         CHECK( doc.get_pointer_to_imo(0L) == nullptr );
         delete pImo;
     }
+
+    TEST_FIXTURE(IdAssignerTestFixture, id_table_01)
+    {
+        //@01. dense ids: store, replace, erase
+        int a, b, c;
+        IdTable<int> table;
+        table.set(0, &a);
+        table.set(1, &b);
+        table.set(2, &c);
+        CHECK( table.size() == 3 );
+        CHECK( table.get(1) == &b );
+        CHECK( table.get(3) == nullptr );
+        CHECK( table.get(k_no_imoid) == nullptr );
+
+        table.set(1, &c);
+        CHECK( table.size() == 3 );
+        CHECK( table.get(1) == &c );
+
+        CHECK( table.erase(1) == true );
+        CHECK( table.erase(1) == false );
+        CHECK( table.size() == 2 );
+        CHECK( table.get(1) == nullptr );
+    }
+
+    TEST_FIXTURE(IdAssignerTestFixture, id_table_02)
+    {
+        //@02. far and negative ids go to the sparse map and are moved to the vector
+        //@    when it grows
+        int a, b, c;
+        IdTable<int> table;
+        table.set(1000000, &a);
+        table.set(k_no_imoid, &b);
+        CHECK( table.size() == 2 );
+        CHECK( table.get(1000000) == &a );
+        CHECK( table.get(k_no_imoid) == &b );
+
+        for (ImoId id=0; id < 1000000; id += 500)
+            table.set(id, &c);
+
+        CHECK( table.size() == 2002 );
+        CHECK( table.get(1000000) == &a );
+        CHECK( table.get(999500) == &c );
+        CHECK( table.get(999501) == nullptr );
+        CHECK( table.erase(1000000) == true );
+        CHECK( table.get(1000000) == nullptr );
+        CHECK( table.size() == 2001 );
+    }
+
+    TEST_FIXTURE(IdAssignerTestFixture, id_table_03)
+    {
+        //@03. iteration visits all entries, dense ids in ascending order
+        int a, b, c, d;
+        IdTable<int> table;
+        table.set(5, &a);
+        table.set(2, &b);
+        table.set(900000, &c);
+        table.set(3, &d);
+        table.erase(3);
+
+        IdTable<int>::const_iterator it = table.begin();
+        CHECK( it->first == 2 && it->second == &b );
+        ++it;
+        CHECK( it->first == 5 && it->second == &a );
+        ++it;
+        CHECK( it->first == 900000 && it->second == &c );
+        ++it;
+        CHECK( it == table.end() );
+
+        table.clear();
+        CHECK( table.begin() == table.end() );
+        CHECK( table.empty() == true );
+    }
 };
 
 
@@ -109,6 +182,17 @@ public:
    ~MyDocument4() override {}
 
     void my_clear_dirty() { clear_dirty(); }
+    void my_set_dirty() { set_dirty(); }
+};
+
+//---------------------------------------------------------------------------------------
+// MyDocModifiedHandler: counts the received events
+class MyDocModifiedHandler : public EventHandler
+{
+public:
+    int m_numEvents = 0;
+
+    void handle_event(SpEventInfo UNUSED(pEvent)) override { ++m_numEvents; }
 };
 
 
@@ -487,6 +571,72 @@ SUITE(DocumentTest)
         CHECK( doc.is_dirty() == false );
     }
 
+    TEST_FIXTURE(DocumentTestFixture, dirty_marks_121)
+    {
+        //@121. dirty marks in the model are cleared
+        Document doc(m_libraryScope);
+        doc.from_string("(score (vers 2.0)(instrument (musicData (n c4 q)(n e4 q))))");
+        ImoScore* pScore = static_cast<ImoScore*>( doc.get_im_root()->get_content_item(0) );
+        ImoMusicData* pMD = pScore->get_instrument(0)->get_musicdata();
+        ImoObj* pNote1 = pMD->get_child(0);
+        ImoObj* pNote2 = pMD->get_child(1);
+        CHECK( pNote1->is_dirty() == true );
+        CHECK( pScore->are_children_dirty() == true );
+
+        doc.clear_dirty_marks();
+
+        CHECK( pNote1->is_dirty() == false );
+        CHECK( pNote2->is_dirty() == false );
+        CHECK( pMD->are_children_dirty() == false );
+        CHECK( pScore->are_children_dirty() == false );
+        CHECK( doc.get_im_root()->are_children_dirty() == false );
+    }
+
+    TEST_FIXTURE(DocumentTestFixture, dirty_marks_122)
+    {
+        //@122. after clearing dirty marks, new marks are valid
+        Document doc(m_libraryScope);
+        doc.from_string("(score (vers 2.0)(instrument (musicData (n c4 q)(n e4 q))))");
+        ImoScore* pScore = static_cast<ImoScore*>( doc.get_im_root()->get_content_item(0) );
+        ImoMusicData* pMD = pScore->get_instrument(0)->get_musicdata();
+        ImoObj* pNote1 = pMD->get_child(0);
+        ImoObj* pNote2 = pMD->get_child(1);
+        doc.clear_dirty_marks();
+
+        pNote2->set_dirty(true);
+
+        CHECK( pNote1->is_dirty() == false );
+        CHECK( pNote2->is_dirty() == true );
+        CHECK( pMD->is_dirty() == false );
+        CHECK( pMD->are_children_dirty() == true );
+        CHECK( pScore->are_children_dirty() == true );
+
+        doc.clear_dirty_marks();
+
+        CHECK( pNote2->is_dirty() == false );
+        CHECK( pScore->are_children_dirty() == false );
+    }
+
+    TEST_FIXTURE(DocumentTestFixture, dirty_marks_123)
+    {
+        //@123. dirty marks are cleared when dirty objects have been deleted
+        Document doc(m_libraryScope);
+        doc.from_string("(score (vers 2.0)(instrument (musicData (n c4 q)(n e4 q))))");
+        ImoScore* pScore = static_cast<ImoScore*>( doc.get_im_root()->get_content_item(0) );
+        ImoMusicData* pMD = pScore->get_instrument(0)->get_musicdata();
+        ImoObj* pNote2 = pMD->get_child(1);
+        doc.clear_dirty_marks();
+
+        pNote2->set_dirty(true);
+        pMD->remove_child_imo(pNote2);
+        delete pNote2;
+        doc.clear_dirty_marks();
+
+        CHECK( pMD->are_children_dirty() == false );
+        CHECK( pScore->are_children_dirty() == false );
+        CHECK( doc.get_im_root()->are_children_dirty() == false );
+    }
+
     TEST_FIXTURE(DocumentTestFixture, other_130)
     {
         //@130. access to weak pointer
@@ -500,5 +650,118 @@ SUITE(DocumentTest)
         CHECK( wpDoc.expired() == false );
     }
 
-};
+    TEST_FIXTURE(DocumentTestFixture, node_pool_140)
+    {
+        //@140. the internal model is allocated in the document pool
+        Document doc(m_libraryScope);
+        NodePool* pPool = doc.get_doc_model()->get_node_pool();
+        size_t nodes = pPool->get_live_nodes();
+        doc.from_string("(score (vers 2.0)(instrument (musicData (clef G)(n c4 q))))");
+
+        CHECK( pPool->get_live_nodes() > nodes );
+        CHECK( NodePool::current() == nullptr );
+    }
 
+    TEST_FIXTURE(DocumentTestFixture, node_pool_141)
+    {
+        //@141. a copy of the model uses its own pool
+        Document doc(m_libraryScope);
+        doc.from_string("(score (vers 2.0)(instrument (musicData (clef G)(n c4 q))))");
+        NodePool* pPool = doc.get_doc_model()->get_node_pool();
+        size_t nodes = pPool->get_live_nodes();
+
+        DocModel* pCopy = doc.create_model_copy();
+
+        CHECK( pCopy->get_node_pool() != pPool );
+        CHECK( pCopy->get_node_pool()->get_live_nodes() == nodes );
+        CHECK( pPool->get_live_nodes() == nodes );
+        delete pCopy;
+        CHECK( pPool->get_live_nodes() == nodes );
+    }
+
+    TEST_FIXTURE(DocumentTestFixture, node_pool_142)
+    {
+        //@142. objects created without current pool are allocated in the heap
+        Document doc(m_libraryScope);
+        doc.create_empty();
+        NodePool* pPool = doc.get_doc_model()->get_node_pool();
+        size_t nodes = pPool->get_live_nodes();
+
+        ImoParagraph* pPara = doc.get_im_root()->add_paragraph();
+
+        CHECK( pPara != nullptr );
+        CHECK( pPool->get_live_nodes() == nodes );
+    }
+
+    TEST_FIXTURE(DocumentTestFixture, transaction_150)
+    {
+        //@150. in a transaction, the modified event is sent only when committing
+        MyDocument4 doc(m_libraryScope);
+        doc.from_string("(score (vers 2.0)(instrument (musicData (clef G)(n c4 q))))");
+        MyDocModifiedHandler handler;
+        doc.add_event_handler(k_doc_modified_event, &handler);
+
+        doc.begin_transaction();
+        doc.begin_transaction();
+        CHECK( doc.is_in_transaction() == true );
+        for (int i=0; i < 3; ++i)
+        {
+            doc.my_set_dirty();
+            doc.notify_if_document_modified();
+        }
+        doc.commit_transaction();
+        CHECK( doc.is_in_transaction() == true );
+        CHECK( handler.m_numEvents == 0 );
+
+        doc.commit_transaction();
+
+        CHECK( doc.is_in_transaction() == false );
+        CHECK( handler.m_numEvents == 1 );
+        CHECK( doc.is_dirty() == false );
+    }
+
+    TEST_FIXTURE(DocumentTestFixture, transaction_151)
+    {
+        //@151. in a transaction, the score structures are updated when committing
+        MyDocument4 doc(m_libraryScope);
+        doc.from_string("(score (vers 2.0)(instrument (musicData (clef G)(n c4 q))))");
+        ImoScore* pScore = static_cast<ImoScore*>( doc.get_im_root()->get_content_item(0) );
+        ImoMusicData* pMD = pScore->get_instrument(0)->get_musicdata();
+        CHECK( pScore->get_staffobjs_table()->num_entries() == 2 );
+
+        doc.begin_transaction();
+        for (int i=0; i < 3; ++i)
+        {
+            pMD->append_child_imo( doc.create_object_from_ldp("(n e4 q)") );
+            pScore->end_of_changes();
+        }
+
+        doc.commit_transaction();
+
+        CHECK( pScore->get_staffobjs_table()->num_entries() == 5 );
+    }
+
+    TEST_FIXTURE(DocumentTestFixture, transaction_152)
+    {
+        //@152. in a transaction, the score structures are updated when the deferred
+        //changes are flushed
+        MyDocument4 doc(m_libraryScope);
+        doc.from_string("(score (vers 2.0)(instrument (musicData (clef G)(n c4 q))))");
+        ImoScore* pScore = static_cast<ImoScore*>( doc.get_im_root()->get_content_item(0) );
+        ImoMusicData* pMD = pScore->get_instrument(0)->get_musicdata();
+
+        doc.begin_transaction();
+        pMD->append_child_imo( doc.create_object_from_ldp("(n e4 q)") );
+        pScore->end_of_changes();
+        doc.flush_deferred_changes();
+        CHECK( doc.is_in_transaction() == true );
+        CHECK( pScore->get_staffobjs_table()->num_entries() == 3 );
+        pMD->append_child_imo( doc.create_object_from_ldp("(n f4 q)") );
+        pScore->end_of_changes();
+
+        doc.commit_transaction();
+
+        CHECK( pScore->get_staffobjs_table()->num_entries() == 4 );
+    }
+
+};
@@ -26,6 +26,11 @@
 #include "lomse_internal_model.h"
 #include "lomse_inlines_container_layouter.h"
 #include "lomse_im_factory.h"
+#include "lomse_command.h"
+#include "lomse_selections.h"
+#include "lomse_document_cursor.h"
+#include "lomse_staffobjs_table.h"
+#include "lomse_gm_measures_table.h"
 
 using namespace UnitTest;
 using namespace std;
@@ -65,6 +70,88 @@ public:
     ~DocLayouterTestFixture()
     {
     }
+
+    std::string long_score(int numMeasures=40)
+    {
+        stringstream src;
+        src << "(score (vers 2.0)(instrument (musicData (clef G)(key C)(time 4 4)";
+        for (int i=0; i < numMeasures; ++i)
+            src << "(n c4 q)(n d4 q)(n e4 q)(n f4 q)(barline)";
+        src << ")))";
+        return src.str();
+    }
+
+    std::string long_score_two_instruments()
+    {
+        stringstream src;
+        src << "(score (vers 2.0)(instrument (musicData (clef G)(key D)(time 2 4)";
+        for (int i=0; i < 30; ++i)
+            src << "(n a4 e g+)(n b4 e g-)(n c5 q)(barline)";
+        src << "))(instrument (musicData (clef F4)(key D)(time 2 4)";
+        for (int i=0; i < 30; ++i)
+            src << "(n c3 q)(r q)(barline)";
+        src << ")))";
+        return src.str();
+    }
+
+    std::string long_score_with_relations()
+    {
+        stringstream src;
+        src << "(score (vers 2.0)(instrument (musicData (clef G)(key F)(time 3 4)";
+        for (int i=0; i < 60; ++i)
+        {
+            src << "(n c5 q (slur " << i << " start)(lyric 1 \"la\"))"
+                << "(n d5 e g+)(n e5 e g-)(n f5 q (tie " << i << " start))(barline)"
+                << "(n f5 q (tie " << i << " stop))(n e5 q (lyric 1 \"la\"))"
+                << "(n d5 q (slur " << i << " stop))(barline)";
+        }
+        src << ")))";
+        return src.str();
+    }
+
+    //lays out the document as the Interactor does, saving the dirty marks reference
+    GraphicModel* layout(Document* pDoc, GraphicModel* pPrevGModel=nullptr)
+    {
+        DocLayouter lyt(pDoc, m_libraryScope);
+        if (pPrevGModel)
+            lyt.update_document(pPrevGModel);
+        else
+            lyt.layout_document();
+        GraphicModel* pGModel = lyt.get_graphic_model();
+        pDoc->clear_dirty_marks();
+        pGModel->set_dirty_marks_ref( pDoc->get_dirty_marks_ref() );
+        return pGModel;
+    }
+
+    void change_accidentals(Document* pDoc, int iNote)
+    {
+        ImoScore* pScore = static_cast<ImoScore*>( pDoc->get_im_root()->get_content_item(0) );
+        ColStaffObjs* pTable = pScore->get_staffobjs_table();
+        ImoId id = k_no_imoid;
+        int i = 0;
+        for (ColStaffObjsIterator it = pTable->begin(); it != pTable->end(); ++it)
+        {
+            if ((*it)->imo_object()->is_note() && i++ == iNote)
+            {
+                id = (*it)->imo_object()->get_id();
+                break;
+            }
+        }
+
+        DocCursor cursor(pDoc);
+        SelectionSet sel(pDoc);
+        sel.add(id);
+        DocCommandExecuter executer(pDoc);
+        executer.execute(&cursor, LOMSE_NEW CmdChangeAccidentals(k_sharp), &sel);
+    }
+
+    std::string dump(GraphicModel* pGModel)
+    {
+        stringstream ss;
+        for (int i=0; i < pGModel->get_num_pages(); ++i)
+            pGModel->dump_page(i, ss);
+        return ss.str();
+    }
 };
 
 //---------------------------------------------------------------------------------------
@@ -500,4 +587,241 @@ SUITE(DocLayouterTest)
     }
 
 
+    TEST_FIXTURE(DocLayouterTestFixture, DocLayouter_update_001)
+    {
+        //@001. After editing a note in last systems, first systems are reused and
+        //      the result is the same than a full layout
+
+        Document doc(m_libraryScope);
+        doc.from_string( long_score() );
+        ImoId scoreId = doc.get_im_root()->get_content_item(0)->get_id();
+        GraphicModel* pPrevGModel = layout(&doc);
+        GmoBoxSystem* pFirstSystem = pPrevGModel->get_system_box(0, scoreId);
+
+        change_accidentals(&doc, 150);
+        GraphicModel* pGModel = layout(&doc, pPrevGModel);
+        GraphicModel* pFullGModel = layout(&doc);
+
+        CHECK( pGModel->get_system_box(0, scoreId) == pFirstSystem );
+        CHECK( dump(pGModel) == dump(pFullGModel) );
+
+        delete pGModel;
+        delete pFullGModel;
+    }
+
+    TEST_FIXTURE(DocLayouterTestFixture, DocLayouter_update_002)
+    {
+        //@002. Systems after the modified one are reused when line breaks do not
+        //      change. The last system is always engraved again
+
+        Document doc(m_libraryScope);
+        doc.from_string( long_score(120) );
+        ImoId scoreId = doc.get_im_root()->get_content_item(0)->get_id();
+        GraphicModel* pPrevGModel = layout(&doc);
+        int numSystems = pPrevGModel->get_num_systems(scoreId);
+        vector<GmoBoxSystem*> systems;
+        for (int i=0; i < numSystems; ++i)
+            systems.push_back( pPrevGModel->get_system_box(i, scoreId) );
+
+        change_accidentals(&doc, 2);    //e4, accidental inside the staff
+        GraphicModel* pGModel = layout(&doc, pPrevGModel);
+        GraphicModel* pFullGModel = layout(&doc);
+
+        CHECK( numSystems > 3 );
+        CHECK( pGModel->get_num_systems(scoreId) == numSystems );
+        CHECK( pGModel->get_system_box(0, scoreId) != systems[0] );
+        for (int i=1; i < numSystems - 1; ++i)
+            CHECK( pGModel->get_system_box(i, scoreId) == systems[i] );
+        CHECK( pGModel->get_system_box(numSystems - 1, scoreId) != systems.back() );
+        CHECK( dump(pGModel) == dump(pFullGModel) );
+
+        delete pGModel;
+        delete pFullGModel;
+    }
+
+    TEST_FIXTURE(DocLayouterTestFixture, DocLayouter_update_003)
+    {
+        //@003. Previous model is not used when dirty marks were cleared after
+        //      building it
+
+        Document doc(m_libraryScope);
+        doc.from_string( long_score() );
+        ImoId scoreId = doc.get_im_root()->get_content_item(0)->get_id();
+        GraphicModel* pPrevGModel = layout(&doc);
+        GmoBoxSystem* pFirstSystem = pPrevGModel->get_system_box(0, scoreId);
+
+        change_accidentals(&doc, 150);
+        doc.clear_dirty_marks();
+        GraphicModel* pGModel = layout(&doc, pPrevGModel);
+
+        CHECK( pGModel->get_system_box(0, scoreId) != pFirstSystem );
+
+        delete pGModel;
+    }
+
+    TEST_FIXTURE(DocLayouterTestFixture, DocLayouter_update_004)
+    {
+        //@004. Systems reused in score with several instruments and beams
+
+        Document doc(m_libraryScope);
+        doc.from_string( long_score_two_instruments() );
+        ImoId scoreId = doc.get_im_root()->get_content_item(0)->get_id();
+        GraphicModel* pPrevGModel = layout(&doc);
+        GmoBoxSystem* pFirstSystem = pPrevGModel->get_system_box(0, scoreId);
+
+        change_accidentals(&doc, 100);
+        GraphicModel* pGModel = layout(&doc, pPrevGModel);
+        GraphicModel* pFullGModel = layout(&doc);
+
+        CHECK( pGModel->get_system_box(0, scoreId) == pFirstSystem );
+        CHECK( dump(pGModel) == dump(pFullGModel) );
+
+        delete pGModel;
+        delete pFullGModel;
+    }
+
+    TEST_FIXTURE(DocLayouterTestFixture, DocLayouter_update_005)
+    {
+        //@005. Editing a note in a middle system. Systems before and after it are
+        //      reused and the result is the same than a full layout
+
+        Document doc(m_libraryScope);
+        doc.from_string( long_score_two_instruments() );
+        ImoId scoreId = doc.get_im_root()->get_content_item(0)->get_id();
+        GraphicModel* pPrevGModel = layout(&doc);
+        int numSystems = pPrevGModel->get_num_systems(scoreId);
+        GmoBoxSystem* pFirstSystem = pPrevGModel->get_system_box(0, scoreId);
+        GmoBoxSystem* pTrailingSystem = pPrevGModel->get_system_box(numSystems - 2, scoreId);
+
+        change_accidentals(&doc, 45);
+        GraphicModel* pGModel = layout(&doc, pPrevGModel);
+        GraphicModel* pFullGModel = layout(&doc);
+
+        CHECK( numSystems > 3 );
+        CHECK( pGModel->get_system_box(0, scoreId) == pFirstSystem );
+        CHECK( pGModel->get_system_box(numSystems - 2, scoreId) == pTrailingSystem );
+        CHECK( dump(pGModel) == dump(pFullGModel) );
+
+        //the measures table uses the barlines in the reused systems
+        GmMeasuresTable* pTable = pGModel->get_stub_for(scoreId)->get_measures_table();
+        GmMeasuresTable* pFullTable = pFullGModel->get_stub_for(scoreId)->get_measures_table();
+        GmoBoxSystem* pBox = pGModel->get_system_box(0, scoreId);
+        for (int i=0; i < pTable->get_num_measures(0); ++i)
+        {
+            CHECK( pTable->get_end_barline_left(0, i, pBox)
+                   == pFullTable->get_end_barline_left(0, i, pBox) );
+        }
+
+        delete pGModel;
+        delete pFullGModel;
+    }
+
+    TEST_FIXTURE(DocLayouterTestFixture, DocLayouter_update_006)
+    {
+        //@006. Slurs, ties and lyrics crossing systems. Same result than a full layout
+
+        Document doc(m_libraryScope);
+        doc.from_string( long_score_with_relations() );
+        GraphicModel* pPrevGModel = layout(&doc);
+
+        change_accidentals(&doc, 150);
+        GraphicModel* pGModel = layout(&doc, pPrevGModel);
+        GraphicModel* pFullGModel = layout(&doc);
+
+        CHECK( dump(pGModel) == dump(pFullGModel) );
+
+        delete pGModel;
+        delete pFullGModel;
+    }
+
+#if (LOMSE_ENABLE_THREADS == 1)
+
+    TEST_FIXTURE(DocLayouterTestFixture, DocLayouter_parallel_001)
+    {
+        //@001. Systems engraved in parallel. Same result than serial engraving
+
+        Document doc(m_libraryScope);
+        doc.from_string( long_score_two_instruments() );
+        GraphicModel* pSerialGModel = layout(&doc);
+        m_libraryScope.set_engrave_systems_in_parallel(true);
+        m_libraryScope.set_num_engraving_threads(4);
+        GraphicModel* pGModel = layout(&doc);
+
+        CHECK( pGModel->get_num_pages() == pSerialGModel->get_num_pages() );
+        CHECK( dump(pGModel) == dump(pSerialGModel) );
+
+        delete pGModel;
+        delete pSerialGModel;
+    }
+
+    TEST_FIXTURE(DocLayouterTestFixture, DocLayouter_parallel_002)
+    {
+        //@002. Slurs, ties and lyrics crossing systems engraved in parallel. Same
+        //      result than serial engraving
+
+        Document doc(m_libraryScope);
+        doc.from_string( long_score_with_relations() );
+        GraphicModel* pSerialGModel = layout(&doc);
+        m_libraryScope.set_engrave_systems_in_parallel(true);
+        m_libraryScope.set_num_engraving_threads(4);
+        GraphicModel* pGModel = layout(&doc);
+
+        CHECK( pGModel->get_num_pages() > 1 );
+        CHECK( dump(pGModel) == dump(pSerialGModel) );
+
+        delete pGModel;
+        delete pSerialGModel;
+    }
+
+    TEST_FIXTURE(DocLayouterTestFixture, DocLayouter_parallel_003)
+    {
+        //@003. Reused systems are not engraved again when engraving in parallel
+
+        m_libraryScope.set_engrave_systems_in_parallel(true);
+        m_libraryScope.set_num_engraving_threads(4);
+        Document doc(m_libraryScope);
+        doc.from_string( long_score_two_instruments() );
+        ImoId scoreId = doc.get_im_root()->get_content_item(0)->get_id();
+        GraphicModel* pPrevGModel = layout(&doc);
+        GmoBoxSystem* pFirstSystem = pPrevGModel->get_system_box(0, scoreId);
+
+        change_accidentals(&doc, 40);
+        GraphicModel* pGModel = layout(&doc, pPrevGModel);
+        m_libraryScope.set_engrave_systems_in_parallel(false);
+        GraphicModel* pSerialGModel = layout(&doc);
+
+        CHECK( pGModel->get_system_box(0, scoreId) == pFirstSystem );
+        CHECK( dump(pGModel) == dump(pSerialGModel) );
+
+        delete pGModel;
+        delete pSerialGModel;
+    }
+
+    TEST_FIXTURE(DocLayouterTestFixture, DocLayouter_parallel_004)
+    {
+        //@004. Systems after the modified one are reused when engraving in parallel
+
+        m_libraryScope.set_engrave_systems_in_parallel(true);
+        m_libraryScope.set_num_engraving_threads(4);
+        Document doc(m_libraryScope);
+        doc.from_string( long_score(120) );
+        ImoId scoreId = doc.get_im_root()->get_content_item(0)->get_id();
+        GraphicModel* pPrevGModel = layout(&doc);
+        int numSystems = pPrevGModel->get_num_systems(scoreId);
+        GmoBoxSystem* pTrailingSystem = pPrevGModel->get_system_box(numSystems - 2, scoreId);
+
+        change_accidentals(&doc, 2);
+        GraphicModel* pGModel = layout(&doc, pPrevGModel);
+        m_libraryScope.set_engrave_systems_in_parallel(false);
+        GraphicModel* pSerialGModel = layout(&doc);
+
+        CHECK( pGModel->get_system_box(numSystems - 2, scoreId) == pTrailingSystem );
+        CHECK( dump(pGModel) == dump(pSerialGModel) );
+
+        delete pGModel;
+        delete pSerialGModel;
+    }
+
+#endif  //LOMSE_ENABLE_THREADS
+
 };
@@ -0,0 +1,478 @@
+//---------------------------------------------------------------------------------------
+// This file is part of the Lomse library.
+// Copyright (c) 2010-present, Lomse Developers
+//
+// Licensed under the MIT license.
+//
+// See LICENSE and NOTICE.md files in the root directory of this source tree.
+//---------------------------------------------------------------------------------------
+
+#define LOMSE_INTERNAL_API
+#include <UnitTest++.h>
+#include <sstream>
+#include <cstdio>
+#include <algorithm>
+#include <set>
+#include "lomse_config.h"
+#include "lomse_build_options.h"
+
+//classes related to these tests
+#include "lomse_im_snapshot.h"
+#include "lomse_injectors.h"
+#include "private/lomse_document_p.h"
+#include "lomse_internal_model.h"
+#include "lomse_im_factory.h"
+#include "lomse_staffobjs_table.h"
+#include "lomse_im_measures_table.h"
+#include "lomse_doorway.h"
+#include "lomse_presenter.h"
+#include "lomse_interactor.h"
+#include "lomse_graphic_view.h"
+#include "lomse_mxl_exporter.h"
+
+using namespace UnitTest;
+using namespace std;
+using namespace lomse;
+
+
+//---------------------------------------------------------------------------------------
+class ImSnapshotTestFixture
+{
+public:
+    LibraryScope m_libraryScope;
+    std::string m_scores_path;
+
+    ImSnapshotTestFixture()     //SetUp fixture
+        : m_libraryScope(cout)
+        , m_scores_path(TESTLIB_SCORES_PATH)
+    {
+        m_libraryScope.set_default_fonts_path(TESTLIB_FONTS_PATH);
+    }
+
+    ~ImSnapshotTestFixture()    //TearDown fixture
+    {
+    }
+
+    //-----------------------------------------------------------------------------------
+    inline const char* test_name()
+    {
+        return UnitTest::CurrentTest::Details()->testName;
+    }
+
+    //-----------------------------------------------------------------------------------
+    int format_for(const string& filename)
+    {
+        string ext = filename.substr(filename.size() - 3);
+        if (ext == "lms")
+            return Document::k_format_ldp;
+        if (ext == "lmd")
+            return Document::k_format_lmd;
+        return Document::k_format_mxl;
+    }
+
+    //-----------------------------------------------------------------------------------
+    string dump_tables(Document& doc)
+    {
+        stringstream ss;
+        ImoScore* pScore = dynamic_cast<ImoScore*>( doc.get_im_root()->get_content_item(0) );
+        if (!pScore)
+            return "no score";
+
+        ss << pScore->get_staffobjs_table()->dump(true);
+        for (int i=0; i < pScore->get_num_instruments(); ++i)
+        {
+            ImMeasuresTable* pTable = pScore->get_instrument(i)->get_measures_table();
+            ss << (pTable ? pTable->dump() : string("no measures")) << endl;
+        }
+        return ss.str();
+    }
+
+    //-----------------------------------------------------------------------------------
+    string sorted_ids(Document& doc)
+    {
+        stringstream ss(doc.dump_ids());
+        vector<string> lines;
+        string line;
+        while (getline(ss, line))
+            lines.push_back(line);
+        sort(lines.begin(), lines.end());
+
+        string ids;
+        for (const string& id : lines)
+            ids += id + "\n";
+        return ids;
+    }
+
+    //-----------------------------------------------------------------------------------
+    string render(LomseDoorway& doorway, const string& source, int format)
+    {
+        stringstream errors;
+        Presenter* pPresenter = doorway.new_document(k_view_vertical_book, source,
+                                                     format, errors);
+        Interactor* pIntor = pPresenter->get_interactor_raw_ptr(0);
+        stringstream svg;
+        pIntor->render_as_svg(svg, 0);
+        delete pPresenter;
+        return svg.str();
+    }
+
+    //-----------------------------------------------------------------------------------
+    string render_file(LomseDoorway& doorway, const string& filename)
+    {
+        stringstream errors;
+        Presenter* pPresenter = doorway.open_document(k_view_vertical_book, filename,
+                                                      errors);
+        Interactor* pIntor = pPresenter->get_interactor_raw_ptr(0);
+        stringstream svg;
+        pIntor->render_as_svg(svg, 0);
+        delete pPresenter;
+        return svg.str();
+    }
+
+    //-----------------------------------------------------------------------------------
+    string save_snapshot(const string& filename)
+    {
+        Document doc(m_libraryScope);
+        doc.from_file(m_scores_path + filename, format_for(filename));
+        stringstream out;
+        doc.save_snapshot(out);
+        return out.str();
+    }
+
+    //-----------------------------------------------------------------------------------
+    string save_node(DocModel* pModel, ImoObj* pImo)
+    {
+        ImSnapshotArchive ar(pModel);
+        ar.io_node(pImo);
+        return ar.get_saved_data();
+    }
+
+    //-----------------------------------------------------------------------------------
+    bool is_snapshot_supported(ImoObj* pImo)
+    {
+        return !(pImo->is_dto() || pImo->is_control() || pImo->is_cursor_info()
+                 || pImo->is_figured_bass());
+    }
+
+    //-----------------------------------------------------------------------------------
+    string export_scores(ImoDocument* pImoDoc)
+    {
+        string source;
+        MxlExporter exporter(m_libraryScope);
+        exporter.set_remove_newlines(true);
+        for (int i=0; i < pImoDoc->get_num_content_items(); ++i)
+        {
+            ImoContentObj* pItem = pImoDoc->get_content_item(i);
+            if (pItem->is_score())
+                source += exporter.get_source(pItem);
+        }
+        return source;
+    }
+
+    //-----------------------------------------------------------------------------------
+    string check_round_trip(Document& doc, set<int>& tested)
+    {
+        //The document restored from a snapshot (serialize() methods) is compared with
+        //a fresh clone of the model (copy constructors). The exporters access the
+        //members directly, so the LDP and MusicXML sources differ when a member is
+        //not saved. Also, each object of a type not yet tested, found by its id, must
+        //be saved again with the same content. Returns the differences found
+
+        stringstream out;
+        CHECK( doc.save_snapshot(out) == true );
+        Document doc2(m_libraryScope);
+        string data = out.str();
+        CHECK( doc2.from_buffer(data.data(), data.size(),
+                                Document::k_format_snapshot) == 0 );
+
+        DocModel* pCopy = doc.create_model_copy();
+        DocModel* pRestored = doc2.get_doc_model();
+        string errors;
+        if (pCopy->get_im_root()->to_string(true)
+            != pRestored->get_im_root()->to_string(true))
+        {
+            errors += "(ldp source) ";
+        }
+        if (export_scores(pCopy->get_im_root()) != export_scores(pRestored->get_im_root()))
+            errors += "(musicxml source) ";
+
+        ImoId maxId = max(pCopy->get_last_assigned_id(), pRestored->get_last_assigned_id());
+        for (ImoId id=0; id <= maxId; ++id)
+        {
+            ImoObj* pClonedImo = pCopy->get_pointer_to_imo(id);
+            ImoObj* pRestoredImo = pRestored->get_pointer_to_imo(id);
+            if (!pClonedImo || !pRestoredImo)
+            {
+                if (pClonedImo || pRestoredImo)
+                    errors += "(id " + std::to_string(id) + ") ";
+                continue;
+            }
+
+            int type = pClonedImo->get_obj_type();
+            if (tested.count(type) > 0)
+                continue;
+            tested.insert(type);
+
+            if (pRestoredImo->get_obj_type() != type
+                || save_node(pRestored, pRestoredImo) != save_node(pCopy, pClonedImo))
+            {
+                errors += pClonedImo->get_name() + " ";
+            }
+        }
+        delete pCopy;
+        return errors;
+    }
+
+};
+
+
+SUITE(ImSnapshotTest)
+{
+
+    TEST_FIXTURE(ImSnapshotTestFixture, snapshot_001)
+    {
+        //@001. the restored model and tables are equal to the saved ones
+
+        const vector<string> files = {
+            "unit-tests/other/01-issue-with-natural.xml",
+            "unit-tests/other/02-barlines.xml",
+            "unit-tests/other/03-BeetAnGeSample.xml",
+            "unit-tests/other/04-multimetric.lms",
+        };
+
+        for (const string& file : files)
+        {
+            Document doc(m_libraryScope);
+            doc.from_file(m_scores_path + file, format_for(file));
+            stringstream out;
+            CHECK( doc.save_snapshot(out) == true );
+
+            stringstream errors;
+            Document doc2(m_libraryScope, errors);
+            string data = out.str();
+            CHECK( doc2.from_buffer(data.data(), data.size(),
+                                    Document::k_format_snapshot) == 0 );
+
+            CHECK( errors.str() == "" );
+            CHECK( doc.to_string(true) == doc2.to_string(true) );
+            CHECK( dump_tables(doc) == dump_tables(doc2) );
+            CHECK( sorted_ids(doc) == sorted_ids(doc2) );
+        }
+    }
+
+    TEST_FIXTURE(ImSnapshotTestFixture, snapshot_002)
+    {
+        //@002. relations and text content are restored
+
+        Document doc(m_libraryScope);
+        doc.from_string("(lenmusdoc (vers 0.0)(content "
+            "(para (txt \"Hello world\"))"
+            "(score (vers 2.0)(instrument (musicData (clef G)"
+            "(n c4 e (t +)(beam 1 +)(slur 1 start))(n c4 e (t -)(beam 1 -))"
+            "(chord (n e4 q)(n g4 q)(slur 1 stop))"
+            "(t + 2 3)(n c4 e)(n d4 e)(n e4 e)(t -)"
+            "(n f4 q (lyric \"la\"))(barline) )))))");
+        stringstream out;
+        CHECK( doc.save_snapshot(out) == true );
+
+        Document doc2(m_libraryScope);
+        doc2.from_string(out.str(), Document::k_format_snapshot);
+
+        CHECK( doc2.get_im_root()->get_num_content_items() == 2 );
+        CHECK( doc.to_string(true) == doc2.to_string(true) );
+        CHECK( dump_tables(doc) == dump_tables(doc2) );
+    }
+
+    TEST_FIXTURE(ImSnapshotTestFixture, snapshot_003)
+    {
+        //@003. rendering the restored document gives the same result
+
+        LomseDoorway doorway;
+        doorway.init_library(k_pix_format_rgba32, 96);
+        doorway.set_default_fonts_path(TESTLIB_FONTS_PATH);
+
+        string file = "unit-tests/other/03-BeetAnGeSample.xml";
+        string source = save_snapshot(file);
+
+        string expected = render_file(doorway, m_scores_path + file);
+        CHECK( render(doorway, source, Document::k_format_snapshot) == expected );
+    }
+
+    TEST_FIXTURE(ImSnapshotTestFixture, snapshot_004)
+    {
+        //@004. snapshot files are identified by extension
+
+        LomseDoorway doorway;
+        doorway.init_library(k_pix_format_rgba32, 96);
+        doorway.set_default_fonts_path(TESTLIB_FONTS_PATH);
+
+        string file = "unit-tests/other/04-multimetric.lms";
+        Document doc(m_libraryScope);
+        doc.from_file(m_scores_path + file, Document::k_format_ldp);
+        string filename = m_scores_path + "../z_test_snapshot.lmsnap";
+        CHECK( doc.save_snapshot(filename) == true );
+
+        string expected = render_file(doorway, m_scores_path + file);
+        CHECK( render_file(doorway, filename) == expected );
+        std::remove(filename.c_str());
+    }
+
+    TEST_FIXTURE(ImSnapshotTestFixture, snapshot_005)
+    {
+        //@005. truncated data is rejected
+
+        string data = save_snapshot("unit-tests/other/02-barlines.xml");
+        data.resize(data.size() - 10);
+
+        stringstream errors;
+        Document doc(m_libraryScope, errors);
+        CHECK( doc.from_string(data, Document::k_format_snapshot) == 1 );
+        CHECK( errors.str() == "Invalid snapshot: truncated data.\n" );
+        CHECK( doc.get_im_root()->get_num_content_items() == 0 );
+    }
+
+    TEST_FIXTURE(ImSnapshotTestFixture, snapshot_006)
+    {
+        //@006. corrupted data is rejected
+
+        string data = save_snapshot("unit-tests/other/02-barlines.xml");
+        data[data.size() / 2] ^= 0x10;
+
+        stringstream errors;
+        Document doc(m_libraryScope, errors);
+        CHECK( doc.from_string(data, Document::k_format_snapshot) == 1 );
+        CHECK( errors.str() == "Invalid snapshot: corrupted data.\n" );
+        CHECK( doc.get_im_root()->get_num_content_items() == 0 );
+    }
+
+    TEST_FIXTURE(ImSnapshotTestFixture, snapshot_007)
+    {
+        //@007. other content is rejected
+
+        stringstream errors;
+        Document doc(m_libraryScope, errors);
+        CHECK( doc.from_string("(score (vers 2.0))", Document::k_format_snapshot) == 1 );
+        CHECK( errors.str() == "Invalid snapshot: not a snapshot or truncated data.\n" );
+        CHECK( doc.get_im_root()->get_num_content_items() == 0 );
+    }
+
+    TEST_FIXTURE(ImSnapshotTestFixture, snapshot_008)
+    {
+        //@008. round trip for each node type: the restored node is equal to a fresh
+        //clone of the saved node. A member not saved in serialize() fails here
+
+        const vector<string> files = {
+            "unit-tests/other/03-BeetAnGeSample.xml",
+            "unit-tests/other/04-multimetric.lms",
+            "unit-tests/arpeggios/301-arpeggiated-chord-up.xml",
+            "unit-tests/xml-export/015-volta-brackets.xml",
+            "unit-tests/docmodel/02091-lyrics-melisma-hyphenation.lms",
+            "02010-graphic-line-text.lms",
+            "02020-fermatas.lms",
+            "02030-metronome.lms",
+            "02041-text-titles.lms",
+            "02050-textbox.lms",
+            "02070-dynamics-marks.lms",
+            "08021-small-table.lmd",
+            "08022-table-merged-cells.lms",
+            "08042-read-png-image.lms",
+            "09003-ebook-three-pages.lms",
+            "09009-dynamic-object.lms",
+            "00180-new-system.lms",
+            "00181-go-back.lms",
+            "00228-group-joined-barlines.lms",
+            "01013-tuplet-only-bracket.lms",
+            "01031-tie-bezier.lms",
+            "50021-articulations.xml",
+            "50060-fingering.xml",
+            "50500-tablature-sample.xml",
+            "unit-tests/repeats/58-repeat-dal-segno-al-coda.xml",
+            "unit-tests/transpose/001-transpose.xml",
+            "unit-tests/xml-export/004-cue-note.xml",
+            "unit-tests/xml-export/005-octave-shift.xml",
+            "unit-tests/xml-export/010-pedal-lines.xml",
+        };
+
+        set<int> tested;
+        for (const string& file : files)
+        {
+            Document doc(m_libraryScope);
+            doc.from_file(m_scores_path + file, format_for(file));
+            string errors = check_round_trip(doc, tested);
+            CHECK( errors == "" );
+            if (errors != "")
+                cout << test_name() << ", " << file << ": " << errors << endl;
+        }
+
+        //objects that can only be created by using the API
+        {
+            Document doc(m_libraryScope);
+            doc.from_string("(lenmusdoc (vers 0.0)(content "
+                "(heading 1 (txt \"Title\"))"
+                "(para (txt \"Hello \")(link (url \"https://lenmus.org\")(txt \"link\")))"
+                "(itemizedlist (listitem (txt \"item\")))"
+                "(dynamic (classid example)(param max \"5\"))"
+                "(score (vers 2.0)(instrument (musicData (clef G)(n c4 q)))) ))");
+            ImoDocument* pImoDoc = doc.get_im_root();
+            ImoScore* pScore = static_cast<ImoScore*>( pImoDoc->get_content_item(4) );
+            ImoMusicData* pMD = pScore->get_instrument(0)->get_musicdata();
+            ImoNote* pNote = static_cast<ImoNote*>( pMD->get_last_child() );
+            pNote->add_attachment( static_cast<ImoAuxObj*>(
+                                        ImFactory::inject(k_imo_line, &doc) ));
+            ImoMultiColumn* pMC = pImoDoc->add_multicolumn_wrapper(2);
+            ImoParagraph* pPara = pMC->get_column(0)->add_paragraph();
+            pPara->add_inline_box(1000.0f)->add_text_item("boxed");
+
+            string errors = check_round_trip(doc, tested);
+            CHECK( errors == "" );
+            if (errors != "")
+                cout << test_name() << ", API: " << errors << endl;
+        }
+
+        //technical marks: there is no score with them in the tests folder
+        {
+            Document doc(m_libraryScope);
+            doc.from_string("<score-partwise version='3.0'><part-list>"
+                "<score-part id='P1'><part-name>Music</part-name></score-part>"
+                "</part-list><part id='P1'><measure number='1'>"
+                "<attributes><divisions>1</divisions><clef><sign>G</sign>"
+                    "<line>2</line></clef></attributes>"
+                "<note><pitch><step>C</step><octave>4</octave></pitch>"
+                    "<duration>4</duration><type>whole</type>"
+                    "<notations><technical><up-bow/></technical></notations></note>"
+                "</measure></part></score-partwise>",
+                Document::k_format_mxl);
+
+            string errors = check_round_trip(doc, tested);
+            CHECK( errors == "" );
+            if (errors != "")
+                cout << test_name() << ", technical: " << errors << endl;
+        }
+
+        //all node types that can be saved must be tested. System info and text
+        //block info are members of their owner, not nodes, and are saved by it
+        tested.insert(k_imo_system_info);
+        tested.insert(k_imo_textblock_info);
+        Document doc(m_libraryScope);
+        string missing;
+        for (int type = k_imo_obj; type < k_imo_last; ++type)
+        {
+            ImoObj* pImo = nullptr;
+            try
+            {
+                pImo = ImFactory::restore(type, doc.get_doc_model(), k_no_imoid);
+            }
+            catch (...)
+            {
+                continue;   //abstract class or DTO
+            }
+            if (is_snapshot_supported(pImo) && tested.count(type) == 0)
+                missing += pImo->get_name() + " ";
+            delete pImo;
+        }
+        CHECK( missing == "" );
+        if (missing != "")
+            cout << test_name() << ", types not tested: " << missing << endl;
+    }
+
+}
@@ -0,0 +1,178 @@
+//---------------------------------------------------------------------------------------
+// This file is part of the Lomse library.
+// Copyright (c) 2010-present, Lomse Developers
+//
+// Licensed under the MIT license.
+//
+// See LICENSE and NOTICE.md files in the root directory of this source tree.
+//---------------------------------------------------------------------------------------
+
+#define LOMSE_INTERNAL_API
+#include <UnitTest++.h>
+#include <sstream>
+#include "lomse_config.h"
+
+//classes related to these tests
+#include "lomse_import_stats.h"
+#include "lomse_injectors.h"
+#include "private/lomse_document_p.h"
+#include "lomse_document.h"
+#include "lomse_internal_model.h"
+#include "lomse_model_builder.h"
+
+using namespace UnitTest;
+using namespace std;
+using namespace lomse;
+
+
+//---------------------------------------------------------------------------------------
+class ImportStatsTestFixture
+{
+public:
+    LibraryScope m_libraryScope;
+    std::string m_scores_path;
+
+    ImportStatsTestFixture()     //SetUp fixture
+        : m_libraryScope(cout)
+        , m_scores_path(TESTLIB_SCORES_PATH)
+    {
+        m_libraryScope.set_default_fonts_path(TESTLIB_FONTS_PATH);
+    }
+
+    ~ImportStatsTestFixture()    //TearDown fixture
+    {
+    }
+};
+
+
+SUITE(ImportStatsTest)
+{
+
+    TEST_FIXTURE(ImportStatsTestFixture, import_stats_001)
+    {
+        //@001. initially, all counters are zero
+
+        Document doc(m_libraryScope);
+        const ImportStats& stats = doc.get_import_stats();
+
+        CHECK( stats.get_total_time() == 0.0 );
+        for (int i=0; i < ImportStats::k_import_max_phase; ++i)
+        {
+            CHECK( stats.get_elapsed_time(i) == 0.0 );
+            CHECK( stats.get_nodes_created(i) == 0L );
+        }
+    }
+
+    TEST_FIXTURE(ImportStatsTestFixture, import_stats_002)
+    {
+        //@002. LDP file. Phases are recorded
+
+        Document doc(m_libraryScope);
+        doc.from_file(m_scores_path + "unit-tests/other/04-multimetric.lms",
+                      Document::k_format_ldp);
+        const ImportStats& stats = doc.get_import_stats();
+
+        CHECK( stats.get_total_time() > 0.0 );
+        CHECK( stats.get_elapsed_time(ImportStats::k_import_parse) > 0.0 );
+        CHECK( stats.get_elapsed_time(ImportStats::k_import_analyse) > 0.0 );
+        CHECK( stats.get_elapsed_time(ImportStats::k_import_staffobjs_table) > 0.0 );
+        CHECK( stats.get_elapsed_time(ImportStats::k_import_restore) == 0.0 );
+        CHECK( stats.get_nodes_created(ImportStats::k_import_parse) == 0L );
+        CHECK( stats.get_nodes_created(ImportStats::k_import_analyse) > 0L );
+
+        double sum = 0.0;
+        for (int i=0; i < ImportStats::k_import_max_phase; ++i)
+            sum += stats.get_elapsed_time(i);
+        CHECK( sum <= stats.get_total_time() );
+    }
+
+    TEST_FIXTURE(ImportStatsTestFixture, import_stats_003)
+    {
+        //@003. MusicXML file. Phases are recorded
+
+        Document doc(m_libraryScope);
+        doc.from_file(m_scores_path + "unit-tests/other/03-BeetAnGeSample.xml",
+                      Document::k_format_mxl);
+        const ImportStats& stats = doc.get_import_stats();
+
+        CHECK( stats.get_elapsed_time(ImportStats::k_import_parse) > 0.0 );
+        CHECK( stats.get_elapsed_time(ImportStats::k_import_analyse) > 0.0 );
+        CHECK( stats.get_elapsed_time(ImportStats::k_import_measures_table) > 0.0 );
+        CHECK( stats.get_nodes_created(ImportStats::k_import_analyse) > 0L );
+    }
+
+    TEST_FIXTURE(ImportStatsTestFixture, import_stats_004)
+    {
+        //@004. stats are recorded for each document
+
+        Document doc(m_libraryScope);
+        doc.from_file(m_scores_path + "unit-tests/other/03-BeetAnGeSample.xml",
+                      Document::k_format_mxl);
+        long nodes = doc.get_import_stats().get_nodes_created(ImportStats::k_import_analyse);
+
+        Document doc2(m_libraryScope);
+        doc2.from_string("(score (vers 2.0)(instrument (musicData (clef G)(n c4 q))))");
+        const ImportStats& stats = doc2.get_import_stats();
+
+        CHECK( stats.get_nodes_created(ImportStats::k_import_analyse) > 0L );
+        CHECK( stats.get_nodes_created(ImportStats::k_import_analyse) < nodes );
+        CHECK( doc.get_import_stats().get_nodes_created(ImportStats::k_import_analyse)
+               == nodes );
+    }
+
+    TEST_FIXTURE(ImportStatsTestFixture, import_stats_005)
+    {
+        //@005. rebuilding the model after edition does not modify the stats
+
+        Document doc(m_libraryScope);
+        doc.from_string("(score (vers 2.0)(instrument (musicData (clef G)(n c4 q))))");
+        string before = doc.get_import_stats().dump();
+
+        ImoScore* pScore = static_cast<ImoScore*>( doc.get_im_root()->get_content_item(0) );
+        pScore->end_of_changes();
+
+        CHECK( doc.get_import_stats().dump() == before );
+    }
+
+    TEST_FIXTURE(ImportStatsTestFixture, import_stats_006)
+    {
+        //@006. the stats are available from the public API
+
+        Document doc(m_libraryScope);
+        doc.from_string("(score (vers 2.0)(instrument (musicData (clef G)(n c4 q))))");
+        ADocument adoc = doc.get_document_api();
+
+        CHECK( &adoc.import_stats() == &doc.get_import_stats() );
+    }
+
+    TEST_FIXTURE(ImportStatsTestFixture, import_stats_007)
+    {
+        //@007. by default, memory is not sampled
+
+        Document doc(m_libraryScope);
+        doc.from_string("(score (vers 2.0)(instrument (musicData (clef G)(n c4 q))))");
+        const ImportStats& stats = doc.get_import_stats();
+
+        CHECK( stats.get_process_heap_growth() == -1LL );
+        CHECK( stats.dump().find("heap") == string::npos );
+    }
+
+    TEST_FIXTURE(ImportStatsTestFixture, import_stats_008)
+    {
+        //@008. memory sampling enabled. Sampled once per import
+
+        m_libraryScope.set_sample_import_memory(true);
+        Document doc(m_libraryScope);
+        doc.from_file(m_scores_path + "unit-tests/other/03-BeetAnGeSample.xml",
+                      Document::k_format_mxl);
+        const ImportStats& stats = doc.get_import_stats();
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+        CHECK( stats.get_process_heap_growth() > 0LL );
+        CHECK( stats.dump().find("process heap growth") != string::npos );
+#else
+        CHECK( stats.get_process_heap_growth() == -1LL );
+#endif
+    }
+
+}
@@ -229,6 +229,31 @@ SUITE(InteractorTest)
         CHECK( pIntor->get_graphic_model() != nullptr );
     }
 
+    TEST_FIXTURE(InteractorTestFixture, Interactor_DocumentUpdated_ReusesSystems)
+    {
+        //when the document is updated, unchanged systems are reused
+        stringstream src;
+        src << "(score (vers 2.0)(instrument (musicData (clef G)(time 4 4)";
+        for (int i=0; i < 40; ++i)
+            src << "(n c4 q)(n d4 q)(n e4 q)(n f4 q)(barline)";
+        src << ")))";
+        SpDocument spDoc( new Document(m_libraryScope) );
+        spDoc->from_string( src.str() );
+        ImoScore* pScore = static_cast<ImoScore*>( spDoc->get_im_root()->get_content_item(0) );
+        View* pView = Injector::inject_View(m_libraryScope, k_view_vertical_book);
+        SpInteractor pIntor(Injector::inject_Interactor(m_libraryScope, WpDocument(spDoc), pView, nullptr));
+        GraphicModel* pGModel = pIntor->get_graphic_model();
+        GmoBoxSystem* pFirstSystem = pGModel->get_system_box(0, pScore->get_id());
+        CHECK( pGModel->get_num_systems(pScore->get_id()) > 2 );
+
+        ImoMusicData* pMD = pScore->get_instrument(0)->get_musicdata();
+        pMD->get_last_child()->set_dirty(true);
+        pIntor->on_document_updated();
+
+        pGModel = pIntor->get_graphic_model();
+        CHECK( pGModel->get_system_box(0, pScore->get_id()) == pFirstSystem );
+    }
+
     //-- selecting objects --------------------------------------------------------------
 
     TEST_FIXTURE(InteractorTestFixture, Interactor_SelectObject)
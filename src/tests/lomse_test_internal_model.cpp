@@ -1748,12 +1748,12 @@ SUITE(InternalModelTest)
     {
         //@01. constructor
 
-        AttrInt a(0, 2);
-        AttrString b(1, std::string("string"));
-        AttrDouble c(2, 2.7);
-        AttrFloat d(3, 2.5f);
-        AttrBool e1(4, true);
-        AttrColor f(5, Color(80,70,55));
+        AttrObj a(0, 2);
+        AttrObj b(1, std::string("string"));
+        AttrObj c(2, 2.7);
+        AttrObj d(3, 2.5f);
+        AttrObj e1(4, true);
+        AttrObj f(5, Color(80,70,55));
 
         CHECK( a.get_int_value() == 2 );
         CHECK( b.get_string_value() == "string" );
@@ -1767,23 +1767,25 @@ SUITE(InternalModelTest)
     {
         //@02. set and get value
 
-        AttrVariant a(0);
-        a.set_string_value(std::string("string"));
+        AttrObj a(0, 0);
+        a.set_value(std::string("string"));
         CHECK( a.get_string_value() == "string" );
+        CHECK( a.holds<string>() == true );
 
-        a.set_int_value(2);
+        a.set_value(2);
         CHECK( a.get_int_value() == 2 );
+        CHECK( a.holds<string>() == false );
 
-        a.set_double_value(2.7);
+        a.set_value(2.7);
         CHECK( a.get_double_value() == 2.7 );
 
-        a.set_bool_value(true);
+        a.set_value(true);
         CHECK( a.get_bool_value() == true );
 
-        a.set_float_value(3.7f);
+        a.set_value(3.7f);
         CHECK( a.get_float_value() == 3.7f );
 
-        a.set_color_value(Color(100,100,100));
+        a.set_value(Color(100,100,100));
         CHECK( is_equal(a.get_color_value(), Color(100,100,100)) == true );
     }
 
@@ -1791,44 +1793,44 @@ SUITE(InternalModelTest)
     {
         //@03. copy constructor
 
-        AttrInt a(0, 2);
-        AttrString b(1, std::string("string"));
-        AttrDouble c(2, 2.7);
-        AttrFloat d(3, 2.5f);
-        AttrBool e1(4, true);
-        AttrColor f(5, Color(80,70,55));
+        AttrObj a(0, 2);
+        AttrObj b(1, std::string("string"));
+        AttrObj c(2, 2.7);
+        AttrObj d(3, 2.5f);
+        AttrObj e1(4, true);
+        AttrObj f(5, Color(80,70,55));
 
-        AttrInt aa(a);
+        AttrObj aa(a);
         CHECK( aa.get_int_value() == 2 );
         aa.set_value(5);
         CHECK( aa.get_int_value() == 5 );
         CHECK( a.get_int_value() == 2 );
 
-        AttrString bb(b);
+        AttrObj bb(b);
         CHECK( bb.get_string_value() == "string" );
         bb.set_value("perico");
         CHECK( bb.get_string_value() == "perico" );
         CHECK( b.get_string_value() == "string" );
 
-        AttrDouble cc(c);
+        AttrObj cc(c);
         CHECK( cc.get_double_value() == 2.7 );
         cc.set_value(3.28);
         CHECK( cc.get_double_value() == 3.28 );
         CHECK( c.get_double_value() == 2.7 );
 
-        AttrFloat dd(d);
+        AttrObj dd(d);
         CHECK( dd.get_float_value() == 2.5f );
         dd.set_value(1.41f);
         CHECK( dd.get_float_value() == 1.41f );
         CHECK( d.get_float_value() == 2.5f );
 
-        AttrBool ee(e1);
+        AttrObj ee(e1);
         CHECK( ee.get_bool_value() == true );
         ee.set_value(false);
         CHECK( ee.get_bool_value() == false );
         CHECK( e1.get_bool_value() == true );
 
-        AttrColor ff(f);
+        AttrObj ff(f);
         CHECK( is_equal(ff.get_color_value(), Color(80,70,55)) == true );
         ff.set_value(Color(80,20,30));
         CHECK( is_equal(ff.get_color_value(), Color(80,20,30)) == true );
@@ -1839,44 +1841,44 @@ SUITE(InternalModelTest)
     {
         //@04. assignment constructor
 
-        AttrInt a(0, 2);
-        AttrString b(1, std::string("string"));
-        AttrDouble c(2, 2.7);
-        AttrFloat d(3, 2.5f);
-        AttrBool e1(4, true);
-        AttrColor f(5, Color(80,70,55));
+        AttrObj a(0, 2);
+        AttrObj b(1, std::string("string"));
+        AttrObj c(2, 2.7);
+        AttrObj d(3, 2.5f);
+        AttrObj e1(4, true);
+        AttrObj f(5, Color(80,70,55));
 
-        AttrInt aa = a;
+        AttrObj aa = a;
         CHECK( aa.get_int_value() == 2 );
         aa.set_value(5);
         CHECK( aa.get_int_value() == 5 );
         CHECK( a.get_int_value() == 2 );
 
-        AttrString bb = b;
+        AttrObj bb = b;
         CHECK( bb.get_string_value() == "string" );
         bb.set_value("perico");
         CHECK( bb.get_string_value() == "perico" );
         CHECK( b.get_string_value() == "string" );
 
-        AttrDouble cc = c;
+        AttrObj cc = c;
         CHECK( cc.get_double_value() == 2.7 );
         cc.set_value(3.28);
         CHECK( cc.get_double_value() == 3.28 );
         CHECK( c.get_double_value() == 2.7 );
 
-        AttrFloat dd = d;
+        AttrObj dd = d;
         CHECK( dd.get_float_value() == 2.5f );
         dd.set_value(1.41f);
         CHECK( dd.get_float_value() == 1.41f );
         CHECK( d.get_float_value() == 2.5f );
 
-        AttrBool ee = e1;
+        AttrObj ee = e1;
         CHECK( ee.get_bool_value() == true );
         ee.set_value(false);
         CHECK( ee.get_bool_value() == false );
         CHECK( e1.get_bool_value() == true );
 
-        AttrColor ff = f;
+        AttrObj ff = f;
         CHECK( is_equal(ff.get_color_value(), Color(80,70,55)) == true );
         ff.set_value(Color(80,20,30));
         CHECK( is_equal(ff.get_color_value(), Color(80,20,30)) == true );
@@ -1942,28 +1944,115 @@ SUITE(InternalModelTest)
         //@04. clone attribute
 
         AttrList aa;
-        aa.push_back( LOMSE_NEW AttrInt(0, 2) );
-        aa.push_back( LOMSE_NEW AttrString(1, std::string("string")) );
-        aa.push_back( LOMSE_NEW AttrDouble(2, 2.7) );
-        aa.push_back( LOMSE_NEW AttrFloat(3, 2.5f) );
-        aa.push_back( LOMSE_NEW AttrBool(4, true) );
-        aa.push_back( LOMSE_NEW AttrColor(5, Color(80,70,55)) );
+        aa.push_back( AttrObj(0, 2) );
+        aa.push_back( AttrObj(1, std::string("string")) );
+        aa.push_back( AttrObj(2, 2.7) );
+        aa.push_back( AttrObj(3, 2.5f) );
+        aa.push_back( AttrObj(4, true) );
+        aa.push_back( AttrObj(5, Color(80,70,55)) );
 
         AttrList bb(const_cast<AttrList&>(aa));
-        AttrObj* pAttr = bb.front();
-        CHECK( pAttr->get_int_value() == 2 );
-        pAttr = pAttr->get_next_attrib();
-        CHECK( pAttr && pAttr->get_string_value() == "string" );
-        pAttr = pAttr->get_next_attrib();
-        CHECK( pAttr && pAttr->get_double_value() == 2.7 );
-        pAttr = pAttr->get_next_attrib();
-        CHECK( pAttr && pAttr->get_float_value() == 2.5f );
-        pAttr = pAttr->get_next_attrib();
-        CHECK( pAttr && pAttr->get_bool_value() == true );
-        pAttr = pAttr->get_next_attrib();
-        CHECK( pAttr &&  is_equal(pAttr->get_color_value(), Color(80,70,55)) == true );
+        CHECK( bb.size() == 6 );
+        CHECK( bb[0]->get_int_value() == 2 );
+        CHECK( bb[1]->get_string_value() == "string" );
+        CHECK( bb[2]->get_double_value() == 2.7 );
+        CHECK( bb[3]->get_float_value() == 2.5f );
+        CHECK( bb[4]->get_bool_value() == true );
+        CHECK( is_equal(bb[5]->get_color_value(), Color(80,70,55)) == true );
+        CHECK( bb[0] != aa[0] );
+        bb[1]->set_value("changed");
+        CHECK( aa[1]->get_string_value() == "string" );
    }
 
+    TEST_FIXTURE(InternalModelTestFixture, attributes_05)
+    {
+        //@05. many attributes. Order is kept when removing
+
+        Document doc(m_libraryScope);
+        ImoBarline* pImo = static_cast<ImoBarline*>(ImFactory::inject(k_imo_barline, &doc));
+
+        for (int i=0; i < 10; ++i)
+            pImo->set_int_attribute(5000 + i, i);
+        CHECK( pImo->get_num_attributes() == 10 );
+
+        pImo->remove_attribute(5000);
+        pImo->remove_attribute(5005);
+        pImo->remove_attribute(5009);
+
+        CHECK( pImo->get_num_attributes() == 7 );
+        CHECK( pImo->get_attribute(5005) == nullptr );
+        CHECK( pImo->get_int_attribute(5008) == 8 );
+        CHECK( pImo->get_attribute_at(0)->get_attrib_idx() == 5001 );
+        CHECK( pImo->get_attribute_at(4)->get_attrib_idx() == 5006 );
+        CHECK( pImo->get_attribute_at(6)->get_attrib_idx() == 5008 );
+
+        delete pImo;
+    }
+
+    TEST_FIXTURE(InternalModelTestFixture, attributes_06)
+    {
+        //@06. changing the type of an attribute replaces it in the same position
+
+        Document doc(m_libraryScope);
+        ImoBarline* pImo = static_cast<ImoBarline*>(ImFactory::inject(k_imo_barline, &doc));
+
+        pImo->set_int_attribute(5000, 2);
+        pImo->set_int_attribute(5001, 3);
+        pImo->set_string_attribute(5000, std::string("Hello!"));
+
+        CHECK( pImo->get_num_attributes() == 2 );
+        CHECK( pImo->get_attribute_at(0)->get_string_value() == "Hello!" );
+        CHECK( pImo->get_int_attribute(5001) == 3 );
+
+        pImo->set_color_attribute(5001, Color(80,70,55));
+        CHECK( pImo->get_num_attributes() == 2 );
+        CHECK( is_equal(pImo->get_color_attribute(5001), Color(80,70,55)) == true );
+
+        delete pImo;
+    }
+
+    TEST_FIXTURE(InternalModelTestFixture, attributes_07)
+    {
+        //@07. assignment replaces previous attributes
+
+        AttrList aa;
+        for (int i=0; i < 6; ++i)
+            aa.push_back( AttrObj(i, i) );
+        AttrList bb;
+        bb.push_back( AttrObj(10, 10) );
+
+        bb = aa;
+        CHECK( bb.size() == 6 );
+        CHECK( bb.find(10) == nullptr );
+        CHECK( bb.find(5) && bb.find(5)->get_int_value() == 5 );
+
+        aa.clear();
+        CHECK( aa.empty() );
+        CHECK( aa.front() == nullptr );
+        aa = bb;
+        CHECK( aa.size() == 6 );
+        CHECK( aa.back()->get_int_value() == 5 );
+    }
+
+    TEST_FIXTURE(InternalModelTestFixture, attributes_08)
+    {
+        //@08. removing the last attribute releases the list
+
+        AttrList aa;
+        aa.push_back( AttrObj(1, 1) );
+        aa.push_back( AttrObj(2, std::string("two")) );
+
+        aa.remove(1);
+        CHECK( aa.size() == 1 );
+        CHECK( aa.front()->get_string_value() == "two" );
+        aa.remove(3);
+        CHECK( aa.size() == 1 );
+        aa.remove(2);
+        CHECK( aa.empty() );
+        CHECK( aa.begin() == aa.end() );
+        CHECK( aa.find(2) == nullptr );
+    }
+
 }
 
 
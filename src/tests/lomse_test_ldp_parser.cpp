@@ -51,6 +51,26 @@ SUITE(LdpParserTest)
         delete score->get_root();
     }
 
+    TEST_FIXTURE(LdpParserTestFixture, ParserArenaMode)
+    {
+        //elements allocated in the arena. Tree valid until arena is freed
+        LdpParser parser(cout, m_pLibraryScope->ldp_factory());
+        parser.use_arena(true);
+        parser.parse_text("(score (vers 1.7)(instrument (musicData (n c4 q)(r e))))");
+        LdpTree* score = parser.get_ldp_tree();
+        LdpElement* pRoot = score->get_root();
+        CHECK( pRoot->is_in_arena() );
+        CHECK( pRoot->get_first_child()->is_in_arena() );
+        CHECK( pRoot->to_string() == "(score (vers 1.7) (instrument (musicData (n c4 q) (r e))))" );
+
+        //a second parse does not destroy previous tree
+        parser.parse_text("(clef G)");
+        CHECK( parser.get_ldp_tree()->get_root()->to_string() == "(clef G)" );
+        CHECK( pRoot->to_string() == "(score (vers 1.7) (instrument (musicData (n c4 q) (r e))))" );
+
+        parser.free_arena();
+    }
+
     TEST_FIXTURE(LdpParserTestFixture, ParserReadScoreFromFile)
     {
         LdpParser parser(cout, m_pLibraryScope->ldp_factory());
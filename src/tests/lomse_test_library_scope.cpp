@@ -0,0 +1,172 @@
+//---------------------------------------------------------------------------------------
+// This file is part of the Lomse library.
+// Copyright (c) 2010-present, Lomse Developers
+//
+// Licensed under the MIT license.
+//
+// See LICENSE and NOTICE.md files in the root directory of this source tree.
+//---------------------------------------------------------------------------------------
+
+#define LOMSE_INTERNAL_API
+#include <UnitTest++.h>
+#include <sstream>
+#include "lomse_build_options.h"
+
+//classes related to these tests
+#include "lomse_injectors.h"
+#include "lomse_doorway.h"
+#include "lomse_presenter.h"
+#include "lomse_interactor.h"
+#include "lomse_graphic_view.h"
+#include "lomse_font_storage.h"
+#include "lomse_workers_pool.h"
+
+#if (LOMSE_ENABLE_THREADS == 1)
+    #include <thread>
+    #include <atomic>
+    #include <mutex>
+    #include <set>
+#endif
+
+using namespace UnitTest;
+using namespace std;
+using namespace lomse;
+
+
+//---------------------------------------------------------------------------------------
+class LibraryScopeTestFixture
+{
+public:
+    std::string m_scores_path;
+
+    LibraryScopeTestFixture()     //SetUp fixture
+        : m_scores_path(TESTLIB_SCORES_PATH)
+    {
+    }
+
+    ~LibraryScopeTestFixture()    //TearDown fixture
+    {
+    }
+
+    //-----------------------------------------------------------------------------------
+    string render_document(LomseDoorway& doorway, const string& filename)
+    {
+        stringstream errors;
+        Presenter* pPresenter = doorway.open_document(k_view_vertical_book,
+                                                      m_scores_path + filename, errors);
+        Interactor* pIntor = pPresenter->get_interactor_raw_ptr(0);
+        stringstream svg;
+        pIntor->render_as_svg(svg, 0);
+        delete pPresenter;
+        return svg.str();
+    }
+};
+
+
+SUITE(LibraryScopeTest)
+{
+
+#if (LOMSE_ENABLE_THREADS == 1)
+
+    TEST_FIXTURE(LibraryScopeTestFixture, library_scope_shared_by_threads)
+    {
+        //@001. documents can be laid out concurrently using the same LibraryScope,
+        //      and the result is the same than when processed by only one thread
+
+        LomseDoorway doorway;
+        doorway.init_library(k_pix_format_rgba32, 96);
+        doorway.set_default_fonts_path(TESTLIB_FONTS_PATH);
+
+        const vector<string> files = {
+            "unit-tests/other/01-issue-with-natural.xml",
+            "unit-tests/other/02-barlines.xml",
+            "unit-tests/other/03-BeetAnGeSample.xml",
+            "unit-tests/other/04-multimetric.lms",
+        };
+
+        vector<string> expected;
+        for (const string& file : files)
+            expected.push_back( render_document(doorway, file) );
+
+        const int numThreads = 4;
+        const int numRounds = 2;
+        vector<vector<string>> results(numThreads);
+        vector<thread> threads;
+        for (int i=0; i < numThreads; ++i)
+        {
+            threads.push_back(thread([&, i]() {
+                for (int round=0; round < numRounds; ++round)
+                {
+                    for (size_t j=0; j < files.size(); ++j)
+                    {
+                        //each thread starts with a different file
+                        size_t iFile = (j + i) % files.size();
+                        results[i].push_back( render_document(doorway, files[iFile]) );
+                    }
+                }
+            }));
+        }
+        for (thread& t : threads)
+            t.join();
+
+        for (int i=0; i < numThreads; ++i)
+        {
+            CHECK( results[i].size() == files.size() * numRounds );
+            for (size_t j=0; j < results[i].size(); ++j)
+            {
+                size_t iFile = (j + i) % files.size();
+                CHECK( results[i][j] == expected[iFile] );
+            }
+        }
+
+        LibraryScope* pScope = doorway.get_library_scope();
+        CHECK( pScope->font_storage()->get_num_font_engines() > 1 );
+    }
+
+    TEST_FIXTURE(LibraryScopeTestFixture, library_scope_workers_pool_002)
+    {
+        //@002. the workers pool runs the task in the requested number of threads and
+        //      the threads are reused
+
+        LibraryScope libraryScope(cout);
+        WorkersPool* pPool = libraryScope.get_workers_pool();
+        atomic<int> count(0);
+        std::mutex mutex;
+        set<thread::id> ids;
+        auto task = [&]() {
+            ++count;
+            std::lock_guard<std::mutex> lock(mutex);
+            ids.insert(this_thread::get_id());
+        };
+
+        for (int i=0; i < 5; ++i)
+            pPool->run(4, task);
+
+        CHECK( count == 20 );
+        CHECK( pPool->num_threads() == 3 );
+        CHECK( ids.size() <= 4 );
+        CHECK( libraryScope.get_workers_pool() == pPool );
+    }
+
+    TEST_FIXTURE(LibraryScopeTestFixture, library_scope_workers_pool_003)
+    {
+        //@003. engraving in parallel many times does not create more font engines
+        //      than threads in the pool
+
+        LomseDoorway doorway;
+        doorway.init_library(k_pix_format_rgba32, 96);
+        doorway.set_default_fonts_path(TESTLIB_FONTS_PATH);
+        LibraryScope* pScope = doorway.get_library_scope();
+        pScope->set_engrave_systems_in_parallel(true);
+        pScope->set_num_engraving_threads(4);
+
+        for (int i=0; i < 5; ++i)
+            render_document(doorway, "unit-tests/other/03-BeetAnGeSample.xml");
+
+        CHECK( pScope->get_workers_pool()->num_threads() <= 3 );
+        CHECK( pScope->font_storage()->get_num_font_engines() <= 4 );
+    }
+
+#endif
+
+}
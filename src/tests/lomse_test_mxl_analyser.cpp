@@ -3089,7 +3089,7 @@ SUITE(MxlAnalyserTest)
                 const list<FingerData>& fingerings = pFing->get_fingerings();
                 const FingerData& data = fingerings.front();
                 CHECK( data.value == "3" );
-                CHECK( data.attribs == nullptr );
+                CHECK( data.attribs.empty() );
                 CHECK( data.flags == 0 );
                 CHECK( data.is_substitution() == false );
                 CHECK( data.is_alternative() == false );
@@ -3174,12 +3174,12 @@ SUITE(MxlAnalyserTest)
                 list<FingerData>::const_iterator it = (pFing->get_fingerings()).begin();
                 const FingerData& data1 = *it;
                 CHECK( data1.value == "5" );
-                CHECK( data1.attribs == nullptr );
+                CHECK( data1.attribs.empty() );
                 CHECK( data1.flags == 0 );
                 ++it;
                 const FingerData& data2 = *it;
                 CHECK( data2.value == "3" );
-                CHECK( data2.attribs == nullptr );
+                CHECK( data2.attribs.empty() );
                 CHECK( data2.is_substitution() == true );
                 CHECK( data2.is_alternative() == false );
             }
@@ -3229,12 +3229,12 @@ SUITE(MxlAnalyserTest)
                 list<FingerData>::const_iterator it = (pFing->get_fingerings()).begin();
                 const FingerData& data1 = *it;
                 CHECK( data1.value == "4" );
-                CHECK( data1.attribs == nullptr );
+                CHECK( data1.attribs.empty() );
                 CHECK( data1.flags == 0 );
                 ++it;
                 const FingerData& data2 = *it;
                 CHECK( data2.value == "5" );
-                CHECK( data2.attribs == nullptr );
+                CHECK( data2.attribs.empty() );
                 CHECK( data2.is_substitution() == false );
                 CHECK( data2.is_alternative() == true );
             }
@@ -9,6 +9,9 @@
 
 #include <UnitTest++.h>
 #include <sstream>
+#include <fstream>
+#include <iterator>
+#include "lomse_config.h"
 #include "lomse_build_options.h"
 
 //classes related to these tests
@@ -16,6 +19,7 @@
 #include "private/lomse_document_p.h"
 #include "lomse_mxl_compiler.h"
 #include "lomse_internal_model.h"
+#include "lomse_staffobjs_table.h"
 
 using namespace UnitTest;
 using namespace std;
@@ -39,6 +43,38 @@ public:
     ~MxlCompilerTestFixture()    //TearDown fixture
     {
     }
+
+    string dump_score(Document& doc)
+    {
+        ImoScore* pScore = dynamic_cast<ImoScore*>( doc.get_im_root()->get_content_item(0) );
+        return (pScore ? pScore->get_staffobjs_table()->dump(false) : string("no score"));
+    }
+
+    string remove_beam_ids(const string& dump)
+    {
+        //beams are exported with its id, as '(beam <id> ...'
+        string result;
+        string tag("(beam ");
+        size_t start = 0;
+        size_t pos = dump.find(tag);
+        while (pos != string::npos)
+        {
+            pos += tag.size();
+            result += dump.substr(start, pos - start);
+            while (pos < dump.size() && isdigit(dump[pos]))
+                ++pos;
+            start = pos;
+            pos = dump.find(tag, start);
+        }
+        result += dump.substr(start);
+        return result;
+    }
+
+    string read_binary_file(const string& filename)
+    {
+        ifstream file(filename.c_str(), ios::in | ios::binary);
+        return string((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+    }
 };
 
 SUITE(MxlCompilerTest)
@@ -104,5 +140,289 @@ SUITE(MxlCompilerTest)
         delete pRoot;
     }
 
+    TEST_FIXTURE(MxlCompilerTestFixture, MxlCompilerStreaming_200)
+    {
+        //200 - streaming import. Same result than full tree import
+        string path = m_scores_path + "50106-repeat-barlines-simple-volta.xml";
+
+        Document doc1(m_libraryScope);
+        MxlCompiler compiler1(m_libraryScope, &doc1);
+        ImoDocument* pDoc1 = compiler1.compile_file(path);
+
+        m_libraryScope.get_musicxml_options()->use_streaming_import(true);
+        Document doc2(m_libraryScope);
+        MxlCompiler compiler2(m_libraryScope, &doc2);
+        ImoDocument* pDoc2 = compiler2.compile_file(path);
+        m_libraryScope.get_musicxml_options()->use_streaming_import(false);
+
+        CHECK( compiler2.get_file_locator() == path );
+        CHECK( pDoc1 && pDoc2 );
+        ImoScore* pScore1 = pDoc1 ? dynamic_cast<ImoScore*>( pDoc1->get_content_item(0) ) : nullptr;
+        ImoScore* pScore2 = pDoc2 ? dynamic_cast<ImoScore*>( pDoc2->get_content_item(0) ) : nullptr;
+        CHECK( pScore1 && pScore2 );
+        if (pScore1 && pScore2)
+        {
+            CHECK( pScore1->get_num_instruments() == pScore2->get_num_instruments() );
+            CHECK( pScore1->get_staffobjs_table()->dump(false)
+                   == pScore2->get_staffobjs_table()->dump(false) );
+        }
+
+        delete pDoc1;
+        delete pDoc2;
+    }
+
+    TEST_FIXTURE(MxlCompilerTestFixture, MxlCompilerStreaming_201)
+    {
+        //201 - streaming import from stream. Errors in <part> content
+        stringstream errormsg;
+        Document doc(m_libraryScope, errormsg);
+        MxlCompiler compiler(m_libraryScope, &doc);
+        stringstream src(
+            "<?xml version='1.0' encoding='utf-8'?>\n"
+            "<score-partwise version='3.0'><part-list>\n"
+            "<score-part id='P1'><part-name>Music</part-name></score-part>\n"
+            "</part-list>\n<part id='P1'>\n"
+            "<measure number='1'>"
+            "<attributes>"
+                "<divisions>1</divisions><key><fifths>0</fifths></key>"
+                "<time><beats>4</beats><beat-type>4</beat-type></time>"
+                "<clef><sign>G</sign><line>2</line></clef>"
+            "</attributes>\n"
+            "<note><pitch><step>C</step><octave>4</octave></pitch><duration>4</duration><type>whole</type></note>\n"
+            "</measure>\n"
+            "<foo/>\n"
+            "</part></score-partwise>");
+        ImoDocument* pDoc = compiler.compile_stream(src);
+        CHECK( compiler.get_file_locator() == "string:" );
+        CHECK( errormsg.str() == "Line 9. Element <part>: element 'foo' unknown "
+                                 "or not possible here. Ignored.\n" );
+        ImoScore* pScore = pDoc ? dynamic_cast<ImoScore*>( pDoc->get_content_item(0) ) : nullptr;
+        CHECK( pScore && pScore->get_num_instruments() == 1 );
+        ImoInstrument* pInstr = pScore ? pScore->get_instrument(0) : nullptr;
+        ImoMusicData* pMD = pInstr ? pInstr->get_musicdata() : nullptr;
+        CHECK( pMD && pMD->get_num_items() == 5 );
+        delete pDoc;
+    }
+
+    TEST_FIXTURE(MxlCompilerTestFixture, MxlCompilerParallel_300)
+    {
+        //300 - parallel import. Same result than sequential import
+        string path = m_scores_path + "unit-tests/other/03-BeetAnGeSample.xml";
+
+        stringstream errormsg1;
+        Document doc1(m_libraryScope, errormsg1);
+        MxlCompiler compiler1(m_libraryScope, &doc1);
+        ImoDocument* pDoc1 = compiler1.compile_file(path);
+
+        m_libraryScope.get_musicxml_options()->use_parallel_import(true);
+        stringstream errormsg2;
+        Document doc2(m_libraryScope, errormsg2);
+        MxlCompiler compiler2(m_libraryScope, &doc2);
+        ImoDocument* pDoc2 = compiler2.compile_file(path);
+        m_libraryScope.get_musicxml_options()->use_parallel_import(false);
+
+        CHECK( errormsg1.str() == errormsg2.str() );
+        CHECK( pDoc1 && pDoc2 );
+        ImoScore* pScore1 = pDoc1 ? dynamic_cast<ImoScore*>( pDoc1->get_content_item(0) ) : nullptr;
+        ImoScore* pScore2 = pDoc2 ? dynamic_cast<ImoScore*>( pDoc2->get_content_item(0) ) : nullptr;
+        CHECK( pScore1 && pScore2 );
+        if (pScore1 && pScore2)
+        {
+            CHECK( pScore2->get_num_instruments() == 2 );
+            CHECK( pScore1->get_num_instruments() == pScore2->get_num_instruments() );
+            //ids assigned in parallel import are not the same than in sequential import
+            CHECK( remove_beam_ids(pScore1->get_staffobjs_table()->dump(false))
+                   == remove_beam_ids(pScore2->get_staffobjs_table()->dump(false)) );
+            ImoInstrument* pInstr1 = pScore1->get_instrument(1);
+            ImoInstrument* pInstr2 = pScore2->get_instrument(1);
+            CHECK( pInstr1->get_staff(0)->get_staff_margin()
+                   == pInstr2->get_staff(0)->get_staff_margin() );
+            CHECK( doc2.get_pointer_to_imo(pInstr2->get_id()) == pInstr2 );
+        }
+
+        delete pDoc1;
+        delete pDoc2;
+    }
+
+    TEST_FIXTURE(MxlCompilerTestFixture, MxlCompilerParallel_301)
+    {
+        //301 - parallel import. Errors are reported as in sequential import
+        string src =
+            "<?xml version='1.0' encoding='utf-8'?>"
+            "<score-partwise version='3.0'><part-list>"
+            "<score-part id='P1'><part-name>Flute</part-name></score-part>"
+            "<score-part id='P2'><part-name>Oboe</part-name></score-part>"
+            "</part-list>"
+            "<part id='P1'><measure number='1'><note><pitch><step>C</step>"
+                "<octave>4</octave></pitch><duration>1</duration><type>foo</type>"
+            "</note></measure></part>"
+            "<part id='P2'><measure number='1'><note><pitch><step>D</step>"
+                "<octave>4</octave></pitch><duration>1</duration><type>bar</type>"
+            "</note></measure></part>"
+            "</score-partwise>";
+
+        stringstream errormsg1;
+        Document doc1(m_libraryScope, errormsg1);
+        MxlCompiler compiler1(m_libraryScope, &doc1);
+        ImoDocument* pDoc1 = compiler1.compile_string(src);
+
+        m_libraryScope.get_musicxml_options()->use_parallel_import(true);
+        stringstream errormsg2;
+        Document doc2(m_libraryScope, errormsg2);
+        MxlCompiler compiler2(m_libraryScope, &doc2);
+        ImoDocument* pDoc2 = compiler2.compile_string(src);
+        m_libraryScope.get_musicxml_options()->use_parallel_import(false);
+
+        string msg = errormsg2.str();
+        CHECK( msg == errormsg1.str() );
+        CHECK( msg.find("'foo'") != string::npos );
+        CHECK( msg.find("'foo'") < msg.find("'bar'") );
+        ImoScore* pScore = pDoc2 ? dynamic_cast<ImoScore*>( pDoc2->get_content_item(0) ) : nullptr;
+        CHECK( pScore && pScore->get_num_instruments() == 2 );
+
+        delete pDoc1;
+        delete pDoc2;
+    }
+
+    TEST_FIXTURE(MxlCompilerTestFixture, MxlCompilerParallel_302)
+    {
+        //302 - the voice of the last note in a part does not leak into the clefs and
+        //keys of the next part. Same result in sequential and parallel import
+        string attribs =
+            "<attributes><divisions>1</divisions><key><fifths>0</fifths></key>"
+            "<clef><sign>G</sign><line>2</line></clef></attributes>";
+        string src =
+            "<score-partwise version='3.0'><part-list>"
+            "<score-part id='P1'><part-name>Flute</part-name></score-part>"
+            "<score-part id='P2'><part-name>Oboe</part-name></score-part>"
+            "</part-list>"
+            "<part id='P1'><measure number='1'>" + attribs +
+            "<note><pitch><step>C</step><octave>4</octave></pitch>"
+                "<duration>4</duration><voice>2</voice><type>whole</type></note>"
+            "</measure></part>"
+            "<part id='P2'><measure number='1'>" + attribs +
+            "<note><pitch><step>D</step><octave>4</octave></pitch>"
+                "<duration>4</duration><voice>1</voice><type>whole</type></note>"
+            "</measure></part></score-partwise>";
+
+        for (int i=0; i < 2; ++i)
+        {
+            m_libraryScope.get_musicxml_options()->use_parallel_import(i == 1);
+            Document doc(m_libraryScope);
+            MxlCompiler compiler(m_libraryScope, &doc);
+            ImoDocument* pDoc = compiler.compile_string(src);
+            ImoScore* pScore = dynamic_cast<ImoScore*>( pDoc->get_content_item(0) );
+            ImoMusicData* pMD1 = pScore->get_instrument(0)->get_musicdata();
+            ImoMusicData* pMD2 = pScore->get_instrument(1)->get_musicdata();
+
+            CHECK( pMD1->get_num_children() == pMD2->get_num_children() );
+            ImoStaffObj* pClef1 = static_cast<ImoStaffObj*>( pMD1->get_first_child() );
+            ImoStaffObj* pClef2 = static_cast<ImoStaffObj*>( pMD2->get_first_child() );
+            CHECK( pClef2->is_clef() );
+            CHECK( pClef2->get_voice() == pClef1->get_voice() );
+            CHECK( pClef2->get_voice() == 0 );
+            delete pDoc;
+        }
+        m_libraryScope.get_musicxml_options()->use_parallel_import(false);
+    }
+
+    TEST_FIXTURE(MxlCompilerTestFixture, MxlCompilerParallel_303)
+    {
+        //303 - parallel import. Ids do not depend on the other parts and are the same
+        //in all runs
+        string head =
+            "<score-partwise version='3.0'><part-list>"
+            "<score-part id='P1'><part-name>Flute</part-name></score-part>"
+            "<score-part id='P2'><part-name>Oboe</part-name></score-part>"
+            "</part-list>";
+        string note =
+            "<note><pitch><step>C</step><octave>4</octave></pitch>"
+            "<duration>1</duration><type>quarter</type></note>";
+        string part2 =
+            "<part id='P2'><measure number='1'><attributes><divisions>1</divisions>"
+            "<clef><sign>G</sign><line>2</line></clef></attributes>"
+            + note + note + "</measure></part></score-partwise>";
+        string src1 = head + "<part id='P1'><measure number='1'>" + note
+                      + "</measure></part>" + part2;
+        string src2 = head + "<part id='P1'><measure number='1'>" + note + note + note
+                      + "</measure><measure number='2'>" + note + "</measure></part>"
+                      + part2;
+
+        m_libraryScope.get_musicxml_options()->use_parallel_import(true);
+        vector<string> ids;
+        for (int i=0; i < 3; ++i)
+        {
+            Document doc(m_libraryScope);
+            MxlCompiler compiler(m_libraryScope, &doc);
+            ImoDocument* pDoc = compiler.compile_string(i == 1 ? src2 : src1);
+            ImoScore* pScore = dynamic_cast<ImoScore*>( pDoc->get_content_item(0) );
+            ImoMusicData* pMD = pScore->get_instrument(1)->get_musicdata();
+            stringstream ss;
+            ImoObj::children_iterator it;
+            for (it = pMD->begin(); it != pMD->end(); ++it)
+            {
+                ss << (*it)->get_id() << ",";
+                CHECK( doc.get_pointer_to_imo((*it)->get_id()) == *it );
+            }
+            ids.push_back(ss.str());
+            delete pDoc;
+        }
+        m_libraryScope.get_musicxml_options()->use_parallel_import(false);
+
+        CHECK( ids[0] == ids[1] );
+        CHECK( ids[0] == ids[2] );
+    }
+
+#if (LOMSE_ENABLE_COMPRESSION == 1)
+
+    TEST_FIXTURE(MxlCompilerTestFixture, MxlCompilerCompressed_400)
+    {
+        //400 - compressed file. Same result than uncompressed file
+        Document doc1(m_libraryScope);
+        doc1.from_file(m_scores_path + "unit-tests/other/03-BeetAnGeSample.xml",
+                       Document::k_format_mxl);
+        Document doc2(m_libraryScope);
+        doc2.from_file(m_scores_path + "unit-tests/other/05-BeetAnGeSample.mxl",
+                       Document::k_format_mxl_compressed);
+
+        CHECK( dump_score(doc1) == dump_score(doc2) );
+        CHECK( dump_score(doc2) != "no score" );
+    }
+
+    TEST_FIXTURE(MxlCompilerTestFixture, MxlCompilerCompressed_401)
+    {
+        //401 - compressed file in memory, from string and from buffer
+        Document doc1(m_libraryScope);
+        doc1.from_file(m_scores_path + "unit-tests/other/03-BeetAnGeSample.xml",
+                       Document::k_format_mxl);
+
+        string mxl = read_binary_file(m_scores_path + "unit-tests/other/05-BeetAnGeSample.mxl");
+        Document doc2(m_libraryScope);
+        doc2.from_string(mxl, Document::k_format_mxl_compressed);
+        Document doc3(m_libraryScope);
+        doc3.from_buffer(mxl.data(), mxl.size(), Document::k_format_mxl_compressed);
+
+        CHECK( dump_score(doc1) == dump_score(doc2) );
+        CHECK( dump_score(doc1) == dump_score(doc3) );
+    }
+
+    TEST_FIXTURE(MxlCompilerTestFixture, MxlCompilerCompressed_402)
+    {
+        //402 - compressed file in memory, streaming import
+        Document doc1(m_libraryScope);
+        doc1.from_file(m_scores_path + "unit-tests/other/03-BeetAnGeSample.xml",
+                       Document::k_format_mxl);
+
+        string mxl = read_binary_file(m_scores_path + "unit-tests/other/05-BeetAnGeSample.mxl");
+        m_libraryScope.get_musicxml_options()->use_streaming_import(true);
+        Document doc2(m_libraryScope);
+        doc2.from_buffer(mxl.data(), mxl.size(), Document::k_format_mxl_compressed);
+        m_libraryScope.get_musicxml_options()->use_streaming_import(false);
+
+        CHECK( dump_score(doc1) == dump_score(doc2) );
+    }
+
+#endif  //LOMSE_ENABLE_COMPRESSION
+
 };
 
@@ -173,3 +173,58 @@ SUITE(LdpFileReaderTest)
     }
 
 }
+
+
+SUITE(LdpMappedFileReaderTest)
+{
+    TEST_FIXTURE(LdpFileReaderTestFixture, mapped_reader_01)
+    {
+        //@01. Invalid file throws exception
+        bool fOk = false;
+        try
+        {
+            LdpMappedFileReader reader("../../invalid_path/no-score.lms");
+        }
+        catch(exception& e)
+        {
+            //cout << e.what() << endl;
+            e.what();
+            fOk = true;
+        }
+        CHECK(fOk);
+    }
+
+    TEST_FIXTURE(LdpFileReaderTestFixture, mapped_reader_02)
+    {
+        //@02. Can read and unread chars
+        LdpMappedFileReader reader(m_scores_path + "00011-empty-fill-page.lms");
+        CHECK( reader.is_ready() );
+        CHECK( reader.get_buffer() != nullptr );
+        CHECK( reader.get_next_char() == '(' );
+        CHECK( reader.get_next_char() == 's' );
+        reader.repeat_last_char();
+        CHECK( reader.get_next_char() == 's' );
+        CHECK( reader.get_next_char() == 'c' );
+    }
+
+    TEST_FIXTURE(LdpFileReaderTestFixture, mapped_reader_03)
+    {
+        //@03. Same content and line numbers than LdpFileReader
+        string loc = m_scores_path + "00011-empty-fill-page.lms";
+        LdpFileReader fileReader(loc);
+        LdpMappedFileReader reader(loc);
+        CHECK( reader.get_locator() == loc);
+
+        bool fOk = true;
+        while (!reader.end_of_data())
+        {
+            fOk &= (fileReader.get_next_char() == reader.get_next_char());
+            fOk &= (fileReader.get_line_number() == reader.get_line_number());
+        }
+        CHECK( fOk );
+        CHECK( reader.end_of_data() );
+        CHECK( reader.get_next_char() == char(EOF) );
+        CHECK( reader.get_line_number() > 1 );
+    }
+
+}
@@ -83,6 +83,33 @@ SUITE(ScoreAlgorithmsTest)
         CHECK( pNote->get_fpitch() == FPitch("e4") );
     }
 
+    TEST_FIXTURE(ScoreAlgorithmsTestFixture, find_noterest_2)
+    {
+        //@002. only notes in requested instrument and voice
+        Document doc(m_libraryScope);
+        doc.from_string("(score (vers 2.0)"
+            "(instrument (musicData (clef G)(n c5 h v1)(goBack h)"
+            "(n e4 e v2)(n f4 e v2)(n g4 q v2) ))"
+            "(instrument (musicData (clef G)(n a4 q v2)(n b4 q v2) )))");
+        ImoScore* pScore =
+            static_cast<ImoScore*>( doc.get_im_root()->get_content_item(0) );
+
+        ImoNote* pNote = static_cast<ImoNote*>(
+                            ScoreAlgorithms::find_noterest_at(pScore, 0, 2, 48.0) );
+        CHECK( pNote && pNote->get_fpitch() == FPitch("f4") );
+
+        pNote = static_cast<ImoNote*>(
+                            ScoreAlgorithms::find_noterest_at(pScore, 0, 1, 96.0) );
+        CHECK( pNote && pNote->get_fpitch() == FPitch("c5") );
+
+        pNote = static_cast<ImoNote*>(
+                            ScoreAlgorithms::find_noterest_at(pScore, 1, 2, 96.0) );
+        CHECK( pNote && pNote->get_fpitch() == FPitch("b4") );
+
+        CHECK( ScoreAlgorithms::find_noterest_at(pScore, 0, 1, 300.0) == nullptr );
+        CHECK( ScoreAlgorithms::find_noterest_at(pScore, 0, 3, 0.0) == nullptr );
+    }
+
     TEST_FIXTURE(ScoreAlgorithmsTestFixture, find_and_classify_021)
     {
         //@021. requested interval starts and ends at same time than existing note
@@ -244,6 +271,38 @@ SUITE(ScoreAlgorithmsTest)
 
     // using the measures table ---------------------------------------------------------
 
+    TEST_FIXTURE(ScoreAlgorithmsTestFixture, find_and_classify_026)
+    {
+        //@026. only notes in requested instrument and voice. Chord notes
+        //  v1: (n c5 h)
+        //  v2: (chord (n e4 e)(n g4 e))(n f4 e)(n g4 q)
+        //              0--------32
+        Document doc(m_libraryScope);
+        doc.from_string("(score (vers 2.0)"
+            "(instrument (musicData (clef G)(n c5 h v1)(goBack h)"
+            "(chord (n e4 e v2)(n g4 e v2))(n f4 e v2)(n g4 q v2) ))"
+            "(instrument (musicData (clef G)(n a4 q v2)(n b4 q v2) )))");
+        ImoScore* pScore =
+            static_cast<ImoScore*>( doc.get_im_root()->get_content_item(0) );
+
+        list<OverlappedNoteRest*> overlaps =
+            ScoreAlgorithms::find_and_classify_overlapped_noterests_at(
+                                                        pScore, 0, 2, 16.0, 32.0);
+
+        CHECK( overlaps.size() == 3 );
+        list<OverlappedNoteRest*>::iterator it = overlaps.begin();
+        CHECK( static_cast<ImoNote*>((*it)->pNR)->get_fpitch() == FPitch("e4") );
+        CHECK( (*it)->type == k_overlap_at_end );
+        ++it;
+        CHECK( static_cast<ImoNote*>((*it)->pNR)->get_fpitch() == FPitch("g4") );
+        CHECK( (*it)->type == k_overlap_at_end );
+        ++it;
+        CHECK( static_cast<ImoNote*>((*it)->pNR)->get_fpitch() == FPitch("f4") );
+        CHECK( (*it)->type == k_overlap_at_start );
+
+        delete_overlaps(overlaps);
+    }
+
     TEST_FIXTURE(ScoreAlgorithmsTestFixture, measures_table_001)
     {
         //@001. Found in first guess. At start of measure
@@ -880,5 +939,127 @@ SUITE(ScoreAlgorithmsTest)
         CHECK( is_equal_time(timepos, 448.0) );
     }
 
+
+    TEST_FIXTURE(ScoreAlgorithmsTestFixture, get_applicable_clef_for_1)
+    {
+        //@001. clef applicable at timepos
+        Document doc(m_libraryScope);
+        doc.from_string("(score (vers 2.0)(instrument (staves 2)(musicData "
+            "(clef G p1)(clef F4 p2)(n c4 q p1)(clef C3 p1)(n e4 q p1)"
+            "(barline)(clef G p2)(n g3 q p2) )))");
+        ImoScore* pScore =
+            static_cast<ImoScore*>( doc.get_im_root()->get_content_item(0) );
+
+        CHECK( ScoreAlgorithms::get_applicable_clef_for(pScore, 0, 0, 0.0) == k_clef_G2 );
+        CHECK( ScoreAlgorithms::get_applicable_clef_for(pScore, 0, 1, 0.0) == k_clef_F4 );
+        CHECK( ScoreAlgorithms::get_applicable_clef_for(pScore, 0, 0, 32.0) == k_clef_G2 );
+        CHECK( ScoreAlgorithms::get_applicable_clef_for(pScore, 0, 0, 64.0) == k_clef_C3 );
+        CHECK( ScoreAlgorithms::get_applicable_clef_for(pScore, 0, 1, 64.0) == k_clef_F4 );
+        CHECK( ScoreAlgorithms::get_applicable_clef_for(pScore, 0, 1, 128.0) == k_clef_G2 );
+        CHECK( ScoreAlgorithms::get_applicable_clef_for(pScore, 0, 2, 0.0) == k_clef_undefined );
+        CHECK( ScoreAlgorithms::get_applicable_clef_for(pScore, 1, 0, 0.0) == k_clef_undefined );
+    }
+
+    TEST_FIXTURE(ScoreAlgorithmsTestFixture, get_applicable_clef_for_2)
+    {
+        //@002. no clef before timepos
+        Document doc(m_libraryScope);
+        doc.from_string("(score (vers 2.0)(instrument (musicData "
+            "(n c4 q)(clef F4)(n c3 q) )))");
+        ImoScore* pScore =
+            static_cast<ImoScore*>( doc.get_im_root()->get_content_item(0) );
+
+        CHECK( ScoreAlgorithms::get_applicable_clef_for(pScore, 0, 0, 0.0) == k_clef_undefined );
+        CHECK( ScoreAlgorithms::get_applicable_clef_for(pScore, 0, 0, 64.0) == k_clef_F4 );
+    }
+
+    TEST_FIXTURE(ScoreAlgorithmsTestFixture, get_applicable_key_1)
+    {
+        //@001. key applicable to a note
+        Document doc(m_libraryScope);
+        doc.from_string("(score (vers 2.0)(instrument (musicData "
+            "(clef G)(key D)(n c4 q)(barline)(key F)(n d4 q)(barline)(n e4 q) )))");
+        ImoScore* pScore =
+            static_cast<ImoScore*>( doc.get_im_root()->get_content_item(0) );
+        ImoMusicData* pMD = pScore->get_instrument(0)->get_musicdata();
+
+        ImoKeySignature* pKey = ScoreAlgorithms::get_applicable_key(pScore,
+                                    static_cast<ImoNote*>( pMD->get_child(2) ));
+        CHECK( pKey && pKey->get_key_type() == k_key_D );
+
+        pKey = ScoreAlgorithms::get_applicable_key(pScore,
+                                    static_cast<ImoNote*>( pMD->get_child(5) ));
+        CHECK( pKey && pKey->get_key_type() == k_key_F );
+
+        pKey = ScoreAlgorithms::get_applicable_key(pScore,
+                                    static_cast<ImoNote*>( pMD->get_child(7) ));
+        CHECK( pKey && pKey->get_key_type() == k_key_F );
+    }
+
+    TEST_FIXTURE(ScoreAlgorithmsTestFixture, get_applicable_key_2)
+    {
+        //@002. key in other instrument is not applicable
+        Document doc(m_libraryScope);
+        doc.from_string("(score (vers 2.0)"
+            "(instrument (musicData (clef G)(key D)(n c4 q) ))"
+            "(instrument (musicData (clef G)(n c4 q) )))");
+        ImoScore* pScore =
+            static_cast<ImoScore*>( doc.get_im_root()->get_content_item(0) );
+        ImoMusicData* pMD = pScore->get_instrument(1)->get_musicdata();
+
+        ImoKeySignature* pKey = ScoreAlgorithms::get_applicable_key(pScore,
+                                    static_cast<ImoNote*>( pMD->get_child(1) ));
+        CHECK( pKey == nullptr );
+    }
+
+    TEST_FIXTURE(ScoreAlgorithmsTestFixture, staff_context_index_1)
+    {
+        //@001. time signatures and octave shifts
+        Document doc(m_libraryScope);
+        doc.from_string("(score (vers 2.0)(instrument (musicData "
+            "(clef G)(time 2 4)(n c4 q)(n d4 q (octaveShift 1 start 8d))(barline)"
+            "(time 3 4)(n e4 q)(n f4 h (octaveShift 1 stop))(barline)(n g4 q) )))");
+        ImoScore* pScore =
+            static_cast<ImoScore*>( doc.get_im_root()->get_content_item(0) );
+        ImoMusicData* pMD = pScore->get_instrument(0)->get_musicdata();
+        const StaffContextIndex& index =
+            pScore->get_staffobjs_table()->get_context_index();
+
+        const StaffContextIndex::ChangePoint* pPoint =
+            index.find_at(StaffContextIndex::k_context_time, 0, 0, 64.0);
+        CHECK( pPoint && pPoint->pSO == pMD->get_child(1) );
+        pPoint = index.find_at(StaffContextIndex::k_context_time, 0, 0, 128.0);
+        CHECK( pPoint && pPoint->pSO == pMD->get_child(5) );
+
+        CHECK( index.find_at(StaffContextIndex::k_context_octave_shift, 0, 0, 0.0) == nullptr );
+        pPoint = index.find_at(StaffContextIndex::k_context_octave_shift, 0, 0, 64.0);
+        CHECK( pPoint && pPoint->pSO == pMD->get_child(3) );
+        CHECK( pPoint && pPoint->value != 0 );
+        pPoint = index.find_at(StaffContextIndex::k_context_octave_shift, 0, 0, 192.0);
+        CHECK( pPoint && pPoint->pSO == pMD->get_child(3) );
+        pPoint = index.find_at(StaffContextIndex::k_context_octave_shift, 0, 0, 320.0);
+        CHECK( pPoint && pPoint->pSO == nullptr );
+        CHECK( pPoint && pPoint->value == 0 );
+    }
+
+    TEST_FIXTURE(ScoreAlgorithmsTestFixture, staff_context_index_2)
+    {
+        //@002. the index is updated when the table is updated
+        Document doc(m_libraryScope);
+        doc.from_string("(score (vers 2.0)(instrument (musicData "
+            "(clef G)(n c4 q)(n d4 q)(clef F4)(n e3 q) )))");
+        ImoScore* pScore =
+            static_cast<ImoScore*>( doc.get_im_root()->get_content_item(0) );
+        ImoMusicData* pMD = pScore->get_instrument(0)->get_musicdata();
+        CHECK( ScoreAlgorithms::get_applicable_clef_for(pScore, 0, 0, 128.0) == k_clef_F4 );
+
+        ImoNoteRest* pNR = static_cast<ImoNoteRest*>( pMD->get_child(2) );
+        pNR->set_note_type_and_dots(k_half, 0);
+        pScore->end_of_changes(pScore->get_instrument(0), pNR, pNR);
+
+        CHECK( ScoreAlgorithms::get_applicable_clef_for(pScore, 0, 0, 128.0) == k_clef_G2 );
+        CHECK( ScoreAlgorithms::get_applicable_clef_for(pScore, 0, 0, 192.0) == k_clef_F4 );
+    }
+
 }
 
@@ -23,6 +23,7 @@
 #include "lomse_time.h"
 #include "lomse_xml_parser.h"
 #include "lomse_mxl_analyser.h"
+#include "lomse_im_measures_table.h"
 
 using namespace UnitTest;
 using namespace std;
@@ -129,6 +130,44 @@ public:
         return UnitTest::CurrentTest::Details()->testName;
     }
 
+    //-----------------------------------------------------------------------------------
+    string dump_tables(ImoScore* pScore)
+    {
+        stringstream ss;
+        ColStaffObjs* pTable = pScore->get_staffobjs_table();
+        ss << pTable->dump(true)
+           << "lines=" << pTable->num_lines()
+           << ", min note=" << pTable->min_note_duration()
+           << ", divisions=" << pTable->get_divisions()
+           << ", noterests=" << pTable->num_half_noterests() << ","
+           << pTable->num_quarter_noterests() << "," << pTable->num_eighth_noterests()
+           << "," << pTable->num_16th_noterests() << endl;
+        for (int i=0; i < pScore->get_num_instruments(); ++i)
+        {
+            ImoInstrument* pInstr = pScore->get_instrument(i);
+            ss << pInstr->get_measures_table()->dump();
+            ImoObj* pImo = pInstr->get_musicdata()->get_first_child();
+            for (; pImo; pImo = pImo->get_next_sibling())
+            {
+                if (pImo->is_note())
+                {
+                    ImoNote* pNote = static_cast<ImoNote*>(pImo);
+                    ss << pNote->get_actual_accidentals() << ","
+                       << pNote->get_notated_accidentals() << " ";
+                }
+            }
+            ss << endl;
+        }
+        return ss.str();
+    }
+
+    //-----------------------------------------------------------------------------------
+    ImoStaffObj* get_staffobj(ImoScore* pScore, int iInstr, int i)
+    {
+        ImoMusicData* pMD = pScore->get_instrument(iInstr)->get_musicdata();
+        return static_cast<ImoStaffObj*>( pMD->get_child(i) );
+    }
+
     void create_score(const string &ldp, ostream& reporter=cout)
     {
         m_pDoc = LOMSE_NEW Document(m_libraryScope);
@@ -3626,6 +3665,430 @@ SUITE(ColStaffObjsBuilderTest)
         if (pRoot && !pRoot->is_document()) delete pRoot;
     }
 
+    TEST_FIXTURE(ColStaffObjsBuilderTestFixture, indexed_access_001)
+    {
+        //@001. entries can be accessed by position and know their position
+
+        Document doc(m_libraryScope);
+        doc.from_string("(score (vers 2.0)(instrument (musicData (clef G)"
+            "(n c4 q)(n d4 q)(barline)(n e4 q) )))");
+        ImoScore* pScore = dynamic_cast<ImoScore*>( doc.get_content_item(0) );
+        ColStaffObjs* pTable = pScore->get_staffobjs_table();
+
+        CHECK( pTable->num_entries() == 5 );
+        int i = 0;
+        ColStaffObjsIterator it;
+        for (it=pTable->begin(); it != pTable->end(); ++it, ++i)
+        {
+            CHECK( (*it)->index() == i );
+            CHECK( pTable->entry_at(i) == *it );
+        }
+        CHECK( pTable->entry_at(-1) == nullptr );
+        CHECK( pTable->entry_at(5) == nullptr );
+        CHECK( pTable->front()->get_prev() == nullptr );
+        CHECK( pTable->back()->get_next() == nullptr );
+        CHECK( pTable->entry_at(2)->get_next() == pTable->entry_at(3) );
+        CHECK( pTable->entry_at(2)->get_prev() == pTable->entry_at(1) );
+    }
+
+    TEST_FIXTURE(ColStaffObjsBuilderTestFixture, indexed_access_002)
+    {
+        //@002. find() returns the entry for a staffobj
+
+        Document doc(m_libraryScope);
+        doc.from_string("(score (vers 2.0)(instrument (musicData (clef G)"
+            "(n c4 q)(n d4 q)(barline)(n e4 q) )))");
+        ImoScore* pScore = dynamic_cast<ImoScore*>( doc.get_content_item(0) );
+        ColStaffObjs* pTable = pScore->get_staffobjs_table();
+
+        ImoStaffObj* pSO = pTable->entry_at(3)->imo_object();
+        ColStaffObjsIterator it = pTable->find(pSO);
+        CHECK( *it == pTable->entry_at(3) );
+        CHECK( it.prev() == pTable->entry_at(2) );
+        CHECK( it.next() == pTable->entry_at(4) );
+        --it;
+        CHECK( *it == pTable->entry_at(2) );
+    }
+
+    TEST_FIXTURE(ColStaffObjsBuilderTestFixture, indexed_access_003)
+    {
+        //@003. after deleting an entry, positions are updated
+
+        Document doc(m_libraryScope);
+        doc.from_string("(score (vers 2.0)(instrument (musicData (clef G)"
+            "(n c4 q)(n d4 q)(barline)(n e4 q) )))");
+        ImoScore* pScore = dynamic_cast<ImoScore*>( doc.get_content_item(0) );
+        ColStaffObjs* pTable = pScore->get_staffobjs_table();
+        ImoStaffObj* pNote = pTable->entry_at(1)->imo_object();
+        ImoStaffObj* pLast = pTable->back()->imo_object();
+
+        pTable->delete_entry_for(pNote);
+
+        CHECK( pTable->num_entries() == 4 );
+        CHECK( pTable->find(pNote) == pTable->end() );
+        CHECK( (*pTable->find(pLast))->index() == 3 );
+        CHECK( pTable->entry_at(0)->get_next() == pTable->entry_at(1) );
+        CHECK( pTable->entry_at(1)->imo_object()->is_note() == true );
+    }
+
+    TEST_FIXTURE(ColStaffObjsBuilderTestFixture, indexed_access_004)
+    {
+        //@004. entries of second instrument are inserted between the entries of the
+        //      first one. Positions are right
+
+        Document doc(m_libraryScope);
+        doc.from_string("(score (vers 2.0)"
+            "(instrument (musicData (clef G)(n c4 q)(n d4 q)(barline)(n e4 h)(barline) ))"
+            "(instrument (musicData (clef F4)(n c3 h)(barline)(n e3 q)(n f3 q)(barline) )))");
+        ImoScore* pScore = dynamic_cast<ImoScore*>( doc.get_content_item(0) );
+        ColStaffObjs* pTable = pScore->get_staffobjs_table();
+
+        CHECK( pTable->num_entries() == 12 );
+        CHECK( pTable->entry_at(1)->num_instrument() == 1 );
+        ColStaffObjsEntry* pPrev = nullptr;
+        for (int i=0; i < pTable->num_entries(); ++i)
+        {
+            ColStaffObjsEntry* pEntry = pTable->entry_at(i);
+            CHECK( pEntry->index() == i );
+            CHECK( pEntry->get_prev() == pPrev );
+            CHECK( !pPrev || pPrev->ticks() <= pEntry->ticks() );
+            pPrev = pEntry;
+        }
+    }
+
+    TEST_FIXTURE(ColStaffObjsBuilderTestFixture, update_001)
+    {
+        //@001. duration changed. Measures after the change are not affected
+
+        Document doc(m_libraryScope);
+        doc.from_string("(score (vers 2.0)"
+            "(instrument (musicData (clef G)(key D)(time 2 4)"
+            "(n c4 q)(n d4 q)(barline)(n c5 h v1)(n e4 q v2)(n f4 q v2)(barline)"
+            "(n g4 q)(n a4 q)(barline)(n f4 h)(barline) ))"
+            "(instrument (musicData (clef F4)(key D)(time 2 4)"
+            "(n c3 h)(barline)(n e3 q)(n f3 q)(barline)(n g3 h)(barline)"
+            "(n a3 h)(barline) )))");
+        ImoScore* pScore = dynamic_cast<ImoScore*>( doc.get_content_item(0) );
+        ColStaffObjs* pTable = pScore->get_staffobjs_table();
+        CHECK( pTable->is_updatable() == true );
+
+        ImoNoteRest* pNR = static_cast<ImoNoteRest*>( get_staffobj(pScore, 0, 8) );
+        pNR->set_note_type_and_dots(k_eighth, 0);
+        pScore->end_of_changes(pScore->get_instrument(0), pNR, pNR);
+        string updated = dump_tables(pScore);
+
+        CHECK( pScore->get_staffobjs_table() == pTable );   //not rebuilt
+        pScore->end_of_changes();
+        CHECK( updated == dump_tables(pScore) );
+    }
+
+    TEST_FIXTURE(ColStaffObjsBuilderTestFixture, update_008)
+    {
+        //@008. the entries replaced when updating are deleted
+
+        Document doc(m_libraryScope);
+        NodePool* pPool = doc.get_doc_model()->get_node_pool();
+        NodePoolScope scope(pPool);
+        doc.from_string("(score (vers 2.0)"
+            "(instrument (musicData (clef G)(key D)(time 2 4)"
+            "(n c4 q)(n d4 q)(barline)(n e4 q)(n f4 q)(barline)"
+            "(n g4 q)(n a4 q)(barline) )))");
+        ImoScore* pScore = dynamic_cast<ImoScore*>( doc.get_content_item(0) );
+        ColStaffObjs* pTable = pScore->get_staffobjs_table();
+        size_t nodes = pPool->get_live_nodes();
+
+        ImoNoteRest* pNR = static_cast<ImoNoteRest*>( get_staffobj(pScore, 0, 6) );
+        pNR->set_note_type_and_dots(k_quarter, 0);
+        pScore->end_of_changes(pScore->get_instrument(0), pNR, pNR);
+
+        CHECK( pScore->get_staffobjs_table() == pTable );   //not rebuilt
+        CHECK( pPool->get_live_nodes() == nodes );
+    }
+
+    TEST_FIXTURE(ColStaffObjsBuilderTestFixture, update_002)
+    {
+        //@002. duration changed. Timepos of next measures changed
+
+        Document doc(m_libraryScope);
+        doc.from_string("(score (vers 2.0)"
+            "(instrument (musicData (clef G)(key D)(time 2 4)"
+            "(n c4 q)(n d4 q)(barline)(n e4 q)(n +f4 q)(barline)"
+            "(n g4 q)(n a4 q)(barline)(n f4 h)(barline) ))"
+            "(instrument (musicData (clef F4)(key D)(time 2 4)"
+            "(n c3 h)(barline)(n e3 q)(n f3 q)(barline)(n g3 h)(barline)"
+            "(n a3 h)(barline) )))");
+        ImoScore* pScore = dynamic_cast<ImoScore*>( doc.get_content_item(0) );
+        ColStaffObjs* pTable = pScore->get_staffobjs_table();
+
+        ImoNoteRest* pNR = static_cast<ImoNoteRest*>( get_staffobj(pScore, 1, 5) );
+        pNR->set_note_type_and_dots(k_half, 0);
+        pScore->end_of_changes(pScore->get_instrument(1), pNR, pNR);
+        string updated = dump_tables(pScore);
+
+        CHECK( pScore->get_staffobjs_table() == pTable );
+        pScore->end_of_changes();
+        CHECK( updated == dump_tables(pScore) );
+    }
+
+    TEST_FIXTURE(ColStaffObjsBuilderTestFixture, update_003)
+    {
+        //@003. notes inserted and deleted. Accidentals in measure updated
+
+        Document doc(m_libraryScope);
+        doc.from_string("(score (vers 2.0)"
+            "(instrument (musicData (clef G)(key C)(time 2 4)"
+            "(n c4 q)(n d4 q)(barline)(n +f4 q)(n f4 q)(barline)"
+            "(n g4 q)(n f4 q)(barline) ))"
+            "(instrument (musicData (clef F4)(key C)(time 2 4)"
+            "(n c3 h)(barline)(n e3 q)(n f3 q)(barline)(n g3 h)(barline) )))");
+        ImoScore* pScore = dynamic_cast<ImoScore*>( doc.get_content_item(0) );
+        ImoInstrument* pInstr = pScore->get_instrument(0);
+        ColStaffObjs* pTable = pScore->get_staffobjs_table();
+        stringstream errormsg;
+
+        //insert
+        ImoStaffObj* pAt = get_staffobj(pScore, 0, 7);
+        list<ImoStaffObj*> objects =
+            pInstr->insert_staff_objects_at(pAt, "(n f4 e)(n a4 e)", errormsg);
+        pScore->end_of_changes(pInstr, objects.front(), objects.back());
+        string updated = dump_tables(pScore);
+        CHECK( pScore->get_staffobjs_table() == pTable );
+        pScore->end_of_changes();
+        CHECK( updated == dump_tables(pScore) );
+
+        //delete
+        pTable = pScore->get_staffobjs_table();
+        ImoStaffObj* pNote = get_staffobj(pScore, 0, 6);
+        ImoStaffObj* pPrev = static_cast<ImoStaffObj*>( pNote->get_prev_sibling() );
+        ImoStaffObj* pNext = static_cast<ImoStaffObj*>( pNote->get_next_sibling() );
+        pInstr->delete_staffobj(pNote);
+        pScore->end_of_changes(pInstr, pPrev, pNext);
+        updated = dump_tables(pScore);
+        CHECK( pScore->get_staffobjs_table() == pTable );
+        pScore->end_of_changes();
+        CHECK( updated == dump_tables(pScore) );
+    }
+
+    TEST_FIXTURE(ColStaffObjsBuilderTestFixture, update_004)
+    {
+        //@004. barline inserted and deleted. Measures renumbered
+
+        Document doc(m_libraryScope);
+        doc.from_string("(score (vers 2.0)"
+            "(instrument (musicData (clef G)(time 2 4)"
+            "(n c4 q)(n d4 q)(barline)(n e4 q)(n f4 q)(n g4 q)(n a4 q)(barline)"
+            "(time 3 4)(n g4 q)(n f4 h)(barline) ))"
+            "(instrument (musicData (clef F4)(time 2 4)"
+            "(n c3 h)(barline)(n e3 q)(n f3 q)(n g3 h)(barline)"
+            "(time 3 4)(n a3 h.)(barline) )))");
+        ImoScore* pScore = dynamic_cast<ImoScore*>( doc.get_content_item(0) );
+        ImoInstrument* pInstr = pScore->get_instrument(0);
+        ColStaffObjs* pTable = pScore->get_staffobjs_table();
+        stringstream errormsg;
+
+        ImoStaffObj* pAt = get_staffobj(pScore, 0, 7);
+        ImoStaffObj* pBarline = pInstr->insert_staffobj_at(pAt, "(barline)", errormsg);
+        pScore->end_of_changes(pInstr, pBarline, pBarline);
+        string updated = dump_tables(pScore);
+        CHECK( pScore->get_staffobjs_table() == pTable );
+        pScore->end_of_changes();
+        CHECK( updated == dump_tables(pScore) );
+
+        pTable = pScore->get_staffobjs_table();
+        ImoStaffObj* pPrev = static_cast<ImoStaffObj*>( pBarline->get_prev_sibling() );
+        ImoStaffObj* pNext = static_cast<ImoStaffObj*>( pBarline->get_next_sibling() );
+        pInstr->delete_staffobj(pBarline);
+        pScore->end_of_changes(pInstr, pPrev, pNext);
+        updated = dump_tables(pScore);
+        CHECK( pScore->get_staffobjs_table() == pTable );
+        pScore->end_of_changes();
+        CHECK( updated == dump_tables(pScore) );
+    }
+
+    TEST_FIXTURE(ColStaffObjsBuilderTestFixture, update_005)
+    {
+        //@005. changes in first measure and key signature changed
+
+        Document doc(m_libraryScope);
+        doc.from_string("(score (vers 2.0)"
+            "(instrument (musicData (clef G)(key C)(time 2 4)"
+            "(n c4 q)(n f4 q)(barline)(n e4 q)(n f4 q)(barline)"
+            "(key F)(n b4 q)(n f4 q)(barline) )))");
+        ImoScore* pScore = dynamic_cast<ImoScore*>( doc.get_content_item(0) );
+        ImoInstrument* pInstr = pScore->get_instrument(0);
+        ColStaffObjs* pTable = pScore->get_staffobjs_table();
+        stringstream errormsg;
+
+        ImoStaffObj* pKey = get_staffobj(pScore, 0, 1);
+        ImoStaffObj* pNewKey = pInstr->insert_staffobj_at(pKey, "(key D)", errormsg);
+        pInstr->delete_staffobj(pKey);
+        pScore->end_of_changes(pInstr, nullptr, pNewKey);
+        string updated = dump_tables(pScore);
+        CHECK( pScore->get_staffobjs_table() == pTable );
+        pScore->end_of_changes();
+        CHECK( updated == dump_tables(pScore) );
+    }
+
+    TEST_FIXTURE(ColStaffObjsBuilderTestFixture, update_006)
+    {
+        //@006. a new voice in modified measures. Lines assignment changes: rebuilt
+
+        Document doc(m_libraryScope);
+        doc.from_string("(score (vers 2.0)"
+            "(instrument (musicData (clef G)(time 2 4)"
+            "(n c4 q)(n d4 q)(barline)(n e4 q)(n f4 q)(barline) ))"
+            "(instrument (musicData (clef F4)(time 2 4)"
+            "(n c3 h)(barline)(n e3 h)(barline) )))");
+        ImoScore* pScore = dynamic_cast<ImoScore*>( doc.get_content_item(0) );
+        ImoInstrument* pInstr = pScore->get_instrument(0);
+        ColStaffObjs* pTable = pScore->get_staffobjs_table();
+        stringstream errormsg;
+
+        ImoStaffObj* pAt = get_staffobj(pScore, 0, 6);
+        ImoStaffObj* pNote = pInstr->insert_staffobj_at(pAt, "(n c5 q v2)", errormsg);
+        pScore->end_of_changes(pInstr, pNote, pNote);
+        string updated = dump_tables(pScore);
+        CHECK( pScore->get_staffobjs_table() != pTable );   //rebuilt
+        pScore->end_of_changes();
+        CHECK( updated == dump_tables(pScore) );
+    }
+
+    TEST_FIXTURE(ColStaffObjsBuilderTestFixture, update_007)
+    {
+        //@007. scores with grace notes are rebuilt
+
+        Document doc(m_libraryScope);
+        doc.from_file(m_scores_path + "unit-tests/grace-notes/222-graces-two-voices.xml",
+                      Document::k_format_mxl);
+        ImoScore* pScore = dynamic_cast<ImoScore*>( doc.get_content_item(0) );
+        ColStaffObjs* pTable = pScore->get_staffobjs_table();
+        CHECK( pTable->is_updatable() == false );
+
+        ColStaffObjsIterator it = pTable->begin();
+        while (it != pTable->end() && !((*it)->imo_object()->is_note()
+               && static_cast<ImoNote*>((*it)->imo_object())->is_regular_note()))
+        {
+            ++it;
+        }
+        ImoNoteRest* pNR = static_cast<ImoNoteRest*>( (*it)->imo_object() );
+        pNR->set_note_type_and_dots(k_quarter, 0);
+        pScore->end_of_changes(pScore->get_instrument(0), pNR, pNR);
+        string updated = dump_tables(pScore);
+        CHECK( pScore->get_staffobjs_table() != pTable );
+        pScore->end_of_changes();
+        CHECK( updated == dump_tables(pScore) );
+    }
+
+    TEST_FIXTURE(ColStaffObjsBuilderTestFixture, ticks_001)
+    {
+        //@001. ticks are exact for tuplets and dotted notes
+
+        TimeUnits triplet = TimeUnits(k_duration_eighth) * 2.0 / 3.0;
+        CHECK( to_ticks(triplet) * 3 == to_ticks(TimeUnits(k_duration_quarter)) );
+        CHECK( to_ticks(triplet + triplet + triplet)
+               == to_ticks(TimeUnits(k_duration_quarter)) );
+
+        TimeUnits septuplet = TimeUnits(k_duration_16th) * 4.0 / 7.0;
+        TimeUnits sum = 0.0;
+        for (int i=0; i < 7; ++i)
+            sum += septuplet;
+        CHECK( to_ticks(septuplet) * 7 == to_ticks(TimeUnits(k_duration_quarter)) );
+        CHECK( to_ticks(sum) == to_ticks(TimeUnits(k_duration_quarter)) );
+
+        TimeUnits dotted = TimeUnits(k_duration_256th) * 1.75;
+        CHECK( to_ticks(dotted) * 4 == to_ticks(TimeUnits(k_duration_256th)) * 7 );
+
+        CHECK( to_time_units(to_ticks(triplet)) == triplet );
+        CHECK( to_ticks(LOMSE_NO_TIME) > to_ticks(1000000.0) );
+    }
+
+    TEST_FIXTURE(ColStaffObjsBuilderTestFixture, ticks_002)
+    {
+        //@002. entries are ordered by ticks. Ticks are updated after edition
+
+        Document doc(m_libraryScope);
+        doc.from_string("(score (vers 2.0)"
+            "(instrument (musicData (clef G)"
+            "(n c4 e (tm 2 3))(n d4 e (tm 2 3))(n e4 e (tm 2 3))"
+            "(barline)(n c4 q)(barline) ))"
+            "(instrument (musicData (clef F4)"
+            "(n c3 s (tm 4 7))(n d3 s (tm 4 7))(n e3 s (tm 4 7))(n f3 s (tm 4 7))"
+            "(n g3 s (tm 4 7))(n a3 s (tm 4 7))(n b3 s (tm 4 7))"
+            "(barline)(n c3 q)(barline) )))");
+        ImoScore* pScore = dynamic_cast<ImoScore*>( doc.get_content_item(0) );
+        ColStaffObjs* pTable = pScore->get_staffobjs_table();
+
+        bool fOk = true;
+        TimeTicks prev = 0;
+        for (ColStaffObjsIterator it=pTable->begin(); it != pTable->end(); ++it)
+        {
+            fOk &= ((*it)->ticks() == to_ticks((*it)->time()));
+            fOk &= ((*it)->ticks() >= prev);
+            prev = (*it)->ticks();
+        }
+        CHECK( fOk );
+        CHECK( prev == to_ticks(TimeUnits(k_duration_half)) );
+
+        ImoInstrument* pInstr = pScore->get_instrument(0);
+        ImoMusicData* pMD = pInstr->get_musicdata();
+        ImoNoteRest* pNR = static_cast<ImoNoteRest*>( pMD->get_child(2) );
+        pNR->set_note_type_and_dots(k_quarter, 0);
+        pScore->end_of_changes();
+
+        pTable = pScore->get_staffobjs_table();
+        fOk = true;
+        for (ColStaffObjsIterator it=pTable->begin(); it != pTable->end(); ++it)
+            fOk &= ((*it)->ticks() == to_ticks((*it)->time()));
+        CHECK( fOk );
+    }
+
+    TEST_FIXTURE(ColStaffObjsBuilderTestFixture, ticks_003)
+    {
+        //@003. MusicXML. Rounded durations of septuplets (divisions=480) are snapped
+        //@     to the exact duration. Notes in both parts are at the same ticks
+
+        Document doc(m_libraryScope);
+        doc.from_file(m_scores_path + "unit-tests/colstaffobjs/10-rounded-septuplets.xml",
+                      Document::k_format_mxl);
+        ImoScore* pScore = dynamic_cast<ImoScore*>( doc.get_content_item(0) );
+        CHECK( pScore != nullptr );
+        ColStaffObjs* pTable = pScore->get_staffobjs_table();
+
+//        cout << test_name() << endl << pTable->dump();
+
+        CHECK( pTable->num_entries() == 24 );
+
+        vector<TimeTicks> notes[2];
+        for (ColStaffObjsIterator it=pTable->begin(); it != pTable->end(); ++it)
+        {
+            if ((*it)->imo_object()->is_note())
+                notes[(*it)->num_instrument()].push_back( (*it)->ticks() );
+        }
+        CHECK( notes[0].size() == 8 );
+        CHECK( notes[0] == notes[1] );
+
+        TimeUnits septuplet = TimeUnits(k_duration_16th) * 4.0 / 7.0;
+        bool fOk = true;
+        for (int i=0; i < int(notes[0].size()); ++i)
+            fOk &= (notes[0][i] == to_ticks(septuplet * TimeUnits(i)));
+        CHECK( fOk );
+
+        //notes at the same time are consecutive entries
+        ColStaffObjsIterator it = pTable->begin();
+        while (!(*it)->imo_object()->is_note())
+            ++it;
+        fOk = true;
+        for (int i=0; i < 8; ++i)
+        {
+            fOk &= ((*it)->num_instrument() == 0);
+            TimeTicks ticks = (*it)->ticks();
+            ++it;
+            fOk &= ((*it)->num_instrument() == 1 && (*it)->ticks() == ticks);
+            ++it;
+        }
+        CHECK( fOk );
+    }
+
 //    TEST_FIXTURE(ColStaffObjsBuilderTestFixture, playback_time_100)
 //    {
 //        //@100. auxiliary, for checking the ColStaffObjs
@@ -81,6 +81,31 @@ SUITE(LdpTokenizerTest)
         CHECK( numTokens == 45 );
     }
 
+    TEST_FIXTURE(LdpTokenizerTestFixture, TokenizerCanReadMappedFile)
+    {
+        //mapped file gives the same tokens than file reader
+        string filename = m_scores_path + "00023-spacing-in-prolog-two-instr.lms";
+        LdpFileReader fileReader(filename);
+        LdpTokenizer fileTokenizer(fileReader, cout);
+        LdpMappedFileReader reader(filename);
+        LdpTokenizer tokenizer(reader, cout);
+        int numTokens = 0;
+        bool fOk = true;
+        LdpToken* token = tokenizer.read_token();
+        for (; token->get_type() != tkEndOfFile; token = tokenizer.read_token())
+        {
+            numTokens++;
+            LdpToken* fileToken = fileTokenizer.read_token();
+            fOk &= (token->get_type() == fileToken->get_type());
+            fOk &= (token->get_value() == fileToken->get_value());
+            fOk &= (token->get_line_number() == fileToken->get_line_number());
+        }
+        CHECK( fOk );
+        CHECK( fileTokenizer.read_token()->get_type() == tkEndOfFile );
+        CHECK( reader.end_of_data() );
+        CHECK( numTokens > 0 );
+    }
+
     TEST_FIXTURE(LdpTokenizerTestFixture, TokenizerCanReadUnicodeString)
     {
         //cout << "'" << "Текст на кирилица" << "'" << endl;
@@ -265,6 +290,34 @@ SUITE(LdpTokenizerTest)
         CHECK( token->get_value() == "-45.70" );
     }
 
+    TEST_FIXTURE(LdpTokenizerTestFixture, Tokenizer_value_is_view)
+    {
+        //values are views into the source, not null terminated
+        LdpTextReader reader("(n c4 q)");
+        LdpTokenizer tokenizer(reader, cout);
+        LdpToken* token = tokenizer.read_token();
+        token = tokenizer.read_token();
+        CHECK( token->get_type() == tkLabel );
+        CHECK( token->get_value_size() == 1 );
+        CHECK( token->value_is("n") );
+        CHECK( string(token->get_value_data(), 3) == "n c" );
+        token = tokenizer.read_token();
+        CHECK( token->get_value() == "c4" );
+        CHECK( token->value_is("c4") );
+        CHECK( !token->value_is("c") );
+        CHECK( !token->value_is("c45") );
+    }
+
+    TEST_FIXTURE(LdpTokenizerTestFixture, Tokenizer_value_with_tabs_is_copied)
+    {
+        //tabs and CR in strings are replaced by spaces
+        LdpTextReader reader(" \"this\tis a\r\nstring\" ");
+        LdpTokenizer tokenizer(reader, cout);
+        LdpToken* token = tokenizer.read_token();
+        CHECK( token->get_type() == tkString );
+        CHECK( token->get_value() == "this is a \nstring" );
+    }
+
     TEST_FIXTURE(LdpTokenizerTestFixture, Tokenizer_skip_bom)
     {
         LdpTextReader reader("\xef\xbb\xbf -45.70 ");
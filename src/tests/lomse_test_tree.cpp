@@ -980,6 +980,97 @@ SUITE(TreeTest)
         delete z2;
     }
 
+    TEST_FIXTURE(TreeTestFixture, TreeNumChildrenUpdatedWhenEditing)
+    {
+        CreateTree();
+        Tree<Element>::depth_first_iterator it = m_tree.begin();
+        ++it;   //B
+        ++it;   //C
+        ++it;   //D
+        m_tree.erase(it);
+        CHECK( a1->get_num_children() == 2 );
+
+        Element* z = LOMSE_NEW Element("Z");
+        m_tree.insert(i, z);
+        CHECK( a1->get_num_children() == 3 );
+        CHECK( a1->get_child(1) == z );
+
+        Element* y = LOMSE_NEW Element("Y");
+        m_tree.replace_node(z, y);
+        CHECK( a1->get_num_children() == 3 );
+        CHECK( a1->get_child(1) == y );
+
+        a1->remove_child(b1);
+        CHECK( a1->get_num_children() == 2 );
+        CHECK( a1->get_child(0) == y );
+
+        delete z;
+        delete y;
+        DeleteTestData();
+    }
+
+    TEST_FIXTURE(TreeTestFixture, TreeGetChildUsingIndex)
+    {
+        Element* a2 = LOMSE_NEW Element("A");
+        vector<Element*> children;
+        for (int i=0; i < 40; ++i)
+        {
+            children.push_back( LOMSE_NEW Element("x") );
+            a2->append_child(children.back());
+        }
+        CHECK( a2->has_children_index() == false );
+
+        CHECK( a2->get_num_children() == 40 );
+        bool fOk = true;
+        for (int i=0; i < 40; ++i)
+            fOk &= (a2->get_child(i) == children[i]);
+        CHECK( fOk );
+        CHECK( a2->has_children_index() == true );
+
+        for (Element* child : children)
+            delete child;
+        delete a2;
+    }
+
+    TEST_FIXTURE(TreeTestFixture, TreeChildrenIndexRebuiltAfterChanges)
+    {
+        Element* a2 = LOMSE_NEW Element("A");
+        m_tree.set_root(a2);
+        vector<Element*> children;
+        for (int i=0; i < 20; ++i)
+        {
+            children.push_back( LOMSE_NEW Element("x") );
+            a2->append_child(children.back());
+        }
+        CHECK( a2->get_child(10) == children[10] );
+
+        Element* z = LOMSE_NEW Element("Z");
+        m_tree.insert(children[5], z);
+        CHECK( a2->has_children_index() == false );
+        CHECK( a2->get_child(5) == z );
+        CHECK( a2->get_child(10) == children[9] );
+
+        a2->remove_child(children[0]);
+        CHECK( a2->has_children_index() == false );
+        CHECK( a2->get_child(4) == z );
+        CHECK( a2->get_child(19) == children[19] );
+        bool fOk = false;
+        try {
+            a2->get_child(20);
+        }
+        catch(exception& e)
+        {
+            e.what();       //compiler happy
+            fOk = true;
+        }
+        CHECK( fOk );
+
+        for (Element* child : children)
+            delete child;
+        delete z;
+        delete a2;
+    }
+
 //Commented out. The tests pass OK but they produce memory leaks because the tree class
 //is not well designed and Tree<T> does not deletes the root and its children.
 //    TEST_FIXTURE(TreeTestFixture, tree_clone_01)
@@ -9,11 +9,15 @@
 
 #include <UnitTest++.h>
 #include <iostream>
+#include <sstream>
 #include "lomse_build_options.h"
 
 //classes related to these tests
 #include "lomse_injectors.h"
 #include "lomse_xml_parser.h"
+#include "lomse_mxl_analyser.h"
+#include "lomse_mnx_analyser.h"
+#include "lomse_lmd_analyser.h"
 #include "private/lomse_document_p.h"
 
 using namespace UnitTest;
@@ -156,6 +160,198 @@ SUITE(XmlParserTest)
 
     }
 
+    TEST_FIXTURE(XmlParserTestFixture, xml_parser_07)
+    {
+        //@07. Parse chunk. Line numbers relative to full document
+
+        XmlParser parser;
+        parser.parse_chunk("<measure number='1'>\n<note/>\n</measure>", 20);
+        XmlNode* root = parser.get_tree_root();
+        CHECK( root->name() == "measure" );
+        XmlNode note = root->child("note");
+        CHECK( parser.get_line_number(root) == 20 );
+        CHECK( parser.get_line_number(&note) == 21 );
+        CHECK( parser.is_node_in_tree(&note) == true );
+
+        XmlParser other;
+        other.parse_text("<note/>");
+        CHECK( other.is_node_in_tree(&note) == false );
+    }
+
+    TEST_FIXTURE(XmlParserTestFixture, xml_stream_reader_01)
+    {
+        //@s01. Stream reader. Markup types, depth and names
+
+        stringstream ss(
+            "<?xml version=\"1.0\"?>\n"
+            "<!DOCTYPE score-partwise [ <!ENTITY x \"<y>\"> ]>\n"
+            "<score version='3.0'><!-- a <b> --><a attr='1>2'/>\n"
+            "<b>text<![CDATA[<c>]]></b></score>");
+        XmlStreamReader reader(ss);
+
+        CHECK( reader.next_markup() == XmlStreamReader::k_other );
+        CHECK( reader.next_markup() == XmlStreamReader::k_other );
+        CHECK( reader.next_markup() == XmlStreamReader::k_start_tag );
+        CHECK( reader.get_name() == "score" );
+        CHECK( reader.get_depth() == 1 );
+        CHECK( reader.get_tag_line() == 3 );
+        CHECK( reader.next_markup() == XmlStreamReader::k_other );
+        CHECK( reader.next_markup() == XmlStreamReader::k_empty_tag );
+        CHECK( reader.get_name() == "a" );
+        CHECK( reader.get_tag() == "<a attr='1>2'/>" );
+        CHECK( reader.get_depth() == 2 );
+        CHECK( reader.next_markup() == XmlStreamReader::k_start_tag );
+        CHECK( reader.get_name() == "b" );
+        CHECK( reader.get_tag_line() == 4 );
+        CHECK( reader.next_markup() == XmlStreamReader::k_other );
+        CHECK( reader.get_text() == "text" );
+        CHECK( reader.next_markup() == XmlStreamReader::k_end_tag );
+        CHECK( reader.get_depth() == 2 );
+        CHECK( reader.next_markup() == XmlStreamReader::k_end_tag );
+        CHECK( reader.get_name() == "score" );
+        CHECK( reader.get_depth() == 1 );
+        CHECK( reader.next_markup() == XmlStreamReader::k_eof );
+    }
+
+    TEST_FIXTURE(XmlParserTestFixture, xml_stream_reader_02)
+    {
+        //@s02. Stream reader. Read full element
+
+        stringstream ss("<part id='P1'><measure number='1'><note><a/></note>"
+                        "</measure><measure number='2'/></part>");
+        XmlStreamReader reader(ss);
+
+        CHECK( reader.next_markup() == XmlStreamReader::k_start_tag );
+        CHECK( reader.next_markup() == XmlStreamReader::k_start_tag );
+        string text;
+        CHECK( reader.read_element(&text) == true );
+        CHECK( text == "<measure number='1'><note><a/></note></measure>" );
+        CHECK( reader.get_name() == "measure" );
+        CHECK( reader.next_markup() == XmlStreamReader::k_empty_tag );
+        CHECK( reader.next_markup() == XmlStreamReader::k_end_tag );
+        CHECK( reader.get_name() == "part" );
+        CHECK( reader.next_markup() == XmlStreamReader::k_eof );
+    }
+
+    TEST_FIXTURE(XmlParserTestFixture, xml_stream_reader_03)
+    {
+        //@s03. Stream reader. Element not closed
+
+        stringstream ss("<part id='P1'><measure number='1'><note>");
+        XmlStreamReader reader(ss);
+
+        CHECK( reader.next_markup() == XmlStreamReader::k_start_tag );
+        CHECK( reader.next_markup() == XmlStreamReader::k_start_tag );
+        string text;
+        CHECK( reader.read_element(&text) == false );
+        CHECK( reader.get_type() == XmlStreamReader::k_error );
+    }
+
+    TEST_FIXTURE(XmlParserTestFixture, xml_tags_table_01)
+    {
+        //@01. XmlTagsTable. All names found. Unknown names return undefined tag
+
+        static const XmlTagsTable::Entry tags[] =
+        {
+            { "note",       1 },
+            { "rest",       2 },
+            { "measure",    3 },
+            { "part",       4 },
+            { "part-list",  5 },
+            { "score-part", 6 },
+        };
+        XmlTagsTable table(tags, 6, -1);
+
+        CHECK( table.get_tag("note") == 1 );
+        CHECK( table.get_tag("rest") == 2 );
+        CHECK( table.get_tag("measure") == 3 );
+        CHECK( table.get_tag("part") == 4 );
+        CHECK( table.get_tag("part-list") == 5 );
+        CHECK( table.get_tag(string("score-part")) == 6 );
+        CHECK( table.get_tag("") == -1 );
+        CHECK( table.get_tag("not") == -1 );
+        CHECK( table.get_tag("notes") == -1 );
+        CHECK( table.get_tag("part-lis") == -1 );
+        CHECK( table.get_table_size() >= 12 );
+    }
+
+    TEST_FIXTURE(XmlParserTestFixture, xml_tags_table_02)
+    {
+        //@02. XmlTagsTable. Duplicated names: first entry is kept
+
+        static const XmlTagsTable::Entry tags[] =
+        {
+            { "note",       1 },
+            { "note",       2 },
+            { "rest",       3 },
+        };
+        XmlTagsTable table(tags, 3, 0);
+
+        CHECK( table.get_tag("note") == 1 );
+        CHECK( table.get_tag("rest") == 3 );
+    }
+
+    TEST_FIXTURE(XmlParserTestFixture, xml_tags_table_03)
+    {
+        //@03. XmlTagsTable. Large table without collisions
+
+        vector<string> names;
+        for (int i=0; i < 300; ++i)
+        {
+            stringstream ss;
+            ss << "tag-" << i;
+            names.push_back(ss.str());
+        }
+        vector<XmlTagsTable::Entry> tags;
+        for (int i=0; i < 300; ++i)
+        {
+            XmlTagsTable::Entry entry = { names[i].c_str(), i };
+            tags.push_back(entry);
+        }
+        XmlTagsTable table(&tags[0], tags.size(), -1);
+
+        bool fOk = true;
+        for (int i=0; i < 300; ++i)
+            fOk &= (table.get_tag(names[i]) == i);
+        CHECK( fOk );
+        CHECK( table.get_tag("tag-300") == -1 );
+    }
+
+    TEST_FIXTURE(XmlParserTestFixture, xml_tags_table_04)
+    {
+        //@04. XmlTagsTable. Valid hints avoid the seed search. Invalid ones are ignored
+
+        static const XmlTagsTable::Entry tags[] =
+        {
+            { "note",       1 },
+            { "rest",       2 },
+            { "measure",    3 },
+            { "part",       4 },
+        };
+        XmlTagsTable table(tags, 4, -1);
+        CHECK( table.was_seed_searched() == true );
+
+        XmlTagsTable table2(tags, 4, -1, table.get_seed(), table.get_table_size());
+        CHECK( table2.was_seed_searched() == false );
+        CHECK( table2.get_seed() == table.get_seed() );
+        CHECK( table2.get_tag("measure") == 3 );
+
+        XmlTagsTable table3(tags, 4, -1, 1u, 3);      //size is not a power of 2
+        CHECK( table3.was_seed_searched() == true );
+        CHECK( table3.get_tag("part") == 4 );
+    }
+
+    TEST_FIXTURE(XmlParserTestFixture, xml_tags_table_05)
+    {
+        //@05. XmlTagsTable. The hints used by the analysers are valid
+
+        CHECK( MxlAnalyser::get_tags_table().was_seed_searched() == false );
+        CHECK( MnxAnalyser::get_tags_table().was_seed_searched() == false );
+        CHECK( LmdAnalyser::get_tags_table().was_seed_searched() == false );
+        CHECK( MxlAnalyser::get_tags_table().get_tag("note") != -1 );
+        CHECK( MxlAnalyser::get_tags_table().get_tag("no-tag") == -1 );
+    }
+
     TEST_FIXTURE(XmlParserTestFixture, xml_parser_901)
     {
         //@901. File not found
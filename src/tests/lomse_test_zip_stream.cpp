@@ -19,6 +19,8 @@
 #include "lomse_zip_stream.h"
 
 #include <cstring>
+#include <fstream>
+#include <iterator>
 
 using namespace UnitTest;
 using namespace std;
@@ -380,6 +382,58 @@ SUITE(ZipInputStreamTest)
         delete[] data;
     }
 
+    TEST_FIXTURE(ZipInputStreamTestFixture, zip_in_memory)
+    {
+        string path = m_scores_path + "10014-compressed-flat-lmd.zip";
+        ifstream file(path.c_str(), ios::in | ios::binary);
+        string content((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+
+        ZipInputStream zs(content.data(), content.size());
+        CHECK( zs.get_num_entries() == 1 );
+        ZipEntryInfo info;
+        zs.get_current_entry_info(info);
+        CHECK( info.filename == "lenmusdoc-example.lmd" );
+        CHECK( zs.is_open() == true );
+        CHECK( zs.get_size() == 8364L );
+        unsigned char* data = zs.get_as_string();
+        ZipInputStream zsFile(path + "#zip:lenmusdoc-example.lmd");
+        unsigned char* expected = zsFile.get_as_string();
+        CHECK( strcmp((char*)data, (char*)expected) == 0 );
+        delete[] data;
+        delete[] expected;
+    }
+
+    TEST_FIXTURE(ZipInputStreamTestFixture, zip_in_memory_invalid)
+    {
+        string content("This is not a zip archive");
+        bool fThrown = false;
+        try
+        {
+            ZipInputStream zs(content.data(), content.size());
+        }
+        catch (const std::runtime_error&)
+        {
+            fThrown = true;
+        }
+        CHECK( fThrown == true );
+    }
+
+    TEST_FIXTURE(ZipInputStreamTestFixture, zip_entry_streambuf)
+    {
+        string path = m_scores_path + "10014-compressed-flat-lmd.zip#zip:lenmusdoc-example.lmd";
+        ZipInputStream zs1(path);
+        unsigned char* data = zs1.get_as_string();
+
+        ZipInputStream zs2(path);
+        ZipEntryStreamBuf buf(zs2);
+        istream stream(&buf);
+        string content((istreambuf_iterator<char>(stream)), istreambuf_iterator<char>());
+
+        CHECK( content.size() == 8364 );
+        CHECK( content == string((char*)data) );
+        delete[] data;
+    }
+
 }
 
 #endif // LOMSE_ENABLE_COMPRESSION